@@ -0,0 +1,369 @@
+"""
+BSD 3-Clause License
+
+Copyright (c) 2026, Miguel Dovale (University of Arizona)
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+This software may be subject to U.S. export control laws. By accepting this
+software, the user agrees to comply with all applicable U.S. export laws and
+regulations. User has the responsibility to obtain export licenses, or other
+export authority as may be required before exporting such information to
+foreign countries or providing access to foreign persons.
+
+Capture file reader (docs/ads1278_output.md): v2 files with header and chunk
+index, headerless v1 record files, and the event files ads1278_dump --trigger
+writes (EVENT messages back to back). The file is mmapped and seeks are
+binary searches over the index, so opening and seeking do not read the data.
+"""
+
+from __future__ import annotations
+
+import argparse
+import mmap
+import struct
+import sys
+from dataclasses import dataclass
+from typing import Optional
+
+import protocol
+
+MAGIC_V2 = b"RPDQCAP2"
+HEADER_BYTES = 256
+DEFAULT_CHUNK_FRAMES = 4096
+NO_LINE = 0xFFFFFFFF
+ENCODING_NAMES = {protocol.DATA_ENC_RECORD48: "record48", protocol.DATA_ENC_P24: "p24",
+                  protocol.DATA_ENC_DELTA: "delta"}
+
+# magic, version, header_bytes, channel_count, sample_bits, encoding, reserved,
+# chunk_frames, channel_slot[8], anchor mono/realtime, index_offset,
+# chunk_count, frame_count, eight u32 acquisition settings, three names,
+# decimation, missed frames, gap count
+HEADER = struct.Struct("<8s6HI8s5Q8I32s32s32sI4x2Q")
+INDEX_ENTRY = struct.Struct("<4Q2I")
+
+
+class CaptureError(RuntimeError):
+    pass
+
+
+@dataclass
+class AcqSettings:
+    backend: int
+    sample_rate_hz: int
+    sclk_hz: int
+    spi_mode: int
+    settle_frames: int
+    drdy_timeout_ms: int
+    drdy_line: int
+    sync_line: int
+    drdy_chip: str
+    sync_chip: str
+    writer: str
+    decimation: int
+
+
+@dataclass
+class Chunk:
+    first_seq: int
+    first_tstamp_ns: int
+    offset: int
+    first_frame: int
+    frame_count: int
+    bytes: int
+
+
+def _name(raw: bytes) -> str:
+    return raw.split(b"\0", 1)[0].decode("ascii", "replace")
+
+
+class CaptureFile:
+    def __init__(self, path: str) -> None:
+        self._file = open(path, "rb")
+        size = self._file.seek(0, 2)
+        self._map: Optional[mmap.mmap] = None
+        self._buf = memoryview(b"")
+        if size:
+            self._map = mmap.mmap(self._file.fileno(), 0, access=mmap.ACCESS_READ)
+            self._buf = memoryview(self._map)
+        self._index: Optional[int] = None     # offset of the on-disk index
+        self._rebuilt: list[Chunk] = []
+        self.acq: Optional[AcqSettings] = None
+        self.anchor_monotonic_ns = 0
+        self.anchor_realtime_ns = 0
+        self.missed_frames = 0
+        self.gap_count = 0
+
+        if bytes(self._buf[:8]) == MAGIC_V2:
+            self._open_v2(size)
+        else:
+            self.version = 1
+            self.encoding = protocol.DATA_ENC_RECORD48
+            self.chunk_frames = DEFAULT_CHUNK_FRAMES
+            self.channel_count = protocol.CHANNELS
+            self.channel_slot = tuple(range(protocol.CHANNELS))
+            self.frame_count = size // protocol.RECORD48.size
+            self.chunk_count = -(-self.frame_count // DEFAULT_CHUNK_FRAMES)
+            self.indexed = True
+
+    def _open_v2(self, size: int) -> None:
+        if size < HEADER_BYTES:
+            raise CaptureError("truncated v2 header")
+        (_magic, version, header_bytes, channels, self.sample_bits, self.encoding, _reserved,
+         self.chunk_frames, slots, self.anchor_monotonic_ns, self.anchor_realtime_ns,
+         index_offset, self.chunk_count, self.frame_count, *acq) = HEADER.unpack_from(self._buf)
+        if version != 2 or header_bytes < HEADER_BYTES or not channels or not self.chunk_frames:
+            raise CaptureError("unsupported v2 header")
+        self.version = 2
+        self.channel_count = channels
+        self.channel_slot = tuple(slots)
+        self.acq = AcqSettings(*acq[:8], _name(acq[8]), _name(acq[9]), _name(acq[10]), acq[11])
+        self.missed_frames, self.gap_count = acq[12], acq[13]
+
+        if HEADER_BYTES <= index_offset <= size and \
+                self.chunk_count <= (size - index_offset) // INDEX_ENTRY.size:
+            self._index = index_offset
+            self.indexed = True
+        else:
+            self._rebuild_index()
+            self.indexed = False
+
+    def _rebuild_index(self) -> None:
+        """The writer never finalized the file: walk the chunks up to the first bad one."""
+        offset = HEADER_BYTES
+        frames = 0
+        while True:
+            try:
+                block, length = self._decode_at(offset)
+            except CaptureError:
+                break
+            self._rebuilt.append(Chunk(block.first_seq, block.tstamp_ns[0], offset, frames, len(block), length))
+            frames += len(block)
+            offset += length
+        self.chunk_count = len(self._rebuilt)
+        self.frame_count = frames
+
+    def _decode_at(self, offset: int) -> tuple[protocol.DataBlock, int]:
+        if offset + protocol.HEADER.size > len(self._buf):
+            raise CaptureError("truncated chunk")
+        magic, version, mtype, _flags, _seq, payload_len = protocol.HEADER.unpack_from(self._buf, offset)
+        end = offset + protocol.HEADER.size + payload_len
+        if magic != protocol.MAGIC or not protocol.version_ok(version) or mtype != protocol.MSG_DATA or \
+                end > len(self._buf):
+            raise CaptureError(f"bad chunk at offset {offset}")
+        try:
+            block = protocol.decode_data(bytes(self._buf[offset + protocol.HEADER.size:end]))
+        except (protocol.ProtocolError, struct.error) as exc:
+            raise CaptureError(f"bad chunk at offset {offset}: {exc}") from None
+        if not len(block) or len(block) > self.chunk_frames or block.channel_count != self.channel_count:
+            raise CaptureError(f"bad chunk at offset {offset}")
+        return block, end - offset
+
+    def close(self) -> None:
+        self._buf.release()
+        if self._map is not None:
+            self._map.close()
+        self._file.close()
+
+    def __enter__(self) -> "CaptureFile":
+        return self
+
+    def __exit__(self, *exc: object) -> None:
+        self.close()
+
+    def chunk(self, idx: int) -> Chunk:
+        if not 0 <= idx < self.chunk_count:
+            raise IndexError(idx)
+        if self.version == 1:
+            first = idx * DEFAULT_CHUNK_FRAMES
+            count = min(DEFAULT_CHUNK_FRAMES, self.frame_count - first)
+            offset = first * protocol.RECORD48.size
+            seq, tstamp_ns = struct.unpack_from("<QQ", self._buf, offset)
+            return Chunk(seq, tstamp_ns, offset, first, count, count * protocol.RECORD48.size)
+        if self._index is None:
+            return self._rebuilt[idx]
+        return Chunk(*INDEX_ENTRY.unpack_from(self._buf, self._index + idx * INDEX_ENTRY.size))
+
+    def _chunk_tstamp(self, idx: int) -> int:
+        if self.version == 1:
+            return struct.unpack_from("<Q", self._buf, idx * DEFAULT_CHUNK_FRAMES * protocol.RECORD48.size + 8)[0]
+        if self._index is None:
+            return self._rebuilt[idx].first_tstamp_ns
+        return struct.unpack_from("<Q", self._buf, self._index + idx * INDEX_ENTRY.size + 8)[0]
+
+    def read_chunk(self, idx: int) -> protocol.DataBlock:
+        chunk = self.chunk(idx)
+        if self.version == 1:
+            block = protocol.DataBlock(chunk.first_seq, protocol.DATA_ENC_RECORD48)
+            protocol._decode_record48(block, self._buf[chunk.offset:chunk.offset + chunk.bytes], chunk.frame_count)
+            return block
+        return self._decode_at(chunk.offset)[0]
+
+    def seek_time(self, tstamp_ns: int) -> int:
+        """Position of the first frame with tstamp_ns >= tstamp_ns (frame_count if none)."""
+        if not self.chunk_count:
+            return 0
+        # Last chunk starting at or before tstamp_ns; the target is in it or starts the next.
+        lo, hi = 0, self.chunk_count
+        while hi - lo > 1:
+            mid = (lo + hi) // 2
+            if self._chunk_tstamp(mid) <= tstamp_ns:
+                lo = mid
+            else:
+                hi = mid
+        block = self.read_chunk(lo)
+        pos = next((idx for idx, t in enumerate(block.tstamp_ns) if t >= tstamp_ns), len(block))
+        return self.chunk(lo).first_frame + pos
+
+    def read(self, frame: int, count: int) -> protocol.DataBlock:
+        """Up to count frames starting at file position frame."""
+        out = protocol.DataBlock(0, self.encoding)
+        if frame >= self.frame_count or count <= 0:
+            return out
+        lo, hi = 0, self.chunk_count
+        while hi - lo > 1:
+            mid = (lo + hi) // 2
+            if self.chunk(mid).first_frame <= frame:
+                lo = mid
+            else:
+                hi = mid
+        idx = lo
+        pos = frame - self.chunk(idx).first_frame
+        out.first_seq = -1
+        while count > 0 and idx < self.chunk_count:
+            block = self.read_chunk(idx)
+            end = min(len(block), pos + count)
+            if out.first_seq < 0:
+                out.first_seq = block.seq[pos]
+            out.seq.extend(block.seq[pos:end])
+            out.tstamp_ns.extend(block.tstamp_ns[pos:end])
+            out.ch.extend(block.ch[pos:end])
+            count -= end - pos
+            idx += 1
+            pos = 0
+        return out
+
+    def wall_ns(self, tstamp_ns: int) -> int:
+        """CLOCK_REALTIME time of a frame timestamp; 0 without an anchor (v1)."""
+        if not self.anchor_realtime_ns:
+            return 0
+        return self.anchor_realtime_ns + (tstamp_ns - self.anchor_monotonic_ns)
+
+
+def is_event_file(path: str) -> bool:
+    with open(path, "rb") as f:
+        head = f.read(8)
+    return head[:4] == struct.pack("<I", protocol.MAGIC) and head != MAGIC_V2
+
+
+def read_events(path: str) -> list[protocol.Event]:
+    """Every EVENT of an event file, in file order."""
+    with open(path, "rb") as f:
+        data = f.read()
+    events = []
+    pos = 0
+    while pos < len(data):
+        if len(data) - pos < protocol.HEADER.size:
+            raise CaptureError(f"truncated message at offset {pos}")
+        magic, version, mtype, _flags, _seq, payload_len = protocol.HEADER.unpack_from(data, pos)
+        end = pos + protocol.HEADER.size + payload_len
+        if magic != protocol.MAGIC or not protocol.version_ok(version) or mtype != protocol.MSG_EVENT or end > len(data):
+            raise CaptureError(f"bad EVENT message at offset {pos}")
+        try:
+            events.append(protocol.decode_event(data[pos + protocol.HEADER.size:end]))
+        except protocol.ProtocolError as exc:
+            raise CaptureError(f"offset {pos}: {exc}") from exc
+        pos = end
+    return events
+
+
+def _print_events(path: str, count: int) -> None:
+    events = read_events(path)
+    print(f"{path}: {len(events)} event(s)")
+    for event in events:
+        block = event.block
+        source = ("external" if event.condition == protocol.EVENT_EXTERNAL
+                  else f"condition {event.condition} on ch{event.channel + 1}")
+        print(f"  event {event.event_id}: seq {event.trigger_seq} ({source}), {len(block)} frame(s) "
+              f"from seq {block.first_seq}, {block.channel_count} channels, "
+              f"{ENCODING_NAMES.get(block.encoding, block.encoding)}")
+        for seq, tstamp_ns, ch in list(zip(block.seq, block.tstamp_ns, block.ch))[:count]:
+            print(f"    seq={seq} tstamp_ns={tstamp_ns} ch={list(ch)}")
+
+
+def _print_info(cf: CaptureFile, path: str) -> None:
+    print(f"{path}: v{cf.version}, {cf.frame_count} frame(s) in {cf.chunk_count} chunk(s) "
+          f"of up to {cf.chunk_frames}, {cf.channel_count} channels, {ENCODING_NAMES.get(cf.encoding, cf.encoding)}"
+          + ("" if cf.indexed else " (index rebuilt: file was not finalized)"))
+    if cf.acq is not None:
+        acq = cf.acq
+        decim = f" (1/{acq.decimation} decimated)" if acq.decimation > 1 else ""
+        print(f"  writer {acq.writer or '?'}, backend {acq.backend}, sample rate {acq.sample_rate_hz} Hz{decim}, "
+              f"sclk {acq.sclk_hz} Hz, spi mode {acq.spi_mode}, settle {acq.settle_frames}")
+        drdy = "-" if acq.drdy_line == NO_LINE else f"{acq.drdy_chip or 'sysfs'}:{acq.drdy_line}"
+        sync = "-" if acq.sync_line == NO_LINE else f"{acq.sync_chip or 'sysfs'}:{acq.sync_line}"
+        print(f"  drdy {drdy}, sync {sync}, channel slots {list(cf.channel_slot)}")
+        print(f"  anchor CLOCK_MONOTONIC {cf.anchor_monotonic_ns} ns = CLOCK_REALTIME {cf.anchor_realtime_ns} ns")
+        if cf.gap_count:
+            print(f"  {cf.missed_frames} missed frame(s) in {cf.gap_count} seq gap(s)")
+    if cf.chunk_count:
+        first = cf.chunk(0)
+        last = cf.read(cf.frame_count - 1, 1)
+        print(f"  seq {first.first_seq}..{last.seq[0]}, tstamp_ns {first.first_tstamp_ns}..{last.tstamp_ns[0]}")
+
+
+def main(argv: list[str]) -> int:
+    p = argparse.ArgumentParser(description="Inspect an ads1278_dump capture file (v1, v2 or events).")
+    p.add_argument("input", help="capture file")
+    p.add_argument("--at", type=int, default=None, metavar="NS",
+                   help="print frames from the first one with tstamp_ns >= NS")
+    p.add_argument("--count", type=int, default=10,
+                   help="frames to print with --at, or per event of an event file (default: 10)")
+    args = p.parse_args(argv)
+
+    try:
+        if is_event_file(args.input):
+            _print_events(args.input, args.count)
+            return 0
+        with CaptureFile(args.input) as cf:
+            if args.at is None:
+                _print_info(cf, args.input)
+                return 0
+            pos = cf.seek_time(args.at)
+            block = cf.read(pos, args.count)
+            for seq, tstamp_ns, ch in zip(block.seq, block.tstamp_ns, block.ch):
+                wall = cf.wall_ns(tstamp_ns)
+                print(f"frame={pos} seq={seq} tstamp_ns={tstamp_ns}"
+                      + (f" wall_ns={wall}" if wall else "") + f" ch={list(ch)}")
+                pos += 1
+    except (OSError, CaptureError) as exc:
+        print(f"error: {exc}", file=sys.stderr)
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    raise SystemExit(main(sys.argv[1:]))
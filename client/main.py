@@ -33,4 +33,353 @@ software, the user agrees to comply with all applicable U.S. export laws and
 regulations. User has the responsibility to obtain export licenses, or other
 export authority as may be required before exporting such information to
 foreign countries or providing access to foreign persons.
+
+Headless stream receiver: connects to the DAQ server, parses the stream and
+reports frames, rate and sequence gaps (or, from a server run with --trigger,
+one line per EVENT window, with --summary-ms one line per SUMMARY and with --psd
+one line per SPECTRUM). With --reconnect-s a lost connection is reopened and
+the stream resumed from the next seq out of the server's history. With --udp it
+listens for the DATA datagrams of a server run with --udp instead (multicast
+group or unicast port); lost datagrams show up as msg_seq and seq gaps. Exit status
+is non-zero on a gap or protocol error, so it doubles as a loopback check
+against `server --backend sim`.
 """
+
+from __future__ import annotations
+
+import argparse
+import socket
+import sys
+import time
+
+import protocol
+
+
+def _ramp_value(index: int, channel: int) -> int:
+    """Sample the server's sim ramp signal produces for a conversion index (see backend_sim.c)."""
+    raw = (index * (channel + 1)) & 0xFFFFFF
+    return (raw ^ 0x800000) - 0x800000
+
+
+def _ramp_ok(ch: tuple[int, ...]) -> bool:
+    # Channel 1 carries the conversion index itself; missed DRDY edges advance
+    # the index without a frame, so it is not derived from seq.
+    index = ch[0] & 0xFFFFFF
+    return all(ch[c] == _ramp_value(index, c) for c in range(len(ch)))
+
+
+def _print_stats(stats: protocol.Stats) -> None:
+    stages = ", ".join(f"{st.name} {st.p50_ns / 1e3:.1f}/{st.p99_ns / 1e3:.1f}/{st.p999_ns / 1e3:.1f}/"
+                       f"{st.max_ns / 1e3:.1f}" for st in stats.stages)
+    print(f"STATS frames {stats.frames}, timeouts {stats.drdy_timeouts}, missed {stats.missed_drdy}, "
+          f"missed conversions {stats.missed_conversions} in {stats.gap_events} gap(s), "
+          f"overlong {stats.overlong_xfers}, ring {stats.ring_high_water}/{stats.ring_capacity} "
+          f"overflows {stats.ring_overflows}, dropped msgs {stats.msgs_dropped}; "
+          f"p50/p99/p99.9/max us: {stages}", file=sys.stderr)
+
+
+def _print_summary(summary: protocol.Summary) -> None:
+    unit = "V" if summary.volts else "codes"
+    fmt = ".6g" if summary.volts else ".1f"
+    chans = "; ".join(f"ch{idx + 1} {c.min:{fmt}}/{c.max:{fmt}}/{c.mean:{fmt}}/{c.rms:{fmt}}"
+                      for idx, c in enumerate(summary.ch))
+    print(f"SUMMARY seq {summary.first_seq}..{summary.last_seq} ({summary.frames} frame(s)), "
+          f"min/max/mean/rms {unit}: {chans}", file=sys.stderr)
+
+
+def _print_spectrum(spectrum: protocol.Spectrum) -> None:
+    unit = "V^2/Hz" if spectrum.volts else "codes^2/Hz"
+    # Skip DC: the peak of interest is a tone, the floor the median bin.
+    body = spectrum.psd[1:] or spectrum.psd
+    peak = max(range(len(body)), key=body.__getitem__) + (len(spectrum.psd) - len(body))
+    floor = sorted(body)[len(body) // 2]
+    print(f"SPECTRUM {spectrum.result_id} ch{spectrum.channel + 1} seq {spectrum.first_seq}..{spectrum.last_seq} "
+          f"({spectrum.segments} x {spectrum.fft_size}-point {spectrum.window}, {len(spectrum.psd)} bins of "
+          f"{spectrum.bin_hz * spectrum.bin_group:.4g} Hz): peak {spectrum.psd[peak]:.4g} {unit} at "
+          f"{spectrum.freq_hz(peak):.4g} Hz, median {floor:.4g} {unit}", file=sys.stderr)
+
+
+class _Receiver:
+    """Counters and sequence tracking across one or more (resumed) connections."""
+
+    def __init__(self, args: argparse.Namespace) -> None:
+        self.args = args
+        self.frames = 0
+        self.gaps = 0
+        self.msg_gaps = 0
+        self.notified_msgs = 0
+        self.lost_frames = 0
+        self.duplicates = 0
+        self.resumes = 0
+        self.resync_bytes = 0
+        self.bad_datagrams = 0
+        self.ramp_errors = 0
+        self.stats_msgs = 0
+        self.events = 0
+        self.summaries = 0
+        self.spectra = 0
+        self.expect_seq: int | None = None
+        self.expect_msg: int | None = None
+        self.await_resume = False
+        self.t_first: float | None = None
+        self.announced = False
+
+    def done(self) -> bool:
+        args = self.args
+        return ((args.frames != 0 and self.frames >= args.frames) or
+                (args.summaries != 0 and self.summaries >= args.summaries) or
+                (args.spectra != 0 and self.spectra >= args.spectra))
+
+    def _started(self) -> None:
+        if self.t_first is None:
+            self.t_first = time.monotonic()
+
+    def handle(self, msg: protocol.Message) -> None:
+        args = self.args
+        # UDP repeats HELLO and CONFIG for late listeners; print them once.
+        if msg.type == protocol.MSG_HELLO:
+            hello = protocol.decode_hello(msg.payload)
+            if not self.announced:
+                print(f"HELLO {hello.server_name} protocol v{hello.proto_version}, "
+                      f"{hello.channel_count} channels", file=sys.stderr)
+            return
+        if msg.type == protocol.MSG_CONFIG:
+            cfg = protocol.decode_config(msg.payload)
+            if not self.announced:
+                print(f"CONFIG rate {cfg.sample_rate_hz} Hz, {cfg.frames_per_msg} frames/msg, "
+                      f"flush {cfg.flush_us} us", file=sys.stderr)
+            self.announced = True
+            return
+        if msg.type == protocol.MSG_GAP:
+            gap = protocol.decode_gap(msg.payload)
+            if gap.resume:
+                self.await_resume = False
+                print(f"RESUME from seq {gap.first_seq}"
+                      + (f", {gap.frame_count} frame(s) no longer in the server history" if gap.frame_count else ""),
+                      file=sys.stderr)
+            else:
+                print(f"GAP: server dropped {gap.msg_count} message(s), {gap.frame_count} frame(s) "
+                      f"from seq {gap.first_seq}", file=sys.stderr)
+                self.notified_msgs += gap.msg_count
+            self.lost_frames += gap.frame_count
+            self.expect_msg = (gap.first_msg_seq + gap.msg_count) & 0xFFFFFFFF
+            return
+
+        # Live messages may arrive before the resume GAP; the replay after it carries them again.
+        if self.await_resume:
+            return
+
+        # DATA, STATS, EVENT, SUMMARY and SPECTRUM share the msg_seq counter.
+        if self.expect_msg is not None and msg.msg_seq != self.expect_msg:
+            self.msg_gaps += (msg.msg_seq - self.expect_msg) & 0xFFFFFFFF
+        self.expect_msg = (msg.msg_seq + 1) & 0xFFFFFFFF
+
+        if msg.type == protocol.MSG_STATS:
+            self.stats_msgs += 1
+            if args.stats:
+                _print_stats(protocol.decode_stats(msg.payload))
+        elif msg.type == protocol.MSG_DATA:
+            block = protocol.decode_data(msg.payload)
+            self._started()
+            # A resumed stream replays from the message holding the next seq wanted.
+            if self.resumes != 0 and self.expect_seq is not None and block.first_seq < self.expect_seq:
+                keep = [idx for idx, seq in enumerate(block.seq) if seq >= self.expect_seq]
+                self.duplicates += len(block) - len(keep)
+                if not keep:
+                    return
+                block.first_seq = block.seq[keep[0]]
+                block.seq = [block.seq[idx] for idx in keep]
+                block.tstamp_ns = [block.tstamp_ns[idx] for idx in keep]
+                block.ch = [block.ch[idx] for idx in keep]
+            if self.expect_seq is not None and block.first_seq != self.expect_seq:
+                self.gaps += 1
+                print(f"gap: expected seq {self.expect_seq}, got {block.first_seq}", file=sys.stderr)
+            self.expect_seq = block.first_seq + len(block)
+            if args.check_ramp:
+                self.ramp_errors += sum(1 for ch in block.ch if not _ramp_ok(ch))
+            if args.print:
+                for seq, ts, ch in zip(block.seq, block.tstamp_ns, block.ch):
+                    print(seq, ts, *ch)
+            self.frames += len(block)
+        elif msg.type == protocol.MSG_SUMMARY:
+            summary = protocol.decode_summary(msg.payload)
+            self._started()
+            _print_summary(summary)
+            self.summaries += 1
+        elif msg.type == protocol.MSG_SPECTRUM:
+            spectrum = protocol.decode_spectrum(msg.payload)
+            self._started()
+            _print_spectrum(spectrum)
+            self.spectra += 1
+        elif msg.type == protocol.MSG_EVENT:
+            event = protocol.decode_event(msg.payload)
+            block = event.block
+            self._started()
+            source = ("external" if event.condition == protocol.EVENT_EXTERNAL
+                      else f"condition {event.condition} on ch{event.channel + 1}")
+            print(f"EVENT {event.event_id} at seq {event.trigger_seq} ({source}), "
+                  f"{len(block)} frame(s), {event.pre_frames} before the trigger", file=sys.stderr)
+            # A window is consecutive frames around the trigger frame.
+            if (block.first_seq != event.trigger_seq - event.pre_frames or
+                    block.seq != list(range(block.first_seq, block.first_seq + len(block)))):
+                self.gaps += 1
+                print(f"bad window in EVENT {event.event_id}", file=sys.stderr)
+            if args.check_ramp:
+                self.ramp_errors += sum(1 for ch in block.ch if not _ramp_ok(ch))
+            if args.print:
+                for seq, ts, ch in zip(block.seq, block.tstamp_ns, block.ch):
+                    print(seq, ts, *ch)
+            self.frames += len(block)
+            self.events += 1
+
+    def session(self, sock: socket.socket) -> None:
+        """Read one connection until EOF or done(); raises OSError on a dropped link."""
+        args = self.args
+        parser = protocol.StreamParser()
+        policy = protocol.POLICIES[args.policy]
+        resume_seq = self.expect_seq if self.resumes != 0 else None
+        self.expect_msg = None
+        self.await_resume = resume_seq is not None
+        if policy != protocol.POLICY_DEFAULT or args.max_lag_ms != 0 or resume_seq is not None:
+            sock.sendall(protocol.encode_subscribe(policy, resume_seq, args.max_lag_ms))
+        try:
+            while not self.done():
+                chunk = sock.recv(1 << 16)
+                if not chunk:
+                    break
+                for msg in parser.feed(chunk):
+                    self.handle(msg)
+        finally:
+            self.resync_bytes += parser.resync_bytes
+
+
+def _open_udp(spec: str, iface: str) -> socket.socket:
+    host, _, port = spec.rpartition(":")
+    group = socket.inet_aton(host)
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+    # Room for bursts while Python decodes (capped by net.core.rmem_max).
+    sock.setsockopt(socket.SOL_SOCKET, socket.SO_RCVBUF, 8 << 20)
+    if 224 <= group[0] <= 239:
+        # Bound to the group so other groups on the same port are not delivered here.
+        sock.bind((host, int(port)))
+        sock.setsockopt(socket.IPPROTO_IP, socket.IP_ADD_MEMBERSHIP, group + socket.inet_aton(iface))
+    else:
+        sock.bind(("", int(port)))
+    return sock
+
+
+def receive_udp(args: argparse.Namespace) -> int:
+    rx = _Receiver(args)
+
+    with _open_udp(args.udp, args.udp_iface) as sock:
+        sock.settimeout(args.timeout)
+        print(f"Listening on {args.udp}", file=sys.stderr)
+        while not rx.done():
+            try:
+                data = sock.recv(1 << 16)
+            except socket.timeout:
+                # There is no end-of-stream on UDP: silence ends the run.
+                print(f"no datagram for {args.timeout:g} s", file=sys.stderr)
+                break
+            try:
+                rx.handle(protocol.decode_datagram(data))
+            except protocol.ProtocolError:
+                rx.bad_datagrams += 1
+    return _report(rx, args)
+
+
+def receive(args: argparse.Namespace) -> int:
+    rx = _Receiver(args)
+    deadline = None
+
+    while True:
+        try:
+            sock = socket.create_connection((args.host, args.port), timeout=args.timeout)
+        except OSError:
+            # Keep retrying while reconnecting; the first connection must succeed.
+            if deadline is None:
+                raise
+            if time.monotonic() >= deadline:
+                break
+            time.sleep(0.2)
+            continue
+        with sock:
+            try:
+                rx.session(sock)
+            except OSError as exc:
+                if args.reconnect_s == 0:
+                    raise
+                print(f"connection lost: {exc}", file=sys.stderr)
+        if rx.done() or args.reconnect_s == 0:
+            break
+        # EOF or a dropped link: resume from the next seq wanted (the server may also have ended).
+        rx.resumes += 1
+        deadline = time.monotonic() + args.reconnect_s
+    return _report(rx, args)
+
+
+def _report(rx: _Receiver, args: argparse.Namespace) -> int:
+    elapsed = (time.monotonic() - rx.t_first) if rx.t_first is not None else 0.0
+    rate = rx.frames / elapsed if elapsed > 0 else 0.0
+    print(f"Received {rx.frames} frame(s) in {elapsed:.3f} s ({rate:.0f} frames/s); "
+          f"{rx.gaps} seq gap(s), {rx.msg_gaps} dropped message(s), "
+          f"{rx.resync_bytes} resync byte(s), {rx.stats_msgs} STATS message(s), {rx.events} EVENT(s), "
+          f"{rx.summaries} SUMMARY message(s), {rx.spectra} SPECTRUM message(s)", file=sys.stderr)
+    if rx.notified_msgs != 0 or rx.lost_frames != 0 or args.reconnect_s != 0:
+        print(f"Server GAPs: {rx.notified_msgs} message(s), {rx.lost_frames} frame(s) lost; "
+              f"{rx.resumes} reconnect(s), {rx.duplicates} replayed frame(s) discarded", file=sys.stderr)
+    if args.udp:
+        print(f"UDP: {rx.msg_gaps} datagram(s) lost, {rx.bad_datagrams} malformed", file=sys.stderr)
+    if args.check_ramp:
+        print(f"Ramp check: {rx.ramp_errors} bad frame(s)", file=sys.stderr)
+
+    ok = (rx.gaps == 0 and rx.msg_gaps == 0 and rx.notified_msgs == 0 and rx.resync_bytes == 0 and
+          rx.bad_datagrams == 0 and rx.ramp_errors == 0)
+    if args.frames != 0 and rx.frames < args.frames:
+        ok = False
+    if args.summaries != 0 and rx.summaries < args.summaries:
+        ok = False
+    if args.spectra != 0 and rx.spectra < args.spectra:
+        ok = False
+    return 0 if ok else 1
+
+
+def main(argv: list[str]) -> int:
+    p = argparse.ArgumentParser(description="Headless receiver for the redpitaya-spi-daq stream.")
+    p.add_argument("--host", default="127.0.0.1", help="Server address (default: 127.0.0.1)")
+    p.add_argument("--port", type=int, default=9000, help="Server port (default: 9000)")
+    p.add_argument("--frames", type=int, default=0,
+                   help="Stop after N frames (default: 0 = until the server closes)")
+    p.add_argument("--summaries", type=int, default=0,
+                   help="Stop after N SUMMARY messages (server --summary-ms/--summary-only)")
+    p.add_argument("--spectra", type=int, default=0,
+                   help="Stop after N SPECTRUM messages, one per channel per result (server --psd)")
+    p.add_argument("--timeout", type=float, default=10.0, help="Socket timeout in seconds (default: 10)")
+    p.add_argument("--check-ramp", action="store_true",
+                   help="Verify samples against the sim backend's ramp signal")
+    p.add_argument("--print", action="store_true", help="Print every frame (seq tstamp_ns ch1..chN)")
+    p.add_argument("--stats", action="store_true", help="Print each STATS message from the server")
+    p.add_argument("--policy", choices=sorted(protocol.POLICIES), default="default",
+                   help="Backpressure policy to SUBSCRIBE with: drop (skip ahead, GAP), disconnect, never "
+                        "(default: the server's)")
+    p.add_argument("--max-lag-ms", type=int, default=0,
+                   help="Lag before a disconnect-policy session is closed (default: the server's)")
+    p.add_argument("--reconnect-s", type=float, default=0.0,
+                   help="After a lost connection keep reconnecting for this long and resume from the next "
+                        "seq (default: 0 = off)")
+    p.add_argument("--udp", metavar="ADDR:PORT",
+                   help="Listen for server --udp datagrams on a multicast group or unicast port instead of TCP")
+    p.add_argument("--udp-iface", default="0.0.0.0",
+                   help="Local interface address to join the multicast group on (default: any)")
+    args = p.parse_args(argv)
+
+    try:
+        return receive_udp(args) if args.udp else receive(args)
+    except (OSError, protocol.ProtocolError) as exc:
+        print(f"error: {exc}", file=sys.stderr)
+        return 1
+
+
+if __name__ == "__main__":
+    raise SystemExit(main(sys.argv[1:]))
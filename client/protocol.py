@@ -0,0 +1,515 @@
+"""
+BSD 3-Clause License
+
+Copyright (c) 2026, Miguel Dovale (University of Arizona)
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+This software may be subject to U.S. export control laws. By accepting this
+software, the user agrees to comply with all applicable U.S. export laws and
+regulations. User has the responsibility to obtain export licenses, or other
+export authority as may be required before exporting such information to
+foreign countries or providing access to foreign persons.
+
+Stream protocol parser (docs/protocol.md). Pure Python, no dependencies.
+"""
+
+from __future__ import annotations
+
+import struct
+from dataclasses import dataclass, field
+from typing import Iterator, Optional, Sequence
+
+MAGIC = 0x51445052  # b"RPDQ"
+VERSION = 2
+MIN_VERSION = 1             # v1 only had DATA channel_count reserved (0 = 8)
+CHANNELS = 8
+
+MSG_HELLO = 1
+MSG_CONFIG = 2
+MSG_DATA = 3
+MSG_STATS = 4
+MSG_EVENT = 5
+MSG_SUMMARY = 6
+MSG_SPECTRUM = 7
+MSG_SUBSCRIBE = 8           # client to server
+MSG_GAP = 9
+
+DATA_ENC_RECORD48 = 1
+DATA_ENC_P24 = 2
+DATA_ENC_DELTA = 3
+DATA_LINEAR_TS = 0x8000     # encoding flag: timestamps as base + last instead of per-frame deltas
+DATA_SEQ_GAPS = 0x4000      # encoding flag: the payload ends with a seq gap list
+
+HEADER = struct.Struct("<IBBHII")
+HELLO = struct.Struct("<HHI32s")
+CONFIG = struct.Struct("<8I")
+DATA_INFO = struct.Struct("<QIHH")
+RECORD48 = struct.Struct("<QQ8i")
+P24_BASE = struct.Struct("<Q")
+LINEAR_TS = struct.Struct("<Q")
+GAP_ENTRY = struct.Struct("<II")
+GAP_COUNT = struct.Struct("<I")
+STATS_HEADER = struct.Struct("<10QIHH")
+STATS_STAGE = struct.Struct("<Q4I")
+STATS_STAGES = ("drdy-wakeup", "spi-xfer", "parse", "ring-dwell", "net-send")
+EVENT_HEADER = struct.Struct("<QQQIIHHI")
+EVENT_EXTERNAL = 0xFFFF
+SUMMARY_HEADER = struct.Struct("<6QHHI")
+SUMMARY_CHANNEL = struct.Struct("<5d")
+SUMMARY_VOLTS = 0x1
+SPECTRUM_HEADER = struct.Struct("<4Q2d2I4H2I")
+SPECTRUM_VOLTS = 0x1
+SPECTRUM_WINDOWS = ("hann", "rect", "blackman-harris")
+SUBSCRIBE = struct.Struct("<QIHH")
+SUBSCRIBE_RESUME = 0x1
+GAP = struct.Struct("<IIQQHHI")
+GAP_RESUME = 0x1
+CODEC_GROUP = 32
+
+# SUBSCRIBE backpressure policies (docs/protocol.md)
+POLICY_DEFAULT = 0
+POLICY_DROP_OLDEST = 1
+POLICY_DISCONNECT = 2
+POLICY_NEVER_DROP = 3
+POLICIES = {"default": POLICY_DEFAULT, "drop": POLICY_DROP_OLDEST, "disconnect": POLICY_DISCONNECT,
+            "never": POLICY_NEVER_DROP}
+
+MAX_PAYLOAD = 16 * 1024 * 1024
+
+
+class ProtocolError(RuntimeError):
+    pass
+
+
+@dataclass
+class Message:
+    type: int
+    flags: int
+    msg_seq: int
+    payload: bytes
+
+
+@dataclass
+class Hello:
+    proto_version: int
+    channel_count: int
+    server_name: str
+
+
+@dataclass
+class Config:
+    backend: int
+    sample_rate_hz: int
+    sclk_hz: int
+    spi_mode: int
+    settle_frames: int
+    frames_per_msg: int
+    flush_us: int
+    stream_mode: int
+
+
+@dataclass
+class StageStats:
+    name: str
+    count: int
+    p50_ns: int
+    p99_ns: int
+    p999_ns: int
+    max_ns: int
+
+
+@dataclass
+class Stats:
+    mono_ns: int
+    frames: int
+    drdy_timeouts: int
+    missed_drdy: int
+    overlong_xfers: int
+    ring_overflows: int
+    ring_high_water: int
+    msgs_dropped: int
+    missed_conversions: int
+    gap_events: int
+    ring_capacity: int
+    stages: list[StageStats] = field(default_factory=list)
+
+
+@dataclass
+class DataBlock:
+    first_seq: int
+    encoding: int
+    channel_count: int = CHANNELS
+    linear_ts: bool = False     # timestamps were sent as DATA_LINEAR_TS (base + rate)
+    gap_count: int = 0          # DATA_SEQ_GAPS entries: forward seq jumps inside the message
+    seq: list[int] = field(default_factory=list)
+    tstamp_ns: list[int] = field(default_factory=list)
+    ch: list[tuple[int, ...]] = field(default_factory=list)
+
+    def __len__(self) -> int:
+        return len(self.seq)
+
+
+@dataclass
+class Event:
+    event_id: int
+    trigger_seq: int
+    trigger_tstamp_ns: int
+    pre_frames: int
+    condition: int              # index into the server's --trigger conditions, EVENT_EXTERNAL
+    channel: int                # 0-based, EVENT_EXTERNAL for external triggers
+    block: DataBlock            # the window; block.seq[pre_frames] == trigger_seq
+
+
+@dataclass
+class ChannelSummary:
+    min: float
+    max: float
+    mean: float
+    rms: float
+    stddev: float
+
+
+@dataclass
+class Summary:
+    mono_ns: int
+    first_seq: int
+    last_seq: int
+    frames: int                 # 0 = no frames in the period
+    first_tstamp_ns: int
+    last_tstamp_ns: int
+    volts: bool                 # calibrated volts, else ADC codes
+    ch: list[ChannelSummary] = field(default_factory=list)
+
+
+@dataclass
+class Spectrum:
+    mono_ns: int
+    result_id: int              # shared by the result's per-channel messages
+    first_seq: int
+    last_seq: int
+    bin_hz: float               # FFT bin spacing
+    enbw_hz: float              # window equivalent noise bandwidth
+    fft_size: int
+    segments: int
+    channel: int                # 0-based
+    window: str
+    volts: bool                 # V^2/Hz, else codes^2/Hz
+    bin_group: int              # psd[k] averages FFT bins [k * bin_group, (k + 1) * bin_group)
+    psd: list[float] = field(default_factory=list)
+
+    def freq_hz(self, k: int) -> float:
+        """Centre frequency of psd[k]."""
+        return (k * self.bin_group + (self.bin_group - 1) / 2) * self.bin_hz
+
+
+@dataclass
+class Gap:
+    first_msg_seq: int          # msg_seq of the first message not sent
+    msg_count: int              # the next message has msg_seq first_msg_seq + msg_count
+    first_seq: int              # first frame lost (the requested seq for a resume)
+    frame_count: int
+    resume: bool                # reply to a resuming SUBSCRIBE
+
+
+def version_ok(version: int) -> bool:
+    """Header versions this parser reads: v1 DATA is v2 with channel_count 0 (= 8)."""
+    return MIN_VERSION <= version <= VERSION
+
+
+def encode_subscribe(policy: int = POLICY_DEFAULT, resume_seq: Optional[int] = None, max_lag_ms: int = 0) -> bytes:
+    """Complete SUBSCRIBE message; resume_seq None joins live."""
+    flags = 0 if resume_seq is None else SUBSCRIBE_RESUME
+    payload = SUBSCRIBE.pack(resume_seq or 0, max_lag_ms, policy, flags)
+    return HEADER.pack(MAGIC, VERSION, MSG_SUBSCRIBE, 0, 0, len(payload)) + payload
+
+
+def decode_gap(payload: bytes) -> Gap:
+    if len(payload) < GAP.size:
+        raise ProtocolError("short GAP payload")
+    first_msg_seq, msg_count, first_seq, frame_count, flags, _r0, _r1 = GAP.unpack_from(payload)
+    return Gap(first_msg_seq, msg_count, first_seq, frame_count, bool(flags & GAP_RESUME))
+
+
+def decode_hello(payload: bytes) -> Hello:
+    version, channels, _reserved, name = HELLO.unpack_from(payload)
+    return Hello(version, channels, name.split(b"\0", 1)[0].decode("ascii", "replace"))
+
+
+def decode_config(payload: bytes) -> Config:
+    return Config(*CONFIG.unpack_from(payload))
+
+
+def decode_stats(payload: bytes) -> Stats:
+    if len(payload) < STATS_HEADER.size:
+        raise ProtocolError("short STATS payload")
+    *counters, stage_count, _reserved = STATS_HEADER.unpack_from(payload)
+    if len(payload) < STATS_HEADER.size + stage_count * STATS_STAGE.size:
+        raise ProtocolError("truncated STATS stages")
+    stats = Stats(*counters)
+    for idx in range(stage_count):
+        name = STATS_STAGES[idx] if idx < len(STATS_STAGES) else f"stage{idx}"
+        fields = STATS_STAGE.unpack_from(payload, STATS_HEADER.size + idx * STATS_STAGE.size)
+        stats.stages.append(StageStats(name, *fields))
+    return stats
+
+
+def _sign24(raw: int) -> int:
+    return raw - 0x1000000 if raw & 0x800000 else raw
+
+
+def _decode_record48(block: DataBlock, body: memoryview, count: int) -> None:
+    if block.channel_count != CHANNELS or len(body) != count * RECORD48.size:
+        raise ProtocolError("DATA length does not match frame count")
+    for seq, tstamp_ns, *ch in RECORD48.iter_unpack(body):
+        block.seq.append(seq)
+        block.tstamp_ns.append(tstamp_ns)
+        block.ch.append(tuple(ch))
+
+
+def _linear_tstamps(base_ns: int, last_ns: int, seqs: Sequence[int]) -> list[int]:
+    """Frame timestamps of a DATA_LINEAR_TS message (docs/protocol.md), on the seq line."""
+    if len(seqs) < 2 or last_ns < base_ns:
+        raise ProtocolError("bad linear DATA timestamps")
+    span = last_ns - base_ns
+    div = seqs[-1] - seqs[0]
+    return [base_ns + ((seq - seqs[0]) * span + div // 2) // div for seq in seqs]
+
+
+def _split_gaps(body: memoryview, first_seq: int, count: int) -> tuple[memoryview, list[int], int]:
+    """Take the DATA_SEQ_GAPS list off the body; returns it, the frame seqs and the gap count."""
+    if len(body) < GAP_COUNT.size:
+        raise ProtocolError("truncated DATA gap list")
+    (gaps,) = GAP_COUNT.unpack_from(body, len(body) - GAP_COUNT.size)
+    start = len(body) - GAP_COUNT.size - gaps * GAP_ENTRY.size
+    if gaps == 0 or gaps >= count or start < P24_BASE.size:
+        raise ProtocolError("bad DATA gap list")
+    seqs = []
+    seq = first_seq
+    prev = 0
+    entries = GAP_ENTRY.iter_unpack(body[start:len(body) - GAP_COUNT.size])
+    for frame, skipped in entries:
+        if frame <= prev or frame >= count or skipped == 0:
+            raise ProtocolError("bad DATA gap list")
+        seqs.extend(range(seq, seq + frame - len(seqs)))
+        seq = seqs[-1] + 1 + skipped
+        prev = frame
+    seqs.extend(range(seq, seq + count - len(seqs)))
+    return body[:start], seqs, gaps
+
+
+def _decode_p24(block: DataBlock, body: memoryview, count: int, seqs: Sequence[int]) -> None:
+    frame_bytes = 3 * block.channel_count
+    samples_len = count * frame_bytes
+    ts_len = LINEAR_TS.size if block.linear_ts else count * 4
+    if len(body) != P24_BASE.size + samples_len + ts_len:
+        raise ProtocolError("DATA length does not match frame count")
+
+    (tstamp_ns,) = P24_BASE.unpack_from(body)
+    samples = body[P24_BASE.size:P24_BASE.size + samples_len]
+    if block.linear_ts:
+        (last_ns,) = LINEAR_TS.unpack_from(body, P24_BASE.size + samples_len)
+        block.tstamp_ns.extend(_linear_tstamps(tstamp_ns, last_ns, seqs))
+    else:
+        deltas = struct.unpack_from(f"<{count}I", body, P24_BASE.size + samples_len)
+        for delta in deltas:
+            tstamp_ns += delta
+            block.tstamp_ns.append(tstamp_ns)
+    block.seq.extend(seqs)
+    for idx in range(count):
+        frame = samples[idx * frame_bytes:(idx + 1) * frame_bytes]
+        block.ch.append(tuple(_sign24(int.from_bytes(frame[pos:pos + 3], "big"))
+                              for pos in range(0, frame_bytes, 3)))
+
+
+def decode_codec_stream(buf: memoryview, pos: int, count: int) -> tuple[list[int], int]:
+    """
+    Decode `count` int32 values of a sample_codec stream starting at buf[pos]
+    (server/include/sample_codec.h); returns the values and the end offset.
+    """
+    values: list[int] = []
+    prev = 0
+    for start in range(0, count, CODEC_GROUP):
+        n = min(CODEC_GROUP, count - start)
+        if pos >= len(buf) or buf[pos] > 32:
+            raise ProtocolError("bad codec group header")
+        width = buf[pos]
+        end = pos + 1 + (n * width + 7) // 8
+        if end > len(buf):
+            raise ProtocolError("codec stream truncated")
+        bits = int.from_bytes(buf[pos + 1:end], "little")
+        mask = (1 << width) - 1
+        for _ in range(n):
+            zz = bits & mask
+            bits >>= width
+            prev = (prev + ((zz >> 1) ^ -(zz & 1))) & 0xFFFFFFFF
+            values.append(prev - 0x100000000 if prev & 0x80000000 else prev)
+        pos = end
+    return values, pos
+
+
+def _decode_delta(block: DataBlock, body: memoryview, count: int, seqs: Sequence[int]) -> None:
+    if len(body) < P24_BASE.size:
+        raise ProtocolError("DATA length does not match frame count")
+
+    (tstamp_ns,) = P24_BASE.unpack_from(body)
+    pos = P24_BASE.size
+    streams = []
+    for _ in range(block.channel_count + (0 if block.linear_ts else 1)):
+        values, pos = decode_codec_stream(body, pos, count)
+        streams.append(values)
+    if block.linear_ts:
+        if len(body) - pos != LINEAR_TS.size:
+            raise ProtocolError("DATA length does not match frame count")
+        (last_ns,) = LINEAR_TS.unpack_from(body, pos)
+        block.tstamp_ns.extend(_linear_tstamps(tstamp_ns, last_ns, seqs))
+        block.seq.extend(seqs)
+        block.ch.extend(zip(*streams))
+        return
+    if pos != len(body):
+        raise ProtocolError("DATA length does not match frame count")
+
+    for delta in streams[-1]:
+        tstamp_ns += delta & 0xFFFFFFFF
+        block.tstamp_ns.append(tstamp_ns)
+    block.seq.extend(seqs)
+    block.ch.extend(zip(*streams[:-1]))
+
+
+def decode_data(payload: bytes) -> DataBlock:
+    first_seq, count, encoding, channels = DATA_INFO.unpack_from(payload)
+    body = memoryview(payload)[DATA_INFO.size:]
+    # 0 = a single ADS1278; daisy chains carry 8 channels per device, and a
+    # server decimating a channel selection (--decim masks) only those.
+    channels = channels or CHANNELS
+    linear_ts = bool(encoding & DATA_LINEAR_TS)
+    seq_gaps = bool(encoding & DATA_SEQ_GAPS)
+    encoding &= ~(DATA_LINEAR_TS | DATA_SEQ_GAPS)
+    if (linear_ts or seq_gaps) and encoding not in (DATA_ENC_P24, DATA_ENC_DELTA):
+        raise ProtocolError("linear timestamps and gap lists need p24 or delta DATA")
+    block = DataBlock(first_seq, encoding, channels, linear_ts)
+    seqs: Sequence[int] = range(first_seq, first_seq + count)
+    if seq_gaps:
+        body, seqs, block.gap_count = _split_gaps(body, first_seq, count)
+
+    if encoding == DATA_ENC_RECORD48:
+        _decode_record48(block, body, count)
+    elif encoding == DATA_ENC_P24:
+        _decode_p24(block, body, count, seqs)
+    elif encoding == DATA_ENC_DELTA:
+        _decode_delta(block, body, count, seqs)
+    else:
+        raise ProtocolError(f"unsupported DATA encoding {encoding}")
+    return block
+
+
+def decode_event(payload: bytes) -> Event:
+    if len(payload) < EVENT_HEADER.size + HEADER.size:
+        raise ProtocolError("short EVENT payload")
+    event_id, trigger_seq, trigger_tstamp_ns, count, pre, condition, channel, _reserved = \
+        EVENT_HEADER.unpack_from(payload)
+    magic, version, mtype, _flags, _msg_seq, data_len = HEADER.unpack_from(payload, EVENT_HEADER.size)
+    start = EVENT_HEADER.size + HEADER.size
+    if magic != MAGIC or not version_ok(version) or mtype != MSG_DATA or start + data_len != len(payload):
+        raise ProtocolError("bad DATA message in EVENT")
+    block = decode_data(payload[start:])
+    if len(block) != count:
+        raise ProtocolError(f"EVENT frame count {count} != DATA frame count {len(block)}")
+    return Event(event_id, trigger_seq, trigger_tstamp_ns, pre, condition, channel, block)
+
+
+def decode_summary(payload: bytes) -> Summary:
+    if len(payload) < SUMMARY_HEADER.size:
+        raise ProtocolError("short SUMMARY payload")
+    *fields, channels, flags, _reserved = SUMMARY_HEADER.unpack_from(payload)
+    if len(payload) < SUMMARY_HEADER.size + channels * SUMMARY_CHANNEL.size:
+        raise ProtocolError("truncated SUMMARY channels")
+    summary = Summary(*fields, volts=bool(flags & SUMMARY_VOLTS))
+    for idx in range(channels):
+        summary.ch.append(ChannelSummary(*SUMMARY_CHANNEL.unpack_from(payload,
+                                                                      SUMMARY_HEADER.size + idx * SUMMARY_CHANNEL.size)))
+    return summary
+
+
+def decode_spectrum(payload: bytes) -> Spectrum:
+    if len(payload) < SPECTRUM_HEADER.size:
+        raise ProtocolError("short SPECTRUM payload")
+    (mono_ns, result_id, first_seq, last_seq, bin_hz, enbw_hz, fft_size, segments, channel, window, flags,
+     bin_group, bins, _reserved) = SPECTRUM_HEADER.unpack_from(payload)
+    if len(payload) < SPECTRUM_HEADER.size + bins * 4:
+        raise ProtocolError("truncated SPECTRUM bins")
+    name = SPECTRUM_WINDOWS[window] if window < len(SPECTRUM_WINDOWS) else f"window {window}"
+    return Spectrum(mono_ns, result_id, first_seq, last_seq, bin_hz, enbw_hz, fft_size, segments, channel, name,
+                    bool(flags & SPECTRUM_VOLTS), bin_group,
+                    list(struct.unpack_from(f"<{bins}f", payload, SPECTRUM_HEADER.size)))
+
+
+def decode_datagram(data: bytes) -> Message:
+    """One UDP datagram (server --udp): exactly one complete message, no resync."""
+    if len(data) < HEADER.size:
+        raise ProtocolError(f"short datagram ({len(data)} bytes)")
+    magic, version, mtype, flags, msg_seq, payload_len = HEADER.unpack_from(data)
+    if magic != MAGIC or not version_ok(version) or payload_len != len(data) - HEADER.size:
+        raise ProtocolError("bad datagram header")
+    return Message(mtype, flags, msg_seq, bytes(data[HEADER.size:]))
+
+
+class StreamParser:
+    """
+    Incremental message parser. feed() accepts arbitrary byte chunks (partial
+    messages are buffered); on a bad header it skips ahead to the next magic
+    and counts the bytes it discarded.
+    """
+
+    def __init__(self) -> None:
+        self._buf = bytearray()
+        self.resync_bytes = 0
+
+    def feed(self, data: bytes) -> Iterator[Message]:
+        self._buf += data
+        while True:
+            msg = self._next()
+            if msg is None:
+                return
+            yield msg
+
+    def _next(self) -> Optional[Message]:
+        buf = self._buf
+        while len(buf) >= HEADER.size:
+            magic, version, mtype, flags, msg_seq, payload_len = HEADER.unpack_from(buf)
+            if magic != MAGIC or not version_ok(version) or payload_len > MAX_PAYLOAD:
+                skip = buf.find(struct.pack("<I", MAGIC), 1)
+                skip = len(buf) - 3 if skip < 0 else skip
+                del buf[:skip]
+                self.resync_bytes += skip
+                continue
+            end = HEADER.size + payload_len
+            if len(buf) < end:
+                return None
+            payload = bytes(buf[HEADER.size:end])
+            del buf[:end]
+            return Message(mtype, flags, msg_seq, payload)
+        return None
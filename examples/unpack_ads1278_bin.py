@@ -36,15 +36,17 @@ import argparse
 import os
 import struct
 import sys
-from typing import BinaryIO, TextIO
+from typing import BinaryIO, Iterator, TextIO
 
 
-# ads1278_dump record layout:
+# ads1278_dump v1 record layout (v2 files start with MAGIC_V2 and are read
+# through client/capture.py):
 #   uint64_t seq (LE)
 #   uint64_t tstamp_ns (LE)
 #   int32_t ch[8] (LE), sign-extended from 24-bit samples
 REC = struct.Struct("<QQ8i")
 CHANNELS = 8
+MAGIC_V2 = b"RPDQCAP2"
 
 
 def _default_out_path(in_path: str, fmt: str) -> str:
@@ -64,6 +66,31 @@ def _code_to_volts(code: int, vref: float) -> float:
     return (float(code) / float(1 << 23)) * float(vref)
 
 
+def _load_calib(path: str | None, vref: float) -> list[tuple[float, float]]:
+    """
+    Per-channel (gain, offset) from a calibration table, the format the server's
+    and ads1278_dump's --calib read: "channel gain offset" lines, channel 1-based,
+    '#' comments; volts = code / 2^23 * Vref * gain + offset. Unlisted channels
+    keep gain 1, offset 0.
+    """
+    calib = [(1.0, 0.0)] * CHANNELS
+    if path is None:
+        return calib
+    with open(path, "r", encoding="utf-8") as f:
+        for lineno, line in enumerate(f, 1):
+            fields = line.split("#", 1)[0].split()
+            if not fields:
+                continue
+            try:
+                ch, gain, offset = int(fields[0]), float(fields[1]), float(fields[2])
+            except (IndexError, ValueError):
+                raise RuntimeError(f"{path}:{lineno}: expected 'channel gain offset'") from None
+            if len(fields) != 3 or not 1 <= ch <= CHANNELS or gain == 0.0:
+                raise RuntimeError(f"{path}:{lineno}: expected 'channel gain offset'")
+            calib[ch - 1] = (gain, offset)
+    return calib
+
+
 def _write_header(out: TextIO, delim: str, to_volts: bool) -> None:
     cols = ["seq", "tstamp_ns"]
     if to_volts:
@@ -73,10 +100,7 @@ def _write_header(out: TextIO, delim: str, to_volts: bool) -> None:
     out.write(delim.join(cols) + "\n")
 
 
-def _unpack_stream(inp: BinaryIO, out: TextIO, *, fmt: str, to_volts: bool, vref: float) -> int:
-    delim = "\t" if fmt == "tsv" else ","
-    _write_header(out, delim, to_volts)
-
+def _v1_frames(inp: BinaryIO) -> Iterator[tuple[int, int, tuple[int, ...]]]:
     n = 0
     while True:
         chunk = inp.read(REC.size)
@@ -86,9 +110,29 @@ def _unpack_stream(inp: BinaryIO, out: TextIO, *, fmt: str, to_volts: bool, vref
             raise RuntimeError(f"Truncated record at byte {n * REC.size}: got {len(chunk)} bytes")
 
         seq, tstamp_ns, *ch = REC.unpack(chunk)
+        yield seq, tstamp_ns, tuple(ch)
+        n += 1
+
+
+def _v2_frames(path: str) -> Iterator[tuple[int, int, tuple[int, ...]]]:
+    sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "client"))
+    import capture
 
+    with capture.CaptureFile(path) as cf:
+        for idx in range(cf.chunk_count):
+            block = cf.read_chunk(idx)
+            yield from zip(block.seq, block.tstamp_ns, block.ch)
+
+
+def _unpack_stream(frames: Iterator[tuple[int, int, tuple[int, ...]]], out: TextIO, *, fmt: str,
+                   to_volts: bool, vref: float, calib: list[tuple[float, float]]) -> int:
+    delim = "\t" if fmt == "tsv" else ","
+    _write_header(out, delim, to_volts)
+
+    n = 0
+    for seq, tstamp_ns, ch in frames:
         if to_volts:
-            vals = [_code_to_volts(x, vref) for x in ch]
+            vals = [_code_to_volts(x, vref) * gain + offset for x, (gain, offset) in zip(ch, calib)]
             row = [str(seq), str(tstamp_ns)] + [f"{v:.12g}" for v in vals]
         else:
             row = [str(seq), str(tstamp_ns)] + [str(x) for x in ch]
@@ -127,13 +171,25 @@ def main(argv: list[str]) -> int:
         default=2.5,
         help="Reference voltage used for --to-volts conversion (default: 2.5)",
     )
+    p.add_argument(
+        "--calib",
+        default=None,
+        help="Per-channel 'channel gain offset' table applied on top of --vref (implies --to-volts)",
+    )
 
     args = p.parse_args(argv)
 
     out_path = args.output or _default_out_path(args.input, args.format)
+    calib = _load_calib(args.calib, args.vref)
 
     with open(args.input, "rb") as inp, open(out_path, "w", encoding="utf-8", newline="\n") as out:
-        n = _unpack_stream(inp, out, fmt=args.format, to_volts=args.to_volts, vref=args.vref)
+        if inp.read(len(MAGIC_V2)) == MAGIC_V2:
+            frames = _v2_frames(args.input)
+        else:
+            inp.seek(0)
+            frames = _v1_frames(inp)
+        n = _unpack_stream(frames, out, fmt=args.format, to_volts=args.to_volts or args.calib is not None,
+                           vref=args.vref, calib=calib)
 
     print(f"Wrote {n} record(s) to {out_path}")
     return 0
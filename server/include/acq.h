@@ -0,0 +1,104 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Miguel Dovale (University of Arizona)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef ACQ_H
+#define ACQ_H
+
+#include "acq_ring.h"
+#include "ads1278.h"
+#include "lat_hist.h"
+#include "rt.h"
+#include "shm_ring.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Acquisition thread: the only reader of its device once started; run one
+ * per device to acquire several ADCs in parallel.
+ * Frames go into an SPSC ring that one consumer thread drains in batches, so
+ * stdout/disk/network stalls in the consumer cannot delay DRDY servicing.
+ */
+typedef struct {
+    ads1278_dev_t *dev;         /* device to read (NULL = the one ads1278_open() opened) */
+    size_t ring_capacity;       /* frames, power of two (0 = default) */
+    uint64_t max_frames;        /* stop after N frames (0 = until acq_stop) */
+    rt_cfg_t rt;                /* applied by the thread to itself; zero = default scheduler */
+    shm_ring_writer_t *shm;     /* also publish every frame here (NULL = off); caller owns it */
+} acq_cfg_t;
+
+typedef struct {
+    uint64_t frames_read;       /* frames read from the device */
+    acq_ring_counters_t ring;
+    lat_hist_t latency;         /* DRDY edge to frame pushed (wakeup + transfer + parse) */
+    lat_hist_t ring_dwell;      /* frame pushed to released by the consumer */
+} acq_stats_t;
+
+typedef struct acq acq_t;
+
+int acq_create(acq_t **out, const acq_cfg_t *cfg);
+
+/*
+ * Spawn the acquisition thread and wait until it has applied cfg->rt. The
+ * device must already be open and started. RT settings that fail are not an error;
+ * see acq_get_rt_status().
+ */
+int acq_start(acq_t *acq);
+
+/* Request the thread to stop and join it (bounded by the DRDY timeout). */
+void acq_stop(acq_t *acq);
+void acq_destroy(acq_t *acq);
+
+/*
+ * Consumer side: pop up to max frames, waiting up to wait_ms for the first one.
+ * Returns 0 on timeout or once the thread has finished and the ring is empty.
+ */
+size_t acq_drain(acq_t *acq, ads1278_frame_t *out, size_t max, uint32_t wait_ms);
+
+acq_ring_t *acq_get_ring(acq_t *acq);
+
+/* Device the thread reads (cfg->dev, or the ads1278_open() device). */
+ads1278_dev_t *acq_get_dev(const acq_t *acq);
+
+/* True once the thread has exited (frame budget reached, stop, or error). */
+bool acq_is_done(const acq_t *acq);
+
+/* errno of the read failure that ended the thread, 0 if none. */
+int acq_get_error(const acq_t *acq);
+
+/* Safe from any thread while acquisition runs. */
+void acq_get_stats(const acq_t *acq, acq_stats_t *out);
+
+/* What the thread's RT profile actually got (valid after acq_start). */
+void acq_get_rt_status(const acq_t *acq, rt_status_t *out);
+
+#endif /* ACQ_H */
@@ -0,0 +1,113 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Miguel Dovale (University of Arizona)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef ACQ_RING_H
+#define ACQ_RING_H
+
+#include "ads1278.h"
+#include "lat_hist.h"
+
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define ACQ_CACHE_LINE_BYTES 64U
+#define ACQ_RING_DEFAULT_CAPACITY 4096U
+
+/*
+ * Lock-free single-producer/single-consumer ring of ads1278_frame_t.
+ *
+ * Exactly one thread may push (the acquisition thread) and exactly one thread
+ * may pop. head/tail are free-running 64-bit counters; capacity is a power of
+ * two so the slot index is a mask. Producer and consumer state live on
+ * separate cache lines, and each side keeps a cached copy of the other's
+ * cursor so the shared line is only touched when the cached view runs out.
+ *
+ * A full ring never blocks the producer: the new frame is dropped and counted
+ * in `overflows`, so acquisition timing is never coupled to the consumer.
+ *
+ * Each slot also keeps its push time; each acq_ring_release() records how long
+ * the oldest frame it retires sat in the ring (push to release) in a dwell
+ * histogram, one sample per release rather than per frame.
+ */
+typedef struct {
+    /* producer-owned */
+    alignas(ACQ_CACHE_LINE_BYTES) _Atomic uint64_t head;
+    uint64_t cached_tail;
+    _Atomic uint64_t pushed;
+    _Atomic uint64_t overflows;
+
+    /* consumer-owned */
+    alignas(ACQ_CACHE_LINE_BYTES) _Atomic uint64_t tail;
+    uint64_t cached_head;
+    _Atomic uint64_t high_water;
+    lat_recorder_t dwell;
+
+    /* immutable after init */
+    alignas(ACQ_CACHE_LINE_BYTES) ads1278_frame_t *slots;
+    uint64_t *push_ns;
+    uint64_t mask;
+} acq_ring_t;
+
+typedef struct {
+    uint64_t capacity;
+    uint64_t occupancy;
+    uint64_t pushed;            /* frames accepted into the ring */
+    uint64_t overflows;         /* frames dropped because the ring was full */
+    uint64_t high_water;        /* maximum backlog observed by the consumer */
+} acq_ring_counters_t;
+
+int acq_ring_init(acq_ring_t *ring, size_t capacity);
+void acq_ring_destroy(acq_ring_t *ring);
+
+/*
+ * Producer side. Returns false (and counts an overflow) when the ring is full.
+ * push_ns is CLOCK_MONOTONIC now (0 = leave the frame out of the dwell histogram).
+ */
+bool acq_ring_push(acq_ring_t *ring, const ads1278_frame_t *frame, uint64_t push_ns);
+
+/* Consumer side: copy out up to max frames. */
+size_t acq_ring_pop_batch(acq_ring_t *ring, ads1278_frame_t *out, size_t max);
+
+/*
+ * Consumer side, zero-copy: expose up to max readable frames as one contiguous
+ * span (it stops at the wrap point), then retire them with acq_ring_release().
+ */
+size_t acq_ring_peek(acq_ring_t *ring, const ads1278_frame_t **first, size_t max);
+void acq_ring_release(acq_ring_t *ring, size_t count);
+
+/* Safe from any thread; values are a relaxed snapshot. */
+void acq_ring_get_counters(const acq_ring_t *ring, acq_ring_counters_t *out);
+void acq_ring_get_dwell(const acq_ring_t *ring, lat_hist_t *out);
+
+#endif /* ACQ_RING_H */
@@ -32,13 +32,57 @@
 #ifndef ADS1278_H
 #define ADS1278_H
 
+#include "lat_hist.h"
+
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 #define ADS1278_CHANNEL_COUNT 8U
 #define ADS1278_TDM_FRAME_BYTES 24U
+
+/*
+ * Longest daisy chain (DOUT of device k+1 into DIN of device k) a frame can
+ * hold. Frames carry ADS1278_MAX_CHANNELS samples, so the default single-ADC
+ * build keeps them at 48 bytes; make MAX_CHAIN=N for chained devices.
+ */
+#ifndef ADS1278_MAX_CHAIN
+#define ADS1278_MAX_CHAIN 1U
+#endif
+#define ADS1278_MAX_CHANNELS (ADS1278_CHANNEL_COUNT * ADS1278_MAX_CHAIN)
+#define ADS1278_MAX_FRAME_BYTES (ADS1278_TDM_FRAME_BYTES * ADS1278_MAX_CHAIN)
 #define ADS1278_DEFAULT_SPIDEV "/dev/spidev2.0"
 #define ADS1278_DEFAULT_DRDY_TIMEOUT_MS 2000U
+#define ADS1278_NO_TIMEOUT UINT32_MAX   /* drdy_timeout_ms / edge wait: block until the edge */
+#define ADS1278_SIM_DEFAULT_RATE_HZ 1000U
+#define ADS1278_SAMPLE_MAX 0x7FFFFF
+#define ADS1278_SAMPLE_MIN (-0x800000)
+
+typedef enum {
+    ADS1278_BACKEND_SPIDEV = 0, /* spidev SPI + sysfs GPIO (hardware) */
+    ADS1278_BACKEND_SIM         /* synthetic frame source, no hardware */
+} ads1278_backend_id_t;
+
+typedef enum {
+    ADS1278_SIM_SIGNAL_ZERO = 0,
+    ADS1278_SIM_SIGNAL_RAMP,    /* per-channel counter, slope = channel + 1 */
+    ADS1278_SIM_SIGNAL_SINE,
+    ADS1278_SIM_SIGNAL_SQUARE,
+    ADS1278_SIM_SIGNAL_NOISE    /* uniform white noise within +/- amplitude */
+} ads1278_sim_signal_t;
+
+typedef struct {
+    uint32_t drdy_rate_hz;      /* synthetic DRDY rate; 0 = free-running */
+                                /* (ignored when drdy_gpiochip supplies real edges) */
+    ads1278_sim_signal_t signal;
+    uint32_t amplitude;         /* peak code (0 = half scale) */
+    double signal_hz;           /* sine/square frequency (0 = rate / 100) */
+    uint32_t jitter_ns;         /* uniform +/- jitter applied to each DRDY edge */
+    uint32_t xfer_delay_us;     /* injected SPI transfer delay */
+    uint32_t xfer_delay_every;  /* inject delay every N transfers (0 = never) */
+    uint32_t seed;              /* noise/jitter PRNG seed (0 = fixed default) */
+    bool busy_wait;             /* spin for edges instead of sleeping (high rates) */
+} ads1278_sim_cfg_t;
 
 typedef struct {
     const char *spidev_path;    /* e.g. "/dev/spidev2.0" */
@@ -46,28 +90,183 @@ typedef struct {
     uint8_t spi_mode;           /* default 0 */
     bool spi_no_cs;             /* true (ADS1278 has no CS pin) */
 
-    /* DRDY (sysfs global GPIO number) */
+    /*
+     * DRDY: sysfs global GPIO number, or a line offset on drdy_gpiochip.
+     * A non-NULL chip (e.g. "/dev/gpiochip0") selects the GPIO character
+     * device, which provides kernel edge timestamps and missed-edge counts.
+     */
     uint32_t drdy_gpio_number;
+    const char *drdy_gpiochip;
 
-    /* SYNC (optional, sysfs global GPIO number) */
+    /* SYNC (optional): sysfs global GPIO number, or offset on sync_gpiochip. */
     uint32_t sync_gpio_number;
+    const char *sync_gpiochip;
     bool use_sync;              /* recommended true for deterministic startup */
     uint32_t settle_frames;     /* discard N frames after SYNC pulse */
 
-    /* Optional guard to avoid indefinite waits. */
+    /*
+     * Optional guard to avoid indefinite waits, 0 = ADS1278_DEFAULT_DRDY_TIMEOUT_MS.
+     * ADS1278_NO_TIMEOUT lets the cdev DRDY wait be one blocking read() per edge.
+     */
     uint32_t drdy_timeout_ms;
+
+    /*
+     * Daisy-chained ADS1278s sharing SCLK and DRDY, 0/1 = a single device.
+     * Each DRDY is read as one chain_length * 24-byte transfer; channel
+     * d * 8 + c is channel c of device d, device 0 being the one wired to MISO.
+     */
+    uint32_t chain_length;
+
+    /*
+     * Replace each DRDY edge time with the clock model's (clock_model.h) once
+     * it locks: the conversion grid without wakeup jitter. The model runs,
+     * and its stats are reported, either way.
+     */
+    bool smooth_tstamps;
+
+    /* Frame source; zero-initialized config selects the hardware backend. */
+    ads1278_backend_id_t backend;
+    ads1278_sim_cfg_t sim;      /* used when backend == ADS1278_BACKEND_SIM */
 } ads1278_cfg_t;
 
+/*
+ * seq is the inferred conversion index since ads1278_start(): it jumps where
+ * conversions were missed (see ads1278_stats_t.missed_conversions).
+ * ch[] holds the device's channel count (8 per chained ADC); the rest is
+ * unspecified. The first 48 bytes are a v1 capture record.
+ */
 typedef struct {
     uint64_t seq;
     uint64_t tstamp_ns;         /* CLOCK_MONOTONIC timestamp */
-    int32_t ch[ADS1278_CHANNEL_COUNT];
+    int32_t ch[ADS1278_MAX_CHANNELS];
 } ads1278_frame_t;
 
+/*
+ * Structure-of-arrays block of consecutive frames: ch[c][i] is channel c of
+ * frame i, each channel contiguous and 64-byte aligned. Blocks come from an
+ * ads1278_block_pool_t and are reused; never allocate them per read.
+ */
+typedef struct {
+    uint64_t seq0;              /* seq of frame 0 */
+    size_t count;               /* valid frames */
+    size_t capacity;            /* frames the arrays can hold */
+    uint64_t *seq;              /* [capacity] per frame; consecutive unless conversions were missed */
+    uint64_t *tstamp_ns;        /* [capacity] CLOCK_MONOTONIC per frame */
+    uint32_t channel_count;     /* channels read into ch[] */
+    int32_t *ch[ADS1278_MAX_CHANNELS]; /* [capacity] each, channel-major */
+    uint8_t *raw;               /* [capacity * ADS1278_MAX_FRAME_BYTES] TDM bytes, device-major */
+} ads1278_block_t;
+
+typedef struct ads1278_block_pool ads1278_block_pool_t;
+
+/* Preallocate block_count blocks of frames_per_block frames each. */
+int ads1278_block_pool_create(ads1278_block_pool_t **out, size_t block_count, size_t frames_per_block);
+void ads1278_block_pool_destroy(ads1278_block_pool_t *pool);
+
+/* Thread-safe; acquire returns NULL (errno = EAGAIN) when all blocks are in use. */
+ads1278_block_t *ads1278_block_acquire(ads1278_block_pool_t *pool);
+void ads1278_block_release(ads1278_block_pool_t *pool, ads1278_block_t *blk);
+
+/*
+ * One ADS1278 behind its own backend instance (SPI device, GPIO lines or sim
+ * state). Devices are independent: several can be open at once, each read
+ * by its own thread. A device is read by one thread at a time; the getters
+ * are safe from any thread while it runs.
+ */
+typedef struct ads1278_dev ads1278_dev_t;
+
+const char *ads1278_backend_name(ads1278_backend_id_t backend);
+
+/*
+ * Read-path counters and per-stage latency since the device was opened.
+ * Recorded by whichever thread reads frames; safe to read from any other
+ * thread meanwhile.
+ */
+typedef struct {
+    uint64_t frames;            /* frames read */
+    uint64_t drdy_timeouts;     /* DRDY waits that hit drdy_timeout_ms */
+    uint64_t missed_drdy;       /* as ads1278_get_missed_drdy() */
+    uint64_t overlong_xfers;    /* as ads1278_get_overlong_xfers() */
+    uint64_t missed_conversions; /* seq jumps: conversions between frames that were never read */
+    uint64_t gap_events;        /* frames that followed at least one missed conversion */
+    uint64_t longest_gap;       /* most conversions missed in one gap */
+    uint64_t ambiguous_intervals; /* frames too far off the period grid to place reliably */
+    double drdy_period_ns;      /* fitted DRDY period, 0 = not locked (only reported edges jump seq) */
+    double tstamp_jitter_ns;    /* std dev of edge times about the clock model, 0 = not locked */
+    uint64_t tstamp_jitter_max_ns; /* largest edge time distance from the clock model */
+    double clock_drift_ppm;     /* clock model rate vs nominal (sim) or vs the rate at lock */
+    uint64_t clock_outliers;    /* clock model points rejected as off the line */
+    uint64_t clock_relocks;     /* clock model locks dropped (timestamp steps) */
+    lat_hist_t drdy_wakeup;     /* DRDY edge to the DRDY wait returning */
+    lat_hist_t spi_xfer;        /* SPI transfer (spidev ioctl) */
+    lat_hist_t parse;           /* 24-bit unpack per frame (block reads: block average) */
+} ads1278_stats_t;
+
+/* cfg strings (paths, chip names) must outlive the device. */
+int ads1278_dev_open(ads1278_dev_t **out, const ads1278_cfg_t *cfg);
+
+/* Pulse SYNC (when configured) and discard settle_frames. */
+int ads1278_dev_start(ads1278_dev_t *dev);
+int ads1278_dev_read_frame(ads1278_dev_t *dev, ads1278_frame_t *out);
+
+/*
+ * Read n frames (n <= blk->capacity) into blk. Raw TDM bytes are staged in
+ * blk->raw and decoded channel-major in one pass after the last transfer.
+ * On failure blk->count holds the frames read (and decoded) before the error.
+ */
+int ads1278_dev_read_frames(ads1278_dev_t *dev, ads1278_block_t *blk, size_t n);
+
+/* Raw bytes of the last transfer: 3 per channel, device 0 first. */
+int ads1278_dev_get_last_raw_frame(const ads1278_dev_t *dev, uint8_t out[ADS1278_MAX_FRAME_BYTES]);
+
+/* 8 * chain length. */
+uint32_t ads1278_dev_channel_count(const ads1278_dev_t *dev);
+
+/*
+ * DRDY edges that occurred but were never read out since the device was
+ * opened. Exact with the GPIO character device (kernel sequence gaps and
+ * queued edges) and the sim backend; always 0 with sysfs GPIO.
+ */
+uint64_t ads1278_dev_get_missed_drdy(const ads1278_dev_t *dev);
+
+/* Frames whose DRDY-edge-to-transfer-done time exceeded 5 ms (overrun risk). */
+uint64_t ads1278_dev_get_overlong_xfers(const ads1278_dev_t *dev);
+int ads1278_dev_get_stats(const ads1278_dev_t *dev, ads1278_stats_t *out);
+
+/* Effective configuration (defaults filled in). */
+const ads1278_cfg_t *ads1278_dev_get_cfg(const ads1278_dev_t *dev);
+void ads1278_dev_stop(ads1278_dev_t *dev);
+void ads1278_dev_close(ads1278_dev_t *dev);
+
+/*
+ * Falling edges on a spare input line (an external trigger, a PPS), with the
+ * same endpoints as DRDY: NULL gpiochip = sysfs GPIO number, otherwise a
+ * line offset on that character device (kernel CLOCK_MONOTONIC edge times).
+ */
+typedef struct ads1278_edge ads1278_edge_t;
+
+int ads1278_edge_open(ads1278_edge_t **out, const char *gpiochip, uint32_t line);
+
+/* 0 with *edge_ns set; -1 with ETIMEDOUT after timeout_ms (unless ADS1278_NO_TIMEOUT), or another errno. */
+int ads1278_edge_wait(ads1278_edge_t *edge, uint32_t timeout_ms, uint64_t *edge_ns);
+void ads1278_edge_close(ads1278_edge_t *edge);
+
+/*
+ * Single-device API: the same calls on one process-wide device. A second
+ * ads1278_open() fails with EALREADY until ads1278_close().
+ */
 int ads1278_open(const ads1278_cfg_t *cfg);
+
+/* The device ads1278_open() opened, NULL when closed. */
+ads1278_dev_t *ads1278_get_dev(void);
 int ads1278_start(void);
 int ads1278_read_frame(ads1278_frame_t *out);
-int ads1278_get_last_raw_frame(uint8_t out[ADS1278_TDM_FRAME_BYTES]);
+int ads1278_read_frames(ads1278_block_t *blk, size_t n);
+int ads1278_get_last_raw_frame(uint8_t out[ADS1278_MAX_FRAME_BYTES]);
+uint32_t ads1278_get_channel_count(void);
+uint64_t ads1278_get_missed_drdy(void);
+uint64_t ads1278_get_overlong_xfers(void);
+int ads1278_get_stats(ads1278_stats_t *out);
 void ads1278_stop(void);
 void ads1278_close(void);
 
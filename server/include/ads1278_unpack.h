@@ -0,0 +1,74 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Miguel Dovale (University of Arizona)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef ADS1278_UNPACK_H
+#define ADS1278_UNPACK_H
+
+#include "ads1278.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Bulk decode of raw MSB-first 24-byte TDM frames into sign-extended int32.
+ *
+ * Implementations: a scalar reference plus SSSE3/AVX2 (x86, selected at run
+ * time from CPUID) and NEON (ARM, selected at compile time: build with
+ * -mfpu=neon on 32-bit ARM). All variants are bit-exact with the reference.
+ * The fastest available one is active by default.
+ */
+typedef enum {
+    ADS1278_UNPACK_SCALAR = 0,
+    ADS1278_UNPACK_SSSE3,
+    ADS1278_UNPACK_AVX2,
+    ADS1278_UNPACK_NEON,
+    ADS1278_UNPACK_IMPL_COUNT
+} ads1278_unpack_impl_t;
+
+/* Interleaved output: out[i * ADS1278_CHANNEL_COUNT + c]. */
+void ads1278_unpack_frames(const uint8_t *raw, size_t nframes, int32_t *out);
+
+/* Channel-major output: ch[c][i]. */
+void ads1278_unpack_frames_soa(const uint8_t *raw, size_t nframes, int32_t *const ch[ADS1278_CHANNEL_COUNT]);
+
+/* Scalar reference implementations, always available. */
+void ads1278_unpack_frames_ref(const uint8_t *raw, size_t nframes, int32_t *out);
+void ads1278_unpack_frames_soa_ref(const uint8_t *raw, size_t nframes, int32_t *const ch[ADS1278_CHANNEL_COUNT]);
+
+bool ads1278_unpack_available(ads1278_unpack_impl_t impl);
+
+/* Switch the active implementation (process-wide); ENOTSUP if unavailable. */
+int ads1278_unpack_select(ads1278_unpack_impl_t impl);
+ads1278_unpack_impl_t ads1278_unpack_active(void);
+const char *ads1278_unpack_impl_name(ads1278_unpack_impl_t impl);
+
+#endif /* ADS1278_UNPACK_H */
@@ -0,0 +1,162 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Miguel Dovale (University of Arizona)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CAPTURE_FILE_H
+#define CAPTURE_FILE_H
+
+#include "ads1278.h"
+#include "capture_writer.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Capture file v2 (docs/ads1278_output.md): a 256-byte header (acquisition
+ * settings, channel layout, CLOCK_MONOTONIC/CLOCK_REALTIME anchor), chunks
+ * that are stream-protocol DATA messages of up to chunk_frames frames, and a
+ * trailing index of one entry per chunk. The header's index_offset is written
+ * last, at close; a file without it (writer killed) is still readable and the
+ * reader rebuilds the index by walking the chunks.
+ *
+ * The reader also opens v1 files (headerless 48-byte records) and seeks in
+ * both by binary search on tstamp_ns, which must not decrease.
+ */
+#define CAPTURE_FILE_MAGIC "RPDQCAP2"
+#define CAPTURE_FILE_VERSION 2U
+#define CAPTURE_FILE_HEADER_BYTES 256U
+#define CAPTURE_FILE_INDEX_ENTRY_BYTES 40U
+#define CAPTURE_FILE_DEFAULT_CHUNK_FRAMES 4096U
+#define CAPTURE_FILE_NAME_BYTES 32U
+#define CAPTURE_FILE_NO_LINE UINT32_MAX
+
+/* Acquisition settings recorded in the header. */
+typedef struct {
+    uint32_t backend;           /* ads1278_backend_id_t */
+    uint32_t sample_rate_hz;    /* nominal DRDY rate, 0 = unknown/free-running */
+    uint32_t sclk_hz;
+    uint32_t spi_mode;
+    uint32_t settle_frames;
+    uint32_t drdy_timeout_ms;
+    uint32_t drdy_line;         /* sysfs number or chip offset */
+    uint32_t sync_line;         /* CAPTURE_FILE_NO_LINE without SYNC */
+    char drdy_chip[CAPTURE_FILE_NAME_BYTES]; /* "" = sysfs */
+    char sync_chip[CAPTURE_FILE_NAME_BYTES];
+    char writer[CAPTURE_FILE_NAME_BYTES];    /* producing tool */
+    uint32_t decimation;        /* frames are 1-in-N decimator outputs, 0/1 = raw */
+} capture_file_acq_t;
+
+typedef struct {
+    uint16_t version;           /* 1 or 2 */
+    uint16_t encoding;          /* chunk PROTO_DATA_ENC_* (v1: RECORD48) */
+    uint16_t channel_count;     /* 8 per chained device, or those --decim selects */
+    uint16_t sample_bits;
+    uint8_t channel_slot[ADS1278_CHANNEL_COUNT]; /* TDM slot of ch[c] within each device */
+    uint32_t chunk_frames;
+    uint64_t anchor_monotonic_ns; /* CLOCK_MONOTONIC and CLOCK_REALTIME read together; */
+    uint64_t anchor_realtime_ns;  /* 0 in v1 */
+    uint64_t frame_count;
+    uint64_t chunk_count;
+    uint64_t missed_frames;     /* seq values skipped between consecutive frames (written at close) */
+    uint64_t gap_count;         /* seq jumps */
+    bool indexed;               /* trailing index present (false: rebuilt on open) */
+    capture_file_acq_t acq;     /* zero in v1 */
+} capture_file_info_t;
+
+typedef struct {
+    uint64_t first_seq;
+    uint64_t first_tstamp_ns;
+    uint64_t offset;            /* file offset of the chunk's DATA message */
+    uint64_t first_frame;       /* position of its first frame in the file */
+    uint32_t frame_count;
+    uint32_t bytes;             /* DATA message size, header included */
+} capture_file_chunk_t;
+
+typedef struct {
+    capture_writer_cfg_t writer;
+    uint16_t encoding;          /* chunk encoding, 0 = RECORD48 */
+    uint32_t chunk_frames;      /* 0 = CAPTURE_FILE_DEFAULT_CHUNK_FRAMES */
+    uint16_t channel_count;     /* 0 = 8; ads1278_dev_channel_count() for a chain */
+    bool linear_ts;             /* P24/DELTA: base + last timestamps for chunks on a line */
+    uint32_t linear_tolerance_ns; /* as proto_data_encoder_t (0 = exact lines only) */
+    capture_file_acq_t acq;
+} capture_file_cfg_t;
+
+typedef struct capture_file_writer capture_file_writer_t;
+typedef struct capture_file capture_file_t;
+
+/* Create the file and write the header; the time anchor is taken here. */
+int capture_file_create(capture_file_writer_t **out, const char *path, const capture_file_cfg_t *cfg);
+
+/* Append frames; a chunk is written whenever one fills (or a frame cannot join it). */
+int capture_file_append(capture_file_writer_t *cf, const ads1278_frame_t *frames, size_t n);
+
+/*
+ * Close the open chunk early and checkpoint the writer, so a reader of the
+ * unfinalized file (crash, power cut) finds every frame appended so far.
+ */
+int capture_file_checkpoint(capture_file_writer_t *cf);
+
+/* Bytes handed to the writer so far: header and complete chunks. */
+uint64_t capture_file_bytes(const capture_file_writer_t *cf);
+
+/*
+ * Write the last chunk and the index, then fill in the header and close the
+ * underlying capture writer. stats may be NULL; the writer is released either way.
+ */
+int capture_file_finish(capture_file_writer_t *cf, capture_writer_stats_t *stats, capture_file_info_t *info);
+
+/*
+ * Finalize a v2 file whose writer never finished (crash, power cut): cut it
+ * after its last whole chunk, append the rebuilt index and rewrite the header
+ * (index offset, counts, seq gaps), as capture_file_finish() would have.
+ * Finished and v1 files are left alone. info receives the resulting header.
+ */
+int capture_file_repair(const char *path, capture_file_info_t *info);
+
+/* mmap a v1 or v2 file; the cursor starts at frame 0. */
+int capture_file_open(capture_file_t **out, const char *path);
+void capture_file_close(capture_file_t *cf);
+const capture_file_info_t *capture_file_get_info(const capture_file_t *cf);
+int capture_file_get_chunk(const capture_file_t *cf, uint64_t idx, capture_file_chunk_t *out);
+
+/* Move the cursor to the first frame with tstamp_ns >= tstamp_ns (or to the end). */
+int capture_file_seek_time(capture_file_t *cf, uint64_t tstamp_ns);
+int capture_file_seek_frame(capture_file_t *cf, uint64_t frame);
+uint64_t capture_file_tell(const capture_file_t *cf);
+
+/* Read up to n frames at the cursor; returns the count (0 at the end), -1 on a corrupt chunk. */
+long capture_file_read(capture_file_t *cf, ads1278_frame_t *out, size_t n);
+
+/* Wall-clock time (CLOCK_REALTIME ns) of a frame timestamp; 0 without an anchor. */
+uint64_t capture_file_wall_ns(const capture_file_t *cf, uint64_t tstamp_ns);
+
+#endif /* CAPTURE_FILE_H */
@@ -0,0 +1,113 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Miguel Dovale (University of Arizona)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CAPTURE_SEGMENTS_H
+#define CAPTURE_SEGMENTS_H
+
+#include "ads1278.h"
+#include "capture_file.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Long-running recorder: frames go to a directory of v2 capture files
+ * (capture_file.h) named <prefix>-NNNNNN.bin. The open segment is
+ * <name>.part; it rotates once it holds segment_bytes or its frames span
+ * segment_ms, is finished (index, header, fsync) and renamed to <name> by a
+ * background thread, followed by an fsync of the directory. That thread
+ * also prepares the next segment (create, preallocate, touch its blocks),
+ * so a rotation on the append path is a pointer swap. At most two segment
+ * writers exist at once, so memory stays at twice the writer blocks.
+ *
+ * Every checkpoint_ms the open chunk and partial block are written and
+ * fdatasync()ed; a reader of a .part left by a crash rebuilds its index
+ * from the chunks (capture_file_open()). capture_seg_open() renames such
+ * leftovers to their final name, trimmed after the last whole chunk, and
+ * deletes ones without frames.
+ *
+ * With a quota, the oldest finished segments are deleted until they fit in
+ * quota_bytes with room for the open and the prepared segment.
+ */
+#define CAPTURE_SEG_DEFAULT_PREFIX "capture"
+#define CAPTURE_SEG_DEFAULT_CHECKPOINT_MS 1000U
+#define CAPTURE_SEG_SUFFIX ".bin"
+#define CAPTURE_SEG_PART_SUFFIX ".part"
+
+typedef struct {
+    const char *dir;
+    const char *prefix;         /* NULL = CAPTURE_SEG_DEFAULT_PREFIX */
+    capture_file_cfg_t file;    /* per segment; writer.prealloc_bytes 0 = segment_bytes */
+    uint64_t segment_bytes;     /* rotate at this size (0 = no size limit) */
+    uint32_t segment_ms;        /* rotate when a segment's frames span this long (0 = no limit) */
+    uint64_t quota_bytes;       /* 0 = keep everything; else at least 3 x segment_bytes */
+    uint32_t checkpoint_ms;     /* 0 = CAPTURE_SEG_DEFAULT_CHECKPOINT_MS */
+} capture_seg_cfg_t;
+
+typedef struct {
+    uint64_t frames;
+    uint64_t bytes_written;     /* all segments, headers and indexes included */
+    uint64_t segments;          /* finished and renamed by this recorder */
+    uint64_t recovered;         /* .part files from an earlier run renamed at open */
+    uint64_t deleted;           /* segments removed for the quota */
+    uint64_t deleted_bytes;
+    uint64_t kept_segments;     /* finished segments on disk at close */
+    uint64_t kept_bytes;
+    uint64_t missed_frames;     /* seq values skipped between appended frames (lost upstream) */
+    uint64_t gap_count;
+    uint64_t checkpoints;
+    uint64_t elapsed_ns;        /* open to close */
+    uint64_t append_ns_max;     /* longest capture_seg_append(): the worst stall the caller saw */
+    uint64_t producer_stalls;   /* waits for a free writer block */
+    uint64_t rotate_waits;      /* rotations that waited for the prepared segment */
+    uint64_t rotate_wait_ns_max;
+    uint64_t write_ns_max;      /* worst of the segment writers' stats */
+    uint64_t fsync_ns_max;
+    uint64_t finish_ns_max;     /* slowest background finish + rename */
+} capture_seg_stats_t;
+
+typedef struct capture_seg capture_seg_t;
+
+/* Create the directory if needed, recover leftovers and prepare the first segment. */
+int capture_seg_open(capture_seg_t **out, const capture_seg_cfg_t *cfg);
+
+/* Append frames, rotating and checkpointing as configured. Fails once any segment failed. */
+int capture_seg_append(capture_seg_t *seg, const ads1278_frame_t *frames, size_t n);
+
+/*
+ * Finish and rename the open segment (an empty one is removed), stop the
+ * background thread and free everything. stats may be NULL. Returns -1 if
+ * any segment failed; the recorder is released either way.
+ */
+int capture_seg_close(capture_seg_t *seg, capture_seg_stats_t *stats);
+
+#endif /* CAPTURE_SEGMENTS_H */
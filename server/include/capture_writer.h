@@ -0,0 +1,118 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Miguel Dovale (University of Arizona)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CAPTURE_WRITER_H
+#define CAPTURE_WRITER_H
+
+#include "ads1278.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Buffered capture writer. Callers append bytes or v1 frame records into a
+ * fixed set of large aligned blocks allocated at open; a background thread
+ * pwrite()s full blocks, so the consumer thread never blocks on the disk
+ * unless every block is already queued (counted as a producer stall).
+ * With io_uring the thread writes every queued block with one
+ * io_uring_enter(), from blocks registered once at open (uring.h).
+ */
+#define CAPTURE_WRITER_DEFAULT_BLOCK_BYTES (1024U * 1024U)
+#define CAPTURE_WRITER_DEFAULT_BLOCK_COUNT 8U
+#define CAPTURE_RECORD_V1_BYTES 48U
+
+typedef enum {
+    CAPTURE_FSYNC_NONE = 0,     /* leave write-back to the kernel */
+    CAPTURE_FSYNC_CLOSE,        /* fsync once at close */
+    CAPTURE_FSYNC_BLOCK,        /* fsync after every block */
+    CAPTURE_FSYNC_INTERVAL      /* fsync after a block once fsync_interval_ms has elapsed */
+} capture_fsync_policy_t;
+
+typedef struct {
+    size_t block_bytes;         /* 0 = CAPTURE_WRITER_DEFAULT_BLOCK_BYTES, multiple of 4096 */
+    uint32_t block_count;       /* 0 = CAPTURE_WRITER_DEFAULT_BLOCK_COUNT, at least 2 */
+    uint64_t prealloc_bytes;    /* posix_fallocate() up front; trimmed at close (0 = off) */
+    capture_fsync_policy_t fsync_policy;
+    uint32_t fsync_interval_ms;
+    bool io_uring;              /* batch block writes through io_uring when the kernel has it */
+} capture_writer_cfg_t;
+
+typedef struct {
+    uint64_t bytes_written;
+    uint64_t blocks_written;
+    uint64_t fsyncs;
+    uint64_t elapsed_ns;        /* open to close */
+    uint64_t write_ns_max;      /* slowest block write (pwrite loop) or io_uring batch */
+    uint64_t write_calls;       /* pwrite() or io_uring_enter() calls */
+    bool io_uring;              /* cfg.io_uring was requested and available */
+    bool io_uring_fixed;        /* blocks are registered buffers (else plain io_uring writes) */
+    uint64_t fsync_ns_max;      /* fsync() or checkpoint fdatasync() */
+    uint64_t checkpoints;       /* capture_writer_checkpoint() syncs done (also counted in fsyncs) */
+    uint64_t producer_stalls;   /* appends that waited for a free block */
+    uint64_t producer_stall_ns_max;
+} capture_writer_stats_t;
+
+typedef struct capture_writer capture_writer_t;
+
+int capture_writer_open(capture_writer_t **out, const char *path, const capture_writer_cfg_t *cfg);
+
+/* Append raw bytes. Fails with the writer thread's errno once a write has failed. */
+int capture_writer_write(capture_writer_t *writer, const void *data, size_t len);
+
+/* Append frames as 48-byte little-endian v1 records (docs/ads1278_output.md): ch[0..7] only. */
+int capture_writer_append_frames(capture_writer_t *writer, const ads1278_frame_t *frames, size_t n);
+
+/*
+ * Durable checkpoint: queue the partly filled block now and have the writer
+ * thread fdatasync() the file once everything queued so far is written.
+ * Waits for a free block like a full one (a producer stall).
+ */
+int capture_writer_checkpoint(capture_writer_t *writer);
+
+/*
+ * Have close() overwrite the first len bytes of the file with data once every
+ * block is on disk and before the close fsync; for headers whose fields are
+ * only known at the end. Replaces any earlier call.
+ */
+int capture_writer_rewrite_head(capture_writer_t *writer, const void *data, size_t len);
+
+/*
+ * Flush the partial block, join the writer thread, apply a pending head
+ * rewrite, trim preallocation, apply the close fsync policy and free
+ * everything. stats may be NULL. Returns -1 if any write failed; the writer
+ * is released either way.
+ */
+int capture_writer_close(capture_writer_t *writer, capture_writer_stats_t *stats);
+
+const char *capture_fsync_policy_name(capture_fsync_policy_t policy);
+
+#endif /* CAPTURE_WRITER_H */
@@ -0,0 +1,137 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Miguel Dovale (University of Arizona)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef CHAN_STATS_H
+#define CHAN_STATS_H
+
+#include "ads1278.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Per-channel running statistics (min, max, mean, RMS, standard deviation)
+ * over a window that the caller resets, e.g. once per summary period, and
+ * over the whole stream.
+ *
+ * Samples are accumulated exactly in integers relative to a per-channel
+ * shift (the running mean, rounded, updated every CHAN_STATS_BLOCK_FRAMES
+ * frames), so a large DC offset does not cost precision; each block is then
+ * merged into double mean/M2 accumulators with the parallel Welford update.
+ * Input must be 24-bit sample codes, as the HAL and decimator produce.
+ *
+ * Calibration maps codes to volts per channel, volts = code * scale + offset
+ * in float32. Both kernels have a scalar reference plus SSE4.1/AVX2 (x86,
+ * chosen at run time) and NEON (compile time) variants, all bit-exact with
+ * the reference; the fastest available one is active by default.
+ */
+#define CHAN_STATS_BLOCK_FRAMES 4096U
+#define CHAN_CALIB_FULL_SCALE 8388608.0    /* 2^23: code of +vref */
+#define CHAN_CALIB_DEFAULT_VREF 2.5
+
+typedef enum {
+    CHAN_STATS_SCALAR = 0,
+    CHAN_STATS_SSE41,
+    CHAN_STATS_AVX2,
+    CHAN_STATS_NEON,
+    CHAN_STATS_IMPL_COUNT
+} chan_stats_impl_t;
+
+typedef struct {
+    double min;
+    double max;
+    double mean;
+    double rms;                 /* sqrt(mean(x^2)) */
+    double stddev;              /* population */
+} chan_stats_channel_t;
+
+typedef struct {
+    uint64_t frames;            /* 0 = empty window, channel values are 0 */
+    uint64_t first_seq;
+    uint64_t last_seq;
+    uint64_t first_tstamp_ns;
+    uint64_t last_tstamp_ns;
+    uint32_t channel_count;
+    bool volts;                 /* values converted by chan_calib_summary() */
+    chan_stats_channel_t ch[ADS1278_MAX_CHANNELS];
+} chan_stats_summary_t;
+
+typedef struct {
+    uint32_t channel_count;
+    float scale[ADS1278_MAX_CHANNELS];  /* volts per code */
+    float offset[ADS1278_MAX_CHANNELS]; /* volts */
+} chan_calib_t;
+
+typedef struct chan_stats chan_stats_t;
+
+/* channel_count 0 = 8, at most ADS1278_MAX_CHANNELS. */
+int chan_stats_create(chan_stats_t **out, uint32_t channel_count);
+void chan_stats_destroy(chan_stats_t *st);
+
+void chan_stats_update(chan_stats_t *st, const ads1278_frame_t *frames, size_t n);
+
+/* Statistics since the last window reset; reset starts the next window. */
+void chan_stats_window(chan_stats_t *st, chan_stats_summary_t *out, bool reset);
+
+/* Statistics since creation or chan_stats_reset(). */
+void chan_stats_total(chan_stats_t *st, chan_stats_summary_t *out);
+void chan_stats_reset(chan_stats_t *st);
+
+/* Ideal transfer function for every channel: scale = vref / 2^23, offset 0. */
+void chan_calib_init(chan_calib_t *cal, uint32_t channel_count, double vref);
+
+/*
+ * chan_calib_init(), then apply a per-channel table. Each line is "channel
+ * gain offset" (channel 1-based; volts = code * vref / 2^23 * gain + offset);
+ * '#' starts a comment and unlisted channels keep gain 1, offset 0. Returns
+ * -1 with errno (EINVAL on a malformed line).
+ */
+int chan_calib_load(chan_calib_t *cal, uint32_t channel_count, double vref, const char *path);
+
+/* Interleaved volts: out[i * channel_count + c]. */
+void chan_calib_frames(const chan_calib_t *cal, const ads1278_frame_t *frames, size_t n, float *out);
+
+/* One channel's samples, e.g. a channel-major decode. */
+void chan_calib_samples(const chan_calib_t *cal, uint32_t channel, const int32_t *codes, size_t n, float *out);
+
+/* Convert a code summary to volts in place (no-op if already converted). */
+void chan_calib_summary(const chan_calib_t *cal, chan_stats_summary_t *s);
+
+bool chan_stats_available(chan_stats_impl_t impl);
+
+/* Switch the active implementation (process-wide); ENOTSUP if unavailable. */
+int chan_stats_select(chan_stats_impl_t impl);
+chan_stats_impl_t chan_stats_active(void);
+const char *chan_stats_impl_name(chan_stats_impl_t impl);
+
+#endif /* CHAN_STATS_H */
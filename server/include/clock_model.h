@@ -0,0 +1,140 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Miguel Dovale (University of Arizona)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef CLOCK_MODEL_H
+#define CLOCK_MODEL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Online fit of frame timestamps against conversion index, for timestamps
+ * without wakeup jitter. DRDY edge times only ever arrive late (interrupt and
+ * scheduling latency), so the fit follows their lower envelope: frames are
+ * grouped into CLOCK_MODEL_BLOCK_NS blocks, the earliest frame of each block
+ * (smallest residual) becomes one point, and a least-squares line through the
+ * last CLOCK_MODEL_POINTS points gives period and offset. Points more than
+ * CLOCK_MODEL_REJECT_MAD median deviations off the first pass are dropped
+ * before the final fit.
+ *
+ * The model locks after CLOCK_MODEL_MIN_POINTS points; until then frames keep
+ * their raw timestamps. Once locked the output is piecewise linear and
+ * continuous: each refit keeps the current output at the current index and
+ * turns the slope toward the new fit so the offset closes over
+ * CLOCK_MODEL_SLEW_NS. Points further than CLOCK_MODEL_OUTLIER_NS from the
+ * line are outliers; CLOCK_MODEL_RELOCK_AFTER of them in a row (a clock step,
+ * a restarted source) drop the lock and start over.
+ *
+ * Not thread-safe; the HAL owns one per device and updates it per frame.
+ */
+#define CLOCK_MODEL_BLOCK_NS 20000000ULL
+#define CLOCK_MODEL_POINTS 64U
+#define CLOCK_MODEL_MIN_POINTS 8U
+#define CLOCK_MODEL_REJECT_MAD 4.0
+#define CLOCK_MODEL_SLEW_NS 1000000000.0
+#define CLOCK_MODEL_OUTLIER_NS 2000000.0
+#define CLOCK_MODEL_RELOCK_AFTER 4U
+
+/*
+ * Any run of locked output stays within this of the straight line through
+ * its first and last timestamps (rounding plus the slew kinks): the
+ * tolerance for sending model timestamps as a base and a rate.
+ */
+#define CLOCK_MODEL_LINEAR_TOLERANCE_NS 2U
+
+typedef struct {
+    double nominal_period_ns;   /* 0 = unknown */
+
+    /*
+     * Output line: tstamp(seq) = line_ns + line_frac_ns + (seq - line_seq) *
+     * period_ns, rounded. The fraction is kept across refits; dropping it at
+     * each one would bias the output by the same rounding every block.
+     */
+    bool locked;
+    uint64_t line_seq;
+    uint64_t line_ns;
+    double line_frac_ns;
+    double period_ns;
+    double fit_period_ns;       /* slope of the last fit (period_ns adds the slew) */
+    double lock_period_ns;      /* fitted period when the lock was taken */
+
+    /* Lower-envelope points, oldest at pt_pos once the ring is full. */
+    uint64_t pt_seq[CLOCK_MODEL_POINTS];
+    uint64_t pt_ns[CLOCK_MODEL_POINTS];
+    uint32_t pt_fill;
+    uint32_t pt_pos;
+    uint32_t outlier_run;
+
+    /* Open block: its earliest frame relative to the reference line. */
+    bool block_open;
+    uint64_t block_start_ns;
+    uint64_t block_seq;
+    uint64_t block_ns;
+    double block_resid;
+    double block_period_ns;     /* reference slope before lock */
+
+    /* Reference before lock: the first frame since the last (re)start. */
+    bool started;
+    uint64_t first_seq;
+    uint64_t first_ns;
+    uint64_t last_out_ns;
+
+    uint64_t frames;            /* timestamped frames seen */
+    uint64_t fits;              /* refits while locked (slope updates) */
+    uint64_t outliers;          /* block points rejected as off the line */
+    uint64_t relocks;           /* locks dropped after an outlier run */
+    double resid_sum;           /* raw - model while locked */
+    double resid_sum_sq;
+    uint64_t resid_count;
+    uint64_t resid_max_ns;      /* largest |raw - model| */
+} clock_model_t;
+
+/* nominal_rate_hz: expected DRDY rate (drift reference), 0 = unknown. */
+void clock_model_init(clock_model_t *model, uint32_t nominal_rate_hz);
+
+/*
+ * Feed frame seq (conversion index, increasing) stamped tstamp_ns (0 = no
+ * timestamp) and return its model timestamp: the raw one until the model
+ * locks, strictly increasing after.
+ */
+uint64_t clock_model_next(clock_model_t *model, uint64_t seq, uint64_t tstamp_ns);
+
+/* Standard deviation of raw - model timestamps (the jitter removed), 0 before lock. */
+double clock_model_jitter_ns(const clock_model_t *model);
+
+/*
+ * Fitted clock rate offset in ppm: against the nominal rate when one was
+ * given, otherwise against the period at lock (drift since lock).
+ */
+double clock_model_drift_ppm(const clock_model_t *model);
+
+#endif /* CLOCK_MODEL_H */
@@ -0,0 +1,126 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Miguel Dovale (University of Arizona)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DECIM_H
+#define DECIM_H
+
+#include "ads1278.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Streaming decimator for one channel group: an order-N CIC decimating by R,
+ * then a linear-phase FIR decimating by M (only every M-th output is
+ * computed) that by default also flattens the CIC passband droop. Total
+ * decimation is R * M; either stage can be bypassed with a factor of 1.
+ *
+ * Fixed point throughout: CIC integrators are 64-bit (N * log2(R) <= 39),
+ * FIR taps are Q22 applied to CIC output with 8 fractional bits, and output
+ * samples are clamped back to the 24-bit input range. NEON kernels are used
+ * when the target has NEON (compile time, as for the unpack kernels).
+ *
+ * Decimation instants are tied to seq (an output is produced when
+ * (seq + 1) % (R * M) == 0) and the output seq is seq / (R * M), so
+ * independent decimators over the same input line up. A seq gap resets the
+ * filter, and outputs are withheld until its history is full again.
+ * Output tstamp_ns is the input time the output is centred on (each stage's
+ * group delay is subtracted).
+ *
+ * One decimator can run several channel groups, each with its own filter:
+ * the groups must be disjoint and share the total factor, so their outputs
+ * fall on the same seq and are merged into one frame. Output frames carry
+ * only the selected channels, in ascending input channel order (ch[0] up to
+ * decim_channels() - 1; the rest read as 0), and the tstamp_ns of the first
+ * group; a group with a different filter length is centred on an input time
+ * that much earlier or later.
+ */
+#define DECIM_MAX_CIC_ORDER 6U
+#define DECIM_DEFAULT_CIC_ORDER 4U
+#define DECIM_MAX_FIR_TAPS 1024U
+#define DECIM_DEFAULT_TAPS_PER_PHASE 16U /* default FIR length 16 * M + 1 */
+#define DECIM_COEFF_FRAC_BITS 22U
+#define DECIM_MAX_GROUPS 8U
+
+typedef struct {
+    uint64_t channel_mask;      /* bit c selects ch[c]; 0 = all input channels */
+    uint32_t cic_factor;        /* R, 0/1 = no CIC stage */
+    uint32_t cic_order;         /* N, 0 = DECIM_DEFAULT_CIC_ORDER */
+    uint32_t fir_factor;        /* M, 0/1 = FIR (if any) runs at the CIC output rate */
+    uint32_t fir_taps;          /* 0 = default length; ignored with fir_coeffs */
+    const int32_t *fir_coeffs;  /* Q22 taps (fir_taps of them), NULL = designed */
+    double fir_passband;        /* designed passband edge / output Nyquist, 0 = 0.8 */
+} decim_cfg_t;
+
+typedef struct {
+    uint64_t frames_in;
+    uint64_t frames_out;
+    uint64_t resets;            /* seq gaps that restarted the filter */
+} decim_stats_t;
+
+typedef struct decim decim_t;
+
+/*
+ * Parse "cic=R,order=N,fir=M,taps=K,pass=P,mask=0xMM" (any subset, in any
+ * order) into cfg, which is zeroed first. Returns -1 on a malformed spec.
+ */
+int decim_parse_spec(const char *spec, decim_cfg_t *cfg);
+
+/*
+ * groups[0..n_groups) over input frames of `channels` channels (up to
+ * DECIM_MAX_GROUPS of them). EINVAL if a mask selects a channel past
+ * `channels` or one already in another group, or the total factors differ.
+ */
+int decim_create(decim_t **out, const decim_cfg_t *groups, size_t n_groups, uint32_t channels);
+void decim_destroy(decim_t *decim);
+void decim_reset(decim_t *decim);
+
+/* R * M. */
+uint32_t decim_factor(const decim_t *decim);
+
+/* FIR taps in use, the longest of any group (0 without a FIR stage). */
+uint32_t decim_fir_taps(const decim_t *decim);
+
+/* Channels per output frame: those selected by all groups. */
+uint32_t decim_channels(const decim_t *decim);
+
+/* Input channel that output ch[channel] is filtered from. */
+uint32_t decim_source_channel(const decim_t *decim, uint32_t channel);
+
+/*
+ * Filter n input frames; out must hold n / decim_factor() + 1 frames.
+ * Returns the number of output frames written.
+ */
+size_t decim_process(decim_t *decim, const ads1278_frame_t *in, size_t n, ads1278_frame_t *out);
+
+void decim_get_stats(const decim_t *decim, decim_stats_t *out);
+
+#endif /* DECIM_H */
@@ -0,0 +1,109 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Miguel Dovale (University of Arizona)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DRDY_MODEL_H
+#define DRDY_MODEL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Online DRDY period model. The ADS1278 converts on a fixed period set by its
+ * clock, so each frame timestamp can be placed on that grid to infer its
+ * conversion index: a reader that slept through edges shows up as an index
+ * jump (missed conversions) instead of a silently contiguous seq.
+ *
+ * Lock is decided on the median of the last DRDY_MODEL_WINDOW per-conversion
+ * intervals (interval / inferred steps), which ignores wakeup outliers and the
+ * gaps themselves: at least DRDY_MODEL_WARMUP intervals seen and their median
+ * absolute deviation below 1/8 of the median. Once locked, the period is taken
+ * over the whole span since lock (elapsed time / elapsed conversions) as soon
+ * as that covers DRDY_MODEL_WINDOW conversions, so its error shrinks with run
+ * length instead of staying at the jitter of a few intervals; long gaps need
+ * that precision to be counted exactly. A lock is dropped only when the MAD
+ * grows past 1/4 of the median.
+ *
+ * Frames are placed against a tracked grid, not the previous timestamp: the
+ * index is round((t - grid) / period) past the last one, with the grid edge
+ * nudged 1/DRDY_MODEL_PHASE_GAIN toward every timestamp. Only the new frame's
+ * jitter enters the rounding, where an interval between two jittered stamps
+ * would carry both. A frame within DRDY_MODEL_AMBIGUOUS_FRAC of a half period
+ * is counted ambiguous and placed on the fewer conversions, so jitter keeps
+ * seq contiguous rather than inventing gaps.
+ *
+ * Unlocked (timestamps too jittery, or a free-running source), frames
+ * advance by one plus the edges the backend reported missed, or are placed
+ * on a nominal period when one was given.
+ *
+ * Not thread-safe; the HAL owns one per device and updates it per frame.
+ */
+#define DRDY_MODEL_WINDOW 32U
+#define DRDY_MODEL_WARMUP 8U
+#define DRDY_MODEL_REFIT_EVERY 8U
+#define DRDY_MODEL_AMBIGUOUS_FRAC 0.25
+#define DRDY_MODEL_LOCK_MAD_DIV 8U
+#define DRDY_MODEL_UNLOCK_MAD_DIV 4U
+#define DRDY_MODEL_PHASE_GAIN 16.0
+
+typedef struct {
+    bool enabled;               /* false: index = previous + 1 + known missed */
+    bool started;               /* first frame placed (index 0) */
+    double nominal_period_ns;   /* 0 = learn only */
+    double period_ns;           /* locked estimate, 0 = not locked */
+    double median_ns;           /* window median at the last refit */
+    double grid_ns;             /* fitted edge time of last_index, 0 = none */
+    uint32_t grid_frames;       /* frames on the grid, capped at DRDY_MODEL_PHASE_GAIN */
+    uint64_t base_index;        /* first clean frame since lock */
+    uint64_t base_tstamp_ns;    /* 0 = no base */
+    uint64_t last_index;
+    uint64_t last_tstamp_ns;
+    uint64_t window[DRDY_MODEL_WINDOW]; /* recent per-conversion intervals, ns */
+    uint32_t window_fill;
+    uint32_t window_pos;
+    uint32_t since_fit;
+
+    uint64_t missed;            /* conversions with no frame */
+    uint64_t gaps;              /* index jumps */
+    uint64_t longest_gap;       /* conversions in the largest jump */
+    uint64_t ambiguous;         /* frames more than DRDY_MODEL_AMBIGUOUS_FRAC off the grid */
+} drdy_model_t;
+
+/* nominal_rate_hz: expected DRDY rate, 0 = unknown. enabled = false for sources without a period. */
+void drdy_model_init(drdy_model_t *model, bool enabled, uint32_t nominal_rate_hz);
+
+/*
+ * Place a frame stamped tstamp_ns (0 = no timestamp) whose DRDY wait reported
+ * known_missed skipped edges. Returns its conversion index; the first frame
+ * after init is 0.
+ */
+uint64_t drdy_model_next(drdy_model_t *model, uint64_t tstamp_ns, uint32_t known_missed);
+
+#endif /* DRDY_MODEL_H */
@@ -0,0 +1,124 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Miguel Dovale (University of Arizona)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef LAT_HIST_H
+#define LAT_HIST_H
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Log-linear latency histogram: values below 2^LAT_HIST_SUB_BITS ns get exact
+ * buckets, above that every power of two is split into 2^LAT_HIST_SUB_BITS
+ * buckets (at most 12.5% relative error). Fixed memory, no allocation.
+ *
+ * lat_hist_t is a plain snapshot for reporting and merging. lat_recorder_t is
+ * the live form: one writer thread records with relaxed atomic stores (no
+ * read-modify-write, no fences), and any thread may snapshot it concurrently
+ * without locks or torn values; a snapshot taken mid-record can be off by the
+ * sample in flight.
+ */
+#define LAT_HIST_SUB_BITS 3U
+#define LAT_HIST_MAX_BITS 40U       /* values >= 2^40 ns (~18 min) share the last bucket */
+#define LAT_HIST_BUCKETS (((LAT_HIST_MAX_BITS - LAT_HIST_SUB_BITS) + 1U) << LAT_HIST_SUB_BITS)
+
+typedef struct {
+    uint64_t count;
+    uint64_t sum_ns;
+    uint64_t min_ns;
+    uint64_t max_ns;
+    uint64_t bucket[LAT_HIST_BUCKETS];
+} lat_hist_t;
+
+typedef struct {
+    _Atomic uint64_t count;
+    _Atomic uint64_t sum_ns;
+    _Atomic uint64_t min_ns;
+    _Atomic uint64_t max_ns;
+    _Atomic uint64_t bucket[LAT_HIST_BUCKETS];
+} lat_recorder_t;
+
+static inline uint32_t lat_hist_bucket(uint64_t ns)
+{
+    uint32_t msb;
+
+    if (ns < (1U << LAT_HIST_SUB_BITS)) {
+        return (uint32_t)ns;
+    }
+    msb = 63U - (uint32_t)__builtin_clzll(ns);
+    if (msb >= LAT_HIST_MAX_BITS) {
+        return LAT_HIST_BUCKETS - 1U;
+    }
+    return ((msb - LAT_HIST_SUB_BITS + 1U) << LAT_HIST_SUB_BITS) +
+        (uint32_t)((ns >> (msb - LAT_HIST_SUB_BITS)) & ((1U << LAT_HIST_SUB_BITS) - 1U));
+}
+
+/* Single-writer increment: a plain load and store, both relaxed. */
+static inline void lat_counter_add(_Atomic uint64_t *counter, uint64_t delta)
+{
+    atomic_store_explicit(counter, atomic_load_explicit(counter, memory_order_relaxed) + delta,
+        memory_order_relaxed);
+}
+
+static inline void lat_recorder_record(lat_recorder_t *rec, uint64_t ns)
+{
+    lat_counter_add(&rec->bucket[lat_hist_bucket(ns)], 1U);
+    lat_counter_add(&rec->count, 1U);
+    lat_counter_add(&rec->sum_ns, ns);
+    if (ns < atomic_load_explicit(&rec->min_ns, memory_order_relaxed)) {
+        atomic_store_explicit(&rec->min_ns, ns, memory_order_relaxed);
+    }
+    if (ns > atomic_load_explicit(&rec->max_ns, memory_order_relaxed)) {
+        atomic_store_explicit(&rec->max_ns, ns, memory_order_relaxed);
+    }
+}
+
+void lat_hist_reset(lat_hist_t *hist);
+void lat_hist_record(lat_hist_t *hist, uint64_t ns);
+void lat_hist_merge(lat_hist_t *dst, const lat_hist_t *src);
+
+/* Upper bound of the bucket holding quantile q (0..1), clamped to max_ns; 0 when empty. */
+uint64_t lat_hist_quantile(const lat_hist_t *hist, double q);
+
+/* Samples strictly above ns, rounded to bucket boundaries. */
+uint64_t lat_hist_count_above(const lat_hist_t *hist, uint64_t ns);
+
+/* "n N, min/p50/p99/p99.9/max A/B/C/D/E us" into buf. */
+void lat_hist_format(const lat_hist_t *hist, char *buf, size_t len);
+
+/* Not concurrent with the writer. */
+void lat_recorder_reset(lat_recorder_t *rec);
+
+/* Safe from any thread while the writer records. */
+void lat_recorder_snapshot(const lat_recorder_t *rec, lat_hist_t *out);
+
+#endif /* LAT_HIST_H */
@@ -0,0 +1,488 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Miguel Dovale (University of Arizona)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PROTO_H
+#define PROTO_H
+
+#include "ads1278.h"
+#include "sample_codec.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Stream protocol (docs/protocol.md). Every message is a 16-byte little-endian
+ * header followed by payload_len bytes:
+ *
+ *   u32 magic   'R','P','D','Q'
+ *   u8  version PROTO_VERSION (PROTO_MIN_VERSION.. accepted)
+ *   u8  type    proto_msg_type_t
+ *   u16 flags   type-specific
+ *   u32 msg_seq per-stream message counter (gaps mean dropped messages)
+ *   u32 payload_len
+ */
+#define PROTO_MAGIC 0x51445052U
+#define PROTO_VERSION 2U
+#define PROTO_MIN_VERSION 1U    /* v1 differs only in DATA's channel_count, then reserved (0) */
+#define PROTO_HEADER_BYTES 16U
+#define PROTO_MAX_PAYLOAD_BYTES (16U * 1024U * 1024U)
+#define PROTO_DEFAULT_PORT 9000U
+
+typedef enum {
+    PROTO_MSG_HELLO = 1,
+    PROTO_MSG_CONFIG = 2,
+    PROTO_MSG_DATA = 3,
+    PROTO_MSG_STATS = 4,
+    PROTO_MSG_EVENT = 5,
+    PROTO_MSG_SUMMARY = 6,
+    PROTO_MSG_SPECTRUM = 7,
+    PROTO_MSG_SUBSCRIBE = 8,    /* client to server */
+    PROTO_MSG_GAP = 9
+} proto_msg_type_t;
+
+typedef struct {
+    uint8_t version;
+    uint8_t type;
+    uint16_t flags;
+    uint32_t msg_seq;
+    uint32_t payload_len;
+} proto_header_t;
+
+/* HELLO: protocol version, channel count and server identification. */
+#define PROTO_HELLO_BYTES 40U
+#define PROTO_SERVER_NAME_BYTES 32U
+
+typedef struct {
+    uint16_t proto_version;
+    uint16_t channel_count;
+    uint32_t reserved;
+    char server_name[PROTO_SERVER_NAME_BYTES];  /* NUL-padded */
+} proto_hello_t;
+
+/* CONFIG: active acquisition and streaming settings. */
+#define PROTO_CONFIG_BYTES 32U
+
+typedef struct {
+    uint32_t backend;           /* ads1278_backend_id_t */
+    uint32_t sample_rate_hz;    /* nominal DRDY rate, 0 = unknown/free-running */
+    uint32_t sclk_hz;
+    uint32_t spi_mode;
+    uint32_t settle_frames;
+    uint32_t frames_per_msg;    /* upper bound on frames in one DATA message */
+    uint32_t flush_us;          /* partial DATA messages are sent after this long */
+    uint32_t stream_mode;       /* stream_mode_t */
+} proto_config_t;
+
+/*
+ * STATS: periodic pipeline health. u64 mono_ns, frames, drdy_timeouts,
+ * missed_drdy, overlong_xfers, ring_overflows, ring_high_water, msgs_dropped,
+ * missed_conversions, gap_events, u32 ring_capacity, u16 stage_count,
+ * u16 reserved, then stage_count latency
+ * summaries {u64 count, u32 p50_ns, p99_ns, p999_ns, max_ns} in
+ * proto_stage_t order. Latencies saturate at UINT32_MAX ns.
+ */
+#define PROTO_STATS_HEADER_BYTES 88U
+#define PROTO_STATS_STAGE_BYTES 24U
+
+typedef enum {
+    PROTO_STAGE_DRDY_WAKEUP = 0,    /* DRDY edge to reader thread running */
+    PROTO_STAGE_SPI_XFER,           /* SPI transfer of one frame */
+    PROTO_STAGE_PARSE,              /* raw frame to decoded frame */
+    PROTO_STAGE_RING_DWELL,         /* acquisition ring push to release */
+    PROTO_STAGE_NET_SEND,           /* message published to fully sent */
+    PROTO_STAGE_COUNT
+} proto_stage_t;
+
+#define PROTO_STATS_BYTES (PROTO_STATS_HEADER_BYTES + (PROTO_STAGE_COUNT * PROTO_STATS_STAGE_BYTES))
+
+typedef struct {
+    uint64_t count;
+    uint32_t p50_ns;
+    uint32_t p99_ns;
+    uint32_t p999_ns;
+    uint32_t max_ns;
+} proto_stage_stats_t;
+
+typedef struct {
+    uint64_t mono_ns;           /* server CLOCK_MONOTONIC when sent */
+    uint64_t frames;
+    uint64_t drdy_timeouts;
+    uint64_t missed_drdy;
+    uint64_t overlong_xfers;
+    uint64_t ring_overflows;
+    uint64_t ring_high_water;
+    uint64_t msgs_dropped;
+    uint64_t missed_conversions; /* seq jumps inferred from the DRDY period model */
+    uint64_t gap_events;
+    uint32_t ring_capacity;
+    uint16_t stage_count;       /* stages present; decoding drops unknown ones */
+    proto_stage_stats_t stage[PROTO_STAGE_COUNT];
+} proto_stats_t;
+
+/*
+ * DATA: u64 first_seq, u32 frame_count, u16 encoding, u16 channel_count
+ * (0 = 8; 8 per chained device, fewer after a channel-selecting decimator),
+ * then an encoding-specific body:
+ *
+ *   RECORD48  frame_count 48-byte v1 capture records (docs/ads1278_output.md);
+ *             8 channels only
+ *   P24       u64 base_tstamp_ns, frame_count x channel_count x 3 bytes of
+ *             MSB-first 24-bit samples (the ADS1278 TDM frame layout, device 0
+ *             first), then frame_count u32 timestamp deltas (ns since the
+ *             previous frame, 0 for the first). Frames in one P24 message have
+ *             consecutive seq.
+ *   DELTA     u64 base_tstamp_ns, then channel_count + 1 sample_codec streams
+ *             of frame_count values: ch1..chN and the P24 timestamp deltas.
+ *             Variable length; the same seq/timestamp rules as P24.
+ *
+ * PROTO_DATA_LINEAR_TS set in the encoding (P24/DELTA, frame_count >= 2)
+ * replaces the per-frame timestamp deltas (P24's u32 column, DELTA's last
+ * stream) with one u64 last_tstamp_ns: frame i is stamped
+ * base + (i * (last - base) + (n - 1) / 2) / (n - 1), n = frame_count,
+ * integer division. Encoders use it for timestamps already on a line, such
+ * as the HAL clock model's.
+ *
+ * PROTO_DATA_SEQ_GAPS set in the encoding (P24/DELTA) appends a gap list to
+ * the payload: gap_count entries of u32 frame (index of the first frame
+ * after the gap, increasing, 1..frame_count - 1) and u32 skipped (seq
+ * values missing before it, >= 1), then u32 gap_count. Frame i then has
+ * seq first_seq + i plus the skipped counts of the entries with frame <= i,
+ * and with PROTO_DATA_LINEAR_TS i and n - 1 above are seq offsets from
+ * first_seq, so a missed conversion does not break the line.
+ */
+#define PROTO_DATA_HEADER_BYTES 16U
+#define PROTO_DATA_ENC_RECORD48 1U
+#define PROTO_DATA_ENC_P24 2U
+#define PROTO_DATA_ENC_DELTA 3U
+#define PROTO_DATA_LINEAR_TS 0x8000U
+#define PROTO_DATA_LINEAR_TS_BYTES 8U
+#define PROTO_DATA_SEQ_GAPS 0x4000U
+#define PROTO_DATA_GAP_ENTRY_BYTES 8U
+#define PROTO_DATA_GAPS_BYTES(gaps) (4U + ((size_t)(gaps) * PROTO_DATA_GAP_ENTRY_BYTES))
+#define PROTO_DATA_MAX_GAPS 64U
+#define PROTO_DATA_ENC_MASK 0x3FFFU
+#define PROTO_RECORD48_BYTES 48U
+#define PROTO_P24_BASE_BYTES 8U
+#define PROTO_P24_FRAME_BYTES(channels) (((size_t)(channels) * 3U) + 4U)
+#define PROTO_DELTA_MAX_STREAMS (ADS1278_MAX_CHANNELS + 1U)
+
+/* Zero-copy view of a DATA payload; the pointers alias the payload. */
+typedef struct {
+    uint64_t first_seq;
+    uint32_t frame_count;
+    uint16_t encoding;
+    uint16_t channel_count;
+    bool linear_ts;             /* PROTO_DATA_LINEAR_TS was set (masked off encoding) */
+    uint32_t gap_count;         /* PROTO_DATA_SEQ_GAPS entries (masked off encoding) */
+    uint64_t skipped;           /* seq values the gap list skips */
+    uint64_t base_tstamp_ns;    /* P24 and DELTA */
+    uint64_t last_tstamp_ns;    /* linear_ts only */
+    const uint8_t *frames;      /* RECORD48 records or P24 packed samples */
+    const uint8_t *ts_deltas;   /* P24 only, NULL when linear_ts */
+    const uint8_t *gaps;        /* gap_count entries, NULL without */
+    const uint8_t *streams[PROTO_DELTA_MAX_STREAMS]; /* DELTA only: channels, then timestamp deltas */
+} proto_data_info_t;
+
+/*
+ * EVENT: one triggered capture window. u64 event_id, u64 trigger_seq,
+ * u64 trigger_tstamp_ns, u32 frame_count, u32 pre_frames, u16 condition
+ * (index into the server's trigger spec, 0xFFFF = external), u16 channel
+ * (0xFFFF for external), u32 reserved, then one complete DATA message
+ * (header included, msg_seq 0) holding the frame_count window frames; the
+ * trigger frame is frame pre_frames of it.
+ */
+#define PROTO_EVENT_HEADER_BYTES 40U
+#define PROTO_EVENT_EXTERNAL 0xFFFFU
+
+typedef struct {
+    uint64_t event_id;
+    uint64_t trigger_seq;
+    uint64_t trigger_tstamp_ns;
+    uint32_t frame_count;
+    uint32_t pre_frames;
+    uint16_t condition;
+    uint16_t channel;
+} proto_event_t;
+
+/* Parsed EVENT payload; data aliases the embedded DATA payload. */
+typedef struct {
+    proto_event_t event;
+    proto_data_info_t data;
+} proto_event_info_t;
+
+/*
+ * SUMMARY: per-channel statistics of the frames since the previous SUMMARY.
+ * u64 mono_ns, first_seq, last_seq, frames, first_tstamp_ns, last_tstamp_ns,
+ * u16 channel_count, u16 flags (PROTO_SUMMARY_VOLTS: values are calibrated
+ * volts, else ADC codes), u32 reserved, then channel_count x {f64 min, max,
+ * mean, rms, stddev}. frames 0 means no frames arrived in the period.
+ */
+#define PROTO_SUMMARY_HEADER_BYTES 56U
+#define PROTO_SUMMARY_CHANNEL_BYTES 40U
+#define PROTO_SUMMARY_VOLTS 0x1U
+#define PROTO_SUMMARY_BYTES(channels) (PROTO_SUMMARY_HEADER_BYTES + ((size_t)(channels) * PROTO_SUMMARY_CHANNEL_BYTES))
+
+typedef struct {
+    double min;
+    double max;
+    double mean;
+    double rms;
+    double stddev;
+} proto_summary_channel_t;
+
+typedef struct {
+    uint64_t mono_ns;           /* server CLOCK_MONOTONIC when sent */
+    uint64_t first_seq;
+    uint64_t last_seq;
+    uint64_t frames;
+    uint64_t first_tstamp_ns;
+    uint64_t last_tstamp_ns;
+    uint16_t channel_count;
+    uint16_t flags;
+    proto_summary_channel_t ch[ADS1278_MAX_CHANNELS];
+} proto_summary_t;
+
+/*
+ * SPECTRUM: one channel of a Welch power spectral density result; a result
+ * is sent as one message per channel sharing result_id. u64 mono_ns,
+ * result_id, first_seq, last_seq, f64 bin_hz (FFT bin spacing), enbw_hz
+ * (window equivalent noise bandwidth), u32 fft_size, segments (periodograms
+ * averaged), u16 channel, window (psd_window_t), flags (PROTO_SPECTRUM_VOLTS:
+ * V^2/Hz, else codes^2/Hz), bin_group, u32 bin_count, reserved, then
+ * bin_count f32 one-sided densities; bin k averages FFT bins
+ * [k * bin_group, (k + 1) * bin_group).
+ */
+#define PROTO_SPECTRUM_HEADER_BYTES 72U
+#define PROTO_SPECTRUM_VOLTS 0x1U
+#define PROTO_SPECTRUM_BYTES(bins) (PROTO_SPECTRUM_HEADER_BYTES + ((size_t)(bins) * 4U))
+
+typedef struct {
+    uint64_t mono_ns;           /* server CLOCK_MONOTONIC when sent */
+    uint64_t result_id;
+    uint64_t first_seq;
+    uint64_t last_seq;
+    double bin_hz;
+    double enbw_hz;
+    uint32_t fft_size;
+    uint32_t segments;
+    uint16_t channel;
+    uint16_t window;
+    uint16_t flags;
+    uint16_t bin_group;
+    uint32_t bin_count;
+} proto_spectrum_t;
+
+/*
+ * SUBSCRIBE (client to server, optional, msg_seq 0): u64 resume_seq,
+ * u32 max_lag_ms, u16 policy (proto_policy_t), u16 flags. It sets the
+ * session's backpressure policy; max_lag_ms is the disconnect policy's limit
+ * (0 = server default). With PROTO_SUBSCRIBE_RESUME the server replays its
+ * history from the message holding frame resume_seq (the client discards
+ * frames it already has), announced by a GAP flagged PROTO_GAP_RESUME.
+ */
+#define PROTO_SUBSCRIBE_BYTES 16U
+#define PROTO_SUBSCRIBE_RESUME 0x1U
+
+typedef enum {
+    PROTO_POLICY_DEFAULT = 0,       /* the server's configured policy */
+    PROTO_POLICY_DROP_OLDEST = 1,   /* skip messages evicted from the history, then send a GAP */
+    PROTO_POLICY_DISCONNECT = 2,    /* close the connection past max_lag_ms or before losing a message */
+    PROTO_POLICY_NEVER_DROP = 3     /* no lag limit, but close rather than skip a message the history evicts */
+} proto_policy_t;
+
+typedef struct {
+    uint64_t resume_seq;
+    uint32_t max_lag_ms;
+    uint16_t policy;
+    uint16_t flags;
+} proto_subscribe_t;
+
+/*
+ * GAP (msg_seq 0): messages this client will not get. u32 first_msg_seq,
+ * u32 msg_count, u64 first_seq, u64 frame_count, u16 flags, u16 reserved,
+ * u32 reserved. msg_seq [first_msg_seq, first_msg_seq + msg_count) were
+ * dropped, holding frame_count frames from frame first_seq on; the next
+ * message has msg_seq first_msg_seq + msg_count. With PROTO_GAP_RESUME it
+ * answers a resuming SUBSCRIBE: first_seq is resume_seq, frame_count the
+ * frames from there that are no longer in the history, msg_count 0.
+ */
+#define PROTO_GAP_BYTES 32U
+#define PROTO_GAP_RESUME 0x1U
+
+typedef struct {
+    uint32_t first_msg_seq;
+    uint32_t msg_count;
+    uint64_t first_seq;
+    uint64_t frame_count;
+    uint16_t flags;
+} proto_gap_t;
+
+/*
+ * DATA encoder writing straight into a caller-owned message buffer of
+ * proto_data_max_bytes(encoding, capacity) bytes. append() takes frames until
+ * the message is full or (P24) seq/timestamps stop being encodable in the
+ * open message; it returns how many it took. DELTA stages frames channel-major
+ * and compresses them in finish(). With linear_ts set, finish() sends
+ * P24/DELTA timestamps as PROTO_DATA_LINEAR_TS when each frame is within
+ * linear_tolerance_ns of that line (0 = only exact lines). A nonzero
+ * max_gaps (at most PROTO_DATA_MAX_GAPS) lets P24/DELTA messages carry that
+ * many forward seq gaps as PROTO_DATA_SEQ_GAPS instead of ending at the
+ * first; the message buffer then needs PROTO_DATA_GAPS_BYTES(max_gaps) more.
+ */
+typedef struct {
+    uint16_t encoding;
+    uint16_t channels;
+    uint32_t capacity;
+    uint8_t *msg;
+    uint32_t count;
+    uint64_t next_seq;
+    uint64_t last_tstamp_ns;
+    bool linear_ts;
+    uint32_t linear_tolerance_ns;
+    uint64_t linear_msgs;       /* messages finished with PROTO_DATA_LINEAR_TS */
+    uint32_t max_gaps;
+    uint32_t gap_count;
+    uint32_t gap_frame[PROTO_DATA_MAX_GAPS];
+    uint32_t gap_skipped[PROTO_DATA_MAX_GAPS];
+    uint32_t *ts_deltas;        /* P24/DELTA staging, capacity entries */
+    int32_t *ch[ADS1278_MAX_CHANNELS]; /* DELTA staging, capacity entries each */
+} proto_data_encoder_t;
+
+static inline void proto_store_u16(uint8_t *dst, uint16_t value)
+{
+    dst[0] = (uint8_t)value;
+    dst[1] = (uint8_t)(value >> 8U);
+}
+
+static inline void proto_store_u32(uint8_t *dst, uint32_t value)
+{
+    dst[0] = (uint8_t)value;
+    dst[1] = (uint8_t)(value >> 8U);
+    dst[2] = (uint8_t)(value >> 16U);
+    dst[3] = (uint8_t)(value >> 24U);
+}
+
+static inline void proto_store_u64(uint8_t *dst, uint64_t value)
+{
+    proto_store_u32(dst, (uint32_t)value);
+    proto_store_u32(dst + 4, (uint32_t)(value >> 32U));
+}
+
+static inline uint16_t proto_load_u16(const uint8_t *src)
+{
+    return (uint16_t)(src[0] | (src[1] << 8U));
+}
+
+static inline uint32_t proto_load_u32(const uint8_t *src)
+{
+    return (uint32_t)src[0] | ((uint32_t)src[1] << 8U) | ((uint32_t)src[2] << 16U) | ((uint32_t)src[3] << 24U);
+}
+
+static inline uint64_t proto_load_u64(const uint8_t *src)
+{
+    return (uint64_t)proto_load_u32(src) | ((uint64_t)proto_load_u32(src + 4) << 32U);
+}
+
+void proto_encode_header(uint8_t dst[PROTO_HEADER_BYTES], const proto_header_t *hdr);
+
+/* -1/EPROTO on bad magic or version, -1/EMSGSIZE on an oversized payload. */
+int proto_decode_header(const uint8_t src[PROTO_HEADER_BYTES], proto_header_t *hdr);
+
+/* Complete messages (header included); return the bytes written. */
+size_t proto_encode_hello(uint8_t *dst, uint32_t msg_seq, const proto_hello_t *hello);
+size_t proto_encode_config(uint8_t *dst, uint32_t msg_seq, const proto_config_t *cfg);
+int proto_decode_hello(const uint8_t *payload, size_t len, proto_hello_t *hello);
+int proto_decode_config(const uint8_t *payload, size_t len, proto_config_t *cfg);
+size_t proto_encode_stats(uint8_t *dst, uint32_t msg_seq, const proto_stats_t *stats);
+int proto_decode_stats(const uint8_t *payload, size_t len, proto_stats_t *stats);
+size_t proto_encode_summary(uint8_t *dst, uint32_t msg_seq, const proto_summary_t *summary);
+int proto_decode_summary(const uint8_t *payload, size_t len, proto_summary_t *summary);
+size_t proto_encode_spectrum(uint8_t *dst, uint32_t msg_seq, const proto_spectrum_t *spectrum, const float *bins);
+
+/* bins (may be NULL) receives min(bin_count, max_bins) densities. */
+int proto_decode_spectrum(const uint8_t *payload, size_t len, proto_spectrum_t *spectrum, float *bins,
+                          size_t max_bins);
+size_t proto_encode_subscribe(uint8_t *dst, const proto_subscribe_t *sub);
+int proto_decode_subscribe(const uint8_t *payload, size_t len, proto_subscribe_t *sub);
+size_t proto_encode_gap(uint8_t *dst, const proto_gap_t *gap);
+int proto_decode_gap(const uint8_t *payload, size_t len, proto_gap_t *gap);
+
+/* Summarise a latency histogram into one STATS stage entry. */
+void proto_stage_from_hist(proto_stage_stats_t *stage, const lat_hist_t *hist);
+const char *proto_stage_name(proto_stage_t stage);
+
+const char *proto_data_encoding_name(uint16_t encoding);
+
+/*
+ * Largest DATA message (header included) for n frames of channels channels,
+ * 0 for an unknown encoding or a channel count it cannot carry. Exact for
+ * the fixed-size encodings, worst case for DELTA.
+ */
+size_t proto_data_max_bytes(uint16_t encoding, uint32_t channels, size_t n);
+
+/* channels: 8 per chained device or a decimator's selection (0 = 8); RECORD48 carries 8 only. */
+int proto_data_encoder_init(proto_data_encoder_t *enc, uint16_t encoding, uint32_t channels, uint32_t capacity);
+void proto_data_encoder_destroy(proto_data_encoder_t *enc);
+void proto_data_begin(proto_data_encoder_t *enc, uint8_t *msg, uint32_t msg_seq, const ads1278_frame_t *first);
+size_t proto_data_append(proto_data_encoder_t *enc, const ads1278_frame_t *frames, size_t n);
+
+/* Patch the headers; returns the message size. The encoder is then idle. */
+size_t proto_data_finish(proto_data_encoder_t *enc);
+
+/* Parse and length-check a DATA payload. */
+int proto_decode_data_info(const uint8_t *payload, size_t len, proto_data_info_t *info);
+
+/* Decode frames [first, first + n) of a parsed payload (DELTA decodes from frame 0). */
+void proto_data_decode_frames(const proto_data_info_t *info, uint32_t first, uint32_t n, ads1278_frame_t *out);
+
+/* Seq of frame idx of a parsed P24/DELTA payload, gap list included. */
+uint64_t proto_data_frame_seq(const proto_data_info_t *info, uint32_t idx);
+
+/* Timestamp of frame idx of a linear_ts payload, without decoding the others. */
+uint64_t proto_data_linear_tstamp(const proto_data_info_t *info, uint32_t idx);
+
+/* Largest EVENT message for a window of n frames (0 as proto_data_max_bytes()). */
+size_t proto_event_max_bytes(uint16_t encoding, uint32_t channels, size_t n);
+
+/*
+ * Encode an EVENT around frames[0..n), n >= 1, with enc idle and sized for
+ * n frames. Sets event->frame_count to the frames that fit: all of them
+ * unless (P24/DELTA) the window holds a timestamp step the encoding cannot
+ * carry. Returns the message size.
+ */
+size_t proto_encode_event(uint8_t *dst, uint32_t msg_seq, proto_event_t *event, proto_data_encoder_t *enc,
+                          const ads1278_frame_t *frames, size_t n);
+int proto_decode_event(const uint8_t *payload, size_t len, proto_event_info_t *info);
+
+/* P24 only: decode all samples channel-major (SIMD unpack straight from the payload for 8 channels). */
+void proto_data_p24_samples_soa(const proto_data_info_t *info, int32_t *const ch[ADS1278_MAX_CHANNELS]);
+
+#endif /* PROTO_H */
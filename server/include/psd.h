@@ -0,0 +1,148 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Miguel Dovale (University of Arizona)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef PSD_H
+#define PSD_H
+
+#include "ads1278.h"
+#include "chan_stats.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Welch power spectral density estimate per channel. Frames stream through
+ * psd_process() (after decimation, if any); every hop frames a segment of
+ * the last fft_size samples of each channel is windowed, transformed with
+ * the bundled real FFT and its periodogram added to a running sum. After
+ * averages segments the mean becomes one result and the sum restarts.
+ *
+ * Results are one-sided densities in codes^2/Hz (V^2/Hz with a calibration
+ * table): bins 0..fft_size/2 of spacing sample_rate / fft_size, with every
+ * bin but DC and Nyquist doubled, so summing a result times bin_hz gives
+ * the mean square of the windowed signal (Parseval). max_bins averages
+ * groups of adjacent bins for a compact result.
+ *
+ * A segment never spans a seq gap: a gap discards the partial segment and
+ * the next one starts fresh at the frame after it.
+ */
+#define PSD_DEFAULT_FFT_SIZE 4096U
+#define PSD_MIN_FFT_SIZE 16U
+#define PSD_MAX_FFT_SIZE 65536U
+#define PSD_DEFAULT_AVERAGES 16U
+
+typedef enum {
+    PSD_WINDOW_HANN = 0,
+    PSD_WINDOW_RECT,
+    PSD_WINDOW_BLACKMAN_HARRIS  /* 4-term, -92 dB sidelobes */
+} psd_window_t;
+
+typedef struct {
+    uint32_t fft_size;          /* power of two in [PSD_MIN_FFT_SIZE, PSD_MAX_FFT_SIZE], 0 = default */
+    uint32_t hop;               /* frames between segment starts, at most fft_size; 0 = fft_size / 2 */
+    uint32_t averages;          /* segments per result, 0 = PSD_DEFAULT_AVERAGES */
+    uint32_t window;            /* psd_window_t */
+    uint32_t max_bins;          /* average adjacent bins down to at most this many, 0 = all */
+    bool detrend;               /* subtract each segment's mean before windowing */
+    uint32_t channel_count;     /* channels per frame, 0 = 8 */
+    double sample_rate_hz;      /* 0 = estimate each result's rate from its frame timestamps */
+    const chan_calib_t *calib;  /* densities in V^2/Hz, NULL = codes^2/Hz */
+} psd_cfg_t;
+
+typedef struct {
+    uint64_t id;                /* 0, 1, ... */
+    uint64_t first_seq;         /* first frame of the first segment */
+    uint64_t last_seq;          /* last frame of the last segment */
+    uint64_t first_tstamp_ns;
+    uint64_t last_tstamp_ns;
+    uint32_t segments;
+    uint32_t fft_size;
+    uint32_t window;            /* psd_window_t */
+    uint32_t bins;              /* per channel, 0 = no result */
+    uint32_t bin_group;         /* result bin k averages FFT bins [k * bin_group, (k + 1) * bin_group) */
+    double sample_rate_hz;
+    double bin_hz;              /* FFT bin spacing, sample_rate_hz / fft_size */
+    double enbw_hz;             /* equivalent noise bandwidth of the window */
+    uint32_t channel_count;
+    bool volts;
+    const float *psd[ADS1278_MAX_CHANNELS]; /* bins values each, valid until the next psd_process() */
+} psd_result_t;
+
+typedef struct {
+    uint64_t frames_in;
+    uint64_t segments;
+    uint64_t results;
+    uint64_t gaps;              /* partial segments discarded at a seq gap */
+} psd_stats_t;
+
+typedef struct psd psd_t;
+
+/*
+ * Parse "fft=N,hop=N,avg=N,window=hann|rect|bh,bins=N,detrend=0|1" (any
+ * subset, in any order) into cfg, which is zeroed first. Returns -1 on a
+ * malformed spec.
+ */
+int psd_parse_spec(const char *spec, psd_cfg_t *cfg);
+
+int psd_create(psd_t **out, const psd_cfg_t *cfg);
+void psd_destroy(psd_t *psd);
+
+/* Bins per channel in every result. */
+uint32_t psd_result_bins(const psd_t *psd);
+
+/*
+ * Feed n frames. Returns how many were consumed: all of them, or fewer when
+ * a result completed, in which case *result describes it (bins != 0) and the
+ * caller passes the rest in again after handling it.
+ */
+size_t psd_process(psd_t *psd, const ads1278_frame_t *frames, size_t n, psd_result_t *result);
+
+/* Drop the partial average and segments (e.g. after reconfiguring the source). */
+void psd_reset(psd_t *psd);
+
+void psd_get_stats(const psd_t *psd, psd_stats_t *out);
+
+const char *psd_window_name(uint32_t window);
+
+/*
+ * The bundled real FFT: n a power of two >= 4. forward() maps n real
+ * samples to bins 0..n/2 as interleaved (re, im) pairs, unnormalised
+ * (X[k] = sum x[j] e^(-2 pi i jk / n)); in and out must not overlap.
+ */
+typedef struct psd_rfft psd_rfft_t;
+
+int psd_rfft_create(psd_rfft_t **out, uint32_t n);
+void psd_rfft_destroy(psd_rfft_t *fft);
+void psd_rfft_forward(psd_rfft_t *fft, const double *in, double *out);
+
+#endif /* PSD_H */
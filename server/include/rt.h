@@ -0,0 +1,103 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Miguel Dovale (University of Arizona)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef RT_H
+#define RT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Real-time execution profile for the acquisition thread. rt_lock_memory()
+ * is process-wide (acq_create() calls it, so every existing and future
+ * mapping is faulted in and locked); rt_apply_thread() runs on the thread
+ * itself (SCHED_FIFO, CPU affinity, prefaulted stack). Neither is fatal:
+ * whatever could not be applied is recorded with its errno in rt_status_t so
+ * the tools can report it and keep running under the default scheduler.
+ */
+#define RT_DEFAULT_STACK_PREFAULT_BYTES (256U * 1024U)
+
+typedef enum {
+    RT_KERNEL_UNKNOWN = 0,
+    RT_KERNEL_NONE,             /* voluntary/no forced preemption */
+    RT_KERNEL_PREEMPT,          /* CONFIG_PREEMPT or PREEMPT_DYNAMIC */
+    RT_KERNEL_PREEMPT_RT        /* fully preemptible (PREEMPT_RT) */
+} rt_kernel_t;
+
+typedef struct {
+    int priority;               /* SCHED_FIFO 1..99, 0 = stay on SCHED_OTHER */
+    uint64_t cpu_mask;          /* allowed CPUs, bit n = CPU n; 0 = any */
+    bool lock_memory;           /* mlockall(MCL_CURRENT | MCL_FUTURE) */
+    size_t stack_prefault_bytes; /* 0 = default when priority or lock_memory is set */
+} rt_cfg_t;
+
+typedef struct {
+    rt_kernel_t kernel;
+    char kernel_version[64];    /* uname -v, truncated */
+    int rt_runtime_us;          /* sched_rt_runtime_us, -1 = unlimited/unknown */
+    uint64_t rtprio_limit;      /* RLIMIT_RTPRIO soft limit (UINT64_MAX = unlimited) */
+    uint64_t memlock_limit;     /* RLIMIT_MEMLOCK soft limit in bytes */
+    bool privileged;            /* effective uid 0 */
+
+    bool memory_locked;
+    int mlock_errno;
+    bool sched_applied;
+    int sched_errno;
+    bool affinity_applied;
+    int affinity_errno;
+    size_t stack_prefaulted;    /* bytes touched on the thread stack */
+} rt_status_t;
+
+/* True if cfg asks for anything beyond the default scheduler. */
+bool rt_cfg_active(const rt_cfg_t *cfg);
+
+/* Kernel preemption model and the limits that decide whether RT will work. */
+void rt_probe(rt_status_t *status);
+
+/* Process-wide mlockall(); a no-op unless cfg->lock_memory. */
+int rt_lock_memory(const rt_cfg_t *cfg, rt_status_t *status);
+
+/* Apply priority, affinity and stack prefault to the calling thread. */
+int rt_apply_thread(const rt_cfg_t *cfg, rt_status_t *status);
+
+/* Parse a CPU list such as "1" or "0,2-3" into a mask. */
+int rt_parse_cpus(const char *text, uint64_t *mask);
+
+/*
+ * One-line summary of what was requested and applied, followed by a
+ * "warning: ..." line for each setting that failed or a non-PREEMPT_RT kernel.
+ */
+void rt_format_status(const rt_cfg_t *cfg, const rt_status_t *status, char *buf, size_t len);
+
+const char *rt_kernel_name(rt_kernel_t kernel);
+
+#endif /* RT_H */
@@ -0,0 +1,75 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Miguel Dovale (University of Arizona)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SAMPLE_CODEC_H
+#define SAMPLE_CODEC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Lossless integer stream codec: first-order delta (the value before the
+ * first one is 0), zigzag, then groups of SAMPLE_CODEC_GROUP values bit-packed
+ * at the group's own width. A group is one width byte (0..32) followed by
+ * ceil(count * width / 8) bytes, values LSB-first. Deltas wrap modulo 2^32, so
+ * any int32 sequence round-trips bit-exactly; quiet 24-bit channels pack to a
+ * few bits per sample.
+ */
+#define SAMPLE_CODEC_GROUP 32U
+
+/* Worst-case encoded size of n values. */
+size_t sample_codec_max_bytes(size_t n);
+
+/* Encode src[0], src[stride], ... (n values); returns the bytes written. */
+size_t sample_codec_encode(const int32_t *src, size_t stride, size_t n, uint8_t *dst);
+
+/* Size of the n-value stream at src, or 0 if it does not fit in len bytes. */
+size_t sample_codec_stream_bytes(const uint8_t *src, size_t len, size_t n);
+
+/*
+ * Sequential decoder over a stream checked with sample_codec_stream_bytes().
+ * Groups are unpacked one at a time into vals[]; reads may stop anywhere.
+ */
+typedef struct {
+    const uint8_t *src;         /* next group */
+    size_t left;                /* values not yet unpacked */
+    uint32_t prev;
+    uint32_t avail;             /* unpacked values not yet returned */
+    uint32_t next;              /* index of the next one in vals */
+    int32_t vals[SAMPLE_CODEC_GROUP];
+} sample_codec_reader_t;
+
+void sample_codec_reader_init(sample_codec_reader_t *rd, const uint8_t *src, size_t n);
+
+/* Next count values (at most those left) into dst[0], dst[stride], ...; dst == NULL skips them. */
+void sample_codec_read(sample_codec_reader_t *rd, size_t count, int32_t *dst, size_t stride);
+
+#endif /* SAMPLE_CODEC_H */
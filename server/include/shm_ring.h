@@ -0,0 +1,159 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Miguel Dovale (University of Arizona)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef SHM_RING_H
+#define SHM_RING_H
+
+#include "ads1278.h"
+
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Frame ring in a named POSIX shared memory object (shm_open), for local
+ * processes that want the acquired frames without opening the device or a
+ * TCP connection. One writer (the acquisition thread) publishes; any number
+ * of read-only processes map it and read frames in place.
+ *
+ * Readers never hold up the writer. Each keeps its own position and checks
+ * after reading that the writer has not started to overwrite what it read
+ * (a seqlock over the whole ring): the writer advances `claim` before it
+ * touches a slot and `head` once the slot is complete, so a frame read at
+ * position p is intact if claim <= p + capacity afterwards. A reader that was
+ * lapped discards what it read and resumes at the newest frame.
+ *
+ * The layout is a stable ABI (native byte order): a SHM_RING_HEADER_BYTES
+ * header, then capacity slots of slot_bytes each, slot i holding frame
+ * i mod capacity. The writer unlinks the name when it closes; readers still
+ * attached see state SHM_RING_CLOSED and can reopen once a new writer is up.
+ */
+#define SHM_RING_MAGIC 0x52535052U      /* "RPSR" in memory */
+#define SHM_RING_VERSION 1U
+#define SHM_RING_HEADER_BYTES 256U
+#define SHM_RING_DEFAULT_NAME "/rp-daq-frames"
+#define SHM_RING_DEFAULT_FRAMES 65536U
+#define SHM_RING_CACHE_LINE_BYTES 64U
+
+enum {
+    SHM_RING_LIVE = 1,
+    SHM_RING_CLOSED = 2
+};
+
+typedef struct {
+    /* immutable once state is SHM_RING_LIVE */
+    alignas(SHM_RING_CACHE_LINE_BYTES) uint32_t magic;
+    uint16_t version;
+    uint16_t header_bytes;      /* offset of slot 0 */
+    uint32_t channels;          /* ch[] entries per slot */
+    uint32_t slot_bytes;
+    uint64_t capacity;          /* slots, power of two */
+    uint64_t sample_rate_hz;    /* nominal, 0 = unknown */
+    int64_t writer_pid;
+    uint64_t created_ns;        /* CLOCK_REALTIME at creation, tells restarts apart */
+    _Atomic uint32_t state;
+
+    /* writer cursors, frames since creation */
+    alignas(SHM_RING_CACHE_LINE_BYTES) _Atomic uint64_t claim;   /* slots being written: [head, claim) */
+    alignas(SHM_RING_CACHE_LINE_BYTES) _Atomic uint64_t head;    /* frames [0, head) are complete */
+} shm_ring_header_t;
+
+/* One frame; ch[] holds the header's channels entries. */
+typedef struct {
+    uint64_t seq;
+    uint64_t tstamp_ns;
+    int32_t ch[];
+} shm_ring_slot_t;
+
+typedef struct {
+    const char *name;           /* "/name", NULL = SHM_RING_DEFAULT_NAME */
+    uint64_t capacity;          /* frames, power of two, 0 = SHM_RING_DEFAULT_FRAMES */
+    uint32_t channels;          /* 0 = 8 */
+    uint64_t sample_rate_hz;
+} shm_ring_cfg_t;
+
+typedef struct {
+    uint64_t frames;            /* frames accepted */
+    uint64_t laps;              /* times the writer overtook this reader */
+    uint64_t frames_lost;       /* frames skipped by those laps */
+} shm_ring_reader_stats_t;
+
+typedef struct shm_ring_writer shm_ring_writer_t;
+typedef struct shm_ring_reader shm_ring_reader_t;
+
+/*
+ * Create the object (mode 0644). A stale object from a writer that is no
+ * longer running is replaced; -1/EBUSY if its writer is still alive,
+ * -1/ENOTSUP if 64-bit atomics are not lock-free here.
+ */
+int shm_ring_writer_create(shm_ring_writer_t **out, const shm_ring_cfg_t *cfg);
+
+/* Writer thread only; never blocks. Only the first channels of each frame are kept. */
+void shm_ring_writer_publish(shm_ring_writer_t *w, const ads1278_frame_t *frames, size_t n);
+
+uint64_t shm_ring_writer_frames(const shm_ring_writer_t *w);
+
+/* Mark the ring closed, unlink the name and unmap. */
+void shm_ring_writer_destroy(shm_ring_writer_t *w);
+
+/*
+ * Map an existing ring read-only. The reader starts at the newest frame, or
+ * with from_oldest at the oldest one still in the ring. -1/EPROTO on a bad
+ * magic or version, -1/EAGAIN while the writer is still initialising it.
+ */
+int shm_ring_reader_open(shm_ring_reader_t **out, const char *name, bool from_oldest);
+
+const shm_ring_header_t *shm_ring_reader_header(const shm_ring_reader_t *r);
+
+/*
+ * Zero-copy read: frames [*first, *first + n) are published and can be read
+ * in place with shm_ring_reader_slot() (n <= max, 0 if none yet). Then call
+ * release(n): it returns 0 if they were intact, or -1/ESTALE if the writer
+ * lapped the reader meanwhile; their contents must then be discarded, and
+ * the reader has moved to the newest frame.
+ */
+size_t shm_ring_reader_peek(shm_ring_reader_t *r, uint64_t *first, size_t max);
+const shm_ring_slot_t *shm_ring_reader_slot(const shm_ring_reader_t *r, uint64_t pos);
+int shm_ring_reader_release(shm_ring_reader_t *r, size_t n);
+
+/* Copying read built on peek/release; retries after a lap. */
+size_t shm_ring_reader_read(shm_ring_reader_t *r, ads1278_frame_t *out, size_t max);
+
+/* True once the writer closed the ring or its process is gone. */
+bool shm_ring_reader_closed(const shm_ring_reader_t *r);
+
+void shm_ring_reader_get_stats(const shm_ring_reader_t *r, shm_ring_reader_stats_t *out);
+void shm_ring_reader_close(shm_ring_reader_t *r);
+
+#endif /* SHM_RING_H */
@@ -0,0 +1,219 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Miguel Dovale (University of Arizona)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef STREAM_SERVER_H
+#define STREAM_SERVER_H
+
+#include "acq.h"
+#include "chan_stats.h"
+#include "decim.h"
+#include "proto.h"
+#include "psd.h"
+#include "trigger.h"
+#include "udp_sender.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Single-threaded epoll TCP server. The event loop is the acquisition ring's
+ * only consumer: it packs frames into DATA messages kept in a fixed shared
+ * history, and every client has its own cursor into that history. The
+ * history is bounded by a message count, a frame count and a byte arena;
+ * what happens when it evicts a message a client has not been sent depends
+ * on the session's policy (stream_policy_t, chosen by the client with
+ * SUBSCRIBE or the server default):
+ *
+ *   drop-oldest  the client skips ahead and is sent a GAP naming the dropped
+ *                messages and frames; the stream never waits for it
+ *   disconnect   the connection is closed once the oldest unsent message is
+ *                max_lag_ms old (or is about to be evicted), so a client that
+ *                reconnects and resumes finds its backlog still in the history
+ *   never-drop   no message is ever skipped: the client gets every message
+ *                the history can hold for it, and is closed (to reconnect and
+ *                resume) rather than sent a GAP once one would be evicted
+ *                unsent; acquisition and other clients never wait for it
+ *
+ * A SUBSCRIBE with a resume seq moves the client's cursor back to the
+ * message holding that frame and replays the backlog as fast as the socket
+ * takes it.
+ *
+ * With stats_ms set, a STATS message (per-stage latency summaries and pipeline
+ * counters) is published into the same history every stats_ms; it takes a
+ * msg_seq like DATA, so gap detection covers both.
+ *
+ * With a trigger configured the server sends EVENT messages instead of DATA:
+ * each carries one capture window, and frames outside windows are dropped.
+ *
+ * With summary_ms set, a SUMMARY message (per-channel min/max/mean/RMS of the
+ * streamed frames since the previous one, in volts with a calibration table)
+ * is published every summary_ms; summary_only drops DATA so dashboards get
+ * a few hundred bytes per period instead of the raw stream.
+ *
+ * With a PSD configured, every Welch result is published as one SPECTRUM
+ * message per channel; with summary_only as well, those replace DATA.
+ */
+#define STREAM_DEFAULT_MAX_CLIENTS 8U
+#define STREAM_DEFAULT_HISTORY_MSGS 256U
+#define STREAM_TRIGGER_HISTORY_MSGS 16U /* default history with a trigger: slots are whole windows */
+#define STREAM_DEFAULT_STATS_MS 1000U
+#define STREAM_DEFAULT_SUMMARY_MS 1000U
+#define STREAM_IOV_MAX 64U
+#define STREAM_DEFAULT_MAX_LAG_MS 2000U
+#define STREAM_SESSION_LOG 16U      /* closed sessions kept for stream_server_get_sessions() */
+#define STREAM_PEER_BYTES 24U
+
+typedef enum {
+    STREAM_MODE_LATENCY = 0,    /* TCP_NODELAY, small messages, short flush interval */
+    STREAM_MODE_THROUGHPUT      /* TCP_CORK around send bursts, large messages */
+} stream_mode_t;
+
+typedef enum {
+    STREAM_POLICY_DROP_OLDEST = PROTO_POLICY_DROP_OLDEST,
+    STREAM_POLICY_DISCONNECT = PROTO_POLICY_DISCONNECT,
+    STREAM_POLICY_NEVER_DROP = PROTO_POLICY_NEVER_DROP
+} stream_policy_t;
+
+typedef enum {
+    STREAM_CLOSE_NONE = 0,      /* still open */
+    STREAM_CLOSE_PEER,          /* the client closed or reset the connection */
+    STREAM_CLOSE_ERROR,         /* send failure */
+    STREAM_CLOSE_PROTOCOL,      /* malformed client message */
+    STREAM_CLOSE_LAGGING,       /* disconnect policy: oldest unsent message older than max_lag_ms */
+    STREAM_CLOSE_OVERRUN        /* disconnect/never-drop policy: the history had to evict an unsent message */
+} stream_close_t;
+
+typedef struct {
+    const char *bind_addr;      /* IPv4 literal, NULL = any */
+    uint16_t port;              /* 0 = ephemeral (see stream_server_port) */
+    stream_mode_t mode;
+    uint32_t frames_per_msg;    /* 0 = mode default */
+    uint32_t flush_us;          /* 0 = mode default */
+    uint32_t history_msgs;      /* power of two, 0 = sized for history_frames/bytes or STREAM_DEFAULT_HISTORY_MSGS */
+    uint64_t history_frames;    /* keep at most this many DATA/EVENT frames, 0 = no frame bound */
+    size_t history_bytes;       /* message arena, 0 = history_msgs full-size messages */
+    stream_policy_t policy;     /* for sessions that do not SUBSCRIBE one, 0 = drop-oldest */
+    uint32_t max_lag_ms;        /* disconnect policy limit, 0 = STREAM_DEFAULT_MAX_LAG_MS */
+    uint32_t max_clients;       /* 0 = STREAM_DEFAULT_MAX_CLIENTS */
+    uint16_t encoding;          /* PROTO_DATA_ENC_*, 0 = P24 */
+    bool linear_ts;             /* P24/DELTA timestamps as base + rate when on a line (PROTO_DATA_LINEAR_TS) */
+    uint32_t linear_tolerance_ns; /* allowed distance from that line, 0 = exact */
+    uint32_t start_clients;     /* start acquisition once this many clients are connected */
+    const decim_cfg_t *decim;   /* decimate before packing, NULL = raw DRDY frames */
+    size_t decim_groups;        /* channel groups in decim[], 0 = 1 */
+    const trigger_cfg_t *trigger; /* send triggered windows as EVENT messages, NULL = continuous DATA */
+    uint32_t stats_ms;          /* STATS message period, 0 = none */
+    uint32_t summary_ms;        /* SUMMARY message period, 0 = none */
+    bool summary_only;          /* no DATA (needs summary_ms or psd); EVENTs are still sent */
+    const psd_cfg_t *psd;       /* SPECTRUM messages, NULL = none; channel count and rate filled in */
+    const chan_calib_t *calib;  /* SUMMARY and SPECTRUM values in volts, NULL = ADC codes */
+    const udp_sender_cfg_t *udp; /* also send DATA as datagrams (not with trigger or summary_only), NULL = TCP only;
+                                  * encoding, hello and announce are filled in */
+    bool io_uring;              /* batch the per-tick client sends into one io_uring_enter() when available */
+    proto_config_t announce;    /* CONFIG payload; stream fields are filled in by the server */
+} stream_server_cfg_t;
+
+typedef struct {
+    uint64_t frames_in;         /* frames taken from the acquisition ring */
+    uint64_t frames_out;        /* frames packed into DATA/EVENT messages (fewer with decimation or a trigger) */
+    uint64_t msgs_published;
+    uint64_t bytes_sent;        /* all clients */
+    uint64_t send_calls;
+    uint64_t send_syscalls;     /* sendmsg(), TCP_CORK setsockopt() and io_uring_enter() calls */
+    bool io_uring;              /* cfg.io_uring was requested and available */
+    uint64_t clients_accepted;
+    uint64_t clients_rejected;  /* over max_clients */
+    uint64_t clients_closed;
+    uint64_t msgs_dropped;      /* summed over clients that fell behind the history */
+    uint64_t gaps_sent;         /* GAP messages, resume replies included */
+    uint64_t clients_lagging;   /* closed by the disconnect or never-drop policy */
+    uint64_t resumes;           /* SUBSCRIBEs with a resume seq */
+    uint64_t msgs_replayed;     /* history messages those resumes rewound over */
+    uint64_t stats_published;   /* STATS messages */
+    uint64_t events_published;  /* EVENT messages */
+    uint64_t summaries_published; /* SUMMARY messages */
+    uint64_t spectra_published; /* SPECTRUM messages (one per channel per result) */
+    uint64_t linear_ts_msgs;    /* DATA/EVENT messages sent with PROTO_DATA_LINEAR_TS */
+    trigger_stats_t trigger;    /* zero without a trigger */
+    psd_stats_t psd;            /* zero without a PSD */
+    lat_hist_t net_send;        /* message published to last byte accepted by a client's socket */
+    udp_sender_stats_t udp;     /* zero without cfg.udp */
+} stream_server_stats_t;
+
+/* Per-connection counters. */
+typedef struct {
+    uint64_t id;                /* accept order, from 1 */
+    char peer[STREAM_PEER_BYTES]; /* "a.b.c.d:port" */
+    stream_policy_t policy;
+    uint32_t max_lag_ms;
+    stream_close_t closed;      /* STREAM_CLOSE_NONE while connected */
+    uint64_t msgs_sent;         /* history messages fully sent */
+    uint64_t bytes_sent;        /* preamble and GAPs included */
+    uint64_t msgs_dropped;
+    uint64_t frames_dropped;
+    uint64_t gaps_sent;
+    uint64_t resumes;
+    uint64_t msgs_replayed;
+    uint64_t max_lag_msgs;      /* largest backlog seen on a flush tick */
+} stream_session_stats_t;
+
+typedef struct stream_server stream_server_t;
+
+int stream_server_create(stream_server_t **out, const stream_server_cfg_t *cfg, acq_t *acq);
+
+/* Bound port (useful with port 0). */
+uint16_t stream_server_port(const stream_server_t *srv);
+
+/*
+ * Run the event loop: start acquisition (after start_clients connections),
+ * stream until acquisition ends and every client has been sent everything,
+ * or until stream_server_stop(). Returns -1 with errno on a loop failure.
+ */
+int stream_server_run(stream_server_t *srv);
+
+/* Async-signal-safe; may be called from any thread. */
+void stream_server_stop(stream_server_t *srv);
+
+void stream_server_get_stats(const stream_server_t *srv, stream_server_stats_t *out);
+
+/*
+ * Open sessions and the last STREAM_SESSION_LOG closed ones, in accept
+ * order; returns how many were written to out (at most max).
+ */
+size_t stream_server_get_sessions(const stream_server_t *srv, stream_session_stats_t *out, size_t max);
+void stream_server_destroy(stream_server_t *srv);
+
+const char *stream_mode_name(stream_mode_t mode);
+const char *stream_policy_name(stream_policy_t policy);
+const char *stream_close_name(stream_close_t reason);
+
+#endif /* STREAM_SERVER_H */
@@ -0,0 +1,145 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Miguel Dovale (University of Arizona)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef TRIGGER_H
+#define TRIGGER_H
+
+#include "ads1278.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Triggered capture. Frames stream through trigger_process() on the consumer
+ * side of the acquisition ring (after decimation, if any); the last
+ * pre_frames of them are kept in a history ring. When any condition fires,
+ * the engine copies that history, collects the trigger frame and post_frames
+ * more, and hands the whole window back as one event. Conditions are then
+ * ignored until holdoff_frames have passed after the window.
+ *
+ * Every condition watches one channel with hysteresis: after firing it
+ * re-arms only once the signal has moved back by hysteresis codes, so noise
+ * around the level does not retrigger. An external trigger (trigger_fire(),
+ * or a GPIO line watched by an internal thread) fires on the first frame
+ * whose tstamp_ns is at or after the edge.
+ *
+ * A window never spans a seq gap: a gap clears the history and ends an open
+ * window early (stats.truncated).
+ */
+#define TRIGGER_MAX_CONDITIONS 8U
+#define TRIGGER_MAX_WINDOW_FRAMES (1U << 20)
+#define TRIGGER_EXTERNAL 0xFFFFU    /* trigger_event_t.condition of an external trigger */
+
+typedef enum {
+    TRIGGER_RISING = 1,         /* crosses up through level */
+    TRIGGER_FALLING,            /* crosses down through level */
+    TRIGGER_SLOPE_UP,           /* ch[n] - ch[n - 1] >= level */
+    TRIGGER_SLOPE_DOWN,         /* ch[n] - ch[n - 1] <= -level */
+    TRIGGER_WINDOW_EXIT,        /* leaves [level, high] */
+    TRIGGER_WINDOW_ENTER        /* enters [level, high] */
+} trigger_kind_t;
+
+typedef struct {
+    uint32_t kind;              /* trigger_kind_t */
+    uint32_t channel;           /* index into ch[] */
+    int32_t level;              /* crossing level, slope magnitude or window low edge */
+    int32_t high;               /* window high edge */
+    uint32_t hysteresis;        /* codes the signal must move back by to re-arm */
+} trigger_cond_t;
+
+typedef struct {
+    trigger_cond_t cond[TRIGGER_MAX_CONDITIONS];
+    uint32_t cond_count;        /* any condition fires the trigger */
+    uint32_t pre_frames;        /* frames before the trigger frame */
+    uint32_t post_frames;       /* frames after it */
+    uint32_t holdoff_frames;    /* frames after a window before the next can start */
+    uint32_t channel_count;     /* channels per frame, 0 = 8 (bounds cond[].channel) */
+    bool use_gpio;              /* external trigger on falling edges of this line: */
+    const char *gpio_chip;      /*   NULL = sysfs GPIO number, as ads1278_edge_open() */
+    uint32_t gpio_line;
+} trigger_cfg_t;
+
+typedef struct {
+    uint64_t id;                /* 0, 1, ... */
+    uint64_t trigger_seq;
+    uint64_t trigger_tstamp_ns;
+    uint32_t condition;         /* index into cfg.cond, or TRIGGER_EXTERNAL */
+    uint32_t pre_frames;        /* frames[pre_frames] is the trigger frame */
+    const ads1278_frame_t *frames; /* valid until the next trigger_process() */
+    uint32_t frame_count;       /* 0 = no event */
+} trigger_event_t;
+
+typedef struct {
+    uint64_t frames_in;
+    uint64_t events;
+    uint64_t suppressed;        /* conditions met during a window or holdoff */
+    uint64_t truncated;         /* windows cut short by a seq gap or trigger_flush() */
+    uint64_t external;          /* external edges received */
+} trigger_stats_t;
+
+typedef struct trigger trigger_t;
+
+/*
+ * Parse "pre=N,post=N,holdoff=N" and conditions into cfg, which is zeroed
+ * first. "ch=C" (1-based, default 1) selects the channel for the conditions
+ * after it; conditions are "rise=L", "fall=L", "slope=S" (negative: falling),
+ * "outside=LO:HI" and "inside=LO:HI", each optionally followed by "hyst=H".
+ * Returns -1 on a malformed spec.
+ */
+int trigger_parse_spec(const char *spec, trigger_cfg_t *cfg);
+
+/* Starts the GPIO watcher thread when cfg->use_gpio. */
+int trigger_create(trigger_t **out, const trigger_cfg_t *cfg);
+void trigger_destroy(trigger_t *trig);
+
+/* pre_frames + 1 + post_frames. */
+uint32_t trigger_window_frames(const trigger_t *trig);
+
+/*
+ * Feed n frames. Returns how many were consumed: all of them, or fewer when
+ * a window completed, in which case *event describes it (frame_count != 0)
+ * and the caller passes the rest in again after handling it.
+ */
+size_t trigger_process(trigger_t *trig, const ads1278_frame_t *frames, size_t n, trigger_event_t *event);
+
+/* End of stream: hand out an open window as it stands (frame_count 0 if none). */
+void trigger_flush(trigger_t *trig, trigger_event_t *event);
+
+/* External trigger at a CLOCK_MONOTONIC time; safe from any thread. */
+void trigger_fire(trigger_t *trig, uint64_t tstamp_ns);
+
+/* The GPIO watcher's errno if it stopped on an error, else 0. */
+int trigger_get_error(const trigger_t *trig);
+
+void trigger_get_stats(const trigger_t *trig, trigger_stats_t *out);
+
+#endif /* TRIGGER_H */
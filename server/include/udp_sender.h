@@ -0,0 +1,106 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Miguel Dovale (University of Arizona)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef UDP_SENDER_H
+#define UDP_SENDER_H
+
+#include "ads1278.h"
+#include "proto.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Connectionless DATA transport for many passive listeners. Frames are packed
+ * into DATA messages that each fit one datagram under the link MTU; msg_seq
+ * counts datagrams, so a receiver detects loss from msg_seq and first_seq
+ * alone and the sender keeps no per-receiver state. Full datagrams are queued
+ * and handed to the kernel in one sendmmsg() per batch on a non-blocking
+ * socket: a datagram the socket cannot take is dropped and counted, never
+ * waited for. HELLO and CONFIG are repeated every announce_ms for listeners
+ * that join late.
+ */
+#define UDP_DEFAULT_MTU 1500U
+#define UDP_DEFAULT_BATCH 32U
+#define UDP_MAX_BATCH 1024U
+#define UDP_DEFAULT_SNDBUF (1U << 20)
+#define UDP_DEFAULT_ANNOUNCE_MS 1000U
+#define UDP_IP_OVERHEAD 28U         /* IPv4 + UDP headers */
+
+typedef struct {
+    const char *dest;           /* IPv4 literal: a multicast group (224.0.0.0/4) or a unicast host */
+    uint16_t port;
+    const char *iface;          /* multicast: IPv4 of the outgoing interface, NULL = routing default */
+    uint8_t ttl;                /* multicast hops, 0 = 1 (this subnet only) */
+    bool no_loop;               /* multicast: do not deliver to listeners on this host */
+    uint32_t mtu;               /* link MTU, 0 = UDP_DEFAULT_MTU */
+    uint32_t batch;             /* datagrams per sendmmsg(), 0 = UDP_DEFAULT_BATCH */
+    uint32_t sndbuf;            /* SO_SNDBUF request in bytes, 0 = UDP_DEFAULT_SNDBUF */
+    uint32_t announce_ms;       /* HELLO + CONFIG period, 0 = UDP_DEFAULT_ANNOUNCE_MS */
+    uint16_t encoding;          /* PROTO_DATA_ENC_*, 0 = P24 */
+    bool linear_ts;             /* as stream_server_cfg_t */
+    uint32_t linear_tolerance_ns;
+    proto_hello_t hello;        /* channel_count sets the frame width (0 = 8) */
+    proto_config_t announce;
+} udp_sender_cfg_t;
+
+typedef struct {
+    uint32_t frames_per_datagram;
+    uint32_t sndbuf;            /* SO_SNDBUF as granted by the kernel */
+    uint64_t frames;            /* frames packed */
+    uint64_t datagrams;         /* DATA datagrams accepted by the socket */
+    uint64_t bytes;             /* UDP payload bytes accepted, announcements included */
+    uint64_t send_calls;        /* sendmmsg() calls */
+    uint64_t dropped;           /* DATA datagrams not sent: socket buffer full or a send error */
+    uint64_t send_errors;       /* sendmmsg() failures other than EAGAIN/ENOBUFS */
+    uint64_t announces;         /* HELLO + CONFIG pairs */
+    uint64_t linear_ts_msgs;
+} udp_sender_stats_t;
+
+typedef struct udp_sender udp_sender_t;
+
+/* -1/EINVAL on a bad address, -1/EMSGSIZE when one frame does not fit the MTU. */
+int udp_sender_create(udp_sender_t **out, const udp_sender_cfg_t *cfg);
+
+/* Pack frames; every full batch of datagrams is sent before this returns. */
+void udp_sender_push(udp_sender_t *snd, const ads1278_frame_t *frames, size_t n);
+
+/* Close the open datagram, send everything queued and announce if due. */
+void udp_sender_flush(udp_sender_t *snd);
+
+void udp_sender_get_stats(const udp_sender_t *snd, udp_sender_stats_t *out);
+
+/* Flushes first. */
+void udp_sender_destroy(udp_sender_t *snd);
+
+#endif /* UDP_SENDER_H */
@@ -0,0 +1,97 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Miguel Dovale (University of Arizona)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef URING_H
+#define URING_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/socket.h>
+
+/*
+ * Minimal io_uring wrapper (raw syscalls, no liburing) for the two hot I/O
+ * paths: capture block writes and the per-tick client send fan-out. Callers
+ * queue several requests and hand them to the kernel with one
+ * io_uring_enter(), instead of one write()/sendmsg() each.
+ *
+ * Optional at run time: uring_probe() fails on kernels without io_uring or
+ * without the opcodes used here (5.6+ for the probe itself), under seccomp
+ * filters that block it, and when the tree was built without
+ * <linux/io_uring.h>; callers then keep their plain syscall path.
+ *
+ * One thread per ring; nothing here is thread-safe.
+ */
+typedef struct uring uring_t;
+
+typedef struct {
+    uint64_t user_data;
+    int32_t res;                /* bytes, or -errno */
+} uring_cqe_t;
+
+typedef struct {
+    uint64_t enters;            /* io_uring_enter() calls */
+    uint64_t sqes;              /* requests submitted */
+    uint64_t fixed_writes;      /* writes from the registered buffer */
+} uring_stats_t;
+
+/* 0 if io_uring with write, write-fixed and sendmsg is usable; -1/errno otherwise. */
+int uring_probe(void);
+
+/* entries: requests in flight at most, rounded up to a power of two. */
+int uring_create(uring_t **out, uint32_t entries);
+
+/*
+ * Register [base, base + len) as fixed buffer 0 (pinned once instead of per
+ * write). Fails with ENOMEM under a low RLIMIT_MEMLOCK on older kernels;
+ * writes then simply go unregistered.
+ */
+int uring_register_buffer(uring_t *ring, void *base, size_t len);
+
+/*
+ * Queue a request; -1/EBUSY when uring_create()'s entries are already queued
+ * or in flight. Writes inside the registered buffer use it automatically.
+ * mh must stay valid until its completion is reaped.
+ */
+int uring_prep_write(uring_t *ring, int fd, const void *buf, size_t len, uint64_t offset, uint64_t user_data);
+int uring_prep_sendmsg(uring_t *ring, int fd, const struct msghdr *mh, int flags, uint64_t user_data);
+
+/* Submit everything queued and wait until wait_nr completions are ready. */
+int uring_submit_wait(uring_t *ring, uint32_t wait_nr);
+
+/* Take up to max completions, in completion order. */
+size_t uring_reap(uring_t *ring, uring_cqe_t *out, size_t max);
+
+void uring_get_stats(const uring_t *ring, uring_stats_t *out);
+void uring_destroy(uring_t *ring);
+
+#endif /* URING_H */
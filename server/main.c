@@ -29,8 +29,1049 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
-/* Placeholder until DAQ server is implemented. */
-int main(void)
+/*
+ * DAQ server: acquisition thread -> SPSC ring -> epoll streaming loop. One
+ * process serves up to --max-clients TCP clients (docs/protocol.md) and,
+ * with --udp, any number of passive datagram listeners; --shm also maps the
+ * frames for local processes (shm_ring.h).
+ */
+
+#include "acq.h"
+#include "ads1278.h"
+#include "chan_stats.h"
+#include "clock_model.h"
+#include "decim.h"
+#include "psd.h"
+#include "stream_server.h"
+#include "trigger.h"
+#include "shm_ring.h"
+#include "udp_sender.h"
+
+#include <errno.h>
+#include <getopt.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    uint32_t gpio_number;       /* sysfs global number, or line offset on chip */
+    char chip[64];              /* empty = sysfs, else /dev/gpiochipN */
+    bool set;
+} gpio_endpoint_t;
+
+enum {
+    OPT_BACKEND = 0x100,
+    OPT_SIM_RATE_HZ,
+    OPT_SIM_SIGNAL,
+    OPT_SIM_AMPLITUDE,
+    OPT_SIM_SIGNAL_HZ,
+    OPT_SIM_BUSY_WAIT,
+    OPT_RING_FRAMES,
+    OPT_BIND,
+    OPT_MODE,
+    OPT_FRAMES_PER_MSG,
+    OPT_ENCODING,
+    OPT_FLUSH_US,
+    OPT_HISTORY_MSGS,
+    OPT_MAX_CLIENTS,
+    OPT_WAIT_CLIENTS,
+    OPT_DECIM,
+    OPT_TRIGGER,
+    OPT_TRIGGER_GPIO,
+    OPT_STATS_MS,
+    OPT_SUMMARY_MS,
+    OPT_SUMMARY_ONLY,
+    OPT_PSD,
+    OPT_CALIB,
+    OPT_VREF,
+    OPT_RT_PRIORITY,
+    OPT_RT_CPUS,
+    OPT_MLOCK,
+    OPT_CHAIN,
+    OPT_SMOOTH_TSTAMPS,
+    OPT_HISTORY_FRAMES,
+    OPT_HISTORY_MB,
+    OPT_POLICY,
+    OPT_MAX_LAG_MS,
+    OPT_IO_URING,
+    OPT_UDP,
+    OPT_UDP_IFACE,
+    OPT_UDP_TTL,
+    OPT_UDP_MTU,
+    OPT_UDP_BATCH,
+    OPT_UDP_SNDBUF_KB,
+    OPT_UDP_NO_LOOP,
+    OPT_SHM,
+    OPT_SHM_FRAMES
+};
+
+static const char *const k_sim_signal_names[] = {
+    [ADS1278_SIM_SIGNAL_ZERO] = "zero",
+    [ADS1278_SIM_SIGNAL_RAMP] = "ramp",
+    [ADS1278_SIM_SIGNAL_SINE] = "sine",
+    [ADS1278_SIM_SIGNAL_SQUARE] = "square",
+    [ADS1278_SIM_SIGNAL_NOISE] = "noise"
+};
+
+static stream_server_t *g_server;
+
+static void usage(FILE *stream, const char *prog_name)
 {
-	return 0;
-}
\ No newline at end of file
+    fprintf(stream,
+        "Usage: %s [options]\n"
+        "\n"
+        "Acquisition:\n"
+        "  --backend <spidev|sim>               Frame source (default: spidev)\n"
+        "  --spidev <path>                      SPI device (default: %s)\n"
+        "  --sclk-hz <hz>                       SPI clock (default: 1000000)\n"
+        "  --spi-mode <0..3>                    SPI mode (default: 0)\n"
+        "  --chain <n>                          Daisy-chained ADS1278s on one DOUT (default: 1, max: %u)\n"
+        "  --drdy <endpoint>                    DRDY input GPIO (required for spidev)\n"
+        "  --sync <endpoint>                    SYNC output GPIO\n"
+        "  --no-sync                            Disable SYNC pulse\n"
+        "  --settle-frames <n>                  Discard N frames after SYNC pulse\n"
+        "  --drdy-timeout-ms <ms>               DRDY wait timeout, 0 = none (default: %u)\n"
+        "  --smooth-tstamps                     Stamp frames from the fitted conversion clock (no wakeup\n"
+        "                                       jitter), so DATA messages fit base + rate timestamps\n"
+        "  --frames <n>                         Stop after N frames, 0 = run until signalled (default: 0)\n"
+        "  --ring-frames <n>                    Acquisition ring size, power of two (default: %u)\n"
+        "  --rt-priority <1..99>                Run the acquisition thread SCHED_FIFO at this priority\n"
+        "  --rt-cpus <list>                     Pin the acquisition thread, e.g. 1 or 0,2-3\n"
+        "  --mlock                              Lock and prefault all memory (mlockall)\n"
+        "\n"
+        "Simulator (--backend sim):\n"
+        "  --sim-rate-hz <hz>                   Synthetic DRDY rate, 0 = free-run (default: %u)\n"
+        "  --sim-signal <name>                  zero|ramp|sine|square|noise (default: ramp)\n"
+        "  --sim-amplitude <code>               Peak code (default: half scale)\n"
+        "  --sim-signal-hz <hz>                 Sine/square frequency (default: rate/100)\n"
+        "  --sim-busy-wait                      Spin for DRDY edges instead of sleeping\n"
+        "\n",
+        prog_name,
+        ADS1278_DEFAULT_SPIDEV,
+        (unsigned)ADS1278_MAX_CHAIN,
+        ADS1278_DEFAULT_DRDY_TIMEOUT_MS,
+        ACQ_RING_DEFAULT_CAPACITY,
+        ADS1278_SIM_DEFAULT_RATE_HZ);
+    fprintf(stream,
+        "Streaming:\n"
+        "  --port <n>                           TCP listen port, 0 = ephemeral (default: %u)\n"
+        "  --bind <ipv4>                        Listen address (default: any)\n"
+        "  --mode <latency|throughput>          Socket tuning and message sizing (default: latency)\n"
+        "  --frames-per-msg <n>                 Frames per DATA message (default: per mode)\n"
+        "  --encoding <p24|delta|record48>      DATA encoding (default: p24)\n"
+        "  --flush-us <us>                      Send partial messages after this long (default: per mode)\n"
+        "  --history-msgs <n>                   Shared message history, power of two (default: %u, or\n"
+        "                                       sized for --history-frames/--history-mb)\n"
+        "  --history-frames <n>                 Keep at most N frames of history\n"
+        "  --history-mb <n>                     Message history memory in MiB (default: history-msgs\n"
+        "                                       full-size messages)\n"
+        "  --policy <drop|disconnect|never>     Backpressure for clients that do not SUBSCRIBE one\n"
+        "                                       (default: drop)\n"
+        "  --max-lag-ms <ms>                    Disconnect-policy lag limit (default: %u)\n"
+        "  --io-uring                           Batch each tick's client sends into one io_uring\n"
+        "                                       submission when the kernel supports it\n"
+        "  --max-clients <n>                    Concurrent clients (default: %u)\n"
+        "  --wait-clients <n>                   Start acquisition once N clients are connected\n"
+        "  --decim <spec>                       Stream decimated frames, e.g. cic=64 or cic=16,fir=4\n"
+        "                                       (keys cic, order, fir, taps, pass, mask); repeat with\n"
+        "                                       disjoint masks and the same total factor for per-group\n"
+        "                                       filters; only the masked channels are sent\n"
+        "  --trigger <spec>                     Send triggered windows as EVENT messages instead of DATA,\n"
+        "                                       e.g. pre=1000,post=4000,ch=2,rise=100000,hyst=500\n"
+        "                                       (keys pre, post, holdoff, ch, rise, fall, slope, outside,\n"
+        "                                       inside, hyst)\n"
+        "  --trigger-gpio <endpoint>            External trigger on falling edges of this input GPIO\n"
+        "  --stats-ms <ms>                      STATS message period, 0 = off (default: %u)\n"
+        "  --summary-ms <ms>                    Per-channel min/max/mean/RMS SUMMARY period, 0 = off\n"
+        "                                       (default: off, %u with --summary-only)\n"
+        "  --summary-only                       Send SUMMARY/SPECTRUM (and STATS) messages instead of DATA\n"
+        "  --psd <spec>                         Welch PSD per channel as SPECTRUM messages, e.g.\n"
+        "                                       fft=4096,avg=16 (keys fft, hop, avg, window=hann|rect|bh,\n"
+        "                                       bins, detrend)\n"
+        "  --calib <file>                       Report SUMMARY/SPECTRUM values in volts using a per-channel\n"
+        "                                       gain/offset table (lines: channel gain offset)\n"
+        "  --vref <volts>                       Reference voltage for volts (default: %.1f)\n"
+        "  --help                               Show this help text\n",
+        PROTO_DEFAULT_PORT,
+        STREAM_DEFAULT_HISTORY_MSGS,
+        STREAM_DEFAULT_MAX_LAG_MS,
+        STREAM_DEFAULT_MAX_CLIENTS,
+        STREAM_DEFAULT_STATS_MS,
+        STREAM_DEFAULT_SUMMARY_MS,
+        CHAN_CALIB_DEFAULT_VREF);
+    fprintf(stream,
+        "\n"
+        "UDP (DATA only, no per-listener state):\n"
+        "  --udp <ipv4:port>                    Also send DATA datagrams to a multicast group or host\n"
+        "  --udp-iface <ipv4>                   Multicast outgoing interface address (default: routing)\n"
+        "  --udp-ttl <n>                        Multicast hops (default: 1)\n"
+        "  --udp-mtu <bytes>                    Keep datagrams under this link MTU (default: %u)\n"
+        "  --udp-batch <n>                      Datagrams per sendmmsg() (default: %u, max: %u)\n"
+        "  --udp-sndbuf-kb <n>                  Socket send buffer (default: %u)\n"
+        "  --udp-no-loop                        Do not deliver multicast to listeners on this host\n"
+        "\n"
+        "Shared memory (local read-only readers, see shm_ring.h):\n"
+        "  --shm <name>                         Also publish every frame to POSIX shm object /name\n"
+        "  --shm-frames <n>                     Shared ring size, power of two (default: %u)\n"
+        "\n"
+        "GPIO endpoints:\n"
+        "  N | sysfs:N                          sysfs global GPIO number (e.g. 968)\n"
+        "  gpiochipK:N | /dev/gpiochipK:N       character device line offset N\n",
+        UDP_DEFAULT_MTU,
+        UDP_DEFAULT_BATCH,
+        UDP_MAX_BATCH,
+        UDP_DEFAULT_SNDBUF / 1024U,
+        SHM_RING_DEFAULT_FRAMES);
+}
+
+static int parse_u32(const char *text, uint32_t *out_value)
+{
+    char *end = NULL;
+    unsigned long value;
+
+    errno = 0;
+    value = strtoul(text, &end, 10);
+    if (errno != 0 || end == text || *end != '\0' || value > UINT32_MAX) {
+        return -1;
+    }
+
+    *out_value = (uint32_t)value;
+    return 0;
+}
+
+static int parse_u64(const char *text, uint64_t *out_value)
+{
+    char *end = NULL;
+    unsigned long long value;
+
+    errno = 0;
+    value = strtoull(text, &end, 10);
+    if (errno != 0 || end == text || *end != '\0') {
+        return -1;
+    }
+
+    *out_value = (uint64_t)value;
+    return 0;
+}
+
+static int parse_double(const char *text, double *out_value)
+{
+    char *end = NULL;
+    double value;
+
+    errno = 0;
+    value = strtod(text, &end);
+    if (errno != 0 || end == text || *end != '\0') {
+        return -1;
+    }
+
+    *out_value = value;
+    return 0;
+}
+
+/* "a.b.c.d:port"; the address is checked when the socket is opened. */
+static int parse_udp_dest(const char *text, char *addr, size_t addr_len, uint16_t *out_port)
+{
+    const char *sep = strrchr(text, ':');
+    uint32_t port = 0U;
+
+    if (sep == NULL || sep == text || (size_t)(sep - text) >= addr_len || parse_u32(sep + 1, &port) != 0 ||
+        port == 0U || port > UINT16_MAX) {
+        return -1;
+    }
+    memcpy(addr, text, (size_t)(sep - text));
+    addr[sep - text] = '\0';
+    *out_port = (uint16_t)port;
+    return 0;
+}
+
+static int parse_sim_signal(const char *text, ads1278_sim_signal_t *out_signal)
+{
+    size_t idx;
+
+    for (idx = 0; idx < sizeof(k_sim_signal_names) / sizeof(k_sim_signal_names[0]); ++idx) {
+        if (strcmp(text, k_sim_signal_names[idx]) == 0) {
+            *out_signal = (ads1278_sim_signal_t)idx;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+static int parse_gpio_endpoint(const char *text, gpio_endpoint_t *out_endpoint)
+{
+    const char *sep = strrchr(text, ':');
+    uint32_t gpio_number = 0U;
+    size_t prefix_len;
+
+    if (sep == NULL) {
+        if (parse_u32(text, &gpio_number) != 0) {
+            return -1;
+        }
+
+        out_endpoint->gpio_number = gpio_number;
+        out_endpoint->chip[0] = '\0';
+        out_endpoint->set = true;
+        return 0;
+    }
+
+    if (parse_u32(sep + 1, &gpio_number) != 0) {
+        return -1;
+    }
+
+    prefix_len = (size_t)(sep - text);
+    if (prefix_len == 5U && strncmp(text, "sysfs", 5U) == 0) {
+        out_endpoint->chip[0] = '\0';
+    } else if (strncmp(text, "gpiochip", 8U) == 0) {
+        if (prefix_len + 5U >= sizeof(out_endpoint->chip)) {
+            return -1;
+        }
+        snprintf(out_endpoint->chip, sizeof(out_endpoint->chip), "/dev/%.*s", (int)prefix_len, text);
+    } else if (text[0] == '/') {
+        if (prefix_len >= sizeof(out_endpoint->chip)) {
+            return -1;
+        }
+        snprintf(out_endpoint->chip, sizeof(out_endpoint->chip), "%.*s", (int)prefix_len, text);
+    } else {
+        return -1;
+    }
+
+    out_endpoint->gpio_number = gpio_number;
+    out_endpoint->set = true;
+    return 0;
+}
+
+static const char *gpio_endpoint_chip(const gpio_endpoint_t *endpoint)
+{
+    return (endpoint->set && endpoint->chip[0] != '\0') ? endpoint->chip : NULL;
+}
+
+static void on_signal(int signo)
+{
+    (void)signo;
+    stream_server_stop(g_server);
+}
+
+static int install_signal_handlers(void)
+{
+    struct sigaction sa;
+
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = on_signal;
+    sigemptyset(&sa.sa_mask);
+    if (sigaction(SIGINT, &sa, NULL) != 0 || sigaction(SIGTERM, &sa, NULL) != 0) {
+        return -1;
+    }
+
+    /* Sends use MSG_NOSIGNAL; this covers anything else touching a dead socket. */
+    sa.sa_handler = SIG_IGN;
+    return sigaction(SIGPIPE, &sa, NULL);
+}
+
+int main(int argc, char **argv)
+{
+    ads1278_cfg_t cfg = {0};
+    acq_cfg_t acq_cfg = {0};
+    stream_server_cfg_t srv_cfg = {0};
+    stream_server_stats_t srv_stats = {0};
+    acq_stats_t acq_stats = {0};
+    gpio_endpoint_t drdy = {0};
+    gpio_endpoint_t sync = {0};
+    uint32_t spi_mode = 0U;
+    uint32_t ring_frames = ACQ_RING_DEFAULT_CAPACITY;
+    uint32_t port = PROTO_DEFAULT_PORT;
+    uint32_t history_mb = 0U;
+    udp_sender_cfg_t udp_cfg = {0};
+    char udp_dest[64];
+    uint32_t udp_value = 0U;
+    shm_ring_cfg_t shm_cfg = {0};
+    uint32_t shm_frames = 0U;
+    shm_ring_writer_t *shm = NULL;
+    decim_cfg_t decim_cfg[DECIM_MAX_GROUPS] = {{0}};
+    trigger_cfg_t trigger_cfg = {0};
+    psd_cfg_t psd_cfg = {0};
+    gpio_endpoint_t trigger_gpio = {0};
+    chan_calib_t calib;
+    const char *calib_path = NULL;
+    double vref = CHAN_CALIB_DEFAULT_VREF;
+    bool vref_set = false;
+    uint32_t rt_priority = 0U;
+    rt_cfg_t rt_cfg = {0};
+    rt_status_t rt_status;
+    char text[512];
+    acq_t *acq = NULL;
+    ads1278_dev_t *dev = NULL;
+    int exit_code = EXIT_FAILURE;
+
+    static const struct option long_options[] = {
+        {"spidev", required_argument, NULL, 'd'},
+        {"sclk-hz", required_argument, NULL, 's'},
+        {"spi-mode", required_argument, NULL, 'm'},
+        {"drdy", required_argument, NULL, 'r'},
+        {"sync", required_argument, NULL, 'y'},
+        {"no-sync", no_argument, NULL, 'n'},
+        {"settle-frames", required_argument, NULL, 't'},
+        {"drdy-timeout-ms", required_argument, NULL, 'w'},
+        {"frames", required_argument, NULL, 'f'},
+        {"port", required_argument, NULL, 'P'},
+        {"help", no_argument, NULL, 'h'},
+        {"backend", required_argument, NULL, OPT_BACKEND},
+        {"sim-rate-hz", required_argument, NULL, OPT_SIM_RATE_HZ},
+        {"sim-signal", required_argument, NULL, OPT_SIM_SIGNAL},
+        {"sim-amplitude", required_argument, NULL, OPT_SIM_AMPLITUDE},
+        {"sim-signal-hz", required_argument, NULL, OPT_SIM_SIGNAL_HZ},
+        {"sim-busy-wait", no_argument, NULL, OPT_SIM_BUSY_WAIT},
+        {"ring-frames", required_argument, NULL, OPT_RING_FRAMES},
+        {"bind", required_argument, NULL, OPT_BIND},
+        {"mode", required_argument, NULL, OPT_MODE},
+        {"frames-per-msg", required_argument, NULL, OPT_FRAMES_PER_MSG},
+        {"encoding", required_argument, NULL, OPT_ENCODING},
+        {"flush-us", required_argument, NULL, OPT_FLUSH_US},
+        {"history-msgs", required_argument, NULL, OPT_HISTORY_MSGS},
+        {"max-clients", required_argument, NULL, OPT_MAX_CLIENTS},
+        {"wait-clients", required_argument, NULL, OPT_WAIT_CLIENTS},
+        {"decim", required_argument, NULL, OPT_DECIM},
+        {"trigger", required_argument, NULL, OPT_TRIGGER},
+        {"trigger-gpio", required_argument, NULL, OPT_TRIGGER_GPIO},
+        {"stats-ms", required_argument, NULL, OPT_STATS_MS},
+        {"summary-ms", required_argument, NULL, OPT_SUMMARY_MS},
+        {"summary-only", no_argument, NULL, OPT_SUMMARY_ONLY},
+        {"psd", required_argument, NULL, OPT_PSD},
+        {"calib", required_argument, NULL, OPT_CALIB},
+        {"vref", required_argument, NULL, OPT_VREF},
+        {"rt-priority", required_argument, NULL, OPT_RT_PRIORITY},
+        {"rt-cpus", required_argument, NULL, OPT_RT_CPUS},
+        {"mlock", no_argument, NULL, OPT_MLOCK},
+        {"chain", required_argument, NULL, OPT_CHAIN},
+        {"smooth-tstamps", no_argument, NULL, OPT_SMOOTH_TSTAMPS},
+        {"history-frames", required_argument, NULL, OPT_HISTORY_FRAMES},
+        {"history-mb", required_argument, NULL, OPT_HISTORY_MB},
+        {"policy", required_argument, NULL, OPT_POLICY},
+        {"max-lag-ms", required_argument, NULL, OPT_MAX_LAG_MS},
+        {"io-uring", no_argument, NULL, OPT_IO_URING},
+        {"udp", required_argument, NULL, OPT_UDP},
+        {"udp-iface", required_argument, NULL, OPT_UDP_IFACE},
+        {"udp-ttl", required_argument, NULL, OPT_UDP_TTL},
+        {"udp-mtu", required_argument, NULL, OPT_UDP_MTU},
+        {"udp-batch", required_argument, NULL, OPT_UDP_BATCH},
+        {"udp-sndbuf-kb", required_argument, NULL, OPT_UDP_SNDBUF_KB},
+        {"udp-no-loop", no_argument, NULL, OPT_UDP_NO_LOOP},
+        {"shm", required_argument, NULL, OPT_SHM},
+        {"shm-frames", required_argument, NULL, OPT_SHM_FRAMES},
+        {0, 0, 0, 0}
+    };
+
+    cfg.spidev_path = ADS1278_DEFAULT_SPIDEV;
+    cfg.sclk_hz = 1000000U;
+    srv_cfg.stats_ms = STREAM_DEFAULT_STATS_MS;
+    cfg.spi_no_cs = true;
+    cfg.use_sync = true;
+    cfg.drdy_timeout_ms = ADS1278_DEFAULT_DRDY_TIMEOUT_MS;
+    cfg.backend = ADS1278_BACKEND_SPIDEV;
+    cfg.sim.drdy_rate_hz = ADS1278_SIM_DEFAULT_RATE_HZ;
+    cfg.sim.signal = ADS1278_SIM_SIGNAL_RAMP;
+    srv_cfg.mode = STREAM_MODE_LATENCY;
+    srv_cfg.encoding = PROTO_DATA_ENC_P24;
+    /* Lossless: only messages whose timestamps lie exactly on a line drop their deltas. */
+    srv_cfg.linear_ts = true;
+
+    while (1) {
+        int opt = getopt_long(argc, argv, "d:s:m:r:y:nt:w:f:P:h", long_options, NULL);
+        if (opt == -1) {
+            break;
+        }
+
+        switch (opt) {
+            case 'd':
+                cfg.spidev_path = optarg;
+                break;
+            case 's':
+                if (parse_u32(optarg, &cfg.sclk_hz) != 0) {
+                    fprintf(stderr, "Invalid --sclk-hz: %s\n", optarg);
+                    goto cleanup;
+                }
+                break;
+            case 'm':
+                if (parse_u32(optarg, &spi_mode) != 0 || spi_mode > 3U) {
+                    fprintf(stderr, "Invalid --spi-mode: %s\n", optarg);
+                    goto cleanup;
+                }
+                break;
+            case OPT_CHAIN:
+                if (parse_u32(optarg, &cfg.chain_length) != 0 || cfg.chain_length < 1U ||
+                    cfg.chain_length > ADS1278_MAX_CHAIN) {
+                    fprintf(stderr, "Invalid --chain (1..%u): %s\n", (unsigned)ADS1278_MAX_CHAIN, optarg);
+                    goto cleanup;
+                }
+                break;
+            case 'r':
+                if (parse_gpio_endpoint(optarg, &drdy) != 0) {
+                    fprintf(stderr, "Invalid --drdy: %s\n", optarg);
+                    goto cleanup;
+                }
+                break;
+            case 'y':
+                if (parse_gpio_endpoint(optarg, &sync) != 0) {
+                    fprintf(stderr, "Invalid --sync: %s\n", optarg);
+                    goto cleanup;
+                }
+                break;
+            case 'n':
+                cfg.use_sync = false;
+                break;
+            case 't':
+                if (parse_u32(optarg, &cfg.settle_frames) != 0) {
+                    fprintf(stderr, "Invalid --settle-frames: %s\n", optarg);
+                    goto cleanup;
+                }
+                break;
+            case 'w':
+                if (parse_u32(optarg, &cfg.drdy_timeout_ms) != 0) {
+                    fprintf(stderr, "Invalid --drdy-timeout-ms: %s\n", optarg);
+                    goto cleanup;
+                }
+                if (cfg.drdy_timeout_ms == 0U) {
+                    cfg.drdy_timeout_ms = ADS1278_NO_TIMEOUT;
+                }
+                break;
+            case 'f':
+                if (parse_u64(optarg, &acq_cfg.max_frames) != 0) {
+                    fprintf(stderr, "Invalid --frames: %s\n", optarg);
+                    goto cleanup;
+                }
+                break;
+            case 'P':
+                if (parse_u32(optarg, &port) != 0 || port > 65535U) {
+                    fprintf(stderr, "Invalid --port: %s\n", optarg);
+                    goto cleanup;
+                }
+                break;
+            case OPT_BACKEND:
+                if (strcmp(optarg, "spidev") == 0) {
+                    cfg.backend = ADS1278_BACKEND_SPIDEV;
+                } else if (strcmp(optarg, "sim") == 0) {
+                    cfg.backend = ADS1278_BACKEND_SIM;
+                } else {
+                    fprintf(stderr, "Invalid --backend: %s\n", optarg);
+                    goto cleanup;
+                }
+                break;
+            case OPT_SIM_RATE_HZ:
+                if (parse_u32(optarg, &cfg.sim.drdy_rate_hz) != 0) {
+                    fprintf(stderr, "Invalid --sim-rate-hz: %s\n", optarg);
+                    goto cleanup;
+                }
+                break;
+            case OPT_SIM_SIGNAL:
+                if (parse_sim_signal(optarg, &cfg.sim.signal) != 0) {
+                    fprintf(stderr, "Invalid --sim-signal: %s\n", optarg);
+                    goto cleanup;
+                }
+                break;
+            case OPT_SIM_AMPLITUDE:
+                if (parse_u32(optarg, &cfg.sim.amplitude) != 0) {
+                    fprintf(stderr, "Invalid --sim-amplitude: %s\n", optarg);
+                    goto cleanup;
+                }
+                break;
+            case OPT_SIM_SIGNAL_HZ:
+                if (parse_double(optarg, &cfg.sim.signal_hz) != 0) {
+                    fprintf(stderr, "Invalid --sim-signal-hz: %s\n", optarg);
+                    goto cleanup;
+                }
+                break;
+            case OPT_SIM_BUSY_WAIT:
+                cfg.sim.busy_wait = true;
+                break;
+            case OPT_SMOOTH_TSTAMPS:
+                cfg.smooth_tstamps = true;
+                srv_cfg.linear_tolerance_ns = CLOCK_MODEL_LINEAR_TOLERANCE_NS;
+                break;
+            case OPT_RING_FRAMES:
+                if (parse_u32(optarg, &ring_frames) != 0 || ring_frames == 0U ||
+                    (ring_frames & (ring_frames - 1U)) != 0U) {
+                    fprintf(stderr, "Invalid --ring-frames (power of two): %s\n", optarg);
+                    goto cleanup;
+                }
+                break;
+            case OPT_SHM:
+                shm_cfg.name = optarg;
+                break;
+            case OPT_SHM_FRAMES:
+                if (parse_u32(optarg, &shm_frames) != 0 || shm_frames == 0U ||
+                    (shm_frames & (shm_frames - 1U)) != 0U) {
+                    fprintf(stderr, "Invalid --shm-frames (power of two): %s\n", optarg);
+                    goto cleanup;
+                }
+                break;
+            case OPT_BIND:
+                srv_cfg.bind_addr = optarg;
+                break;
+            case OPT_MODE:
+                if (strcmp(optarg, "latency") == 0) {
+                    srv_cfg.mode = STREAM_MODE_LATENCY;
+                } else if (strcmp(optarg, "throughput") == 0) {
+                    srv_cfg.mode = STREAM_MODE_THROUGHPUT;
+                } else {
+                    fprintf(stderr, "Invalid --mode: %s\n", optarg);
+                    goto cleanup;
+                }
+                break;
+            case OPT_FRAMES_PER_MSG:
+                if (parse_u32(optarg, &srv_cfg.frames_per_msg) != 0 || srv_cfg.frames_per_msg == 0U) {
+                    fprintf(stderr, "Invalid --frames-per-msg: %s\n", optarg);
+                    goto cleanup;
+                }
+                break;
+            case OPT_ENCODING:
+                if (strcmp(optarg, "p24") == 0) {
+                    srv_cfg.encoding = PROTO_DATA_ENC_P24;
+                } else if (strcmp(optarg, "record48") == 0) {
+                    srv_cfg.encoding = PROTO_DATA_ENC_RECORD48;
+                } else if (strcmp(optarg, "delta") == 0) {
+                    srv_cfg.encoding = PROTO_DATA_ENC_DELTA;
+                } else {
+                    fprintf(stderr, "Invalid --encoding: %s\n", optarg);
+                    goto cleanup;
+                }
+                break;
+            case OPT_FLUSH_US:
+                if (parse_u32(optarg, &srv_cfg.flush_us) != 0 || srv_cfg.flush_us == 0U) {
+                    fprintf(stderr, "Invalid --flush-us: %s\n", optarg);
+                    goto cleanup;
+                }
+                break;
+            case OPT_HISTORY_MSGS:
+                if (parse_u32(optarg, &srv_cfg.history_msgs) != 0 || srv_cfg.history_msgs < 2U ||
+                    (srv_cfg.history_msgs & (srv_cfg.history_msgs - 1U)) != 0U) {
+                    fprintf(stderr, "Invalid --history-msgs (power of two >= 2): %s\n", optarg);
+                    goto cleanup;
+                }
+                break;
+            case OPT_HISTORY_FRAMES:
+                if (parse_u64(optarg, &srv_cfg.history_frames) != 0 || srv_cfg.history_frames == 0U) {
+                    fprintf(stderr, "Invalid --history-frames: %s\n", optarg);
+                    goto cleanup;
+                }
+                break;
+            case OPT_HISTORY_MB:
+                if (parse_u32(optarg, &history_mb) != 0 || history_mb == 0U || history_mb > 4096U) {
+                    fprintf(stderr, "Invalid --history-mb (1..4096): %s\n", optarg);
+                    goto cleanup;
+                }
+                srv_cfg.history_bytes = (size_t)history_mb * 1024U * 1024U;
+                break;
+            case OPT_POLICY:
+                if (strcmp(optarg, "drop") == 0) {
+                    srv_cfg.policy = STREAM_POLICY_DROP_OLDEST;
+                } else if (strcmp(optarg, "disconnect") == 0) {
+                    srv_cfg.policy = STREAM_POLICY_DISCONNECT;
+                } else if (strcmp(optarg, "never") == 0) {
+                    srv_cfg.policy = STREAM_POLICY_NEVER_DROP;
+                } else {
+                    fprintf(stderr, "Invalid --policy: %s\n", optarg);
+                    goto cleanup;
+                }
+                break;
+            case OPT_MAX_LAG_MS:
+                if (parse_u32(optarg, &srv_cfg.max_lag_ms) != 0 || srv_cfg.max_lag_ms == 0U) {
+                    fprintf(stderr, "Invalid --max-lag-ms: %s\n", optarg);
+                    goto cleanup;
+                }
+                break;
+            case OPT_IO_URING:
+                srv_cfg.io_uring = true;
+                break;
+            case OPT_UDP:
+                if (parse_udp_dest(optarg, udp_dest, sizeof(udp_dest), &udp_cfg.port) != 0) {
+                    fprintf(stderr, "Invalid --udp (ipv4:port): %s\n", optarg);
+                    goto cleanup;
+                }
+                udp_cfg.dest = udp_dest;
+                srv_cfg.udp = &udp_cfg;
+                break;
+            case OPT_UDP_IFACE:
+                udp_cfg.iface = optarg;
+                break;
+            case OPT_UDP_TTL:
+                if (parse_u32(optarg, &udp_value) != 0 || udp_value == 0U || udp_value > 255U) {
+                    fprintf(stderr, "Invalid --udp-ttl (1..255): %s\n", optarg);
+                    goto cleanup;
+                }
+                udp_cfg.ttl = (uint8_t)udp_value;
+                break;
+            case OPT_UDP_MTU:
+                if (parse_u32(optarg, &udp_cfg.mtu) != 0 || udp_cfg.mtu < 576U || udp_cfg.mtu > 65535U) {
+                    fprintf(stderr, "Invalid --udp-mtu (576..65535): %s\n", optarg);
+                    goto cleanup;
+                }
+                break;
+            case OPT_UDP_BATCH:
+                if (parse_u32(optarg, &udp_cfg.batch) != 0 || udp_cfg.batch == 0U || udp_cfg.batch > UDP_MAX_BATCH) {
+                    fprintf(stderr, "Invalid --udp-batch (1..%u): %s\n", UDP_MAX_BATCH, optarg);
+                    goto cleanup;
+                }
+                break;
+            case OPT_UDP_SNDBUF_KB:
+                if (parse_u32(optarg, &udp_value) != 0 || udp_value == 0U || udp_value > 65536U) {
+                    fprintf(stderr, "Invalid --udp-sndbuf-kb (1..65536): %s\n", optarg);
+                    goto cleanup;
+                }
+                udp_cfg.sndbuf = udp_value * 1024U;
+                break;
+            case OPT_UDP_NO_LOOP:
+                udp_cfg.no_loop = true;
+                break;
+            case OPT_MAX_CLIENTS:
+                if (parse_u32(optarg, &srv_cfg.max_clients) != 0 || srv_cfg.max_clients == 0U) {
+                    fprintf(stderr, "Invalid --max-clients: %s\n", optarg);
+                    goto cleanup;
+                }
+                break;
+            case OPT_WAIT_CLIENTS:
+                if (parse_u32(optarg, &srv_cfg.start_clients) != 0) {
+                    fprintf(stderr, "Invalid --wait-clients: %s\n", optarg);
+                    goto cleanup;
+                }
+                break;
+            case OPT_DECIM:
+                if (srv_cfg.decim_groups == DECIM_MAX_GROUPS ||
+                    decim_parse_spec(optarg, &decim_cfg[srv_cfg.decim_groups]) != 0) {
+                    fprintf(stderr, "Invalid --decim: %s\n", optarg);
+                    goto cleanup;
+                }
+                ++srv_cfg.decim_groups;
+                srv_cfg.decim = decim_cfg;
+                break;
+            case OPT_TRIGGER:
+                if (trigger_parse_spec(optarg, &trigger_cfg) != 0) {
+                    fprintf(stderr, "Invalid --trigger: %s\n", optarg);
+                    goto cleanup;
+                }
+                srv_cfg.trigger = &trigger_cfg;
+                break;
+            case OPT_TRIGGER_GPIO:
+                if (parse_gpio_endpoint(optarg, &trigger_gpio) != 0) {
+                    fprintf(stderr, "Invalid --trigger-gpio: %s\n", optarg);
+                    goto cleanup;
+                }
+                break;
+            case OPT_STATS_MS:
+                if (parse_u32(optarg, &srv_cfg.stats_ms) != 0) {
+                    fprintf(stderr, "Invalid --stats-ms: %s\n", optarg);
+                    goto cleanup;
+                }
+                break;
+            case OPT_SUMMARY_MS:
+                if (parse_u32(optarg, &srv_cfg.summary_ms) != 0) {
+                    fprintf(stderr, "Invalid --summary-ms: %s\n", optarg);
+                    goto cleanup;
+                }
+                break;
+            case OPT_SUMMARY_ONLY:
+                srv_cfg.summary_only = true;
+                break;
+            case OPT_PSD:
+                if (psd_parse_spec(optarg, &psd_cfg) != 0) {
+                    fprintf(stderr, "Invalid --psd: %s\n", optarg);
+                    goto cleanup;
+                }
+                srv_cfg.psd = &psd_cfg;
+                break;
+            case OPT_CALIB:
+                calib_path = optarg;
+                break;
+            case OPT_VREF:
+                if (parse_double(optarg, &vref) != 0 || !(vref > 0.0)) {
+                    fprintf(stderr, "Invalid --vref: %s\n", optarg);
+                    goto cleanup;
+                }
+                vref_set = true;
+                break;
+            case OPT_RT_PRIORITY:
+                if (parse_u32(optarg, &rt_priority) != 0 || rt_priority < 1U || rt_priority > 99U) {
+                    fprintf(stderr, "Invalid --rt-priority (1..99): %s\n", optarg);
+                    goto cleanup;
+                }
+                break;
+            case OPT_RT_CPUS:
+                if (rt_parse_cpus(optarg, &rt_cfg.cpu_mask) != 0) {
+                    fprintf(stderr, "Invalid --rt-cpus: %s\n", optarg);
+                    goto cleanup;
+                }
+                break;
+            case OPT_MLOCK:
+                rt_cfg.lock_memory = true;
+                break;
+            case 'h':
+                usage(stdout, argv[0]);
+                exit_code = EXIT_SUCCESS;
+                goto cleanup;
+            default:
+                usage(stderr, argv[0]);
+                goto cleanup;
+        }
+    }
+
+    if (cfg.backend == ADS1278_BACKEND_SPIDEV && !drdy.set) {
+        fprintf(stderr, "--drdy is required.\n");
+        usage(stderr, argv[0]);
+        goto cleanup;
+    }
+    if (cfg.backend == ADS1278_BACKEND_SPIDEV && cfg.use_sync && !sync.set) {
+        fprintf(stderr, "--sync is required unless --no-sync is used.\n");
+        goto cleanup;
+    }
+    if (cfg.chain_length > 1U && srv_cfg.encoding == PROTO_DATA_ENC_RECORD48) {
+        fprintf(stderr, "--encoding record48 carries 8 channels; use p24 or delta with --chain.\n");
+        goto cleanup;
+    }
+    if (srv_cfg.decim != NULL && srv_cfg.encoding == PROTO_DATA_ENC_RECORD48) {
+        uint64_t selected = 0U;
+        size_t group;
+
+        for (group = 0U; group < srv_cfg.decim_groups; ++group) {
+            selected |= (decim_cfg[group].channel_mask != 0U) ? decim_cfg[group].channel_mask : 0xFFU;
+        }
+        if (selected != 0xFFU) {
+            fprintf(stderr, "--encoding record48 carries 8 channels; use p24 or delta with a --decim mask.\n");
+            goto cleanup;
+        }
+    }
+    if (trigger_gpio.set && srv_cfg.trigger == NULL) {
+        fprintf(stderr, "--trigger-gpio needs --trigger for the window, e.g. --trigger pre=1000,post=1000.\n");
+        goto cleanup;
+    }
+    if (srv_cfg.trigger != NULL && trigger_cfg.cond_count == 0U && !trigger_gpio.set) {
+        fprintf(stderr, "--trigger needs a condition or --trigger-gpio.\n");
+        goto cleanup;
+    }
+    if (srv_cfg.summary_only && srv_cfg.summary_ms == 0U && srv_cfg.psd == NULL) {
+        srv_cfg.summary_ms = STREAM_DEFAULT_SUMMARY_MS;
+    }
+    if ((calib_path != NULL || vref_set) && srv_cfg.summary_ms == 0U && srv_cfg.psd == NULL) {
+        fprintf(stderr, "--calib and --vref apply to SUMMARY/SPECTRUM messages; add --summary-ms, --summary-only "
+            "or --psd.\n");
+        goto cleanup;
+    }
+    if (srv_cfg.udp != NULL && (srv_cfg.trigger != NULL || srv_cfg.summary_only)) {
+        fprintf(stderr, "--udp carries DATA only; it cannot be used with --trigger or --summary-only.\n");
+        goto cleanup;
+    }
+    if (srv_cfg.udp == NULL && (udp_cfg.iface != NULL || udp_cfg.ttl != 0U || udp_cfg.mtu != 0U ||
+                                udp_cfg.batch != 0U || udp_cfg.sndbuf != 0U || udp_cfg.no_loop)) {
+        fprintf(stderr, "--udp-* options need --udp.\n");
+        goto cleanup;
+    }
+    if (shm_cfg.name == NULL && shm_frames != 0U) {
+        fprintf(stderr, "--shm-frames needs --shm.\n");
+        goto cleanup;
+    }
+    if (srv_cfg.start_clients > ((srv_cfg.max_clients != 0U) ? srv_cfg.max_clients : STREAM_DEFAULT_MAX_CLIENTS)) {
+        fprintf(stderr, "--wait-clients exceeds --max-clients.\n");
+        goto cleanup;
+    }
+
+    cfg.spi_mode = (uint8_t)spi_mode;
+    cfg.drdy_gpio_number = drdy.gpio_number;
+    cfg.drdy_gpiochip = gpio_endpoint_chip(&drdy);
+    cfg.sync_gpio_number = cfg.use_sync ? sync.gpio_number : 0U;
+    cfg.sync_gpiochip = cfg.use_sync ? gpio_endpoint_chip(&sync) : NULL;
+    trigger_cfg.use_gpio = trigger_gpio.set;
+    trigger_cfg.gpio_chip = gpio_endpoint_chip(&trigger_gpio);
+    trigger_cfg.gpio_line = trigger_gpio.gpio_number;
+
+    srv_cfg.port = (uint16_t)port;
+    srv_cfg.announce.backend = (uint32_t)cfg.backend;
+    srv_cfg.announce.sample_rate_hz = (cfg.backend == ADS1278_BACKEND_SIM) ? cfg.sim.drdy_rate_hz : 0U;
+    srv_cfg.announce.sclk_hz = cfg.sclk_hz;
+    srv_cfg.announce.spi_mode = spi_mode;
+    srv_cfg.announce.settle_frames = cfg.settle_frames;
+
+    if (ads1278_dev_open(&dev, &cfg) != 0) {
+        perror("ads1278_dev_open");
+        goto cleanup;
+    }
+    if (ads1278_dev_start(dev) != 0) {
+        perror("ads1278_dev_start");
+        goto cleanup;
+    }
+
+    if (calib_path != NULL || vref_set) {
+        if (calib_path == NULL) {
+            chan_calib_init(&calib, ads1278_dev_channel_count(dev), vref);
+        } else if (chan_calib_load(&calib, ads1278_dev_channel_count(dev), vref, calib_path) != 0) {
+            fprintf(stderr, "Cannot load calibration table %s: %s\n", calib_path, strerror(errno));
+            goto cleanup;
+        }
+        srv_cfg.calib = &calib;
+    }
+
+    if (shm_cfg.name != NULL) {
+        shm_cfg.capacity = shm_frames;
+        shm_cfg.channels = ads1278_dev_channel_count(dev);
+        shm_cfg.sample_rate_hz = srv_cfg.announce.sample_rate_hz;
+        if (shm_ring_writer_create(&shm, &shm_cfg) != 0) {
+            fprintf(stderr, "Cannot create shared memory ring %s: %s\n", shm_cfg.name, strerror(errno));
+            goto cleanup;
+        }
+    }
+
+    acq_cfg.dev = dev;
+    acq_cfg.ring_capacity = ring_frames;
+    acq_cfg.shm = shm;
+    acq_cfg.rt = rt_cfg;
+    acq_cfg.rt.priority = (int)rt_priority;
+    if (acq_create(&acq, &acq_cfg) != 0) {
+        perror("acq_create");
+        goto cleanup;
+    }
+    if (stream_server_create(&g_server, &srv_cfg, acq) != 0) {
+        perror("stream_server_create");
+        goto cleanup;
+    }
+    if (install_signal_handlers() != 0) {
+        perror("sigaction");
+        goto cleanup;
+    }
+
+    fprintf(stderr, "Streaming %s backend on port %u (%s mode, %s DATA)%s.\n",
+        ads1278_backend_name(cfg.backend), (unsigned)stream_server_port(g_server),
+        stream_mode_name(srv_cfg.mode), proto_data_encoding_name(srv_cfg.encoding), (srv_cfg.start_clients != 0U) ? ", waiting for clients" : "");
+    if (srv_cfg.io_uring) {
+        stream_server_get_stats(g_server, &srv_stats);
+        fprintf(stderr, "%s\n", srv_stats.io_uring ? "Client sends batched through io_uring."
+            : "warning: io_uring unavailable, client sends use sendmsg().");
+    }
+    if (srv_cfg.udp != NULL) {
+        stream_server_get_stats(g_server, &srv_stats);
+        fprintf(stderr, "UDP DATA to %s:%u, %u frame(s) per datagram, send buffer %u KiB.\n", udp_cfg.dest,
+            (unsigned)udp_cfg.port, srv_stats.udp.frames_per_datagram, srv_stats.udp.sndbuf / 1024U);
+    }
+    if (shm != NULL) {
+        fprintf(stderr, "Publishing frames to shared memory %s (%u frame ring).\n", shm_cfg.name,
+            (shm_frames != 0U) ? shm_frames : SHM_RING_DEFAULT_FRAMES);
+    }
+    if (stream_server_run(g_server) != 0) {
+        perror("stream_server_run");
+        goto cleanup;
+    }
+
+    acq_stop(acq);
+    acq_get_stats(acq, &acq_stats);
+    stream_server_get_stats(g_server, &srv_stats);
+    if (acq_get_error(acq) != 0) {
+        errno = acq_get_error(acq);
+        perror("ads1278_dev_read_frame");
+        goto cleanup;
+    }
+
+    fprintf(stderr, "Acquired %" PRIu64 " frame(s); ring high-water %" PRIu64 ", overflows %" PRIu64
+        ", missed DRDY %" PRIu64 ".\n",
+        acq_stats.frames_read, acq_stats.ring.high_water, acq_stats.ring.overflows,
+        ads1278_dev_get_missed_drdy(dev));
+    acq_get_rt_status(acq, &rt_status);
+    rt_format_status(&acq_cfg.rt, &rt_status, text, sizeof(text));
+    fprintf(stderr, "%s\n", text);
+    lat_hist_format(&acq_stats.latency, text, sizeof(text));
+    fprintf(stderr, "DRDY-to-frame latency: %s.\n", text);
+    {
+        ads1278_stats_t hal_stats = {0};
+
+        if (ads1278_dev_get_stats(dev, &hal_stats) == 0 && hal_stats.missed_conversions != 0U) {
+            fprintf(stderr, "warning: %" PRIu64 " conversion(s) missed in %" PRIu64 " gap(s), longest %" PRIu64
+                " (seq jumps).\n", hal_stats.missed_conversions, hal_stats.gap_events, hal_stats.longest_gap);
+        }
+        if (hal_stats.drdy_period_ns != 0.0) {
+            fprintf(stderr, "DRDY clock: jitter %.0f ns RMS (max %" PRIu64 " ns) about the fitted clock, drift %+.2f "
+                "ppm, %" PRIu64 " outlier(s), %" PRIu64 " relock(s)%s.\n", hal_stats.tstamp_jitter_ns,
+                hal_stats.tstamp_jitter_max_ns, hal_stats.clock_drift_ppm, hal_stats.clock_outliers,
+                hal_stats.clock_relocks, cfg.smooth_tstamps ? "; frames stamped from the fit" : "");
+        }
+    }
+    if (ads1278_dev_get_overlong_xfers(dev) != 0U) {
+        fprintf(stderr, "warning: %" PRIu64 " frame(s) read more than 5 ms after DRDY (overrun risk).\n",
+            ads1278_dev_get_overlong_xfers(dev));
+    }
+    if (srv_cfg.decim != NULL) {
+        fprintf(stderr, "Decimated %" PRIu64 " frame(s) to %" PRIu64 ".\n", srv_stats.frames_in, srv_stats.frames_out);
+    }
+    if (srv_cfg.trigger != NULL) {
+        fprintf(stderr, "Trigger: %" PRIu64 " event(s) from %" PRIu64 " frame(s), %" PRIu64 " suppressed, %" PRIu64
+            " truncated, %" PRIu64 " external edge(s).\n", srv_stats.trigger.events, srv_stats.trigger.frames_in,
+            srv_stats.trigger.suppressed, srv_stats.trigger.truncated, srv_stats.trigger.external);
+    }
+    fprintf(stderr, "Streamed %" PRIu64 " message(s), %" PRIu64 " byte(s) in %" PRIu64 " send call(s), %" PRIu64
+        " syscall(s)%s; clients %" PRIu64 " accepted, %" PRIu64 " rejected, %" PRIu64 " message(s) dropped for slow "
+        "clients.\n",
+        srv_stats.msgs_published, srv_stats.bytes_sent, srv_stats.send_calls, srv_stats.send_syscalls,
+        srv_stats.io_uring ? " via io_uring" : "",
+        srv_stats.clients_accepted, srv_stats.clients_rejected, srv_stats.msgs_dropped);
+    if (srv_stats.gaps_sent != 0U || srv_stats.clients_lagging != 0U || srv_stats.resumes != 0U) {
+        fprintf(stderr, "Backpressure: %" PRIu64 " GAP(s) sent, %" PRIu64 " client(s) disconnected for lagging, %"
+            PRIu64 " resume(s) replaying %" PRIu64 " message(s).\n",
+            srv_stats.gaps_sent, srv_stats.clients_lagging, srv_stats.resumes, srv_stats.msgs_replayed);
+    }
+    {
+        stream_session_stats_t sessions[STREAM_SESSION_LOG];
+        size_t count = stream_server_get_sessions(g_server, sessions, STREAM_SESSION_LOG);
+        size_t idx;
+
+        for (idx = 0U; idx < count; ++idx) {
+            const stream_session_stats_t *ss = &sessions[idx];
+
+            fprintf(stderr, "  session %" PRIu64 " %s (%s): %" PRIu64 " message(s), %" PRIu64 " byte(s); %" PRIu64
+                " dropped (%" PRIu64 " frame(s)) in %" PRIu64 " GAP(s), %" PRIu64 " resume(s) replaying %" PRIu64
+                ", max backlog %" PRIu64 "; %s.\n", ss->id, ss->peer, stream_policy_name(ss->policy),
+                ss->msgs_sent, ss->bytes_sent, ss->msgs_dropped, ss->frames_dropped, ss->gaps_sent, ss->resumes,
+                ss->msgs_replayed, ss->max_lag_msgs, stream_close_name(ss->closed));
+        }
+    }
+    if (srv_cfg.udp != NULL) {
+        const udp_sender_stats_t *udp = &srv_stats.udp;
+
+        fprintf(stderr, "UDP: %" PRIu64 " frame(s) in %" PRIu64 " datagram(s), %" PRIu64 " byte(s) in %" PRIu64
+            " sendmmsg() call(s) (%.1f datagrams/call); %" PRIu64 " dropped by the socket, %" PRIu64
+            " send error(s), %" PRIu64 " announcement(s).\n", udp->frames, udp->datagrams, udp->bytes,
+            udp->send_calls, (udp->send_calls != 0U) ? (double)udp->datagrams / (double)udp->send_calls : 0.0,
+            udp->dropped, udp->send_errors, udp->announces);
+    }
+    if (shm != NULL) {
+        fprintf(stderr, "Shared memory: %" PRIu64 " frame(s) published to %s.\n", shm_ring_writer_frames(shm),
+            shm_cfg.name);
+    }
+    lat_hist_format(&srv_stats.net_send, text, sizeof(text));
+    fprintf(stderr, "Publish-to-sent latency: %s; %" PRIu64 " STATS message(s).\n", text, srv_stats.stats_published);
+    if (srv_stats.linear_ts_msgs != 0U) {
+        fprintf(stderr, "%" PRIu64 " DATA/EVENT message(s) sent with base + rate timestamps.\n",
+            srv_stats.linear_ts_msgs);
+    }
+    if (srv_cfg.summary_ms != 0U) {
+        fprintf(stderr, "Published %" PRIu64 " SUMMARY message(s) (%s, %s kernels).\n", srv_stats.summaries_published,
+            (srv_cfg.calib != NULL) ? "volts" : "codes", chan_stats_impl_name(chan_stats_active()));
+    }
+    if (srv_cfg.psd != NULL) {
+        fprintf(stderr, "PSD: %" PRIu64 " result(s) from %" PRIu64 " segment(s), %" PRIu64 " SPECTRUM message(s), %"
+            PRIu64 " partial segment(s) dropped at seq gaps.\n", srv_stats.psd.results, srv_stats.psd.segments,
+            srv_stats.spectra_published, srv_stats.psd.gaps);
+    }
+    exit_code = EXIT_SUCCESS;
+
+cleanup:
+    {
+        stream_server_t *srv = g_server;
+
+        g_server = NULL;
+        stream_server_destroy(srv);
+    }
+    acq_destroy(acq);
+    shm_ring_writer_destroy(shm);
+    ads1278_dev_stop(dev);
+    ads1278_dev_close(dev);
+    return exit_code;
+}
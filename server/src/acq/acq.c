@@ -0,0 +1,253 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Miguel Dovale (University of Arizona)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "acq.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* Consumer nap while the ring is empty; bounds drain latency, not acquisition. */
+#define ACQ_DRAIN_NAP_US 500U
+
+struct acq {
+    acq_cfg_t cfg;
+    acq_ring_t ring;
+    pthread_t thread;
+    int thread_started;
+    atomic_bool stop_requested;
+    atomic_bool ready;
+    atomic_bool done;
+    atomic_int error;
+    _Atomic uint64_t frames_read;
+    rt_status_t rt;             /* written by the thread before ready */
+    lat_recorder_t latency;     /* written by the acquisition thread */
+};
+
+static void nap_us(uint32_t usec)
+{
+    struct timespec ts;
+
+    ts.tv_sec = (time_t)(usec / 1000000U);
+    ts.tv_nsec = (long)(usec % 1000000U) * 1000L;
+    (void)nanosleep(&ts, NULL);
+}
+
+static uint64_t monotonic_ns(void)
+{
+    struct timespec ts;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+static void *acq_thread_main(void *arg)
+{
+    acq_t *acq = arg;
+    uint64_t count = 0U;
+
+    (void)rt_apply_thread(&acq->cfg.rt, &acq->rt);
+    atomic_store_explicit(&acq->ready, true, memory_order_release);
+
+    while (!atomic_load_explicit(&acq->stop_requested, memory_order_relaxed)) {
+        ads1278_frame_t frame;
+        uint64_t now;
+
+        if (acq->cfg.max_frames != 0U && count >= acq->cfg.max_frames) {
+            break;
+        }
+
+        if (ads1278_dev_read_frame(acq->cfg.dev, &frame) != 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            atomic_store(&acq->error, errno);
+            break;
+        }
+
+        now = monotonic_ns();
+        lat_recorder_record(&acq->latency, (now > frame.tstamp_ns) ? now - frame.tstamp_ns : 0U);
+        ++count;
+        atomic_store_explicit(&acq->frames_read, count, memory_order_relaxed);
+        (void)acq_ring_push(&acq->ring, &frame, now);
+        if (acq->cfg.shm != NULL) {
+            shm_ring_writer_publish(acq->cfg.shm, &frame, 1);
+        }
+    }
+
+    atomic_store_explicit(&acq->done, true, memory_order_release);
+    return NULL;
+}
+
+int acq_create(acq_t **out, const acq_cfg_t *cfg)
+{
+    acq_t *acq;
+
+    if (out == NULL || cfg == NULL) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    acq = calloc(1U, sizeof(*acq));
+    if (acq == NULL) {
+        return -1;
+    }
+
+    acq->cfg = *cfg;
+    if (acq_ring_init(&acq->ring, cfg->ring_capacity) != 0) {
+        int saved_errno = errno;
+
+        free(acq);
+        errno = saved_errno;
+        return -1;
+    }
+
+    atomic_init(&acq->stop_requested, false);
+    atomic_init(&acq->ready, false);
+    atomic_init(&acq->done, false);
+    atomic_init(&acq->error, 0);
+    atomic_init(&acq->frames_read, 0U);
+    rt_probe(&acq->rt);
+    (void)rt_lock_memory(&acq->cfg.rt, &acq->rt);
+    lat_recorder_reset(&acq->latency);
+
+    *out = acq;
+    return 0;
+}
+
+int acq_start(acq_t *acq)
+{
+    int rc;
+
+    if (acq == NULL) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (acq->thread_started) {
+        errno = EALREADY;
+        return -1;
+    }
+    if (acq->cfg.dev == NULL) {
+        acq->cfg.dev = ads1278_get_dev();
+    }
+    if (acq->cfg.dev == NULL) {
+        errno = ENODEV;
+        return -1;
+    }
+
+    rc = pthread_create(&acq->thread, NULL, acq_thread_main, acq);
+    if (rc != 0) {
+        errno = rc;
+        return -1;
+    }
+
+    acq->thread_started = 1;
+    while (!atomic_load_explicit(&acq->ready, memory_order_acquire)) {
+        nap_us(ACQ_DRAIN_NAP_US);
+    }
+    return 0;
+}
+
+void acq_stop(acq_t *acq)
+{
+    if (acq == NULL || !acq->thread_started) {
+        return;
+    }
+
+    atomic_store(&acq->stop_requested, true);
+    (void)pthread_join(acq->thread, NULL);
+    acq->thread_started = 0;
+}
+
+void acq_destroy(acq_t *acq)
+{
+    if (acq == NULL) {
+        return;
+    }
+
+    acq_stop(acq);
+    acq_ring_destroy(&acq->ring);
+    free(acq);
+}
+
+size_t acq_drain(acq_t *acq, ads1278_frame_t *out, size_t max, uint32_t wait_ms)
+{
+    uint32_t waited_us = 0U;
+
+    for (;;) {
+        /* Sample done before popping so frames pushed just before exit are not missed. */
+        bool finished = acq_is_done(acq);
+        size_t n = acq_ring_pop_batch(&acq->ring, out, max);
+
+        if (n != 0U || finished || waited_us >= wait_ms * 1000U) {
+            return n;
+        }
+
+        nap_us(ACQ_DRAIN_NAP_US);
+        waited_us += ACQ_DRAIN_NAP_US;
+    }
+}
+
+acq_ring_t *acq_get_ring(acq_t *acq)
+{
+    return &acq->ring;
+}
+
+ads1278_dev_t *acq_get_dev(const acq_t *acq)
+{
+    return (acq->cfg.dev != NULL) ? acq->cfg.dev : ads1278_get_dev();
+}
+
+bool acq_is_done(const acq_t *acq)
+{
+    return atomic_load_explicit(&acq->done, memory_order_acquire);
+}
+
+int acq_get_error(const acq_t *acq)
+{
+    return atomic_load(&acq->error);
+}
+
+void acq_get_stats(const acq_t *acq, acq_stats_t *out)
+{
+    out->frames_read = atomic_load_explicit(&acq->frames_read, memory_order_relaxed);
+    acq_ring_get_counters(&acq->ring, &out->ring);
+    lat_recorder_snapshot(&acq->latency, &out->latency);
+    acq_ring_get_dwell(&acq->ring, &out->ring_dwell);
+}
+
+void acq_get_rt_status(const acq_t *acq, rt_status_t *out)
+{
+    *out = acq->rt;
+}
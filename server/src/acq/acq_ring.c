@@ -0,0 +1,204 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Miguel Dovale (University of Arizona)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "acq_ring.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+int acq_ring_init(acq_ring_t *ring, size_t capacity)
+{
+    void *slots = NULL;
+    void *push_ns = NULL;
+
+    if (ring == NULL) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (capacity == 0U) {
+        capacity = ACQ_RING_DEFAULT_CAPACITY;
+    }
+    if ((capacity & (capacity - 1U)) != 0U) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    if (posix_memalign(&slots, ACQ_CACHE_LINE_BYTES, capacity * sizeof(ads1278_frame_t)) != 0) {
+        errno = ENOMEM;
+        return -1;
+    }
+    if (posix_memalign(&push_ns, ACQ_CACHE_LINE_BYTES, capacity * sizeof(uint64_t)) != 0) {
+        free(slots);
+        errno = ENOMEM;
+        return -1;
+    }
+    memset(slots, 0, capacity * sizeof(ads1278_frame_t));
+    memset(push_ns, 0, capacity * sizeof(uint64_t));
+
+    atomic_init(&ring->head, 0U);
+    ring->cached_tail = 0U;
+    atomic_init(&ring->pushed, 0U);
+    atomic_init(&ring->overflows, 0U);
+    atomic_init(&ring->high_water, 0U);
+    atomic_init(&ring->tail, 0U);
+    ring->cached_head = 0U;
+    lat_recorder_reset(&ring->dwell);
+    ring->slots = slots;
+    ring->push_ns = push_ns;
+    ring->mask = (uint64_t)capacity - 1U;
+    return 0;
+}
+
+void acq_ring_destroy(acq_ring_t *ring)
+{
+    if (ring == NULL) {
+        return;
+    }
+
+    free(ring->slots);
+    free(ring->push_ns);
+    ring->slots = NULL;
+    ring->push_ns = NULL;
+    ring->mask = 0U;
+}
+
+bool acq_ring_push(acq_ring_t *ring, const ads1278_frame_t *frame, uint64_t push_ns)
+{
+    uint64_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    uint64_t used = head - ring->cached_tail;
+
+    if (used > ring->mask) {
+        ring->cached_tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+        used = head - ring->cached_tail;
+        if (used > ring->mask) {
+            atomic_store_explicit(&ring->overflows,
+                atomic_load_explicit(&ring->overflows, memory_order_relaxed) + 1U,
+                memory_order_relaxed);
+            return false;
+        }
+    }
+
+    ring->slots[head & ring->mask] = *frame;
+    ring->push_ns[head & ring->mask] = push_ns;
+    atomic_store_explicit(&ring->head, head + 1U, memory_order_release);
+    atomic_store_explicit(&ring->pushed,
+        atomic_load_explicit(&ring->pushed, memory_order_relaxed) + 1U,
+        memory_order_relaxed);
+    return true;
+}
+
+size_t acq_ring_peek(acq_ring_t *ring, const ads1278_frame_t **first, size_t max)
+{
+    uint64_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    uint64_t avail = ring->cached_head - tail;
+    uint64_t to_wrap;
+
+    if (avail == 0U) {
+        ring->cached_head = atomic_load_explicit(&ring->head, memory_order_acquire);
+        avail = ring->cached_head - tail;
+        if (avail == 0U) {
+            return 0U;
+        }
+
+        /* Exact backlog at refresh time: the consumer sees every peak once it catches up. */
+        if (avail > atomic_load_explicit(&ring->high_water, memory_order_relaxed)) {
+            atomic_store_explicit(&ring->high_water, avail, memory_order_relaxed);
+        }
+    }
+
+    to_wrap = (ring->mask + 1U) - (tail & ring->mask);
+    if (avail > to_wrap) {
+        avail = to_wrap;
+    }
+    if (avail > (uint64_t)max) {
+        avail = (uint64_t)max;
+    }
+
+    *first = &ring->slots[tail & ring->mask];
+    return (size_t)avail;
+}
+
+void acq_ring_release(acq_ring_t *ring, size_t count)
+{
+    uint64_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    uint64_t pushed_at;
+
+    /* One sample per release, from its oldest frame: the batch's worst dwell. */
+    pushed_at = (count != 0U) ? ring->push_ns[tail & ring->mask] : 0U;
+    if (pushed_at != 0U) {
+        struct timespec ts;
+        uint64_t now;
+
+        (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+        now = ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+        lat_recorder_record(&ring->dwell, (now > pushed_at) ? now - pushed_at : 0U);
+    }
+
+    atomic_store_explicit(&ring->tail, tail + (uint64_t)count, memory_order_release);
+}
+
+size_t acq_ring_pop_batch(acq_ring_t *ring, ads1278_frame_t *out, size_t max)
+{
+    size_t total = 0U;
+
+    while (total < max) {
+        const ads1278_frame_t *span = NULL;
+        size_t n = acq_ring_peek(ring, &span, max - total);
+
+        if (n == 0U) {
+            break;
+        }
+        memcpy(&out[total], span, n * sizeof(*span));
+        acq_ring_release(ring, n);
+        total += n;
+    }
+
+    return total;
+}
+
+void acq_ring_get_counters(const acq_ring_t *ring, acq_ring_counters_t *out)
+{
+    uint64_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    uint64_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+
+    out->capacity = ring->mask + 1U;
+    out->occupancy = (head >= tail) ? (head - tail) : 0U;
+    out->pushed = atomic_load_explicit(&ring->pushed, memory_order_relaxed);
+    out->overflows = atomic_load_explicit(&ring->overflows, memory_order_relaxed);
+    out->high_water = atomic_load_explicit(&ring->high_water, memory_order_relaxed);
+}
+
+void acq_ring_get_dwell(const acq_ring_t *ring, lat_hist_t *out)
+{
+    lat_recorder_snapshot(&ring->dwell, out);
+}
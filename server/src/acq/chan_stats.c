@@ -0,0 +1,856 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Miguel Dovale (University of Arizona)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "chan_stats.h"
+
+#include <errno.h>
+#include <limits.h>
+#include <math.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define CHAN_STATS_HAVE_X86 1
+#include <immintrin.h>
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define CHAN_STATS_HAVE_NEON 1
+#include <arm_neon.h>
+#endif
+
+#define CHAN_CALIB_LINE_BYTES 256U
+
+/*
+ * Accumulate n frames into a block: sum and sum of squares of ch - shift,
+ * min and max of ch. With 24-bit codes |ch - shift| < 2^24, so a block of
+ * CHAN_STATS_BLOCK_FRAMES squares stays below 2^60.
+ */
+typedef void (*stats_block_fn)(const ads1278_frame_t *frames, size_t n, uint32_t channels, const int32_t *shift,
+                               int64_t *sum, uint64_t *sq, int32_t *min, int32_t *max);
+typedef void (*calib_frames_fn)(const chan_calib_t *cal, const ads1278_frame_t *frames, size_t n, float *out);
+typedef void (*calib_samples_fn)(const int32_t *codes, size_t n, float scale, float offset, float *out);
+
+typedef struct {
+    const char *name;
+    stats_block_fn block;
+    calib_frames_fn frames;
+    calib_samples_fn samples;
+} chan_stats_ops_t;
+
+/* Merged statistics of one set (window or total). */
+typedef struct {
+    uint64_t frames;            /* including the open block */
+    uint64_t merged;            /* frames folded into mean/m2 */
+    uint64_t first_seq;
+    uint64_t last_seq;
+    uint64_t first_tstamp_ns;
+    uint64_t last_tstamp_ns;
+    double mean[ADS1278_MAX_CHANNELS];
+    double m2[ADS1278_MAX_CHANNELS];
+    int32_t min[ADS1278_MAX_CHANNELS];
+    int32_t max[ADS1278_MAX_CHANNELS];
+} stats_set_t;
+
+struct chan_stats {
+    uint32_t channels;
+    bool have_shift;
+
+    /* Open block, exact integers relative to shift. */
+    uint32_t block_n;
+    int32_t shift[ADS1278_MAX_CHANNELS];
+    int64_t sum[ADS1278_MAX_CHANNELS];
+    uint64_t sq[ADS1278_MAX_CHANNELS];
+    int32_t min[ADS1278_MAX_CHANNELS];
+    int32_t max[ADS1278_MAX_CHANNELS];
+
+    stats_set_t window;
+    stats_set_t total;
+};
+
+static void stats_block_range(const ads1278_frame_t *frames, size_t n, uint32_t first, uint32_t channels,
+                              const int32_t *shift, int64_t *sum, uint64_t *sq, int32_t *min, int32_t *max)
+{
+    size_t i;
+    uint32_t c;
+
+    for (i = 0U; i < n; ++i) {
+        const int32_t *ch = frames[i].ch;
+
+        for (c = first; c < channels; ++c) {
+            const int32_t d = ch[c] - shift[c];
+
+            sum[c] += d;
+            sq[c] += (uint64_t)((int64_t)d * d);
+            if (ch[c] < min[c]) {
+                min[c] = ch[c];
+            }
+            if (ch[c] > max[c]) {
+                max[c] = ch[c];
+            }
+        }
+    }
+}
+
+static void stats_block_ref(const ads1278_frame_t *frames, size_t n, uint32_t channels, const int32_t *shift,
+                            int64_t *sum, uint64_t *sq, int32_t *min, int32_t *max)
+{
+    stats_block_range(frames, n, 0U, channels, shift, sum, sq, min, max);
+}
+
+static void calib_frames_range(const chan_calib_t *cal, const ads1278_frame_t *frames, size_t n, uint32_t first,
+                               float *out)
+{
+    const uint32_t channels = cal->channel_count;
+    size_t i;
+    uint32_t c;
+
+    for (i = 0U; i < n; ++i) {
+        for (c = first; c < channels; ++c) {
+            const float v = (float)frames[i].ch[c] * cal->scale[c];
+
+            out[(i * channels) + c] = v + cal->offset[c];
+        }
+    }
+}
+
+static void calib_frames_ref(const chan_calib_t *cal, const ads1278_frame_t *frames, size_t n, float *out)
+{
+    calib_frames_range(cal, frames, n, 0U, out);
+}
+
+static void calib_samples_ref(const int32_t *codes, size_t n, float scale, float offset, float *out)
+{
+    size_t i;
+
+    for (i = 0U; i < n; ++i) {
+        const float v = (float)codes[i] * scale;
+
+        out[i] = v + offset;
+    }
+}
+
+#if defined(CHAN_STATS_HAVE_X86)
+
+/*
+ * Channels across lanes: one unaligned load per frame and group. Sums widen
+ * to 64 bits per lane; squares use the signed 32x32->64 multiply on even
+ * lanes, and again after shifting the odd lanes down.
+ */
+__attribute__((target("sse4.1")))
+static void stats_block_sse41(const ads1278_frame_t *frames, size_t n, uint32_t channels, const int32_t *shift,
+                              int64_t *sum, uint64_t *sq, int32_t *min, int32_t *max)
+{
+    uint32_t g;
+
+    for (g = 0U; g + 4U <= channels; g += 4U) {
+        const __m128i k = _mm_loadu_si128((const __m128i *)(shift + g));
+        __m128i s_lo = _mm_loadu_si128((const __m128i *)(sum + g));
+        __m128i s_hi = _mm_loadu_si128((const __m128i *)(sum + g + 2));
+        __m128i q_even = _mm_setzero_si128();
+        __m128i q_odd = _mm_setzero_si128();
+        __m128i lo = _mm_loadu_si128((const __m128i *)(min + g));
+        __m128i hi = _mm_loadu_si128((const __m128i *)(max + g));
+        uint64_t q[4];
+        size_t i;
+
+        for (i = 0U; i < n; ++i) {
+            const __m128i x = _mm_loadu_si128((const __m128i *)(frames[i].ch + g));
+            const __m128i d = _mm_sub_epi32(x, k);
+            const __m128i d_odd = _mm_srli_epi64(d, 32);
+
+            lo = _mm_min_epi32(lo, x);
+            hi = _mm_max_epi32(hi, x);
+            s_lo = _mm_add_epi64(s_lo, _mm_cvtepi32_epi64(d));
+            s_hi = _mm_add_epi64(s_hi, _mm_cvtepi32_epi64(_mm_srli_si128(d, 8)));
+            q_even = _mm_add_epi64(q_even, _mm_mul_epi32(d, d));
+            q_odd = _mm_add_epi64(q_odd, _mm_mul_epi32(d_odd, d_odd));
+        }
+
+        _mm_storeu_si128((__m128i *)(sum + g), s_lo);
+        _mm_storeu_si128((__m128i *)(sum + g + 2), s_hi);
+        _mm_storeu_si128((__m128i *)(min + g), lo);
+        _mm_storeu_si128((__m128i *)(max + g), hi);
+        _mm_storeu_si128((__m128i *)q, q_even);
+        _mm_storeu_si128((__m128i *)(q + 2), q_odd);
+        sq[g] += q[0];
+        sq[g + 1U] += q[2];
+        sq[g + 2U] += q[1];
+        sq[g + 3U] += q[3];
+    }
+
+    if (g < channels) {
+        stats_block_range(frames, n, g, channels, shift, sum, sq, min, max);
+    }
+}
+
+__attribute__((target("avx2")))
+static void stats_block_avx2(const ads1278_frame_t *frames, size_t n, uint32_t channels, const int32_t *shift,
+                             int64_t *sum, uint64_t *sq, int32_t *min, int32_t *max)
+{
+    uint32_t g;
+
+    for (g = 0U; g + 8U <= channels; g += 8U) {
+        const __m256i k = _mm256_loadu_si256((const __m256i *)(shift + g));
+        __m256i s_lo = _mm256_loadu_si256((const __m256i *)(sum + g));
+        __m256i s_hi = _mm256_loadu_si256((const __m256i *)(sum + g + 4));
+        __m256i q_even = _mm256_setzero_si256();
+        __m256i q_odd = _mm256_setzero_si256();
+        __m256i lo = _mm256_loadu_si256((const __m256i *)(min + g));
+        __m256i hi = _mm256_loadu_si256((const __m256i *)(max + g));
+        uint64_t q[8];
+        uint32_t j;
+        size_t i;
+
+        for (i = 0U; i < n; ++i) {
+            const __m256i x = _mm256_loadu_si256((const __m256i *)(frames[i].ch + g));
+            const __m256i d = _mm256_sub_epi32(x, k);
+            const __m256i d_odd = _mm256_srli_epi64(d, 32);
+
+            lo = _mm256_min_epi32(lo, x);
+            hi = _mm256_max_epi32(hi, x);
+            s_lo = _mm256_add_epi64(s_lo, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(d)));
+            s_hi = _mm256_add_epi64(s_hi, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(d, 1)));
+            q_even = _mm256_add_epi64(q_even, _mm256_mul_epi32(d, d));
+            q_odd = _mm256_add_epi64(q_odd, _mm256_mul_epi32(d_odd, d_odd));
+        }
+
+        _mm256_storeu_si256((__m256i *)(sum + g), s_lo);
+        _mm256_storeu_si256((__m256i *)(sum + g + 4), s_hi);
+        _mm256_storeu_si256((__m256i *)(min + g), lo);
+        _mm256_storeu_si256((__m256i *)(max + g), hi);
+        _mm256_storeu_si256((__m256i *)q, q_even);
+        _mm256_storeu_si256((__m256i *)(q + 4), q_odd);
+        for (j = 0U; j < 4U; ++j) {
+            sq[g + (2U * j)] += q[j];
+            sq[g + (2U * j) + 1U] += q[4U + j];
+        }
+    }
+
+    if (g < channels) {
+        stats_block_range(frames, n, g, channels, shift, sum, sq, min, max);
+    }
+}
+
+/* Multiply and add stay separate instructions, as in the reference, so results match bit for bit. */
+__attribute__((target("sse4.1")))
+static void calib_frames_sse41(const chan_calib_t *cal, const ads1278_frame_t *frames, size_t n, float *out)
+{
+    const uint32_t channels = cal->channel_count;
+    uint32_t g;
+
+    for (g = 0U; g + 4U <= channels; g += 4U) {
+        const __m128 scale = _mm_loadu_ps(cal->scale + g);
+        const __m128 offset = _mm_loadu_ps(cal->offset + g);
+        size_t i;
+
+        for (i = 0U; i < n; ++i) {
+            const __m128 x = _mm_cvtepi32_ps(_mm_loadu_si128((const __m128i *)(frames[i].ch + g)));
+
+            _mm_storeu_ps(out + (i * channels) + g, _mm_add_ps(_mm_mul_ps(x, scale), offset));
+        }
+    }
+
+    if (g < channels) {
+        calib_frames_range(cal, frames, n, g, out);
+    }
+}
+
+__attribute__((target("sse4.1")))
+static void calib_samples_sse41(const int32_t *codes, size_t n, float scale, float offset, float *out)
+{
+    const __m128 vscale = _mm_set1_ps(scale);
+    const __m128 voffset = _mm_set1_ps(offset);
+    size_t i;
+
+    for (i = 0U; i + 4U <= n; i += 4U) {
+        const __m128 x = _mm_cvtepi32_ps(_mm_loadu_si128((const __m128i *)(codes + i)));
+
+        _mm_storeu_ps(out + i, _mm_add_ps(_mm_mul_ps(x, vscale), voffset));
+    }
+
+    calib_samples_ref(codes + i, n - i, scale, offset, out + i);
+}
+
+__attribute__((target("avx2")))
+static void calib_frames_avx2(const chan_calib_t *cal, const ads1278_frame_t *frames, size_t n, float *out)
+{
+    const uint32_t channels = cal->channel_count;
+    uint32_t g;
+
+    for (g = 0U; g + 8U <= channels; g += 8U) {
+        const __m256 scale = _mm256_loadu_ps(cal->scale + g);
+        const __m256 offset = _mm256_loadu_ps(cal->offset + g);
+        size_t i;
+
+        for (i = 0U; i < n; ++i) {
+            const __m256 x = _mm256_cvtepi32_ps(_mm256_loadu_si256((const __m256i *)(frames[i].ch + g)));
+
+            _mm256_storeu_ps(out + (i * channels) + g, _mm256_add_ps(_mm256_mul_ps(x, scale), offset));
+        }
+    }
+
+    if (g < channels) {
+        calib_frames_range(cal, frames, n, g, out);
+    }
+}
+
+__attribute__((target("avx2")))
+static void calib_samples_avx2(const int32_t *codes, size_t n, float scale, float offset, float *out)
+{
+    const __m256 vscale = _mm256_set1_ps(scale);
+    const __m256 voffset = _mm256_set1_ps(offset);
+    size_t i;
+
+    for (i = 0U; i + 8U <= n; i += 8U) {
+        const __m256 x = _mm256_cvtepi32_ps(_mm256_loadu_si256((const __m256i *)(codes + i)));
+
+        _mm256_storeu_ps(out + i, _mm256_add_ps(_mm256_mul_ps(x, vscale), voffset));
+    }
+
+    calib_samples_ref(codes + i, n - i, scale, offset, out + i);
+}
+
+#endif /* CHAN_STATS_HAVE_X86 */
+
+#if defined(CHAN_STATS_HAVE_NEON)
+
+static void stats_block_neon(const ads1278_frame_t *frames, size_t n, uint32_t channels, const int32_t *shift,
+                             int64_t *sum, uint64_t *sq, int32_t *min, int32_t *max)
+{
+    uint32_t g;
+
+    for (g = 0U; g + 4U <= channels; g += 4U) {
+        const int32x4_t k = vld1q_s32(shift + g);
+        int64x2_t s_lo = vld1q_s64(sum + g);
+        int64x2_t s_hi = vld1q_s64(sum + g + 2);
+        int64x2_t q_lo = vdupq_n_s64(0);
+        int64x2_t q_hi = vdupq_n_s64(0);
+        int32x4_t lo = vld1q_s32(min + g);
+        int32x4_t hi = vld1q_s32(max + g);
+        int64_t q[4];
+        size_t i;
+
+        for (i = 0U; i < n; ++i) {
+            const int32x4_t x = vld1q_s32(frames[i].ch + g);
+            const int32x4_t d = vsubq_s32(x, k);
+
+            lo = vminq_s32(lo, x);
+            hi = vmaxq_s32(hi, x);
+            s_lo = vaddw_s32(s_lo, vget_low_s32(d));
+            s_hi = vaddw_s32(s_hi, vget_high_s32(d));
+            q_lo = vmlal_s32(q_lo, vget_low_s32(d), vget_low_s32(d));
+            q_hi = vmlal_s32(q_hi, vget_high_s32(d), vget_high_s32(d));
+        }
+
+        vst1q_s64(sum + g, s_lo);
+        vst1q_s64(sum + g + 2, s_hi);
+        vst1q_s32(min + g, lo);
+        vst1q_s32(max + g, hi);
+        vst1q_s64(q, q_lo);
+        vst1q_s64(q + 2, q_hi);
+        sq[g] += (uint64_t)q[0];
+        sq[g + 1U] += (uint64_t)q[1];
+        sq[g + 2U] += (uint64_t)q[2];
+        sq[g + 3U] += (uint64_t)q[3];
+    }
+
+    if (g < channels) {
+        stats_block_range(frames, n, g, channels, shift, sum, sq, min, max);
+    }
+}
+
+static void calib_frames_neon(const chan_calib_t *cal, const ads1278_frame_t *frames, size_t n, float *out)
+{
+    const uint32_t channels = cal->channel_count;
+    uint32_t g;
+
+    for (g = 0U; g + 4U <= channels; g += 4U) {
+        const float32x4_t scale = vld1q_f32(cal->scale + g);
+        const float32x4_t offset = vld1q_f32(cal->offset + g);
+        size_t i;
+
+        for (i = 0U; i < n; ++i) {
+            const float32x4_t x = vcvtq_f32_s32(vld1q_s32(frames[i].ch + g));
+
+            vst1q_f32(out + (i * channels) + g, vaddq_f32(vmulq_f32(x, scale), offset));
+        }
+    }
+
+    if (g < channels) {
+        calib_frames_range(cal, frames, n, g, out);
+    }
+}
+
+static void calib_samples_neon(const int32_t *codes, size_t n, float scale, float offset, float *out)
+{
+    const float32x4_t vscale = vdupq_n_f32(scale);
+    const float32x4_t voffset = vdupq_n_f32(offset);
+    size_t i;
+
+    for (i = 0U; i + 4U <= n; i += 4U) {
+        const float32x4_t x = vcvtq_f32_s32(vld1q_s32(codes + i));
+
+        vst1q_f32(out + i, vaddq_f32(vmulq_f32(x, vscale), voffset));
+    }
+
+    calib_samples_ref(codes + i, n - i, scale, offset, out + i);
+}
+
+#endif /* CHAN_STATS_HAVE_NEON */
+
+static const chan_stats_ops_t k_impls[CHAN_STATS_IMPL_COUNT] = {
+    [CHAN_STATS_SCALAR] = {"scalar", stats_block_ref, calib_frames_ref, calib_samples_ref},
+#if defined(CHAN_STATS_HAVE_X86)
+    [CHAN_STATS_SSE41] = {"sse4.1", stats_block_sse41, calib_frames_sse41, calib_samples_sse41},
+    [CHAN_STATS_AVX2] = {"avx2", stats_block_avx2, calib_frames_avx2, calib_samples_avx2},
+#else
+    [CHAN_STATS_SSE41] = {"sse4.1", NULL, NULL, NULL},
+    [CHAN_STATS_AVX2] = {"avx2", NULL, NULL, NULL},
+#endif
+#if defined(CHAN_STATS_HAVE_NEON)
+    [CHAN_STATS_NEON] = {"neon", stats_block_neon, calib_frames_neon, calib_samples_neon},
+#else
+    [CHAN_STATS_NEON] = {"neon", NULL, NULL, NULL},
+#endif
+};
+
+/* -1 until first use; resolving twice from racing threads is harmless. */
+static atomic_int g_active_impl = -1;
+
+bool chan_stats_available(chan_stats_impl_t impl)
+{
+    if ((unsigned)impl >= (unsigned)CHAN_STATS_IMPL_COUNT || k_impls[impl].block == NULL) {
+        return false;
+    }
+
+#if defined(CHAN_STATS_HAVE_X86)
+    if (impl == CHAN_STATS_SSE41) {
+        return __builtin_cpu_supports("sse4.1") != 0;
+    }
+    if (impl == CHAN_STATS_AVX2) {
+        return __builtin_cpu_supports("avx2") != 0;
+    }
+#endif
+
+    return true;
+}
+
+static chan_stats_impl_t resolve_best(void)
+{
+    static const chan_stats_impl_t k_preference[] = {
+        CHAN_STATS_AVX2,
+        CHAN_STATS_NEON,
+        CHAN_STATS_SSE41,
+    };
+    size_t idx;
+
+    for (idx = 0U; idx < sizeof(k_preference) / sizeof(k_preference[0]); ++idx) {
+        if (chan_stats_available(k_preference[idx])) {
+            return k_preference[idx];
+        }
+    }
+
+    return CHAN_STATS_SCALAR;
+}
+
+chan_stats_impl_t chan_stats_active(void)
+{
+    int impl = atomic_load_explicit(&g_active_impl, memory_order_relaxed);
+
+    if (impl < 0) {
+        impl = (int)resolve_best();
+        atomic_store_explicit(&g_active_impl, impl, memory_order_relaxed);
+    }
+
+    return (chan_stats_impl_t)impl;
+}
+
+int chan_stats_select(chan_stats_impl_t impl)
+{
+    if (!chan_stats_available(impl)) {
+        errno = ENOTSUP;
+        return -1;
+    }
+
+    atomic_store_explicit(&g_active_impl, (int)impl, memory_order_relaxed);
+    return 0;
+}
+
+const char *chan_stats_impl_name(chan_stats_impl_t impl)
+{
+    if ((unsigned)impl >= (unsigned)CHAN_STATS_IMPL_COUNT) {
+        return "unknown";
+    }
+
+    return k_impls[impl].name;
+}
+
+static void set_clear(stats_set_t *set, uint32_t channels)
+{
+    uint32_t c;
+
+    memset(set, 0, sizeof(*set));
+    for (c = 0U; c < channels; ++c) {
+        set->min[c] = INT32_MAX;
+        set->max[c] = INT32_MIN;
+    }
+}
+
+static void block_clear(chan_stats_t *st)
+{
+    uint32_t c;
+
+    st->block_n = 0U;
+    for (c = 0U; c < st->channels; ++c) {
+        st->sum[c] = 0;
+        st->sq[c] = 0U;
+        st->min[c] = INT32_MAX;
+        st->max[c] = INT32_MIN;
+    }
+}
+
+/* Chan et al. pairwise update: fold a block (n, mean, m2) into a set. */
+static void set_merge(stats_set_t *set, uint32_t c, uint64_t n, double mean, double m2)
+{
+    const double na = (double)set->merged;
+    const double nb = (double)n;
+    const double delta = mean - set->mean[c];
+    const double total = na + nb;
+
+    set->mean[c] += delta * (nb / total);
+    set->m2[c] += m2 + (delta * delta * (na * nb / total));
+}
+
+static void block_flush(chan_stats_t *st)
+{
+    const uint64_t n = st->block_n;
+    uint32_t c;
+
+    if (n == 0U) {
+        return;
+    }
+
+    for (c = 0U; c < st->channels; ++c) {
+        const double s = (double)st->sum[c];
+        const double mean = (double)st->shift[c] + (s / (double)n);
+        double m2 = (double)st->sq[c] - (s * (s / (double)n));
+        double next;
+
+        if (m2 < 0.0) {
+            m2 = 0.0;
+        }
+        set_merge(&st->window, c, n, mean, m2);
+        set_merge(&st->total, c, n, mean, m2);
+        if (st->min[c] < st->window.min[c]) {
+            st->window.min[c] = st->min[c];
+        }
+        if (st->max[c] > st->window.max[c]) {
+            st->window.max[c] = st->max[c];
+        }
+        if (st->min[c] < st->total.min[c]) {
+            st->total.min[c] = st->min[c];
+        }
+        if (st->max[c] > st->total.max[c]) {
+            st->total.max[c] = st->max[c];
+        }
+
+        /* Re-centre on the running mean so the next block's sums stay small. */
+        next = nearbyint(st->total.mean[c]);
+        st->shift[c] = (int32_t)fmax(fmin(next, 8388607.0), -8388608.0);
+    }
+    st->window.merged += n;
+    st->total.merged += n;
+    block_clear(st);
+}
+
+static void set_note_frames(stats_set_t *set, const ads1278_frame_t *frames, size_t n)
+{
+    if (set->frames == 0U) {
+        set->first_seq = frames[0].seq;
+        set->first_tstamp_ns = frames[0].tstamp_ns;
+    }
+    set->frames += n;
+    set->last_seq = frames[n - 1U].seq;
+    set->last_tstamp_ns = frames[n - 1U].tstamp_ns;
+}
+
+static void set_summary(const chan_stats_t *st, const stats_set_t *set, chan_stats_summary_t *out)
+{
+    uint32_t c;
+
+    memset(out, 0, sizeof(*out));
+    out->channel_count = st->channels;
+    if (set->merged == 0U) {
+        return;
+    }
+
+    out->frames = set->merged;
+    out->first_seq = set->first_seq;
+    out->last_seq = set->last_seq;
+    out->first_tstamp_ns = set->first_tstamp_ns;
+    out->last_tstamp_ns = set->last_tstamp_ns;
+    for (c = 0U; c < st->channels; ++c) {
+        const double var = set->m2[c] / (double)set->merged;
+
+        out->ch[c].min = (double)set->min[c];
+        out->ch[c].max = (double)set->max[c];
+        out->ch[c].mean = set->mean[c];
+        out->ch[c].stddev = sqrt(var);
+        out->ch[c].rms = sqrt((set->mean[c] * set->mean[c]) + var);
+    }
+}
+
+int chan_stats_create(chan_stats_t **out, uint32_t channel_count)
+{
+    chan_stats_t *st;
+
+    if (out == NULL) {
+        errno = EINVAL;
+        return -1;
+    }
+    *out = NULL;
+
+    if (channel_count == 0U) {
+        channel_count = ADS1278_CHANNEL_COUNT;
+    }
+    if (channel_count > ADS1278_MAX_CHANNELS) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    st = calloc(1U, sizeof(*st));
+    if (st == NULL) {
+        return -1;
+    }
+    st->channels = channel_count;
+    chan_stats_reset(st);
+
+    *out = st;
+    return 0;
+}
+
+void chan_stats_destroy(chan_stats_t *st)
+{
+    free(st);
+}
+
+void chan_stats_update(chan_stats_t *st, const ads1278_frame_t *frames, size_t n)
+{
+    const stats_block_fn block = k_impls[chan_stats_active()].block;
+
+    if (n == 0U) {
+        return;
+    }
+
+    if (!st->have_shift) {
+        memcpy(st->shift, frames[0].ch, st->channels * sizeof(st->shift[0]));
+        st->have_shift = true;
+    }
+    set_note_frames(&st->window, frames, n);
+    set_note_frames(&st->total, frames, n);
+
+    while (n > 0U) {
+        size_t take = CHAN_STATS_BLOCK_FRAMES - st->block_n;
+
+        if (take > n) {
+            take = n;
+        }
+        block(frames, take, st->channels, st->shift, st->sum, st->sq, st->min, st->max);
+        st->block_n += (uint32_t)take;
+        if (st->block_n == CHAN_STATS_BLOCK_FRAMES) {
+            block_flush(st);
+        }
+        frames += take;
+        n -= take;
+    }
+}
+
+void chan_stats_window(chan_stats_t *st, chan_stats_summary_t *out, bool reset)
+{
+    block_flush(st);
+    set_summary(st, &st->window, out);
+    if (reset) {
+        set_clear(&st->window, st->channels);
+    }
+}
+
+void chan_stats_total(chan_stats_t *st, chan_stats_summary_t *out)
+{
+    block_flush(st);
+    set_summary(st, &st->total, out);
+}
+
+void chan_stats_reset(chan_stats_t *st)
+{
+    st->have_shift = false;
+    block_clear(st);
+    set_clear(&st->window, st->channels);
+    set_clear(&st->total, st->channels);
+}
+
+void chan_calib_init(chan_calib_t *cal, uint32_t channel_count, double vref)
+{
+    const float scale = (float)(vref / CHAN_CALIB_FULL_SCALE);
+    uint32_t c;
+
+    memset(cal, 0, sizeof(*cal));
+    cal->channel_count = (channel_count != 0U) ? channel_count : ADS1278_CHANNEL_COUNT;
+    if (cal->channel_count > ADS1278_MAX_CHANNELS) {
+        cal->channel_count = ADS1278_MAX_CHANNELS;
+    }
+    for (c = 0U; c < cal->channel_count; ++c) {
+        cal->scale[c] = scale;
+    }
+}
+
+static int parse_calib_line(char *line, uint32_t channels, uint32_t *channel, double *gain, double *offset)
+{
+    char *comment = strchr(line, '#');
+    char *end;
+    unsigned long ch;
+
+    if (comment != NULL) {
+        *comment = '\0';
+    }
+    end = line;
+    while (*end == ' ' || *end == '\t' || *end == '\r' || *end == '\n') {
+        ++end;
+    }
+    if (*end == '\0') {
+        return 0;
+    }
+
+    errno = 0;
+    ch = strtoul(line, &end, 10);
+    if (end == line || errno != 0 || ch == 0UL || ch > channels) {
+        return -1;
+    }
+    line = end;
+    *gain = strtod(line, &end);
+    if (end == line || !isfinite(*gain) || *gain == 0.0) {
+        return -1;
+    }
+    line = end;
+    *offset = strtod(line, &end);
+    if (end == line || !isfinite(*offset)) {
+        return -1;
+    }
+    while (*end == ' ' || *end == '\t' || *end == '\r' || *end == '\n') {
+        ++end;
+    }
+    if (*end != '\0') {
+        return -1;
+    }
+
+    *channel = (uint32_t)(ch - 1UL);
+    return 1;
+}
+
+int chan_calib_load(chan_calib_t *cal, uint32_t channel_count, double vref, const char *path)
+{
+    char line[CHAN_CALIB_LINE_BYTES];
+    FILE *fp;
+    int ret = -1;
+
+    chan_calib_init(cal, channel_count, vref);
+
+    fp = fopen(path, "r");
+    if (fp == NULL) {
+        return -1;
+    }
+
+    while (fgets(line, sizeof(line), fp) != NULL) {
+        uint32_t channel;
+        double gain;
+        double offset;
+        int rc = parse_calib_line(line, cal->channel_count, &channel, &gain, &offset);
+
+        if (rc < 0) {
+            errno = EINVAL;
+            goto out;
+        }
+        if (rc > 0) {
+            cal->scale[channel] = (float)(vref / CHAN_CALIB_FULL_SCALE * gain);
+            cal->offset[channel] = (float)offset;
+        }
+    }
+    if (ferror(fp)) {
+        errno = EIO;
+        goto out;
+    }
+    ret = 0;
+
+out:
+    fclose(fp);
+    return ret;
+}
+
+void chan_calib_frames(const chan_calib_t *cal, const ads1278_frame_t *frames, size_t n, float *out)
+{
+    k_impls[chan_stats_active()].frames(cal, frames, n, out);
+}
+
+void chan_calib_samples(const chan_calib_t *cal, uint32_t channel, const int32_t *codes, size_t n, float *out)
+{
+    k_impls[chan_stats_active()].samples(codes, n, cal->scale[channel], cal->offset[channel], out);
+}
+
+void chan_calib_summary(const chan_calib_t *cal, chan_stats_summary_t *s)
+{
+    uint32_t channels = s->channel_count;
+    uint32_t c;
+
+    if (s->volts) {
+        return;
+    }
+    if (channels > cal->channel_count) {
+        channels = cal->channel_count;
+    }
+
+    for (c = 0U; c < channels && s->frames != 0U; ++c) {
+        chan_stats_channel_t *ch = &s->ch[c];
+        const double scale = (double)cal->scale[c];
+        const double offset = (double)cal->offset[c];
+        const double lo = (ch->min * scale) + offset;
+        const double hi = (ch->max * scale) + offset;
+
+        ch->min = (scale < 0.0) ? hi : lo;
+        ch->max = (scale < 0.0) ? lo : hi;
+        ch->mean = (ch->mean * scale) + offset;
+        ch->stddev *= fabs(scale);
+        ch->rms = sqrt((ch->mean * ch->mean) + (ch->stddev * ch->stddev));
+    }
+    s->volts = true;
+}
@@ -0,0 +1,724 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Miguel Dovale (University of Arizona)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "decim.h"
+
+#include <errno.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define DECIM_HAVE_NEON 1
+#endif
+
+#define DECIM_PI 3.14159265358979323846
+#define CIC_MAX_GROWTH_BITS 39.0
+#define CIC_FRAC_BITS 8U            /* extra resolution carried from CIC to FIR */
+#define CIC_MULT_SHIFT 30U
+#define FIR_SHIFT (DECIM_COEFF_FRAC_BITS + CIC_FRAC_BITS)
+#define DESIGN_GRID 512U
+#define DEFAULT_PASSBAND 0.8
+
+_Static_assert(ADS1278_MAX_CHANNELS <= 64U, "decim_cfg_t.channel_mask has one bit per channel");
+
+/* One channel group and its filter; state arrays are n channels wide. */
+typedef struct {
+    uint32_t n;
+    uint8_t in_ch[ADS1278_MAX_CHANNELS];  /* input channel of each group channel */
+    uint8_t out_ch[ADS1278_MAX_CHANNELS]; /* and its place in the output frame */
+    bool contiguous;            /* in_ch[] is a run, read straight from the frame */
+    int32_t *gather;            /* otherwise the group's samples of the current frame */
+    uint32_t r;
+    uint32_t order;             /* 0 without a CIC stage */
+    uint32_t m;
+    uint32_t taps;              /* 0 without a FIR stage */
+    uint64_t warmup;            /* CIC outputs before the filter output is valid */
+
+    /* CIC: integrators and comb delays ([stage * n + channel]) wrap modulo 2^64. */
+    uint64_t *integ;
+    uint64_t *comb;
+    uint32_t cic_pre_shift;     /* output = ((v >> pre_shift) * mult) >> CIC_MULT_SHIFT */
+    int64_t cic_mult;
+    uint32_t r_phase;           /* position of the next input in its CIC block */
+    uint32_t blk_count;         /* inputs in the current block, and their timestamps: */
+    uint64_t blk_t0;
+    uint64_t blk_tsum;          /* sum of (t - blk_t0) */
+    uint64_t blk_tlast;
+    int32_t *q8;                /* CIC output, n channels */
+    int64_t *acc;               /* filter output before rounding, n channels */
+
+    /* FIR: coefficients reversed so that coeffs[k] pairs with window row k (oldest first). */
+    int32_t *coeffs;
+    int32_t *hist;              /* 2 * taps rows of n; row k and k + taps are equal */
+    uint64_t *hist_ts;
+    uint32_t hist_pos;          /* oldest row of the window, next one to overwrite */
+    uint32_t m_phase;
+
+    uint64_t cic_outputs;       /* since the last reset */
+} decim_group_t;
+
+struct decim {
+    uint32_t channels;          /* per output frame */
+    uint8_t source[ADS1278_MAX_CHANNELS]; /* input channel of each output channel */
+    uint32_t factor;
+    size_t n_groups;
+    decim_group_t *groups;
+    bool started;
+    uint64_t next_seq;
+    decim_stats_t stats;
+};
+
+static int parse_field(const char *text, size_t len, unsigned long long max, unsigned long long *out)
+{
+    char buf[32];
+    char *end = NULL;
+
+    if (len == 0U || len >= sizeof(buf)) {
+        return -1;
+    }
+    memcpy(buf, text, len);
+    buf[len] = '\0';
+    errno = 0;
+    *out = strtoull(buf, &end, 0);
+    return (errno != 0 || *end != '\0' || buf[0] == '-' || *out > max) ? -1 : 0;
+}
+
+int decim_parse_spec(const char *spec, decim_cfg_t *cfg)
+{
+    const char *pos = spec;
+
+    if (spec == NULL || cfg == NULL) {
+        errno = EINVAL;
+        return -1;
+    }
+    memset(cfg, 0, sizeof(*cfg));
+
+    while (*pos != '\0') {
+        const char *end = strchr(pos, ',');
+        const char *eq = strchr(pos, '=');
+        size_t len = (end != NULL) ? (size_t)(end - pos) : strlen(pos);
+        size_t key_len;
+        unsigned long long value = 0ULL;
+
+        if (eq == NULL || eq >= pos + len) {
+            return -1;
+        }
+        key_len = (size_t)(eq - pos);
+        if (key_len == 4U && strncmp(pos, "pass", 4U) == 0) {
+            char buf[32];
+            char *num_end = NULL;
+
+            if (len - 5U == 0U || len - 5U >= sizeof(buf)) {
+                return -1;
+            }
+            memcpy(buf, eq + 1, len - 5U);
+            buf[len - 5U] = '\0';
+            cfg->fir_passband = strtod(buf, &num_end);
+            if (*num_end != '\0' || cfg->fir_passband <= 0.0 || cfg->fir_passband > 1.0) {
+                return -1;
+            }
+        } else if (key_len == 4U && strncmp(pos, "mask", 4U) == 0) {
+            if (parse_field(eq + 1, len - 5U, UINT64_MAX, &value) != 0) {
+                return -1;
+            }
+            cfg->channel_mask = (uint64_t)value;
+        } else {
+            if (parse_field(eq + 1, len - key_len - 1U, UINT32_MAX, &value) != 0) {
+                return -1;
+            }
+            if (key_len == 3U && strncmp(pos, "cic", 3U) == 0) {
+                cfg->cic_factor = (uint32_t)value;
+            } else if (key_len == 5U && strncmp(pos, "order", 5U) == 0) {
+                cfg->cic_order = (uint32_t)value;
+            } else if (key_len == 3U && strncmp(pos, "fir", 3U) == 0) {
+                cfg->fir_factor = (uint32_t)value;
+            } else if (key_len == 4U && strncmp(pos, "taps", 4U) == 0) {
+                cfg->fir_taps = (uint32_t)value;
+            } else {
+                return -1;
+            }
+        }
+        pos += len;
+        if (*pos == ',') {
+            ++pos;
+        }
+    }
+    return 0;
+}
+
+/* |H(f)| of the CIC at its output rate, f in cycles per output sample. */
+static double cic_gain(uint32_t r, uint32_t order, double f)
+{
+    double ratio;
+
+    if (order == 0U || f == 0.0) {
+        return 1.0;
+    }
+    ratio = sin(DECIM_PI * f) / ((double)r * sin(DECIM_PI * f / (double)r));
+    return pow(fabs(ratio), (double)order);
+}
+
+/*
+ * Window design of a low-pass FIR whose passband is the inverse of the CIC
+ * droop: the desired response is integrated on a grid, Blackman-windowed and
+ * scaled to unit DC gain.
+ */
+static void design_fir(const decim_group_t *group, double passband, double *h)
+{
+    double edge = passband * 0.5 / (double)group->m;
+    double centre = (double)(group->taps - 1U) / 2.0;
+    double sum = 0.0;
+    uint32_t k;
+
+    for (k = 0U; k < group->taps; ++k) {
+        double acc = 0.0;
+        uint32_t idx;
+
+        for (idx = 0U; idx <= DESIGN_GRID; ++idx) {
+            double f = edge * (double)idx / (double)DESIGN_GRID;
+            double weight = (idx == 0U || idx == DESIGN_GRID) ? 0.5 : 1.0;
+
+            acc += weight * cos(2.0 * DECIM_PI * f * ((double)k - centre)) / cic_gain(group->r, group->order, f);
+        }
+        h[k] = 2.0 * acc * edge / (double)DESIGN_GRID;
+        if (group->taps > 1U) {
+            double x = 2.0 * DECIM_PI * (double)k / (double)(group->taps - 1U);
+
+            h[k] *= 0.42 - (0.5 * cos(x)) + (0.08 * cos(2.0 * x));
+        }
+        sum += h[k];
+    }
+    for (k = 0U; k < group->taps; ++k) {
+        h[k] /= sum;
+    }
+}
+
+static int setup_fir(decim_group_t *group, const decim_cfg_t *cfg)
+{
+    uint32_t k;
+
+    group->coeffs = malloc((size_t)group->taps * sizeof(*group->coeffs));
+    group->hist = malloc((size_t)group->taps * 2U * group->n * sizeof(*group->hist));
+    group->hist_ts = malloc((size_t)group->taps * 2U * sizeof(*group->hist_ts));
+    if (group->coeffs == NULL || group->hist == NULL || group->hist_ts == NULL) {
+        return -1;
+    }
+
+    if (cfg->fir_coeffs != NULL) {
+        for (k = 0U; k < group->taps; ++k) {
+            group->coeffs[k] = cfg->fir_coeffs[group->taps - 1U - k];
+        }
+        return 0;
+    }
+
+    {
+        double *h = malloc((size_t)group->taps * sizeof(*h));
+        int64_t sum = 0;
+
+        if (h == NULL) {
+            return -1;
+        }
+        design_fir(group, (cfg->fir_passband > 0.0) ? cfg->fir_passband : DEFAULT_PASSBAND, h);
+        for (k = 0U; k < group->taps; ++k) {
+            group->coeffs[group->taps - 1U - k] = (int32_t)lround(h[k] * (double)(1UL << DECIM_COEFF_FRAC_BITS));
+            sum += group->coeffs[group->taps - 1U - k];
+        }
+        /* Rounding leaves the DC gain a few LSB off; the centre tap absorbs it. */
+        group->coeffs[group->taps / 2U] += (int32_t)((INT64_C(1) << DECIM_COEFF_FRAC_BITS) - sum);
+        free(h);
+    }
+    return 0;
+}
+
+/* Normalise the CIC gain R^N to 1 with CIC_FRAC_BITS fractional bits, in 64 bits. */
+static void setup_cic_scale(decim_group_t *group)
+{
+    double gain = pow((double)group->r, (double)group->order);
+    uint32_t bits = (uint32_t)ceil(log2(gain));
+
+    group->cic_pre_shift = (bits > CIC_FRAC_BITS) ? bits - CIC_FRAC_BITS : 0U;
+    group->cic_mult = (int64_t)llround(ldexp(1.0, (int)(CIC_MULT_SHIFT + CIC_FRAC_BITS + group->cic_pre_shift)) / gain);
+}
+
+/* Filter parameters of one group; its channels are filled in by the caller. */
+static int setup_group(decim_group_t *group, const decim_cfg_t *cfg)
+{
+    bool want_fir = cfg->fir_factor > 1U || cfg->fir_taps != 0U || cfg->fir_coeffs != NULL;
+
+    group->r = (cfg->cic_factor > 1U) ? cfg->cic_factor : 1U;
+    group->order = (group->r > 1U) ? ((cfg->cic_order != 0U) ? cfg->cic_order : DECIM_DEFAULT_CIC_ORDER) : 0U;
+    group->m = (cfg->fir_factor > 1U) ? cfg->fir_factor : 1U;
+    if (want_fir) {
+        group->taps = (cfg->fir_taps != 0U) ? cfg->fir_taps : (DECIM_DEFAULT_TAPS_PER_PHASE * group->m) + 1U;
+    }
+
+    if (group->order > DECIM_MAX_CIC_ORDER || group->taps > DECIM_MAX_FIR_TAPS ||
+        (cfg->fir_coeffs != NULL && cfg->fir_taps == 0U) ||
+        (double)group->order * log2((double)group->r) > CIC_MAX_GROWTH_BITS ||
+        (uint64_t)group->r * group->m > UINT32_MAX || (group->r == 1U && !want_fir) ||
+        cfg->fir_passband < 0.0 || cfg->fir_passband > 1.0) {
+        errno = EINVAL;
+        return -1;
+    }
+    group->warmup = ((group->order != 0U) ? group->order + 1U : 1U) + group->taps;
+    setup_cic_scale(group);
+
+    group->integ = calloc((size_t)group->order * group->n + 1U, sizeof(*group->integ));
+    group->comb = calloc((size_t)group->order * group->n + 1U, sizeof(*group->comb));
+    group->gather = calloc(group->n, sizeof(*group->gather));
+    group->q8 = calloc(group->n, sizeof(*group->q8));
+    group->acc = calloc(group->n, sizeof(*group->acc));
+    if (group->integ == NULL || group->comb == NULL || group->gather == NULL || group->q8 == NULL ||
+        group->acc == NULL) {
+        return -1;
+    }
+    return (group->taps != 0U) ? setup_fir(group, cfg) : 0;
+}
+
+int decim_create(decim_t **out, const decim_cfg_t *groups, size_t n_groups, uint32_t channels)
+{
+    decim_t *decim;
+    uint64_t all;
+    uint64_t used = 0U;
+    size_t idx;
+
+    if (out == NULL || groups == NULL || n_groups == 0U || n_groups > DECIM_MAX_GROUPS || channels == 0U ||
+        channels > ADS1278_MAX_CHANNELS) {
+        errno = EINVAL;
+        return -1;
+    }
+    *out = NULL;
+    all = (channels == 64U) ? UINT64_MAX : ((UINT64_C(1) << channels) - 1U);
+    for (idx = 0U; idx < n_groups; ++idx) {
+        uint64_t mask = (groups[idx].channel_mask != 0U) ? groups[idx].channel_mask : all;
+
+        if ((mask & ~all) != 0U || (mask & used) != 0U) {
+            errno = EINVAL;
+            return -1;
+        }
+        used |= mask;
+    }
+
+    decim = calloc(1U, sizeof(*decim));
+    if (decim == NULL) {
+        return -1;
+    }
+    decim->groups = calloc(n_groups, sizeof(*decim->groups));
+    if (decim->groups == NULL) {
+        free(decim);
+        return -1;
+    }
+    decim->n_groups = n_groups;
+
+    for (idx = 0U; idx < n_groups; ++idx) {
+        decim_group_t *group = &decim->groups[idx];
+        uint64_t mask = (groups[idx].channel_mask != 0U) ? groups[idx].channel_mask : all;
+        uint32_t place = 0U;
+        uint32_t channel;
+
+        /* Output frames keep the selected channels in input order. */
+        for (channel = 0U; channel < channels; ++channel) {
+            if ((mask & (UINT64_C(1) << channel)) != 0U) {
+                group->in_ch[group->n] = (uint8_t)channel;
+                group->out_ch[group->n] = (uint8_t)place;
+                ++group->n;
+            }
+            if ((used & (UINT64_C(1) << channel)) != 0U) {
+                ++place;
+            }
+        }
+        group->contiguous = (uint32_t)(group->in_ch[group->n - 1U] - group->in_ch[0]) + 1U == group->n;
+        if (setup_group(group, &groups[idx]) != 0) {
+            goto fail;
+        }
+        if (idx == 0U) {
+            decim->factor = group->r * group->m;
+        } else if (group->r * group->m != decim->factor) {
+            errno = EINVAL;
+            goto fail;
+        }
+    }
+    for (idx = 0U; idx < channels; ++idx) {
+        if ((used & (UINT64_C(1) << idx)) != 0U) {
+            decim->source[decim->channels++] = (uint8_t)idx;
+        }
+    }
+
+    *out = decim;
+    return 0;
+
+fail:
+    {
+        int saved_errno = errno;
+
+        decim_destroy(decim);
+        errno = saved_errno;
+    }
+    return -1;
+}
+
+void decim_destroy(decim_t *decim)
+{
+    size_t idx;
+
+    if (decim == NULL) {
+        return;
+    }
+    for (idx = 0U; idx < decim->n_groups; ++idx) {
+        decim_group_t *group = &decim->groups[idx];
+
+        free(group->integ);
+        free(group->comb);
+        free(group->gather);
+        free(group->q8);
+        free(group->acc);
+        free(group->coeffs);
+        free(group->hist);
+        free(group->hist_ts);
+    }
+    free(decim->groups);
+    free(decim);
+}
+
+void decim_reset(decim_t *decim)
+{
+    decim->started = false;
+}
+
+uint32_t decim_factor(const decim_t *decim)
+{
+    return decim->factor;
+}
+
+uint32_t decim_fir_taps(const decim_t *decim)
+{
+    uint32_t taps = 0U;
+    size_t idx;
+
+    for (idx = 0U; idx < decim->n_groups; ++idx) {
+        if (decim->groups[idx].taps > taps) {
+            taps = decim->groups[idx].taps;
+        }
+    }
+    return taps;
+}
+
+uint32_t decim_channels(const decim_t *decim)
+{
+    return decim->channels;
+}
+
+uint32_t decim_source_channel(const decim_t *decim, uint32_t channel)
+{
+    return decim->source[channel];
+}
+
+void decim_get_stats(const decim_t *decim, decim_stats_t *out)
+{
+    *out = decim->stats;
+}
+
+/* Clear the filter and align the decimation phases to the frame at seq. */
+static void restart(decim_group_t *group, uint64_t seq)
+{
+    memset(group->integ, 0, (size_t)group->order * group->n * sizeof(*group->integ));
+    memset(group->comb, 0, (size_t)group->order * group->n * sizeof(*group->comb));
+    group->r_phase = (uint32_t)(seq % group->r);
+    group->m_phase = (uint32_t)((seq / group->r) % group->m);
+    group->blk_count = 0U;
+    group->hist_pos = 0U;
+    group->cic_outputs = 0U;
+}
+
+static inline void integrate(decim_group_t *group, const int32_t *in)
+{
+    uint32_t channel = 0U;
+    uint32_t stage;
+
+#if defined(DECIM_HAVE_NEON)
+    for (; channel + 2U <= group->n; channel += 2U) {
+        uint64x2_t x = vreinterpretq_u64_s64(vmovl_s32(vld1_s32(in + channel)));
+
+        for (stage = 0U; stage < group->order; ++stage) {
+            uint64_t *acc = group->integ + ((size_t)stage * group->n) + channel;
+
+            x = vaddq_u64(vld1q_u64(acc), x);
+            vst1q_u64(acc, x);
+        }
+    }
+#endif
+    for (; channel < group->n; ++channel) {
+        uint64_t x = (uint64_t)(int64_t)in[channel];
+
+        for (stage = 0U; stage < group->order; ++stage) {
+            uint64_t *acc = group->integ + ((size_t)stage * group->n) + channel;
+
+            *acc += x;
+            x = *acc;
+        }
+    }
+}
+
+/* Comb section and gain normalisation at a CIC decimation instant. */
+static void cic_output(decim_group_t *group, const int32_t *in)
+{
+    const uint64_t *last = group->integ + ((size_t)((group->order != 0U) ? group->order - 1U : 0U) * group->n);
+    uint32_t channel;
+
+    for (channel = 0U; channel < group->n; ++channel) {
+        uint64_t x = (group->order != 0U) ? last[channel] : (uint64_t)(int64_t)in[channel];
+        int64_t v;
+        uint32_t stage;
+
+        for (stage = 0U; stage < group->order; ++stage) {
+            uint64_t *delay = group->comb + ((size_t)stage * group->n) + channel;
+            uint64_t y = x - *delay;
+
+            *delay = x;
+            x = y;
+        }
+        v = (int64_t)x >> group->cic_pre_shift;
+        group->q8[channel] = (int32_t)(((v * group->cic_mult) + (INT64_C(1) << (CIC_MULT_SHIFT - 1U))) >> CIC_MULT_SHIFT);
+    }
+}
+
+/* Input time the current CIC output is centred on: block mean minus the other N - 1 boxcars. */
+static uint64_t cic_tstamp(const decim_group_t *group)
+{
+    uint64_t mean = group->blk_t0 + (group->blk_tsum / group->blk_count);
+    uint64_t span = group->blk_tlast - group->blk_t0;
+
+    if (group->order <= 1U || group->blk_tlast < group->blk_t0) {
+        return mean;
+    }
+    return mean - (((uint64_t)(group->order - 1U) * span) / 2U);
+}
+
+static void fir_output(decim_group_t *group)
+{
+    size_t stride = group->n;
+    const int32_t *window = group->hist + ((size_t)group->hist_pos * stride);
+    int64_t *acc = group->acc;
+    uint32_t channel = 0U;
+    uint32_t k;
+
+#if defined(DECIM_HAVE_NEON)
+    for (; channel + 8U <= group->n; channel += 8U) {
+        const int32_t *row = window + channel;
+        int64x2_t sum[4] = {vdupq_n_s64(0), vdupq_n_s64(0), vdupq_n_s64(0), vdupq_n_s64(0)};
+        uint32_t idx;
+
+        for (k = 0U; k < group->taps; ++k, row += stride) {
+            int32x2_t coeff = vdup_n_s32(group->coeffs[k]);
+
+            sum[0] = vmlal_s32(sum[0], vld1_s32(row), coeff);
+            sum[1] = vmlal_s32(sum[1], vld1_s32(row + 2), coeff);
+            sum[2] = vmlal_s32(sum[2], vld1_s32(row + 4), coeff);
+            sum[3] = vmlal_s32(sum[3], vld1_s32(row + 6), coeff);
+        }
+        for (idx = 0U; idx < 4U; ++idx) {
+            vst1q_s64(acc + channel + (idx * 2U), sum[idx]);
+        }
+    }
+    for (; channel + 2U <= group->n; channel += 2U) {
+        const int32_t *row = window + channel;
+        int64x2_t sum = vdupq_n_s64(0);
+
+        for (k = 0U; k < group->taps; ++k, row += stride) {
+            sum = vmlal_s32(sum, vld1_s32(row), vdup_n_s32(group->coeffs[k]));
+        }
+        vst1q_s64(acc + channel, sum);
+    }
+#endif
+    if (channel < group->n) {
+        const int32_t *row = window;
+        uint32_t first = channel;
+
+        for (; channel < group->n; ++channel) {
+            acc[channel] = 0;
+        }
+        for (k = 0U; k < group->taps; ++k, row += stride) {
+            int64_t coeff = group->coeffs[k];
+
+            for (channel = first; channel < group->n; ++channel) {
+                acc[channel] += coeff * row[channel];
+            }
+        }
+    }
+}
+
+static int32_t clamp_sample(int64_t value)
+{
+    if (value > ADS1278_SAMPLE_MAX) {
+        return ADS1278_SAMPLE_MAX;
+    }
+    if (value < ADS1278_SAMPLE_MIN) {
+        return ADS1278_SAMPLE_MIN;
+    }
+    return (int32_t)value;
+}
+
+/* Round the group's output into its places in the output frame. */
+static void emit(const decim_group_t *group, ads1278_frame_t *out, uint32_t shift)
+{
+    uint32_t channel;
+
+    for (channel = 0U; channel < group->n; ++channel) {
+        out->ch[group->out_ch[channel]] = clamp_sample((group->acc[channel] + (INT64_C(1) << (shift - 1U))) >> shift);
+    }
+}
+
+/*
+ * Feed one frame to a group. At a decimation instant with the filter settled
+ * it writes its channels of out, sets *tstamp_ns and returns true.
+ */
+static bool group_step(decim_group_t *group, const ads1278_frame_t *frame, ads1278_frame_t *out,
+                       uint64_t *tstamp_ns)
+{
+    const int32_t *in = frame->ch + group->in_ch[0];
+    uint64_t cic_ts;
+    uint32_t channel;
+
+    if (!group->contiguous) {
+        for (channel = 0U; channel < group->n; ++channel) {
+            group->gather[channel] = frame->ch[group->in_ch[channel]];
+        }
+        in = group->gather;
+    }
+
+    integrate(group, in);
+    if (group->blk_count == 0U) {
+        group->blk_t0 = frame->tstamp_ns;
+        group->blk_tsum = 0U;
+    }
+    group->blk_tsum += frame->tstamp_ns - group->blk_t0;
+    group->blk_tlast = frame->tstamp_ns;
+    ++group->blk_count;
+    if (++group->r_phase < group->r) {
+        return false;
+    }
+
+    /* CIC output */
+    group->r_phase = 0U;
+    cic_output(group, in);
+    cic_ts = cic_tstamp(group);
+    group->blk_count = 0U;
+    ++group->cic_outputs;
+
+    if (group->taps == 0U) {
+        if (group->cic_outputs < group->warmup) {
+            return false;
+        }
+        for (channel = 0U; channel < group->n; ++channel) {
+            group->acc[channel] = group->q8[channel];
+        }
+        emit(group, out, CIC_FRAC_BITS);
+        *tstamp_ns = cic_ts;
+        return true;
+    }
+
+    /* FIR: append the row twice so the window is always contiguous. */
+    {
+        uint32_t mirror = group->hist_pos + group->taps;
+        size_t row_bytes = (size_t)group->n * sizeof(*group->q8);
+
+        memcpy(group->hist + ((size_t)group->hist_pos * group->n), group->q8, row_bytes);
+        memcpy(group->hist + ((size_t)mirror * group->n), group->q8, row_bytes);
+        group->hist_ts[group->hist_pos] = cic_ts;
+        group->hist_ts[mirror] = cic_ts;
+        if (++group->hist_pos == group->taps) {
+            group->hist_pos = 0U;
+        }
+    }
+    if (++group->m_phase < group->m) {
+        return false;
+    }
+    group->m_phase = 0U;
+    if (group->cic_outputs < group->warmup) {
+        return false;
+    }
+    {
+        const uint64_t *ts = group->hist_ts + group->hist_pos;
+        uint64_t early = ts[(group->taps - 1U) / 2U];
+        uint64_t late = ts[group->taps / 2U];
+
+        fir_output(group);
+        emit(group, out, FIR_SHIFT);
+        *tstamp_ns = early + ((late - early) / 2U);
+    }
+    return true;
+}
+
+size_t decim_process(decim_t *decim, const ads1278_frame_t *in, size_t n, ads1278_frame_t *out)
+{
+    size_t produced = 0U;
+    size_t idx;
+
+    for (idx = 0U; idx < n; ++idx) {
+        const ads1278_frame_t *frame = &in[idx];
+        ads1278_frame_t *dst = &out[produced];
+        uint64_t tstamp_ns = 0U;
+        uint64_t unused_ns;
+        size_t ready = 0U;
+        size_t group;
+
+        if (!decim->started || frame->seq != decim->next_seq) {
+            if (decim->started) {
+                ++decim->stats.resets;
+            }
+            for (group = 0U; group < decim->n_groups; ++group) {
+                restart(&decim->groups[group], frame->seq);
+            }
+            decim->started = true;
+        }
+        decim->next_seq = frame->seq + 1U;
+        ++decim->stats.frames_in;
+
+        /* The groups share the factor, so their decimation instants coincide. */
+        for (group = 0U; group < decim->n_groups; ++group) {
+            if (group_step(&decim->groups[group], frame, dst, (group == 0U) ? &tstamp_ns : &unused_ns)) {
+                ++ready;
+            }
+        }
+        if (ready != decim->n_groups) {
+            continue;
+        }
+        dst->seq = frame->seq / decim->factor;
+        dst->tstamp_ns = tstamp_ns;
+        memset(&dst->ch[decim->channels], 0, (ADS1278_MAX_CHANNELS - decim->channels) * sizeof(dst->ch[0]));
+        ++decim->stats.frames_out;
+        ++produced;
+    }
+    return produced;
+}
@@ -0,0 +1,606 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Miguel Dovale (University of Arizona)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "psd.h"
+
+#include <errno.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PSD_TWO_PI 6.28318530717958647692
+
+/*
+ * Real FFT of n points as one complex FFT of n/2 points over the even/odd
+ * sample pairs, then a split step that separates the two half spectra.
+ */
+struct psd_rfft {
+    uint32_t n;
+    uint32_t half;
+    uint32_t *rev;              /* [half] bit-reversed index */
+    double *tw;                 /* [half / 2] (cos, -sin) of 2 pi j / half */
+    double *split;              /* [half / 2 + 1] (cos, -sin) of 2 pi k / n */
+    double *work;               /* [half] complex */
+};
+
+struct psd {
+    psd_cfg_t cfg;
+    chan_calib_t calib;
+    uint32_t channels;
+    uint32_t fft_size;
+    uint32_t bins;              /* fft_size / 2 + 1 */
+    uint32_t out_bins;
+    uint32_t group;
+    psd_rfft_t *fft;
+    double *window;
+    double win_sum;
+    double win_sum_sq;
+
+    /* The open segment: fill samples per channel, channel c at seg[c * fft_size]. */
+    double *seg;
+    uint64_t *tstamp;           /* [fft_size] timestamps of the segment's frames */
+    uint32_t fill;
+    bool have_seq;
+    uint64_t next_seq;
+
+    double *in;                 /* [fft_size] windowed segment */
+    double *spec;               /* [bins] complex */
+    double *acc;                /* [channels * bins] summed periodograms */
+    float *out;                 /* [channels * out_bins] last result */
+    uint32_t segments;
+    uint64_t first_seq;
+    uint64_t first_tstamp_ns;
+    uint64_t last_seq;
+    uint64_t last_tstamp_ns;
+    uint64_t next_id;
+    psd_stats_t stats;
+};
+
+int psd_rfft_create(psd_rfft_t **out, uint32_t n)
+{
+    psd_rfft_t *fft;
+    uint32_t bits = 0U;
+    uint32_t idx;
+
+    if (out == NULL || n < 4U || (n & (n - 1U)) != 0U) {
+        errno = EINVAL;
+        return -1;
+    }
+    *out = NULL;
+
+    fft = calloc(1U, sizeof(*fft));
+    if (fft == NULL) {
+        return -1;
+    }
+    fft->n = n;
+    fft->half = n / 2U;
+    fft->rev = calloc(fft->half, sizeof(*fft->rev));
+    fft->tw = calloc(fft->half, sizeof(*fft->tw));
+    fft->split = calloc((size_t)fft->half + 2U, sizeof(*fft->split));
+    fft->work = calloc((size_t)fft->half * 2U, sizeof(*fft->work));
+    if (fft->rev == NULL || fft->tw == NULL || fft->split == NULL || fft->work == NULL) {
+        psd_rfft_destroy(fft);
+        return -1;
+    }
+
+    while ((1U << bits) < fft->half) {
+        ++bits;
+    }
+    for (idx = 0U; idx < fft->half; ++idx) {
+        uint32_t r = 0U;
+        uint32_t b;
+
+        for (b = 0U; b < bits; ++b) {
+            r |= ((idx >> b) & 1U) << (bits - 1U - b);
+        }
+        fft->rev[idx] = r;
+    }
+    for (idx = 0U; idx < fft->half / 2U; ++idx) {
+        double angle = PSD_TWO_PI * (double)idx / (double)fft->half;
+
+        fft->tw[2U * idx] = cos(angle);
+        fft->tw[(2U * idx) + 1U] = -sin(angle);
+    }
+    for (idx = 0U; idx <= fft->half / 2U; ++idx) {
+        double angle = PSD_TWO_PI * (double)idx / (double)n;
+
+        fft->split[2U * idx] = cos(angle);
+        fft->split[(2U * idx) + 1U] = -sin(angle);
+    }
+
+    *out = fft;
+    return 0;
+}
+
+void psd_rfft_destroy(psd_rfft_t *fft)
+{
+    if (fft == NULL) {
+        return;
+    }
+    free(fft->rev);
+    free(fft->tw);
+    free(fft->split);
+    free(fft->work);
+    free(fft);
+}
+
+void psd_rfft_forward(psd_rfft_t *fft, const double *in, double *out)
+{
+    const uint32_t half = fft->half;
+    double *z = fft->work;
+    uint32_t len;
+    uint32_t k;
+
+    /* Pack x[2j] + i x[2j + 1] in bit-reversed order, then radix-2 butterflies. */
+    for (k = 0U; k < half; ++k) {
+        uint32_t r = fft->rev[k];
+
+        z[2U * r] = in[2U * k];
+        z[(2U * r) + 1U] = in[(2U * k) + 1U];
+    }
+    for (len = 2U; len <= half; len <<= 1U) {
+        const uint32_t span = len / 2U;
+        const uint32_t step = half / len;
+        uint32_t base;
+
+        for (base = 0U; base < half; base += len) {
+            double *a = z + (2U * base);
+            double *b = a + (2U * span);
+            uint32_t j;
+
+            for (j = 0U; j < span; ++j) {
+                const double wr = fft->tw[2U * j * step];
+                const double wi = fft->tw[(2U * j * step) + 1U];
+                const double br = (b[2U * j] * wr) - (b[(2U * j) + 1U] * wi);
+                const double bi = (b[2U * j] * wi) + (b[(2U * j) + 1U] * wr);
+                const double ar = a[2U * j];
+                const double ai = a[(2U * j) + 1U];
+
+                a[2U * j] = ar + br;
+                a[(2U * j) + 1U] = ai + bi;
+                b[2U * j] = ar - br;
+                b[(2U * j) + 1U] = ai - bi;
+            }
+        }
+    }
+
+    /*
+     * Split: with E = (Z[k] + conj(Z[half - k])) / 2 the even-sample spectrum
+     * and O = (Z[k] - conj(Z[half - k])) / 2i the odd one, X[k] = E + W^k O
+     * and X[half - k] = conj(E) - conj(W^k O).
+     */
+    out[0] = z[0] + z[1];
+    out[1] = 0.0;
+    out[2U * half] = z[0] - z[1];
+    out[(2U * half) + 1U] = 0.0;
+    for (k = 1U; k <= half / 2U; ++k) {
+        const uint32_t m = half - k;
+        const double er = 0.5 * (z[2U * k] + z[2U * m]);
+        const double ei = 0.5 * (z[(2U * k) + 1U] - z[(2U * m) + 1U]);
+        const double or_ = 0.5 * (z[(2U * k) + 1U] + z[(2U * m) + 1U]);
+        const double oi = -0.5 * (z[2U * k] - z[2U * m]);
+        const double wr = fft->split[2U * k];
+        const double wi = fft->split[(2U * k) + 1U];
+        const double tr = (or_ * wr) - (oi * wi);
+        const double ti = (or_ * wi) + (oi * wr);
+
+        out[2U * k] = er + tr;
+        out[(2U * k) + 1U] = ei + ti;
+        out[2U * m] = er - tr;
+        out[(2U * m) + 1U] = -(ei - ti);
+    }
+}
+
+static int parse_u32(const char *text, size_t len, uint32_t *out)
+{
+    char buf[32];
+    char *end = NULL;
+    unsigned long long value;
+
+    if (len == 0U || len >= sizeof(buf) || text[0] == '-') {
+        return -1;
+    }
+    memcpy(buf, text, len);
+    buf[len] = '\0';
+    errno = 0;
+    value = strtoull(buf, &end, 0);
+    if (errno != 0 || *end != '\0' || value > UINT32_MAX) {
+        return -1;
+    }
+    *out = (uint32_t)value;
+    return 0;
+}
+
+static bool key_is(const char *key, size_t key_len, const char *name)
+{
+    return key_len == strlen(name) && strncmp(key, name, key_len) == 0;
+}
+
+int psd_parse_spec(const char *spec, psd_cfg_t *cfg)
+{
+    const char *pos = spec;
+
+    if (spec == NULL || cfg == NULL) {
+        errno = EINVAL;
+        return -1;
+    }
+    memset(cfg, 0, sizeof(*cfg));
+
+    while (*pos != '\0') {
+        const char *end = strchr(pos, ',');
+        const char *eq = strchr(pos, '=');
+        size_t len = (end != NULL) ? (size_t)(end - pos) : strlen(pos);
+        const char *value;
+        size_t key_len;
+        size_t value_len;
+        uint32_t number = 0U;
+
+        if (eq == NULL || eq >= pos + len) {
+            return -1;
+        }
+        key_len = (size_t)(eq - pos);
+        value = eq + 1;
+        value_len = len - key_len - 1U;
+        if (key_is(pos, key_len, "window")) {
+            if (key_is(value, value_len, "hann")) {
+                cfg->window = PSD_WINDOW_HANN;
+            } else if (key_is(value, value_len, "rect")) {
+                cfg->window = PSD_WINDOW_RECT;
+            } else if (key_is(value, value_len, "bh")) {
+                cfg->window = PSD_WINDOW_BLACKMAN_HARRIS;
+            } else {
+                return -1;
+            }
+        } else {
+            if (parse_u32(value, value_len, &number) != 0) {
+                return -1;
+            }
+            if (key_is(pos, key_len, "fft")) {
+                cfg->fft_size = number;
+            } else if (key_is(pos, key_len, "hop")) {
+                cfg->hop = number;
+            } else if (key_is(pos, key_len, "avg")) {
+                cfg->averages = number;
+            } else if (key_is(pos, key_len, "bins")) {
+                cfg->max_bins = number;
+            } else if (key_is(pos, key_len, "detrend") && number <= 1U) {
+                cfg->detrend = (number != 0U);
+            } else {
+                return -1;
+            }
+        }
+        pos += len;
+        if (*pos == ',') {
+            ++pos;
+        }
+    }
+    return 0;
+}
+
+static void fill_window(double *w, uint32_t n, uint32_t kind)
+{
+    uint32_t j;
+
+    /* Periodic (DFT-even) forms, as usual for spectral estimation. */
+    for (j = 0U; j < n; ++j) {
+        double x = PSD_TWO_PI * (double)j / (double)n;
+
+        switch (kind) {
+            case PSD_WINDOW_RECT:
+                w[j] = 1.0;
+                break;
+            case PSD_WINDOW_BLACKMAN_HARRIS:
+                w[j] = 0.35875 - (0.48829 * cos(x)) + (0.14128 * cos(2.0 * x)) - (0.01168 * cos(3.0 * x));
+                break;
+            default:
+                w[j] = 0.5 - (0.5 * cos(x));
+                break;
+        }
+    }
+}
+
+int psd_create(psd_t **out, const psd_cfg_t *cfg)
+{
+    psd_t *psd;
+    uint32_t fft_size;
+    uint32_t hop;
+    uint32_t channels;
+    uint32_t j;
+
+    if (out == NULL || cfg == NULL) {
+        errno = EINVAL;
+        return -1;
+    }
+    *out = NULL;
+
+    fft_size = (cfg->fft_size != 0U) ? cfg->fft_size : PSD_DEFAULT_FFT_SIZE;
+    hop = (cfg->hop != 0U) ? cfg->hop : fft_size / 2U;
+    channels = (cfg->channel_count != 0U) ? cfg->channel_count : ADS1278_CHANNEL_COUNT;
+    if (fft_size < PSD_MIN_FFT_SIZE || fft_size > PSD_MAX_FFT_SIZE || (fft_size & (fft_size - 1U)) != 0U ||
+        hop > fft_size || cfg->window > PSD_WINDOW_BLACKMAN_HARRIS || channels > ADS1278_MAX_CHANNELS ||
+        cfg->sample_rate_hz < 0.0 || (cfg->calib != NULL && cfg->calib->channel_count < channels)) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    psd = calloc(1U, sizeof(*psd));
+    if (psd == NULL) {
+        return -1;
+    }
+    psd->cfg = *cfg;
+    psd->cfg.fft_size = fft_size;
+    psd->cfg.hop = hop;
+    psd->cfg.averages = (cfg->averages != 0U) ? cfg->averages : PSD_DEFAULT_AVERAGES;
+    psd->cfg.channel_count = channels;
+    psd->cfg.calib = NULL;
+    if (cfg->calib != NULL) {
+        psd->calib = *cfg->calib;
+        psd->cfg.calib = &psd->calib;
+    }
+    psd->channels = channels;
+    psd->fft_size = fft_size;
+    psd->bins = (fft_size / 2U) + 1U;
+    psd->group = 1U;
+    if (cfg->max_bins != 0U && psd->bins > cfg->max_bins) {
+        psd->group = (psd->bins + cfg->max_bins - 1U) / cfg->max_bins;
+    }
+    psd->out_bins = (psd->bins + psd->group - 1U) / psd->group;
+
+    psd->window = calloc(fft_size, sizeof(*psd->window));
+    psd->seg = calloc((size_t)channels * fft_size, sizeof(*psd->seg));
+    psd->tstamp = calloc(fft_size, sizeof(*psd->tstamp));
+    psd->in = calloc(fft_size, sizeof(*psd->in));
+    psd->spec = calloc((size_t)psd->bins * 2U, sizeof(*psd->spec));
+    psd->acc = calloc((size_t)channels * psd->bins, sizeof(*psd->acc));
+    psd->out = calloc((size_t)channels * psd->out_bins, sizeof(*psd->out));
+    if (psd->window == NULL || psd->seg == NULL || psd->tstamp == NULL || psd->in == NULL ||
+        psd->spec == NULL || psd->acc == NULL || psd->out == NULL ||
+        psd_rfft_create(&psd->fft, fft_size) != 0) {
+        psd_destroy(psd);
+        return -1;
+    }
+
+    fill_window(psd->window, fft_size, cfg->window);
+    for (j = 0U; j < fft_size; ++j) {
+        psd->win_sum += psd->window[j];
+        psd->win_sum_sq += psd->window[j] * psd->window[j];
+    }
+
+    *out = psd;
+    return 0;
+}
+
+void psd_destroy(psd_t *psd)
+{
+    if (psd == NULL) {
+        return;
+    }
+    psd_rfft_destroy(psd->fft);
+    free(psd->window);
+    free(psd->seg);
+    free(psd->tstamp);
+    free(psd->in);
+    free(psd->spec);
+    free(psd->acc);
+    free(psd->out);
+    free(psd);
+}
+
+uint32_t psd_result_bins(const psd_t *psd)
+{
+    return psd->out_bins;
+}
+
+void psd_reset(psd_t *psd)
+{
+    psd->fill = 0U;
+    psd->have_seq = false;
+    psd->segments = 0U;
+    memset(psd->acc, 0, (size_t)psd->channels * psd->bins * sizeof(*psd->acc));
+}
+
+/* Window and transform the full segment of every channel; add the periodograms. */
+static void add_segment(psd_t *psd, uint64_t seq, uint64_t tstamp_ns)
+{
+    const uint32_t n = psd->fft_size;
+    uint32_t c;
+
+    if (psd->segments == 0U) {
+        psd->first_seq = seq - (n - 1U);
+        psd->first_tstamp_ns = psd->tstamp[0];
+    }
+    psd->last_seq = seq;
+    psd->last_tstamp_ns = tstamp_ns;
+
+    for (c = 0U; c < psd->channels; ++c) {
+        const double *x = psd->seg + ((size_t)c * n);
+        double *acc = psd->acc + ((size_t)c * psd->bins);
+        double mean = 0.0;
+        uint32_t j;
+
+        if (psd->cfg.detrend) {
+            for (j = 0U; j < n; ++j) {
+                mean += x[j];
+            }
+            mean /= (double)n;
+        }
+        for (j = 0U; j < n; ++j) {
+            psd->in[j] = (x[j] - mean) * psd->window[j];
+        }
+        psd_rfft_forward(psd->fft, psd->in, psd->spec);
+        for (j = 0U; j < psd->bins; ++j) {
+            const double re = psd->spec[2U * j];
+            const double im = psd->spec[(2U * j) + 1U];
+
+            acc[j] += (re * re) + (im * im);
+        }
+    }
+    ++psd->segments;
+    ++psd->stats.segments;
+}
+
+/* Average, scale to a one-sided density and group the accumulated periodograms. */
+static void finish_result(psd_t *psd, psd_result_t *result)
+{
+    const uint32_t n = psd->fft_size;
+    double fs = psd->cfg.sample_rate_hz;
+    double scale;
+    uint32_t c;
+
+    if (fs == 0.0) {
+        /* Estimate from the frames themselves; 1 (cycles per sample) without usable timestamps. */
+        fs = 1.0;
+        if (psd->last_seq > psd->first_seq && psd->last_tstamp_ns > psd->first_tstamp_ns) {
+            fs = (double)(psd->last_seq - psd->first_seq) * 1e9 /
+                 (double)(psd->last_tstamp_ns - psd->first_tstamp_ns);
+        }
+    }
+    scale = 1.0 / (fs * psd->win_sum_sq * (double)psd->segments);
+
+    for (c = 0U; c < psd->channels; ++c) {
+        double *acc = psd->acc + ((size_t)c * psd->bins);
+        float *dst = psd->out + ((size_t)c * psd->out_bins);
+        uint32_t k;
+
+        for (k = 0U; k < psd->out_bins; ++k) {
+            uint32_t first = k * psd->group;
+            uint32_t last = first + psd->group;
+            double sum = 0.0;
+            uint32_t j;
+
+            if (last > psd->bins) {
+                last = psd->bins;
+            }
+            for (j = first; j < last; ++j) {
+                double one_sided = (j == 0U || j == n / 2U) ? 1.0 : 2.0;
+
+                sum += acc[j] * one_sided;
+            }
+            dst[k] = (float)(sum * scale / (double)(last - first));
+        }
+        result->psd[c] = dst;
+        memset(acc, 0, psd->bins * sizeof(*acc));
+    }
+
+    result->id = psd->next_id++;
+    result->first_seq = psd->first_seq;
+    result->last_seq = psd->last_seq;
+    result->first_tstamp_ns = psd->first_tstamp_ns;
+    result->last_tstamp_ns = psd->last_tstamp_ns;
+    result->segments = psd->segments;
+    result->fft_size = n;
+    result->window = psd->cfg.window;
+    result->bins = psd->out_bins;
+    result->bin_group = psd->group;
+    result->sample_rate_hz = fs;
+    result->bin_hz = fs / (double)n;
+    result->enbw_hz = fs * psd->win_sum_sq / (psd->win_sum * psd->win_sum);
+    result->channel_count = psd->channels;
+    result->volts = (psd->cfg.calib != NULL);
+    psd->segments = 0U;
+    ++psd->stats.results;
+}
+
+size_t psd_process(psd_t *psd, const ads1278_frame_t *frames, size_t n, psd_result_t *result)
+{
+    const uint32_t size = psd->fft_size;
+    const uint32_t keep = size - psd->cfg.hop;
+    size_t idx;
+
+    memset(result, 0, sizeof(*result));
+    for (idx = 0U; idx < n; ++idx) {
+        const ads1278_frame_t *frame = &frames[idx];
+        uint32_t c;
+
+        if (psd->have_seq && frame->seq != psd->next_seq) {
+            if (psd->fill != 0U) {
+                ++psd->stats.gaps;
+            }
+            psd->fill = 0U;
+        }
+        psd->have_seq = true;
+        psd->next_seq = frame->seq + 1U;
+        ++psd->stats.frames_in;
+
+        if (psd->cfg.calib != NULL) {
+            for (c = 0U; c < psd->channels; ++c) {
+                psd->seg[((size_t)c * size) + psd->fill] =
+                    ((double)frame->ch[c] * psd->calib.scale[c]) + psd->calib.offset[c];
+            }
+        } else {
+            for (c = 0U; c < psd->channels; ++c) {
+                psd->seg[((size_t)c * size) + psd->fill] = (double)frame->ch[c];
+            }
+        }
+        psd->tstamp[psd->fill] = frame->tstamp_ns;
+        if (++psd->fill < size) {
+            continue;
+        }
+
+        add_segment(psd, frame->seq, frame->tstamp_ns);
+        /* The next segment starts hop frames later: keep the overlap. */
+        for (c = 0U; c < psd->channels; ++c) {
+            double *x = psd->seg + ((size_t)c * size);
+
+            memmove(x, x + psd->cfg.hop, keep * sizeof(*x));
+        }
+        memmove(psd->tstamp, psd->tstamp + psd->cfg.hop, keep * sizeof(*psd->tstamp));
+        psd->fill = keep;
+
+        if (psd->segments == psd->cfg.averages) {
+            finish_result(psd, result);
+            return idx + 1U;
+        }
+    }
+    return n;
+}
+
+void psd_get_stats(const psd_t *psd, psd_stats_t *out)
+{
+    if (psd != NULL && out != NULL) {
+        *out = psd->stats;
+    }
+}
+
+const char *psd_window_name(uint32_t window)
+{
+    switch (window) {
+        case PSD_WINDOW_HANN:
+            return "hann";
+        case PSD_WINDOW_RECT:
+            return "rect";
+        case PSD_WINDOW_BLACKMAN_HARRIS:
+            return "blackman-harris";
+        default:
+            return "unknown";
+    }
+}
@@ -0,0 +1,339 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Miguel Dovale (University of Arizona)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/* sched_setaffinity(), CPU_SET and RLIMIT_RTPRIO are Linux extensions. */
+#define _GNU_SOURCE
+
+#include "rt.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/utsname.h>
+#include <unistd.h>
+
+#define RT_STACK_CHUNK_BYTES 4096U
+
+static int read_proc_int(const char *path, int *out)
+{
+    FILE *f = fopen(path, "r");
+    int ok;
+
+    if (f == NULL) {
+        return -1;
+    }
+    ok = (fscanf(f, "%d", out) == 1);
+    (void)fclose(f);
+    return ok ? 0 : -1;
+}
+
+static uint64_t rlimit_soft(int resource)
+{
+    struct rlimit rl;
+
+    if (getrlimit(resource, &rl) != 0) {
+        return 0U;
+    }
+    return (rl.rlim_cur == RLIM_INFINITY) ? UINT64_MAX : (uint64_t)rl.rlim_cur;
+}
+
+/* Touch one chunk per level so the stack pages are faulted in before the first DRDY. */
+__attribute__((noinline)) static size_t prefault_stack(size_t remaining)
+{
+    volatile uint8_t chunk[RT_STACK_CHUNK_BYTES];
+    size_t touched = RT_STACK_CHUNK_BYTES;
+    size_t offset;
+
+    for (offset = 0U; offset < RT_STACK_CHUNK_BYTES; offset += 64U) {
+        chunk[offset] = 0U;
+    }
+    if (remaining > RT_STACK_CHUNK_BYTES) {
+        touched += prefault_stack(remaining - RT_STACK_CHUNK_BYTES);
+    }
+    /* Read after the call so it cannot become a tail call. */
+    return touched + chunk[0];
+}
+
+bool rt_cfg_active(const rt_cfg_t *cfg)
+{
+    return cfg != NULL && (cfg->priority > 0 || cfg->cpu_mask != 0U || cfg->lock_memory);
+}
+
+void rt_probe(rt_status_t *status)
+{
+    struct utsname uts;
+    int realtime = 0;
+
+    memset(status, 0, sizeof(*status));
+    status->kernel = RT_KERNEL_UNKNOWN;
+    if (uname(&uts) == 0) {
+        /* Truncation is fine: only the PREEMPT markers near the start matter. */
+        memcpy(status->kernel_version, uts.version, strnlen(uts.version, sizeof(status->kernel_version) - 1U));
+        if (strstr(uts.version, "PREEMPT_RT") != NULL) {
+            status->kernel = RT_KERNEL_PREEMPT_RT;
+        } else if (strstr(uts.version, "PREEMPT") != NULL) {
+            status->kernel = RT_KERNEL_PREEMPT;
+        } else {
+            status->kernel = RT_KERNEL_NONE;
+        }
+    }
+    /* Present (and 1) only on PREEMPT_RT kernels. */
+    if (read_proc_int("/sys/kernel/realtime", &realtime) == 0 && realtime == 1) {
+        status->kernel = RT_KERNEL_PREEMPT_RT;
+    }
+    if (read_proc_int("/proc/sys/kernel/sched_rt_runtime_us", &status->rt_runtime_us) != 0) {
+        status->rt_runtime_us = -1;
+    }
+#ifdef RLIMIT_RTPRIO
+    status->rtprio_limit = rlimit_soft(RLIMIT_RTPRIO);
+#else
+    status->rtprio_limit = 0U;
+#endif
+    status->memlock_limit = rlimit_soft(RLIMIT_MEMLOCK);
+    status->privileged = (geteuid() == 0);
+    status->mlock_errno = 0;
+    status->sched_errno = 0;
+    status->affinity_errno = 0;
+}
+
+int rt_lock_memory(const rt_cfg_t *cfg, rt_status_t *status)
+{
+    if (cfg == NULL || !cfg->lock_memory) {
+        return 0;
+    }
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+        status->mlock_errno = errno;
+        return -1;
+    }
+    status->memory_locked = true;
+    return 0;
+}
+
+int rt_apply_thread(const rt_cfg_t *cfg, rt_status_t *status)
+{
+    int first_errno = 0;
+    size_t prefault;
+
+    if (!rt_cfg_active(cfg)) {
+        return 0;
+    }
+
+    if (cfg->priority > 0) {
+        struct sched_param param;
+        int rc;
+
+        memset(&param, 0, sizeof(param));
+        param.sched_priority = cfg->priority;
+        rc = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+        if (rc == 0) {
+            status->sched_applied = true;
+        } else {
+            status->sched_errno = rc;
+            first_errno = rc;
+        }
+    }
+
+    if (cfg->cpu_mask != 0U) {
+#ifdef __linux__
+        cpu_set_t set;
+        int cpu;
+
+        CPU_ZERO(&set);
+        for (cpu = 0; cpu < 64; ++cpu) {
+            if ((cfg->cpu_mask & (1ULL << cpu)) != 0U) {
+                CPU_SET(cpu, &set);
+            }
+        }
+        /* pid 0 is the calling thread, not the process. */
+        if (sched_setaffinity(0, sizeof(set), &set) == 0) {
+            status->affinity_applied = true;
+        } else {
+            status->affinity_errno = errno;
+            if (first_errno == 0) {
+                first_errno = errno;
+            }
+        }
+#else
+        /* Thread affinity is Linux-only; other systems report it as unsupported. */
+        status->affinity_errno = ENOTSUP;
+        if (first_errno == 0) {
+            first_errno = ENOTSUP;
+        }
+#endif
+    }
+
+    prefault = (cfg->stack_prefault_bytes != 0U) ? cfg->stack_prefault_bytes : RT_DEFAULT_STACK_PREFAULT_BYTES;
+    status->stack_prefaulted = prefault_stack(prefault);
+
+    if (first_errno != 0) {
+        errno = first_errno;
+        return -1;
+    }
+    return 0;
+}
+
+int rt_parse_cpus(const char *text, uint64_t *mask)
+{
+    uint64_t out = 0U;
+    const char *p = text;
+
+    if (text == NULL || mask == NULL || *text == '\0') {
+        errno = EINVAL;
+        return -1;
+    }
+    for (;;) {
+        char *end = NULL;
+        unsigned long first;
+        unsigned long last;
+
+        errno = 0;
+        first = strtoul(p, &end, 10);
+        if (errno != 0 || end == p || first >= 64U) {
+            errno = EINVAL;
+            return -1;
+        }
+        last = first;
+        p = end;
+        if (*p == '-') {
+            ++p;
+            last = strtoul(p, &end, 10);
+            if (errno != 0 || end == p || last >= 64U || last < first) {
+                errno = EINVAL;
+                return -1;
+            }
+            p = end;
+        }
+        for (; first <= last; ++first) {
+            out |= 1ULL << first;
+        }
+        if (*p == '\0') {
+            break;
+        }
+        if (*p != ',') {
+            errno = EINVAL;
+            return -1;
+        }
+        ++p;
+    }
+    *mask = out;
+    return 0;
+}
+
+static size_t append(char *buf, size_t len, size_t used, const char *fmt, ...)
+    __attribute__((format(printf, 4, 5)));
+
+static size_t append(char *buf, size_t len, size_t used, const char *fmt, ...)
+{
+    va_list ap;
+    int n;
+
+    if (used >= len) {
+        return used;
+    }
+    va_start(ap, fmt);
+    n = vsnprintf(buf + used, len - used, fmt, ap);
+    va_end(ap);
+    return (n < 0) ? used : used + (size_t)n;
+}
+
+void rt_format_status(const rt_cfg_t *cfg, const rt_status_t *status, char *buf, size_t len)
+{
+    size_t used = 0U;
+
+    if (len == 0U) {
+        return;
+    }
+    buf[0] = '\0';
+    used = append(buf, len, used, "RT: kernel %s", rt_kernel_name(status->kernel));
+    if (!rt_cfg_active(cfg)) {
+        used = append(buf, len, used, ", acquisition thread on the default scheduler.");
+    } else {
+        if (cfg->priority > 0) {
+            used = append(buf, len, used, ", SCHED_FIFO %d %s", cfg->priority,
+                status->sched_applied ? "on" : "FAILED");
+        }
+        if (cfg->cpu_mask != 0U) {
+            used = append(buf, len, used, ", CPU mask 0x%llx %s", (unsigned long long)cfg->cpu_mask,
+                status->affinity_applied ? "on" : "FAILED");
+        }
+        if (cfg->lock_memory) {
+            used = append(buf, len, used, ", mlockall %s", status->memory_locked ? "on" : "FAILED");
+        }
+        used = append(buf, len, used, ", %zu KiB stack prefaulted.", status->stack_prefaulted / 1024U);
+    }
+
+    if (cfg != NULL && cfg->priority > 0 && !status->sched_applied) {
+        if (status->rtprio_limit == UINT64_MAX) {
+            used = append(buf, len, used, "\nwarning: SCHED_FIFO: %s (RLIMIT_RTPRIO unlimited",
+                strerror(status->sched_errno));
+        } else {
+            used = append(buf, len, used, "\nwarning: SCHED_FIFO: %s (RLIMIT_RTPRIO %llu",
+                strerror(status->sched_errno), (unsigned long long)status->rtprio_limit);
+        }
+        used = append(buf, len, used, "%s)", status->privileged ? ", root; container without CAP_SYS_NICE?"
+                                                                 : ", not root; needs CAP_SYS_NICE or a higher limit");
+    }
+    if (cfg != NULL && cfg->cpu_mask != 0U && !status->affinity_applied) {
+        used = append(buf, len, used, "\nwarning: CPU affinity: %s", strerror(status->affinity_errno));
+    }
+    if (cfg != NULL && cfg->lock_memory && !status->memory_locked) {
+        used = append(buf, len, used, "\nwarning: mlockall: %s (RLIMIT_MEMLOCK %llu bytes)",
+            strerror(status->mlock_errno), (unsigned long long)status->memlock_limit);
+    }
+    if (rt_cfg_active(cfg) && status->kernel != RT_KERNEL_PREEMPT_RT) {
+        used = append(buf, len, used, "\nwarning: kernel is not PREEMPT_RT; wakeup latency is not bounded");
+    }
+    if (cfg != NULL && cfg->priority > 0 && status->rt_runtime_us >= 0) {
+        used = append(buf, len, used, "\nnote: RT throttling leaves %d us/s to RT tasks (sched_rt_runtime_us)",
+            status->rt_runtime_us);
+    }
+    (void)used;
+}
+
+const char *rt_kernel_name(rt_kernel_t kernel)
+{
+    switch (kernel) {
+        case RT_KERNEL_NONE:
+            return "no forced preemption";
+        case RT_KERNEL_PREEMPT:
+            return "PREEMPT";
+        case RT_KERNEL_PREEMPT_RT:
+            return "PREEMPT_RT";
+        default:
+            return "unknown";
+    }
+}
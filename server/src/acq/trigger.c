@@ -0,0 +1,527 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Miguel Dovale (University of Arizona)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "trigger.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TRIGGER_GPIO_POLL_MS 100U
+
+typedef struct {
+    trigger_cond_t cfg;
+    bool armed;                 /* seen the re-arm region since the last fire */
+    bool have_prev;             /* slopes: prev holds the previous sample */
+    int32_t prev;
+} cond_state_t;
+
+struct trigger {
+    trigger_cfg_t cfg;
+    cond_state_t cond[TRIGGER_MAX_CONDITIONS];
+
+    /* Pre-trigger history: the last hist_mask + 1 frames, hist_count since the last gap. */
+    ads1278_frame_t *hist;
+    uint32_t hist_mask;
+    uint64_t hist_count;
+
+    ads1278_frame_t *window;    /* pre + 1 + post frames */
+    uint32_t window_cap;
+    uint32_t window_len;
+    uint32_t post_left;
+    bool capturing;
+    trigger_event_t open;       /* header of the window being collected */
+    uint64_t holdoff_left;
+
+    bool have_seq;
+    uint64_t next_seq;
+    uint64_t next_id;
+
+    /* External trigger: earliest pending edge time, 0 = none. */
+    _Atomic uint64_t ext_ns;
+    ads1278_edge_t *edge;
+    pthread_t thread;
+    bool thread_started;
+    atomic_bool stop;
+    _Atomic int error;
+
+    _Atomic uint64_t frames_in;
+    _Atomic uint64_t events;
+    _Atomic uint64_t suppressed;
+    _Atomic uint64_t truncated;
+    _Atomic uint64_t external;
+};
+
+static int parse_i64(const char *text, size_t len, long long *out)
+{
+    char buf[32];
+    char *end = NULL;
+
+    if (len == 0U || len >= sizeof(buf)) {
+        return -1;
+    }
+    memcpy(buf, text, len);
+    buf[len] = '\0';
+    errno = 0;
+    *out = strtoll(buf, &end, 0);
+    return (errno != 0 || *end != '\0') ? -1 : 0;
+}
+
+static int parse_i32(const char *text, size_t len, int32_t *out)
+{
+    long long value;
+
+    if (parse_i64(text, len, &value) != 0 || value < INT32_MIN || value > INT32_MAX) {
+        return -1;
+    }
+    *out = (int32_t)value;
+    return 0;
+}
+
+static int parse_u32(const char *text, size_t len, uint32_t *out)
+{
+    long long value;
+
+    if (parse_i64(text, len, &value) != 0 || value < 0 || value > UINT32_MAX) {
+        return -1;
+    }
+    *out = (uint32_t)value;
+    return 0;
+}
+
+/* "LO:HI" with LO <= HI. */
+static int parse_range(const char *text, size_t len, int32_t *low, int32_t *high)
+{
+    const char *colon = memchr(text, ':', len);
+
+    if (colon == NULL || parse_i32(text, (size_t)(colon - text), low) != 0 ||
+        parse_i32(colon + 1, len - (size_t)(colon - text) - 1U, high) != 0 || *low > *high) {
+        return -1;
+    }
+    return 0;
+}
+
+static bool key_is(const char *key, size_t key_len, const char *name)
+{
+    return key_len == strlen(name) && strncmp(key, name, key_len) == 0;
+}
+
+int trigger_parse_spec(const char *spec, trigger_cfg_t *cfg)
+{
+    const char *pos = spec;
+    uint32_t channel = 0U;
+    trigger_cond_t *last = NULL;
+
+    if (spec == NULL || cfg == NULL) {
+        errno = EINVAL;
+        return -1;
+    }
+    memset(cfg, 0, sizeof(*cfg));
+
+    while (*pos != '\0') {
+        const char *end = strchr(pos, ',');
+        const char *eq = strchr(pos, '=');
+        size_t len = (end != NULL) ? (size_t)(end - pos) : strlen(pos);
+        const char *val;
+        size_t key_len;
+        size_t val_len;
+
+        if (eq == NULL || eq >= pos + len) {
+            return -1;
+        }
+        key_len = (size_t)(eq - pos);
+        val = eq + 1;
+        val_len = len - key_len - 1U;
+
+        if (key_is(pos, key_len, "pre")) {
+            if (parse_u32(val, val_len, &cfg->pre_frames) != 0) {
+                return -1;
+            }
+        } else if (key_is(pos, key_len, "post")) {
+            if (parse_u32(val, val_len, &cfg->post_frames) != 0) {
+                return -1;
+            }
+        } else if (key_is(pos, key_len, "holdoff")) {
+            if (parse_u32(val, val_len, &cfg->holdoff_frames) != 0) {
+                return -1;
+            }
+        } else if (key_is(pos, key_len, "ch")) {
+            if (parse_u32(val, val_len, &channel) != 0 || channel == 0U || channel > ADS1278_MAX_CHANNELS) {
+                return -1;
+            }
+            --channel;
+        } else if (key_is(pos, key_len, "hyst")) {
+            if (last == NULL || parse_u32(val, val_len, &last->hysteresis) != 0) {
+                return -1;
+            }
+        } else {
+            trigger_cond_t cond;
+
+            memset(&cond, 0, sizeof(cond));
+            cond.channel = channel;
+            if (key_is(pos, key_len, "rise") || key_is(pos, key_len, "fall")) {
+                cond.kind = (pos[0] == 'r') ? TRIGGER_RISING : TRIGGER_FALLING;
+                if (parse_i32(val, val_len, &cond.level) != 0) {
+                    return -1;
+                }
+            } else if (key_is(pos, key_len, "slope")) {
+                if (parse_i32(val, val_len, &cond.level) != 0 || cond.level == 0 || cond.level == INT32_MIN) {
+                    return -1;
+                }
+                cond.kind = (cond.level > 0) ? TRIGGER_SLOPE_UP : TRIGGER_SLOPE_DOWN;
+                cond.level = (cond.level > 0) ? cond.level : -cond.level;
+            } else if (key_is(pos, key_len, "outside") || key_is(pos, key_len, "inside")) {
+                cond.kind = (pos[0] == 'o') ? TRIGGER_WINDOW_EXIT : TRIGGER_WINDOW_ENTER;
+                if (parse_range(val, val_len, &cond.level, &cond.high) != 0) {
+                    return -1;
+                }
+            } else {
+                return -1;
+            }
+            if (cfg->cond_count == TRIGGER_MAX_CONDITIONS) {
+                return -1;
+            }
+            cfg->cond[cfg->cond_count] = cond;
+            last = &cfg->cond[cfg->cond_count++];
+        }
+        pos += len;
+        if (*pos == ',') {
+            ++pos;
+        }
+    }
+    return 0;
+}
+
+/* Advance one condition by a sample; true when it fires on it. */
+static bool cond_step(cond_state_t *st, int32_t sample)
+{
+    const trigger_cond_t *c = &st->cfg;
+    int64_t v = sample;
+    int64_t level = c->level;
+    int64_t hyst = c->hysteresis;
+    bool fire;
+    bool arm;
+
+    switch (c->kind) {
+        case TRIGGER_RISING:
+            fire = v >= level;
+            arm = v + hyst < level;
+            break;
+        case TRIGGER_FALLING:
+            fire = v <= level;
+            arm = v - hyst > level;
+            break;
+        case TRIGGER_SLOPE_UP:
+        case TRIGGER_SLOPE_DOWN:
+            if (!st->have_prev) {
+                st->have_prev = true;
+                st->prev = sample;
+                return false;
+            }
+            v = (int64_t)sample - st->prev;
+            st->prev = sample;
+            if (c->kind == TRIGGER_SLOPE_DOWN) {
+                v = -v;
+            }
+            fire = v >= level;
+            arm = v + hyst < level;
+            break;
+        case TRIGGER_WINDOW_EXIT:
+            fire = v < level || v > c->high;
+            arm = v >= level + hyst && v <= c->high - hyst;
+            break;
+        default:
+            fire = v >= level && v <= c->high;
+            arm = v < level - hyst || v > c->high + hyst;
+            break;
+    }
+    if (st->armed && fire) {
+        st->armed = false;
+        return true;
+    }
+    if (arm) {
+        st->armed = true;
+    }
+    return false;
+}
+
+static void *gpio_watch_main(void *arg)
+{
+    trigger_t *trig = arg;
+
+    while (!atomic_load_explicit(&trig->stop, memory_order_acquire)) {
+        uint64_t edge_ns = 0U;
+
+        if (ads1278_edge_wait(trig->edge, TRIGGER_GPIO_POLL_MS, &edge_ns) == 0) {
+            trigger_fire(trig, edge_ns);
+        } else if (errno != ETIMEDOUT && errno != EINTR) {
+            atomic_store_explicit(&trig->error, errno, memory_order_release);
+            break;
+        }
+    }
+    return NULL;
+}
+
+int trigger_create(trigger_t **out, const trigger_cfg_t *cfg)
+{
+    trigger_t *trig;
+    uint32_t channels;
+    uint32_t hist_cap = 1U;
+    uint64_t window;
+    uint32_t idx;
+
+    if (out == NULL || cfg == NULL) {
+        errno = EINVAL;
+        return -1;
+    }
+    *out = NULL;
+
+    channels = (cfg->channel_count != 0U) ? cfg->channel_count : ADS1278_CHANNEL_COUNT;
+    window = (uint64_t)cfg->pre_frames + 1U + cfg->post_frames;
+    if ((cfg->cond_count == 0U && !cfg->use_gpio) || cfg->cond_count > TRIGGER_MAX_CONDITIONS ||
+        channels > ADS1278_MAX_CHANNELS || window > TRIGGER_MAX_WINDOW_FRAMES) {
+        errno = EINVAL;
+        return -1;
+    }
+    for (idx = 0U; idx < cfg->cond_count; ++idx) {
+        if (cfg->cond[idx].channel >= channels || cfg->cond[idx].kind < TRIGGER_RISING ||
+            cfg->cond[idx].kind > TRIGGER_WINDOW_ENTER) {
+            errno = EINVAL;
+            return -1;
+        }
+    }
+
+    trig = calloc(1U, sizeof(*trig));
+    if (trig == NULL) {
+        return -1;
+    }
+    trig->cfg = *cfg;
+    trig->cfg.channel_count = channels;
+    for (idx = 0U; idx < cfg->cond_count; ++idx) {
+        trig->cond[idx].cfg = cfg->cond[idx];
+    }
+    while (hist_cap < cfg->pre_frames) {
+        hist_cap <<= 1U;
+    }
+    trig->hist_mask = hist_cap - 1U;
+    trig->window_cap = (uint32_t)window;
+    trig->hist = calloc(hist_cap, sizeof(*trig->hist));
+    trig->window = calloc(trig->window_cap, sizeof(*trig->window));
+    if (trig->hist == NULL || trig->window == NULL) {
+        trigger_destroy(trig);
+        return -1;
+    }
+
+    if (cfg->use_gpio) {
+        if (ads1278_edge_open(&trig->edge, cfg->gpio_chip, cfg->gpio_line) != 0) {
+            trigger_destroy(trig);
+            return -1;
+        }
+        if (pthread_create(&trig->thread, NULL, gpio_watch_main, trig) != 0) {
+            trigger_destroy(trig);
+            errno = EAGAIN;
+            return -1;
+        }
+        trig->thread_started = true;
+    }
+
+    *out = trig;
+    return 0;
+}
+
+void trigger_destroy(trigger_t *trig)
+{
+    if (trig == NULL) {
+        return;
+    }
+    if (trig->thread_started) {
+        atomic_store_explicit(&trig->stop, true, memory_order_release);
+        (void)pthread_join(trig->thread, NULL);
+    }
+    ads1278_edge_close(trig->edge);
+    free(trig->hist);
+    free(trig->window);
+    free(trig);
+}
+
+uint32_t trigger_window_frames(const trigger_t *trig)
+{
+    return trig->window_cap;
+}
+
+static void hand_out(trigger_t *trig, trigger_event_t *event)
+{
+    *event = trig->open;
+    event->frames = trig->window;
+    event->frame_count = trig->window_len;
+    trig->capturing = false;
+    trig->holdoff_left = trig->cfg.holdoff_frames;
+    atomic_fetch_add_explicit(&trig->events, 1U, memory_order_relaxed);
+}
+
+/* Start a window at frame: the history before it, then the frame itself. */
+static void open_window(trigger_t *trig, const ads1278_frame_t *frame, uint32_t condition)
+{
+    uint64_t pre = (trig->hist_count < trig->cfg.pre_frames) ? trig->hist_count : trig->cfg.pre_frames;
+    uint64_t first = trig->hist_count - pre;
+    uint32_t head = (uint32_t)(first & trig->hist_mask);
+    uint32_t run = trig->hist_mask + 1U - head;
+
+    if (run > pre) {
+        run = (uint32_t)pre;
+    }
+    memcpy(trig->window, &trig->hist[head], run * sizeof(*trig->window));
+    memcpy(trig->window + run, trig->hist, ((size_t)pre - run) * sizeof(*trig->window));
+    trig->window[pre] = *frame;
+    trig->window_len = (uint32_t)pre + 1U;
+    trig->post_left = trig->cfg.post_frames;
+    trig->capturing = true;
+
+    memset(&trig->open, 0, sizeof(trig->open));
+    trig->open.id = trig->next_id++;
+    trig->open.trigger_seq = frame->seq;
+    trig->open.trigger_tstamp_ns = frame->tstamp_ns;
+    trig->open.condition = condition;
+    trig->open.pre_frames = (uint32_t)pre;
+}
+
+size_t trigger_process(trigger_t *trig, const ads1278_frame_t *frames, size_t n, trigger_event_t *event)
+{
+    uint64_t ext = atomic_load_explicit(&trig->ext_ns, memory_order_acquire);
+    bool keep_history = trig->cfg.pre_frames != 0U;
+    size_t idx;
+
+    event->frame_count = 0U;
+    for (idx = 0U; idx < n; ++idx) {
+        const ads1278_frame_t *frame = &frames[idx];
+        uint32_t fired = UINT32_MAX;
+        uint32_t cond;
+
+        if (trig->have_seq && frame->seq != trig->next_seq) {
+            trig->hist_count = 0U;
+            for (cond = 0U; cond < trig->cfg.cond_count; ++cond) {
+                trig->cond[cond].have_prev = false;
+            }
+            if (trig->capturing) {
+                /* Hand out what was collected; the frame after the gap is seen again next call. */
+                trig->have_seq = false;
+                atomic_fetch_add_explicit(&trig->truncated, 1U, memory_order_relaxed);
+                hand_out(trig, event);
+                break;
+            }
+        }
+        trig->have_seq = true;
+        trig->next_seq = frame->seq + 1U;
+
+        for (cond = 0U; cond < trig->cfg.cond_count; ++cond) {
+            if (cond_step(&trig->cond[cond], frame->ch[trig->cond[cond].cfg.channel]) && fired == UINT32_MAX) {
+                fired = cond;
+            }
+        }
+        if (ext != 0U && frame->tstamp_ns >= ext) {
+            (void)atomic_compare_exchange_strong_explicit(&trig->ext_ns, &ext, 0U,
+                memory_order_acq_rel, memory_order_acquire);
+            ext = 0U;
+            if (fired == UINT32_MAX) {
+                fired = TRIGGER_EXTERNAL;
+            }
+        }
+
+        if (trig->capturing) {
+            trig->window[trig->window_len++] = *frame;
+            --trig->post_left;
+        } else if (trig->holdoff_left != 0U) {
+            --trig->holdoff_left;
+            if (fired != UINT32_MAX) {
+                atomic_fetch_add_explicit(&trig->suppressed, 1U, memory_order_relaxed);
+            }
+            fired = UINT32_MAX;
+        } else if (fired != UINT32_MAX) {
+            open_window(trig, frame, fired);
+            fired = UINT32_MAX;
+        }
+        if (fired != UINT32_MAX) {
+            atomic_fetch_add_explicit(&trig->suppressed, 1U, memory_order_relaxed);
+        }
+
+        if (keep_history) {
+            trig->hist[trig->hist_count & trig->hist_mask] = *frame;
+            ++trig->hist_count;
+        }
+        if (trig->capturing && trig->post_left == 0U) {
+            hand_out(trig, event);
+            ++idx;
+            break;
+        }
+    }
+    atomic_fetch_add_explicit(&trig->frames_in, idx, memory_order_relaxed);
+    return idx;
+}
+
+void trigger_flush(trigger_t *trig, trigger_event_t *event)
+{
+    event->frame_count = 0U;
+    if (trig->capturing) {
+        atomic_fetch_add_explicit(&trig->truncated, 1U, memory_order_relaxed);
+        hand_out(trig, event);
+    }
+}
+
+void trigger_fire(trigger_t *trig, uint64_t tstamp_ns)
+{
+    uint64_t cur = atomic_load_explicit(&trig->ext_ns, memory_order_acquire);
+
+    if (tstamp_ns == 0U) {
+        tstamp_ns = 1U;
+    }
+    /* Keep the earliest pending edge. */
+    while ((cur == 0U || tstamp_ns < cur) &&
+           !atomic_compare_exchange_weak_explicit(&trig->ext_ns, &cur, tstamp_ns,
+               memory_order_acq_rel, memory_order_acquire)) {
+    }
+    atomic_fetch_add_explicit(&trig->external, 1U, memory_order_relaxed);
+}
+
+int trigger_get_error(const trigger_t *trig)
+{
+    return atomic_load_explicit(&trig->error, memory_order_acquire);
+}
+
+void trigger_get_stats(const trigger_t *trig, trigger_stats_t *out)
+{
+    out->frames_in = atomic_load_explicit(&trig->frames_in, memory_order_relaxed);
+    out->events = atomic_load_explicit(&trig->events, memory_order_relaxed);
+    out->suppressed = atomic_load_explicit(&trig->suppressed, memory_order_relaxed);
+    out->truncated = atomic_load_explicit(&trig->truncated, memory_order_relaxed);
+    out->external = atomic_load_explicit(&trig->external, memory_order_relaxed);
+}
@@ -0,0 +1,1005 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Miguel Dovale (University of Arizona)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "capture_file.h"
+
+#include "proto.h"
+#include "sample_codec.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#define INDEX_INITIAL_ENTRIES 1024U
+
+/* Header field offsets (docs/ads1278_output.md). */
+#define HDR_VERSION 8U
+#define HDR_HEADER_BYTES 10U
+#define HDR_CHANNEL_COUNT 12U
+#define HDR_SAMPLE_BITS 14U
+#define HDR_ENCODING 16U
+#define HDR_CHUNK_FRAMES 20U
+#define HDR_CHANNEL_SLOT 24U
+#define HDR_ANCHOR_MONO 32U
+#define HDR_ANCHOR_REAL 40U
+#define HDR_INDEX_OFFSET 48U
+#define HDR_CHUNK_COUNT 56U
+#define HDR_FRAME_COUNT 64U
+#define HDR_ACQ 72U
+#define HDR_DRDY_CHIP 104U
+#define HDR_SYNC_CHIP 136U
+#define HDR_WRITER 168U
+#define HDR_DECIMATION 200U
+#define HDR_MISSED_FRAMES 208U
+#define HDR_GAP_COUNT 216U
+
+struct capture_file_writer {
+    capture_writer_t *writer;
+    proto_data_encoder_t enc;
+    uint8_t *msg;
+    capture_file_info_t info;
+    uint8_t header[CAPTURE_FILE_HEADER_BYTES];
+    uint64_t offset;            /* bytes handed to the writer so far */
+    uint64_t chunk_seq;         /* first frame of the open chunk */
+    uint64_t chunk_tstamp_ns;
+    uint64_t next_seq;          /* seq expected after the last appended frame */
+    bool have_seq;
+    uint8_t *index;
+    uint64_t index_cap;         /* entries */
+};
+
+struct capture_file {
+    int fd;
+    const uint8_t *map;
+    size_t size;
+    capture_file_info_t info;
+    const uint8_t *index;       /* CAPTURE_FILE_INDEX_ENTRY_BYTES per chunk (v2) */
+    uint8_t *rebuilt;           /* index built by walking the chunks */
+
+    /*
+     * Cursor: frame cur_pos of chunk cur_chunk. data describes that chunk
+     * once loaded; DELTA chunks are decoded whole into cache on first read.
+     */
+    uint64_t cur_chunk;
+    uint32_t cur_pos;
+    bool loaded;
+    bool cached;
+    proto_data_info_t data;
+    ads1278_frame_t *cache;
+};
+
+static uint64_t clock_ns(clockid_t clock)
+{
+    struct timespec ts = {0, 0};
+
+    (void)clock_gettime(clock, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+static void encode_acq(uint8_t *dst, const capture_file_acq_t *acq)
+{
+    proto_store_u32(dst, acq->backend);
+    proto_store_u32(dst + 4, acq->sample_rate_hz);
+    proto_store_u32(dst + 8, acq->sclk_hz);
+    proto_store_u32(dst + 12, acq->spi_mode);
+    proto_store_u32(dst + 16, acq->settle_frames);
+    proto_store_u32(dst + 20, acq->drdy_timeout_ms);
+    proto_store_u32(dst + 24, acq->drdy_line);
+    proto_store_u32(dst + 28, acq->sync_line);
+}
+
+static void decode_acq(const uint8_t *src, capture_file_acq_t *acq)
+{
+    acq->backend = proto_load_u32(src);
+    acq->sample_rate_hz = proto_load_u32(src + 4);
+    acq->sclk_hz = proto_load_u32(src + 8);
+    acq->spi_mode = proto_load_u32(src + 12);
+    acq->settle_frames = proto_load_u32(src + 16);
+    acq->drdy_timeout_ms = proto_load_u32(src + 20);
+    acq->drdy_line = proto_load_u32(src + 24);
+    acq->sync_line = proto_load_u32(src + 28);
+}
+
+static void copy_name(char *dst, const uint8_t *src)
+{
+    memcpy(dst, src, CAPTURE_FILE_NAME_BYTES);
+    dst[CAPTURE_FILE_NAME_BYTES - 1U] = '\0';
+}
+
+static void store_name(uint8_t *dst, const char *src)
+{
+    memset(dst, 0, CAPTURE_FILE_NAME_BYTES);
+    memcpy(dst, src, strnlen(src, CAPTURE_FILE_NAME_BYTES - 1U));
+}
+
+static void encode_header(uint8_t *dst, const capture_file_info_t *info, uint64_t index_offset)
+{
+    uint32_t channel;
+
+    memset(dst, 0, CAPTURE_FILE_HEADER_BYTES);
+    memcpy(dst, CAPTURE_FILE_MAGIC, 8U);
+    proto_store_u16(dst + HDR_VERSION, CAPTURE_FILE_VERSION);
+    proto_store_u16(dst + HDR_HEADER_BYTES, CAPTURE_FILE_HEADER_BYTES);
+    proto_store_u16(dst + HDR_CHANNEL_COUNT, info->channel_count);
+    proto_store_u16(dst + HDR_SAMPLE_BITS, info->sample_bits);
+    proto_store_u16(dst + HDR_ENCODING, info->encoding);
+    proto_store_u32(dst + HDR_CHUNK_FRAMES, info->chunk_frames);
+    for (channel = 0U; channel < ADS1278_CHANNEL_COUNT; ++channel) {
+        dst[HDR_CHANNEL_SLOT + channel] = info->channel_slot[channel];
+    }
+    proto_store_u64(dst + HDR_ANCHOR_MONO, info->anchor_monotonic_ns);
+    proto_store_u64(dst + HDR_ANCHOR_REAL, info->anchor_realtime_ns);
+    proto_store_u64(dst + HDR_INDEX_OFFSET, index_offset);
+    proto_store_u64(dst + HDR_CHUNK_COUNT, info->chunk_count);
+    proto_store_u64(dst + HDR_FRAME_COUNT, info->frame_count);
+    encode_acq(dst + HDR_ACQ, &info->acq);
+    store_name(dst + HDR_DRDY_CHIP, info->acq.drdy_chip);
+    store_name(dst + HDR_SYNC_CHIP, info->acq.sync_chip);
+    store_name(dst + HDR_WRITER, info->acq.writer);
+    proto_store_u32(dst + HDR_DECIMATION, info->acq.decimation);
+    proto_store_u64(dst + HDR_MISSED_FRAMES, info->missed_frames);
+    proto_store_u64(dst + HDR_GAP_COUNT, info->gap_count);
+}
+
+static void encode_index_entry(uint8_t *dst, const capture_file_chunk_t *chunk)
+{
+    proto_store_u64(dst, chunk->first_seq);
+    proto_store_u64(dst + 8, chunk->first_tstamp_ns);
+    proto_store_u64(dst + 16, chunk->offset);
+    proto_store_u64(dst + 24, chunk->first_frame);
+    proto_store_u32(dst + 32, chunk->frame_count);
+    proto_store_u32(dst + 36, chunk->bytes);
+}
+
+static void decode_index_entry(const uint8_t *src, capture_file_chunk_t *chunk)
+{
+    chunk->first_seq = proto_load_u64(src);
+    chunk->first_tstamp_ns = proto_load_u64(src + 8);
+    chunk->offset = proto_load_u64(src + 16);
+    chunk->first_frame = proto_load_u64(src + 24);
+    chunk->frame_count = proto_load_u32(src + 32);
+    chunk->bytes = proto_load_u32(src + 36);
+}
+
+/* ---- writer ---- */
+
+static void writer_release(capture_file_writer_t *cf)
+{
+    proto_data_encoder_destroy(&cf->enc);
+    free(cf->msg);
+    free(cf->index);
+    free(cf);
+}
+
+int capture_file_create(capture_file_writer_t **out, const char *path, const capture_file_cfg_t *cfg)
+{
+    capture_file_writer_t *cf;
+    uint64_t mono0;
+    uint64_t mono1;
+    uint32_t channel;
+
+    if (out == NULL || path == NULL || cfg == NULL) {
+        errno = EINVAL;
+        return -1;
+    }
+    *out = NULL;
+
+    cf = calloc(1U, sizeof(*cf));
+    if (cf == NULL) {
+        return -1;
+    }
+    cf->info.version = CAPTURE_FILE_VERSION;
+    cf->info.encoding = (cfg->encoding != 0U) ? cfg->encoding : PROTO_DATA_ENC_RECORD48;
+    cf->info.channel_count = (cfg->channel_count != 0U) ? cfg->channel_count : ADS1278_CHANNEL_COUNT;
+    cf->info.sample_bits = 24U;
+    cf->info.chunk_frames = (cfg->chunk_frames != 0U) ? cfg->chunk_frames : CAPTURE_FILE_DEFAULT_CHUNK_FRAMES;
+    for (channel = 0U; channel < ADS1278_CHANNEL_COUNT; ++channel) {
+        cf->info.channel_slot[channel] = (uint8_t)channel;
+    }
+    cf->info.acq = cfg->acq;
+    cf->info.acq.drdy_chip[CAPTURE_FILE_NAME_BYTES - 1U] = '\0';
+    cf->info.acq.sync_chip[CAPTURE_FILE_NAME_BYTES - 1U] = '\0';
+    cf->info.acq.writer[CAPTURE_FILE_NAME_BYTES - 1U] = '\0';
+
+    if (proto_data_encoder_init(&cf->enc, cf->info.encoding, cf->info.channel_count, cf->info.chunk_frames) != 0) {
+        free(cf);
+        return -1;
+    }
+    cf->enc.linear_ts = cfg->linear_ts;
+    cf->enc.linear_tolerance_ns = cfg->linear_tolerance_ns;
+    /* Missed conversions stay inside a chunk as its gap list (RECORD48 stores every seq). */
+    if (cf->info.encoding != PROTO_DATA_ENC_RECORD48) {
+        cf->enc.max_gaps = PROTO_DATA_MAX_GAPS;
+    }
+    cf->msg = malloc(proto_data_max_bytes(cf->info.encoding, cf->info.channel_count, cf->info.chunk_frames) +
+                     PROTO_DATA_GAPS_BYTES(cf->enc.max_gaps));
+    cf->index_cap = INDEX_INITIAL_ENTRIES;
+    cf->index = malloc(cf->index_cap * CAPTURE_FILE_INDEX_ENTRY_BYTES);
+    if (cf->msg == NULL || cf->index == NULL) {
+        writer_release(cf);
+        return -1;
+    }
+
+    /* Realtime bracketed by two monotonic reads; the midpoint is the anchor. */
+    mono0 = clock_ns(CLOCK_MONOTONIC);
+    cf->info.anchor_realtime_ns = clock_ns(CLOCK_REALTIME);
+    mono1 = clock_ns(CLOCK_MONOTONIC);
+    cf->info.anchor_monotonic_ns = mono0 + ((mono1 - mono0) / 2U);
+
+    if (capture_writer_open(&cf->writer, path, &cfg->writer) != 0) {
+        int saved_errno = errno;
+
+        writer_release(cf);
+        errno = saved_errno;
+        return -1;
+    }
+    encode_header(cf->header, &cf->info, 0U);
+    if (capture_writer_write(cf->writer, cf->header, sizeof(cf->header)) != 0) {
+        int saved_errno = errno;
+
+        (void)capture_writer_close(cf->writer, NULL);
+        writer_release(cf);
+        errno = saved_errno;
+        return -1;
+    }
+    cf->offset = CAPTURE_FILE_HEADER_BYTES;
+
+    *out = cf;
+    return 0;
+}
+
+static int flush_chunk(capture_file_writer_t *cf)
+{
+    capture_file_chunk_t chunk;
+    size_t len;
+
+    if (cf->enc.count == 0U) {
+        return 0;
+    }
+    if (cf->info.chunk_count == cf->index_cap) {
+        uint8_t *grown = realloc(cf->index, (size_t)cf->index_cap * 2U * CAPTURE_FILE_INDEX_ENTRY_BYTES);
+
+        if (grown == NULL) {
+            return -1;
+        }
+        cf->index = grown;
+        cf->index_cap *= 2U;
+    }
+
+    chunk.first_seq = cf->chunk_seq;
+    chunk.first_tstamp_ns = cf->chunk_tstamp_ns;
+    chunk.offset = cf->offset;
+    chunk.first_frame = cf->info.frame_count;
+    chunk.frame_count = cf->enc.count;
+    len = proto_data_finish(&cf->enc);
+    cf->enc.count = 0U;
+    chunk.bytes = (uint32_t)len;
+
+    encode_index_entry(cf->index + (cf->info.chunk_count * CAPTURE_FILE_INDEX_ENTRY_BYTES), &chunk);
+    ++cf->info.chunk_count;
+    cf->info.frame_count += chunk.frame_count;
+    cf->offset += len;
+    return capture_writer_write(cf->writer, cf->msg, len);
+}
+
+int capture_file_append(capture_file_writer_t *cf, const ads1278_frame_t *frames, size_t n)
+{
+    size_t pos = 0U;
+
+    if (cf == NULL || (frames == NULL && n != 0U)) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    /* Forward seq jumps are missed conversions (or dropped frames); a restart is not counted. */
+    for (pos = 0U; pos < n; ++pos) {
+        if (cf->have_seq && frames[pos].seq > cf->next_seq) {
+            cf->info.missed_frames += frames[pos].seq - cf->next_seq;
+            ++cf->info.gap_count;
+        }
+        cf->next_seq = frames[pos].seq + 1U;
+        cf->have_seq = true;
+    }
+
+    pos = 0U;
+    while (pos < n) {
+        size_t taken;
+
+        if (cf->enc.count == 0U) {
+            proto_data_begin(&cf->enc, cf->msg, (uint32_t)cf->info.chunk_count, &frames[pos]);
+            cf->chunk_seq = frames[pos].seq;
+            cf->chunk_tstamp_ns = frames[pos].tstamp_ns;
+        }
+        taken = proto_data_append(&cf->enc, &frames[pos], n - pos);
+        pos += taken;
+        /* A short append is a timestamp step, a seq step back or a gap past max_gaps. */
+        if ((pos < n || cf->enc.count == cf->info.chunk_frames) && flush_chunk(cf) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int capture_file_checkpoint(capture_file_writer_t *cf)
+{
+    if (cf == NULL) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (flush_chunk(cf) != 0) {
+        return -1;
+    }
+    return capture_writer_checkpoint(cf->writer);
+}
+
+uint64_t capture_file_bytes(const capture_file_writer_t *cf)
+{
+    return cf->offset;
+}
+
+int capture_file_finish(capture_file_writer_t *cf, capture_writer_stats_t *stats, capture_file_info_t *info)
+{
+    uint64_t index_offset;
+    int rc = 0;
+
+    if (cf == NULL) {
+        return 0;
+    }
+
+    if (flush_chunk(cf) != 0) {
+        rc = -1;
+    }
+    index_offset = cf->offset;
+    if (rc == 0 && cf->info.chunk_count != 0U &&
+        capture_writer_write(cf->writer, cf->index, cf->info.chunk_count * CAPTURE_FILE_INDEX_ENTRY_BYTES) != 0) {
+        rc = -1;
+    }
+    if (rc == 0) {
+        cf->info.indexed = true;
+        encode_header(cf->header, &cf->info, index_offset);
+        rc = capture_writer_rewrite_head(cf->writer, cf->header, sizeof(cf->header));
+    }
+    {
+        int saved_errno = errno;
+
+        if (capture_writer_close(cf->writer, stats) != 0) {
+            rc = -1;
+        } else if (rc != 0) {
+            errno = saved_errno;
+        }
+    }
+    if (info != NULL) {
+        *info = cf->info;
+    }
+    writer_release(cf);
+    return rc;
+}
+
+/* ---- reader ---- */
+
+static int parse_header(capture_file_t *cf, uint64_t *index_offset)
+{
+    const uint8_t *hdr = cf->map;
+    capture_file_info_t *info = &cf->info;
+    uint16_t channels = proto_load_u16(hdr + HDR_CHANNEL_COUNT);
+    uint32_t channel;
+
+    if (proto_load_u16(hdr + HDR_VERSION) != CAPTURE_FILE_VERSION ||
+        proto_load_u16(hdr + HDR_HEADER_BYTES) < CAPTURE_FILE_HEADER_BYTES ||
+        channels == 0U || channels > ADS1278_MAX_CHANNELS ||
+        proto_load_u32(hdr + HDR_CHUNK_FRAMES) == 0U) {
+        return -1;
+    }
+    info->version = CAPTURE_FILE_VERSION;
+    info->channel_count = channels;
+    info->sample_bits = proto_load_u16(hdr + HDR_SAMPLE_BITS);
+    info->encoding = proto_load_u16(hdr + HDR_ENCODING);
+    info->chunk_frames = proto_load_u32(hdr + HDR_CHUNK_FRAMES);
+    for (channel = 0U; channel < ADS1278_CHANNEL_COUNT; ++channel) {
+        info->channel_slot[channel] = hdr[HDR_CHANNEL_SLOT + channel];
+    }
+    info->anchor_monotonic_ns = proto_load_u64(hdr + HDR_ANCHOR_MONO);
+    info->anchor_realtime_ns = proto_load_u64(hdr + HDR_ANCHOR_REAL);
+    info->chunk_count = proto_load_u64(hdr + HDR_CHUNK_COUNT);
+    info->frame_count = proto_load_u64(hdr + HDR_FRAME_COUNT);
+    decode_acq(hdr + HDR_ACQ, &info->acq);
+    copy_name(info->acq.drdy_chip, hdr + HDR_DRDY_CHIP);
+    copy_name(info->acq.sync_chip, hdr + HDR_SYNC_CHIP);
+    copy_name(info->acq.writer, hdr + HDR_WRITER);
+    info->acq.decimation = proto_load_u32(hdr + HDR_DECIMATION);
+    info->missed_frames = proto_load_u64(hdr + HDR_MISSED_FRAMES);
+    info->gap_count = proto_load_u64(hdr + HDR_GAP_COUNT);
+    *index_offset = proto_load_u64(hdr + HDR_INDEX_OFFSET);
+    return 0;
+}
+
+/* Check a chunk's DATA message; its payload info is returned for decoding. */
+static int check_chunk(const capture_file_t *cf, uint64_t offset, proto_data_info_t *data,
+                       size_t *bytes)
+{
+    proto_header_t hdr;
+    size_t len;
+
+    if (offset > cf->size || cf->size - offset < PROTO_HEADER_BYTES) {
+        return -1;
+    }
+    if (proto_decode_header(cf->map + offset, &hdr) != 0 || hdr.type != PROTO_MSG_DATA) {
+        return -1;
+    }
+    len = PROTO_HEADER_BYTES + (size_t)hdr.payload_len;
+    if (cf->size - offset < len ||
+        proto_decode_data_info(cf->map + offset + PROTO_HEADER_BYTES, hdr.payload_len, data) != 0 ||
+        data->frame_count == 0U || data->frame_count > cf->info.chunk_frames ||
+        data->channel_count != cf->info.channel_count) {
+        return -1;
+    }
+    *bytes = len;
+    return 0;
+}
+
+/* Index a file the writer never finalized: walk the chunks up to the first bad one. */
+static int rebuild_index(capture_file_t *cf)
+{
+    uint64_t offset = CAPTURE_FILE_HEADER_BYTES;
+    uint64_t cap = INDEX_INITIAL_ENTRIES;
+    capture_file_chunk_t chunk;
+    proto_data_info_t data;
+    size_t bytes;
+
+    cf->rebuilt = malloc(cap * CAPTURE_FILE_INDEX_ENTRY_BYTES);
+    if (cf->rebuilt == NULL) {
+        return -1;
+    }
+    cf->info.chunk_count = 0U;
+    cf->info.frame_count = 0U;
+    while (check_chunk(cf, offset, &data, &bytes) == 0) {
+        ads1278_frame_t first;
+
+        if (cf->info.chunk_count == cap) {
+            uint8_t *grown = realloc(cf->rebuilt, (size_t)cap * 2U * CAPTURE_FILE_INDEX_ENTRY_BYTES);
+
+            if (grown == NULL) {
+                return -1;
+            }
+            cf->rebuilt = grown;
+            cap *= 2U;
+        }
+        proto_data_decode_frames(&data, 0U, 1U, &first);
+        chunk.first_seq = first.seq;
+        chunk.first_tstamp_ns = first.tstamp_ns;
+        chunk.offset = offset;
+        chunk.first_frame = cf->info.frame_count;
+        chunk.frame_count = data.frame_count;
+        chunk.bytes = (uint32_t)bytes;
+        encode_index_entry(cf->rebuilt + (cf->info.chunk_count * CAPTURE_FILE_INDEX_ENTRY_BYTES), &chunk);
+        ++cf->info.chunk_count;
+        cf->info.frame_count += data.frame_count;
+        offset += bytes;
+    }
+    cf->index = cf->rebuilt;
+    cf->info.indexed = false;
+    return 0;
+}
+
+static int open_v2(capture_file_t *cf)
+{
+    uint64_t index_offset;
+
+    if (cf->size < CAPTURE_FILE_HEADER_BYTES || parse_header(cf, &index_offset) != 0) {
+        return -1;
+    }
+    if (index_offset >= CAPTURE_FILE_HEADER_BYTES && index_offset <= cf->size &&
+        cf->info.chunk_count <= (cf->size - index_offset) / CAPTURE_FILE_INDEX_ENTRY_BYTES) {
+        cf->index = cf->map + index_offset;
+        cf->info.indexed = true;
+        return 0;
+    }
+    return rebuild_index(cf);
+}
+
+/* v1 has no header: records are grouped into virtual chunks for the cursor. */
+static void open_v1(capture_file_t *cf)
+{
+    cf->info.version = 1U;
+    cf->info.encoding = PROTO_DATA_ENC_RECORD48;
+    cf->info.channel_count = ADS1278_CHANNEL_COUNT;
+    cf->info.sample_bits = 24U;
+    cf->info.chunk_frames = CAPTURE_FILE_DEFAULT_CHUNK_FRAMES;
+    cf->info.frame_count = cf->size / PROTO_RECORD48_BYTES;
+    cf->info.chunk_count = (cf->info.frame_count + CAPTURE_FILE_DEFAULT_CHUNK_FRAMES - 1U) /
+                           CAPTURE_FILE_DEFAULT_CHUNK_FRAMES;
+    cf->info.indexed = true;
+}
+
+int capture_file_open(capture_file_t **out, const char *path)
+{
+    capture_file_t *cf;
+    struct stat st;
+    int saved_errno;
+
+    if (out == NULL || path == NULL) {
+        errno = EINVAL;
+        return -1;
+    }
+    *out = NULL;
+
+    cf = calloc(1U, sizeof(*cf));
+    if (cf == NULL) {
+        return -1;
+    }
+    cf->fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (cf->fd < 0) {
+        goto fail;
+    }
+    if (fstat(cf->fd, &st) != 0) {
+        goto fail;
+    }
+    cf->size = (size_t)st.st_size;
+    if (cf->size != 0U) {
+        void *map = mmap(NULL, cf->size, PROT_READ, MAP_SHARED, cf->fd, 0);
+
+        if (map == MAP_FAILED) {
+            goto fail;
+        }
+        cf->map = map;
+    }
+
+    if (cf->size >= 8U && memcmp(cf->map, CAPTURE_FILE_MAGIC, 8U) == 0) {
+        if (open_v2(cf) != 0) {
+            if (errno != ENOMEM) {
+                errno = EPROTO;
+            }
+            goto fail;
+        }
+    } else {
+        open_v1(cf);
+    }
+
+    if (cf->info.encoding == PROTO_DATA_ENC_DELTA) {
+        cf->cache = malloc((size_t)cf->info.chunk_frames * sizeof(*cf->cache));
+        if (cf->cache == NULL) {
+            goto fail;
+        }
+    }
+    *out = cf;
+    return 0;
+
+fail:
+    saved_errno = errno;
+    capture_file_close(cf);
+    errno = saved_errno;
+    return -1;
+}
+
+void capture_file_close(capture_file_t *cf)
+{
+    if (cf == NULL) {
+        return;
+    }
+    if (cf->map != NULL) {
+        (void)munmap((void *)cf->map, cf->size);
+    }
+    if (cf->fd >= 0) {
+        (void)close(cf->fd);
+    }
+    free(cf->rebuilt);
+    free(cf->cache);
+    free(cf);
+}
+
+const capture_file_info_t *capture_file_get_info(const capture_file_t *cf)
+{
+    return &cf->info;
+}
+
+static void chunk_at(const capture_file_t *cf, uint64_t idx, capture_file_chunk_t *out)
+{
+    if (cf->info.version == 1U) {
+        uint64_t first = idx * CAPTURE_FILE_DEFAULT_CHUNK_FRAMES;
+        uint64_t left = cf->info.frame_count - first;
+        const uint8_t *src = cf->map + (first * PROTO_RECORD48_BYTES);
+
+        out->first_seq = proto_load_u64(src);
+        out->first_tstamp_ns = proto_load_u64(src + 8);
+        out->offset = first * PROTO_RECORD48_BYTES;
+        out->first_frame = first;
+        out->frame_count = (uint32_t)((left < CAPTURE_FILE_DEFAULT_CHUNK_FRAMES) ? left
+                                                                                 : CAPTURE_FILE_DEFAULT_CHUNK_FRAMES);
+        out->bytes = out->frame_count * PROTO_RECORD48_BYTES;
+        return;
+    }
+    decode_index_entry(cf->index + (idx * CAPTURE_FILE_INDEX_ENTRY_BYTES), out);
+}
+
+int capture_file_get_chunk(const capture_file_t *cf, uint64_t idx, capture_file_chunk_t *out)
+{
+    if (cf == NULL || out == NULL || idx >= cf->info.chunk_count) {
+        errno = EINVAL;
+        return -1;
+    }
+    chunk_at(cf, idx, out);
+    return 0;
+}
+
+/* Locate chunk cur_chunk; v1 records are presented as a RECORD48 payload. */
+static int load_chunk(capture_file_t *cf)
+{
+    capture_file_chunk_t chunk;
+
+    if (cf->loaded) {
+        return 0;
+    }
+    chunk_at(cf, cf->cur_chunk, &chunk);
+    if (cf->info.version == 1U) {
+        memset(&cf->data, 0, sizeof(cf->data));
+        cf->data.first_seq = chunk.first_seq;
+        cf->data.frame_count = chunk.frame_count;
+        cf->data.encoding = PROTO_DATA_ENC_RECORD48;
+        cf->data.channel_count = ADS1278_CHANNEL_COUNT;
+        cf->data.frames = cf->map + chunk.offset;
+    } else {
+        size_t bytes;
+
+        if (check_chunk(cf, chunk.offset, &cf->data, &bytes) != 0 || cf->data.frame_count != chunk.frame_count) {
+            errno = EPROTO;
+            return -1;
+        }
+    }
+    cf->loaded = true;
+    cf->cached = false;
+    return 0;
+}
+
+static void set_cursor(capture_file_t *cf, uint64_t chunk, uint32_t pos)
+{
+    if (chunk != cf->cur_chunk) {
+        cf->cur_chunk = chunk;
+        cf->loaded = false;
+    }
+    cf->cur_pos = pos;
+}
+
+/* First frame of the loaded chunk with tstamp_ns >= target (frame_count if none). */
+static uint32_t chunk_find_time(const proto_data_info_t *data, uint64_t target)
+{
+    uint64_t tstamp_ns = data->base_tstamp_ns;
+    uint32_t idx;
+
+    if (data->encoding == PROTO_DATA_ENC_RECORD48) {
+        uint32_t lo = 0U;
+        uint32_t hi = data->frame_count;
+
+        while (lo < hi) {
+            uint32_t mid = lo + ((hi - lo) / 2U);
+
+            if (proto_load_u64(data->frames + ((size_t)mid * PROTO_RECORD48_BYTES) + 8U) < target) {
+                lo = mid + 1U;
+            } else {
+                hi = mid;
+            }
+        }
+        return lo;
+    }
+
+    if (data->linear_ts) {
+        uint32_t lo = 0U;
+        uint32_t hi = data->frame_count;
+
+        while (lo < hi) {
+            uint32_t mid = lo + ((hi - lo) / 2U);
+
+            if (proto_data_linear_tstamp(data, mid) < target) {
+                lo = mid + 1U;
+            } else {
+                hi = mid;
+            }
+        }
+        return lo;
+    }
+
+    /* P24/DELTA carry timestamps as deltas: only the timestamp column is walked. */
+    if (data->encoding == PROTO_DATA_ENC_P24) {
+        for (idx = 0U; idx < data->frame_count; ++idx) {
+            tstamp_ns += proto_load_u32(data->ts_deltas + (idx * 4U));
+            if (tstamp_ns >= target) {
+                break;
+            }
+        }
+        return idx;
+    }
+    {
+        sample_codec_reader_t rd;
+        int32_t deltas[SAMPLE_CODEC_GROUP];
+
+        sample_codec_reader_init(&rd, data->streams[data->channel_count], data->frame_count);
+        for (idx = 0U; idx < data->frame_count; idx += SAMPLE_CODEC_GROUP) {
+            uint32_t n = data->frame_count - idx;
+            uint32_t pos;
+
+            if (n > SAMPLE_CODEC_GROUP) {
+                n = SAMPLE_CODEC_GROUP;
+            }
+            sample_codec_read(&rd, n, deltas, 1U);
+            for (pos = 0U; pos < n; ++pos) {
+                tstamp_ns += (uint32_t)deltas[pos];
+                if (tstamp_ns >= target) {
+                    return idx + pos;
+                }
+            }
+        }
+        return data->frame_count;
+    }
+}
+
+int capture_file_seek_frame(capture_file_t *cf, uint64_t frame)
+{
+    capture_file_chunk_t chunk;
+    uint64_t lo = 0U;
+    uint64_t hi;
+
+    if (cf == NULL) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (frame >= cf->info.frame_count) {
+        set_cursor(cf, cf->info.chunk_count, 0U);
+        return 0;
+    }
+
+    /* Last chunk whose first_frame <= frame. */
+    hi = cf->info.chunk_count;
+    while (hi - lo > 1U) {
+        uint64_t mid = lo + ((hi - lo) / 2U);
+
+        chunk_at(cf, mid, &chunk);
+        if (chunk.first_frame <= frame) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+    chunk_at(cf, lo, &chunk);
+    set_cursor(cf, lo, (uint32_t)(frame - chunk.first_frame));
+    return 0;
+}
+
+int capture_file_seek_time(capture_file_t *cf, uint64_t tstamp_ns)
+{
+    capture_file_chunk_t chunk;
+    uint64_t lo = 0U;
+    uint64_t hi;
+    uint32_t pos;
+
+    if (cf == NULL) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (cf->info.chunk_count == 0U) {
+        set_cursor(cf, 0U, 0U);
+        return 0;
+    }
+
+    /* Last chunk starting at or before tstamp_ns; the target is in it or starts the next. */
+    hi = cf->info.chunk_count;
+    while (hi - lo > 1U) {
+        uint64_t mid = lo + ((hi - lo) / 2U);
+
+        chunk_at(cf, mid, &chunk);
+        if (chunk.first_tstamp_ns <= tstamp_ns) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+    set_cursor(cf, lo, 0U);
+    if (load_chunk(cf) != 0) {
+        return -1;
+    }
+    pos = chunk_find_time(&cf->data, tstamp_ns);
+    if (pos == cf->data.frame_count) {
+        set_cursor(cf, lo + 1U, 0U);
+    } else {
+        cf->cur_pos = pos;
+    }
+    return 0;
+}
+
+uint64_t capture_file_tell(const capture_file_t *cf)
+{
+    capture_file_chunk_t chunk;
+
+    if (cf->cur_chunk >= cf->info.chunk_count) {
+        return cf->info.frame_count;
+    }
+    chunk_at(cf, cf->cur_chunk, &chunk);
+    return chunk.first_frame + cf->cur_pos;
+}
+
+long capture_file_read(capture_file_t *cf, ads1278_frame_t *out, size_t n)
+{
+    size_t done = 0U;
+
+    if (cf == NULL || (out == NULL && n != 0U)) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    while (done < n && cf->cur_chunk < cf->info.chunk_count) {
+        uint32_t take;
+
+        if (load_chunk(cf) != 0) {
+            return (done != 0U) ? (long)done : -1;
+        }
+        take = cf->data.frame_count - cf->cur_pos;
+        if (take > n - done) {
+            take = (uint32_t)(n - done);
+        }
+        if (cf->data.encoding == PROTO_DATA_ENC_DELTA) {
+            /* Codec streams only decode front to back: expand the chunk once. */
+            if (!cf->cached) {
+                proto_data_decode_frames(&cf->data, 0U, cf->data.frame_count, cf->cache);
+                cf->cached = true;
+            }
+            memcpy(&out[done], &cf->cache[cf->cur_pos], take * sizeof(*out));
+        } else {
+            proto_data_decode_frames(&cf->data, cf->cur_pos, take, &out[done]);
+        }
+        done += take;
+        cf->cur_pos += take;
+        if (cf->cur_pos == cf->data.frame_count) {
+            set_cursor(cf, cf->cur_chunk + 1U, 0U);
+        }
+    }
+    return (long)done;
+}
+
+uint64_t capture_file_wall_ns(const capture_file_t *cf, uint64_t tstamp_ns)
+{
+    int64_t offset;
+
+    if (cf->info.anchor_realtime_ns == 0U) {
+        return 0U;
+    }
+    offset = (int64_t)(tstamp_ns - cf->info.anchor_monotonic_ns);
+    return (uint64_t)((int64_t)cf->info.anchor_realtime_ns + offset);
+}
+
+/* ---- repair ---- */
+
+static int write_at(int fd, const uint8_t *data, size_t len, uint64_t offset)
+{
+    while (len != 0U) {
+        ssize_t n = pwrite(fd, data, len, (off_t)offset);
+
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        data += n;
+        len -= (size_t)n;
+        offset += (uint64_t)n;
+    }
+    return 0;
+}
+
+int capture_file_repair(const char *path, capture_file_info_t *info)
+{
+    capture_file_t *cf = NULL;
+    ads1278_frame_t *frames = NULL;
+    uint8_t header[CAPTURE_FILE_HEADER_BYTES];
+    uint64_t index_offset = CAPTURE_FILE_HEADER_BYTES;
+    uint64_t next_seq = 0U;
+    bool have_seq = false;
+    long got;
+    int fd = -1;
+    int rc = -1;
+
+    if (path == NULL || info == NULL) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (capture_file_open(&cf, path) != 0) {
+        return -1;
+    }
+    if (cf->info.version != CAPTURE_FILE_VERSION || cf->info.indexed) {
+        *info = cf->info;
+        capture_file_close(cf);
+        return 0;
+    }
+    if (cf->info.chunk_count != 0U) {
+        capture_file_chunk_t last;
+
+        chunk_at(cf, cf->info.chunk_count - 1U, &last);
+        index_offset = last.offset + last.bytes;
+    }
+
+    /* The header's gap counts are only written at close: count them as the writer does. */
+    frames = malloc((size_t)cf->info.chunk_frames * sizeof(*frames));
+    if (frames == NULL) {
+        goto out;
+    }
+    cf->info.missed_frames = 0U;
+    cf->info.gap_count = 0U;
+    while ((got = capture_file_read(cf, frames, cf->info.chunk_frames)) > 0) {
+        long pos;
+
+        for (pos = 0; pos < got; ++pos) {
+            if (have_seq && frames[pos].seq > next_seq) {
+                cf->info.missed_frames += frames[pos].seq - next_seq;
+                ++cf->info.gap_count;
+            }
+            next_seq = frames[pos].seq + 1U;
+            have_seq = true;
+        }
+    }
+    if (got < 0) {
+        errno = EPROTO;
+        goto out;
+    }
+
+    /*
+     * A torn chunk and any preallocated tail make way for the index, which is
+     * durable before the header points at it. The map is not read past here.
+     */
+    fd = open(path, O_WRONLY | O_CLOEXEC);
+    if (fd < 0 || ftruncate(fd, (off_t)index_offset) != 0 ||
+        write_at(fd, cf->index, (size_t)cf->info.chunk_count * CAPTURE_FILE_INDEX_ENTRY_BYTES, index_offset) != 0 ||
+        fdatasync(fd) != 0) {
+        goto out;
+    }
+    cf->info.indexed = true;
+    encode_header(header, &cf->info, index_offset);
+    if (write_at(fd, header, sizeof(header), 0U) != 0 || fdatasync(fd) != 0) {
+        goto out;
+    }
+    *info = cf->info;
+    rc = 0;
+
+out:
+    {
+        int saved_errno = errno;
+
+        if (fd >= 0) {
+            (void)close(fd);
+        }
+        free(frames);
+        capture_file_close(cf);
+        errno = saved_errno;
+    }
+    return rc;
+}
@@ -0,0 +1,677 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Miguel Dovale (University of Arizona)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "capture_segments.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <time.h>
+#include <unistd.h>
+
+typedef struct {
+    uint32_t index;
+    uint64_t bytes;
+} seg_entry_t;
+
+struct capture_seg {
+    capture_seg_cfg_t cfg;
+    char *dir;
+    char *prefix;
+    int dir_fd;
+
+    /* Producer-owned. */
+    capture_file_writer_t *cur;
+    uint32_t cur_index;
+    uint64_t cur_frames;
+    uint64_t cur_first_tstamp_ns;
+    uint64_t last_checkpoint_ns;
+    uint64_t next_seq;
+    bool have_seq;
+
+    pthread_mutex_t lock;
+    pthread_cond_t cond;        /* any change below */
+    capture_file_writer_t *next; /* prepared by the thread */
+    uint32_t next_index;
+    capture_file_writer_t *retiring; /* handed to the thread to finish */
+    uint32_t retiring_index;
+    uint32_t alloc_index;       /* index of the next segment to prepare */
+    bool stopping;
+
+    pthread_t thread;
+    bool thread_started;
+    atomic_int error;
+
+    /* Thread-owned until joined: finished segments on disk, oldest first. */
+    seg_entry_t *kept;
+    size_t kept_count;
+    size_t kept_cap;
+    uint64_t kept_bytes;
+    uint64_t last_bytes;
+
+    uint64_t open_ns;
+    capture_seg_stats_t stats;  /* frame, append and rotate fields producer-owned, the rest thread-owned */
+};
+
+static uint64_t monotonic_ns(void)
+{
+    struct timespec ts = {0, 0};
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+static void set_error(capture_seg_t *seg, int error)
+{
+    int expected = 0;
+
+    (void)atomic_compare_exchange_strong(&seg->error, &expected, (error != 0) ? error : EIO);
+}
+
+static void update_max(uint64_t *max, uint64_t value)
+{
+    if (value > *max) {
+        *max = value;
+    }
+}
+
+static int seg_path(const capture_seg_t *seg, uint32_t index, bool part, char *buf, size_t len)
+{
+    int n = snprintf(buf, len, "%s/%s-%06u%s%s", seg->dir, seg->prefix, (unsigned)index, CAPTURE_SEG_SUFFIX,
+        part ? CAPTURE_SEG_PART_SUFFIX : "");
+
+    if (n < 0 || (size_t)n >= len) {
+        errno = ENAMETOOLONG;
+        return -1;
+    }
+    return 0;
+}
+
+/* "<prefix>-<digits>.bin" or the same with ".part"; anything else is not ours. */
+static bool parse_seg_name(const capture_seg_t *seg, const char *name, uint32_t *index, bool *part)
+{
+    size_t plen = strlen(seg->prefix);
+    unsigned long value = 0UL;
+    const char *p;
+
+    if (strncmp(name, seg->prefix, plen) != 0 || name[plen] != '-') {
+        return false;
+    }
+    p = name + plen + 1U;
+    if (*p < '0' || *p > '9') {
+        return false;
+    }
+    while (*p >= '0' && *p <= '9') {
+        value = (value * 10UL) + (unsigned long)(*p - '0');
+        if (value > UINT32_MAX - 1UL) {
+            return false;
+        }
+        ++p;
+    }
+    if (strcmp(p, CAPTURE_SEG_SUFFIX) == 0) {
+        *part = false;
+    } else if (strcmp(p, CAPTURE_SEG_SUFFIX CAPTURE_SEG_PART_SUFFIX) == 0) {
+        *part = true;
+    } else {
+        return false;
+    }
+    *index = (uint32_t)value;
+    return true;
+}
+
+static int kept_push(capture_seg_t *seg, uint32_t index, uint64_t bytes)
+{
+    if (seg->kept_count == seg->kept_cap) {
+        size_t cap = (seg->kept_cap != 0U) ? seg->kept_cap * 2U : 64U;
+        seg_entry_t *grown = realloc(seg->kept, cap * sizeof(*grown));
+
+        if (grown == NULL) {
+            return -1;
+        }
+        seg->kept = grown;
+        seg->kept_cap = cap;
+    }
+    seg->kept[seg->kept_count].index = index;
+    seg->kept[seg->kept_count].bytes = bytes;
+    ++seg->kept_count;
+    seg->kept_bytes += bytes;
+    return 0;
+}
+
+static int cmp_entry(const void *lhs, const void *rhs)
+{
+    const seg_entry_t *a = lhs;
+    const seg_entry_t *b = rhs;
+
+    return (a->index > b->index) - (a->index < b->index);
+}
+
+/*
+ * Delete the oldest segments until the rest leave room for the open and the
+ * prepared one. The newest finished segment is always kept.
+ */
+static void enforce_quota(capture_seg_t *seg)
+{
+    uint64_t reserve = (seg->cfg.segment_bytes > seg->last_bytes) ? seg->cfg.segment_bytes : seg->last_bytes;
+    char path[PATH_MAX];
+
+    if (seg->cfg.quota_bytes == 0U) {
+        return;
+    }
+    reserve *= 2U;
+    while (seg->kept_count > 1U && seg->kept_bytes + reserve > seg->cfg.quota_bytes) {
+        const seg_entry_t *oldest = &seg->kept[0];
+
+        if (seg_path(seg, oldest->index, false, path, sizeof(path)) != 0 ||
+            (unlink(path) != 0 && errno != ENOENT)) {
+            set_error(seg, errno);
+            return;
+        }
+        ++seg->stats.deleted;
+        seg->stats.deleted_bytes += oldest->bytes;
+        seg->kept_bytes -= oldest->bytes;
+        --seg->kept_count;
+        memmove(&seg->kept[0], &seg->kept[1], seg->kept_count * sizeof(seg->kept[0]));
+    }
+}
+
+/*
+ * A .part from a run that died: keep it if it holds a v2 header and at least
+ * one whole chunk, finalized as retire_segment() would have (cut after the
+ * last chunk, index, header); otherwise remove it.
+ */
+static int recover_part(capture_seg_t *seg, uint32_t index)
+{
+    char part[PATH_MAX];
+    char path[PATH_MAX];
+    char magic[sizeof(CAPTURE_FILE_MAGIC) - 1U];
+    capture_file_info_t info;
+    struct stat st;
+    ssize_t got;
+    int fd;
+
+    if (seg_path(seg, index, true, part, sizeof(part)) != 0 || seg_path(seg, index, false, path, sizeof(path)) != 0) {
+        return -1;
+    }
+    fd = open(part, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return -1;
+    }
+    /* The reader would take a file without the magic (zeroed preallocation) as v1 records. */
+    got = pread(fd, magic, sizeof(magic), 0);
+    (void)close(fd);
+    if (got != (ssize_t)sizeof(magic) || memcmp(magic, CAPTURE_FILE_MAGIC, sizeof(magic)) != 0) {
+        return unlink(part);
+    }
+    /* EPROTO is a header the reader rejects; other errors leave the file for the next run. */
+    if (capture_file_repair(part, &info) != 0) {
+        return (errno == EPROTO) ? unlink(part) : -1;
+    }
+    if (info.frame_count == 0U) {
+        return unlink(part);
+    }
+    if (stat(part, &st) != 0 || rename(part, path) != 0 || kept_push(seg, index, (uint64_t)st.st_size) != 0) {
+        return -1;
+    }
+    ++seg->stats.recovered;
+    return 0;
+}
+
+/* Collect our finished segments for the quota and recover .part leftovers. */
+static int scan_dir(capture_seg_t *seg)
+{
+    uint32_t *parts = NULL;
+    size_t part_count = 0U;
+    size_t part_cap = 0U;
+    struct dirent *ent;
+    DIR *dir;
+    size_t idx;
+    int rc = -1;
+
+    dir = opendir(seg->dir);
+    if (dir == NULL) {
+        return -1;
+    }
+    while ((ent = readdir(dir)) != NULL) {
+        char path[PATH_MAX];
+        struct stat st;
+        uint32_t index;
+        bool part;
+
+        if (!parse_seg_name(seg, ent->d_name, &index, &part)) {
+            continue;
+        }
+        if (index >= seg->alloc_index) {
+            seg->alloc_index = index + 1U;
+        }
+        /* Recovered (renamed) only after closedir(), so readdir() never sees a segment twice. */
+        if (part) {
+            if (part_count == part_cap) {
+                size_t cap = (part_cap != 0U) ? part_cap * 2U : 8U;
+                uint32_t *grown = realloc(parts, cap * sizeof(*grown));
+
+                if (grown == NULL) {
+                    goto out;
+                }
+                parts = grown;
+                part_cap = cap;
+            }
+            parts[part_count++] = index;
+            continue;
+        }
+        if (seg_path(seg, index, false, path, sizeof(path)) != 0 || stat(path, &st) != 0 ||
+            kept_push(seg, index, (uint64_t)st.st_size) != 0) {
+            goto out;
+        }
+    }
+    (void)closedir(dir);
+    dir = NULL;
+    for (idx = 0U; idx < part_count; ++idx) {
+        if (recover_part(seg, parts[idx]) != 0) {
+            goto out;
+        }
+    }
+    if (part_count != 0U && fsync(seg->dir_fd) != 0) {
+        goto out;
+    }
+    /* kept is still NULL in an empty directory, which qsort() must not see. */
+    if (seg->kept_count > 1U) {
+        qsort(seg->kept, seg->kept_count, sizeof(seg->kept[0]), cmp_entry);
+    }
+    rc = 0;
+
+out:
+    {
+        int saved_errno = errno;
+
+        if (dir != NULL) {
+            (void)closedir(dir);
+        }
+        free(parts);
+        errno = saved_errno;
+    }
+    return rc;
+}
+
+static capture_file_writer_t *create_segment(capture_seg_t *seg, uint32_t index)
+{
+    capture_file_writer_t *cf = NULL;
+    char part[PATH_MAX];
+
+    if (seg_path(seg, index, true, part, sizeof(part)) != 0 || capture_file_create(&cf, part, &seg->cfg.file) != 0) {
+        set_error(seg, errno);
+        return NULL;
+    }
+    return cf;
+}
+
+/* Finish, fsync and rename; a segment without frames is removed instead. */
+static void retire_segment(capture_seg_t *seg, capture_file_writer_t *cf, uint32_t index)
+{
+    capture_writer_stats_t ws = {0};
+    capture_file_info_t info = {0};
+    char part[PATH_MAX];
+    char path[PATH_MAX];
+    uint64_t t0 = monotonic_ns();
+
+    if (capture_file_finish(cf, &ws, &info) != 0) {
+        set_error(seg, errno);
+        return;
+    }
+    if (seg_path(seg, index, true, part, sizeof(part)) != 0 || seg_path(seg, index, false, path, sizeof(path)) != 0) {
+        set_error(seg, errno);
+        return;
+    }
+    if (info.frame_count == 0U) {
+        if (unlink(part) != 0) {
+            set_error(seg, errno);
+        }
+        return;
+    }
+    if (rename(part, path) != 0 || fsync(seg->dir_fd) != 0 || kept_push(seg, index, ws.bytes_written) != 0) {
+        set_error(seg, errno);
+        return;
+    }
+
+    ++seg->stats.segments;
+    seg->stats.bytes_written += ws.bytes_written;
+    seg->stats.checkpoints += ws.checkpoints;
+    seg->stats.producer_stalls += ws.producer_stalls;
+    update_max(&seg->stats.write_ns_max, ws.write_ns_max);
+    update_max(&seg->stats.fsync_ns_max, ws.fsync_ns_max);
+    update_max(&seg->stats.finish_ns_max, monotonic_ns() - t0);
+    seg->last_bytes = ws.bytes_written;
+    enforce_quota(seg);
+}
+
+static void *seg_thread_main(void *arg)
+{
+    capture_seg_t *seg = arg;
+
+    pthread_mutex_lock(&seg->lock);
+    for (;;) {
+        if (seg->retiring != NULL) {
+            capture_file_writer_t *cf = seg->retiring;
+            uint32_t index = seg->retiring_index;
+
+            pthread_mutex_unlock(&seg->lock);
+            retire_segment(seg, cf, index);
+            pthread_mutex_lock(&seg->lock);
+            seg->retiring = NULL;
+            pthread_cond_broadcast(&seg->cond);
+            continue;
+        }
+        /* Finish first, then prepare: at most two writers hold blocks at once. */
+        if (seg->next == NULL && !seg->stopping && atomic_load(&seg->error) == 0) {
+            uint32_t index = seg->alloc_index++;
+            capture_file_writer_t *cf;
+
+            pthread_mutex_unlock(&seg->lock);
+            cf = create_segment(seg, index);
+            pthread_mutex_lock(&seg->lock);
+            seg->next = cf;
+            seg->next_index = index;
+            pthread_cond_broadcast(&seg->cond);
+            continue;
+        }
+        if (seg->stopping) {
+            break;
+        }
+        pthread_cond_wait(&seg->cond, &seg->lock);
+    }
+    pthread_mutex_unlock(&seg->lock);
+    return NULL;
+}
+
+/* Hand the open segment to the thread and switch to the prepared one. */
+static int rotate(capture_seg_t *seg, bool take_next)
+{
+    bool rotating = (seg->cur != NULL);
+    uint64_t t0 = 0U;
+    int rc = 0;
+
+    pthread_mutex_lock(&seg->lock);
+    while (seg->retiring != NULL || (take_next && seg->next == NULL && atomic_load(&seg->error) == 0)) {
+        if (t0 == 0U) {
+            t0 = monotonic_ns();
+        }
+        pthread_cond_wait(&seg->cond, &seg->lock);
+    }
+    if (seg->cur != NULL) {
+        seg->retiring = seg->cur;
+        seg->retiring_index = seg->cur_index;
+        seg->cur = NULL;
+    }
+    if (take_next) {
+        if (seg->next != NULL) {
+            seg->cur = seg->next;
+            seg->cur_index = seg->next_index;
+            seg->next = NULL;
+        } else {
+            errno = atomic_load(&seg->error);
+            rc = -1;
+        }
+    }
+    pthread_cond_broadcast(&seg->cond);
+    pthread_mutex_unlock(&seg->lock);
+
+    seg->cur_frames = 0U;
+    /* The first segment at open is not a rotation. */
+    if (t0 != 0U && rotating) {
+        ++seg->stats.rotate_waits;
+        update_max(&seg->stats.rotate_wait_ns_max, monotonic_ns() - t0);
+    }
+    return rc;
+}
+
+static void stop_thread(capture_seg_t *seg)
+{
+    if (!seg->thread_started) {
+        return;
+    }
+    pthread_mutex_lock(&seg->lock);
+    seg->stopping = true;
+    pthread_cond_broadcast(&seg->cond);
+    pthread_mutex_unlock(&seg->lock);
+    pthread_join(seg->thread, NULL);
+    seg->thread_started = false;
+
+    /* The prepared segment never got a frame. */
+    if (seg->next != NULL) {
+        retire_segment(seg, seg->next, seg->next_index);
+        seg->next = NULL;
+    }
+}
+
+static void seg_free(capture_seg_t *seg)
+{
+    if (seg->dir_fd >= 0) {
+        (void)close(seg->dir_fd);
+    }
+    pthread_cond_destroy(&seg->cond);
+    pthread_mutex_destroy(&seg->lock);
+    free(seg->kept);
+    free(seg->prefix);
+    free(seg->dir);
+    free(seg);
+}
+
+int capture_seg_open(capture_seg_t **out, const capture_seg_cfg_t *cfg)
+{
+    capture_seg_t *seg;
+    int rc;
+
+    if (out == NULL || cfg == NULL || cfg->dir == NULL || cfg->dir[0] == '\0' ||
+        (cfg->prefix != NULL && (cfg->prefix[0] == '\0' || strchr(cfg->prefix, '/') != NULL)) ||
+        (cfg->quota_bytes != 0U && cfg->segment_bytes > cfg->quota_bytes / 3U)) {
+        errno = EINVAL;
+        return -1;
+    }
+    *out = NULL;
+
+    seg = calloc(1U, sizeof(*seg));
+    if (seg == NULL) {
+        return -1;
+    }
+    seg->dir_fd = -1;
+    seg->cfg = *cfg;
+    if (seg->cfg.checkpoint_ms == 0U) {
+        seg->cfg.checkpoint_ms = CAPTURE_SEG_DEFAULT_CHECKPOINT_MS;
+    }
+    if (seg->cfg.file.writer.prealloc_bytes == 0U) {
+        seg->cfg.file.writer.prealloc_bytes = seg->cfg.segment_bytes;
+    }
+    /* A segment is renamed only once its data is on disk. */
+    if (seg->cfg.file.writer.fsync_policy == CAPTURE_FSYNC_NONE) {
+        seg->cfg.file.writer.fsync_policy = CAPTURE_FSYNC_CLOSE;
+    }
+    pthread_mutex_init(&seg->lock, NULL);
+    pthread_cond_init(&seg->cond, NULL);
+    atomic_init(&seg->error, 0);
+    seg->dir = strdup(cfg->dir);
+    seg->prefix = strdup((cfg->prefix != NULL) ? cfg->prefix : CAPTURE_SEG_DEFAULT_PREFIX);
+    if (seg->dir == NULL || seg->prefix == NULL) {
+        goto fail;
+    }
+    seg->cfg.dir = seg->dir;
+    seg->cfg.prefix = seg->prefix;
+
+    if (mkdir(seg->dir, 0755) != 0 && errno != EEXIST) {
+        goto fail;
+    }
+    seg->dir_fd = open(seg->dir, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (seg->dir_fd < 0 || scan_dir(seg) != 0) {
+        goto fail;
+    }
+    if (seg->kept_count != 0U) {
+        seg->last_bytes = seg->kept[seg->kept_count - 1U].bytes;
+        enforce_quota(seg);
+        if (atomic_load(&seg->error) != 0) {
+            errno = atomic_load(&seg->error);
+            goto fail;
+        }
+    }
+
+    seg->open_ns = monotonic_ns();
+    rc = pthread_create(&seg->thread, NULL, seg_thread_main, seg);
+    if (rc != 0) {
+        errno = rc;
+        goto fail;
+    }
+    seg->thread_started = true;
+    if (rotate(seg, true) != 0) {
+        goto fail;
+    }
+    seg->last_checkpoint_ns = monotonic_ns();
+
+    *out = seg;
+    return 0;
+
+fail:
+    {
+        int saved_errno = errno;
+
+        stop_thread(seg);
+        seg_free(seg);
+        errno = saved_errno;
+    }
+    return -1;
+}
+
+/* Frames that still belong to a segment whose frames start at first_ns. */
+static size_t frames_within(const ads1278_frame_t *frames, size_t n, uint64_t first_ns, uint64_t span_ns)
+{
+    size_t idx = 0U;
+
+    while (idx < n && (frames[idx].tstamp_ns < first_ns || frames[idx].tstamp_ns - first_ns < span_ns)) {
+        ++idx;
+    }
+    return idx;
+}
+
+int capture_seg_append(capture_seg_t *seg, const ads1278_frame_t *frames, size_t n)
+{
+    uint64_t t0 = monotonic_ns();
+    uint64_t span_ns;
+    size_t idx;
+    int error;
+
+    if (seg == NULL || (frames == NULL && n != 0U)) {
+        errno = EINVAL;
+        return -1;
+    }
+    error = atomic_load_explicit(&seg->error, memory_order_relaxed);
+    if (error != 0) {
+        errno = error;
+        return -1;
+    }
+
+    for (idx = 0U; idx < n; ++idx) {
+        if (seg->have_seq && frames[idx].seq > seg->next_seq) {
+            seg->stats.missed_frames += frames[idx].seq - seg->next_seq;
+            ++seg->stats.gap_count;
+        }
+        seg->next_seq = frames[idx].seq + 1U;
+        seg->have_seq = true;
+    }
+    seg->stats.frames += n;
+
+    span_ns = (uint64_t)seg->cfg.segment_ms * 1000000ULL;
+    while (n != 0U) {
+        size_t take = n;
+
+        if (seg->cur_frames == 0U) {
+            seg->cur_first_tstamp_ns = frames[0].tstamp_ns;
+        }
+        if (span_ns != 0U) {
+            take = frames_within(frames, n, seg->cur_first_tstamp_ns, span_ns);
+        }
+        if (take != 0U) {
+            if (capture_file_append(seg->cur, frames, take) != 0) {
+                return -1;
+            }
+            seg->cur_frames += take;
+            frames += take;
+            n -= take;
+        }
+        /* Leftover frames mean the time limit was reached. */
+        if ((n != 0U || (seg->cfg.segment_bytes != 0U && capture_file_bytes(seg->cur) >= seg->cfg.segment_bytes)) &&
+            rotate(seg, true) != 0) {
+            return -1;
+        }
+    }
+
+    if (t0 - seg->last_checkpoint_ns >= (uint64_t)seg->cfg.checkpoint_ms * 1000000ULL) {
+        if (capture_file_checkpoint(seg->cur) != 0) {
+            return -1;
+        }
+        seg->last_checkpoint_ns = t0;
+    }
+    update_max(&seg->stats.append_ns_max, monotonic_ns() - t0);
+    return 0;
+}
+
+int capture_seg_close(capture_seg_t *seg, capture_seg_stats_t *stats)
+{
+    int error;
+
+    if (seg == NULL) {
+        return 0;
+    }
+
+    (void)rotate(seg, false);
+    stop_thread(seg);
+
+    seg->stats.elapsed_ns = monotonic_ns() - seg->open_ns;
+    seg->stats.kept_segments = seg->kept_count;
+    seg->stats.kept_bytes = seg->kept_bytes;
+    if (stats != NULL) {
+        *stats = seg->stats;
+    }
+    error = atomic_load(&seg->error);
+    seg_free(seg);
+
+    if (error != 0) {
+        errno = error;
+        return -1;
+    }
+    return 0;
+}
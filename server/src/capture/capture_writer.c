@@ -0,0 +1,696 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Miguel Dovale (University of Arizona)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "capture_writer.h"
+#include "uring.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <time.h>
+#include <unistd.h>
+
+#define CAPTURE_BLOCK_ALIGN_BYTES 4096U
+
+/* A frame starts with a v1 record; with ADS1278_MAX_CHAIN 1 it is exactly one. */
+_Static_assert(offsetof(ads1278_frame_t, ch) == 16U && sizeof(ads1278_frame_t) >= CAPTURE_RECORD_V1_BYTES,
+    "ads1278_frame_t must start with the 48-byte v1 record layout");
+
+struct capture_writer {
+    capture_writer_cfg_t cfg;
+    int fd;
+    uint8_t *storage;
+    size_t *fill;               /* bytes used per block */
+    bool *sync;                 /* fdatasync() once the block is written (checkpoint) */
+
+    /* Producer-owned. */
+    uint32_t cur;
+    size_t cur_fill;
+
+    pthread_mutex_t lock;
+    pthread_cond_t work_cond;   /* full block queued or closing */
+    pthread_cond_t free_cond;   /* block returned to the free stack */
+    uint32_t *full_queue;       /* FIFO of block indices, block_count slots */
+    uint32_t full_head;
+    uint32_t full_count;
+    uint32_t *free_stack;
+    uint32_t free_count;
+    bool closing;
+
+    pthread_t thread;
+    bool thread_started;
+    atomic_int error;
+
+    /* Writer-thread-owned until joined. */
+    uint64_t offset;
+    uint64_t last_fsync_ns;
+
+    uring_t *uring;             /* NULL = pwrite() */
+    uint32_t *batch;            /* io_uring: blocks taken together, their offsets and completions */
+    uint64_t *batch_off;
+    uring_cqe_t *cqes;
+
+    uint8_t *head;              /* rewritten at offset 0 on close */
+    size_t head_len;
+
+    uint64_t open_ns;
+    capture_writer_stats_t stats;
+};
+
+static uint64_t monotonic_ns(void)
+{
+    struct timespec ts = {0, 0};
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+static uint8_t *block_ptr(const capture_writer_t *writer, uint32_t idx)
+{
+    return writer->storage + ((size_t)idx * writer->cfg.block_bytes);
+}
+
+static int pwrite_all(int fd, const uint8_t *data, size_t len, uint64_t offset, uint64_t *calls)
+{
+    while (len > 0U) {
+        ssize_t n = pwrite(fd, data, len, (off_t)offset);
+
+        ++*calls;
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        data += (size_t)n;
+        len -= (size_t)n;
+        offset += (uint64_t)n;
+    }
+
+    return 0;
+}
+
+static void timed_fsync(capture_writer_t *writer, bool data_only)
+{
+    uint64_t t0 = monotonic_ns();
+    uint64_t dt;
+
+    if ((data_only ? fdatasync(writer->fd) : fsync(writer->fd)) != 0) {
+        int expected = 0;
+
+        (void)atomic_compare_exchange_strong(&writer->error, &expected, errno);
+    }
+    dt = monotonic_ns() - t0;
+    ++writer->stats.fsyncs;
+    if (dt > writer->stats.fsync_ns_max) {
+        writer->stats.fsync_ns_max = dt;
+    }
+    writer->last_fsync_ns = t0 + dt;
+}
+
+static void apply_fsync_policy(capture_writer_t *writer, uint64_t now)
+{
+    if (writer->cfg.fsync_policy == CAPTURE_FSYNC_BLOCK ||
+        (writer->cfg.fsync_policy == CAPTURE_FSYNC_INTERVAL &&
+         now - writer->last_fsync_ns >= (uint64_t)writer->cfg.fsync_interval_ms * 1000000ULL)) {
+        timed_fsync(writer, false);
+    }
+}
+
+static void write_block(capture_writer_t *writer, uint32_t idx)
+{
+    size_t len = writer->fill[idx];
+    uint64_t t0;
+    uint64_t dt;
+
+    if (atomic_load(&writer->error) != 0 || len == 0U) {
+        return;
+    }
+
+    t0 = monotonic_ns();
+    if (pwrite_all(writer->fd, block_ptr(writer, idx), len, writer->offset, &writer->stats.write_calls) != 0) {
+        int expected = 0;
+
+        (void)atomic_compare_exchange_strong(&writer->error, &expected, errno);
+        return;
+    }
+    dt = monotonic_ns() - t0;
+
+    writer->offset += len;
+    writer->stats.bytes_written += len;
+    ++writer->stats.blocks_written;
+    if (dt > writer->stats.write_ns_max) {
+        writer->stats.write_ns_max = dt;
+    }
+    apply_fsync_policy(writer, t0 + dt);
+}
+
+/* One io_uring_enter() for a run of queued blocks; short writes are finished with pwrite(). */
+static void write_blocks_uring(capture_writer_t *writer, const uint32_t *idx, uint32_t n)
+{
+    uint64_t offset = writer->offset;
+    uint64_t enters_before;
+    uring_stats_t us;
+    uint32_t queued = 0U;
+    uint32_t done = 0U;
+    uint32_t k;
+    uint64_t t0;
+    uint64_t dt;
+    int error = 0;
+
+    if (atomic_load(&writer->error) != 0) {
+        return;
+    }
+    uring_get_stats(writer->uring, &us);
+    enters_before = us.enters;
+
+    t0 = monotonic_ns();
+    for (k = 0U; k < n; ++k) {
+        writer->batch_off[k] = offset;
+        if (writer->fill[idx[k]] == 0U) {
+            continue;
+        }
+        (void)uring_prep_write(writer->uring, writer->fd, block_ptr(writer, idx[k]), writer->fill[idx[k]], offset, k);
+        offset += writer->fill[idx[k]];
+        ++queued;
+    }
+    if (uring_submit_wait(writer->uring, queued) != 0) {
+        error = errno;
+    }
+    while (error == 0 && done < queued) {
+        size_t got = uring_reap(writer->uring, writer->cqes, queued - done);
+        size_t c;
+
+        for (c = 0U; c < got; ++c) {
+            uint32_t b = (uint32_t)writer->cqes[c].user_data;
+            size_t len = writer->fill[idx[b]];
+            int32_t res = writer->cqes[c].res;
+
+            if (res < 0) {
+                error = -res;
+            } else if ((size_t)res < len &&
+                       pwrite_all(writer->fd, block_ptr(writer, idx[b]) + res, len - (size_t)res,
+                           writer->batch_off[b] + (uint64_t)res, &writer->stats.write_calls) != 0) {
+                error = errno;
+            }
+        }
+        done += (uint32_t)got;
+        if (got == 0U && uring_submit_wait(writer->uring, queued - done) != 0) {
+            error = errno;
+        }
+    }
+    dt = monotonic_ns() - t0;
+    uring_get_stats(writer->uring, &us);
+    writer->stats.write_calls += us.enters - enters_before;
+    if (error != 0) {
+        int expected = 0;
+
+        (void)atomic_compare_exchange_strong(&writer->error, &expected, error);
+        return;
+    }
+
+    writer->stats.bytes_written += offset - writer->offset;
+    writer->stats.blocks_written += queued;
+    writer->offset = offset;
+    if (dt > writer->stats.write_ns_max) {
+        writer->stats.write_ns_max = dt;
+    }
+    apply_fsync_policy(writer, t0 + dt);
+}
+
+static void *writer_thread_main(void *arg)
+{
+    capture_writer_t *writer = arg;
+
+    for (;;) {
+        uint32_t idx = 0U;
+        uint32_t n = 1U;
+        uint32_t k;
+        bool checkpoint = false;
+
+        pthread_mutex_lock(&writer->lock);
+        while (writer->full_count == 0U && !writer->closing) {
+            pthread_cond_wait(&writer->work_cond, &writer->lock);
+        }
+        if (writer->full_count == 0U) {
+            pthread_mutex_unlock(&writer->lock);
+            break;
+        }
+        /* io_uring takes every queued block at once, unless each needs its own fsync. */
+        if (writer->uring != NULL && writer->cfg.fsync_policy != CAPTURE_FSYNC_BLOCK) {
+            n = writer->full_count;
+        }
+        for (k = 0U; k < n; ++k) {
+            idx = writer->full_queue[writer->full_head];
+            writer->full_head = (writer->full_head + 1U) % writer->cfg.block_count;
+            checkpoint = checkpoint || writer->sync[idx];
+            if (writer->uring != NULL) {
+                writer->batch[k] = idx;
+            }
+        }
+        writer->full_count -= n;
+        pthread_mutex_unlock(&writer->lock);
+
+        /* After a failure blocks are still recycled so the producer never deadlocks. */
+        if (writer->uring != NULL) {
+            write_blocks_uring(writer, writer->batch, n);
+        } else {
+            write_block(writer, idx);
+        }
+        if (checkpoint && atomic_load(&writer->error) == 0) {
+            timed_fsync(writer, true);
+            ++writer->stats.checkpoints;
+        }
+
+        pthread_mutex_lock(&writer->lock);
+        for (k = 0U; k < n; ++k) {
+            if (writer->uring != NULL) {
+                idx = writer->batch[k];
+            }
+            writer->fill[idx] = 0U;
+            writer->sync[idx] = false;
+            writer->free_stack[writer->free_count++] = idx;
+        }
+        pthread_cond_signal(&writer->free_cond);
+        pthread_mutex_unlock(&writer->lock);
+    }
+
+    return NULL;
+}
+
+/* Queue the current block; with take_next, wait for (and switch to) a free one. */
+static void submit_current(capture_writer_t *writer, bool take_next)
+{
+    uint32_t tail;
+
+    pthread_mutex_lock(&writer->lock);
+    writer->fill[writer->cur] = writer->cur_fill;
+    tail = (writer->full_head + writer->full_count) % writer->cfg.block_count;
+    writer->full_queue[tail] = writer->cur;
+    ++writer->full_count;
+    pthread_cond_signal(&writer->work_cond);
+
+    if (take_next) {
+        if (writer->free_count == 0U) {
+            uint64_t t0 = monotonic_ns();
+            uint64_t dt;
+
+            while (writer->free_count == 0U) {
+                pthread_cond_wait(&writer->free_cond, &writer->lock);
+            }
+            dt = monotonic_ns() - t0;
+            ++writer->stats.producer_stalls;
+            if (dt > writer->stats.producer_stall_ns_max) {
+                writer->stats.producer_stall_ns_max = dt;
+            }
+        }
+        writer->cur = writer->free_stack[--writer->free_count];
+    }
+    pthread_mutex_unlock(&writer->lock);
+
+    writer->cur_fill = 0U;
+}
+
+static void writer_free(capture_writer_t *writer)
+{
+    if (writer->fd >= 0) {
+        (void)close(writer->fd);
+    }
+    pthread_cond_destroy(&writer->free_cond);
+    pthread_cond_destroy(&writer->work_cond);
+    pthread_mutex_destroy(&writer->lock);
+    uring_destroy(writer->uring);
+    free(writer->cqes);
+    free(writer->batch_off);
+    free(writer->batch);
+    free(writer->head);
+    free(writer->free_stack);
+    free(writer->full_queue);
+    free(writer->sync);
+    free(writer->fill);
+    free(writer->storage);
+    free(writer);
+}
+
+int capture_writer_open(capture_writer_t **out, const char *path, const capture_writer_cfg_t *cfg)
+{
+    capture_writer_t *writer = NULL;
+    uint32_t idx;
+    int rc;
+
+    if (out == NULL || path == NULL || cfg == NULL) {
+        errno = EINVAL;
+        return -1;
+    }
+    *out = NULL;
+
+    writer = calloc(1U, sizeof(*writer));
+    if (writer == NULL) {
+        return -1;
+    }
+    writer->fd = -1;
+    writer->cfg = *cfg;
+    if (writer->cfg.block_bytes == 0U) {
+        writer->cfg.block_bytes = CAPTURE_WRITER_DEFAULT_BLOCK_BYTES;
+    }
+    if (writer->cfg.block_count == 0U) {
+        writer->cfg.block_count = CAPTURE_WRITER_DEFAULT_BLOCK_COUNT;
+    }
+    pthread_mutex_init(&writer->lock, NULL);
+    pthread_cond_init(&writer->work_cond, NULL);
+    pthread_cond_init(&writer->free_cond, NULL);
+
+    if ((writer->cfg.block_bytes % CAPTURE_BLOCK_ALIGN_BYTES) != 0U || writer->cfg.block_count < 2U ||
+        writer->cfg.fsync_policy > CAPTURE_FSYNC_INTERVAL) {
+        errno = EINVAL;
+        goto fail;
+    }
+
+    rc = posix_memalign((void **)&writer->storage, CAPTURE_BLOCK_ALIGN_BYTES,
+        writer->cfg.block_bytes * writer->cfg.block_count);
+    if (rc != 0) {
+        writer->storage = NULL;
+        errno = rc;
+        goto fail;
+    }
+    writer->fill = calloc(writer->cfg.block_count, sizeof(*writer->fill));
+    writer->sync = calloc(writer->cfg.block_count, sizeof(*writer->sync));
+    writer->full_queue = calloc(writer->cfg.block_count, sizeof(*writer->full_queue));
+    writer->free_stack = calloc(writer->cfg.block_count, sizeof(*writer->free_stack));
+    if (writer->fill == NULL || writer->sync == NULL || writer->full_queue == NULL || writer->free_stack == NULL) {
+        goto fail;
+    }
+    /* Touch every block now so page faults do not land on the capture path. */
+    memset(writer->storage, 0, writer->cfg.block_bytes * writer->cfg.block_count);
+
+    writer->cur = 0U;
+    for (idx = writer->cfg.block_count - 1U; idx >= 1U; --idx) {
+        writer->free_stack[writer->free_count++] = idx;
+    }
+
+    writer->fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (writer->fd < 0) {
+        goto fail;
+    }
+    if (writer->cfg.prealloc_bytes != 0U) {
+        rc = posix_fallocate(writer->fd, 0, (off_t)writer->cfg.prealloc_bytes);
+        if (rc != 0) {
+            errno = rc;
+            goto fail;
+        }
+    }
+
+    /* io_uring is best effort: without it (or its memory) blocks go through pwrite(). */
+    if (writer->cfg.io_uring && uring_create(&writer->uring, writer->cfg.block_count) == 0) {
+        writer->batch = calloc(writer->cfg.block_count, sizeof(*writer->batch));
+        writer->batch_off = calloc(writer->cfg.block_count, sizeof(*writer->batch_off));
+        writer->cqes = calloc(writer->cfg.block_count, sizeof(*writer->cqes));
+        if (writer->batch == NULL || writer->batch_off == NULL || writer->cqes == NULL) {
+            goto fail;
+        }
+        writer->stats.io_uring = true;
+        writer->stats.io_uring_fixed = (uring_register_buffer(writer->uring, writer->storage,
+            writer->cfg.block_bytes * writer->cfg.block_count) == 0);
+    }
+
+    atomic_init(&writer->error, 0);
+    writer->open_ns = monotonic_ns();
+    writer->last_fsync_ns = writer->open_ns;
+
+    rc = pthread_create(&writer->thread, NULL, writer_thread_main, writer);
+    if (rc != 0) {
+        errno = rc;
+        goto fail;
+    }
+    writer->thread_started = true;
+
+    *out = writer;
+    return 0;
+
+fail:
+    {
+        int saved_errno = errno;
+
+        writer_free(writer);
+        errno = saved_errno;
+    }
+    return -1;
+}
+
+int capture_writer_write(capture_writer_t *writer, const void *data, size_t len)
+{
+    const uint8_t *src = data;
+    int error;
+
+    if (writer == NULL || (data == NULL && len != 0U)) {
+        errno = EINVAL;
+        return -1;
+    }
+    error = atomic_load_explicit(&writer->error, memory_order_relaxed);
+    if (error != 0) {
+        errno = error;
+        return -1;
+    }
+
+    while (len > 0U) {
+        size_t space = writer->cfg.block_bytes - writer->cur_fill;
+        size_t n = (len < space) ? len : space;
+
+        memcpy(block_ptr(writer, writer->cur) + writer->cur_fill, src, n);
+        writer->cur_fill += n;
+        src += n;
+        len -= n;
+        if (writer->cur_fill == writer->cfg.block_bytes) {
+            submit_current(writer, true);
+        }
+    }
+
+    return 0;
+}
+
+#if !defined(__BYTE_ORDER__) || (__BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__)
+static void store_u64_le(uint8_t *dst, uint64_t value)
+{
+    uint32_t idx;
+
+    for (idx = 0U; idx < 8U; ++idx) {
+        dst[idx] = (uint8_t)(value >> (idx * 8U));
+    }
+}
+
+#endif
+
+static void store_record_v1(uint8_t *dst, const ads1278_frame_t *frame)
+{
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+    memcpy(dst, frame, CAPTURE_RECORD_V1_BYTES);
+#else
+    uint32_t idx;
+
+    store_u64_le(dst, frame->seq);
+    store_u64_le(dst + 8, frame->tstamp_ns);
+    for (idx = 0U; idx < ADS1278_CHANNEL_COUNT; ++idx) {
+        uint32_t value = (uint32_t)frame->ch[idx];
+
+        dst[16U + (idx * 4U) + 0U] = (uint8_t)value;
+        dst[16U + (idx * 4U) + 1U] = (uint8_t)(value >> 8U);
+        dst[16U + (idx * 4U) + 2U] = (uint8_t)(value >> 16U);
+        dst[16U + (idx * 4U) + 3U] = (uint8_t)(value >> 24U);
+    }
+#endif
+}
+
+int capture_writer_append_frames(capture_writer_t *writer, const ads1278_frame_t *frames, size_t n)
+{
+    size_t idx = 0U;
+    int error;
+
+    if (writer == NULL || (frames == NULL && n != 0U)) {
+        errno = EINVAL;
+        return -1;
+    }
+    error = atomic_load_explicit(&writer->error, memory_order_relaxed);
+    if (error != 0) {
+        errno = error;
+        return -1;
+    }
+
+    while (idx < n) {
+        size_t fit = (writer->cfg.block_bytes - writer->cur_fill) / CAPTURE_RECORD_V1_BYTES;
+
+        if (fit == 0U) {
+            /* Record straddles the block boundary. */
+            uint8_t record[CAPTURE_RECORD_V1_BYTES];
+
+            store_record_v1(record, &frames[idx]);
+            if (capture_writer_write(writer, record, sizeof(record)) != 0) {
+                return -1;
+            }
+            ++idx;
+            continue;
+        }
+
+        if (fit > n - idx) {
+            fit = n - idx;
+        }
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__) && ADS1278_MAX_CHAIN == 1
+        memcpy(block_ptr(writer, writer->cur) + writer->cur_fill, &frames[idx], fit * CAPTURE_RECORD_V1_BYTES);
+        writer->cur_fill += fit * CAPTURE_RECORD_V1_BYTES;
+        idx += fit;
+#else
+        for (; fit > 0U; --fit, ++idx) {
+            store_record_v1(block_ptr(writer, writer->cur) + writer->cur_fill, &frames[idx]);
+            writer->cur_fill += CAPTURE_RECORD_V1_BYTES;
+        }
+#endif
+        if (writer->cur_fill == writer->cfg.block_bytes) {
+            submit_current(writer, true);
+        }
+    }
+
+    return 0;
+}
+
+int capture_writer_checkpoint(capture_writer_t *writer)
+{
+    int error;
+
+    if (writer == NULL) {
+        errno = EINVAL;
+        return -1;
+    }
+    error = atomic_load_explicit(&writer->error, memory_order_relaxed);
+    if (error != 0) {
+        errno = error;
+        return -1;
+    }
+
+    /* An empty block still carries the flag, so data already queued gets synced. */
+    writer->sync[writer->cur] = true;
+    submit_current(writer, true);
+    return 0;
+}
+
+int capture_writer_rewrite_head(capture_writer_t *writer, const void *data, size_t len)
+{
+    uint8_t *head;
+
+    if (writer == NULL || data == NULL || len == 0U) {
+        errno = EINVAL;
+        return -1;
+    }
+    head = malloc(len);
+    if (head == NULL) {
+        return -1;
+    }
+    memcpy(head, data, len);
+    free(writer->head);
+    writer->head = head;
+    writer->head_len = len;
+    return 0;
+}
+
+int capture_writer_close(capture_writer_t *writer, capture_writer_stats_t *stats)
+{
+    int error;
+
+    if (writer == NULL) {
+        return 0;
+    }
+
+    if (writer->cur_fill != 0U) {
+        submit_current(writer, false);
+    }
+    pthread_mutex_lock(&writer->lock);
+    writer->closing = true;
+    pthread_cond_signal(&writer->work_cond);
+    pthread_mutex_unlock(&writer->lock);
+    if (writer->thread_started) {
+        pthread_join(writer->thread, NULL);
+    }
+
+    if (writer->head_len != 0U && atomic_load(&writer->error) == 0 &&
+        pwrite_all(writer->fd, writer->head, writer->head_len, 0U, &writer->stats.write_calls) != 0) {
+        int expected = 0;
+
+        (void)atomic_compare_exchange_strong(&writer->error, &expected, errno);
+    }
+    if (writer->cfg.prealloc_bytes != 0U && ftruncate(writer->fd, (off_t)writer->offset) != 0) {
+        int expected = 0;
+
+        (void)atomic_compare_exchange_strong(&writer->error, &expected, errno);
+    }
+    if (writer->cfg.fsync_policy != CAPTURE_FSYNC_NONE) {
+        timed_fsync(writer, false);
+    }
+    if (close(writer->fd) != 0) {
+        int expected = 0;
+
+        (void)atomic_compare_exchange_strong(&writer->error, &expected, errno);
+    }
+    writer->fd = -1;
+
+    writer->stats.elapsed_ns = monotonic_ns() - writer->open_ns;
+    if (stats != NULL) {
+        *stats = writer->stats;
+    }
+    error = atomic_load(&writer->error);
+    writer_free(writer);
+
+    if (error != 0) {
+        errno = error;
+        return -1;
+    }
+    return 0;
+}
+
+const char *capture_fsync_policy_name(capture_fsync_policy_t policy)
+{
+    switch (policy) {
+        case CAPTURE_FSYNC_NONE:
+            return "none";
+        case CAPTURE_FSYNC_CLOSE:
+            return "close";
+        case CAPTURE_FSYNC_BLOCK:
+            return "block";
+        case CAPTURE_FSYNC_INTERVAL:
+            return "interval";
+        default:
+            return "unknown";
+    }
+}
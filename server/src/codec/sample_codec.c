@@ -0,0 +1,220 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Miguel Dovale (University of Arizona)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "sample_codec.h"
+
+#include <string.h>
+
+/* Group payload plus slack so the unpacker can always load a whole word. */
+#define GROUP_SCRATCH_BYTES ((SAMPLE_CODEC_GROUP * 4U) + 8U)
+
+static inline uint32_t zigzag(uint32_t delta)
+{
+    return (delta << 1U) ^ (0U - (delta >> 31U));
+}
+
+static inline uint32_t unzigzag(uint32_t value)
+{
+    return (value >> 1U) ^ (0U - (value & 1U));
+}
+
+static inline uint32_t bit_width(uint32_t value)
+{
+    return (value == 0U) ? 0U : 32U - (uint32_t)__builtin_clz(value);
+}
+
+static inline size_t group_bytes(size_t count, uint32_t width)
+{
+    return ((count * width) + 7U) / 8U;
+}
+
+static inline uint32_t load_u32(const uint8_t *src)
+{
+    return (uint32_t)src[0] | ((uint32_t)src[1] << 8U) | ((uint32_t)src[2] << 16U) | ((uint32_t)src[3] << 24U);
+}
+
+static inline void store_u32(uint8_t *dst, uint32_t value)
+{
+    dst[0] = (uint8_t)value;
+    dst[1] = (uint8_t)(value >> 8U);
+    dst[2] = (uint8_t)(value >> 16U);
+    dst[3] = (uint8_t)(value >> 24U);
+}
+
+size_t sample_codec_max_bytes(size_t n)
+{
+    return (n * 4U) + ((n + SAMPLE_CODEC_GROUP - 1U) / SAMPLE_CODEC_GROUP);
+}
+
+/* Whole 32-bit words go out as soon as they fill; the tail is flushed bytewise. */
+static uint8_t *pack_group(uint8_t *dst, const uint32_t *values, size_t count, uint32_t width)
+{
+    uint64_t acc = 0U;
+    uint32_t bits = 0U;
+    size_t idx;
+
+    for (idx = 0U; idx < count; ++idx) {
+        acc |= (uint64_t)values[idx] << bits;
+        bits += width;
+        if (bits >= 32U) {
+            store_u32(dst, (uint32_t)acc);
+            dst += 4;
+            acc >>= 32U;
+            bits -= 32U;
+        }
+    }
+    while (bits > 0U) {
+        *dst++ = (uint8_t)acc;
+        acc >>= 8U;
+        bits = (bits > 8U) ? bits - 8U : 0U;
+    }
+    return dst;
+}
+
+size_t sample_codec_encode(const int32_t *src, size_t stride, size_t n, uint8_t *dst)
+{
+    uint8_t *const start = dst;
+    uint32_t prev = 0U;
+    size_t pos;
+
+    for (pos = 0U; pos < n; pos += SAMPLE_CODEC_GROUP) {
+        uint32_t values[SAMPLE_CODEC_GROUP];
+        size_t count = (n - pos < SAMPLE_CODEC_GROUP) ? n - pos : SAMPLE_CODEC_GROUP;
+        uint32_t any = 0U;
+        uint32_t width;
+        size_t idx;
+
+        for (idx = 0U; idx < count; ++idx) {
+            uint32_t cur = (uint32_t)src[(pos + idx) * stride];
+
+            values[idx] = zigzag(cur - prev);
+            any |= values[idx];
+            prev = cur;
+        }
+
+        width = bit_width(any);
+        *dst++ = (uint8_t)width;
+        dst = pack_group(dst, values, count, width);
+    }
+
+    return (size_t)(dst - start);
+}
+
+size_t sample_codec_stream_bytes(const uint8_t *src, size_t len, size_t n)
+{
+    size_t used = 0U;
+    size_t pos;
+
+    for (pos = 0U; pos < n; pos += SAMPLE_CODEC_GROUP) {
+        size_t count = (n - pos < SAMPLE_CODEC_GROUP) ? n - pos : SAMPLE_CODEC_GROUP;
+        uint32_t width;
+
+        if (used >= len || src[used] > 32U) {
+            return 0U;
+        }
+        width = src[used];
+        used += 1U + group_bytes(count, width);
+        if (used > len) {
+            return 0U;
+        }
+    }
+
+    return used;
+}
+
+void sample_codec_reader_init(sample_codec_reader_t *rd, const uint8_t *src, size_t n)
+{
+    rd->src = src;
+    rd->left = n;
+    rd->prev = 0U;
+    rd->avail = 0U;
+    rd->next = 0U;
+}
+
+static void unpack_group(sample_codec_reader_t *rd)
+{
+    uint8_t scratch[GROUP_SCRATCH_BYTES];
+    uint32_t count = (rd->left < SAMPLE_CODEC_GROUP) ? (uint32_t)rd->left : SAMPLE_CODEC_GROUP;
+    uint32_t width = *rd->src++;
+    uint32_t mask = (width == 32U) ? UINT32_MAX : ((1U << width) - 1U);
+    size_t nbytes = group_bytes(count, width);
+    const uint8_t *in = scratch;
+    uint32_t prev = rd->prev;
+    uint64_t acc = 0U;
+    uint32_t bits = 0U;
+    uint32_t idx;
+
+    memcpy(scratch, rd->src, nbytes);
+    memset(scratch + nbytes, 0, 8U);
+    rd->src += nbytes;
+
+    for (idx = 0U; idx < count; ++idx) {
+        if (bits < width) {
+            acc |= (uint64_t)load_u32(in) << bits;
+            in += 4;
+            bits += 32U;
+        }
+        prev += unzigzag((uint32_t)acc & mask);
+        acc >>= width;
+        bits -= width;
+        rd->vals[idx] = (int32_t)prev;
+    }
+
+    rd->prev = prev;
+    rd->left -= count;
+    rd->avail = count;
+    rd->next = 0U;
+}
+
+void sample_codec_read(sample_codec_reader_t *rd, size_t count, int32_t *dst, size_t stride)
+{
+    while (count > 0U) {
+        size_t n;
+        size_t idx;
+
+        if (rd->avail == 0U) {
+            if (rd->left == 0U) {
+                break;
+            }
+            unpack_group(rd);
+        }
+        n = (count < rd->avail) ? count : rd->avail;
+        if (dst != NULL) {
+            for (idx = 0U; idx < n; ++idx) {
+                dst[idx * stride] = rd->vals[rd->next + idx];
+            }
+            dst += n * stride;
+        }
+        rd->next += (uint32_t)n;
+        rd->avail -= (uint32_t)n;
+        count -= n;
+    }
+}
@@ -0,0 +1,1220 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Miguel Dovale (University of Arizona)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "proto.h"
+
+#include "ads1278_unpack.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+void proto_encode_header(uint8_t dst[PROTO_HEADER_BYTES], const proto_header_t *hdr)
+{
+    proto_store_u32(dst, PROTO_MAGIC);
+    dst[4] = hdr->version;
+    dst[5] = hdr->type;
+    proto_store_u16(dst + 6, hdr->flags);
+    proto_store_u32(dst + 8, hdr->msg_seq);
+    proto_store_u32(dst + 12, hdr->payload_len);
+}
+
+int proto_decode_header(const uint8_t src[PROTO_HEADER_BYTES], proto_header_t *hdr)
+{
+    if (proto_load_u32(src) != PROTO_MAGIC || src[4] < PROTO_MIN_VERSION || src[4] > PROTO_VERSION) {
+        errno = EPROTO;
+        return -1;
+    }
+
+    hdr->version = src[4];
+    hdr->type = src[5];
+    hdr->flags = proto_load_u16(src + 6);
+    hdr->msg_seq = proto_load_u32(src + 8);
+    hdr->payload_len = proto_load_u32(src + 12);
+    if (hdr->payload_len > PROTO_MAX_PAYLOAD_BYTES) {
+        errno = EMSGSIZE;
+        return -1;
+    }
+    return 0;
+}
+
+static void encode_simple_header(uint8_t *dst, proto_msg_type_t type, uint32_t msg_seq, uint32_t payload_len)
+{
+    proto_header_t hdr = {0};
+
+    hdr.version = PROTO_VERSION;
+    hdr.type = (uint8_t)type;
+    hdr.msg_seq = msg_seq;
+    hdr.payload_len = payload_len;
+    proto_encode_header(dst, &hdr);
+}
+
+size_t proto_encode_hello(uint8_t *dst, uint32_t msg_seq, const proto_hello_t *hello)
+{
+    uint8_t *payload = dst + PROTO_HEADER_BYTES;
+
+    encode_simple_header(dst, PROTO_MSG_HELLO, msg_seq, PROTO_HELLO_BYTES);
+    proto_store_u16(payload, hello->proto_version);
+    proto_store_u16(payload + 2, hello->channel_count);
+    proto_store_u32(payload + 4, hello->reserved);
+    memset(payload + 8, 0, PROTO_SERVER_NAME_BYTES);
+    memcpy(payload + 8, hello->server_name, strnlen(hello->server_name, PROTO_SERVER_NAME_BYTES));
+    return PROTO_HEADER_BYTES + PROTO_HELLO_BYTES;
+}
+
+int proto_decode_hello(const uint8_t *payload, size_t len, proto_hello_t *hello)
+{
+    if (len < PROTO_HELLO_BYTES) {
+        errno = EPROTO;
+        return -1;
+    }
+
+    hello->proto_version = proto_load_u16(payload);
+    hello->channel_count = proto_load_u16(payload + 2);
+    hello->reserved = proto_load_u32(payload + 4);
+    memcpy(hello->server_name, payload + 8, PROTO_SERVER_NAME_BYTES);
+    hello->server_name[PROTO_SERVER_NAME_BYTES - 1U] = '\0';
+    return 0;
+}
+
+size_t proto_encode_config(uint8_t *dst, uint32_t msg_seq, const proto_config_t *cfg)
+{
+    uint8_t *payload = dst + PROTO_HEADER_BYTES;
+
+    encode_simple_header(dst, PROTO_MSG_CONFIG, msg_seq, PROTO_CONFIG_BYTES);
+    proto_store_u32(payload, cfg->backend);
+    proto_store_u32(payload + 4, cfg->sample_rate_hz);
+    proto_store_u32(payload + 8, cfg->sclk_hz);
+    proto_store_u32(payload + 12, cfg->spi_mode);
+    proto_store_u32(payload + 16, cfg->settle_frames);
+    proto_store_u32(payload + 20, cfg->frames_per_msg);
+    proto_store_u32(payload + 24, cfg->flush_us);
+    proto_store_u32(payload + 28, cfg->stream_mode);
+    return PROTO_HEADER_BYTES + PROTO_CONFIG_BYTES;
+}
+
+int proto_decode_config(const uint8_t *payload, size_t len, proto_config_t *cfg)
+{
+    if (len < PROTO_CONFIG_BYTES) {
+        errno = EPROTO;
+        return -1;
+    }
+
+    cfg->backend = proto_load_u32(payload);
+    cfg->sample_rate_hz = proto_load_u32(payload + 4);
+    cfg->sclk_hz = proto_load_u32(payload + 8);
+    cfg->spi_mode = proto_load_u32(payload + 12);
+    cfg->settle_frames = proto_load_u32(payload + 16);
+    cfg->frames_per_msg = proto_load_u32(payload + 20);
+    cfg->flush_us = proto_load_u32(payload + 24);
+    cfg->stream_mode = proto_load_u32(payload + 28);
+    return 0;
+}
+
+size_t proto_encode_stats(uint8_t *dst, uint32_t msg_seq, const proto_stats_t *stats)
+{
+    uint8_t *payload = dst + PROTO_HEADER_BYTES;
+    uint32_t idx;
+
+    encode_simple_header(dst, PROTO_MSG_STATS, msg_seq, PROTO_STATS_BYTES);
+    proto_store_u64(payload, stats->mono_ns);
+    proto_store_u64(payload + 8, stats->frames);
+    proto_store_u64(payload + 16, stats->drdy_timeouts);
+    proto_store_u64(payload + 24, stats->missed_drdy);
+    proto_store_u64(payload + 32, stats->overlong_xfers);
+    proto_store_u64(payload + 40, stats->ring_overflows);
+    proto_store_u64(payload + 48, stats->ring_high_water);
+    proto_store_u64(payload + 56, stats->msgs_dropped);
+    proto_store_u64(payload + 64, stats->missed_conversions);
+    proto_store_u64(payload + 72, stats->gap_events);
+    proto_store_u32(payload + 80, stats->ring_capacity);
+    proto_store_u16(payload + 84, PROTO_STAGE_COUNT);
+    proto_store_u16(payload + 86, 0U);
+    for (idx = 0U; idx < PROTO_STAGE_COUNT; ++idx) {
+        uint8_t *dst_stage = payload + PROTO_STATS_HEADER_BYTES + (idx * PROTO_STATS_STAGE_BYTES);
+        const proto_stage_stats_t *stage = &stats->stage[idx];
+
+        proto_store_u64(dst_stage, stage->count);
+        proto_store_u32(dst_stage + 8, stage->p50_ns);
+        proto_store_u32(dst_stage + 12, stage->p99_ns);
+        proto_store_u32(dst_stage + 16, stage->p999_ns);
+        proto_store_u32(dst_stage + 20, stage->max_ns);
+    }
+    return PROTO_HEADER_BYTES + PROTO_STATS_BYTES;
+}
+
+int proto_decode_stats(const uint8_t *payload, size_t len, proto_stats_t *stats)
+{
+    uint32_t present;
+    uint32_t idx;
+
+    if (len < PROTO_STATS_HEADER_BYTES) {
+        errno = EPROTO;
+        return -1;
+    }
+    present = proto_load_u16(payload + 84);
+    if (len < PROTO_STATS_HEADER_BYTES + ((size_t)present * PROTO_STATS_STAGE_BYTES)) {
+        errno = EPROTO;
+        return -1;
+    }
+
+    memset(stats, 0, sizeof(*stats));
+    stats->mono_ns = proto_load_u64(payload);
+    stats->frames = proto_load_u64(payload + 8);
+    stats->drdy_timeouts = proto_load_u64(payload + 16);
+    stats->missed_drdy = proto_load_u64(payload + 24);
+    stats->overlong_xfers = proto_load_u64(payload + 32);
+    stats->ring_overflows = proto_load_u64(payload + 40);
+    stats->ring_high_water = proto_load_u64(payload + 48);
+    stats->msgs_dropped = proto_load_u64(payload + 56);
+    stats->missed_conversions = proto_load_u64(payload + 64);
+    stats->gap_events = proto_load_u64(payload + 72);
+    stats->ring_capacity = proto_load_u32(payload + 80);
+    stats->stage_count = (uint16_t)((present < PROTO_STAGE_COUNT) ? present : PROTO_STAGE_COUNT);
+    for (idx = 0U; idx < stats->stage_count; ++idx) {
+        const uint8_t *src = payload + PROTO_STATS_HEADER_BYTES + (idx * PROTO_STATS_STAGE_BYTES);
+        proto_stage_stats_t *stage = &stats->stage[idx];
+
+        stage->count = proto_load_u64(src);
+        stage->p50_ns = proto_load_u32(src + 8);
+        stage->p99_ns = proto_load_u32(src + 12);
+        stage->p999_ns = proto_load_u32(src + 16);
+        stage->max_ns = proto_load_u32(src + 20);
+    }
+    return 0;
+}
+
+static void store_f64(uint8_t *dst, double value)
+{
+    uint64_t bits;
+
+    memcpy(&bits, &value, sizeof(bits));
+    proto_store_u64(dst, bits);
+}
+
+static double load_f64(const uint8_t *src)
+{
+    const uint64_t bits = proto_load_u64(src);
+    double value;
+
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+size_t proto_encode_summary(uint8_t *dst, uint32_t msg_seq, const proto_summary_t *summary)
+{
+    const size_t len = PROTO_SUMMARY_BYTES(summary->channel_count);
+    uint8_t *payload = dst + PROTO_HEADER_BYTES;
+    uint32_t idx;
+
+    encode_simple_header(dst, PROTO_MSG_SUMMARY, msg_seq, (uint32_t)len);
+    proto_store_u64(payload, summary->mono_ns);
+    proto_store_u64(payload + 8, summary->first_seq);
+    proto_store_u64(payload + 16, summary->last_seq);
+    proto_store_u64(payload + 24, summary->frames);
+    proto_store_u64(payload + 32, summary->first_tstamp_ns);
+    proto_store_u64(payload + 40, summary->last_tstamp_ns);
+    proto_store_u16(payload + 48, summary->channel_count);
+    proto_store_u16(payload + 50, summary->flags);
+    proto_store_u32(payload + 52, 0U);
+    for (idx = 0U; idx < summary->channel_count; ++idx) {
+        uint8_t *dst_ch = payload + PROTO_SUMMARY_HEADER_BYTES + (idx * PROTO_SUMMARY_CHANNEL_BYTES);
+        const proto_summary_channel_t *ch = &summary->ch[idx];
+
+        store_f64(dst_ch, ch->min);
+        store_f64(dst_ch + 8, ch->max);
+        store_f64(dst_ch + 16, ch->mean);
+        store_f64(dst_ch + 24, ch->rms);
+        store_f64(dst_ch + 32, ch->stddev);
+    }
+    return PROTO_HEADER_BYTES + len;
+}
+
+int proto_decode_summary(const uint8_t *payload, size_t len, proto_summary_t *summary)
+{
+    uint32_t channels;
+    uint32_t idx;
+
+    if (len < PROTO_SUMMARY_HEADER_BYTES) {
+        errno = EPROTO;
+        return -1;
+    }
+    channels = proto_load_u16(payload + 48);
+    if (channels > ADS1278_MAX_CHANNELS || len < PROTO_SUMMARY_BYTES(channels)) {
+        errno = EPROTO;
+        return -1;
+    }
+
+    memset(summary, 0, sizeof(*summary));
+    summary->mono_ns = proto_load_u64(payload);
+    summary->first_seq = proto_load_u64(payload + 8);
+    summary->last_seq = proto_load_u64(payload + 16);
+    summary->frames = proto_load_u64(payload + 24);
+    summary->first_tstamp_ns = proto_load_u64(payload + 32);
+    summary->last_tstamp_ns = proto_load_u64(payload + 40);
+    summary->channel_count = (uint16_t)channels;
+    summary->flags = proto_load_u16(payload + 50);
+    for (idx = 0U; idx < channels; ++idx) {
+        const uint8_t *src = payload + PROTO_SUMMARY_HEADER_BYTES + (idx * PROTO_SUMMARY_CHANNEL_BYTES);
+        proto_summary_channel_t *ch = &summary->ch[idx];
+
+        ch->min = load_f64(src);
+        ch->max = load_f64(src + 8);
+        ch->mean = load_f64(src + 16);
+        ch->rms = load_f64(src + 24);
+        ch->stddev = load_f64(src + 32);
+    }
+    return 0;
+}
+
+size_t proto_encode_spectrum(uint8_t *dst, uint32_t msg_seq, const proto_spectrum_t *spectrum, const float *bins)
+{
+    const size_t len = PROTO_SPECTRUM_BYTES(spectrum->bin_count);
+    uint8_t *payload = dst + PROTO_HEADER_BYTES;
+    uint32_t idx;
+
+    encode_simple_header(dst, PROTO_MSG_SPECTRUM, msg_seq, (uint32_t)len);
+    proto_store_u64(payload, spectrum->mono_ns);
+    proto_store_u64(payload + 8, spectrum->result_id);
+    proto_store_u64(payload + 16, spectrum->first_seq);
+    proto_store_u64(payload + 24, spectrum->last_seq);
+    store_f64(payload + 32, spectrum->bin_hz);
+    store_f64(payload + 40, spectrum->enbw_hz);
+    proto_store_u32(payload + 48, spectrum->fft_size);
+    proto_store_u32(payload + 52, spectrum->segments);
+    proto_store_u16(payload + 56, spectrum->channel);
+    proto_store_u16(payload + 58, spectrum->window);
+    proto_store_u16(payload + 60, spectrum->flags);
+    proto_store_u16(payload + 62, spectrum->bin_group);
+    proto_store_u32(payload + 64, spectrum->bin_count);
+    proto_store_u32(payload + 68, 0U);
+    for (idx = 0U; idx < spectrum->bin_count; ++idx) {
+        uint32_t bits;
+
+        memcpy(&bits, &bins[idx], sizeof(bits));
+        proto_store_u32(payload + PROTO_SPECTRUM_HEADER_BYTES + ((size_t)idx * 4U), bits);
+    }
+    return PROTO_HEADER_BYTES + len;
+}
+
+int proto_decode_spectrum(const uint8_t *payload, size_t len, proto_spectrum_t *spectrum, float *bins,
+                          size_t max_bins)
+{
+    size_t idx;
+
+    if (len < PROTO_SPECTRUM_HEADER_BYTES) {
+        errno = EPROTO;
+        return -1;
+    }
+    memset(spectrum, 0, sizeof(*spectrum));
+    spectrum->bin_count = proto_load_u32(payload + 64);
+    if (len < PROTO_SPECTRUM_BYTES(spectrum->bin_count)) {
+        errno = EPROTO;
+        return -1;
+    }
+    spectrum->mono_ns = proto_load_u64(payload);
+    spectrum->result_id = proto_load_u64(payload + 8);
+    spectrum->first_seq = proto_load_u64(payload + 16);
+    spectrum->last_seq = proto_load_u64(payload + 24);
+    spectrum->bin_hz = load_f64(payload + 32);
+    spectrum->enbw_hz = load_f64(payload + 40);
+    spectrum->fft_size = proto_load_u32(payload + 48);
+    spectrum->segments = proto_load_u32(payload + 52);
+    spectrum->channel = proto_load_u16(payload + 56);
+    spectrum->window = proto_load_u16(payload + 58);
+    spectrum->flags = proto_load_u16(payload + 60);
+    spectrum->bin_group = proto_load_u16(payload + 62);
+    for (idx = 0U; bins != NULL && idx < spectrum->bin_count && idx < max_bins; ++idx) {
+        uint32_t bits = proto_load_u32(payload + PROTO_SPECTRUM_HEADER_BYTES + (idx * 4U));
+
+        memcpy(&bins[idx], &bits, sizeof(bits));
+    }
+    return 0;
+}
+
+size_t proto_encode_subscribe(uint8_t *dst, const proto_subscribe_t *sub)
+{
+    uint8_t *payload = dst + PROTO_HEADER_BYTES;
+
+    encode_simple_header(dst, PROTO_MSG_SUBSCRIBE, 0U, PROTO_SUBSCRIBE_BYTES);
+    proto_store_u64(payload, sub->resume_seq);
+    proto_store_u32(payload + 8, sub->max_lag_ms);
+    proto_store_u16(payload + 12, sub->policy);
+    proto_store_u16(payload + 14, sub->flags);
+    return PROTO_HEADER_BYTES + PROTO_SUBSCRIBE_BYTES;
+}
+
+int proto_decode_subscribe(const uint8_t *payload, size_t len, proto_subscribe_t *sub)
+{
+    if (len < PROTO_SUBSCRIBE_BYTES) {
+        errno = EPROTO;
+        return -1;
+    }
+
+    sub->resume_seq = proto_load_u64(payload);
+    sub->max_lag_ms = proto_load_u32(payload + 8);
+    sub->policy = proto_load_u16(payload + 12);
+    sub->flags = proto_load_u16(payload + 14);
+    return 0;
+}
+
+size_t proto_encode_gap(uint8_t *dst, const proto_gap_t *gap)
+{
+    uint8_t *payload = dst + PROTO_HEADER_BYTES;
+
+    encode_simple_header(dst, PROTO_MSG_GAP, 0U, PROTO_GAP_BYTES);
+    proto_store_u32(payload, gap->first_msg_seq);
+    proto_store_u32(payload + 4, gap->msg_count);
+    proto_store_u64(payload + 8, gap->first_seq);
+    proto_store_u64(payload + 16, gap->frame_count);
+    proto_store_u16(payload + 24, gap->flags);
+    proto_store_u16(payload + 26, 0U);
+    proto_store_u32(payload + 28, 0U);
+    return PROTO_HEADER_BYTES + PROTO_GAP_BYTES;
+}
+
+int proto_decode_gap(const uint8_t *payload, size_t len, proto_gap_t *gap)
+{
+    if (len < PROTO_GAP_BYTES) {
+        errno = EPROTO;
+        return -1;
+    }
+
+    gap->first_msg_seq = proto_load_u32(payload);
+    gap->msg_count = proto_load_u32(payload + 4);
+    gap->first_seq = proto_load_u64(payload + 8);
+    gap->frame_count = proto_load_u64(payload + 16);
+    gap->flags = proto_load_u16(payload + 24);
+    return 0;
+}
+
+static uint32_t saturate_u32(uint64_t value)
+{
+    return (value > UINT32_MAX) ? UINT32_MAX : (uint32_t)value;
+}
+
+void proto_stage_from_hist(proto_stage_stats_t *stage, const lat_hist_t *hist)
+{
+    stage->count = hist->count;
+    stage->p50_ns = saturate_u32(lat_hist_quantile(hist, 0.5));
+    stage->p99_ns = saturate_u32(lat_hist_quantile(hist, 0.99));
+    stage->p999_ns = saturate_u32(lat_hist_quantile(hist, 0.999));
+    stage->max_ns = saturate_u32(hist->max_ns);
+}
+
+const char *proto_stage_name(proto_stage_t stage)
+{
+    switch (stage) {
+        case PROTO_STAGE_DRDY_WAKEUP:
+            return "drdy-wakeup";
+        case PROTO_STAGE_SPI_XFER:
+            return "spi-xfer";
+        case PROTO_STAGE_PARSE:
+            return "parse";
+        case PROTO_STAGE_RING_DWELL:
+            return "ring-dwell";
+        case PROTO_STAGE_NET_SEND:
+            return "net-send";
+    default:
+            return "unknown";
+    }
+}
+
+const char *proto_data_encoding_name(uint16_t encoding)
+{
+    switch (encoding) {
+        case PROTO_DATA_ENC_RECORD48:
+            return "record48";
+        case PROTO_DATA_ENC_P24:
+            return "p24";
+        case PROTO_DATA_ENC_DELTA:
+            return "delta";
+        default:
+            return "unknown";
+    }
+}
+
+static bool has_base_tstamp(uint16_t encoding)
+{
+    return encoding == PROTO_DATA_ENC_P24 || encoding == PROTO_DATA_ENC_DELTA;
+}
+
+static size_t data_body_offset(uint16_t encoding)
+{
+    return PROTO_DATA_HEADER_BYTES + (has_base_tstamp(encoding) ? PROTO_P24_BASE_BYTES : 0U);
+}
+
+/* Channels in one frame: whole devices, at most the longest chain. */
+static bool channels_valid(uint16_t encoding, uint32_t channels)
+{
+    if (encoding == PROTO_DATA_ENC_RECORD48) {
+        return channels == ADS1278_CHANNEL_COUNT;
+    }
+    return channels != 0U && channels <= ADS1278_MAX_CHANNELS;
+}
+
+size_t proto_data_max_bytes(uint16_t encoding, uint32_t channels, size_t n)
+{
+    if (!channels_valid(encoding, channels)) {
+        return 0U;
+    }
+    switch (encoding) {
+        case PROTO_DATA_ENC_RECORD48:
+            return PROTO_HEADER_BYTES + data_body_offset(encoding) + (n * PROTO_RECORD48_BYTES);
+        case PROTO_DATA_ENC_P24:
+            return PROTO_HEADER_BYTES + data_body_offset(encoding) + (n * PROTO_P24_FRAME_BYTES(channels));
+        case PROTO_DATA_ENC_DELTA:
+            return PROTO_HEADER_BYTES + data_body_offset(encoding) +
+                ((channels + 1U) * sample_codec_max_bytes(n));
+        default:
+            return 0U;
+    }
+}
+
+int proto_data_encoder_init(proto_data_encoder_t *enc, uint16_t encoding, uint32_t channels, uint32_t capacity)
+{
+    if (channels == 0U) {
+        channels = ADS1278_CHANNEL_COUNT;
+    }
+    if (enc == NULL || capacity == 0U || proto_data_max_bytes(encoding, channels, capacity) == 0U) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    memset(enc, 0, sizeof(*enc));
+    enc->encoding = encoding;
+    enc->channels = (uint16_t)channels;
+    enc->capacity = capacity;
+    if (has_base_tstamp(encoding)) {
+        enc->ts_deltas = calloc(capacity, sizeof(*enc->ts_deltas));
+        if (enc->ts_deltas == NULL) {
+            return -1;
+        }
+    }
+    if (encoding == PROTO_DATA_ENC_DELTA) {
+        uint32_t channel;
+
+        enc->ch[0] = calloc((size_t)capacity * channels, sizeof(*enc->ch[0]));
+        if (enc->ch[0] == NULL) {
+            proto_data_encoder_destroy(enc);
+            return -1;
+        }
+        for (channel = 1U; channel < channels; ++channel) {
+            enc->ch[channel] = enc->ch[0] + ((size_t)channel * capacity);
+        }
+    }
+    return 0;
+}
+
+void proto_data_encoder_destroy(proto_data_encoder_t *enc)
+{
+    if (enc != NULL) {
+        free(enc->ts_deltas);
+        free(enc->ch[0]);
+        memset(enc->ch, 0, sizeof(enc->ch));
+        enc->ts_deltas = NULL;
+    }
+}
+
+void proto_data_begin(proto_data_encoder_t *enc, uint8_t *msg, uint32_t msg_seq, const ads1278_frame_t *first)
+{
+    uint8_t *payload = msg + PROTO_HEADER_BYTES;
+
+    enc->msg = msg;
+    enc->count = 0U;
+    enc->gap_count = 0U;
+    enc->next_seq = first->seq;
+    enc->last_tstamp_ns = first->tstamp_ns;
+
+    encode_simple_header(msg, PROTO_MSG_DATA, msg_seq, 0U);
+    proto_store_u64(payload, first->seq);
+    proto_store_u16(payload + 12, enc->encoding);
+    proto_store_u16(payload + 14, enc->channels);
+    if (has_base_tstamp(enc->encoding)) {
+        proto_store_u64(payload + PROTO_DATA_HEADER_BYTES, first->tstamp_ns);
+    }
+}
+
+static void store_record48(uint8_t *dst, const ads1278_frame_t *frames, size_t n)
+{
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+    /* An ads1278_frame_t starts with exactly a record on little-endian targets. */
+#if ADS1278_MAX_CHAIN == 1
+    memcpy(dst, frames, n * PROTO_RECORD48_BYTES);
+#else
+    size_t idx;
+
+    for (idx = 0U; idx < n; ++idx) {
+        memcpy(dst + (idx * PROTO_RECORD48_BYTES), &frames[idx], PROTO_RECORD48_BYTES);
+    }
+#endif
+#else
+    size_t idx;
+    uint32_t channel;
+
+    for (idx = 0U; idx < n; ++idx) {
+        proto_store_u64(dst, frames[idx].seq);
+        proto_store_u64(dst + 8, frames[idx].tstamp_ns);
+        for (channel = 0U; channel < ADS1278_CHANNEL_COUNT; ++channel) {
+            proto_store_u32(dst + 16U + (channel * 4U), (uint32_t)frames[idx].ch[channel]);
+        }
+        dst += PROTO_RECORD48_BYTES;
+    }
+#endif
+}
+
+/*
+ * Time going backwards or >4 s needs a new base. A forward seq gap is noted
+ * in the gap list while there is room; otherwise it needs a new first_seq.
+ */
+static bool frame_fits_implied(proto_data_encoder_t *enc, const ads1278_frame_t *frame)
+{
+    uint64_t skipped;
+
+    if (frame->tstamp_ns < enc->last_tstamp_ns || frame->tstamp_ns - enc->last_tstamp_ns > UINT32_MAX) {
+        return false;
+    }
+    if (frame->seq == enc->next_seq) {
+        return true;
+    }
+    skipped = frame->seq - enc->next_seq;
+    if (frame->seq < enc->next_seq || skipped > UINT32_MAX || enc->gap_count >= enc->max_gaps) {
+        return false;
+    }
+    enc->gap_frame[enc->gap_count] = enc->count;
+    enc->gap_skipped[enc->gap_count] = (uint32_t)skipped;
+    ++enc->gap_count;
+    return true;
+}
+
+static size_t append_p24(proto_data_encoder_t *enc, const ads1278_frame_t *frames, size_t n)
+{
+    uint8_t *dst = enc->msg + PROTO_HEADER_BYTES + data_body_offset(enc->encoding) +
+        ((size_t)enc->count * enc->channels * 3U);
+    size_t idx;
+
+    for (idx = 0U; idx < n && enc->count < enc->capacity; ++idx) {
+        const ads1278_frame_t *frame = &frames[idx];
+        uint64_t delta = frame->tstamp_ns - enc->last_tstamp_ns;
+        uint32_t channel;
+
+        if (!frame_fits_implied(enc, frame)) {
+            break;
+        }
+
+        for (channel = 0U; channel < enc->channels; ++channel) {
+            uint32_t value = (uint32_t)frame->ch[channel];
+
+            dst[0] = (uint8_t)(value >> 16U);
+            dst[1] = (uint8_t)(value >> 8U);
+            dst[2] = (uint8_t)value;
+            dst += 3;
+        }
+        enc->ts_deltas[enc->count++] = (uint32_t)delta;
+        enc->next_seq = frame->seq + 1U;
+        enc->last_tstamp_ns = frame->tstamp_ns;
+    }
+
+    return idx;
+}
+
+static size_t append_delta(proto_data_encoder_t *enc, const ads1278_frame_t *frames, size_t n)
+{
+    size_t idx;
+
+    for (idx = 0U; idx < n && enc->count < enc->capacity; ++idx) {
+        const ads1278_frame_t *frame = &frames[idx];
+        uint32_t channel;
+
+        if (!frame_fits_implied(enc, frame)) {
+            break;
+        }
+        for (channel = 0U; channel < enc->channels; ++channel) {
+            enc->ch[channel][enc->count] = frame->ch[channel];
+        }
+        enc->ts_deltas[enc->count++] = (uint32_t)(frame->tstamp_ns - enc->last_tstamp_ns);
+        enc->next_seq = frame->seq + 1U;
+        enc->last_tstamp_ns = frame->tstamp_ns;
+    }
+
+    return idx;
+}
+
+size_t proto_data_append(proto_data_encoder_t *enc, const ads1278_frame_t *frames, size_t n)
+{
+    size_t room = enc->capacity - enc->count;
+
+    if (enc->encoding == PROTO_DATA_ENC_P24) {
+        return append_p24(enc, frames, n);
+    }
+    if (enc->encoding == PROTO_DATA_ENC_DELTA) {
+        return append_delta(enc, frames, n);
+    }
+
+    n = (n < room) ? n : room;
+    store_record48(enc->msg + PROTO_HEADER_BYTES + data_body_offset(enc->encoding) +
+        ((size_t)enc->count * PROTO_RECORD48_BYTES), frames, n);
+    enc->count += (uint32_t)n;
+    return n;
+}
+
+/*
+ * Frame timestamps of a linear_ts message, stepped one seq at a time without
+ * a division per frame. seq_span is last_seq - first_seq (n - 1 without gaps).
+ */
+typedef struct {
+    uint64_t tstamp_ns;
+    uint64_t step;              /* (last - base) / seq_span */
+    uint64_t rem_step;          /* (last - base) % seq_span */
+    uint64_t rem;
+    uint64_t div;               /* seq_span */
+} linear_ts_t;
+
+static void linear_ts_init(linear_ts_t *lin, uint64_t base_ns, uint64_t last_ns, uint64_t seq_span, uint64_t first)
+{
+    uint64_t span = last_ns - base_ns;
+    uint64_t acc;
+
+    lin->div = seq_span;
+    lin->step = span / lin->div;
+    lin->rem_step = span % lin->div;
+    acc = (first * lin->rem_step) + (lin->div / 2U);
+    lin->tstamp_ns = base_ns + (first * lin->step) + (acc / lin->div);
+    lin->rem = acc % lin->div;
+}
+
+/* Step over the seq values a gap skipped. */
+static void linear_ts_skip(linear_ts_t *lin, uint64_t skipped)
+{
+    uint64_t acc = lin->rem + (skipped * lin->rem_step);
+
+    lin->tstamp_ns += (skipped * lin->step) + (acc / lin->div);
+    lin->rem = acc % lin->div;
+}
+
+static inline uint64_t linear_ts_next(linear_ts_t *lin)
+{
+    uint64_t tstamp_ns = lin->tstamp_ns;
+
+    lin->tstamp_ns += lin->step;
+    lin->rem += lin->rem_step;
+    if (lin->rem >= lin->div) {
+        lin->rem -= lin->div;
+        ++lin->tstamp_ns;
+    }
+    return tstamp_ns;
+}
+
+/* Staged timestamps all within linear_tolerance_ns of the first-to-last line. */
+static bool staged_ts_linear(const proto_data_encoder_t *enc, uint64_t first_seq, uint64_t base_ns)
+{
+    linear_ts_t lin;
+    uint64_t tstamp_ns = base_ns;
+    uint32_t gap = 0U;
+    uint32_t idx;
+
+    if (!enc->linear_ts || enc->count < 3U || enc->encoding == PROTO_DATA_ENC_RECORD48) {
+        return false;
+    }
+    linear_ts_init(&lin, base_ns, enc->last_tstamp_ns, enc->next_seq - 1U - first_seq, 0U);
+    for (idx = 0U; idx < enc->count; ++idx) {
+        uint64_t line_ns;
+
+        if (gap < enc->gap_count && enc->gap_frame[gap] == idx) {
+            linear_ts_skip(&lin, enc->gap_skipped[gap++]);
+        }
+        line_ns = linear_ts_next(&lin);
+
+        tstamp_ns += enc->ts_deltas[idx];
+        if (((tstamp_ns > line_ns) ? tstamp_ns - line_ns : line_ns - tstamp_ns) > enc->linear_tolerance_ns) {
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t proto_data_finish(proto_data_encoder_t *enc)
+{
+    size_t total = proto_data_max_bytes(enc->encoding, enc->channels, enc->count);
+    uint8_t *payload = enc->msg + PROTO_HEADER_BYTES;
+    bool linear = staged_ts_linear(enc, proto_load_u64(payload), proto_load_u64(payload + PROTO_DATA_HEADER_BYTES));
+    uint16_t encoding = enc->encoding;
+
+    if (enc->encoding == PROTO_DATA_ENC_DELTA) {
+        uint8_t *dst = payload + data_body_offset(enc->encoding);
+        uint32_t channel;
+
+        for (channel = 0U; channel < enc->channels; ++channel) {
+            dst += sample_codec_encode(enc->ch[channel], 1U, enc->count, dst);
+        }
+        if (linear) {
+            proto_store_u64(dst, enc->last_tstamp_ns);
+            dst += PROTO_DATA_LINEAR_TS_BYTES;
+        } else {
+            dst += sample_codec_encode((const int32_t *)enc->ts_deltas, 1U, enc->count, dst);
+        }
+        total = (size_t)(dst - enc->msg);
+    } else if (enc->encoding == PROTO_DATA_ENC_P24) {
+        uint8_t *dst = payload + data_body_offset(enc->encoding) + ((size_t)enc->count * enc->channels * 3U);
+        uint32_t idx;
+
+        if (linear) {
+            proto_store_u64(dst, enc->last_tstamp_ns);
+            total = (size_t)(dst - enc->msg) + PROTO_DATA_LINEAR_TS_BYTES;
+        } else {
+            for (idx = 0U; idx < enc->count; ++idx) {
+                proto_store_u32(dst + (idx * 4U), enc->ts_deltas[idx]);
+            }
+        }
+    }
+    if (enc->gap_count != 0U) {
+        uint8_t *dst = enc->msg + total;
+        uint32_t gap;
+
+        for (gap = 0U; gap < enc->gap_count; ++gap) {
+            proto_store_u32(dst, enc->gap_frame[gap]);
+            proto_store_u32(dst + 4, enc->gap_skipped[gap]);
+            dst += PROTO_DATA_GAP_ENTRY_BYTES;
+        }
+        proto_store_u32(dst, enc->gap_count);
+        total += PROTO_DATA_GAPS_BYTES(enc->gap_count);
+        encoding |= PROTO_DATA_SEQ_GAPS;
+    }
+    if (linear) {
+        encoding |= PROTO_DATA_LINEAR_TS;
+        ++enc->linear_msgs;
+    }
+    proto_store_u16(payload + 12, encoding);
+    proto_store_u32(enc->msg + 12, (uint32_t)(total - PROTO_HEADER_BYTES));
+    proto_store_u32(payload + 8, enc->count);
+    enc->msg = NULL;
+    return total;
+}
+
+size_t proto_event_max_bytes(uint16_t encoding, uint32_t channels, size_t n)
+{
+    size_t data = proto_data_max_bytes(encoding, channels, n);
+
+    return (data == 0U) ? 0U : PROTO_HEADER_BYTES + PROTO_EVENT_HEADER_BYTES + data;
+}
+
+size_t proto_encode_event(uint8_t *dst, uint32_t msg_seq, proto_event_t *event, proto_data_encoder_t *enc,
+                          const ads1278_frame_t *frames, size_t n)
+{
+    uint8_t *payload = dst + PROTO_HEADER_BYTES;
+    size_t data_len;
+
+    proto_data_begin(enc, payload + PROTO_EVENT_HEADER_BYTES, 0U, &frames[0]);
+    event->frame_count = (uint32_t)proto_data_append(enc, frames, n);
+    data_len = proto_data_finish(enc);
+
+    encode_simple_header(dst, PROTO_MSG_EVENT, msg_seq, (uint32_t)(PROTO_EVENT_HEADER_BYTES + data_len));
+    proto_store_u64(payload, event->event_id);
+    proto_store_u64(payload + 8, event->trigger_seq);
+    proto_store_u64(payload + 16, event->trigger_tstamp_ns);
+    proto_store_u32(payload + 24, event->frame_count);
+    proto_store_u32(payload + 28, event->pre_frames);
+    proto_store_u16(payload + 32, event->condition);
+    proto_store_u16(payload + 34, event->channel);
+    proto_store_u32(payload + 36, 0U);
+    return PROTO_HEADER_BYTES + PROTO_EVENT_HEADER_BYTES + data_len;
+}
+
+int proto_decode_event(const uint8_t *payload, size_t len, proto_event_info_t *info)
+{
+    proto_header_t hdr;
+
+    if (len < PROTO_EVENT_HEADER_BYTES + PROTO_HEADER_BYTES ||
+        proto_decode_header(payload + PROTO_EVENT_HEADER_BYTES, &hdr) != 0 || hdr.type != PROTO_MSG_DATA ||
+        hdr.payload_len != len - PROTO_EVENT_HEADER_BYTES - PROTO_HEADER_BYTES) {
+        errno = EPROTO;
+        return -1;
+    }
+
+    memset(&info->event, 0, sizeof(info->event));
+    info->event.event_id = proto_load_u64(payload);
+    info->event.trigger_seq = proto_load_u64(payload + 8);
+    info->event.trigger_tstamp_ns = proto_load_u64(payload + 16);
+    info->event.frame_count = proto_load_u32(payload + 24);
+    info->event.pre_frames = proto_load_u32(payload + 28);
+    info->event.condition = proto_load_u16(payload + 32);
+    info->event.channel = proto_load_u16(payload + 34);
+    if (proto_decode_data_info(payload + PROTO_EVENT_HEADER_BYTES + PROTO_HEADER_BYTES, hdr.payload_len,
+                               &info->data) != 0 ||
+        info->data.frame_count != info->event.frame_count) {
+        errno = EPROTO;
+        return -1;
+    }
+    return 0;
+}
+
+/*
+ * Walk the channel_count + 1 codec streams (channel_count and the u64 last
+ * timestamp when linear); they must fill the payload exactly.
+ */
+static int decode_delta_info(const uint8_t *payload, size_t len, proto_data_info_t *info)
+{
+    size_t pos = data_body_offset(PROTO_DATA_ENC_DELTA);
+    uint32_t streams = info->channel_count + (info->linear_ts ? 0U : 1U);
+    uint32_t idx;
+
+    if (len < pos || info->frame_count > PROTO_MAX_PAYLOAD_BYTES) {
+        errno = EPROTO;
+        return -1;
+    }
+    info->base_tstamp_ns = proto_load_u64(payload + PROTO_DATA_HEADER_BYTES);
+    for (idx = 0U; idx < streams; ++idx) {
+        size_t used = sample_codec_stream_bytes(payload + pos, len - pos, info->frame_count);
+
+        if (used == 0U && info->frame_count != 0U) {
+            errno = EPROTO;
+            return -1;
+        }
+        info->streams[idx] = payload + pos;
+        pos += used;
+    }
+    if (info->linear_ts) {
+        if (len - pos != PROTO_DATA_LINEAR_TS_BYTES) {
+            errno = EPROTO;
+            return -1;
+        }
+        info->last_tstamp_ns = proto_load_u64(payload + pos);
+        pos += PROTO_DATA_LINEAR_TS_BYTES;
+    }
+    if (pos != len) {
+        errno = EPROTO;
+        return -1;
+    }
+    return 0;
+}
+
+/* Check the trailing gap list and take it off the payload length. */
+static int decode_gap_list(const uint8_t *payload, size_t *len, proto_data_info_t *info)
+{
+    uint32_t prev = 0U;
+    uint32_t gap;
+
+    if (*len < PROTO_DATA_HEADER_BYTES + PROTO_DATA_GAPS_BYTES(0U)) {
+        return -1;
+    }
+    info->gap_count = proto_load_u32(payload + *len - 4U);
+    if (info->gap_count == 0U || info->gap_count >= info->frame_count ||
+        (*len - PROTO_DATA_HEADER_BYTES - 4U) / PROTO_DATA_GAP_ENTRY_BYTES < info->gap_count) {
+        return -1;
+    }
+    *len -= PROTO_DATA_GAPS_BYTES(info->gap_count);
+    info->gaps = payload + *len;
+    for (gap = 0U; gap < info->gap_count; ++gap) {
+        uint32_t frame = proto_load_u32(info->gaps + (gap * PROTO_DATA_GAP_ENTRY_BYTES));
+        uint32_t skipped = proto_load_u32(info->gaps + (gap * PROTO_DATA_GAP_ENTRY_BYTES) + 4U);
+
+        if (frame <= prev || frame >= info->frame_count || skipped == 0U) {
+            return -1;
+        }
+        info->skipped += skipped;
+        prev = frame;
+    }
+    return 0;
+}
+
+int proto_decode_data_info(const uint8_t *payload, size_t len, proto_data_info_t *info)
+{
+    size_t body;
+    size_t expect;
+    uint16_t encoding;
+
+    if (len < PROTO_DATA_HEADER_BYTES) {
+        errno = EPROTO;
+        return -1;
+    }
+
+    memset(info, 0, sizeof(*info));
+    info->first_seq = proto_load_u64(payload);
+    info->frame_count = proto_load_u32(payload + 8);
+    encoding = proto_load_u16(payload + 12);
+    info->channel_count = proto_load_u16(payload + 14);
+    info->linear_ts = (encoding & PROTO_DATA_LINEAR_TS) != 0U;
+    info->encoding = encoding & PROTO_DATA_ENC_MASK;
+    if (info->channel_count == 0U) {
+        info->channel_count = ADS1278_CHANNEL_COUNT;
+    }
+    if (!channels_valid(info->encoding, info->channel_count) ||
+        (info->linear_ts && (!has_base_tstamp(info->encoding) || info->frame_count < 2U))) {
+        errno = EPROTO;
+        return -1;
+    }
+    if ((encoding & PROTO_DATA_SEQ_GAPS) != 0U &&
+        (!has_base_tstamp(info->encoding) || decode_gap_list(payload, &len, info) != 0)) {
+        errno = EPROTO;
+        return -1;
+    }
+    if (info->encoding == PROTO_DATA_ENC_DELTA) {
+        if (decode_delta_info(payload, len, info) != 0) {
+            return -1;
+        }
+        goto check_linear;
+    }
+    if (info->frame_count > PROTO_MAX_PAYLOAD_BYTES / PROTO_P24_FRAME_BYTES(ADS1278_CHANNEL_COUNT)) {
+        errno = EPROTO;
+        return -1;
+    }
+    expect = proto_data_max_bytes(info->encoding, info->channel_count, info->frame_count);
+    if (info->linear_ts) {
+        expect -= ((size_t)info->frame_count * 4U) - PROTO_DATA_LINEAR_TS_BYTES;
+    }
+    if (expect != PROTO_HEADER_BYTES + len) {
+        errno = EPROTO;
+        return -1;
+    }
+
+    body = data_body_offset(info->encoding);
+    info->frames = payload + body;
+    if (info->encoding == PROTO_DATA_ENC_P24) {
+        const uint8_t *tail = info->frames + ((size_t)info->frame_count * info->channel_count * 3U);
+
+        info->base_tstamp_ns = proto_load_u64(payload + PROTO_DATA_HEADER_BYTES);
+        if (info->linear_ts) {
+            info->last_tstamp_ns = proto_load_u64(tail);
+        } else {
+            info->ts_deltas = tail;
+        }
+    }
+
+check_linear:
+    if (info->linear_ts && info->last_tstamp_ns < info->base_tstamp_ns) {
+        errno = EPROTO;
+        return -1;
+    }
+    return 0;
+}
+
+/* Seq of frame pos counting the gaps before it; *gap is the first entry at or after pos. */
+static uint64_t seq_at(const proto_data_info_t *info, uint32_t pos, uint32_t *gap)
+{
+    uint64_t seq = info->first_seq + pos;
+    uint32_t idx;
+
+    for (idx = 0U; idx < info->gap_count; ++idx) {
+        const uint8_t *entry = info->gaps + (idx * PROTO_DATA_GAP_ENTRY_BYTES);
+
+        if (proto_load_u32(entry) >= pos) {
+            break;
+        }
+        seq += proto_load_u32(entry + 4U);
+    }
+    *gap = idx;
+    return seq;
+}
+
+/* Seq values skipped right before frame pos (0 without a gap there); advances *gap. */
+static uint32_t gap_before(const proto_data_info_t *info, uint32_t pos, uint32_t *gap)
+{
+    const uint8_t *entry;
+
+    if (*gap >= info->gap_count) {
+        return 0U;
+    }
+    entry = info->gaps + (*gap * PROTO_DATA_GAP_ENTRY_BYTES);
+    if (proto_load_u32(entry) != pos) {
+        return 0U;
+    }
+    ++*gap;
+    return proto_load_u32(entry + 4U);
+}
+
+static uint64_t seq_span(const proto_data_info_t *info)
+{
+    return (uint64_t)info->frame_count - 1U + info->skipped;
+}
+
+/* Frames are decoded SAMPLE_CODEC_GROUP at a time, one reader per stream. */
+static void decode_delta_frames(const proto_data_info_t *info, uint32_t first, uint32_t n, ads1278_frame_t *out)
+{
+    sample_codec_reader_t rd[PROTO_DELTA_MAX_STREAMS];
+    int32_t vals[SAMPLE_CODEC_GROUP];
+    uint64_t tstamp_ns = info->base_tstamp_ns;
+    uint32_t channels = info->channel_count;
+    linear_ts_t lin = {0};
+    uint32_t gap;
+    uint64_t seq = seq_at(info, first, &gap);
+    uint32_t stream;
+    uint32_t done;
+    uint32_t idx;
+
+    for (stream = 0U; stream < channels; ++stream) {
+        sample_codec_reader_init(&rd[stream], info->streams[stream], info->frame_count);
+        sample_codec_read(&rd[stream], first, NULL, 0U);
+    }
+    if (info->linear_ts) {
+        linear_ts_init(&lin, info->base_tstamp_ns, info->last_tstamp_ns, seq_span(info), seq - info->first_seq);
+    } else {
+        sample_codec_reader_init(&rd[channels], info->streams[channels], info->frame_count);
+    }
+    for (done = 0U; done < first && !info->linear_ts; done += SAMPLE_CODEC_GROUP) {
+        uint32_t chunk = (first - done < SAMPLE_CODEC_GROUP) ? first - done : SAMPLE_CODEC_GROUP;
+
+        sample_codec_read(&rd[channels], chunk, vals, 1U);
+        for (idx = 0U; idx < chunk; ++idx) {
+            tstamp_ns += (uint32_t)vals[idx];
+        }
+    }
+
+    for (done = 0U; done < n; done += SAMPLE_CODEC_GROUP) {
+        uint32_t chunk = (n - done < SAMPLE_CODEC_GROUP) ? n - done : SAMPLE_CODEC_GROUP;
+
+        for (stream = 0U; stream < channels; ++stream) {
+            sample_codec_read(&rd[stream], chunk, vals, 1U);
+            for (idx = 0U; idx < chunk; ++idx) {
+                out[done + idx].ch[stream] = vals[idx];
+            }
+        }
+        if (info->linear_ts) {
+            for (idx = 0U; idx < chunk; ++idx) {
+                uint32_t skipped = gap_before(info, first + done + idx, &gap);
+
+                if (skipped != 0U) {
+                    linear_ts_skip(&lin, skipped);
+                }
+                seq += skipped;
+                out[done + idx].seq = seq++;
+                out[done + idx].tstamp_ns = linear_ts_next(&lin);
+            }
+            continue;
+        }
+        sample_codec_read(&rd[channels], chunk, vals, 1U);
+        for (idx = 0U; idx < chunk; ++idx) {
+            tstamp_ns += (uint32_t)vals[idx];
+            seq += gap_before(info, first + done + idx, &gap);
+            out[done + idx].seq = seq++;
+            out[done + idx].tstamp_ns = tstamp_ns;
+        }
+    }
+}
+
+void proto_data_decode_frames(const proto_data_info_t *info, uint32_t first, uint32_t n, ads1278_frame_t *out)
+{
+    uint64_t tstamp_ns = info->base_tstamp_ns;
+    uint32_t gap;
+    uint64_t seq;
+    uint32_t idx;
+
+    if (info->encoding == PROTO_DATA_ENC_RECORD48) {
+        for (idx = 0U; idx < n; ++idx) {
+            const uint8_t *src = info->frames + ((size_t)(first + idx) * PROTO_RECORD48_BYTES);
+            uint32_t channel;
+
+            out[idx].seq = proto_load_u64(src);
+            out[idx].tstamp_ns = proto_load_u64(src + 8);
+            for (channel = 0U; channel < ADS1278_CHANNEL_COUNT; ++channel) {
+                out[idx].ch[channel] = (int32_t)proto_load_u32(src + 16U + (channel * 4U));
+            }
+        }
+        return;
+    }
+
+    if (info->encoding == PROTO_DATA_ENC_DELTA) {
+        decode_delta_frames(info, first, n, out);
+        return;
+    }
+
+    seq = seq_at(info, first, &gap);
+    if (info->linear_ts) {
+        linear_ts_t lin;
+
+        linear_ts_init(&lin, info->base_tstamp_ns, info->last_tstamp_ns, seq_span(info), seq - info->first_seq);
+        for (idx = 0U; idx < n; ++idx) {
+            uint32_t pos = first + idx;
+            uint32_t skipped = gap_before(info, pos, &gap);
+
+            if (skipped != 0U) {
+                linear_ts_skip(&lin, skipped);
+            }
+            seq += skipped;
+            out[idx].seq = seq++;
+            out[idx].tstamp_ns = linear_ts_next(&lin);
+            ads1278_unpack_frames(info->frames + ((size_t)pos * info->channel_count * 3U),
+                info->channel_count / ADS1278_CHANNEL_COUNT, out[idx].ch);
+        }
+        return;
+    }
+
+    for (idx = 0U; idx < first; ++idx) {
+        tstamp_ns += proto_load_u32(info->ts_deltas + (idx * 4U));
+    }
+    for (idx = 0U; idx < n; ++idx) {
+        uint32_t pos = first + idx;
+
+        tstamp_ns += proto_load_u32(info->ts_deltas + (pos * 4U));
+        seq += gap_before(info, pos, &gap);
+        out[idx].seq = seq++;
+        out[idx].tstamp_ns = tstamp_ns;
+        ads1278_unpack_frames(info->frames + ((size_t)pos * info->channel_count * 3U),
+            info->channel_count / ADS1278_CHANNEL_COUNT, out[idx].ch);
+    }
+}
+
+uint64_t proto_data_frame_seq(const proto_data_info_t *info, uint32_t idx)
+{
+    uint32_t gap;
+    uint64_t seq = seq_at(info, idx, &gap);
+
+    return seq + gap_before(info, idx, &gap);
+}
+
+uint64_t proto_data_linear_tstamp(const proto_data_info_t *info, uint32_t idx)
+{
+    linear_ts_t lin;
+
+    linear_ts_init(&lin, info->base_tstamp_ns, info->last_tstamp_ns, seq_span(info),
+                   proto_data_frame_seq(info, idx) - info->first_seq);
+    return lin.tstamp_ns;
+}
+
+void proto_data_p24_samples_soa(const proto_data_info_t *info, int32_t *const ch[ADS1278_MAX_CHANNELS])
+{
+    uint32_t devices = info->channel_count / ADS1278_CHANNEL_COUNT;
+    int32_t frame[ADS1278_MAX_CHANNELS];
+    uint32_t idx;
+
+    if (devices == 1U) {
+        ads1278_unpack_frames_soa(info->frames, info->frame_count, ch);
+        return;
+    }
+    /* Chained frames interleave devices; the SoA kernels want one device's frames contiguous. */
+    for (idx = 0U; idx < info->frame_count; ++idx) {
+        uint32_t channel;
+
+        ads1278_unpack_frames(info->frames + ((size_t)idx * info->channel_count * 3U), devices, frame);
+        for (channel = 0U; channel < info->channel_count; ++channel) {
+            ch[channel][idx] = frame[channel];
+        }
+    }
+}
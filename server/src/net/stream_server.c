@@ -0,0 +1,1637 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Miguel Dovale (University of Arizona)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/* TCP_CORK is a Linux extension hidden by a strict _POSIX_C_SOURCE. */
+#define _DEFAULT_SOURCE
+
+#include "stream_server.h"
+#include "uring.h"
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <sys/uio.h>
+#include <time.h>
+#include <unistd.h>
+
+#define LATENCY_FRAMES_PER_MSG 16U
+#define LATENCY_FLUSH_US 1000U
+#define THROUGHPUT_FRAMES_PER_MSG 512U
+#define THROUGHPUT_FLUSH_US 20000U
+
+#define STREAM_LISTEN_BACKLOG 16
+#define STREAM_EPOLL_EVENTS 32
+#define STREAM_RX_BYTES 512U
+#define STREAM_MAX_HISTORY_MSGS (1U << 20)  /* slot ring ceiling when sized from frames or bytes */
+#define STREAM_DECIM_BATCH_FRAMES 512U    /* also the trigger's batch */
+
+/* epoll tags below STREAM_TAG_CLIENT0; client i is STREAM_TAG_CLIENT0 + i. */
+#define STREAM_TAG_LISTEN 0U
+#define STREAM_TAG_TIMER 1U
+#define STREAM_TAG_STOP 2U
+#define STREAM_TAG_CLIENT0 3U
+
+#define PREAMBLE_BYTES (PROTO_HEADER_BYTES + PROTO_HELLO_BYTES + PROTO_HEADER_BYTES + PROTO_CONFIG_BYTES)
+
+typedef struct {
+    uint8_t *buf;               /* in the arena */
+    size_t len;
+    uint64_t publish_ns;        /* CLOCK_MONOTONIC when it became sendable */
+    uint64_t first_seq;         /* first frame of a DATA/EVENT message */
+    uint32_t frames;            /* 0 for other messages */
+} stream_msg_t;
+
+typedef struct {
+    int fd;                     /* -1 = free slot */
+    uint64_t cursor;            /* next history message to send */
+    size_t offset;              /* bytes of history[cursor] already sent */
+    uint8_t *spill;             /* tail of a message reclaimed mid-send */
+    size_t spill_len;
+    size_t spill_off;
+    size_t preamble_off;
+    uint8_t gap_msg[PROTO_HEADER_BYTES + PROTO_GAP_BYTES]; /* GAP being sent */
+    size_t gap_len;
+    size_t gap_off;
+    proto_gap_t gap;            /* not yet encoded; first_msg_seq + msg_count == cursor */
+    bool gap_pending;
+    uint8_t rx[PROTO_HEADER_BYTES + PROTO_SUBSCRIBE_BYTES]; /* client message being read */
+    size_t rx_fill;
+    uint32_t rx_skip;           /* payload bytes of an ignored message still to discard */
+    bool want_out;              /* EPOLLOUT armed */
+    stream_session_stats_t session;
+    uint64_t resume_ns; /* replayed messages age from here, not from publish */
+} stream_client_t;
+
+struct stream_server {
+    stream_server_cfg_t cfg;
+    acq_t *acq;
+    int listen_fd;
+    int epoll_fd;
+    int timer_fd;
+    int stop_fd;
+    uint16_t port;
+
+    uint8_t *storage;           /* message arena and client spill buffers */
+    size_t msg_capacity;
+    uint8_t *arena;             /* history messages, laid out in msg_seq order and wrapping */
+    size_t arena_bytes;
+    size_t arena_pos;           /* where the next message starts */
+    stream_msg_t *history;
+    uint64_t history_mask;
+    uint64_t tail;              /* oldest kept message */
+    uint64_t head;              /* message being filled; [tail, head) are sendable */
+    uint64_t history_frames;    /* DATA/EVENT frames in [tail, head) */
+    proto_data_encoder_t enc;   /* enc.count frames are in history[head] */
+    uint32_t channels;          /* per frame sent: 8 per chained device, or those --decim selects */
+    decim_t *decim;
+    ads1278_frame_t *decim_out; /* STREAM_DECIM_BATCH_FRAMES + 1 decimator outputs */
+    trigger_t *trigger;
+    trigger_cfg_t trigger_cfg;
+    chan_stats_t *chan_stats;   /* SUMMARY accumulators, NULL without summary_ms */
+    chan_calib_t calib;
+    psd_t *psd;                 /* SPECTRUM source, NULL without cfg.psd */
+    udp_sender_t *udp;          /* datagram copy of the DATA stream, NULL without cfg.udp */
+    uring_t *uring;             /* batched fan-out sends, NULL = one sendmsg() per client */
+    struct iovec *uring_iov;    /* STREAM_IOV_MAX per client */
+    struct msghdr *uring_msg;   /* per client, live until its completion is reaped */
+    size_t *uring_want;
+    bool *uring_queued;
+    uring_cqe_t *uring_cqes;
+
+    stream_client_t *clients;
+    uint32_t client_count;
+    uint64_t next_session_id;
+    stream_session_stats_t closed[STREAM_SESSION_LOG];
+    uint64_t closed_count;
+
+    uint8_t preamble[PREAMBLE_BYTES];
+    bool acq_started;
+    bool eos;
+    uint64_t next_stats_ns;
+    uint64_t next_summary_ns;
+    lat_recorder_t net_send;
+    stream_server_stats_t stats;
+};
+
+static uint64_t monotonic_ns(void)
+{
+    struct timespec ts;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+static int set_nonblocking(int fd)
+{
+    int flags = fcntl(fd, F_GETFL, 0);
+
+    if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) != 0) {
+        return -1;
+    }
+    return 0;
+}
+
+static int epoll_add(int epoll_fd, int fd, uint32_t events, uint32_t tag)
+{
+    struct epoll_event ev;
+
+    memset(&ev, 0, sizeof(ev));
+    ev.events = events;
+    ev.data.u32 = tag;
+    return epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev);
+}
+
+static void set_tcp_opt(int fd, int opt, int value)
+{
+    (void)setsockopt(fd, IPPROTO_TCP, opt, &value, sizeof(value));
+}
+
+static bool client_caught_up(const stream_server_t *srv, const stream_client_t *client)
+{
+    return client->preamble_off == sizeof(srv->preamble) &&
+        client->spill_off == client->spill_len &&
+        client->gap_off == client->gap_len && !client->gap_pending &&
+        client->cursor == srv->head;
+}
+
+static void client_open(stream_server_t *srv, stream_client_t *client, int fd, const struct sockaddr_in *peer)
+{
+    char addr[INET_ADDRSTRLEN];
+    uint8_t *spill = client->spill;
+
+    memset(client, 0, sizeof(*client));
+    client->fd = fd;
+    client->spill = spill;
+    /* New clients join live at the message being filled. */
+    client->cursor = srv->head;
+    client->session.id = ++srv->next_session_id;
+    client->session.policy = srv->cfg.policy;
+    client->session.max_lag_ms = srv->cfg.max_lag_ms;
+    if (inet_ntop(AF_INET, &peer->sin_addr, addr, sizeof(addr)) == NULL) {
+        strcpy(addr, "?");
+    }
+    (void)snprintf(client->session.peer, sizeof(client->session.peer), "%s:%u", addr,
+                   (unsigned int)ntohs(peer->sin_port));
+    ++srv->client_count;
+    ++srv->stats.clients_accepted;
+}
+
+static void client_close(stream_server_t *srv, stream_client_t *client, stream_close_t reason)
+{
+    (void)epoll_ctl(srv->epoll_fd, EPOLL_CTL_DEL, client->fd, NULL);
+    (void)close(client->fd);
+    client->fd = -1;
+    client->session.closed = reason;
+    srv->closed[srv->closed_count++ % STREAM_SESSION_LOG] = client->session;
+    --srv->client_count;
+    ++srv->stats.clients_closed;
+}
+
+static void client_arm_out(stream_server_t *srv, stream_client_t *client, bool want_out)
+{
+    struct epoll_event ev;
+
+    if (client->want_out == want_out) {
+        return;
+    }
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN | EPOLLRDHUP | (want_out ? EPOLLOUT : 0U);
+    ev.data.u32 = STREAM_TAG_CLIENT0 + (uint32_t)(client - srv->clients);
+    (void)epoll_ctl(srv->epoll_fd, EPOLL_CTL_MOD, client->fd, &ev);
+    client->want_out = want_out;
+}
+
+static void client_advance(stream_server_t *srv, stream_client_t *client, size_t sent, uint64_t now)
+{
+    size_t n;
+
+    client->session.bytes_sent += sent;
+
+    n = sizeof(srv->preamble) - client->preamble_off;
+    n = (sent < n) ? sent : n;
+    client->preamble_off += n;
+    sent -= n;
+
+    n = client->spill_len - client->spill_off;
+    n = (sent < n) ? sent : n;
+    client->spill_off += n;
+    sent -= n;
+
+    n = client->gap_len - client->gap_off;
+    n = (sent < n) ? sent : n;
+    client->gap_off += n;
+    sent -= n;
+
+    while (sent > 0U) {
+        const stream_msg_t *msg = &srv->history[client->cursor & srv->history_mask];
+
+        n = msg->len - client->offset;
+        if (sent < n) {
+            client->offset += sent;
+            break;
+        }
+        sent -= n;
+        client->offset = 0U;
+        ++client->cursor;
+        ++client->session.msgs_sent;
+        lat_recorder_record(&srv->net_send, (now > msg->publish_ns) ? now - msg->publish_ns : 0U);
+    }
+}
+
+/*
+ * Next sendmsg() of a client's backlog: preamble, spill, GAP, then history
+ * messages, up to STREAM_IOV_MAX entries; *more is set if backlog remains.
+ */
+static size_t client_iov(stream_server_t *srv, stream_client_t *client, struct iovec *iov, size_t *out_niov,
+                         bool *more)
+{
+    size_t want = 0U;
+    size_t niov = 0U;
+    uint64_t idx;
+    size_t offset;
+
+    /* Drops are announced once the previous GAP is out, ahead of the next message. */
+    if (client->gap_off == client->gap_len && client->gap_pending) {
+        client->gap_len = proto_encode_gap(client->gap_msg, &client->gap);
+        client->gap_off = 0U;
+        client->gap_pending = false;
+        ++client->session.gaps_sent;
+        ++srv->stats.gaps_sent;
+    }
+    if (client->preamble_off < sizeof(srv->preamble)) {
+        iov[niov].iov_base = srv->preamble + client->preamble_off;
+        iov[niov].iov_len = sizeof(srv->preamble) - client->preamble_off;
+        want += iov[niov++].iov_len;
+    }
+    if (client->spill_off < client->spill_len) {
+        iov[niov].iov_base = client->spill + client->spill_off;
+        iov[niov].iov_len = client->spill_len - client->spill_off;
+        want += iov[niov++].iov_len;
+    }
+    if (client->gap_off < client->gap_len) {
+        iov[niov].iov_base = client->gap_msg + client->gap_off;
+        iov[niov].iov_len = client->gap_len - client->gap_off;
+        want += iov[niov++].iov_len;
+    }
+    for (idx = client->cursor, offset = client->offset; idx < srv->head && niov < STREAM_IOV_MAX;
+         ++idx, offset = 0U) {
+        const stream_msg_t *msg = &srv->history[idx & srv->history_mask];
+
+        iov[niov].iov_base = msg->buf + offset;
+        iov[niov].iov_len = msg->len - offset;
+        want += iov[niov++].iov_len;
+    }
+    *out_niov = niov;
+    *more = (idx < srv->head) || client->gap_pending;
+    return want;
+}
+
+/* Send as much backlog as the socket takes; one sendmsg() per STREAM_IOV_MAX messages. */
+static void client_flush(stream_server_t *srv, stream_client_t *client)
+{
+    bool cork = (srv->cfg.mode == STREAM_MODE_THROUGHPUT);
+    bool blocked = false;
+
+    if (client_caught_up(srv, client)) {
+        client_arm_out(srv, client, false);
+        return;
+    }
+    if (cork) {
+        set_tcp_opt(client->fd, TCP_CORK, 1);
+        ++srv->stats.send_syscalls;
+    }
+
+    while (!client_caught_up(srv, client)) {
+        struct iovec iov[STREAM_IOV_MAX];
+        struct msghdr mh;
+        size_t niov;
+        bool more;
+        size_t want = client_iov(srv, client, iov, &niov, &more);
+        ssize_t sent;
+
+        memset(&mh, 0, sizeof(mh));
+        mh.msg_iov = iov;
+        mh.msg_iovlen = niov;
+        ++srv->stats.send_syscalls;
+        sent = sendmsg(client->fd, &mh, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                blocked = true;
+                break;
+            }
+            client_close(srv, client, STREAM_CLOSE_ERROR);
+            return;
+        }
+
+        ++srv->stats.send_calls;
+        srv->stats.bytes_sent += (uint64_t)sent;
+        client_advance(srv, client, (size_t)sent, monotonic_ns());
+        if ((size_t)sent < want) {
+            /* Short write: the socket buffer is full, wait for EPOLLOUT. */
+            blocked = true;
+            break;
+        }
+    }
+
+    if (cork) {
+        set_tcp_opt(client->fd, TCP_CORK, 0);
+        ++srv->stats.send_syscalls;
+    }
+    client_arm_out(srv, client, blocked);
+}
+
+/* The ring failed mid-batch: what reached those sockets is unknown, so drop them and go back to sendmsg(). */
+static void uring_abandon(stream_server_t *srv, const bool *queued)
+{
+    uint32_t idx;
+
+    for (idx = 0U; idx < srv->cfg.max_clients; ++idx) {
+        if (queued[idx] && srv->clients[idx].fd >= 0) {
+            client_close(srv, &srv->clients[idx], STREAM_CLOSE_ERROR);
+        }
+    }
+    uring_destroy(srv->uring);
+    srv->uring = NULL;
+    srv->stats.io_uring = false;
+}
+
+/*
+ * io_uring fan-out: one SENDMSG per client with backlog, all submitted with a
+ * single io_uring_enter(). MSG_DONTWAIT keeps each as non-blocking as
+ * client_flush(), and in throughput mode MSG_MORE stands in for TCP_CORK
+ * while a client's backlog needs another round.
+ */
+static void flush_clients_uring(stream_server_t *srv)
+{
+    for (;;) {
+        bool *queued = srv->uring_queued;
+        uint32_t count = 0U;
+        uring_stats_t us;
+        uint64_t enters_before;
+        uint64_t now;
+        size_t got;
+        size_t c;
+        uint32_t idx;
+
+        for (idx = 0U; idx < srv->cfg.max_clients; ++idx) {
+            stream_client_t *client = &srv->clients[idx];
+            struct iovec *iov = srv->uring_iov + ((size_t)idx * STREAM_IOV_MAX);
+            struct msghdr *mh = &srv->uring_msg[idx];
+            size_t niov;
+            bool more;
+
+            queued[idx] = false;
+            if (client->fd < 0 || client->want_out || client_caught_up(srv, client)) {
+                continue;
+            }
+            srv->uring_want[idx] = client_iov(srv, client, iov, &niov, &more);
+            more = more && (srv->cfg.mode == STREAM_MODE_THROUGHPUT);
+            memset(mh, 0, sizeof(*mh));
+            mh->msg_iov = iov;
+            mh->msg_iovlen = niov;
+            if (uring_prep_sendmsg(srv->uring, client->fd, mh,
+                    MSG_NOSIGNAL | MSG_DONTWAIT | (more ? MSG_MORE : 0), idx) == 0) {
+                queued[idx] = true;
+                ++count;
+            }
+        }
+        if (count == 0U) {
+            return;
+        }
+
+        uring_get_stats(srv->uring, &us);
+        enters_before = us.enters;
+        if (uring_submit_wait(srv->uring, count) != 0) {
+            uring_abandon(srv, queued);
+            return;
+        }
+        uring_get_stats(srv->uring, &us);
+        srv->stats.send_syscalls += us.enters - enters_before;
+
+        now = monotonic_ns();
+        got = uring_reap(srv->uring, srv->uring_cqes, count);
+        for (c = 0U; c < got; ++c) {
+            stream_client_t *client = &srv->clients[srv->uring_cqes[c].user_data];
+            int32_t res = srv->uring_cqes[c].res;
+
+            if (res == -EINTR) {
+                continue;
+            }
+            if (res == -EAGAIN || res == -EWOULDBLOCK) {
+                client_arm_out(srv, client, true);
+                continue;
+            }
+            if (res < 0) {
+                client_close(srv, client, STREAM_CLOSE_ERROR);
+                continue;
+            }
+            ++srv->stats.send_calls;
+            srv->stats.bytes_sent += (uint64_t)res;
+            client_advance(srv, client, (size_t)res, now);
+            if ((size_t)res < srv->uring_want[srv->uring_cqes[c].user_data]) {
+                client_arm_out(srv, client, true);
+            }
+        }
+    }
+}
+
+static void flush_all_clients(stream_server_t *srv)
+{
+    uint32_t idx;
+
+    if (srv->uring != NULL) {
+        flush_clients_uring(srv);
+        return;
+    }
+    for (idx = 0U; idx < srv->cfg.max_clients; ++idx) {
+        stream_client_t *client = &srv->clients[idx];
+
+        /* Blocked clients resume from EPOLLOUT. */
+        if (client->fd >= 0 && !client->want_out) {
+            client_flush(srv, client);
+        }
+    }
+}
+
+/* Whether message `head` fits with `tail` the oldest kept one and `frames` frames kept. */
+static bool history_room(const stream_server_t *srv, uint64_t tail, uint64_t frames)
+{
+    size_t tail_off;
+
+    if (tail == srv->head) {
+        return true;
+    }
+    if (srv->head - tail > srv->history_mask ||
+        (srv->cfg.history_frames != 0U && frames + srv->cfg.frames_per_msg > srv->cfg.history_frames)) {
+        return false;
+    }
+    /* Kept messages run from tail_off to arena_pos, wrapping at most once. */
+    tail_off = (size_t)(srv->history[tail & srv->history_mask].buf - srv->arena);
+    if (srv->arena_pos > tail_off) {
+        return srv->arena_bytes - srv->arena_pos >= srv->msg_capacity || tail_off >= srv->msg_capacity;
+    }
+    return tail_off - srv->arena_pos >= srv->msg_capacity;
+}
+
+static void client_note_drop(stream_server_t *srv, stream_client_t *client, const stream_msg_t *msg)
+{
+    proto_gap_t *gap = &client->gap;
+
+    if (!client->gap_pending) {
+        memset(gap, 0, sizeof(*gap));
+        gap->first_msg_seq = (uint32_t)client->cursor;
+        client->gap_pending = true;
+    }
+    if (gap->frame_count == 0U) {
+        gap->first_seq = msg->first_seq;
+    }
+    ++gap->msg_count;
+    gap->frame_count += msg->frames;
+    ++client->session.msgs_dropped;
+    client->session.frames_dropped += msg->frames;
+    ++srv->stats.msgs_dropped;
+}
+
+/* Finish a partially sent history[cursor] from the spill buffer and move past it. */
+static void client_spill(stream_server_t *srv, stream_client_t *client)
+{
+    const stream_msg_t *msg = &srv->history[client->cursor & srv->history_mask];
+
+    client->spill_len = msg->len - client->offset;
+    client->spill_off = 0U;
+    memcpy(client->spill, msg->buf + client->offset, client->spill_len);
+    client->offset = 0U;
+    ++client->cursor;
+}
+
+/*
+ * Drop the oldest kept message. Sessions still at it are handled by policy:
+ * disconnect and never-drop close them, drop-oldest skips ahead with a GAP.
+ * A message that was partially sent is finished from the client's spill
+ * buffer so framing holds.
+ */
+static void evict_oldest(stream_server_t *srv)
+{
+    const stream_msg_t *msg = &srv->history[srv->tail & srv->history_mask];
+    uint32_t idx;
+
+    for (idx = 0U; idx < srv->cfg.max_clients; ++idx) {
+        stream_client_t *client = &srv->clients[idx];
+
+        if (client->fd < 0 || client->cursor != srv->tail) {
+            continue;
+        }
+        if (client->session.policy != STREAM_POLICY_DROP_OLDEST) {
+            client_close(srv, client, STREAM_CLOSE_OVERRUN);
+            ++srv->stats.clients_lagging;
+        } else if (client->offset != 0U) {
+            client_spill(srv, client);
+        } else {
+            client_note_drop(srv, client, msg);
+            ++client->cursor;
+        }
+    }
+    srv->history_frames -= msg->frames;
+    ++srv->tail;
+}
+
+/* Make room for message `head` (up to msg_capacity bytes), evicting as needed. */
+static stream_msg_t *claim_slot(stream_server_t *srv)
+{
+    stream_msg_t *msg = &srv->history[srv->head & srv->history_mask];
+
+    while (!history_room(srv, srv->tail, srv->history_frames)) {
+        evict_oldest(srv);
+    }
+    if (srv->tail == srv->head || srv->arena_bytes - srv->arena_pos < srv->msg_capacity) {
+        srv->arena_pos = 0U;
+    }
+    msg->buf = srv->arena + srv->arena_pos;
+    msg->len = 0U;
+    msg->first_seq = 0U;
+    msg->frames = 0U;
+    return msg;
+}
+
+static void commit_slot(stream_server_t *srv, stream_msg_t *msg, size_t len, uint64_t now)
+{
+    msg->len = len;
+    msg->publish_ns = now;
+    srv->arena_pos = (size_t)(msg->buf - srv->arena) + len;
+    srv->history_frames += msg->frames;
+    ++srv->head;
+}
+
+static void publish_open_message(stream_server_t *srv)
+{
+    stream_msg_t *msg = &srv->history[srv->head & srv->history_mask];
+
+    if (srv->enc.count == 0U) {
+        return;
+    }
+    msg->frames = srv->enc.count;
+    commit_slot(srv, msg, proto_data_finish(&srv->enc), monotonic_ns());
+    srv->enc.count = 0U;
+    ++srv->stats.msgs_published;
+}
+
+/* Takes the next msg_seq; call with no DATA message open. */
+static void publish_stats(stream_server_t *srv, uint64_t now)
+{
+    stream_msg_t *msg;
+    acq_ring_t *ring = acq_get_ring(srv->acq);
+    acq_ring_counters_t counters;
+    ads1278_stats_t hal;
+    proto_stats_t stats;
+    lat_hist_t hist;
+
+    memset(&stats, 0, sizeof(stats));
+    stats.mono_ns = now;
+    if (ads1278_dev_get_stats(acq_get_dev(srv->acq), &hal) == 0) {
+        stats.frames = hal.frames;
+        stats.drdy_timeouts = hal.drdy_timeouts;
+        stats.missed_drdy = hal.missed_drdy;
+        stats.overlong_xfers = hal.overlong_xfers;
+        stats.missed_conversions = hal.missed_conversions;
+        stats.gap_events = hal.gap_events;
+        proto_stage_from_hist(&stats.stage[PROTO_STAGE_DRDY_WAKEUP], &hal.drdy_wakeup);
+        proto_stage_from_hist(&stats.stage[PROTO_STAGE_SPI_XFER], &hal.spi_xfer);
+        proto_stage_from_hist(&stats.stage[PROTO_STAGE_PARSE], &hal.parse);
+    }
+    acq_ring_get_counters(ring, &counters);
+    stats.ring_overflows = counters.overflows;
+    stats.ring_high_water = counters.high_water;
+    stats.ring_capacity = (uint32_t)counters.capacity;
+    stats.msgs_dropped = srv->stats.msgs_dropped;
+    acq_ring_get_dwell(ring, &hist);
+    proto_stage_from_hist(&stats.stage[PROTO_STAGE_RING_DWELL], &hist);
+    lat_recorder_snapshot(&srv->net_send, &hist);
+    proto_stage_from_hist(&stats.stage[PROTO_STAGE_NET_SEND], &hist);
+    stats.stage_count = PROTO_STAGE_COUNT;
+
+    msg = claim_slot(srv);
+    commit_slot(srv, msg, proto_encode_stats(msg->buf, (uint32_t)srv->head, &stats), now);
+    ++srv->stats.stats_published;
+}
+
+/* Takes the next msg_seq and starts the next summary window; call with no DATA message open. */
+static void publish_summary(stream_server_t *srv, uint64_t now)
+{
+    stream_msg_t *msg;
+    chan_stats_summary_t window;
+    proto_summary_t summary;
+    uint32_t c;
+
+    chan_stats_window(srv->chan_stats, &window, true);
+    if (srv->cfg.calib != NULL) {
+        chan_calib_summary(&srv->calib, &window);
+    }
+
+    memset(&summary, 0, sizeof(summary));
+    summary.mono_ns = now;
+    summary.first_seq = window.first_seq;
+    summary.last_seq = window.last_seq;
+    summary.frames = window.frames;
+    summary.first_tstamp_ns = window.first_tstamp_ns;
+    summary.last_tstamp_ns = window.last_tstamp_ns;
+    summary.channel_count = (uint16_t)window.channel_count;
+    summary.flags = window.volts ? PROTO_SUMMARY_VOLTS : 0U;
+    for (c = 0U; c < window.channel_count; ++c) {
+        summary.ch[c].min = window.ch[c].min;
+        summary.ch[c].max = window.ch[c].max;
+        summary.ch[c].mean = window.ch[c].mean;
+        summary.ch[c].rms = window.ch[c].rms;
+        summary.ch[c].stddev = window.ch[c].stddev;
+    }
+
+    msg = claim_slot(srv);
+    commit_slot(srv, msg, proto_encode_summary(msg->buf, (uint32_t)srv->head, &summary), now);
+    ++srv->stats.summaries_published;
+}
+
+/* One SPECTRUM message per channel; closes an open DATA message first. */
+static void publish_spectrum(stream_server_t *srv, const psd_result_t *result)
+{
+    proto_spectrum_t spectrum;
+    uint64_t now;
+    uint32_t c;
+
+    publish_open_message(srv);
+    now = monotonic_ns();
+    memset(&spectrum, 0, sizeof(spectrum));
+    spectrum.mono_ns = now;
+    spectrum.result_id = result->id;
+    spectrum.first_seq = result->first_seq;
+    spectrum.last_seq = result->last_seq;
+    spectrum.bin_hz = result->bin_hz;
+    spectrum.enbw_hz = result->enbw_hz;
+    spectrum.fft_size = result->fft_size;
+    spectrum.segments = result->segments;
+    spectrum.window = (uint16_t)result->window;
+    spectrum.flags = result->volts ? PROTO_SPECTRUM_VOLTS : 0U;
+    spectrum.bin_group = (uint16_t)result->bin_group;
+    spectrum.bin_count = result->bins;
+    for (c = 0U; c < result->channel_count; ++c) {
+        stream_msg_t *msg = claim_slot(srv);
+
+        spectrum.channel = (uint16_t)c;
+        commit_slot(srv, msg, proto_encode_spectrum(msg->buf, (uint32_t)srv->head, &spectrum, result->psd[c]),
+                    now);
+        ++srv->stats.spectra_published;
+    }
+}
+
+static void psd_frames(stream_server_t *srv, const ads1278_frame_t *frames, size_t n)
+{
+    while (n != 0U) {
+        psd_result_t result;
+        size_t used = psd_process(srv->psd, frames, n, &result);
+
+        if (result.bins != 0U) {
+            publish_spectrum(srv, &result);
+        }
+        frames += used;
+        n -= used;
+    }
+}
+
+/* Pack frames that are already out of the ring (decimator output). */
+static void pack_frames(stream_server_t *srv, const ads1278_frame_t *frames, size_t n)
+{
+    while (n != 0U) {
+        size_t room = srv->cfg.frames_per_msg - srv->enc.count;
+        size_t want = (n < room) ? n : room;
+        size_t taken;
+
+        if (srv->enc.count == 0U) {
+            stream_msg_t *msg = claim_slot(srv);
+
+            msg->first_seq = frames[0].seq;
+            proto_data_begin(&srv->enc, msg->buf, (uint32_t)srv->head, frames);
+        }
+        taken = proto_data_append(&srv->enc, frames, want);
+        if (srv->udp != NULL) {
+            udp_sender_push(srv->udp, frames, taken);
+        }
+        srv->stats.frames_out += taken;
+        frames += taken;
+        n -= taken;
+        if (taken < want || srv->enc.count == srv->cfg.frames_per_msg) {
+            publish_open_message(srv);
+        }
+    }
+}
+
+/* Takes the next msg_seq; the encoder is sized for a whole window. */
+static void publish_event(stream_server_t *srv, const trigger_event_t *event)
+{
+    stream_msg_t *msg;
+    proto_event_t ev;
+    size_t len;
+
+    memset(&ev, 0, sizeof(ev));
+    ev.event_id = event->id;
+    ev.trigger_seq = event->trigger_seq;
+    ev.trigger_tstamp_ns = event->trigger_tstamp_ns;
+    ev.pre_frames = event->pre_frames;
+    if (event->condition == TRIGGER_EXTERNAL) {
+        ev.condition = PROTO_EVENT_EXTERNAL;
+        ev.channel = PROTO_EVENT_EXTERNAL;
+    } else {
+        ev.condition = (uint16_t)event->condition;
+        ev.channel = (uint16_t)srv->trigger_cfg.cond[event->condition].channel;
+    }
+
+    msg = claim_slot(srv);
+    len = proto_encode_event(msg->buf, (uint32_t)srv->head, &ev, &srv->enc, event->frames, event->frame_count);
+    msg->first_seq = event->frames[0].seq;
+    msg->frames = ev.frame_count;
+    commit_slot(srv, msg, len, monotonic_ns());
+    srv->enc.count = 0U;
+    ++srv->stats.events_published;
+    srv->stats.frames_out += ev.frame_count;
+}
+
+static void trigger_frames(stream_server_t *srv, const ads1278_frame_t *frames, size_t n)
+{
+    while (n != 0U) {
+        trigger_event_t event;
+        size_t used = trigger_process(srv->trigger, frames, n, &event);
+
+        if (event.frame_count != 0U) {
+            publish_event(srv, &event);
+        }
+        frames += used;
+        n -= used;
+    }
+}
+
+/* Move everything the acquisition thread has produced into DATA (or EVENT) messages. */
+static void pump_frames(stream_server_t *srv)
+{
+    acq_ring_t *ring = acq_get_ring(srv->acq);
+
+    if (srv->decim != NULL || srv->trigger != NULL || srv->chan_stats != NULL || srv->psd != NULL) {
+        for (;;) {
+            const ads1278_frame_t *span = NULL;
+            size_t n = acq_ring_peek(ring, &span, STREAM_DECIM_BATCH_FRAMES);
+            const ads1278_frame_t *frames = span;
+            size_t out = n;
+
+            if (n == 0U) {
+                return;
+            }
+            if (srv->decim != NULL) {
+                out = decim_process(srv->decim, span, n, srv->decim_out);
+                frames = srv->decim_out;
+            }
+            if (srv->chan_stats != NULL) {
+                chan_stats_update(srv->chan_stats, frames, out);
+            }
+            if (srv->psd != NULL) {
+                psd_frames(srv, frames, out);
+            }
+            if (srv->trigger != NULL) {
+                trigger_frames(srv, frames, out);
+            } else if (!srv->cfg.summary_only) {
+                pack_frames(srv, frames, out);
+            }
+            acq_ring_release(ring, n);
+            srv->stats.frames_in += n;
+        }
+    }
+
+    for (;;) {
+        const ads1278_frame_t *span = NULL;
+        size_t n = acq_ring_peek(ring, &span, srv->cfg.frames_per_msg - srv->enc.count);
+        size_t taken;
+
+        if (n == 0U) {
+            break;
+        }
+        if (srv->enc.count == 0U) {
+            stream_msg_t *msg = claim_slot(srv);
+
+            msg->first_seq = span[0].seq;
+            proto_data_begin(&srv->enc, msg->buf, (uint32_t)srv->head, span);
+        }
+        taken = proto_data_append(&srv->enc, span, n);
+        if (srv->udp != NULL) {
+            udp_sender_push(srv->udp, span, taken);
+        }
+        acq_ring_release(ring, taken);
+        srv->stats.frames_in += taken;
+        srv->stats.frames_out += taken;
+        /* A short append means the encoding needs a new message (seq gap, time step). */
+        if (taken < n || srv->enc.count == srv->cfg.frames_per_msg) {
+            publish_open_message(srv);
+        }
+    }
+}
+
+static int start_acquisition(stream_server_t *srv)
+{
+    struct itimerspec its;
+
+    if (acq_start(srv->acq) != 0) {
+        return -1;
+    }
+    srv->acq_started = true;
+
+    memset(&its, 0, sizeof(its));
+    its.it_value.tv_sec = (time_t)(srv->cfg.flush_us / 1000000U);
+    its.it_value.tv_nsec = (long)(srv->cfg.flush_us % 1000000U) * 1000L;
+    its.it_interval = its.it_value;
+    return timerfd_settime(srv->timer_fd, 0, &its, NULL);
+}
+
+/* Track backlogs and close disconnect-policy sessions whose oldest unsent message is too old. */
+static void check_lag(stream_server_t *srv, uint64_t now)
+{
+    uint32_t idx;
+
+    for (idx = 0U; idx < srv->cfg.max_clients; ++idx) {
+        stream_client_t *client = &srv->clients[idx];
+        uint64_t lag;
+        uint64_t since;
+
+        if (client->fd < 0) {
+            continue;
+        }
+        lag = srv->head - client->cursor;
+        if (lag > client->session.max_lag_msgs) {
+            client->session.max_lag_msgs = lag;
+        }
+        if (lag == 0U || client->session.policy != STREAM_POLICY_DISCONNECT) {
+            continue;
+        }
+        since = srv->history[client->cursor & srv->history_mask].publish_ns;
+        if (since < client->resume_ns) {
+            since = client->resume_ns;
+        }
+        if (now > since + ((uint64_t)client->session.max_lag_ms * 1000000ULL)) {
+            client_close(srv, client, STREAM_CLOSE_LAGGING);
+            ++srv->stats.clients_lagging;
+        }
+    }
+}
+
+static void on_timer(stream_server_t *srv)
+{
+    uint64_t expirations;
+    bool finished;
+
+    (void)read(srv->timer_fd, &expirations, sizeof(expirations));
+
+    /* Sample done before draining so frames pushed just before exit are kept. */
+    finished = acq_is_done(srv->acq);
+    pump_frames(srv);
+    publish_open_message(srv);
+    if (srv->udp != NULL) {
+        udp_sender_flush(srv->udp);
+    }
+    if (finished && srv->trigger != NULL && !srv->eos) {
+        trigger_event_t event;
+
+        trigger_flush(srv->trigger, &event);
+        if (event.frame_count != 0U) {
+            publish_event(srv, &event);
+        }
+    }
+    if (srv->chan_stats != NULL) {
+        uint64_t now = monotonic_ns();
+
+        /* The last, partial window goes out at end of stream. */
+        if (now >= srv->next_summary_ns || (finished && !srv->eos)) {
+            publish_summary(srv, now);
+            srv->next_summary_ns = now + ((uint64_t)srv->cfg.summary_ms * 1000000ULL);
+        }
+    }
+    if (srv->cfg.stats_ms != 0U) {
+        uint64_t now = monotonic_ns();
+
+        if (now >= srv->next_stats_ns) {
+            publish_stats(srv, now);
+            srv->next_stats_ns = now + ((uint64_t)srv->cfg.stats_ms * 1000000ULL);
+        }
+    }
+    if (finished) {
+        srv->eos = true;
+    }
+    flush_all_clients(srv);
+    check_lag(srv, monotonic_ns());
+}
+
+static int on_accept(stream_server_t *srv)
+{
+    for (;;) {
+        struct sockaddr_in peer;
+        socklen_t peer_len = sizeof(peer);
+        int fd = accept(srv->listen_fd, (struct sockaddr *)&peer, &peer_len);
+        uint32_t idx;
+
+        if (fd < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == ECONNABORTED) {
+                return 0;
+            }
+            return -1;
+        }
+
+        idx = 0U;
+        while (idx < srv->cfg.max_clients && srv->clients[idx].fd >= 0) {
+            ++idx;
+        }
+        if (idx == srv->cfg.max_clients || srv->eos || set_nonblocking(fd) != 0 ||
+            epoll_add(srv->epoll_fd, fd, EPOLLIN | EPOLLRDHUP, STREAM_TAG_CLIENT0 + idx) != 0) {
+            (void)close(fd);
+            ++srv->stats.clients_rejected;
+            continue;
+        }
+
+        if (srv->cfg.mode == STREAM_MODE_LATENCY) {
+            set_tcp_opt(fd, TCP_NODELAY, 1);
+        }
+
+        client_open(srv, &srv->clients[idx], fd, &peer);
+        client_flush(srv, &srv->clients[idx]);
+
+        if (!srv->acq_started && srv->client_count >= srv->cfg.start_clients && start_acquisition(srv) != 0) {
+            return -1;
+        }
+    }
+}
+
+/*
+ * Rewind to the oldest kept message holding frames at or after resume_seq
+ * (the live edge when none does yet) and announce it with a resume GAP.
+ */
+static void client_resume(stream_server_t *srv, stream_client_t *client, uint64_t resume_seq)
+{
+    proto_gap_t *gap = &client->gap;
+    bool older = false;
+    uint64_t idx;
+
+    if (client->offset != 0U) {
+        client_spill(srv, client);
+    }
+    for (idx = srv->tail; idx < srv->head; ++idx) {
+        const stream_msg_t *msg = &srv->history[idx & srv->history_mask];
+
+        if (msg->frames == 0U) {
+            continue;
+        }
+        if (msg->first_seq + msg->frames > resume_seq) {
+            break;
+        }
+        older = true;
+    }
+
+    /* Pending drops are superseded: the client restarts its accounting here. */
+    memset(gap, 0, sizeof(*gap));
+    gap->first_msg_seq = (uint32_t)idx;
+    gap->first_seq = resume_seq;
+    gap->flags = PROTO_GAP_RESUME;
+    if (!older && idx < srv->head && srv->history[idx & srv->history_mask].first_seq > resume_seq) {
+        gap->frame_count = srv->history[idx & srv->history_mask].first_seq - resume_seq;
+    }
+    client->gap_pending = true;
+
+    if (idx < client->cursor) {
+        client->session.msgs_replayed += client->cursor - idx;
+        srv->stats.msgs_replayed += client->cursor - idx;
+    }
+    client->cursor = idx;
+    client->resume_ns = monotonic_ns();
+    ++client->session.resumes;
+    ++srv->stats.resumes;
+}
+
+static void client_subscribe(stream_server_t *srv, stream_client_t *client, const proto_subscribe_t *sub)
+{
+    if (sub->policy >= PROTO_POLICY_DROP_OLDEST && sub->policy <= PROTO_POLICY_NEVER_DROP) {
+        client->session.policy = (stream_policy_t)sub->policy;
+    }
+    client->session.max_lag_ms = (sub->max_lag_ms != 0U) ? sub->max_lag_ms : srv->cfg.max_lag_ms;
+    if ((sub->flags & PROTO_SUBSCRIBE_RESUME) != 0U) {
+        client_resume(srv, client, sub->resume_seq);
+    }
+}
+
+/* Feed received bytes through the message parser; other message types are skipped. */
+static int client_rx(stream_server_t *srv, stream_client_t *client, const uint8_t *data, size_t n)
+{
+    while (n != 0U) {
+        proto_header_t hdr;
+        size_t want;
+        size_t take;
+
+        if (client->rx_skip != 0U) {
+            take = (n < client->rx_skip) ? n : client->rx_skip;
+            client->rx_skip -= (uint32_t)take;
+            data += take;
+            n -= take;
+            continue;
+        }
+
+        want = (client->rx_fill < PROTO_HEADER_BYTES) ? PROTO_HEADER_BYTES : sizeof(client->rx);
+        take = want - client->rx_fill;
+        take = (n < take) ? n : take;
+        memcpy(client->rx + client->rx_fill, data, take);
+        client->rx_fill += take;
+        data += take;
+        n -= take;
+
+        if (client->rx_fill == PROTO_HEADER_BYTES) {
+            if (proto_decode_header(client->rx, &hdr) != 0) {
+                return -1;
+            }
+            if (hdr.type != PROTO_MSG_SUBSCRIBE || hdr.payload_len != PROTO_SUBSCRIBE_BYTES) {
+                client->rx_skip = hdr.payload_len;
+                client->rx_fill = 0U;
+            }
+        } else if (client->rx_fill == sizeof(client->rx)) {
+            proto_subscribe_t sub;
+
+            if (proto_decode_subscribe(client->rx + PROTO_HEADER_BYTES, PROTO_SUBSCRIBE_BYTES, &sub) != 0) {
+                return -1;
+            }
+            client_subscribe(srv, client, &sub);
+            client->rx_fill = 0U;
+        }
+    }
+    return 0;
+}
+
+static void on_client(stream_server_t *srv, stream_client_t *client, uint32_t events)
+{
+    if ((events & EPOLLIN) != 0U) {
+        uint8_t buf[STREAM_RX_BYTES];
+        ssize_t n;
+
+        for (;;) {
+            n = recv(client->fd, buf, sizeof(buf), MSG_DONTWAIT);
+            if (n <= 0) {
+                break;
+            }
+            if (client_rx(srv, client, buf, (size_t)n) != 0) {
+                client_close(srv, client, STREAM_CLOSE_PROTOCOL);
+                return;
+            }
+        }
+        if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+            client_close(srv, client, STREAM_CLOSE_PEER);
+            return;
+        }
+    }
+    if ((events & (EPOLLERR | EPOLLHUP | EPOLLRDHUP)) != 0U) {
+        client_close(srv, client, STREAM_CLOSE_PEER);
+        return;
+    }
+    /* A SUBSCRIBE may have queued a GAP or a replay. */
+    if ((events & EPOLLOUT) != 0U || !client->want_out) {
+        client_flush(srv, client);
+    }
+}
+
+static bool all_clients_caught_up(const stream_server_t *srv)
+{
+    uint32_t idx;
+
+    for (idx = 0U; idx < srv->cfg.max_clients; ++idx) {
+        if (srv->clients[idx].fd >= 0 && !client_caught_up(srv, &srv->clients[idx])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int stream_server_run(stream_server_t *srv)
+{
+    bool stop = false;
+
+    if (srv == NULL) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (!srv->acq_started && srv->cfg.start_clients == 0U && start_acquisition(srv) != 0) {
+        return -1;
+    }
+
+    while (!stop && !(srv->eos && all_clients_caught_up(srv))) {
+        struct epoll_event events[STREAM_EPOLL_EVENTS];
+        int n = epoll_wait(srv->epoll_fd, events, STREAM_EPOLL_EVENTS, -1);
+        int idx;
+
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+
+        for (idx = 0; idx < n; ++idx) {
+            uint32_t tag = events[idx].data.u32;
+
+            if (tag == STREAM_TAG_LISTEN) {
+                if (on_accept(srv) != 0) {
+                    return -1;
+                }
+            } else if (tag == STREAM_TAG_TIMER) {
+                on_timer(srv);
+            } else if (tag == STREAM_TAG_STOP) {
+                stop = true;
+            } else if (srv->clients[tag - STREAM_TAG_CLIENT0].fd >= 0) {
+                on_client(srv, &srv->clients[tag - STREAM_TAG_CLIENT0], events[idx].events);
+            }
+        }
+    }
+
+    return 0;
+}
+
+void stream_server_stop(stream_server_t *srv)
+{
+    uint64_t one = 1U;
+
+    if (srv != NULL) {
+        (void)write(srv->stop_fd, &one, sizeof(one));
+    }
+}
+
+static int open_listener(stream_server_t *srv)
+{
+    struct sockaddr_in addr;
+    socklen_t addr_len = sizeof(addr);
+    int one = 1;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(srv->cfg.port);
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (srv->cfg.bind_addr != NULL && inet_pton(AF_INET, srv->cfg.bind_addr, &addr.sin_addr) != 1) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    srv->listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (srv->listen_fd < 0) {
+        return -1;
+    }
+    (void)setsockopt(srv->listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    if (bind(srv->listen_fd, (const struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+        listen(srv->listen_fd, STREAM_LISTEN_BACKLOG) != 0 ||
+        set_nonblocking(srv->listen_fd) != 0 ||
+        getsockname(srv->listen_fd, (struct sockaddr *)&addr, &addr_len) != 0) {
+        return -1;
+    }
+
+    srv->port = ntohs(addr.sin_port);
+    return 0;
+}
+
+/*
+ * Slot ring size when only a frame or byte bound was given: enough slots for
+ * the expected message size (flush ticks may close messages early), doubled
+ * for control messages and rounded up to a power of two.
+ */
+static uint32_t history_slots(const stream_server_t *srv)
+{
+    uint64_t frames_per_msg = srv->cfg.frames_per_msg;
+    uint64_t want;
+    uint32_t slots = 2U;
+
+    if (srv->cfg.history_frames == 0U && srv->cfg.history_bytes == 0U) {
+        return (srv->trigger != NULL) ? STREAM_TRIGGER_HISTORY_MSGS : STREAM_DEFAULT_HISTORY_MSGS;
+    }
+    if (srv->trigger == NULL && srv->cfg.announce.sample_rate_hz != 0U) {
+        uint64_t per_flush = ((uint64_t)srv->cfg.announce.sample_rate_hz * srv->cfg.flush_us) / 1000000U;
+
+        frames_per_msg = (per_flush == 0U) ? 1U : (per_flush < frames_per_msg) ? per_flush : frames_per_msg;
+    }
+    if (srv->cfg.history_frames != 0U) {
+        want = (srv->cfg.history_frames + frames_per_msg - 1U) / frames_per_msg;
+    } else {
+        want = srv->cfg.history_bytes /
+               proto_data_max_bytes(srv->cfg.encoding, srv->channels, (size_t)frames_per_msg);
+    }
+    want *= 2U;
+    while (slots < want && slots < STREAM_MAX_HISTORY_MSGS) {
+        slots *= 2U;
+    }
+    return slots;
+}
+
+int stream_server_create(stream_server_t **out, const stream_server_cfg_t *cfg, acq_t *acq)
+{
+    stream_server_t *srv;
+    proto_hello_t hello;
+    size_t offset;
+    uint32_t idx;
+
+    if (out == NULL || cfg == NULL || acq == NULL || cfg->mode > STREAM_MODE_THROUGHPUT ||
+        (cfg->history_msgs & (cfg->history_msgs - 1U)) != 0U || cfg->history_msgs == 1U ||
+        cfg->policy > STREAM_POLICY_NEVER_DROP ||
+        (cfg->summary_only && cfg->summary_ms == 0U && cfg->psd == NULL) ||
+        (cfg->udp != NULL && (cfg->trigger != NULL || cfg->summary_only))) {
+        errno = EINVAL;
+        return -1;
+    }
+    *out = NULL;
+
+    srv = calloc(1U, sizeof(*srv));
+    if (srv == NULL) {
+        return -1;
+    }
+    srv->listen_fd = -1;
+    srv->epoll_fd = -1;
+    srv->timer_fd = -1;
+    srv->stop_fd = -1;
+    srv->acq = acq;
+    srv->cfg = *cfg;
+    srv->channels = ads1278_dev_channel_count(acq_get_dev(acq));
+    lat_recorder_reset(&srv->net_send);
+    if (srv->cfg.frames_per_msg == 0U) {
+        srv->cfg.frames_per_msg = (cfg->mode == STREAM_MODE_LATENCY) ? LATENCY_FRAMES_PER_MSG
+                                                                     : THROUGHPUT_FRAMES_PER_MSG;
+    }
+    if (srv->cfg.flush_us == 0U) {
+        srv->cfg.flush_us = (cfg->mode == STREAM_MODE_LATENCY) ? LATENCY_FLUSH_US : THROUGHPUT_FLUSH_US;
+    }
+    if (srv->cfg.policy == 0) {
+        srv->cfg.policy = STREAM_POLICY_DROP_OLDEST;
+    }
+    if (srv->cfg.max_lag_ms == 0U) {
+        srv->cfg.max_lag_ms = STREAM_DEFAULT_MAX_LAG_MS;
+    }
+    if (srv->cfg.max_clients == 0U) {
+        srv->cfg.max_clients = STREAM_DEFAULT_MAX_CLIENTS;
+    }
+    if (srv->cfg.encoding == 0U) {
+        srv->cfg.encoding = PROTO_DATA_ENC_P24;
+    }
+    srv->cfg.announce.frames_per_msg = srv->cfg.frames_per_msg;
+    srv->cfg.announce.flush_us = srv->cfg.flush_us;
+    srv->cfg.announce.stream_mode = (uint32_t)srv->cfg.mode;
+    srv->cfg.decim = NULL;
+    if (cfg->decim != NULL) {
+        if (decim_create(&srv->decim, cfg->decim, (cfg->decim_groups != 0U) ? cfg->decim_groups : 1U,
+                         srv->channels) != 0) {
+            goto fail;
+        }
+        /* Everything downstream sees the decimator's frames, which carry only its channels. */
+        srv->channels = decim_channels(srv->decim);
+        if (proto_data_max_bytes(srv->cfg.encoding, srv->channels, 1U) == 0U) {
+            errno = EINVAL;
+            goto fail;
+        }
+        srv->decim_out = calloc(STREAM_DECIM_BATCH_FRAMES + 1U, sizeof(*srv->decim_out));
+        if (srv->decim_out == NULL) {
+            goto fail;
+        }
+        srv->cfg.announce.sample_rate_hz /= decim_factor(srv->decim);
+    }
+    srv->cfg.trigger = NULL;
+    if (cfg->trigger != NULL) {
+        srv->trigger_cfg = *cfg->trigger;
+        srv->trigger_cfg.channel_count = srv->channels;
+        if (trigger_create(&srv->trigger, &srv->trigger_cfg) != 0) {
+            goto fail;
+        }
+        /* One message per window: the encoder and every history slot hold a whole one. */
+        srv->cfg.frames_per_msg = trigger_window_frames(srv->trigger);
+        srv->cfg.announce.frames_per_msg = srv->cfg.frames_per_msg;
+        if (proto_event_max_bytes(srv->cfg.encoding, srv->channels, srv->cfg.frames_per_msg) >
+            PROTO_HEADER_BYTES + PROTO_MAX_PAYLOAD_BYTES) {
+            errno = EMSGSIZE;
+            goto fail;
+        }
+    }
+
+    srv->cfg.calib = NULL;
+    if (cfg->calib != NULL) {
+        srv->calib = *cfg->calib;
+        if (srv->decim != NULL) {
+            /* The table is per input channel; follow the decimator's selection. */
+            for (idx = 0U; idx < srv->channels; ++idx) {
+                srv->calib.scale[idx] = cfg->calib->scale[decim_source_channel(srv->decim, idx)];
+                srv->calib.offset[idx] = cfg->calib->offset[decim_source_channel(srv->decim, idx)];
+            }
+            srv->calib.channel_count = srv->channels;
+        }
+        srv->cfg.calib = &srv->calib;
+    }
+    if (cfg->summary_ms != 0U) {
+        if (chan_stats_create(&srv->chan_stats, srv->channels) != 0) {
+            goto fail;
+        }
+        srv->next_summary_ns = monotonic_ns() + ((uint64_t)cfg->summary_ms * 1000000ULL);
+    }
+
+    srv->cfg.psd = NULL;
+    if (cfg->psd != NULL) {
+        psd_cfg_t psd_cfg = *cfg->psd;
+
+        psd_cfg.channel_count = srv->channels;
+        psd_cfg.calib = srv->cfg.calib;
+        if (psd_cfg.sample_rate_hz == 0.0 && cfg->announce.sample_rate_hz != 0U) {
+            psd_cfg.sample_rate_hz = (double)cfg->announce.sample_rate_hz /
+                                     (double)((srv->decim != NULL) ? decim_factor(srv->decim) : 1U);
+        }
+        if (psd_create(&srv->psd, &psd_cfg) != 0) {
+            goto fail;
+        }
+    }
+
+    /* Message arena and per-client spill buffers in one allocation, touched up front. */
+    srv->msg_capacity = (srv->trigger != NULL)
+        ? proto_event_max_bytes(srv->cfg.encoding, srv->channels, srv->cfg.frames_per_msg)
+        : proto_data_max_bytes(srv->cfg.encoding, srv->channels, srv->cfg.frames_per_msg);
+    if (srv->msg_capacity < PROTO_HEADER_BYTES + PROTO_STATS_BYTES) {
+        srv->msg_capacity = PROTO_HEADER_BYTES + PROTO_STATS_BYTES;
+    }
+    if (srv->msg_capacity < PROTO_HEADER_BYTES + PROTO_SUMMARY_BYTES(srv->channels)) {
+        srv->msg_capacity = PROTO_HEADER_BYTES + PROTO_SUMMARY_BYTES(srv->channels);
+    }
+    if (srv->psd != NULL && srv->msg_capacity < PROTO_HEADER_BYTES + PROTO_SPECTRUM_BYTES(psd_result_bins(srv->psd))) {
+        srv->msg_capacity = PROTO_HEADER_BYTES + PROTO_SPECTRUM_BYTES(psd_result_bins(srv->psd));
+    }
+    if (srv->cfg.history_frames != 0U && srv->cfg.history_frames < srv->cfg.frames_per_msg) {
+        errno = EINVAL;
+        goto fail;
+    }
+    if (srv->cfg.history_msgs == 0U) {
+        srv->cfg.history_msgs = history_slots(srv);
+    }
+    srv->arena_bytes = (srv->cfg.history_bytes != 0U) ? srv->cfg.history_bytes
+                                                      : (size_t)srv->cfg.history_msgs * srv->msg_capacity;
+    if (srv->arena_bytes < 2U * srv->msg_capacity) {
+        errno = EINVAL;
+        goto fail;
+    }
+
+    if (proto_data_encoder_init(&srv->enc, srv->cfg.encoding, srv->channels, srv->cfg.frames_per_msg) != 0) {
+        goto fail;
+    }
+    srv->enc.linear_ts = srv->cfg.linear_ts;
+    srv->enc.linear_tolerance_ns = srv->cfg.linear_tolerance_ns;
+    srv->history = calloc(srv->cfg.history_msgs, sizeof(*srv->history));
+    srv->clients = calloc(srv->cfg.max_clients, sizeof(*srv->clients));
+    srv->storage = calloc(srv->arena_bytes + ((size_t)srv->cfg.max_clients * srv->msg_capacity), 1U);
+    if (srv->history == NULL || srv->clients == NULL || srv->storage == NULL) {
+        goto fail;
+    }
+    memset(srv->storage, 0, srv->arena_bytes + ((size_t)srv->cfg.max_clients * srv->msg_capacity));
+    srv->arena = srv->storage;
+    srv->history_mask = (uint64_t)srv->cfg.history_msgs - 1U;
+    for (idx = 0U; idx < srv->cfg.max_clients; ++idx) {
+        srv->clients[idx].fd = -1;
+        srv->clients[idx].spill = srv->arena + srv->arena_bytes + ((size_t)idx * srv->msg_capacity);
+    }
+
+    /* HELLO and CONFIG are the same for every client; msg_seq restarts at DATA. */
+    memset(&hello, 0, sizeof(hello));
+    hello.proto_version = PROTO_VERSION;
+    hello.channel_count = srv->channels;
+    strncpy(hello.server_name, "redpitaya-spi-daq", sizeof(hello.server_name) - 1U);
+    offset = proto_encode_hello(srv->preamble, 0U, &hello);
+    offset += proto_encode_config(srv->preamble + offset, 0U, &srv->cfg.announce);
+    (void)offset;
+
+    srv->cfg.udp = NULL;
+    if (cfg->udp != NULL) {
+        udp_sender_cfg_t udp_cfg = *cfg->udp;
+
+        /* Same encoding and announcement as TCP; datagrams are packed independently. */
+        udp_cfg.encoding = srv->cfg.encoding;
+        udp_cfg.linear_ts = srv->cfg.linear_ts;
+        udp_cfg.linear_tolerance_ns = srv->cfg.linear_tolerance_ns;
+        udp_cfg.hello = hello;
+        udp_cfg.announce = srv->cfg.announce;
+        if (udp_sender_create(&srv->udp, &udp_cfg) != 0) {
+            goto fail;
+        }
+    }
+
+    /* io_uring is best effort: without it every client gets its own sendmsg(). */
+    if (srv->cfg.io_uring && uring_create(&srv->uring, srv->cfg.max_clients) == 0) {
+        srv->uring_iov = calloc((size_t)srv->cfg.max_clients * STREAM_IOV_MAX, sizeof(*srv->uring_iov));
+        srv->uring_msg = calloc(srv->cfg.max_clients, sizeof(*srv->uring_msg));
+        srv->uring_want = calloc(srv->cfg.max_clients, sizeof(*srv->uring_want));
+        srv->uring_queued = calloc(srv->cfg.max_clients, sizeof(*srv->uring_queued));
+        srv->uring_cqes = calloc(srv->cfg.max_clients, sizeof(*srv->uring_cqes));
+        if (srv->uring_iov == NULL || srv->uring_msg == NULL || srv->uring_want == NULL ||
+            srv->uring_queued == NULL || srv->uring_cqes == NULL) {
+            goto fail;
+        }
+        srv->stats.io_uring = true;
+    }
+
+    if (open_listener(srv) != 0) {
+        goto fail;
+    }
+    srv->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    srv->timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    srv->stop_fd = eventfd(0U, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (srv->epoll_fd < 0 || srv->timer_fd < 0 || srv->stop_fd < 0 ||
+        epoll_add(srv->epoll_fd, srv->listen_fd, EPOLLIN, STREAM_TAG_LISTEN) != 0 ||
+        epoll_add(srv->epoll_fd, srv->timer_fd, EPOLLIN, STREAM_TAG_TIMER) != 0 ||
+        epoll_add(srv->epoll_fd, srv->stop_fd, EPOLLIN, STREAM_TAG_STOP) != 0) {
+        goto fail;
+    }
+
+    *out = srv;
+    return 0;
+
+fail:
+    {
+        int saved_errno = errno;
+
+        stream_server_destroy(srv);
+        errno = saved_errno;
+    }
+    return -1;
+}
+
+uint16_t stream_server_port(const stream_server_t *srv)
+{
+    return (srv != NULL) ? srv->port : 0U;
+}
+
+void stream_server_get_stats(const stream_server_t *srv, stream_server_stats_t *out)
+{
+    if (srv != NULL && out != NULL) {
+        *out = srv->stats;
+        out->linear_ts_msgs = srv->enc.linear_msgs;
+        lat_recorder_snapshot(&srv->net_send, &out->net_send);
+        if (srv->trigger != NULL) {
+            trigger_get_stats(srv->trigger, &out->trigger);
+        }
+        psd_get_stats(srv->psd, &out->psd);
+        udp_sender_get_stats(srv->udp, &out->udp);
+    }
+}
+
+void stream_server_destroy(stream_server_t *srv)
+{
+    uint32_t idx;
+
+    if (srv == NULL) {
+        return;
+    }
+
+    for (idx = 0U; srv->clients != NULL && idx < srv->cfg.max_clients; ++idx) {
+        if (srv->clients[idx].fd >= 0) {
+            (void)shutdown(srv->clients[idx].fd, SHUT_WR);
+            (void)close(srv->clients[idx].fd);
+        }
+    }
+    if (srv->stop_fd >= 0) {
+        (void)close(srv->stop_fd);
+    }
+    if (srv->timer_fd >= 0) {
+        (void)close(srv->timer_fd);
+    }
+    if (srv->epoll_fd >= 0) {
+        (void)close(srv->epoll_fd);
+    }
+    if (srv->listen_fd >= 0) {
+        (void)close(srv->listen_fd);
+    }
+    udp_sender_destroy(srv->udp);
+    uring_destroy(srv->uring);
+    free(srv->uring_cqes);
+    free(srv->uring_queued);
+    free(srv->uring_want);
+    free(srv->uring_msg);
+    free(srv->uring_iov);
+    proto_data_encoder_destroy(&srv->enc);
+    free(srv->decim_out);
+    decim_destroy(srv->decim);
+    trigger_destroy(srv->trigger);
+    chan_stats_destroy(srv->chan_stats);
+    psd_destroy(srv->psd);
+    free(srv->storage);
+    free(srv->clients);
+    free(srv->history);
+    free(srv);
+}
+
+size_t stream_server_get_sessions(const stream_server_t *srv, stream_session_stats_t *out, size_t max)
+{
+    size_t n = 0U;
+    size_t i;
+    size_t j;
+    uint64_t idx;
+
+    if (srv == NULL || out == NULL) {
+        return 0U;
+    }
+    idx = (srv->closed_count > STREAM_SESSION_LOG) ? srv->closed_count - STREAM_SESSION_LOG : 0U;
+    for (; idx < srv->closed_count && n < max; ++idx) {
+        out[n++] = srv->closed[idx % STREAM_SESSION_LOG];
+    }
+    for (i = 0U; i < srv->cfg.max_clients && n < max; ++i) {
+        if (srv->clients[i].fd >= 0) {
+            out[n++] = srv->clients[i].session;
+        }
+    }
+    /* A few dozen entries at most: insertion sort by accept order. */
+    for (i = 1U; i < n; ++i) {
+        stream_session_stats_t tmp = out[i];
+
+        for (j = i; j > 0U && out[j - 1U].id > tmp.id; --j) {
+            out[j] = out[j - 1U];
+        }
+        out[j] = tmp;
+    }
+    return n;
+}
+
+const char *stream_mode_name(stream_mode_t mode)
+{
+    switch (mode) {
+        case STREAM_MODE_LATENCY:
+            return "latency";
+        case STREAM_MODE_THROUGHPUT:
+            return "throughput";
+        default:
+            return "unknown";
+    }
+}
+
+const char *stream_policy_name(stream_policy_t policy)
+{
+    switch (policy) {
+        case STREAM_POLICY_DROP_OLDEST:
+            return "drop-oldest";
+        case STREAM_POLICY_DISCONNECT:
+            return "disconnect";
+        case STREAM_POLICY_NEVER_DROP:
+            return "never-drop";
+        default:
+            return "unknown";
+    }
+}
+
+const char *stream_close_name(stream_close_t reason)
+{
+    switch (reason) {
+        case STREAM_CLOSE_NONE:
+            return "open";
+        case STREAM_CLOSE_PEER:
+            return "closed by peer";
+        case STREAM_CLOSE_ERROR:
+            return "send error";
+        case STREAM_CLOSE_PROTOCOL:
+            return "protocol error";
+        case STREAM_CLOSE_LAGGING:
+            return "lagging";
+        case STREAM_CLOSE_OVERRUN:
+            return "history overrun";
+        default:
+            return "unknown";
+    }
+}
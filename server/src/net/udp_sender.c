@@ -0,0 +1,362 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Miguel Dovale (University of Arizona)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/* sendmmsg() is a GNU extension. */
+#define _GNU_SOURCE
+
+#include "udp_sender.h"
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <time.h>
+#include <unistd.h>
+
+#define ANNOUNCE_BYTES (PROTO_HEADER_BYTES + PROTO_HELLO_BYTES + PROTO_HEADER_BYTES + PROTO_CONFIG_BYTES)
+
+struct udp_sender {
+    udp_sender_cfg_t cfg;
+    int fd;
+    struct sockaddr_in addr;
+    proto_data_encoder_t enc;   /* enc.count frames are in the datagram at slot queued */
+    uint32_t frames_per_datagram;
+    size_t datagram_bytes;      /* slot size: the largest DATA message of frames_per_datagram frames */
+    uint8_t *slots;             /* batch datagrams */
+    struct iovec *iov;
+    struct mmsghdr *msgs;
+    uint32_t queued;            /* finished datagrams waiting for sendmmsg() */
+    uint32_t next_msg_seq;
+    uint8_t announce[ANNOUNCE_BYTES];
+    size_t hello_len;
+    size_t config_len;
+    uint64_t next_announce_ns;
+    udp_sender_stats_t stats;
+};
+
+static uint64_t monotonic_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+static uint8_t *slot(const udp_sender_t *snd, uint32_t idx)
+{
+    return snd->slots + ((size_t)idx * snd->datagram_bytes);
+}
+
+/* A datagram the kernel did not take is gone: receivers see it as a msg_seq gap. */
+static void send_queued(udp_sender_t *snd)
+{
+    uint32_t sent = 0U;
+    uint32_t idx;
+
+    for (idx = 0U; idx < snd->queued; ++idx) {
+        const uint8_t *buf = slot(snd, idx);
+
+        snd->iov[idx].iov_base = (void *)buf;
+        snd->iov[idx].iov_len = PROTO_HEADER_BYTES + proto_load_u32(buf + 12);
+    }
+    while (sent < snd->queued) {
+        int n = sendmmsg(snd->fd, snd->msgs + sent, snd->queued - sent, 0);
+
+        ++snd->stats.send_calls;
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != ENOBUFS) {
+                ++snd->stats.send_errors;
+            }
+            snd->stats.dropped += snd->queued - sent;
+            break;
+        }
+        for (idx = sent; idx < sent + (uint32_t)n; ++idx) {
+            snd->stats.bytes += snd->msgs[idx].msg_len;
+        }
+        snd->stats.datagrams += (uint32_t)n;
+        sent += (uint32_t)n;
+    }
+    snd->queued = 0U;
+}
+
+static void close_datagram(udp_sender_t *snd)
+{
+    (void)proto_data_finish(&snd->enc);
+    snd->enc.count = 0U;
+    ++snd->next_msg_seq;
+    if (++snd->queued == snd->cfg.batch) {
+        send_queued(snd);
+    }
+}
+
+static void announce(udp_sender_t *snd)
+{
+    struct iovec iov[2];
+    struct mmsghdr msgs[2];
+    int n;
+
+    memset(msgs, 0, sizeof(msgs));
+    iov[0].iov_base = snd->announce;
+    iov[0].iov_len = snd->hello_len;
+    iov[1].iov_base = snd->announce + snd->hello_len;
+    iov[1].iov_len = snd->config_len;
+    msgs[0].msg_hdr.msg_name = &snd->addr;
+    msgs[0].msg_hdr.msg_namelen = sizeof(snd->addr);
+    msgs[0].msg_hdr.msg_iov = &iov[0];
+    msgs[0].msg_hdr.msg_iovlen = 1U;
+    msgs[1].msg_hdr = msgs[0].msg_hdr;
+    msgs[1].msg_hdr.msg_iov = &iov[1];
+
+    n = sendmmsg(snd->fd, msgs, 2U, 0);
+    ++snd->stats.send_calls;
+    if (n == 2) {
+        snd->stats.bytes += snd->hello_len + snd->config_len;
+        ++snd->stats.announces;
+    } else if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != ENOBUFS) {
+        ++snd->stats.send_errors;
+    }
+}
+
+void udp_sender_push(udp_sender_t *snd, const ads1278_frame_t *frames, size_t n)
+{
+    while (n != 0U) {
+        size_t taken;
+
+        if (snd->enc.count == 0U) {
+            proto_data_begin(&snd->enc, slot(snd, snd->queued), snd->next_msg_seq, frames);
+        }
+        taken = proto_data_append(&snd->enc, frames, n);
+        snd->stats.frames += taken;
+        frames += taken;
+        n -= taken;
+        /* A short append means the encoding needs a new datagram (seq gap, time step). */
+        if (n != 0U || snd->enc.count == snd->frames_per_datagram) {
+            close_datagram(snd);
+        }
+    }
+}
+
+void udp_sender_flush(udp_sender_t *snd)
+{
+    uint64_t now;
+
+    if (snd->enc.count != 0U) {
+        close_datagram(snd);
+    }
+    if (snd->queued != 0U) {
+        send_queued(snd);
+    }
+    now = monotonic_ns();
+    if (now >= snd->next_announce_ns) {
+        announce(snd);
+        snd->next_announce_ns = now + ((uint64_t)snd->cfg.announce_ms * 1000000ULL);
+    }
+}
+
+static int open_socket(udp_sender_t *snd)
+{
+    struct sockaddr_in *addr = &snd->addr;
+    int sndbuf = (int)snd->cfg.sndbuf;
+    socklen_t len = sizeof(sndbuf);
+
+    memset(addr, 0, sizeof(*addr));
+    addr->sin_family = AF_INET;
+    addr->sin_port = htons(snd->cfg.port);
+    if (snd->cfg.dest == NULL || snd->cfg.port == 0U || inet_pton(AF_INET, snd->cfg.dest, &addr->sin_addr) != 1) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    snd->fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (snd->fd < 0) {
+        return -1;
+    }
+    /* Capped by net.core.wmem_max; the kernel reports twice what it granted. */
+    (void)setsockopt(snd->fd, SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf));
+    if (getsockopt(snd->fd, SOL_SOCKET, SO_SNDBUF, &sndbuf, &len) == 0) {
+        snd->stats.sndbuf = (uint32_t)sndbuf / 2U;
+    }
+
+    if (IN_MULTICAST(ntohl(addr->sin_addr.s_addr))) {
+        int ttl = (snd->cfg.ttl != 0U) ? snd->cfg.ttl : 1;
+        int loop = snd->cfg.no_loop ? 0 : 1;
+
+        if (setsockopt(snd->fd, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl)) != 0 ||
+            setsockopt(snd->fd, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof(loop)) != 0) {
+            return -1;
+        }
+        if (snd->cfg.iface != NULL) {
+            struct in_addr iface;
+
+            if (inet_pton(AF_INET, snd->cfg.iface, &iface) != 1) {
+                errno = EINVAL;
+                return -1;
+            }
+            if (setsockopt(snd->fd, IPPROTO_IP, IP_MULTICAST_IF, &iface, sizeof(iface)) != 0) {
+                return -1;
+            }
+        }
+    }
+
+    /*
+     * Left unconnected: a connected socket would report ICMP port unreachable
+     * from a unicast host with no listener yet as an error on a later send.
+     */
+    return 0;
+}
+
+int udp_sender_create(udp_sender_t **out, const udp_sender_cfg_t *cfg)
+{
+    udp_sender_t *snd;
+    uint32_t channels;
+    size_t room;
+    uint32_t idx;
+
+    if (out == NULL || cfg == NULL || (cfg->batch > UDP_MAX_BATCH)) {
+        errno = EINVAL;
+        return -1;
+    }
+    *out = NULL;
+
+    snd = calloc(1U, sizeof(*snd));
+    if (snd == NULL) {
+        return -1;
+    }
+    snd->fd = -1;
+    snd->cfg = *cfg;
+    if (snd->cfg.mtu == 0U) {
+        snd->cfg.mtu = UDP_DEFAULT_MTU;
+    }
+    if (snd->cfg.batch == 0U) {
+        snd->cfg.batch = UDP_DEFAULT_BATCH;
+    }
+    if (snd->cfg.sndbuf == 0U) {
+        snd->cfg.sndbuf = UDP_DEFAULT_SNDBUF;
+    }
+    if (snd->cfg.announce_ms == 0U) {
+        snd->cfg.announce_ms = UDP_DEFAULT_ANNOUNCE_MS;
+    }
+    if (snd->cfg.encoding == 0U) {
+        snd->cfg.encoding = PROTO_DATA_ENC_P24;
+    }
+    channels = (cfg->hello.channel_count != 0U) ? cfg->hello.channel_count : ADS1278_CHANNEL_COUNT;
+    snd->cfg.hello.channel_count = (uint16_t)channels;
+
+    /* As many frames as the worst-case message leaves under the MTU. */
+    room = (snd->cfg.mtu > UDP_IP_OVERHEAD) ? snd->cfg.mtu - UDP_IP_OVERHEAD : 0U;
+    if (proto_data_max_bytes(snd->cfg.encoding, channels, 1U) == 0U) {
+        errno = EINVAL;
+        goto fail;
+    }
+    while (proto_data_max_bytes(snd->cfg.encoding, channels, snd->frames_per_datagram + 1U) <= room) {
+        ++snd->frames_per_datagram;
+    }
+    if (snd->frames_per_datagram == 0U) {
+        errno = EMSGSIZE;
+        goto fail;
+    }
+    snd->datagram_bytes = proto_data_max_bytes(snd->cfg.encoding, channels, snd->frames_per_datagram);
+    snd->stats.frames_per_datagram = snd->frames_per_datagram;
+
+    if (proto_data_encoder_init(&snd->enc, snd->cfg.encoding, channels, snd->frames_per_datagram) != 0) {
+        goto fail;
+    }
+    snd->enc.linear_ts = snd->cfg.linear_ts;
+    snd->enc.linear_tolerance_ns = snd->cfg.linear_tolerance_ns;
+    snd->slots = calloc(snd->cfg.batch, snd->datagram_bytes);
+    snd->iov = calloc(snd->cfg.batch, sizeof(*snd->iov));
+    snd->msgs = calloc(snd->cfg.batch, sizeof(*snd->msgs));
+    if (snd->slots == NULL || snd->iov == NULL || snd->msgs == NULL) {
+        goto fail;
+    }
+    for (idx = 0U; idx < snd->cfg.batch; ++idx) {
+        snd->msgs[idx].msg_hdr.msg_name = &snd->addr;
+        snd->msgs[idx].msg_hdr.msg_namelen = sizeof(snd->addr);
+        snd->msgs[idx].msg_hdr.msg_iov = &snd->iov[idx];
+        snd->msgs[idx].msg_hdr.msg_iovlen = 1U;
+    }
+
+    snd->hello_len = proto_encode_hello(snd->announce, 0U, &snd->cfg.hello);
+    snd->config_len = proto_encode_config(snd->announce + snd->hello_len, 0U, &snd->cfg.announce);
+
+    if (open_socket(snd) != 0) {
+        goto fail;
+    }
+
+    *out = snd;
+    return 0;
+
+fail:
+    {
+        int saved_errno = errno;
+
+        /* Nothing to flush on a half-configured socket. */
+        if (snd->fd >= 0) {
+            (void)close(snd->fd);
+            snd->fd = -1;
+        }
+        udp_sender_destroy(snd);
+        errno = saved_errno;
+    }
+    return -1;
+}
+
+void udp_sender_get_stats(const udp_sender_t *snd, udp_sender_stats_t *out)
+{
+    if (snd == NULL || out == NULL) {
+        return;
+    }
+    *out = snd->stats;
+    out->linear_ts_msgs = snd->enc.linear_msgs;
+}
+
+void udp_sender_destroy(udp_sender_t *snd)
+{
+    if (snd == NULL) {
+        return;
+    }
+    if (snd->fd >= 0) {
+        udp_sender_flush(snd);
+        (void)close(snd->fd);
+    }
+    proto_data_encoder_destroy(&snd->enc);
+    free(snd->msgs);
+    free(snd->iov);
+    free(snd->slots);
+    free(snd);
+}
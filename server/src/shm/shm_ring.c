@@ -0,0 +1,443 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Miguel Dovale (University of Arizona)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "shm_ring.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <time.h>
+#include <unistd.h>
+
+_Static_assert(sizeof(shm_ring_header_t) <= SHM_RING_HEADER_BYTES, "shm ring header too large");
+_Static_assert(sizeof(shm_ring_slot_t) == 16, "shm ring slot header changed");
+
+struct shm_ring_writer {
+    char name[NAME_MAX + 1];
+    shm_ring_header_t *hdr;
+    uint8_t *slots;
+    size_t map_bytes;
+    uint64_t mask;
+    uint32_t channels;
+    uint32_t slot_bytes;
+    uint64_t head;              /* private copy of hdr->head */
+};
+
+struct shm_ring_reader {
+    const shm_ring_header_t *hdr;
+    const uint8_t *slots;
+    size_t map_bytes;
+    uint64_t capacity;
+    uint64_t mask;
+    uint32_t slot_bytes;
+    uint32_t channels;
+    uint64_t pos;               /* next frame to read */
+    shm_ring_reader_stats_t stats;
+};
+
+static uint32_t slot_bytes_for(uint32_t channels)
+{
+    size_t bytes = sizeof(shm_ring_slot_t) + ((size_t)channels * sizeof(int32_t));
+
+    return (uint32_t)((bytes + 7U) & ~(size_t)7U);
+}
+
+static int check_name(const char *name)
+{
+    size_t len = strlen(name);
+
+    if ((len < 2U) || (len > NAME_MAX) || (name[0] != '/') || (strchr(name + 1, '/') != NULL)) {
+        errno = EINVAL;
+        return -1;
+    }
+    return 0;
+}
+
+static bool pid_alive(int64_t pid)
+{
+    if (pid <= 0) {
+        return false;
+    }
+    return (kill((pid_t)pid, 0) == 0) || (errno == EPERM);
+}
+
+/* An existing object is stale unless a live writer still owns it. */
+static int claim_stale(const char *name)
+{
+    int fd = shm_open(name, O_RDONLY, 0);
+    struct stat st;
+    bool busy = false;
+
+    if (fd < 0) {
+        return (errno == ENOENT) ? 0 : -1;
+    }
+    if ((fstat(fd, &st) == 0) && ((size_t)st.st_size >= SHM_RING_HEADER_BYTES)) {
+        const shm_ring_header_t *hdr = mmap(NULL, SHM_RING_HEADER_BYTES, PROT_READ, MAP_SHARED, fd, 0);
+
+        if (hdr != MAP_FAILED) {
+            busy = (hdr->magic == SHM_RING_MAGIC) &&
+                   (atomic_load_explicit(&hdr->state, memory_order_acquire) == SHM_RING_LIVE) &&
+                   pid_alive(hdr->writer_pid);
+            munmap((void *)hdr, SHM_RING_HEADER_BYTES);
+        }
+    }
+    close(fd);
+    if (busy) {
+        errno = EBUSY;
+        return -1;
+    }
+    if ((shm_unlink(name) != 0) && (errno != ENOENT)) {
+        return -1;
+    }
+    return 0;
+}
+
+int shm_ring_writer_create(shm_ring_writer_t **out, const shm_ring_cfg_t *cfg)
+{
+    shm_ring_writer_t *w = NULL;
+    const char *name;
+    uint64_t capacity;
+    uint32_t channels;
+    struct timespec ts;
+    void *map;
+    int fd = -1;
+    int attempt;
+    int saved;
+
+    if ((out == NULL) || (cfg == NULL)) {
+        errno = EINVAL;
+        return -1;
+    }
+    *out = NULL;
+    name = (cfg->name != NULL) ? cfg->name : SHM_RING_DEFAULT_NAME;
+    capacity = (cfg->capacity != 0U) ? cfg->capacity : SHM_RING_DEFAULT_FRAMES;
+    channels = (cfg->channels != 0U) ? cfg->channels : 8U;
+    if ((check_name(name) != 0) || ((capacity & (capacity - 1U)) != 0U) ||
+        (capacity > ((uint64_t)1 << 32)) || (channels > ADS1278_MAX_CHANNELS)) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    w = calloc(1, sizeof(*w));
+    if (w == NULL) {
+        return -1;
+    }
+    memcpy(w->name, name, strlen(name) + 1U);
+    w->channels = channels;
+    w->slot_bytes = slot_bytes_for(channels);
+    w->mask = capacity - 1U;
+    w->map_bytes = SHM_RING_HEADER_BYTES + ((size_t)capacity * w->slot_bytes);
+
+    for (attempt = 0; attempt < 2; ++attempt) {
+        fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0644);
+        if ((fd >= 0) || (errno != EEXIST) || (claim_stale(name) != 0)) {
+            break;
+        }
+    }
+    if (fd < 0) {
+        goto fail;
+    }
+    /* ftruncate() leaves state 0, which readers treat as not ready yet. */
+    if (ftruncate(fd, (off_t)w->map_bytes) != 0) {
+        goto fail_unlink;
+    }
+    map = mmap(NULL, w->map_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) {
+        goto fail_unlink;
+    }
+    close(fd);
+    fd = -1;
+    w->hdr = map;
+    w->slots = (uint8_t *)map + SHM_RING_HEADER_BYTES;
+    if (!atomic_is_lock_free(&w->hdr->head)) {
+        errno = ENOTSUP;
+        goto fail_unlink;
+    }
+    /* Fault the slots in now rather than on the acquisition thread's first lap. */
+    memset(w->slots, 0, w->map_bytes - SHM_RING_HEADER_BYTES);
+
+    clock_gettime(CLOCK_REALTIME, &ts);
+    w->hdr->magic = SHM_RING_MAGIC;
+    w->hdr->version = SHM_RING_VERSION;
+    w->hdr->header_bytes = SHM_RING_HEADER_BYTES;
+    w->hdr->channels = channels;
+    w->hdr->slot_bytes = w->slot_bytes;
+    w->hdr->capacity = capacity;
+    w->hdr->sample_rate_hz = cfg->sample_rate_hz;
+    w->hdr->writer_pid = (int64_t)getpid();
+    w->hdr->created_ns = ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+    atomic_store_explicit(&w->hdr->claim, 0, memory_order_relaxed);
+    atomic_store_explicit(&w->hdr->head, 0, memory_order_relaxed);
+    atomic_store_explicit(&w->hdr->state, SHM_RING_LIVE, memory_order_release);
+
+    *out = w;
+    return 0;
+
+fail_unlink:
+    saved = errno;
+    shm_unlink(name);
+    errno = saved;
+fail:
+    saved = errno;
+    if (fd >= 0) {
+        close(fd);
+    }
+    if (w->hdr != NULL) {
+        munmap(w->hdr, w->map_bytes);
+    }
+    free(w);
+    errno = saved;
+    return -1;
+}
+
+void shm_ring_writer_publish(shm_ring_writer_t *w, const ads1278_frame_t *frames, size_t n)
+{
+    size_t ch_bytes = (size_t)w->channels * sizeof(int32_t);
+
+    while (n > 0U) {
+        size_t chunk = (n > (size_t)(w->mask + 1U)) ? (size_t)(w->mask + 1U) : n;
+        size_t i;
+
+        /* Readers of the slots about to be reused must see the claim first. */
+        atomic_store_explicit(&w->hdr->claim, w->head + chunk, memory_order_relaxed);
+        atomic_thread_fence(memory_order_release);
+        for (i = 0; i < chunk; ++i) {
+            shm_ring_slot_t *s = (shm_ring_slot_t *)(w->slots + (((w->head + i) & w->mask) * w->slot_bytes));
+
+            s->seq = frames[i].seq;
+            s->tstamp_ns = frames[i].tstamp_ns;
+            memcpy(s->ch, frames[i].ch, ch_bytes);
+        }
+        w->head += chunk;
+        atomic_store_explicit(&w->hdr->head, w->head, memory_order_release);
+        frames += chunk;
+        n -= chunk;
+    }
+}
+
+uint64_t shm_ring_writer_frames(const shm_ring_writer_t *w)
+{
+    return w->head;
+}
+
+void shm_ring_writer_destroy(shm_ring_writer_t *w)
+{
+    if (w == NULL) {
+        return;
+    }
+    atomic_store_explicit(&w->hdr->state, SHM_RING_CLOSED, memory_order_release);
+    shm_unlink(w->name);
+    munmap(w->hdr, w->map_bytes);
+    free(w);
+}
+
+int shm_ring_reader_open(shm_ring_reader_t **out, const char *name, bool from_oldest)
+{
+    shm_ring_reader_t *r = NULL;
+    const shm_ring_header_t *hdr;
+    struct stat st;
+    void *map = MAP_FAILED;
+    size_t map_bytes = 0;
+    uint64_t head;
+    int fd;
+    int saved;
+
+    if (out == NULL) {
+        errno = EINVAL;
+        return -1;
+    }
+    *out = NULL;
+    if (name == NULL) {
+        name = SHM_RING_DEFAULT_NAME;
+    }
+    fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    if (fstat(fd, &st) != 0) {
+        goto fail;
+    }
+    if ((size_t)st.st_size < SHM_RING_HEADER_BYTES) {
+        errno = EAGAIN;
+        goto fail;
+    }
+    map_bytes = (size_t)st.st_size;
+    map = mmap(NULL, map_bytes, PROT_READ, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) {
+        goto fail;
+    }
+    hdr = map;
+    if (atomic_load_explicit(&hdr->state, memory_order_acquire) == 0U) {
+        errno = EAGAIN;
+        goto fail;
+    }
+    if ((hdr->magic != SHM_RING_MAGIC) || (hdr->version != SHM_RING_VERSION) ||
+        (hdr->header_bytes != SHM_RING_HEADER_BYTES) || (hdr->channels > ADS1278_MAX_CHANNELS) ||
+        (hdr->slot_bytes != slot_bytes_for(hdr->channels)) || (hdr->capacity == 0U) ||
+        ((hdr->capacity & (hdr->capacity - 1U)) != 0U) ||
+        (map_bytes < SHM_RING_HEADER_BYTES + (hdr->capacity * hdr->slot_bytes))) {
+        errno = EPROTO;
+        goto fail;
+    }
+
+    r = calloc(1, sizeof(*r));
+    if (r == NULL) {
+        goto fail;
+    }
+    close(fd);
+    r->hdr = hdr;
+    r->slots = (const uint8_t *)map + SHM_RING_HEADER_BYTES;
+    r->map_bytes = map_bytes;
+    r->capacity = hdr->capacity;
+    r->mask = hdr->capacity - 1U;
+    r->slot_bytes = hdr->slot_bytes;
+    r->channels = hdr->channels;
+    head = atomic_load_explicit(&hdr->head, memory_order_acquire);
+    if (!from_oldest) {
+        r->pos = head;
+    } else {
+        r->pos = (head > r->capacity) ? (head - r->capacity) : 0U;
+    }
+    *out = r;
+    return 0;
+
+fail:
+    saved = errno;
+    if (map != MAP_FAILED) {
+        munmap(map, map_bytes);
+    }
+    close(fd);
+    errno = saved;
+    return -1;
+}
+
+const shm_ring_header_t *shm_ring_reader_header(const shm_ring_reader_t *r)
+{
+    return r->hdr;
+}
+
+/* Skip to the newest frame after being overtaken. */
+static void skip_lapped(shm_ring_reader_t *r, uint64_t head)
+{
+    r->stats.laps++;
+    r->stats.frames_lost += head - r->pos;
+    r->pos = head;
+}
+
+size_t shm_ring_reader_peek(shm_ring_reader_t *r, uint64_t *first, size_t max)
+{
+    uint64_t head = atomic_load_explicit(&r->hdr->head, memory_order_acquire);
+    uint64_t avail;
+
+    if (head - r->pos > r->capacity) {
+        skip_lapped(r, head);
+    }
+    avail = head - r->pos;
+    if (avail > max) {
+        avail = max;
+    }
+    *first = r->pos;
+    return (size_t)avail;
+}
+
+const shm_ring_slot_t *shm_ring_reader_slot(const shm_ring_reader_t *r, uint64_t pos)
+{
+    return (const shm_ring_slot_t *)(r->slots + ((pos & r->mask) * r->slot_bytes));
+}
+
+int shm_ring_reader_release(shm_ring_reader_t *r, size_t n)
+{
+    uint64_t claim;
+
+    /* Order the slot reads before the claim check (seqlock read side). */
+    atomic_thread_fence(memory_order_acquire);
+    claim = atomic_load_explicit(&r->hdr->claim, memory_order_relaxed);
+    if (claim > r->pos + r->capacity) {
+        skip_lapped(r, atomic_load_explicit(&r->hdr->head, memory_order_acquire));
+        errno = ESTALE;
+        return -1;
+    }
+    r->pos += n;
+    r->stats.frames += n;
+    return 0;
+}
+
+size_t shm_ring_reader_read(shm_ring_reader_t *r, ads1278_frame_t *out, size_t max)
+{
+    size_t ch_bytes = (size_t)r->channels * sizeof(int32_t);
+
+    for (;;) {
+        uint64_t first;
+        size_t n = shm_ring_reader_peek(r, &first, max);
+        size_t i;
+
+        if (n == 0U) {
+            return 0;
+        }
+        for (i = 0; i < n; ++i) {
+            const shm_ring_slot_t *s = shm_ring_reader_slot(r, first + i);
+
+            out[i].seq = s->seq;
+            out[i].tstamp_ns = s->tstamp_ns;
+            memcpy(out[i].ch, s->ch, ch_bytes);
+        }
+        if (shm_ring_reader_release(r, n) == 0) {
+            return n;
+        }
+    }
+}
+
+bool shm_ring_reader_closed(const shm_ring_reader_t *r)
+{
+    return (atomic_load_explicit(&r->hdr->state, memory_order_acquire) != SHM_RING_LIVE) ||
+           !pid_alive(r->hdr->writer_pid);
+}
+
+void shm_ring_reader_get_stats(const shm_ring_reader_t *r, shm_ring_reader_stats_t *out)
+{
+    *out = r->stats;
+}
+
+void shm_ring_reader_close(shm_ring_reader_t *r)
+{
+    if (r == NULL) {
+        return;
+    }
+    munmap((void *)r->hdr, r->map_bytes);
+    free(r);
+}
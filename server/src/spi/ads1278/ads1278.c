@@ -30,590 +30,522 @@
  */
 
 #include "ads1278.h"
+#include "ads1278_backend.h"
+#include "ads1278_unpack.h"
+#include "clock_model.h"
+#include "drdy_model.h"
 
 #include <errno.h>
+#include <math.h>
+#include <stdatomic.h>
 #include <stdint.h>
-#include <stdio.h>
-#include <string.h>
-
-#ifndef __linux__
-
-int ads1278_open(const ads1278_cfg_t *cfg)
-{
-    (void)cfg;
-    errno = ENOTSUP;
-    return -1;
-}
-
-int ads1278_start(void)
-{
-    errno = ENOTSUP;
-    return -1;
-}
-
-int ads1278_read_frame(ads1278_frame_t *out)
-{
-    (void)out;
-    errno = ENOTSUP;
-    return -1;
-}
-
-int ads1278_get_last_raw_frame(uint8_t out[ADS1278_TDM_FRAME_BYTES])
-{
-    (void)out;
-    errno = ENOTSUP;
-    return -1;
-}
-
-void ads1278_stop(void)
-{
-}
-
-void ads1278_close(void)
-{
-}
-
-#else
-
-#include <fcntl.h>
-#include <linux/spi/spidev.h>
-#include <poll.h>
 #include <stdlib.h>
-#include <sys/ioctl.h>
+#include <string.h>
 #include <time.h>
-#include <unistd.h>
 
 #define ADS1278_SYNC_PULSE_US 10U
 #define ADS1278_OVERLONG_XFER_WARN_US 5000U
 
-typedef struct {
-    uint32_t line_number;
-    int fd;
-    int exported;
-} ads1278_gpio_t;
-
-typedef struct {
-    int is_open;
+/* One ADS1278: its backend instance, seq model and read-path statistics. */
+struct ads1278_dev {
     int started;
-    int spi_fd;
-    uint64_t seq;
+    int fresh;                  /* next DRDY is the first since start or SYNC */
+    drdy_model_t model;         /* assigns seq; reading thread only */
+    clock_model_t clock;        /* smooths timestamps against seq; reading thread only */
     ads1278_cfg_t cfg;
-    ads1278_gpio_t drdy_gpio;
-    ads1278_gpio_t sync_gpio;
-    uint8_t tx_zeros[ADS1278_TDM_FRAME_BYTES];
-    uint8_t last_raw[ADS1278_TDM_FRAME_BYTES];
-} ads1278_ctx_t;
-
-static ads1278_ctx_t g_ctx = {
-    .spi_fd = -1,
-    .drdy_gpio = {.fd = -1},
-    .sync_gpio = {.fd = -1}
+    const ads1278_backend_ops_t *ops;
+    void *backend;
+    uint32_t chain;             /* devices on the daisy chain, >= 1 */
+    size_t frame_bytes;         /* chain * ADS1278_TDM_FRAME_BYTES per DRDY */
+    uint8_t last_raw[ADS1278_MAX_FRAME_BYTES];
+
+    /* Written only by the reading thread; ads1278_dev_get_stats() may run anywhere. */
+    _Atomic uint64_t frames;
+    _Atomic uint64_t drdy_timeouts;
+    _Atomic uint64_t missed_drdy;
+    _Atomic uint64_t overlong_xfers;
+    _Atomic uint64_t missed_conversions;
+    _Atomic uint64_t gap_events;
+    _Atomic uint64_t longest_gap;
+    _Atomic uint64_t ambiguous_intervals;
+    _Atomic uint64_t period_ps; /* drdy_model period, picoseconds */
+    _Atomic uint64_t jitter_ps; /* clock_model jitter, picoseconds */
+    _Atomic uint64_t jitter_max_ns;
+    _Atomic int64_t drift_ppb;
+    _Atomic uint64_t clock_outliers;
+    _Atomic uint64_t clock_relocks;
+    lat_recorder_t wakeup;
+    lat_recorder_t xfer;
+    lat_recorder_t parse;
 };
 
-static int write_text_file(const char *path, const char *value)
-{
-    int fd = open(path, O_WRONLY | O_CLOEXEC);
-    ssize_t written;
-
-    if (fd < 0) {
-        return -1;
-    }
-
-    written = write(fd, value, strlen(value));
-    if (written < 0 || (size_t)written != strlen(value)) {
-        int saved_errno = (written < 0) ? errno : EIO;
-        close(fd);
-        errno = saved_errno;
-        return -1;
-    }
+/* Device behind the single-instance ads1278_open() API. */
+static ads1278_dev_t *g_dev;
 
-    if (close(fd) < 0) {
-        return -1;
-    }
-
-    return 0;
-}
-
-static int sysfs_export_gpio(uint32_t line_number, int *did_export)
+/* Off Linux the spidev backend is a stub failing with ENOTSUP, as the whole driver was before. */
+static const ads1278_backend_ops_t *backend_lookup(ads1278_backend_id_t backend)
 {
-    char buf[32];
-    int rc;
-
-    snprintf(buf, sizeof(buf), "%u", line_number);
-    rc = write_text_file("/sys/class/gpio/export", buf);
-    if (rc == 0) {
-        *did_export = 1;
-        return 0;
+    switch (backend) {
+        case ADS1278_BACKEND_SPIDEV:
+            return &ads1278_backend_spidev_ops;
+        case ADS1278_BACKEND_SIM:
+            return &ads1278_backend_sim_ops;
+        default:
+            return NULL;
     }
-
-    if (errno == EBUSY) {
-        *did_export = 0;
-        return 0;
-    }
-    return -1;
 }
 
-static int sysfs_unexport_gpio(uint32_t line_number)
+/* A free-running sim has no conversion clock to model. */
+static void reset_model(ads1278_dev_t *dev)
 {
-    char buf[32];
+    bool periodic = !(dev->cfg.backend == ADS1278_BACKEND_SIM && dev->cfg.sim.drdy_rate_hz == 0U &&
+        dev->cfg.drdy_gpiochip == NULL);
+    uint32_t nominal_hz = (dev->cfg.backend == ADS1278_BACKEND_SIM && dev->cfg.drdy_gpiochip == NULL) ?
+        dev->cfg.sim.drdy_rate_hz : 0U;
 
-    snprintf(buf, sizeof(buf), "%u", line_number);
-    return write_text_file("/sys/class/gpio/unexport", buf);
+    drdy_model_init(&dev->model, periodic, nominal_hz);
+    clock_model_init(&dev->clock, nominal_hz);
 }
 
-static int sysfs_set_gpio_attr(uint32_t line_number, const char *attr, const char *value)
+/* Place a frame on the conversion grid and publish what the model learned. */
+static uint64_t next_seq(ads1278_dev_t *dev, uint64_t tstamp_ns, uint32_t known_missed)
 {
-    char path[96];
+    uint64_t gaps = dev->model.gaps;
+    uint64_t ambiguous = dev->model.ambiguous;
+    uint64_t seq = drdy_model_next(&dev->model, tstamp_ns, known_missed);
 
-    snprintf(path, sizeof(path), "/sys/class/gpio/gpio%u/%s", line_number, attr);
-    return write_text_file(path, value);
+    if (dev->model.gaps != gaps) {
+        atomic_store_explicit(&dev->missed_conversions, dev->model.missed, memory_order_relaxed);
+        atomic_store_explicit(&dev->gap_events, dev->model.gaps, memory_order_relaxed);
+        atomic_store_explicit(&dev->longest_gap, dev->model.longest_gap, memory_order_relaxed);
+    }
+    if (dev->model.ambiguous != ambiguous) {
+        atomic_store_explicit(&dev->ambiguous_intervals, dev->model.ambiguous, memory_order_relaxed);
+    }
+    atomic_store_explicit(&dev->period_ps, (uint64_t)(dev->model.period_ns * 1000.0), memory_order_relaxed);
+    return seq;
 }
 
-static int sysfs_open_gpio_value(uint32_t line_number, int flags)
+/* Run the clock model on a placed frame; its stats are published once per block. */
+static uint64_t next_tstamp(ads1278_dev_t *dev, uint64_t seq, uint64_t edge_ns)
 {
-    char path[96];
-
-    snprintf(path, sizeof(path), "/sys/class/gpio/gpio%u/value", line_number);
-    return open(path, flags | O_CLOEXEC);
+    uint64_t block_start_ns = dev->clock.block_start_ns;
+    uint64_t smoothed;
+
+    if (!dev->model.enabled) {
+        return edge_ns;
+    }
+    smoothed = clock_model_next(&dev->clock, seq, edge_ns);
+    if (dev->clock.block_start_ns != block_start_ns) {
+        atomic_store_explicit(&dev->jitter_ps, (uint64_t)(clock_model_jitter_ns(&dev->clock) * 1000.0),
+                              memory_order_relaxed);
+        atomic_store_explicit(&dev->jitter_max_ns, dev->clock.resid_max_ns, memory_order_relaxed);
+        atomic_store_explicit(&dev->drift_ppb, (int64_t)llround(clock_model_drift_ppm(&dev->clock) * 1000.0),
+                              memory_order_relaxed);
+        atomic_store_explicit(&dev->clock_outliers, dev->clock.outliers, memory_order_relaxed);
+        atomic_store_explicit(&dev->clock_relocks, dev->clock.relocks, memory_order_relaxed);
+    }
+    return dev->cfg.smooth_tstamps ? smoothed : edge_ns;
 }
 
-static uint64_t monotonic_now_ns(void)
+static void sleep_us(uint32_t usec)
 {
-    struct timespec ts = {0, 0};
+    struct timespec ts;
 
-    if (clock_gettime(CLOCK_MONOTONIC, &ts) != 0) {
-        return 0;
+    ts.tv_sec = (time_t)(usec / 1000000U);
+    ts.tv_nsec = (long)(usec % 1000000U) * 1000L;
+    while (nanosleep(&ts, &ts) != 0 && errno == EINTR) {
     }
-
-    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
 }
 
-static void gpio_reset(ads1278_gpio_t *gpio)
+const char *ads1278_backend_name(ads1278_backend_id_t backend)
 {
-    memset(gpio, 0, sizeof(*gpio));
-    gpio->fd = -1;
+    const ads1278_backend_ops_t *ops = backend_lookup(backend);
+
+    return (ops != NULL) ? ops->name : "unknown";
 }
 
-static int gpio_open_drdy(ads1278_gpio_t *gpio, uint32_t line_number)
+int ads1278_dev_open(ads1278_dev_t **out, const ads1278_cfg_t *cfg)
 {
-    gpio_reset(gpio);
-    gpio->line_number = line_number;
+    ads1278_dev_t *dev;
+    const ads1278_backend_ops_t *ops;
 
-    if (sysfs_export_gpio(line_number, &gpio->exported) != 0) {
+    if (out == NULL || cfg == NULL) {
+        errno = EINVAL;
         return -1;
     }
 
-    if (sysfs_set_gpio_attr(line_number, "direction", "in") != 0) {
+    ops = backend_lookup(cfg->backend);
+    if (ops == NULL || cfg->chain_length > ADS1278_MAX_CHAIN) {
+        errno = EINVAL;
         return -1;
     }
 
-    if (sysfs_set_gpio_attr(line_number, "edge", "falling") != 0) {
+    dev = calloc(1U, sizeof(*dev));
+    if (dev == NULL) {
         return -1;
     }
+    dev->cfg = *cfg;
+    if (dev->cfg.spidev_path == NULL) {
+        dev->cfg.spidev_path = ADS1278_DEFAULT_SPIDEV;
+    }
+    if (dev->cfg.sclk_hz == 0U) {
+        dev->cfg.sclk_hz = 1000000U;
+    }
+    if (dev->cfg.drdy_timeout_ms == 0U) {
+        dev->cfg.drdy_timeout_ms = ADS1278_DEFAULT_DRDY_TIMEOUT_MS;
+    }
+    if (dev->cfg.chain_length == 0U) {
+        dev->cfg.chain_length = 1U;
+    }
+    dev->chain = dev->cfg.chain_length;
+    dev->frame_bytes = (size_t)dev->chain * ADS1278_TDM_FRAME_BYTES;
+    dev->ops = ops;
 
-    gpio->fd = sysfs_open_gpio_value(line_number, O_RDONLY | O_NONBLOCK);
-    if (gpio->fd < 0) {
+    if (ops->open(&dev->backend, &dev->cfg) != 0) {
+        int saved_errno = errno;
+
+        free(dev);
+        errno = saved_errno;
         return -1;
     }
 
+    reset_model(dev);
+    *out = dev;
     return 0;
 }
 
-static int gpio_open_sync(ads1278_gpio_t *gpio, uint32_t line_number)
+int ads1278_dev_start(ads1278_dev_t *dev)
 {
-    gpio_reset(gpio);
-    gpio->line_number = line_number;
-
-    if (sysfs_export_gpio(line_number, &gpio->exported) != 0) {
+    if (dev == NULL) {
+        errno = ENODEV;
         return -1;
     }
-
-    if (sysfs_set_gpio_attr(line_number, "direction", "out") != 0) {
-        return -1;
+    if (dev->started) {
+        return 0;
     }
 
-    if (sysfs_set_gpio_attr(line_number, "value", "1") != 0) {
-        return -1;
-    }
+    dev->started = 1;
+    dev->fresh = 1;
+    if (dev->cfg.use_sync && dev->ops->set_sync != NULL) {
+        uint32_t idx;
+        ads1278_frame_t discard = {0};
 
-    gpio->fd = sysfs_open_gpio_value(line_number, O_RDWR);
-    if (gpio->fd < 0) {
-        return -1;
+        if (dev->ops->set_sync(dev->backend, 0) != 0) {
+            dev->started = 0;
+            return -1;
+        }
+        sleep_us(ADS1278_SYNC_PULSE_US);
+        if (dev->ops->set_sync(dev->backend, 1) != 0) {
+            dev->started = 0;
+            return -1;
+        }
+        /* Releasing SYNC restarts the conversion clock: a new grid. */
+        reset_model(dev);
+        dev->fresh = 1;
+
+        for (idx = 0; idx < dev->cfg.settle_frames; ++idx) {
+            if (ads1278_dev_read_frame(dev, &discard) != 0) {
+                dev->started = 0;
+                return -1;
+            }
+        }
     }
 
     return 0;
 }
 
-static int gpio_set_value(const ads1278_gpio_t *gpio, int value)
+/*
+ * One DRDY wait + one transfer of the whole chain; shared by the single-frame
+ * and block paths. *done_ns is when the transfer finished, the start of the
+ * parse stage.
+ */
+static inline int read_raw_frame(ads1278_dev_t *dev, uint8_t *raw, uint64_t *seq, uint64_t *tstamp_ns,
+                                 uint64_t *done_ns)
 {
-    const char out = (value == 0) ? '0' : '1';
+    ads1278_drdy_event_t ev = {0, 0};
+    uint64_t wake_ns;
+    uint64_t post_xfer_ns;
 
-    if (gpio->fd < 0) {
-        errno = EBADF;
+    if (dev->ops->wait_drdy(dev->backend, dev->cfg.drdy_timeout_ms, &ev) != 0) {
+        if (errno == ETIMEDOUT) {
+            lat_counter_add(&dev->drdy_timeouts, 1U);
+        }
         return -1;
     }
+    wake_ns = ads1278_monotonic_now_ns();
+    /* Edges queued between open and start (or before SYNC) were never ours to read. */
+    if (dev->fresh) {
+        dev->fresh = 0;
+        ev.missed = 0U;
+    }
+    if (ev.missed != 0U) {
+        lat_counter_add(&dev->missed_drdy, ev.missed);
+    }
+    if (ev.edge_ns != 0U) {
+        lat_recorder_record(&dev->wakeup, (wake_ns > ev.edge_ns) ? wake_ns - ev.edge_ns : 0U);
+    }
 
-    if (lseek(gpio->fd, 0, SEEK_SET) < 0) {
+    if (dev->ops->transfer(dev->backend, raw, dev->frame_bytes) != 0) {
         return -1;
     }
+    post_xfer_ns = ads1278_monotonic_now_ns();
+    lat_recorder_record(&dev->xfer, post_xfer_ns - wake_ns);
 
-    if (write(gpio->fd, &out, 1) != 1) {
-        if (errno == 0) {
-            errno = EIO;
-        }
-        return -1;
+    /* Counted, not printed: stdio here would stall the next DRDY. */
+    if (ev.edge_ns != 0U && post_xfer_ns > ev.edge_ns &&
+        post_xfer_ns - ev.edge_ns > (uint64_t)ADS1278_OVERLONG_XFER_WARN_US * 1000U) {
+        lat_counter_add(&dev->overlong_xfers, 1U);
     }
 
+    *seq = next_seq(dev, ev.edge_ns, ev.missed);
+    *tstamp_ns = next_tstamp(dev, *seq, ev.edge_ns);
+    *done_ns = post_xfer_ns;
     return 0;
 }
 
-static int gpio_wait_drdy_event(const ads1278_gpio_t *gpio, uint32_t timeout_ms)
+int ads1278_dev_read_frame(ads1278_dev_t *dev, ads1278_frame_t *out)
 {
-    char junk[8];
-    struct pollfd pfd = {0};
-    int rc;
+    uint8_t raw[ADS1278_MAX_FRAME_BYTES] = {0};
+    uint64_t drdy_ts_ns = 0U;
+    uint64_t done_ns = 0U;
+    uint64_t seq = 0U;
 
-    if (gpio->fd < 0) {
-        errno = EBADF;
+    if (out == NULL) {
+        errno = EINVAL;
         return -1;
     }
-
-    if (lseek(gpio->fd, 0, SEEK_SET) < 0) {
+    if (dev == NULL || !dev->started) {
+        errno = EPERM;
         return -1;
     }
-    (void)read(gpio->fd, junk, sizeof(junk));
 
-    pfd.fd = gpio->fd;
-    pfd.events = POLLPRI | POLLERR;
-    rc = poll(&pfd, 1, (int)timeout_ms);
-    if (rc < 0) {
-        return -1;
-    }
-    if (rc == 0) {
-        errno = ETIMEDOUT;
-        return -1;
-    }
-    if ((pfd.revents & POLLPRI) == 0) {
-        errno = EIO;
+    if (read_raw_frame(dev, raw, &seq, &drdy_ts_ns, &done_ns) != 0) {
         return -1;
     }
 
-    if (lseek(gpio->fd, 0, SEEK_SET) < 0) {
-        return -1;
-    }
-    (void)read(gpio->fd, junk, sizeof(junk));
+    memcpy(dev->last_raw, raw, dev->frame_bytes);
+
+    out->seq = seq;
+    out->tstamp_ns = drdy_ts_ns;
+    /* A chain is consecutive 24-byte device frames: ch[d * 8 + c] falls out. */
+    ads1278_unpack_frames(raw, dev->chain, out->ch);
+    lat_recorder_record(&dev->parse, ads1278_monotonic_now_ns() - done_ns);
+    lat_counter_add(&dev->frames, 1U);
 
     return 0;
 }
 
-static void gpio_close(ads1278_gpio_t *gpio)
+int ads1278_dev_read_frames(ads1278_dev_t *dev, ads1278_block_t *blk, size_t n)
 {
-    if (gpio == NULL) {
-        return;
-    }
+    size_t idx;
+    int rc = 0;
 
-    if (gpio->fd >= 0) {
-        close(gpio->fd);
-    }
-    if (gpio->exported) {
-        (void)sysfs_unexport_gpio(gpio->line_number);
+    if (blk == NULL || n > blk->capacity) {
+        errno = EINVAL;
+        return -1;
     }
-
-    gpio_reset(gpio);
-}
-
-static int spi_open_and_configure(const ads1278_cfg_t *cfg)
-{
-    int fd = -1;
-    uint8_t mode;
-    uint8_t effective_mode = 0U;
-    uint8_t bits_per_word = 8U;
-    uint8_t effective_bits_per_word = 0U;
-    uint32_t max_speed_hz;
-    uint32_t effective_max_speed_hz = 0U;
-
-    fd = open(cfg->spidev_path, O_RDWR | O_CLOEXEC);
-    if (fd < 0) {
+    if (dev == NULL || !dev->started) {
+        errno = EPERM;
         return -1;
     }
 
-    mode = cfg->spi_mode;
-#ifdef SPI_NO_CS
-    if (cfg->spi_no_cs) {
-        mode = (uint8_t)(mode | SPI_NO_CS);
-    }
-#endif
+    /*
+     * blk->raw is device-major (device d's frames start at d * capacity * 24)
+     * so each device decodes with the contiguous SoA kernel. A single device
+     * transfers in place; a chain is split out of a staging buffer.
+     */
+    for (idx = 0U; idx < n; ++idx) {
+        uint64_t done_ns;
+        uint32_t device;
 
-    if (ioctl(fd, SPI_IOC_WR_MODE, &mode) < 0) {
-        /* Some kernels/drivers reject SPI_NO_CS with EINVAL even when defined. */
-#ifdef SPI_NO_CS
-        if (cfg->spi_no_cs && errno == EINVAL) {
-            mode = cfg->spi_mode;
-            if (ioctl(fd, SPI_IOC_WR_MODE, &mode) == 0) {
-                goto spi_mode_ok;
+        if (dev->chain == 1U) {
+            if (read_raw_frame(dev, blk->raw + (idx * ADS1278_TDM_FRAME_BYTES), &blk->seq[idx],
+                    &blk->tstamp_ns[idx], &done_ns) != 0) {
+                rc = -1;
+                break;
             }
+            continue;
+        }
+        if (read_raw_frame(dev, dev->last_raw, &blk->seq[idx], &blk->tstamp_ns[idx], &done_ns) != 0) {
+            rc = -1;
+            break;
+        }
+        for (device = 0U; device < dev->chain; ++device) {
+            memcpy(blk->raw + ((((size_t)device * blk->capacity) + idx) * ADS1278_TDM_FRAME_BYTES),
+                dev->last_raw + ((size_t)device * ADS1278_TDM_FRAME_BYTES), ADS1278_TDM_FRAME_BYTES);
         }
-#endif
-        close(fd);
-        return -1;
     }
 
-spi_mode_ok:
-    if (ioctl(fd, SPI_IOC_WR_BITS_PER_WORD, &bits_per_word) < 0) {
-        close(fd);
-        return -1;
-    }
+    blk->count = idx;
+    blk->seq0 = (idx != 0U) ? blk->seq[0] : 0U;
+    blk->channel_count = dev->chain * ADS1278_CHANNEL_COUNT;
+    if (idx != 0U) {
+        int saved_errno = errno;
+        uint64_t parse_start_ns = ads1278_monotonic_now_ns();
+        uint32_t device;
 
-    max_speed_hz = cfg->sclk_hz;
-    if (ioctl(fd, SPI_IOC_WR_MAX_SPEED_HZ, &max_speed_hz) < 0) {
-        close(fd);
-        return -1;
-    }
-
-    if (ioctl(fd, SPI_IOC_RD_MODE, &effective_mode) < 0) {
-        close(fd);
-        return -1;
-    }
-    if (ioctl(fd, SPI_IOC_RD_BITS_PER_WORD, &effective_bits_per_word) < 0) {
-        close(fd);
-        return -1;
-    }
-    if (ioctl(fd, SPI_IOC_RD_MAX_SPEED_HZ, &effective_max_speed_hz) < 0) {
-        close(fd);
-        return -1;
-    }
-    if ((effective_mode & (SPI_CPHA | SPI_CPOL)) != (cfg->spi_mode & (SPI_CPHA | SPI_CPOL))) {
-        close(fd);
-        errno = EINVAL;
-        return -1;
-    }
-    if (effective_bits_per_word != bits_per_word) {
-        close(fd);
-        errno = EINVAL;
-        return -1;
-    }
-    if (effective_max_speed_hz == 0U) {
-        close(fd);
-        errno = EIO;
-        return -1;
+        if (dev->chain == 1U) {
+            memcpy(dev->last_raw, blk->raw + ((idx - 1U) * ADS1278_TDM_FRAME_BYTES), ADS1278_TDM_FRAME_BYTES);
+        }
+        for (device = 0U; device < dev->chain; ++device) {
+            ads1278_unpack_frames_soa(blk->raw + ((size_t)device * blk->capacity * ADS1278_TDM_FRAME_BYTES), idx,
+                &blk->ch[device * ADS1278_CHANNEL_COUNT]);
+        }
+        /* One sample per block: the per-frame average. */
+        lat_recorder_record(&dev->parse, (ads1278_monotonic_now_ns() - parse_start_ns) / idx);
+        lat_counter_add(&dev->frames, idx);
+        errno = saved_errno;
     }
 
-    fprintf(stderr,
-        "ads1278 spi: req(mode=%u,bpw=%u,speed=%u) eff(mode=%u,bpw=%u,speed=%u)\n",
-        (unsigned)cfg->spi_mode,
-        (unsigned)bits_per_word,
-        (unsigned)cfg->sclk_hz,
-        (unsigned)effective_mode,
-        (unsigned)effective_bits_per_word,
-        (unsigned)effective_max_speed_hz);
-
-    return fd;
+    return rc;
 }
 
-static int spi_read_24_bytes(uint8_t rx[ADS1278_TDM_FRAME_BYTES])
+int ads1278_dev_get_last_raw_frame(const ads1278_dev_t *dev, uint8_t out[ADS1278_MAX_FRAME_BYTES])
 {
-    struct spi_ioc_transfer transfer = {0};
-    int rc;
-
-    transfer.tx_buf = (uintptr_t)g_ctx.tx_zeros;
-    transfer.rx_buf = (uintptr_t)rx;
-    transfer.len = ADS1278_TDM_FRAME_BYTES;
-    transfer.speed_hz = g_ctx.cfg.sclk_hz;
-    transfer.bits_per_word = 8U;
-
-    rc = ioctl(g_ctx.spi_fd, SPI_IOC_MESSAGE(1), &transfer);
-    if (rc < 0) {
-        return -1;
-    }
-    if ((uint32_t)rc != ADS1278_TDM_FRAME_BYTES) {
-        errno = EIO;
+    if (out == NULL) {
+        errno = EINVAL;
         return -1;
     }
 
+    if (dev != NULL) {
+        memcpy(out, dev->last_raw, ADS1278_MAX_FRAME_BYTES);
+    } else {
+        memset(out, 0, ADS1278_MAX_FRAME_BYTES);
+    }
     return 0;
 }
 
-static void parse_samples_msb_first(const uint8_t raw[ADS1278_TDM_FRAME_BYTES], ads1278_frame_t *out)
+uint32_t ads1278_dev_channel_count(const ads1278_dev_t *dev)
 {
-    uint32_t idx;
-
-    for (idx = 0; idx < ADS1278_CHANNEL_COUNT; ++idx) {
-        uint32_t offset = idx * 3U;
-        uint32_t raw24 = ((uint32_t)raw[offset] << 16U) |
-            ((uint32_t)raw[offset + 1U] << 8U) |
-            (uint32_t)raw[offset + 2U];
-
-        if ((raw24 & 0x800000U) != 0U) {
-            raw24 |= 0xFF000000U;
-        }
+    return (dev != NULL) ? dev->chain * ADS1278_CHANNEL_COUNT : ADS1278_CHANNEL_COUNT;
+}
 
-        out->ch[idx] = (int32_t)raw24;
-    }
+uint64_t ads1278_dev_get_missed_drdy(const ads1278_dev_t *dev)
+{
+    return (dev != NULL) ? atomic_load_explicit(&dev->missed_drdy, memory_order_relaxed) : 0U;
 }
 
-int ads1278_open(const ads1278_cfg_t *cfg)
+uint64_t ads1278_dev_get_overlong_xfers(const ads1278_dev_t *dev)
 {
-    ads1278_cfg_t effective_cfg;
+    return (dev != NULL) ? atomic_load_explicit(&dev->overlong_xfers, memory_order_relaxed) : 0U;
+}
 
-    if (cfg == NULL) {
+int ads1278_dev_get_stats(const ads1278_dev_t *dev, ads1278_stats_t *out)
+{
+    if (out == NULL) {
         errno = EINVAL;
         return -1;
     }
-    if (g_ctx.is_open) {
-        errno = EALREADY;
-        return -1;
+    if (dev == NULL) {
+        memset(out, 0, sizeof(*out));
+        return 0;
     }
 
-    memset(&effective_cfg, 0, sizeof(effective_cfg));
-    effective_cfg = *cfg;
-    if (effective_cfg.spidev_path == NULL) {
-        effective_cfg.spidev_path = ADS1278_DEFAULT_SPIDEV;
-    }
-    if (effective_cfg.sclk_hz == 0U) {
-        effective_cfg.sclk_hz = 1000000U;
-    }
-    if (effective_cfg.drdy_timeout_ms == 0U) {
-        effective_cfg.drdy_timeout_ms = ADS1278_DEFAULT_DRDY_TIMEOUT_MS;
-    }
+    out->frames = atomic_load_explicit(&dev->frames, memory_order_relaxed);
+    out->drdy_timeouts = atomic_load_explicit(&dev->drdy_timeouts, memory_order_relaxed);
+    out->missed_drdy = atomic_load_explicit(&dev->missed_drdy, memory_order_relaxed);
+    out->overlong_xfers = atomic_load_explicit(&dev->overlong_xfers, memory_order_relaxed);
+    out->missed_conversions = atomic_load_explicit(&dev->missed_conversions, memory_order_relaxed);
+    out->gap_events = atomic_load_explicit(&dev->gap_events, memory_order_relaxed);
+    out->longest_gap = atomic_load_explicit(&dev->longest_gap, memory_order_relaxed);
+    out->ambiguous_intervals = atomic_load_explicit(&dev->ambiguous_intervals, memory_order_relaxed);
+    out->drdy_period_ns = (double)atomic_load_explicit(&dev->period_ps, memory_order_relaxed) / 1000.0;
+    out->tstamp_jitter_ns = (double)atomic_load_explicit(&dev->jitter_ps, memory_order_relaxed) / 1000.0;
+    out->tstamp_jitter_max_ns = atomic_load_explicit(&dev->jitter_max_ns, memory_order_relaxed);
+    out->clock_drift_ppm = (double)atomic_load_explicit(&dev->drift_ppb, memory_order_relaxed) / 1000.0;
+    out->clock_outliers = atomic_load_explicit(&dev->clock_outliers, memory_order_relaxed);
+    out->clock_relocks = atomic_load_explicit(&dev->clock_relocks, memory_order_relaxed);
+    lat_recorder_snapshot(&dev->wakeup, &out->drdy_wakeup);
+    lat_recorder_snapshot(&dev->xfer, &out->spi_xfer);
+    lat_recorder_snapshot(&dev->parse, &out->parse);
+    return 0;
+}
 
-    memset(&g_ctx, 0, sizeof(g_ctx));
-    g_ctx.spi_fd = -1;
-    gpio_reset(&g_ctx.drdy_gpio);
-    gpio_reset(&g_ctx.sync_gpio);
+const ads1278_cfg_t *ads1278_dev_get_cfg(const ads1278_dev_t *dev)
+{
+    return (dev != NULL) ? &dev->cfg : NULL;
+}
 
-    g_ctx.cfg = effective_cfg;
-    g_ctx.spi_fd = spi_open_and_configure(&g_ctx.cfg);
-    if (g_ctx.spi_fd < 0) {
-        ads1278_close();
-        return -1;
+void ads1278_dev_stop(ads1278_dev_t *dev)
+{
+    if (dev != NULL) {
+        dev->started = 0;
     }
+}
 
-    if (gpio_open_drdy(&g_ctx.drdy_gpio, g_ctx.cfg.drdy_gpio_number) != 0) {
-        ads1278_close();
-        return -1;
+void ads1278_dev_close(ads1278_dev_t *dev)
+{
+    if (dev == NULL) {
+        return;
     }
+    dev->ops->close(dev->backend);
+    free(dev);
+}
 
-    if (g_ctx.cfg.use_sync &&
-        gpio_open_sync(&g_ctx.sync_gpio, g_ctx.cfg.sync_gpio_number) != 0) {
-        ads1278_close();
+/* Single-instance API: one process-wide device, as before handles existed. */
+
+int ads1278_open(const ads1278_cfg_t *cfg)
+{
+    if (g_dev != NULL) {
+        errno = EALREADY;
         return -1;
     }
+    return ads1278_dev_open(&g_dev, cfg);
+}
 
-    g_ctx.seq = 0U;
-    g_ctx.is_open = 1;
-    return 0;
+ads1278_dev_t *ads1278_get_dev(void)
+{
+    return g_dev;
 }
 
 int ads1278_start(void)
 {
-    if (!g_ctx.is_open) {
-        errno = ENODEV;
-        return -1;
-    }
-    if (g_ctx.started) {
-        return 0;
-    }
-
-    g_ctx.started = 1;
-    if (g_ctx.cfg.use_sync) {
-        uint32_t idx;
-        ads1278_frame_t discard = {0};
-
-        if (gpio_set_value(&g_ctx.sync_gpio, 0) != 0) {
-            g_ctx.started = 0;
-            return -1;
-        }
-        usleep(ADS1278_SYNC_PULSE_US);
-        if (gpio_set_value(&g_ctx.sync_gpio, 1) != 0) {
-            g_ctx.started = 0;
-            return -1;
-        }
-
-        for (idx = 0; idx < g_ctx.cfg.settle_frames; ++idx) {
-            if (ads1278_read_frame(&discard) != 0) {
-                g_ctx.started = 0;
-                return -1;
-            }
-        }
-    }
-
-    return 0;
+    return ads1278_dev_start(g_dev);
 }
 
 int ads1278_read_frame(ads1278_frame_t *out)
 {
-    uint8_t raw[ADS1278_TDM_FRAME_BYTES] = {0};
-    uint64_t drdy_ts_ns;
-    uint64_t post_xfer_ns;
-
-    if (out == NULL) {
-        errno = EINVAL;
-        return -1;
-    }
-    if (!g_ctx.is_open || !g_ctx.started) {
-        errno = EPERM;
-        return -1;
-    }
-
-    if (gpio_wait_drdy_event(&g_ctx.drdy_gpio, g_ctx.cfg.drdy_timeout_ms) != 0) {
-        return -1;
-    }
-
-    drdy_ts_ns = monotonic_now_ns();
-    if (spi_read_24_bytes(raw) != 0) {
-        return -1;
-    }
-    post_xfer_ns = monotonic_now_ns();
-
-    memcpy(g_ctx.last_raw, raw, sizeof(raw));
+    return ads1278_dev_read_frame(g_dev, out);
+}
 
-    out->seq = g_ctx.seq++;
-    out->tstamp_ns = drdy_ts_ns;
-    parse_samples_msb_first(raw, out);
+int ads1278_read_frames(ads1278_block_t *blk, size_t n)
+{
+    return ads1278_dev_read_frames(g_dev, blk, n);
+}
 
-    if (drdy_ts_ns != 0U && post_xfer_ns > drdy_ts_ns) {
-        uint64_t elapsed_us = (post_xfer_ns - drdy_ts_ns) / 1000U;
+int ads1278_get_last_raw_frame(uint8_t out[ADS1278_MAX_FRAME_BYTES])
+{
+    return ads1278_dev_get_last_raw_frame(g_dev, out);
+}
 
-        if (elapsed_us > ADS1278_OVERLONG_XFER_WARN_US) {
-            fprintf(stderr,
-                "ads1278 warning: slow transfer (%llu us), overrun risk\n",
-                (unsigned long long)elapsed_us);
-        }
-    }
+uint32_t ads1278_get_channel_count(void)
+{
+    return ads1278_dev_channel_count(g_dev);
+}
 
-    return 0;
+uint64_t ads1278_get_missed_drdy(void)
+{
+    return ads1278_dev_get_missed_drdy(g_dev);
 }
 
-int ads1278_get_last_raw_frame(uint8_t out[ADS1278_TDM_FRAME_BYTES])
+uint64_t ads1278_get_overlong_xfers(void)
 {
-    if (out == NULL) {
-        errno = EINVAL;
-        return -1;
-    }
+    return ads1278_dev_get_overlong_xfers(g_dev);
+}
 
-    memcpy(out, g_ctx.last_raw, ADS1278_TDM_FRAME_BYTES);
-    return 0;
+int ads1278_get_stats(ads1278_stats_t *out)
+{
+    return ads1278_dev_get_stats(g_dev, out);
 }
 
 void ads1278_stop(void)
 {
-    g_ctx.started = 0;
+    ads1278_dev_stop(g_dev);
 }
 
 void ads1278_close(void)
 {
-    if (g_ctx.spi_fd >= 0) {
-        close(g_ctx.spi_fd);
-        g_ctx.spi_fd = -1;
-    }
-
-    gpio_close(&g_ctx.drdy_gpio);
-    gpio_close(&g_ctx.sync_gpio);
-
-    memset(g_ctx.last_raw, 0, sizeof(g_ctx.last_raw));
-    g_ctx.seq = 0;
-    g_ctx.started = 0;
-    g_ctx.is_open = 0;
+    ads1278_dev_close(g_dev);
+    g_dev = NULL;
 }
-
-#endif /* __linux__ */
@@ -0,0 +1,84 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Miguel Dovale (University of Arizona)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef ADS1278_BACKEND_H
+#define ADS1278_BACKEND_H
+
+#include "ads1278.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+typedef struct {
+    uint64_t edge_ns;           /* best CLOCK_MONOTONIC estimate of the /DRDY edge */
+    uint32_t missed;            /* edges since the last event that will never be serviced */
+} ads1278_drdy_event_t;
+
+/*
+ * Frame source behind the HAL. The core (ads1278.c) owns sequencing, parsing
+ * and timing checks; a backend only has to deliver DRDY edges and raw TDM bytes.
+ * All callbacks follow the HAL convention: 0 on success, -1 with errno set.
+ */
+typedef struct {
+    const char *name;
+
+    /* Allocate backend state and acquire its resources. */
+    int (*open)(void **state, const ads1278_cfg_t *cfg);
+
+    /* Drive /SYNC (active-low). NULL when the backend has no SYNC line. */
+    int (*set_sync)(void *state, int level);
+
+    /* Block until the next /DRDY falling edge or timeout (ETIMEDOUT). */
+    int (*wait_drdy)(void *state, uint32_t timeout_ms, ads1278_drdy_event_t *ev);
+
+    /* Clock len bytes (a multiple of ADS1278_TDM_FRAME_BYTES) out of DOUT. */
+    int (*transfer)(void *state, uint8_t *rx, size_t len);
+
+    /* Release everything acquired by open(); state is invalid afterwards. */
+    void (*close)(void *state);
+} ads1278_backend_ops_t;
+
+extern const ads1278_backend_ops_t ads1278_backend_spidev_ops;
+extern const ads1278_backend_ops_t ads1278_backend_sim_ops;
+
+static inline uint64_t ads1278_monotonic_now_ns(void)
+{
+    struct timespec ts = {0, 0};
+
+    if (clock_gettime(CLOCK_MONOTONIC, &ts) != 0) {
+        return 0;
+    }
+
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+#endif /* ADS1278_BACKEND_H */
@@ -0,0 +1,180 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Miguel Dovale (University of Arizona)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "ads1278.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BLOCK_ALIGN_BYTES 64U
+
+struct ads1278_block_pool {
+    pthread_mutex_t lock;
+    ads1278_block_t *blocks;
+    ads1278_block_t **free_list;
+    size_t block_count;
+    size_t free_count;
+    uint8_t *storage;
+};
+
+static size_t align_up(size_t value)
+{
+    return (value + (BLOCK_ALIGN_BYTES - 1U)) & ~(size_t)(BLOCK_ALIGN_BYTES - 1U);
+}
+
+int ads1278_block_pool_create(ads1278_block_pool_t **out, size_t block_count, size_t frames_per_block)
+{
+    ads1278_block_pool_t *pool;
+    size_t ts_bytes;
+    size_t ch_bytes;
+    size_t raw_bytes;
+    size_t block_bytes;
+    size_t idx;
+    void *storage = NULL;
+    int rc;
+
+    if (out == NULL || block_count == 0U || frames_per_block == 0U) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    ts_bytes = align_up(frames_per_block * sizeof(uint64_t));
+    ch_bytes = align_up(frames_per_block * sizeof(int32_t));
+    raw_bytes = align_up(frames_per_block * ADS1278_MAX_FRAME_BYTES);
+    block_bytes = (2U * ts_bytes) + (ch_bytes * ADS1278_MAX_CHANNELS) + raw_bytes;
+
+    pool = calloc(1U, sizeof(*pool));
+    if (pool == NULL) {
+        return -1;
+    }
+
+    pool->blocks = calloc(block_count, sizeof(*pool->blocks));
+    pool->free_list = calloc(block_count, sizeof(*pool->free_list));
+    if (pool->blocks == NULL || pool->free_list == NULL ||
+        posix_memalign(&storage, BLOCK_ALIGN_BYTES, block_bytes * block_count) != 0) {
+        free(pool->blocks);
+        free(pool->free_list);
+        free(pool);
+        errno = ENOMEM;
+        return -1;
+    }
+
+    rc = pthread_mutex_init(&pool->lock, NULL);
+    if (rc != 0) {
+        free(storage);
+        free(pool->blocks);
+        free(pool->free_list);
+        free(pool);
+        errno = rc;
+        return -1;
+    }
+
+    /* Touch everything now so the first reads do not page-fault. */
+    memset(storage, 0, block_bytes * block_count);
+    pool->storage = storage;
+    pool->block_count = block_count;
+
+    for (idx = 0U; idx < block_count; ++idx) {
+        ads1278_block_t *blk = &pool->blocks[idx];
+        uint8_t *base = pool->storage + (idx * block_bytes);
+        uint32_t channel;
+
+        blk->capacity = frames_per_block;
+        blk->tstamp_ns = (uint64_t *)(void *)base;
+        base += ts_bytes;
+        blk->seq = (uint64_t *)(void *)base;
+        base += ts_bytes;
+        for (channel = 0U; channel < ADS1278_MAX_CHANNELS; ++channel) {
+            blk->ch[channel] = (int32_t *)(void *)base;
+            base += ch_bytes;
+        }
+        blk->raw = base;
+        pool->free_list[idx] = blk;
+    }
+    pool->free_count = block_count;
+
+    *out = pool;
+    return 0;
+}
+
+void ads1278_block_pool_destroy(ads1278_block_pool_t *pool)
+{
+    if (pool == NULL) {
+        return;
+    }
+
+    (void)pthread_mutex_destroy(&pool->lock);
+    free(pool->storage);
+    free(pool->blocks);
+    free(pool->free_list);
+    free(pool);
+}
+
+ads1278_block_t *ads1278_block_acquire(ads1278_block_pool_t *pool)
+{
+    ads1278_block_t *blk = NULL;
+
+    if (pool == NULL) {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    (void)pthread_mutex_lock(&pool->lock);
+    if (pool->free_count != 0U) {
+        blk = pool->free_list[--pool->free_count];
+    }
+    (void)pthread_mutex_unlock(&pool->lock);
+
+    if (blk == NULL) {
+        errno = EAGAIN;
+        return NULL;
+    }
+
+    blk->seq0 = 0U;
+    blk->count = 0U;
+    return blk;
+}
+
+void ads1278_block_release(ads1278_block_pool_t *pool, ads1278_block_t *blk)
+{
+    if (pool == NULL || blk == NULL) {
+        return;
+    }
+
+    (void)pthread_mutex_lock(&pool->lock);
+    if (pool->free_count < pool->block_count) {
+        pool->free_list[pool->free_count++] = blk;
+    }
+    (void)pthread_mutex_unlock(&pool->lock);
+}
@@ -0,0 +1,86 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Miguel Dovale (University of Arizona)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "ads1278.h"
+#include "ads1278_gpio.h"
+
+#include <errno.h>
+#include <stdlib.h>
+
+struct ads1278_edge {
+    ads1278_gpio_t gpio;
+};
+
+int ads1278_edge_open(ads1278_edge_t **out, const char *gpiochip, uint32_t line)
+{
+    ads1278_edge_t *edge;
+
+    if (out == NULL) {
+        errno = EINVAL;
+        return -1;
+    }
+    *out = NULL;
+
+    edge = calloc(1U, sizeof(*edge));
+    if (edge == NULL) {
+        return -1;
+    }
+    ads1278_gpio_init(&edge->gpio, ads1278_gpio_ops_for(gpiochip));
+    if (edge->gpio.ops->open_drdy(&edge->gpio, gpiochip, line) != 0) {
+        int saved_errno = errno;
+
+        free(edge);
+        errno = saved_errno;
+        return -1;
+    }
+    *out = edge;
+    return 0;
+}
+
+int ads1278_edge_wait(ads1278_edge_t *edge, uint32_t timeout_ms, uint64_t *edge_ns)
+{
+    uint32_t missed = 0U;
+
+    if (edge == NULL || edge_ns == NULL) {
+        errno = EINVAL;
+        return -1;
+    }
+    return edge->gpio.ops->wait_edge(&edge->gpio, timeout_ms, edge_ns, &missed);
+}
+
+void ads1278_edge_close(ads1278_edge_t *edge)
+{
+    if (edge == NULL) {
+        return;
+    }
+    edge->gpio.ops->close(&edge->gpio);
+    free(edge);
+}
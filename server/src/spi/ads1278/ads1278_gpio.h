@@ -0,0 +1,88 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Miguel Dovale (University of Arizona)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef ADS1278_GPIO_H
+#define ADS1278_GPIO_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * /DRDY input and /SYNC output lines. Two implementations share this table:
+ * sysfs (global GPIO numbers) and the GPIO character device v2 uAPI
+ * (/dev/gpiochipN + line offset), which also provides kernel edge timestamps.
+ */
+typedef struct ads1278_gpio ads1278_gpio_t;
+
+typedef struct {
+    const char *name;
+
+    /* chip is ignored by sysfs; line is a global number (sysfs) or offset (cdev). */
+    int (*open_drdy)(ads1278_gpio_t *gpio, const char *chip, uint32_t line);
+    int (*open_sync)(ads1278_gpio_t *gpio, const char *chip, uint32_t line);
+    int (*set_value)(ads1278_gpio_t *gpio, int value);
+
+    /*
+     * Wait for a falling edge, at most timeout_ms (ADS1278_NO_TIMEOUT = no
+     * limit). edge_ns receives the CLOCK_MONOTONIC edge time, missed the
+     * number of edges that occurred but will never be serviced.
+     */
+    int (*wait_edge)(ads1278_gpio_t *gpio, uint32_t timeout_ms, uint64_t *edge_ns, uint32_t *missed);
+    void (*close)(ads1278_gpio_t *gpio);
+} ads1278_gpio_ops_t;
+
+struct ads1278_gpio {
+    const ads1278_gpio_ops_t *ops;
+    uint32_t line;
+    int fd;
+    int exported;               /* sysfs: line was exported by us */
+    uint32_t last_seqno;        /* cdev: line_seqno of the last event read */
+};
+
+extern const ads1278_gpio_ops_t ads1278_gpio_sysfs_ops;
+extern const ads1278_gpio_ops_t ads1278_gpio_cdev_ops;
+
+static inline void ads1278_gpio_init(ads1278_gpio_t *gpio, const ads1278_gpio_ops_t *ops)
+{
+    gpio->ops = ops;
+    gpio->line = 0U;
+    gpio->fd = -1;
+    gpio->exported = 0;
+    gpio->last_seqno = 0U;
+}
+
+/* NULL chip selects sysfs, anything else the character device. */
+static inline const ads1278_gpio_ops_t *ads1278_gpio_ops_for(const char *chip)
+{
+    return (chip == NULL) ? &ads1278_gpio_sysfs_ops : &ads1278_gpio_cdev_ops;
+}
+
+#endif /* ADS1278_GPIO_H */
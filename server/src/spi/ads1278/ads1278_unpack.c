@@ -0,0 +1,423 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Miguel Dovale (University of Arizona)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "ads1278_unpack.h"
+
+#include <errno.h>
+#include <stdatomic.h>
+#include <stdint.h>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define ADS1278_UNPACK_HAVE_X86 1
+#include <immintrin.h>
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define ADS1278_UNPACK_HAVE_NEON 1
+#include <arm_neon.h>
+#endif
+
+typedef void (*unpack_aos_fn)(const uint8_t *raw, size_t nframes, int32_t *out);
+typedef void (*unpack_soa_fn)(const uint8_t *raw, size_t nframes, int32_t *const ch[ADS1278_CHANNEL_COUNT]);
+
+typedef struct {
+    const char *name;
+    unpack_aos_fn aos;
+    unpack_soa_fn soa;
+} unpack_impl_ops_t;
+
+static inline int32_t decode_sample(const uint8_t *src)
+{
+    uint32_t raw24 = ((uint32_t)src[0] << 16U) | ((uint32_t)src[1] << 8U) | (uint32_t)src[2];
+
+    return (int32_t)(raw24 ^ 0x800000U) - 0x800000;
+}
+
+void ads1278_unpack_frames_ref(const uint8_t *raw, size_t nframes, int32_t *out)
+{
+    size_t idx;
+    uint32_t channel;
+
+    for (idx = 0U; idx < nframes; ++idx) {
+        for (channel = 0U; channel < ADS1278_CHANNEL_COUNT; ++channel) {
+            out[channel] = decode_sample(raw + (channel * 3U));
+        }
+        raw += ADS1278_TDM_FRAME_BYTES;
+        out += ADS1278_CHANNEL_COUNT;
+    }
+}
+
+static void unpack_soa_ref_from(const uint8_t *raw, size_t first, size_t nframes,
+                                int32_t *const ch[ADS1278_CHANNEL_COUNT])
+{
+    uint32_t channel;
+
+    for (channel = 0U; channel < ADS1278_CHANNEL_COUNT; ++channel) {
+        const uint8_t *src = raw + (first * ADS1278_TDM_FRAME_BYTES) + (channel * 3U);
+        int32_t *dst = ch[channel];
+        size_t idx;
+
+        for (idx = first; idx < nframes; ++idx) {
+            dst[idx] = decode_sample(src);
+            src += ADS1278_TDM_FRAME_BYTES;
+        }
+    }
+}
+
+void ads1278_unpack_frames_soa_ref(const uint8_t *raw, size_t nframes, int32_t *const ch[ADS1278_CHANNEL_COUNT])
+{
+    unpack_soa_ref_from(raw, 0U, nframes, ch);
+}
+
+#if defined(ADS1278_UNPACK_HAVE_X86)
+/*
+ * One frame per pair of 16-byte loads: bytes 0..15 carry samples 0..3 and
+ * bytes 8..23 carry samples 4..7, so neither load reads past the frame. The
+ * shuffle places each big-endian sample in the top three bytes of its lane
+ * and the arithmetic shift by 8 sign-extends it.
+ */
+__attribute__((target("ssse3")))
+static inline __m128i ssse3_decode_lo(const uint8_t *frame)
+{
+    const __m128i mask = _mm_setr_epi8(-128, 2, 1, 0, -128, 5, 4, 3, -128, 8, 7, 6, -128, 11, 10, 9);
+
+    return _mm_srai_epi32(_mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)frame), mask), 8);
+}
+
+__attribute__((target("ssse3")))
+static inline __m128i ssse3_decode_hi(const uint8_t *frame)
+{
+    const __m128i mask = _mm_setr_epi8(-128, 6, 5, 4, -128, 9, 8, 7, -128, 12, 11, 10, -128, 15, 14, 13);
+
+    return _mm_srai_epi32(_mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(frame + 8)), mask), 8);
+}
+
+__attribute__((target("ssse3")))
+static void unpack_aos_ssse3(const uint8_t *raw, size_t nframes, int32_t *out)
+{
+    size_t idx;
+
+    for (idx = 0U; idx < nframes; ++idx) {
+        _mm_storeu_si128((__m128i *)out, ssse3_decode_lo(raw));
+        _mm_storeu_si128((__m128i *)(out + 4), ssse3_decode_hi(raw));
+        raw += ADS1278_TDM_FRAME_BYTES;
+        out += ADS1278_CHANNEL_COUNT;
+    }
+}
+
+__attribute__((target("ssse3")))
+static inline void sse_store_transposed(__m128i r0, __m128i r1, __m128i r2, __m128i r3,
+                                        int32_t *d0, int32_t *d1, int32_t *d2, int32_t *d3)
+{
+    __m128i t0 = _mm_unpacklo_epi32(r0, r1);
+    __m128i t1 = _mm_unpacklo_epi32(r2, r3);
+    __m128i t2 = _mm_unpackhi_epi32(r0, r1);
+    __m128i t3 = _mm_unpackhi_epi32(r2, r3);
+
+    _mm_storeu_si128((__m128i *)d0, _mm_unpacklo_epi64(t0, t1));
+    _mm_storeu_si128((__m128i *)d1, _mm_unpackhi_epi64(t0, t1));
+    _mm_storeu_si128((__m128i *)d2, _mm_unpacklo_epi64(t2, t3));
+    _mm_storeu_si128((__m128i *)d3, _mm_unpackhi_epi64(t2, t3));
+}
+
+__attribute__((target("ssse3")))
+static void unpack_soa_ssse3(const uint8_t *raw, size_t nframes, int32_t *const ch[ADS1278_CHANNEL_COUNT])
+{
+    size_t idx;
+
+    for (idx = 0U; idx + 4U <= nframes; idx += 4U) {
+        const uint8_t *f = raw + (idx * ADS1278_TDM_FRAME_BYTES);
+
+        sse_store_transposed(ssse3_decode_lo(f), ssse3_decode_lo(f + 24), ssse3_decode_lo(f + 48),
+                             ssse3_decode_lo(f + 72),
+                             ch[0] + idx, ch[1] + idx, ch[2] + idx, ch[3] + idx);
+        sse_store_transposed(ssse3_decode_hi(f), ssse3_decode_hi(f + 24), ssse3_decode_hi(f + 48),
+                             ssse3_decode_hi(f + 72),
+                             ch[4] + idx, ch[5] + idx, ch[6] + idx, ch[7] + idx);
+    }
+
+    unpack_soa_ref_from(raw, idx, nframes, ch);
+}
+
+/* One whole frame per 256-bit vector: low lane from byte 0, high lane from byte 8. */
+__attribute__((target("avx2")))
+static inline __m256i avx2_decode_frame(const uint8_t *frame)
+{
+    const __m256i mask = _mm256_setr_epi8(-128, 2, 1, 0, -128, 5, 4, 3, -128, 8, 7, 6, -128, 11, 10, 9,
+                                          -128, 6, 5, 4, -128, 9, 8, 7, -128, 12, 11, 10, -128, 15, 14, 13);
+    __m256i v = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i *)frame)),
+                                        _mm_loadu_si128((const __m128i *)(frame + 8)), 1);
+
+    return _mm256_srai_epi32(_mm256_shuffle_epi8(v, mask), 8);
+}
+
+__attribute__((target("avx2")))
+static void unpack_aos_avx2(const uint8_t *raw, size_t nframes, int32_t *out)
+{
+    size_t idx;
+
+    for (idx = 0U; idx + 2U <= nframes; idx += 2U) {
+        _mm256_storeu_si256((__m256i *)out, avx2_decode_frame(raw));
+        _mm256_storeu_si256((__m256i *)(out + 8), avx2_decode_frame(raw + ADS1278_TDM_FRAME_BYTES));
+        raw += 2U * ADS1278_TDM_FRAME_BYTES;
+        out += 2U * ADS1278_CHANNEL_COUNT;
+    }
+
+    if (idx < nframes) {
+        _mm256_storeu_si256((__m256i *)out, avx2_decode_frame(raw));
+    }
+}
+
+__attribute__((target("avx2")))
+static void unpack_soa_avx2(const uint8_t *raw, size_t nframes, int32_t *const ch[ADS1278_CHANNEL_COUNT])
+{
+    size_t idx;
+
+    for (idx = 0U; idx + 8U <= nframes; idx += 8U) {
+        const uint8_t *f = raw + (idx * ADS1278_TDM_FRAME_BYTES);
+        __m256i r0 = avx2_decode_frame(f);
+        __m256i r1 = avx2_decode_frame(f + 24);
+        __m256i r2 = avx2_decode_frame(f + 48);
+        __m256i r3 = avx2_decode_frame(f + 72);
+        __m256i r4 = avx2_decode_frame(f + 96);
+        __m256i r5 = avx2_decode_frame(f + 120);
+        __m256i r6 = avx2_decode_frame(f + 144);
+        __m256i r7 = avx2_decode_frame(f + 168);
+        __m256i t0 = _mm256_unpacklo_epi32(r0, r1);
+        __m256i t1 = _mm256_unpackhi_epi32(r0, r1);
+        __m256i t2 = _mm256_unpacklo_epi32(r2, r3);
+        __m256i t3 = _mm256_unpackhi_epi32(r2, r3);
+        __m256i t4 = _mm256_unpacklo_epi32(r4, r5);
+        __m256i t5 = _mm256_unpackhi_epi32(r4, r5);
+        __m256i t6 = _mm256_unpacklo_epi32(r6, r7);
+        __m256i t7 = _mm256_unpackhi_epi32(r6, r7);
+        /* u0 holds channel 0 (low lane) and channel 4 (high lane) of frames 0..3, and so on. */
+        __m256i u0 = _mm256_unpacklo_epi64(t0, t2);
+        __m256i u1 = _mm256_unpackhi_epi64(t0, t2);
+        __m256i u2 = _mm256_unpacklo_epi64(t1, t3);
+        __m256i u3 = _mm256_unpackhi_epi64(t1, t3);
+        __m256i u4 = _mm256_unpacklo_epi64(t4, t6);
+        __m256i u5 = _mm256_unpackhi_epi64(t4, t6);
+        __m256i u6 = _mm256_unpacklo_epi64(t5, t7);
+        __m256i u7 = _mm256_unpackhi_epi64(t5, t7);
+
+        _mm256_storeu_si256((__m256i *)(ch[0] + idx), _mm256_permute2x128_si256(u0, u4, 0x20));
+        _mm256_storeu_si256((__m256i *)(ch[1] + idx), _mm256_permute2x128_si256(u1, u5, 0x20));
+        _mm256_storeu_si256((__m256i *)(ch[2] + idx), _mm256_permute2x128_si256(u2, u6, 0x20));
+        _mm256_storeu_si256((__m256i *)(ch[3] + idx), _mm256_permute2x128_si256(u3, u7, 0x20));
+        _mm256_storeu_si256((__m256i *)(ch[4] + idx), _mm256_permute2x128_si256(u0, u4, 0x31));
+        _mm256_storeu_si256((__m256i *)(ch[5] + idx), _mm256_permute2x128_si256(u1, u5, 0x31));
+        _mm256_storeu_si256((__m256i *)(ch[6] + idx), _mm256_permute2x128_si256(u2, u6, 0x31));
+        _mm256_storeu_si256((__m256i *)(ch[7] + idx), _mm256_permute2x128_si256(u3, u7, 0x31));
+    }
+
+    unpack_soa_ref_from(raw, idx, nframes, ch);
+}
+#endif /* ADS1278_UNPACK_HAVE_X86 */
+
+#if defined(ADS1278_UNPACK_HAVE_NEON)
+/*
+ * vld3 de-interleaves the big-endian byte planes; the top two bytes form a
+ * signed 16-bit value that is widened with a shift by 8, which sign-extends,
+ * and the low byte is OR-ed in.
+ */
+static inline void neon_decode8(uint8x8_t b0, uint8x8_t b1, uint8x8_t b2, int32x4_t *lo, int32x4_t *hi)
+{
+    int16x8_t top = vreinterpretq_s16_u16(vorrq_u16(vshll_n_u8(b0, 8), vmovl_u8(b1)));
+    uint16x8_t low = vmovl_u8(b2);
+
+    *lo = vorrq_s32(vshll_n_s16(vget_low_s16(top), 8), vreinterpretq_s32_u32(vmovl_u16(vget_low_u16(low))));
+    *hi = vorrq_s32(vshll_n_s16(vget_high_s16(top), 8), vreinterpretq_s32_u32(vmovl_u16(vget_high_u16(low))));
+}
+
+/* Two frames from one 48-byte vld3q. */
+static inline void neon_decode_pair(const uint8_t *frames, int32x4_t r[4])
+{
+    uint8x16x3_t v = vld3q_u8(frames);
+
+    neon_decode8(vget_low_u8(v.val[0]), vget_low_u8(v.val[1]), vget_low_u8(v.val[2]), &r[0], &r[1]);
+    neon_decode8(vget_high_u8(v.val[0]), vget_high_u8(v.val[1]), vget_high_u8(v.val[2]), &r[2], &r[3]);
+}
+
+static void unpack_aos_neon(const uint8_t *raw, size_t nframes, int32_t *out)
+{
+    size_t idx;
+
+    for (idx = 0U; idx + 2U <= nframes; idx += 2U) {
+        int32x4_t r[4];
+
+        neon_decode_pair(raw, r);
+        vst1q_s32(out, r[0]);
+        vst1q_s32(out + 4, r[1]);
+        vst1q_s32(out + 8, r[2]);
+        vst1q_s32(out + 12, r[3]);
+        raw += 2U * ADS1278_TDM_FRAME_BYTES;
+        out += 2U * ADS1278_CHANNEL_COUNT;
+    }
+
+    if (idx < nframes) {
+        uint8x8x3_t v = vld3_u8(raw);
+        int32x4_t lo;
+        int32x4_t hi;
+
+        neon_decode8(v.val[0], v.val[1], v.val[2], &lo, &hi);
+        vst1q_s32(out, lo);
+        vst1q_s32(out + 4, hi);
+    }
+}
+
+static inline void neon_store_transposed(int32x4_t r0, int32x4_t r1, int32x4_t r2, int32x4_t r3,
+                                         int32_t *d0, int32_t *d1, int32_t *d2, int32_t *d3)
+{
+    int32x4x2_t x = vtrnq_s32(r0, r1);
+    int32x4x2_t y = vtrnq_s32(r2, r3);
+
+    vst1q_s32(d0, vcombine_s32(vget_low_s32(x.val[0]), vget_low_s32(y.val[0])));
+    vst1q_s32(d1, vcombine_s32(vget_low_s32(x.val[1]), vget_low_s32(y.val[1])));
+    vst1q_s32(d2, vcombine_s32(vget_high_s32(x.val[0]), vget_high_s32(y.val[0])));
+    vst1q_s32(d3, vcombine_s32(vget_high_s32(x.val[1]), vget_high_s32(y.val[1])));
+}
+
+static void unpack_soa_neon(const uint8_t *raw, size_t nframes, int32_t *const ch[ADS1278_CHANNEL_COUNT])
+{
+    size_t idx;
+
+    for (idx = 0U; idx + 4U <= nframes; idx += 4U) {
+        const uint8_t *f = raw + (idx * ADS1278_TDM_FRAME_BYTES);
+        int32x4_t a[4];
+        int32x4_t b[4];
+
+        neon_decode_pair(f, a);
+        neon_decode_pair(f + 48, b);
+        neon_store_transposed(a[0], a[2], b[0], b[2], ch[0] + idx, ch[1] + idx, ch[2] + idx, ch[3] + idx);
+        neon_store_transposed(a[1], a[3], b[1], b[3], ch[4] + idx, ch[5] + idx, ch[6] + idx, ch[7] + idx);
+    }
+
+    unpack_soa_ref_from(raw, idx, nframes, ch);
+}
+#endif /* ADS1278_UNPACK_HAVE_NEON */
+
+static const unpack_impl_ops_t k_impls[ADS1278_UNPACK_IMPL_COUNT] = {
+    [ADS1278_UNPACK_SCALAR] = {"scalar", ads1278_unpack_frames_ref, ads1278_unpack_frames_soa_ref},
+#if defined(ADS1278_UNPACK_HAVE_X86)
+    [ADS1278_UNPACK_SSSE3] = {"ssse3", unpack_aos_ssse3, unpack_soa_ssse3},
+    [ADS1278_UNPACK_AVX2] = {"avx2", unpack_aos_avx2, unpack_soa_avx2},
+#else
+    [ADS1278_UNPACK_SSSE3] = {"ssse3", NULL, NULL},
+    [ADS1278_UNPACK_AVX2] = {"avx2", NULL, NULL},
+#endif
+#if defined(ADS1278_UNPACK_HAVE_NEON)
+    [ADS1278_UNPACK_NEON] = {"neon", unpack_aos_neon, unpack_soa_neon},
+#else
+    [ADS1278_UNPACK_NEON] = {"neon", NULL, NULL},
+#endif
+};
+
+/* -1 until first use; resolving twice from racing threads is harmless. */
+static atomic_int g_active_impl = -1;
+
+bool ads1278_unpack_available(ads1278_unpack_impl_t impl)
+{
+    if ((unsigned)impl >= (unsigned)ADS1278_UNPACK_IMPL_COUNT || k_impls[impl].aos == NULL) {
+        return false;
+    }
+
+#if defined(ADS1278_UNPACK_HAVE_X86)
+    if (impl == ADS1278_UNPACK_SSSE3) {
+        return __builtin_cpu_supports("ssse3") != 0;
+    }
+    if (impl == ADS1278_UNPACK_AVX2) {
+        return __builtin_cpu_supports("avx2") != 0;
+    }
+#endif
+
+    return true;
+}
+
+static ads1278_unpack_impl_t resolve_best(void)
+{
+    static const ads1278_unpack_impl_t k_preference[] = {
+        ADS1278_UNPACK_AVX2,
+        ADS1278_UNPACK_NEON,
+        ADS1278_UNPACK_SSSE3,
+    };
+    size_t idx;
+
+    for (idx = 0U; idx < sizeof(k_preference) / sizeof(k_preference[0]); ++idx) {
+        if (ads1278_unpack_available(k_preference[idx])) {
+            return k_preference[idx];
+        }
+    }
+
+    return ADS1278_UNPACK_SCALAR;
+}
+
+ads1278_unpack_impl_t ads1278_unpack_active(void)
+{
+    int impl = atomic_load_explicit(&g_active_impl, memory_order_relaxed);
+
+    if (impl < 0) {
+        impl = (int)resolve_best();
+        atomic_store_explicit(&g_active_impl, impl, memory_order_relaxed);
+    }
+
+    return (ads1278_unpack_impl_t)impl;
+}
+
+int ads1278_unpack_select(ads1278_unpack_impl_t impl)
+{
+    if (!ads1278_unpack_available(impl)) {
+        errno = ENOTSUP;
+        return -1;
+    }
+
+    atomic_store_explicit(&g_active_impl, (int)impl, memory_order_relaxed);
+    return 0;
+}
+
+const char *ads1278_unpack_impl_name(ads1278_unpack_impl_t impl)
+{
+    if ((unsigned)impl >= (unsigned)ADS1278_UNPACK_IMPL_COUNT) {
+        return "unknown";
+    }
+
+    return k_impls[impl].name;
+}
+
+void ads1278_unpack_frames(const uint8_t *raw, size_t nframes, int32_t *out)
+{
+    k_impls[ads1278_unpack_active()].aos(raw, nframes, out);
+}
+
+void ads1278_unpack_frames_soa(const uint8_t *raw, size_t nframes, int32_t *const ch[ADS1278_CHANNEL_COUNT])
+{
+    k_impls[ads1278_unpack_active()].soa(raw, nframes, ch);
+}
@@ -0,0 +1,323 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Miguel Dovale (University of Arizona)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Synthetic ADS1278: emits MSB-first 24-byte TDM frames on a virtual DRDY clock,
+ * one per device for a daisy chain (channel c of the transfer is chain channel c)
+ * so the whole HAL path can be exercised and benchmarked without hardware.
+ * The virtual ADC free-runs like the real one: if the caller falls behind by
+ * more than one conversion period, the skipped conversions are lost.
+ *
+ * With cfg->drdy_gpiochip set, edges come from a real GPIO character-device
+ * line instead (e.g. a gpio-sim line), so the cdev DRDY path can be tested
+ * without SPI hardware.
+ */
+
+#include "ads1278_backend.h"
+#include "ads1278_gpio.h"
+
+#include <errno.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define SIM_NOMINAL_RATE_HZ 1000.0
+#define SIM_DEFAULT_SEED 0x2545F491U
+
+typedef struct {
+    ads1278_sim_cfg_t cfg;
+    uint64_t period_ns;         /* 0 = free-running */
+    uint64_t next_edge_ns;      /* nominal time of the next conversion */
+    uint64_t next_index;        /* conversion index of the next edge */
+    uint64_t cur_index;         /* conversion presented by the last edge */
+    uint64_t xfer_count;
+    ads1278_gpio_t drdy_gpio;
+    int external_drdy;
+    uint32_t rng;
+    int32_t amplitude;
+    double phase_step;          /* radians per conversion */
+} sim_state_t;
+
+static uint32_t sim_rand(sim_state_t *st)
+{
+    uint32_t x = st->rng;
+
+    x ^= x << 13U;
+    x ^= x >> 17U;
+    x ^= x << 5U;
+    st->rng = x;
+    return x;
+}
+
+#ifdef __linux__
+static int sim_sleep_until(uint64_t deadline_ns)
+{
+    struct timespec ts;
+    int rc;
+
+    ts.tv_sec = (time_t)(deadline_ns / 1000000000ULL);
+    ts.tv_nsec = (long)(deadline_ns % 1000000000ULL);
+    do {
+        rc = clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+    } while (rc == EINTR);
+
+    if (rc != 0) {
+        errno = rc;
+        return -1;
+    }
+    return 0;
+}
+#else
+/* No absolute clock_nanosleep() everywhere (macOS); re-arm a relative sleep until the deadline. */
+static int sim_sleep_until(uint64_t deadline_ns)
+{
+    uint64_t now;
+
+    while ((now = ads1278_monotonic_now_ns()) < deadline_ns) {
+        struct timespec ts;
+        uint64_t left = deadline_ns - now;
+
+        ts.tv_sec = (time_t)(left / 1000000000ULL);
+        ts.tv_nsec = (long)(left % 1000000000ULL);
+        if (nanosleep(&ts, NULL) != 0 && errno != EINTR) {
+            return -1;
+        }
+    }
+    return 0;
+}
+#endif /* __linux__ */
+
+static int32_t sign_extend_24(uint32_t raw24)
+{
+    return (int32_t)((raw24 & 0xFFFFFFU) ^ 0x800000U) - 0x800000;
+}
+
+static int32_t sim_sample(sim_state_t *st, uint64_t index, uint32_t channel)
+{
+    const double two_pi = 6.283185307179586;
+    double phase;
+
+    switch (st->cfg.signal) {
+        case ADS1278_SIM_SIGNAL_RAMP:
+            return sign_extend_24((uint32_t)(index * (uint64_t)(channel + 1U)));
+        case ADS1278_SIM_SIGNAL_SINE:
+            phase = st->phase_step * (double)index + (two_pi * (double)channel) / 8.0;
+            return (int32_t)lrint((double)st->amplitude * sin(phase));
+        case ADS1278_SIM_SIGNAL_SQUARE:
+            phase = st->phase_step * (double)index + (two_pi * (double)channel) / 8.0;
+            return (sin(phase) >= 0.0) ? st->amplitude : -st->amplitude;
+        case ADS1278_SIM_SIGNAL_NOISE:
+            return (int32_t)(sim_rand(st) % (2U * (uint32_t)st->amplitude + 1U)) - st->amplitude;
+        case ADS1278_SIM_SIGNAL_ZERO:
+        default:
+            return 0;
+    }
+}
+
+static int sim_open(void **state, const ads1278_cfg_t *cfg)
+{
+    sim_state_t *st;
+    double rate_hz;
+    double signal_hz;
+
+    if (cfg->sim.signal > ADS1278_SIM_SIGNAL_NOISE) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    st = calloc(1U, sizeof(*st));
+    if (st == NULL) {
+        return -1;
+    }
+
+    st->cfg = cfg->sim;
+    st->rng = (cfg->sim.seed != 0U) ? cfg->sim.seed : SIM_DEFAULT_SEED;
+    st->amplitude = (cfg->sim.amplitude == 0U) ? (ADS1278_SAMPLE_MAX / 2) :
+        (int32_t)((cfg->sim.amplitude > (uint32_t)ADS1278_SAMPLE_MAX) ?
+            (uint32_t)ADS1278_SAMPLE_MAX : cfg->sim.amplitude);
+
+    rate_hz = (cfg->sim.drdy_rate_hz != 0U) ? (double)cfg->sim.drdy_rate_hz : SIM_NOMINAL_RATE_HZ;
+    signal_hz = (cfg->sim.signal_hz > 0.0) ? cfg->sim.signal_hz : rate_hz / 100.0;
+    st->phase_step = 6.283185307179586 * signal_hz / rate_hz;
+
+    if (cfg->sim.drdy_rate_hz != 0U) {
+        st->period_ns = 1000000000ULL / cfg->sim.drdy_rate_hz;
+        if (st->period_ns == 0U) {
+            st->period_ns = 1U;
+        }
+    }
+    st->next_edge_ns = ads1278_monotonic_now_ns() + st->period_ns;
+
+    ads1278_gpio_init(&st->drdy_gpio, &ads1278_gpio_cdev_ops);
+    if (cfg->drdy_gpiochip != NULL) {
+        if (st->drdy_gpio.ops->open_drdy(&st->drdy_gpio, cfg->drdy_gpiochip,
+                cfg->drdy_gpio_number) != 0) {
+            int saved_errno = errno;
+
+            free(st);
+            errno = saved_errno;
+            return -1;
+        }
+        st->external_drdy = 1;
+    }
+
+    *state = st;
+    return 0;
+}
+
+static int sim_set_sync(void *state, int level)
+{
+    sim_state_t *st = state;
+
+    /* Releasing /SYNC restarts the conversion clock, as on the real device. */
+    if (level != 0) {
+        st->next_edge_ns = ads1278_monotonic_now_ns() + st->period_ns;
+        st->next_index = 0U;
+    }
+    return 0;
+}
+
+static int sim_wait_drdy(void *state, uint32_t timeout_ms, ads1278_drdy_event_t *ev)
+{
+    sim_state_t *st = state;
+    uint64_t now;
+    uint64_t edge;
+
+    ev->missed = 0U;
+    if (st->external_drdy) {
+        if (st->drdy_gpio.ops->wait_edge(&st->drdy_gpio, timeout_ms, &ev->edge_ns, &ev->missed) != 0) {
+            return -1;
+        }
+        st->next_index += ev->missed;
+        st->cur_index = st->next_index++;
+        return 0;
+    }
+
+    now = ads1278_monotonic_now_ns();
+    if (st->period_ns == 0U) {
+        st->cur_index = st->next_index++;
+        ev->edge_ns = now;
+        return 0;
+    }
+
+    /* Edges we slept through are gone; the latest one is still pending. */
+    if (now >= st->next_edge_ns + st->period_ns) {
+        uint64_t skipped = (now - st->next_edge_ns) / st->period_ns;
+
+        st->next_edge_ns += skipped * st->period_ns;
+        st->next_index += skipped;
+        ev->missed = (skipped > UINT32_MAX) ? UINT32_MAX : (uint32_t)skipped;
+    }
+
+    edge = st->next_edge_ns;
+    if (st->cfg.jitter_ns != 0U) {
+        uint32_t span = 2U * st->cfg.jitter_ns + 1U;
+        int64_t offset = (int64_t)(sim_rand(st) % span) - (int64_t)st->cfg.jitter_ns;
+
+        edge = (uint64_t)((int64_t)edge + offset);
+    }
+
+    if (edge > now) {
+        uint64_t timeout_ns = (uint64_t)timeout_ms * 1000000ULL;
+
+        if (edge - now > timeout_ns) {
+            (void)sim_sleep_until(now + timeout_ns);
+            errno = ETIMEDOUT;
+            return -1;
+        }
+        if (st->cfg.busy_wait) {
+            while (ads1278_monotonic_now_ns() < edge) {
+            }
+        } else if (sim_sleep_until(edge) != 0) {
+            return -1;
+        }
+    }
+
+    st->cur_index = st->next_index++;
+    st->next_edge_ns += st->period_ns;
+    ev->edge_ns = edge;
+    return 0;
+}
+
+static int sim_transfer(void *state, uint8_t *rx, size_t len)
+{
+    sim_state_t *st = state;
+    size_t offset;
+    uint32_t channel = 0U;
+
+    if ((len % 3U) != 0U) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    ++st->xfer_count;
+    if (st->cfg.xfer_delay_every != 0U && st->cfg.xfer_delay_us != 0U &&
+        (st->xfer_count % st->cfg.xfer_delay_every) == 0U) {
+        if (sim_sleep_until(ads1278_monotonic_now_ns() +
+                (uint64_t)st->cfg.xfer_delay_us * 1000ULL) != 0) {
+            return -1;
+        }
+    }
+
+    for (offset = 0U; offset < len; offset += 3U) {
+        uint32_t raw24 = (uint32_t)sim_sample(st, st->cur_index, channel);
+
+        rx[offset] = (uint8_t)(raw24 >> 16U);
+        rx[offset + 1U] = (uint8_t)(raw24 >> 8U);
+        rx[offset + 2U] = (uint8_t)raw24;
+        ++channel;
+    }
+
+    return 0;
+}
+
+static void sim_close(void *state)
+{
+    sim_state_t *st = state;
+
+    if (st == NULL) {
+        return;
+    }
+
+    st->drdy_gpio.ops->close(&st->drdy_gpio);
+    free(st);
+}
+
+const ads1278_backend_ops_t ads1278_backend_sim_ops = {
+    .name = "sim",
+    .open = sim_open,
+    .set_sync = sim_set_sync,
+    .wait_drdy = sim_wait_drdy,
+    .transfer = sim_transfer,
+    .close = sim_close
+};
@@ -0,0 +1,301 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Miguel Dovale (University of Arizona)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "ads1278_backend.h"
+#include "ads1278_gpio.h"
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef __linux__
+
+static int spidev_open(void **state, const ads1278_cfg_t *cfg)
+{
+    (void)state;
+    (void)cfg;
+    errno = ENOTSUP;
+    return -1;
+}
+
+static int spidev_wait_drdy(void *state, uint32_t timeout_ms, ads1278_drdy_event_t *ev)
+{
+    (void)state;
+    (void)timeout_ms;
+    (void)ev;
+    errno = ENOTSUP;
+    return -1;
+}
+
+static int spidev_transfer(void *state, uint8_t *rx, size_t len)
+{
+    (void)state;
+    (void)rx;
+    (void)len;
+    errno = ENOTSUP;
+    return -1;
+}
+
+static void spidev_close(void *state)
+{
+    (void)state;
+}
+
+const ads1278_backend_ops_t ads1278_backend_spidev_ops = {
+    .name = "spidev",
+    .open = spidev_open,
+    .set_sync = NULL,
+    .wait_drdy = spidev_wait_drdy,
+    .transfer = spidev_transfer,
+    .close = spidev_close
+};
+
+#else
+
+#include <fcntl.h>
+#include <linux/spi/spidev.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+typedef struct {
+    int spi_fd;
+    uint32_t sclk_hz;
+    ads1278_gpio_t drdy_gpio;
+    ads1278_gpio_t sync_gpio;
+    uint8_t tx_zeros[ADS1278_MAX_FRAME_BYTES];  /* DIN of the chain's last device reads zeros */
+} spidev_state_t;
+
+static int spi_open_and_configure(const ads1278_cfg_t *cfg)
+{
+    int fd = -1;
+    uint8_t mode;
+    uint8_t effective_mode = 0U;
+    uint8_t bits_per_word = 8U;
+    uint8_t effective_bits_per_word = 0U;
+    uint32_t max_speed_hz;
+    uint32_t effective_max_speed_hz = 0U;
+
+    fd = open(cfg->spidev_path, O_RDWR | O_CLOEXEC);
+    if (fd < 0) {
+        return -1;
+    }
+
+    mode = cfg->spi_mode;
+#ifdef SPI_NO_CS
+    if (cfg->spi_no_cs) {
+        mode = (uint8_t)(mode | SPI_NO_CS);
+    }
+#endif
+
+    if (ioctl(fd, SPI_IOC_WR_MODE, &mode) < 0) {
+        /* Some kernels/drivers reject SPI_NO_CS with EINVAL even when defined. */
+#ifdef SPI_NO_CS
+        if (cfg->spi_no_cs && errno == EINVAL) {
+            mode = cfg->spi_mode;
+            if (ioctl(fd, SPI_IOC_WR_MODE, &mode) == 0) {
+                goto spi_mode_ok;
+            }
+        }
+#endif
+        close(fd);
+        return -1;
+    }
+
+spi_mode_ok:
+    if (ioctl(fd, SPI_IOC_WR_BITS_PER_WORD, &bits_per_word) < 0) {
+        close(fd);
+        return -1;
+    }
+
+    max_speed_hz = cfg->sclk_hz;
+    if (ioctl(fd, SPI_IOC_WR_MAX_SPEED_HZ, &max_speed_hz) < 0) {
+        close(fd);
+        return -1;
+    }
+
+    if (ioctl(fd, SPI_IOC_RD_MODE, &effective_mode) < 0) {
+        close(fd);
+        return -1;
+    }
+    if (ioctl(fd, SPI_IOC_RD_BITS_PER_WORD, &effective_bits_per_word) < 0) {
+        close(fd);
+        return -1;
+    }
+    if (ioctl(fd, SPI_IOC_RD_MAX_SPEED_HZ, &effective_max_speed_hz) < 0) {
+        close(fd);
+        return -1;
+    }
+    if ((effective_mode & (SPI_CPHA | SPI_CPOL)) != (cfg->spi_mode & (SPI_CPHA | SPI_CPOL))) {
+        close(fd);
+        errno = EINVAL;
+        return -1;
+    }
+    if (effective_bits_per_word != bits_per_word) {
+        close(fd);
+        errno = EINVAL;
+        return -1;
+    }
+    if (effective_max_speed_hz == 0U) {
+        close(fd);
+        errno = EIO;
+        return -1;
+    }
+
+    fprintf(stderr,
+        "ads1278 spi: req(mode=%u,bpw=%u,speed=%u) eff(mode=%u,bpw=%u,speed=%u)\n",
+        (unsigned)cfg->spi_mode,
+        (unsigned)bits_per_word,
+        (unsigned)cfg->sclk_hz,
+        (unsigned)effective_mode,
+        (unsigned)effective_bits_per_word,
+        (unsigned)effective_max_speed_hz);
+
+    return fd;
+}
+
+static void spidev_close(void *state)
+{
+    spidev_state_t *st = state;
+
+    if (st == NULL) {
+        return;
+    }
+
+    if (st->spi_fd >= 0) {
+        close(st->spi_fd);
+        st->spi_fd = -1;
+    }
+
+    if (st->drdy_gpio.ops != NULL) {
+        st->drdy_gpio.ops->close(&st->drdy_gpio);
+    }
+    if (st->sync_gpio.ops != NULL) {
+        st->sync_gpio.ops->close(&st->sync_gpio);
+    }
+    free(st);
+}
+
+static int spidev_open(void **state, const ads1278_cfg_t *cfg)
+{
+    spidev_state_t *st = calloc(1U, sizeof(*st));
+
+    if (st == NULL) {
+        return -1;
+    }
+
+    st->spi_fd = -1;
+    st->sclk_hz = cfg->sclk_hz;
+    ads1278_gpio_init(&st->drdy_gpio, ads1278_gpio_ops_for(cfg->drdy_gpiochip));
+    ads1278_gpio_init(&st->sync_gpio, ads1278_gpio_ops_for(cfg->sync_gpiochip));
+
+    st->spi_fd = spi_open_and_configure(cfg);
+    if (st->spi_fd < 0) {
+        goto fail;
+    }
+
+    if (st->drdy_gpio.ops->open_drdy(&st->drdy_gpio, cfg->drdy_gpiochip,
+            cfg->drdy_gpio_number) != 0) {
+        goto fail;
+    }
+
+    if (cfg->use_sync && st->sync_gpio.ops->open_sync(&st->sync_gpio, cfg->sync_gpiochip,
+            cfg->sync_gpio_number) != 0) {
+        goto fail;
+    }
+
+    *state = st;
+    return 0;
+
+fail:
+    {
+        int saved_errno = errno;
+
+        spidev_close(st);
+        errno = saved_errno;
+    }
+    return -1;
+}
+
+static int spidev_set_sync(void *state, int level)
+{
+    spidev_state_t *st = state;
+
+    return st->sync_gpio.ops->set_value(&st->sync_gpio, level);
+}
+
+static int spidev_wait_drdy(void *state, uint32_t timeout_ms, ads1278_drdy_event_t *ev)
+{
+    spidev_state_t *st = state;
+
+    return st->drdy_gpio.ops->wait_edge(&st->drdy_gpio, timeout_ms, &ev->edge_ns, &ev->missed);
+}
+
+static int spidev_transfer(void *state, uint8_t *rx, size_t len)
+{
+    spidev_state_t *st = state;
+    struct spi_ioc_transfer transfer = {0};
+    int rc;
+
+    if (len > sizeof(st->tx_zeros)) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    transfer.tx_buf = (uintptr_t)st->tx_zeros;
+    transfer.rx_buf = (uintptr_t)rx;
+    transfer.len = (uint32_t)len;
+    transfer.speed_hz = st->sclk_hz;
+    transfer.bits_per_word = 8U;
+
+    rc = ioctl(st->spi_fd, SPI_IOC_MESSAGE(1), &transfer);
+    if (rc < 0) {
+        return -1;
+    }
+    if ((size_t)rc != len) {
+        errno = EIO;
+        return -1;
+    }
+
+    return 0;
+}
+
+const ads1278_backend_ops_t ads1278_backend_spidev_ops = {
+    .name = "spidev",
+    .open = spidev_open,
+    .set_sync = spidev_set_sync,
+    .wait_drdy = spidev_wait_drdy,
+    .transfer = spidev_transfer,
+    .close = spidev_close
+};
+
+#endif /* __linux__ */
@@ -0,0 +1,328 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Miguel Dovale (University of Arizona)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "clock_model.h"
+
+#include <math.h>
+#include <string.h>
+
+static int64_t signed_diff(uint64_t a, uint64_t b)
+{
+    return (int64_t)(a - b);
+}
+
+/* Where the reference line puts seq, in ns relative to its anchor. */
+static double reference_resid(const clock_model_t *model, uint64_t seq, uint64_t tstamp_ns)
+{
+    if (model->locked) {
+        return (double)signed_diff(tstamp_ns, model->line_ns) - model->line_frac_ns -
+            (double)signed_diff(seq, model->line_seq) * model->period_ns;
+    }
+    return (double)signed_diff(tstamp_ns, model->first_ns) -
+        (double)signed_diff(seq, model->first_seq) * model->block_period_ns;
+}
+
+static uint64_t line_at(const clock_model_t *model, uint64_t seq)
+{
+    double offset = model->line_frac_ns + (double)signed_diff(seq, model->line_seq) * model->period_ns;
+
+    return model->line_ns + (uint64_t)llround(offset);
+}
+
+static void sort_double(double *values, uint32_t n)
+{
+    uint32_t idx;
+
+    for (idx = 1U; idx < n; ++idx) {
+        double value = values[idx];
+        uint32_t pos = idx;
+
+        while (pos > 0U && values[pos - 1U] > value) {
+            values[pos] = values[pos - 1U];
+            --pos;
+        }
+        values[pos] = value;
+    }
+}
+
+/*
+ * Least squares over the points marked in keep, coordinates relative to
+ * (seq_ref, ns_ref). Returns false when fewer than two points or no spread.
+ */
+static bool fit_line(const clock_model_t *model, const bool *keep, uint64_t seq_ref, uint64_t ns_ref,
+                     double *intercept, double *slope)
+{
+    double sx = 0.0;
+    double sy = 0.0;
+    double sxx = 0.0;
+    double sxy = 0.0;
+    double n = 0.0;
+    double den;
+    uint32_t idx;
+
+    for (idx = 0U; idx < model->pt_fill; ++idx) {
+        double x;
+        double y;
+
+        if (!keep[idx]) {
+            continue;
+        }
+        x = (double)signed_diff(model->pt_seq[idx], seq_ref);
+        y = (double)signed_diff(model->pt_ns[idx], ns_ref);
+        sx += x;
+        sy += y;
+        sxx += x * x;
+        sxy += x * y;
+        n += 1.0;
+    }
+    if (n < 2.0) {
+        return false;
+    }
+    den = n * sxx - sx * sx;
+    if (den <= 0.0) {
+        return false;
+    }
+    *slope = (n * sxy - sx * sy) / den;
+    *intercept = (sy - *slope * sx) / n;
+    return *slope > 0.0;
+}
+
+/* Two-pass fit: drop points far off the first line (by MAD), refit the rest. */
+static bool robust_fit(const clock_model_t *model, uint64_t seq_ref, uint64_t ns_ref, double *intercept, double *slope)
+{
+    bool keep[CLOCK_MODEL_POINTS];
+    double resid[CLOCK_MODEL_POINTS];
+    double sorted[CLOCK_MODEL_POINTS];
+    double median;
+    double limit;
+    uint32_t n = model->pt_fill;
+    uint32_t kept = 0U;
+    uint32_t idx;
+
+    for (idx = 0U; idx < CLOCK_MODEL_POINTS; ++idx) {
+        keep[idx] = idx < n;
+    }
+    if (!fit_line(model, keep, seq_ref, ns_ref, intercept, slope)) {
+        return false;
+    }
+    for (idx = 0U; idx < n; ++idx) {
+        double x = (double)signed_diff(model->pt_seq[idx], seq_ref);
+
+        resid[idx] = (double)signed_diff(model->pt_ns[idx], ns_ref) - (*intercept + *slope * x);
+        sorted[idx] = resid[idx];
+    }
+    sort_double(sorted, n);
+    median = sorted[n / 2U];
+    for (idx = 0U; idx < n; ++idx) {
+        sorted[idx] = fabs(resid[idx] - median);
+    }
+    sort_double(sorted, n);
+    /* A 1 ns floor keeps an exact (jitter-free) set from rejecting itself. */
+    limit = CLOCK_MODEL_REJECT_MAD * sorted[n / 2U] + 1.0;
+    for (idx = 0U; idx < n; ++idx) {
+        keep[idx] = fabs(resid[idx] - median) <= limit;
+        kept += keep[idx] ? 1U : 0U;
+    }
+    if (kept == n || kept < CLOCK_MODEL_MIN_POINTS / 2U) {
+        return true;
+    }
+    return fit_line(model, keep, seq_ref, ns_ref, intercept, slope);
+}
+
+static void restart(clock_model_t *model)
+{
+    model->locked = false;
+    model->started = false;
+    model->block_open = false;
+    model->pt_fill = 0U;
+    model->pt_pos = 0U;
+    model->outlier_run = 0U;
+}
+
+/* Close the open block: its minimum becomes a point, then refit at seq. */
+static void close_block(clock_model_t *model, uint64_t seq)
+{
+    uint64_t newest_seq = model->block_seq;
+    uint64_t newest_ns = model->block_ns;
+    double intercept;
+    double slope;
+    double fitted;
+
+    model->block_open = false;
+    if (model->locked) {
+        if (fabs(reference_resid(model, newest_seq, newest_ns)) > CLOCK_MODEL_OUTLIER_NS) {
+            ++model->outliers;
+            if (++model->outlier_run >= CLOCK_MODEL_RELOCK_AFTER) {
+                ++model->relocks;
+                restart(model);
+            }
+            return;
+        }
+    }
+    model->outlier_run = 0U;
+
+    model->pt_seq[model->pt_pos] = newest_seq;
+    model->pt_ns[model->pt_pos] = newest_ns;
+    model->pt_pos = (model->pt_pos + 1U) % CLOCK_MODEL_POINTS;
+    if (model->pt_fill < CLOCK_MODEL_POINTS) {
+        ++model->pt_fill;
+    }
+    if (model->pt_fill < CLOCK_MODEL_MIN_POINTS ||
+        !robust_fit(model, newest_seq, newest_ns, &intercept, &slope)) {
+        return;
+    }
+    fitted = intercept + slope * (double)signed_diff(seq, newest_seq);
+
+    if (!model->locked) {
+        double whole = floor(fitted);
+
+        model->locked = true;
+        model->line_seq = seq;
+        model->line_ns = newest_ns + (uint64_t)(int64_t)whole;
+        model->line_frac_ns = fitted - whole;
+        model->period_ns = slope;
+        model->fit_period_ns = slope;
+        model->lock_period_ns = slope;
+        return;
+    }
+
+    /* Keep the output continuous at seq; close the offset over the slew time. */
+    {
+        double exact = model->line_frac_ns + (double)signed_diff(seq, model->line_seq) * model->period_ns;
+        double whole = floor(exact);
+        double offset;
+
+        model->line_seq = seq;
+        model->line_ns += (uint64_t)(int64_t)whole;
+        model->line_frac_ns = exact - whole;
+        offset = (double)signed_diff(newest_ns, model->line_ns) + fitted - model->line_frac_ns;
+        model->period_ns = slope + offset * slope / CLOCK_MODEL_SLEW_NS;
+        model->fit_period_ns = slope;
+        ++model->fits;
+    }
+}
+
+void clock_model_init(clock_model_t *model, uint32_t nominal_rate_hz)
+{
+    memset(model, 0, sizeof(*model));
+    model->nominal_period_ns = (nominal_rate_hz != 0U) ? 1e9 / (double)nominal_rate_hz : 0.0;
+}
+
+uint64_t clock_model_next(clock_model_t *model, uint64_t seq, uint64_t tstamp_ns)
+{
+    uint64_t out;
+    double resid;
+
+    if (tstamp_ns == 0U) {
+        if (!model->locked) {
+            return 0U;
+        }
+        out = line_at(model, seq);
+        goto out;
+    }
+
+    ++model->frames;
+    if (model->block_open && signed_diff(tstamp_ns, model->block_start_ns) >= (int64_t)CLOCK_MODEL_BLOCK_NS) {
+        close_block(model, seq);
+    }
+    if (!model->started) {
+        model->started = true;
+        model->first_seq = seq;
+        model->first_ns = tstamp_ns;
+    }
+    if (!model->block_open) {
+        model->block_open = true;
+        model->block_start_ns = tstamp_ns;
+        model->block_resid = INFINITY;
+        if (model->nominal_period_ns != 0.0) {
+            model->block_period_ns = model->nominal_period_ns;
+        } else if (seq != model->first_seq) {
+            model->block_period_ns = (double)signed_diff(tstamp_ns, model->first_ns) /
+                (double)(seq - model->first_seq);
+        } else {
+            model->block_period_ns = 0.0;
+        }
+    }
+    resid = reference_resid(model, seq, tstamp_ns);
+    if (resid < model->block_resid) {
+        model->block_resid = resid;
+        model->block_seq = seq;
+        model->block_ns = tstamp_ns;
+    }
+
+    if (!model->locked) {
+        out = tstamp_ns;
+        goto out;
+    }
+    out = line_at(model, seq);
+    {
+        double r = (double)signed_diff(tstamp_ns, out);
+        uint64_t mag = (uint64_t)fabs(r);
+
+        model->resid_sum += r;
+        model->resid_sum_sq += r * r;
+        ++model->resid_count;
+        if (mag > model->resid_max_ns) {
+            model->resid_max_ns = mag;
+        }
+    }
+
+out:
+    if (model->last_out_ns != 0U && signed_diff(out, model->last_out_ns) <= 0) {
+        out = model->last_out_ns + 1U;
+    }
+    model->last_out_ns = out;
+    return out;
+}
+
+double clock_model_jitter_ns(const clock_model_t *model)
+{
+    double mean;
+    double var;
+
+    if (model->resid_count == 0U) {
+        return 0.0;
+    }
+    mean = model->resid_sum / (double)model->resid_count;
+    var = model->resid_sum_sq / (double)model->resid_count - mean * mean;
+    return (var > 0.0) ? sqrt(var) : 0.0;
+}
+
+double clock_model_drift_ppm(const clock_model_t *model)
+{
+    double reference = (model->nominal_period_ns != 0.0) ? model->nominal_period_ns : model->lock_period_ns;
+
+    if (!model->locked || model->fit_period_ns <= 0.0 || reference == 0.0) {
+        return 0.0;
+    }
+    return (reference / model->fit_period_ns - 1.0) * 1e6;
+}
@@ -0,0 +1,209 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Miguel Dovale (University of Arizona)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "drdy_model.h"
+
+#include <math.h>
+#include <string.h>
+
+static void sort_u64(uint64_t *values, uint32_t n)
+{
+    uint32_t idx;
+
+    for (idx = 1U; idx < n; ++idx) {
+        uint64_t value = values[idx];
+        uint32_t pos = idx;
+
+        while (pos > 0U && values[pos - 1U] > value) {
+            values[pos] = values[pos - 1U];
+            --pos;
+        }
+        values[pos] = value;
+    }
+}
+
+/* Median and median absolute deviation of the window; locks when the MAD is small. */
+static void refit(drdy_model_t *model)
+{
+    uint64_t sorted[DRDY_MODEL_WINDOW];
+    uint32_t n = model->window_fill;
+    uint64_t median;
+    uint32_t idx;
+
+    memcpy(sorted, model->window, n * sizeof(sorted[0]));
+    sort_u64(sorted, n);
+    median = sorted[n / 2U];
+    for (idx = 0U; idx < n; ++idx) {
+        sorted[idx] = (sorted[idx] > median) ? sorted[idx] - median : median - sorted[idx];
+    }
+    sort_u64(sorted, n);
+    if (median != 0U && sorted[n / 2U] * DRDY_MODEL_LOCK_MAD_DIV <= median) {
+        model->median_ns = (double)median;
+        if (model->period_ns == 0.0) {
+            model->period_ns = model->median_ns;
+        }
+    } else if (model->period_ns == 0.0 || sorted[n / 2U] * DRDY_MODEL_UNLOCK_MAD_DIV > median) {
+        model->period_ns = 0.0;
+        model->base_tstamp_ns = 0U;
+        model->grid_ns = 0.0;
+    }
+}
+
+/* Long-baseline period from the first clean frame since lock. */
+static void update_baseline(drdy_model_t *model, uint64_t tstamp_ns)
+{
+    uint64_t span;
+
+    if (model->period_ns == 0.0) {
+        return;
+    }
+    if (model->base_tstamp_ns == 0U) {
+        model->base_index = model->last_index;
+        model->base_tstamp_ns = tstamp_ns;
+        return;
+    }
+    span = model->last_index - model->base_index;
+    model->period_ns = (span >= DRDY_MODEL_WINDOW)
+        ? (double)(tstamp_ns - model->base_tstamp_ns) / (double)span
+        : model->median_ns;
+}
+
+void drdy_model_init(drdy_model_t *model, bool enabled, uint32_t nominal_rate_hz)
+{
+    memset(model, 0, sizeof(*model));
+    model->enabled = enabled;
+    model->nominal_period_ns = (nominal_rate_hz != 0U) ? 1e9 / (double)nominal_rate_hz : 0.0;
+}
+
+/*
+ * Edge time of last_index on the fitted grid: advanced by whole periods and
+ * pulled 1/DRDY_MODEL_PHASE_GAIN of the way toward each timestamp (1/n while
+ * fewer frames than that are on it), so one
+ * frame's jitter moves it by a fraction of that jitter. Ambiguous frames
+ * steer it too, clamped to half a period, or a grid that drifted into the
+ * ambiguous band would never be pulled back out.
+ */
+static void update_grid(drdy_model_t *model, double period, uint64_t steps, uint64_t tstamp_ns)
+{
+    double residual;
+
+    if (model->grid_ns == 0.0) {
+        model->grid_ns = (double)tstamp_ns;
+        model->grid_frames = 1U;
+        return;
+    }
+    model->grid_ns += (double)steps * period;
+    residual = (double)tstamp_ns - model->grid_ns;
+    if (residual > 0.5 * period) {
+        residual = 0.5 * period;
+    } else if (residual < -0.5 * period) {
+        residual = -0.5 * period;
+    }
+    /* A fresh grid starts as the running mean of its residuals. */
+    if (model->grid_frames < (uint32_t)DRDY_MODEL_PHASE_GAIN) {
+        ++model->grid_frames;
+    }
+    model->grid_ns += residual / (double)model->grid_frames;
+}
+
+uint64_t drdy_model_next(drdy_model_t *model, uint64_t tstamp_ns, uint32_t known_missed)
+{
+    uint64_t steps = 1U + (uint64_t)known_missed;
+    double period = 0.0;
+    bool clean = false;
+
+    if (!model->started) {
+        model->started = true;
+        model->last_index = 0U;
+        model->last_tstamp_ns = tstamp_ns;
+        model->grid_ns = (model->enabled && tstamp_ns != 0U) ? (double)tstamp_ns : 0.0;
+        return 0U;
+    }
+
+    if (model->enabled && tstamp_ns != 0U && model->last_tstamp_ns != 0U && tstamp_ns > model->last_tstamp_ns) {
+        uint64_t dt = tstamp_ns - model->last_tstamp_ns;
+
+        period = (model->period_ns != 0.0) ? model->period_ns : model->nominal_period_ns;
+        clean = true;
+        if (period != 0.0) {
+            /*
+             * Measured from the grid, not the previous timestamp, so only this
+             * frame's jitter counts; two jittered stamps would double it.
+             */
+            double ref = (model->grid_ns != 0.0) ? model->grid_ns : (double)model->last_tstamp_ns;
+            double ratio = ((double)tstamp_ns - ref) / period;
+            double nearest = floor(ratio + 0.5);
+            double place = nearest;
+
+            if (fabs(ratio - nearest) > DRDY_MODEL_AMBIGUOUS_FRAC) {
+                /* Near a half period: take the fewer conversions rather than invent a gap. */
+                ++model->ambiguous;
+                clean = false;
+                place = floor(ratio);
+            }
+            if (place > (double)steps) {
+                steps = (uint64_t)place;
+            }
+        }
+
+        /* Ambiguous intervals would bias the fit toward the jitter. */
+        if (clean) {
+            model->window[model->window_pos] = dt / steps;
+            model->window_pos = (model->window_pos + 1U) % DRDY_MODEL_WINDOW;
+            if (model->window_fill < DRDY_MODEL_WINDOW) {
+                ++model->window_fill;
+            }
+            if (++model->since_fit >= DRDY_MODEL_REFIT_EVERY && model->window_fill >= DRDY_MODEL_WARMUP) {
+                model->since_fit = 0U;
+                refit(model);
+            }
+        }
+    }
+
+    if (steps > 1U) {
+        model->missed += steps - 1U;
+        ++model->gaps;
+        if (steps - 1U > model->longest_gap) {
+            model->longest_gap = steps - 1U;
+        }
+    }
+    model->last_index += steps;
+    model->last_tstamp_ns = tstamp_ns;
+    if (period != 0.0 && tstamp_ns != 0U) {
+        update_grid(model, period, steps, tstamp_ns);
+    } else {
+        model->grid_ns = 0.0;
+    }
+    if (clean && tstamp_ns != 0U) {
+        update_baseline(model, tstamp_ns);
+    }
+    return model->last_index;
+}
@@ -0,0 +1,305 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Miguel Dovale (University of Arizona)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * GPIO character device (v2 uAPI) lines. A DRDY line request delivers
+ * gpio_v2_line_event records stamped by the kernel in the edge IRQ, so one
+ * read() returns the edge time plus every queued edge, and per-line sequence
+ * numbers expose edges the kernel saw but we never serviced.
+ */
+
+#include "ads1278.h"
+#include "ads1278_gpio.h"
+
+#include <errno.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifndef __linux__
+
+static int cdev_open_line(ads1278_gpio_t *gpio, const char *chip, uint32_t line)
+{
+    (void)gpio;
+    (void)chip;
+    (void)line;
+    errno = ENOTSUP;
+    return -1;
+}
+
+static int cdev_set_value(ads1278_gpio_t *gpio, int value)
+{
+    (void)gpio;
+    (void)value;
+    errno = ENOTSUP;
+    return -1;
+}
+
+static int cdev_wait_edge(ads1278_gpio_t *gpio, uint32_t timeout_ms, uint64_t *edge_ns, uint32_t *missed)
+{
+    (void)gpio;
+    (void)timeout_ms;
+    (void)edge_ns;
+    (void)missed;
+    errno = ENOTSUP;
+    return -1;
+}
+
+static void cdev_close(ads1278_gpio_t *gpio)
+{
+    (void)gpio;
+}
+
+const ads1278_gpio_ops_t ads1278_gpio_cdev_ops = {
+    .name = "cdev",
+    .open_drdy = cdev_open_line,
+    .open_sync = cdev_open_line,
+    .set_value = cdev_set_value,
+    .wait_edge = cdev_wait_edge,
+    .close = cdev_close
+};
+
+#else
+
+#include <fcntl.h>
+#include <linux/gpio.h>
+#include <poll.h>
+#include <stdio.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+#define CDEV_CONSUMER_LABEL "ads1278"
+#define CDEV_EVENT_BUFFER_SIZE 64U
+#define CDEV_EVENTS_PER_READ CDEV_EVENT_BUFFER_SIZE /* one read() empties the kernel FIFO */
+
+static int cdev_request_line(ads1278_gpio_t *gpio, const char *chip, uint32_t offset,
+    uint64_t flags, int initial_value)
+{
+    struct gpio_v2_line_request req;
+    int chip_fd;
+    int saved_errno;
+
+    if (chip == NULL) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    chip_fd = open(chip, O_RDWR | O_CLOEXEC);
+    if (chip_fd < 0) {
+        return -1;
+    }
+
+    memset(&req, 0, sizeof(req));
+    req.offsets[0] = offset;
+    req.num_lines = 1U;
+    snprintf(req.consumer, sizeof(req.consumer), "%s", CDEV_CONSUMER_LABEL);
+    req.config.flags = flags;
+    if ((flags & GPIO_V2_LINE_FLAG_OUTPUT) != 0U) {
+        req.config.num_attrs = 1U;
+        req.config.attrs[0].attr.id = GPIO_V2_LINE_ATTR_ID_OUTPUT_VALUES;
+        req.config.attrs[0].attr.values = (initial_value != 0) ? 1U : 0U;
+        req.config.attrs[0].mask = 1U;
+    } else {
+        req.event_buffer_size = CDEV_EVENT_BUFFER_SIZE;
+    }
+
+    if (ioctl(chip_fd, GPIO_V2_GET_LINE_IOCTL, &req) < 0) {
+        saved_errno = errno;
+        close(chip_fd);
+        errno = saved_errno;
+        return -1;
+    }
+    close(chip_fd);
+
+    gpio->fd = req.fd;
+    gpio->line = offset;
+    gpio->last_seqno = 0U;
+    return 0;
+}
+
+static int cdev_open_drdy(ads1278_gpio_t *gpio, const char *chip, uint32_t offset)
+{
+    /*
+     * Default event clock is CLOCK_MONOTONIC, the same base as tstamp_ns. The
+     * line fd stays blocking so a wait without a timeout is a single read().
+     */
+    return cdev_request_line(gpio, chip, offset, GPIO_V2_LINE_FLAG_INPUT | GPIO_V2_LINE_FLAG_EDGE_FALLING, 0);
+}
+
+static int cdev_open_sync(ads1278_gpio_t *gpio, const char *chip, uint32_t offset)
+{
+    return cdev_request_line(gpio, chip, offset, GPIO_V2_LINE_FLAG_OUTPUT, 1);
+}
+
+static int cdev_set_value(ads1278_gpio_t *gpio, int value)
+{
+    struct gpio_v2_line_values values;
+
+    if (gpio->fd < 0) {
+        errno = EBADF;
+        return -1;
+    }
+
+    memset(&values, 0, sizeof(values));
+    values.mask = 1U;
+    values.bits = (value != 0) ? 1U : 0U;
+    return ioctl(gpio->fd, GPIO_V2_LINE_SET_VALUES_IOCTL, &values);
+}
+
+static ssize_t cdev_read_events(int fd, struct gpio_v2_line_event *events, size_t max)
+{
+    ssize_t rc;
+
+    do {
+        rc = read(fd, events, max * sizeof(*events));
+    } while (rc < 0 && errno == EINTR);
+
+    if (rc < 0) {
+        return -1;
+    }
+    if ((size_t)rc % sizeof(*events) != 0U) {
+        errno = EIO;
+        return -1;
+    }
+    return rc / (ssize_t)sizeof(*events);
+}
+
+/* 1 when the line has events queued, 0 after timeout_ms without, -1 on error. */
+static int cdev_poll_events(int fd, int timeout_ms)
+{
+    struct pollfd pfd = {0};
+    int rc;
+
+    pfd.fd = fd;
+    pfd.events = POLLIN;
+    do {
+        rc = poll(&pfd, 1, timeout_ms);
+    } while (rc < 0 && errno == EINTR);
+    return rc;
+}
+
+/*
+ * Without a timeout the wait is one blocking read(), which also takes every
+ * queued edge; poll() is only needed to bound the wait.
+ */
+static int cdev_wait_edge(ads1278_gpio_t *gpio, uint32_t timeout_ms, uint64_t *edge_ns, uint32_t *missed)
+{
+    struct gpio_v2_line_event events[CDEV_EVENTS_PER_READ];
+    uint32_t serviced_missed = 0U;
+    ssize_t count;
+    ssize_t idx;
+    int have_edge = 0;
+    int rc;
+
+    if (gpio->fd < 0) {
+        errno = EBADF;
+        return -1;
+    }
+
+    if (timeout_ms != ADS1278_NO_TIMEOUT) {
+        rc = cdev_poll_events(gpio->fd, (int)timeout_ms);
+        if (rc < 0) {
+            return -1;
+        }
+        if (rc == 0) {
+            errno = ETIMEDOUT;
+            return -1;
+        }
+    }
+
+    count = cdev_read_events(gpio->fd, events, CDEV_EVENTS_PER_READ);
+    if (count < 0) {
+        return -1;
+    }
+
+    /* A full buffer may have left newer edges queued: take them without blocking. */
+    for (;;) {
+        for (idx = 0; idx < count; ++idx) {
+            uint32_t seqno = events[idx].line_seqno;
+
+            /* Kernel FIFO overflow leaves a hole in line_seqno. */
+            if (seqno > gpio->last_seqno + 1U) {
+                serviced_missed += seqno - gpio->last_seqno - 1U;
+            }
+            gpio->last_seqno = seqno;
+
+            /* Every queued edge except the newest will never get its own transfer. */
+            if (have_edge) {
+                ++serviced_missed;
+            }
+            *edge_ns = events[idx].timestamp_ns;
+            have_edge = 1;
+        }
+
+        if (count < (ssize_t)CDEV_EVENTS_PER_READ) {
+            break;
+        }
+        rc = cdev_poll_events(gpio->fd, 0);
+        if (rc < 0) {
+            return -1;
+        }
+        if (rc == 0) {
+            break;
+        }
+        count = cdev_read_events(gpio->fd, events, CDEV_EVENTS_PER_READ);
+        if (count < 0) {
+            return -1;
+        }
+    }
+
+    if (!have_edge) {
+        errno = EIO;
+        return -1;
+    }
+
+    *missed = serviced_missed;
+    return 0;
+}
+
+static void cdev_close(ads1278_gpio_t *gpio)
+{
+    if (gpio->fd >= 0) {
+        close(gpio->fd);
+    }
+
+    ads1278_gpio_init(gpio, gpio->ops);
+}
+
+const ads1278_gpio_ops_t ads1278_gpio_cdev_ops = {
+    .name = "cdev",
+    .open_drdy = cdev_open_drdy,
+    .open_sync = cdev_open_sync,
+    .set_value = cdev_set_value,
+    .wait_edge = cdev_wait_edge,
+    .close = cdev_close
+};
+
+#endif /* __linux__ */
@@ -0,0 +1,295 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Miguel Dovale (University of Arizona)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "ads1278.h"
+#include "ads1278_gpio.h"
+
+#include <errno.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifndef __linux__
+
+static int sysfs_open_line(ads1278_gpio_t *gpio, const char *chip, uint32_t line)
+{
+    (void)gpio;
+    (void)chip;
+    (void)line;
+    errno = ENOTSUP;
+    return -1;
+}
+
+static int sysfs_set_value(ads1278_gpio_t *gpio, int value)
+{
+    (void)gpio;
+    (void)value;
+    errno = ENOTSUP;
+    return -1;
+}
+
+static int sysfs_wait_edge(ads1278_gpio_t *gpio, uint32_t timeout_ms, uint64_t *edge_ns, uint32_t *missed)
+{
+    (void)gpio;
+    (void)timeout_ms;
+    (void)edge_ns;
+    (void)missed;
+    errno = ENOTSUP;
+    return -1;
+}
+
+static void sysfs_close(ads1278_gpio_t *gpio)
+{
+    (void)gpio;
+}
+
+const ads1278_gpio_ops_t ads1278_gpio_sysfs_ops = {
+    .name = "sysfs",
+    .open_drdy = sysfs_open_line,
+    .open_sync = sysfs_open_line,
+    .set_value = sysfs_set_value,
+    .wait_edge = sysfs_wait_edge,
+    .close = sysfs_close
+};
+
+#else
+
+#include "ads1278_backend.h"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+static int write_text_file(const char *path, const char *value)
+{
+    int fd = open(path, O_WRONLY | O_CLOEXEC);
+    ssize_t written;
+
+    if (fd < 0) {
+        return -1;
+    }
+
+    written = write(fd, value, strlen(value));
+    if (written < 0 || (size_t)written != strlen(value)) {
+        int saved_errno = (written < 0) ? errno : EIO;
+        close(fd);
+        errno = saved_errno;
+        return -1;
+    }
+
+    if (close(fd) < 0) {
+        return -1;
+    }
+
+    return 0;
+}
+
+static int sysfs_export_gpio(uint32_t line_number, int *did_export)
+{
+    char buf[32];
+    int rc;
+
+    snprintf(buf, sizeof(buf), "%u", line_number);
+    rc = write_text_file("/sys/class/gpio/export", buf);
+    if (rc == 0) {
+        *did_export = 1;
+        return 0;
+    }
+
+    if (errno == EBUSY) {
+        *did_export = 0;
+        return 0;
+    }
+    return -1;
+}
+
+static int sysfs_unexport_gpio(uint32_t line_number)
+{
+    char buf[32];
+
+    snprintf(buf, sizeof(buf), "%u", line_number);
+    return write_text_file("/sys/class/gpio/unexport", buf);
+}
+
+static int sysfs_set_gpio_attr(uint32_t line_number, const char *attr, const char *value)
+{
+    char path[96];
+
+    snprintf(path, sizeof(path), "/sys/class/gpio/gpio%u/%s", line_number, attr);
+    return write_text_file(path, value);
+}
+
+static int sysfs_open_gpio_value(uint32_t line_number, int flags)
+{
+    char path[96];
+
+    snprintf(path, sizeof(path), "/sys/class/gpio/gpio%u/value", line_number);
+    return open(path, flags | O_CLOEXEC);
+}
+
+static int sysfs_open_drdy(ads1278_gpio_t *gpio, const char *chip, uint32_t line_number)
+{
+    (void)chip;
+    gpio->line = line_number;
+
+    if (sysfs_export_gpio(line_number, &gpio->exported) != 0) {
+        return -1;
+    }
+
+    if (sysfs_set_gpio_attr(line_number, "direction", "in") != 0) {
+        return -1;
+    }
+
+    if (sysfs_set_gpio_attr(line_number, "edge", "falling") != 0) {
+        return -1;
+    }
+
+    gpio->fd = sysfs_open_gpio_value(line_number, O_RDONLY | O_NONBLOCK);
+    if (gpio->fd < 0) {
+        return -1;
+    }
+
+    return 0;
+}
+
+static int sysfs_open_sync(ads1278_gpio_t *gpio, const char *chip, uint32_t line_number)
+{
+    (void)chip;
+    gpio->line = line_number;
+
+    if (sysfs_export_gpio(line_number, &gpio->exported) != 0) {
+        return -1;
+    }
+
+    if (sysfs_set_gpio_attr(line_number, "direction", "out") != 0) {
+        return -1;
+    }
+
+    if (sysfs_set_gpio_attr(line_number, "value", "1") != 0) {
+        return -1;
+    }
+
+    gpio->fd = sysfs_open_gpio_value(line_number, O_RDWR);
+    if (gpio->fd < 0) {
+        return -1;
+    }
+
+    return 0;
+}
+
+static int sysfs_set_value(ads1278_gpio_t *gpio, int value)
+{
+    const char out = (value == 0) ? '0' : '1';
+
+    if (gpio->fd < 0) {
+        errno = EBADF;
+        return -1;
+    }
+
+    if (lseek(gpio->fd, 0, SEEK_SET) < 0) {
+        return -1;
+    }
+
+    if (write(gpio->fd, &out, 1) != 1) {
+        if (errno == 0) {
+            errno = EIO;
+        }
+        return -1;
+    }
+
+    return 0;
+}
+
+static int sysfs_wait_edge(ads1278_gpio_t *gpio, uint32_t timeout_ms, uint64_t *edge_ns, uint32_t *missed)
+{
+    char junk[8];
+    struct pollfd pfd = {0};
+    int rc;
+
+    if (gpio->fd < 0) {
+        errno = EBADF;
+        return -1;
+    }
+
+    if (lseek(gpio->fd, 0, SEEK_SET) < 0) {
+        return -1;
+    }
+    (void)read(gpio->fd, junk, sizeof(junk));
+
+    pfd.fd = gpio->fd;
+    pfd.events = POLLPRI | POLLERR;
+    rc = poll(&pfd, 1, (timeout_ms == ADS1278_NO_TIMEOUT) ? -1 : (int)timeout_ms);
+    if (rc < 0) {
+        return -1;
+    }
+    if (rc == 0) {
+        errno = ETIMEDOUT;
+        return -1;
+    }
+    if ((pfd.revents & POLLPRI) == 0) {
+        errno = EIO;
+        return -1;
+    }
+
+    if (lseek(gpio->fd, 0, SEEK_SET) < 0) {
+        return -1;
+    }
+    (void)read(gpio->fd, junk, sizeof(junk));
+
+    /* sysfs carries no edge timestamp or count; the wakeup time is the best we have. */
+    *edge_ns = ads1278_monotonic_now_ns();
+    *missed = 0U;
+    return 0;
+}
+
+static void sysfs_close(ads1278_gpio_t *gpio)
+{
+    if (gpio->fd >= 0) {
+        close(gpio->fd);
+    }
+    if (gpio->exported) {
+        (void)sysfs_unexport_gpio(gpio->line);
+    }
+
+    ads1278_gpio_init(gpio, gpio->ops);
+}
+
+const ads1278_gpio_ops_t ads1278_gpio_sysfs_ops = {
+    .name = "sysfs",
+    .open_drdy = sysfs_open_drdy,
+    .open_sync = sysfs_open_sync,
+    .set_value = sysfs_set_value,
+    .wait_edge = sysfs_wait_edge,
+    .close = sysfs_close
+};
+
+#endif /* __linux__ */
@@ -0,0 +1,163 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Miguel Dovale (University of Arizona)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "lat_hist.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#define SUB_COUNT (1U << LAT_HIST_SUB_BITS)
+
+/* Largest value that lands in bucket idx. */
+static uint64_t bucket_upper(uint32_t idx)
+{
+    uint32_t octave = idx >> LAT_HIST_SUB_BITS;
+    uint64_t sub = idx & (SUB_COUNT - 1U);
+    uint32_t shift;
+
+    if (octave == 0U) {
+        return sub;
+    }
+    shift = octave - 1U;
+    return ((((uint64_t)SUB_COUNT + sub + 1U) << shift) - 1U);
+}
+
+void lat_hist_reset(lat_hist_t *hist)
+{
+    memset(hist, 0, sizeof(*hist));
+    hist->min_ns = UINT64_MAX;
+}
+
+void lat_hist_record(lat_hist_t *hist, uint64_t ns)
+{
+    ++hist->bucket[lat_hist_bucket(ns)];
+    ++hist->count;
+    hist->sum_ns += ns;
+    if (ns < hist->min_ns) {
+        hist->min_ns = ns;
+    }
+    if (ns > hist->max_ns) {
+        hist->max_ns = ns;
+    }
+}
+
+void lat_hist_merge(lat_hist_t *dst, const lat_hist_t *src)
+{
+    uint32_t idx;
+
+    for (idx = 0U; idx < LAT_HIST_BUCKETS; ++idx) {
+        dst->bucket[idx] += src->bucket[idx];
+    }
+    dst->count += src->count;
+    dst->sum_ns += src->sum_ns;
+    if (src->min_ns < dst->min_ns) {
+        dst->min_ns = src->min_ns;
+    }
+    if (src->max_ns > dst->max_ns) {
+        dst->max_ns = src->max_ns;
+    }
+}
+
+uint64_t lat_hist_quantile(const lat_hist_t *hist, double q)
+{
+    uint64_t rank;
+    uint64_t seen = 0U;
+    uint32_t idx;
+
+    if (hist->count == 0U) {
+        return 0U;
+    }
+    if (q <= 0.0) {
+        return hist->min_ns;
+    }
+    rank = (q >= 1.0) ? hist->count : (uint64_t)(q * (double)hist->count) + 1U;
+    if (rank > hist->count) {
+        rank = hist->count;
+    }
+    for (idx = 0U; idx < LAT_HIST_BUCKETS; ++idx) {
+        seen += hist->bucket[idx];
+        if (seen >= rank) {
+            uint64_t upper = bucket_upper(idx);
+
+            return (upper < hist->max_ns) ? upper : hist->max_ns;
+        }
+    }
+    return hist->max_ns;
+}
+
+uint64_t lat_hist_count_above(const lat_hist_t *hist, uint64_t ns)
+{
+    uint64_t above = 0U;
+    uint32_t idx;
+
+    for (idx = lat_hist_bucket(ns) + 1U; idx < LAT_HIST_BUCKETS; ++idx) {
+        above += hist->bucket[idx];
+    }
+    return above;
+}
+
+void lat_hist_format(const lat_hist_t *hist, char *buf, size_t len)
+{
+    snprintf(buf, len, "n %" PRIu64 ", min/p50/p99/p99.9/max %.1f/%.1f/%.1f/%.1f/%.1f us", hist->count,
+        (double)lat_hist_quantile(hist, 0.0) / 1000.0, (double)lat_hist_quantile(hist, 0.5) / 1000.0,
+        (double)lat_hist_quantile(hist, 0.99) / 1000.0, (double)lat_hist_quantile(hist, 0.999) / 1000.0,
+        (double)hist->max_ns / 1000.0);
+}
+
+void lat_recorder_reset(lat_recorder_t *rec)
+{
+    uint32_t idx;
+
+    for (idx = 0U; idx < LAT_HIST_BUCKETS; ++idx) {
+        atomic_store_explicit(&rec->bucket[idx], 0U, memory_order_relaxed);
+    }
+    atomic_store_explicit(&rec->count, 0U, memory_order_relaxed);
+    atomic_store_explicit(&rec->sum_ns, 0U, memory_order_relaxed);
+    atomic_store_explicit(&rec->min_ns, UINT64_MAX, memory_order_relaxed);
+    atomic_store_explicit(&rec->max_ns, 0U, memory_order_relaxed);
+}
+
+void lat_recorder_snapshot(const lat_recorder_t *rec, lat_hist_t *out)
+{
+    uint64_t total = 0U;
+    uint32_t idx;
+
+    for (idx = 0U; idx < LAT_HIST_BUCKETS; ++idx) {
+        out->bucket[idx] = atomic_load_explicit(&rec->bucket[idx], memory_order_relaxed);
+        total += out->bucket[idx];
+    }
+    /* Buckets are the ground truth; count follows them so quantiles stay in range. */
+    out->count = total;
+    out->sum_ns = atomic_load_explicit(&rec->sum_ns, memory_order_relaxed);
+    out->min_ns = atomic_load_explicit(&rec->min_ns, memory_order_relaxed);
+    out->max_ns = atomic_load_explicit(&rec->max_ns, memory_order_relaxed);
+}
@@ -0,0 +1,450 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Miguel Dovale (University of Arizona)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/* syscall() needs _DEFAULT_SOURCE. */
+#define _DEFAULT_SOURCE
+
+#include "uring.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <sys/syscall.h>
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter) && defined(__NR_io_uring_register)
+#define URING_HAVE_ABI 1
+#endif
+#endif
+#endif
+
+#ifdef URING_HAVE_ABI
+
+#include <linux/io_uring.h>
+#include <stdatomic.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+struct uring {
+    int fd;
+    uint32_t entries;
+    uint32_t queued;            /* prepared, not yet submitted */
+    uint32_t inflight;          /* submitted, not yet reaped */
+
+    void *sq_map;
+    size_t sq_map_bytes;
+    void *cq_map;               /* == sq_map with IORING_FEAT_SINGLE_MMAP */
+    size_t cq_map_bytes;
+    struct io_uring_sqe *sqes;
+    size_t sqes_bytes;
+
+    _Atomic uint32_t *sq_head;
+    _Atomic uint32_t *sq_tail;
+    uint32_t sq_mask;
+    uint32_t *sq_array;
+    _Atomic uint32_t *cq_head;
+    _Atomic uint32_t *cq_tail;
+    uint32_t cq_mask;
+    struct io_uring_cqe *cqes;
+    uint32_t sq_local_tail;
+
+    const uint8_t *fixed_base;
+    size_t fixed_len;
+    uring_stats_t stats;
+};
+
+static int sys_setup(uint32_t entries, struct io_uring_params *params)
+{
+    return (int)syscall(__NR_io_uring_setup, entries, params);
+}
+
+static int sys_enter(int fd, uint32_t to_submit, uint32_t min_complete, uint32_t flags)
+{
+    return (int)syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, NULL, 0);
+}
+
+static int sys_register(int fd, uint32_t opcode, void *arg, uint32_t nr)
+{
+    return (int)syscall(__NR_io_uring_register, fd, opcode, arg, nr);
+}
+
+static bool op_supported(const struct io_uring_probe *probe, uint32_t op)
+{
+    return op <= probe->last_op && (probe->ops[op].flags & IO_URING_OP_SUPPORTED) != 0U;
+}
+
+int uring_probe(void)
+{
+    static const uint32_t k_ops[] = {IORING_OP_WRITE, IORING_OP_WRITE_FIXED, IORING_OP_SENDMSG};
+    struct io_uring_params params;
+    struct io_uring_probe *probe;
+    size_t probe_bytes = sizeof(*probe) + (256U * sizeof(struct io_uring_probe_op));
+    size_t idx;
+    int fd;
+    int rc = 0;
+
+    memset(&params, 0, sizeof(params));
+    fd = sys_setup(2U, &params);
+    if (fd < 0) {
+        return -1;
+    }
+    probe = calloc(1U, probe_bytes);
+    if (probe == NULL) {
+        (void)close(fd);
+        return -1;
+    }
+    /* IORING_REGISTER_PROBE itself is 5.6+, like IORING_OP_WRITE. */
+    if (sys_register(fd, IORING_REGISTER_PROBE, probe, 256U) != 0) {
+        rc = -1;
+    }
+    for (idx = 0U; rc == 0 && idx < sizeof(k_ops) / sizeof(k_ops[0]); ++idx) {
+        if (!op_supported(probe, k_ops[idx])) {
+            errno = EOPNOTSUPP;
+            rc = -1;
+        }
+    }
+    if (rc == 0 && (params.features & IORING_FEAT_NODROP) == 0U) {
+        errno = EOPNOTSUPP;
+        rc = -1;
+    }
+    free(probe);
+    (void)close(fd);
+    return rc;
+}
+
+int uring_create(uring_t **out, uint32_t entries)
+{
+    struct io_uring_params params;
+    uring_t *ring;
+    uint8_t *sq;
+    uint8_t *cq;
+    int saved;
+
+    if (out == NULL || entries == 0U || entries > 4096U) {
+        errno = EINVAL;
+        return -1;
+    }
+    *out = NULL;
+    if (uring_probe() != 0) {
+        return -1;
+    }
+    ring = calloc(1U, sizeof(*ring));
+    if (ring == NULL) {
+        return -1;
+    }
+    ring->sq_map = MAP_FAILED;
+    ring->cq_map = MAP_FAILED;
+    ring->sqes = MAP_FAILED;
+
+    memset(&params, 0, sizeof(params));
+    ring->fd = sys_setup(entries, &params);
+    if (ring->fd < 0) {
+        goto fail;
+    }
+    ring->entries = params.sq_entries;
+
+    ring->sq_map_bytes = params.sq_off.array + (params.sq_entries * sizeof(uint32_t));
+    ring->cq_map_bytes = params.cq_off.cqes + (params.cq_entries * sizeof(struct io_uring_cqe));
+    if ((params.features & IORING_FEAT_SINGLE_MMAP) != 0U && ring->cq_map_bytes > ring->sq_map_bytes) {
+        ring->sq_map_bytes = ring->cq_map_bytes;
+    }
+    ring->sq_map = mmap(NULL, ring->sq_map_bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd,
+        IORING_OFF_SQ_RING);
+    if (ring->sq_map == MAP_FAILED) {
+        goto fail;
+    }
+    if ((params.features & IORING_FEAT_SINGLE_MMAP) != 0U) {
+        ring->cq_map = ring->sq_map;
+    } else {
+        ring->cq_map = mmap(NULL, ring->cq_map_bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd,
+            IORING_OFF_CQ_RING);
+        if (ring->cq_map == MAP_FAILED) {
+            goto fail;
+        }
+    }
+    ring->sqes_bytes = params.sq_entries * sizeof(struct io_uring_sqe);
+    ring->sqes = mmap(NULL, ring->sqes_bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd,
+        IORING_OFF_SQES);
+    if (ring->sqes == MAP_FAILED) {
+        goto fail;
+    }
+
+    sq = ring->sq_map;
+    cq = ring->cq_map;
+    ring->sq_head = (_Atomic uint32_t *)(void *)(sq + params.sq_off.head);
+    ring->sq_tail = (_Atomic uint32_t *)(void *)(sq + params.sq_off.tail);
+    ring->sq_mask = *(uint32_t *)(void *)(sq + params.sq_off.ring_mask);
+    ring->sq_array = (uint32_t *)(void *)(sq + params.sq_off.array);
+    ring->cq_head = (_Atomic uint32_t *)(void *)(cq + params.cq_off.head);
+    ring->cq_tail = (_Atomic uint32_t *)(void *)(cq + params.cq_off.tail);
+    ring->cq_mask = *(uint32_t *)(void *)(cq + params.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe *)(void *)(cq + params.cq_off.cqes);
+    ring->sq_local_tail = atomic_load_explicit(ring->sq_tail, memory_order_relaxed);
+
+    *out = ring;
+    return 0;
+
+fail:
+    saved = errno;
+    uring_destroy(ring);
+    errno = saved;
+    return -1;
+}
+
+int uring_register_buffer(uring_t *ring, void *base, size_t len)
+{
+    struct iovec iov;
+
+    if (ring == NULL || base == NULL || len == 0U || ring->fixed_base != NULL) {
+        errno = EINVAL;
+        return -1;
+    }
+    iov.iov_base = base;
+    iov.iov_len = len;
+    if (sys_register(ring->fd, IORING_REGISTER_BUFFERS, &iov, 1U) != 0) {
+        return -1;
+    }
+    ring->fixed_base = base;
+    ring->fixed_len = len;
+    return 0;
+}
+
+static struct io_uring_sqe *next_sqe(uring_t *ring)
+{
+    struct io_uring_sqe *sqe;
+    uint32_t idx;
+
+    if (ring->queued + ring->inflight >= ring->entries) {
+        errno = EBUSY;
+        return NULL;
+    }
+    idx = ring->sq_local_tail & ring->sq_mask;
+    sqe = &ring->sqes[idx];
+    memset(sqe, 0, sizeof(*sqe));
+    ring->sq_array[idx] = idx;
+    ++ring->sq_local_tail;
+    ++ring->queued;
+    return sqe;
+}
+
+int uring_prep_write(uring_t *ring, int fd, const void *buf, size_t len, uint64_t offset, uint64_t user_data)
+{
+    struct io_uring_sqe *sqe = next_sqe(ring);
+    const uint8_t *p = buf;
+
+    if (sqe == NULL) {
+        return -1;
+    }
+    sqe->fd = fd;
+    sqe->off = offset;
+    sqe->addr = (uint64_t)(uintptr_t)buf;
+    sqe->len = (uint32_t)len;
+    sqe->user_data = user_data;
+    if (ring->fixed_base != NULL && p >= ring->fixed_base && len <= ring->fixed_len &&
+        (size_t)(p - ring->fixed_base) <= ring->fixed_len - len) {
+        sqe->opcode = IORING_OP_WRITE_FIXED;
+        sqe->buf_index = 0U;
+        ++ring->stats.fixed_writes;
+    } else {
+        sqe->opcode = IORING_OP_WRITE;
+    }
+    return 0;
+}
+
+int uring_prep_sendmsg(uring_t *ring, int fd, const struct msghdr *mh, int flags, uint64_t user_data)
+{
+    struct io_uring_sqe *sqe = next_sqe(ring);
+
+    if (sqe == NULL) {
+        return -1;
+    }
+    sqe->opcode = IORING_OP_SENDMSG;
+    sqe->fd = fd;
+    sqe->addr = (uint64_t)(uintptr_t)mh;
+    sqe->len = 1U;
+    sqe->msg_flags = (uint32_t)flags;
+    sqe->user_data = user_data;
+    return 0;
+}
+
+static uint32_t cq_ready(const uring_t *ring)
+{
+    return atomic_load_explicit(ring->cq_tail, memory_order_acquire) -
+        atomic_load_explicit(ring->cq_head, memory_order_relaxed);
+}
+
+int uring_submit_wait(uring_t *ring, uint32_t wait_nr)
+{
+    atomic_store_explicit(ring->sq_tail, ring->sq_local_tail, memory_order_release);
+    /* A signal can end the wait early, or the kernel can take fewer requests: go again. */
+    while (ring->queued != 0U || cq_ready(ring) < wait_nr) {
+        int rc = sys_enter(ring->fd, ring->queued, wait_nr, (wait_nr != 0U) ? IORING_ENTER_GETEVENTS : 0U);
+
+        ++ring->stats.enters;
+        if (rc < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        ring->queued -= (uint32_t)rc;
+        ring->inflight += (uint32_t)rc;
+        ring->stats.sqes += (uint64_t)rc;
+    }
+    return 0;
+}
+
+size_t uring_reap(uring_t *ring, uring_cqe_t *out, size_t max)
+{
+    uint32_t head = atomic_load_explicit(ring->cq_head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(ring->cq_tail, memory_order_acquire);
+    size_t n = 0U;
+
+    while (head != tail && n < max) {
+        const struct io_uring_cqe *cqe = &ring->cqes[head & ring->cq_mask];
+
+        out[n].user_data = cqe->user_data;
+        out[n].res = cqe->res;
+        ++n;
+        ++head;
+    }
+    atomic_store_explicit(ring->cq_head, head, memory_order_release);
+    ring->inflight -= (uint32_t)n;
+    return n;
+}
+
+void uring_get_stats(const uring_t *ring, uring_stats_t *out)
+{
+    *out = ring->stats;
+}
+
+void uring_destroy(uring_t *ring)
+{
+    if (ring == NULL) {
+        return;
+    }
+    if (ring->sqes != MAP_FAILED) {
+        munmap(ring->sqes, ring->sqes_bytes);
+    }
+    if (ring->cq_map != MAP_FAILED && ring->cq_map != ring->sq_map) {
+        munmap(ring->cq_map, ring->cq_map_bytes);
+    }
+    if (ring->sq_map != MAP_FAILED) {
+        munmap(ring->sq_map, ring->sq_map_bytes);
+    }
+    if (ring->fd >= 0) {
+        (void)close(ring->fd);
+    }
+    free(ring);
+}
+
+#else /* !URING_HAVE_ABI */
+
+/* Built without the io_uring ABI headers: every caller takes its plain path. */
+int uring_probe(void)
+{
+    errno = ENOSYS;
+    return -1;
+}
+
+int uring_create(uring_t **out, uint32_t entries)
+{
+    (void)entries;
+    if (out != NULL) {
+        *out = NULL;
+    }
+    errno = ENOSYS;
+    return -1;
+}
+
+int uring_register_buffer(uring_t *ring, void *base, size_t len)
+{
+    (void)ring;
+    (void)base;
+    (void)len;
+    errno = ENOSYS;
+    return -1;
+}
+
+int uring_prep_write(uring_t *ring, int fd, const void *buf, size_t len, uint64_t offset, uint64_t user_data)
+{
+    (void)ring;
+    (void)fd;
+    (void)buf;
+    (void)len;
+    (void)offset;
+    (void)user_data;
+    errno = ENOSYS;
+    return -1;
+}
+
+int uring_prep_sendmsg(uring_t *ring, int fd, const struct msghdr *mh, int flags, uint64_t user_data)
+{
+    (void)ring;
+    (void)fd;
+    (void)mh;
+    (void)flags;
+    (void)user_data;
+    errno = ENOSYS;
+    return -1;
+}
+
+int uring_submit_wait(uring_t *ring, uint32_t wait_nr)
+{
+    (void)ring;
+    (void)wait_nr;
+    errno = ENOSYS;
+    return -1;
+}
+
+size_t uring_reap(uring_t *ring, uring_cqe_t *out, size_t max)
+{
+    (void)ring;
+    (void)out;
+    (void)max;
+    return 0U;
+}
+
+void uring_get_stats(const uring_t *ring, uring_stats_t *out)
+{
+    (void)ring;
+    memset(out, 0, sizeof(*out));
+}
+
+void uring_destroy(uring_t *ring)
+{
+    (void)ring;
+}
+
+#endif /* URING_HAVE_ABI */
@@ -0,0 +1,293 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Miguel Dovale (University of Arizona)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * SPSC frame ring and the acquisition thread on the sim backend: a full ring
+ * drops and counts instead of blocking, and every frame drained keeps the
+ * seq of the ramp's conversion index, also when a sleeping DRDY source makes
+ * missed conversions skip seq; independent devices on their own threads
+ * never see each other's frames.
+ */
+
+#include "acq.h"
+#include "test_util.h"
+
+#include <pthread.h>
+
+#define TEST_ACQ_RING_FRAMES 65536U
+#define TEST_ACQ_BATCH 256U
+#define TEST_ACQ_FRAMES 200000U
+#define TEST_ACQ_SECONDS 0.2
+#define TEST_ACQ_SMALL_RING 8U
+#define TEST_ACQ_DEVICES 4U
+#define TEST_ACQ_DEVICE_FRAMES 200000U
+
+typedef struct {
+    acq_t *acq;
+    uint64_t drained;
+    uint64_t bad;               /* frames whose seq does not match their ramp index */
+} drain_t;
+
+/* Drain until the acquisition ends, checking every frame's seq against its ramp sample. */
+static void *drain_main(void *arg)
+{
+    drain_t *d = arg;
+    ads1278_frame_t batch[TEST_ACQ_BATCH];
+    uint32_t index_offset = 0U;
+
+    for (;;) {
+        bool finished = acq_is_done(d->acq);
+        size_t n = acq_drain(d->acq, batch, TEST_ACQ_BATCH, 100U);
+        size_t idx;
+
+        if (n == 0U && finished) {
+            break;
+        }
+        for (idx = 0U; idx < n; ++idx) {
+            uint32_t offset = (sim_ramp_index(&batch[idx]) - (uint32_t)batch[idx].seq) & 0xFFFFFFU;
+
+            if (d->drained + idx == 0U) {
+                index_offset = offset;
+            } else if (offset != index_offset) {
+                ++d->bad;
+            }
+        }
+        d->drained += n;
+    }
+    return NULL;
+}
+
+/* Fill a small ring past capacity, then read it back across the wrap point. */
+static int test_ring(void)
+{
+    acq_ring_t ring;
+    acq_ring_counters_t counters;
+    ads1278_frame_t frame;
+    ads1278_frame_t out[TEST_ACQ_SMALL_RING];
+    const ads1278_frame_t *span;
+    uint64_t seq;
+    size_t n;
+    size_t idx;
+    int rc = -1;
+
+    if (acq_ring_init(&ring, TEST_ACQ_SMALL_RING) != 0) {
+        perror("acq_ring_init");
+        return -1;
+    }
+    memset(&frame, 0, sizeof(frame));
+    for (seq = 0U; seq < TEST_ACQ_SMALL_RING + 3U; ++seq) {
+        frame.seq = seq;
+        if (acq_ring_push(&ring, &frame, 0U) != (seq < TEST_ACQ_SMALL_RING)) {
+            fprintf(stderr, "ring: push of seq %" PRIu64 " into %u slots\n", seq, TEST_ACQ_SMALL_RING);
+            goto out;
+        }
+    }
+    /* Retire 5, push 5 more so the readable span wraps. */
+    n = acq_ring_pop_batch(&ring, out, 5U);
+    for (idx = 0U; idx < 5U; ++idx) {
+        frame.seq = TEST_ACQ_SMALL_RING + idx;
+        if (!acq_ring_push(&ring, &frame, 0U)) {
+            fprintf(stderr, "ring: push after pop failed\n");
+            goto out;
+        }
+    }
+    for (idx = 0U; idx < n; ++idx) {
+        if (out[idx].seq != idx) {
+            fprintf(stderr, "ring: popped seq %" PRIu64 " at %zu\n", out[idx].seq, idx);
+            goto out;
+        }
+    }
+    seq = n;
+    while ((n = acq_ring_peek(&ring, &span, TEST_ACQ_SMALL_RING)) != 0U) {
+        for (idx = 0U; idx < n; ++idx, ++seq) {
+            if (span[idx].seq != seq) {
+                fprintf(stderr, "ring: peeked seq %" PRIu64 ", expected %" PRIu64 "\n", span[idx].seq, seq);
+                goto out;
+            }
+        }
+        acq_ring_release(&ring, n);
+    }
+    acq_ring_get_counters(&ring, &counters);
+    if (seq != TEST_ACQ_SMALL_RING + 5U || counters.occupancy != 0U || counters.overflows != 3U ||
+        counters.pushed != TEST_ACQ_SMALL_RING + 5U || counters.high_water != TEST_ACQ_SMALL_RING) {
+        fprintf(stderr, "ring: read up to seq %" PRIu64 ", %" PRIu64 " pushed, %" PRIu64 " overflow(s), "
+            "high-water %" PRIu64 ", %" PRIu64 " left\n", seq, counters.pushed, counters.overflows,
+            counters.high_water, counters.occupancy);
+        goto out;
+    }
+    rc = 0;
+
+out:
+    acq_ring_destroy(&ring);
+    return rc;
+}
+
+/* Sim DRDY at rate_hz (0 = free-running) for `frames` frames through the acquisition thread. */
+static int acq_run(uint32_t rate_hz, uint64_t frames)
+{
+    ads1278_cfg_t cfg = {0};
+    acq_cfg_t acq_cfg = {0};
+    drain_t d;
+    int rc = -1;
+
+    memset(&d, 0, sizeof(d));
+    cfg.backend = ADS1278_BACKEND_SIM;
+    cfg.sim.drdy_rate_hz = rate_hz;
+    cfg.sim.signal = ADS1278_SIM_SIGNAL_RAMP;
+    if (ads1278_open(&cfg) != 0 || ads1278_start() != 0) {
+        perror("ads1278_open/start");
+        ads1278_close();
+        return -1;
+    }
+    acq_cfg.ring_capacity = TEST_ACQ_RING_FRAMES;
+    acq_cfg.max_frames = frames;
+    if (acq_create(&d.acq, &acq_cfg) != 0 || acq_start(d.acq) != 0) {
+        perror("acq_create/start");
+        goto out;
+    }
+    (void)drain_main(&d);
+    acq_stop(d.acq);
+    if (acq_get_error(d.acq) != 0 || d.drained != frames || d.bad != 0U) {
+        fprintf(stderr, "sim %u Hz: %" PRIu64 " of %" PRIu64 " frames, %" PRIu64 " off the conversion index, "
+            "error %d\n", rate_hz, d.drained, frames, d.bad, acq_get_error(d.acq));
+        goto out;
+    }
+    rc = 0;
+
+out:
+    acq_destroy(d.acq);
+    ads1278_stop();
+    ads1278_close();
+    return rc;
+}
+
+static int test_free_running(void)
+{
+    return acq_run(0U, TEST_ACQ_FRAMES);
+}
+
+static int test_drdy_rates(void)
+{
+    static const uint32_t rates[] = {8000U, 52734U};
+    size_t idx;
+
+    for (idx = 0U; idx < sizeof(rates) / sizeof(rates[0]); ++idx) {
+        if (acq_run(rates[idx], (uint64_t)((double)rates[idx] * TEST_ACQ_SECONDS)) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/* Free-running sim devices through handles, one acquisition and one consumer thread each. */
+static int test_multi_device(void)
+{
+    ads1278_dev_t *devs[TEST_ACQ_DEVICES];
+    drain_t drains[TEST_ACQ_DEVICES];
+    pthread_t consumers[TEST_ACQ_DEVICES];
+    bool started[TEST_ACQ_DEVICES];
+    uint32_t idx;
+    int rc = -1;
+
+    memset(devs, 0, sizeof(devs));
+    memset(drains, 0, sizeof(drains));
+    memset(started, 0, sizeof(started));
+    for (idx = 0U; idx < TEST_ACQ_DEVICES; ++idx) {
+        ads1278_cfg_t cfg = {0};
+        acq_cfg_t acq_cfg = {0};
+
+        cfg.backend = ADS1278_BACKEND_SIM;
+        cfg.sim.drdy_rate_hz = 0U;
+        cfg.sim.signal = ADS1278_SIM_SIGNAL_RAMP;
+        if (ads1278_dev_open(&devs[idx], &cfg) != 0 || ads1278_dev_start(devs[idx]) != 0) {
+            perror("ads1278_dev_open/start");
+            goto out;
+        }
+        acq_cfg.dev = devs[idx];
+        acq_cfg.ring_capacity = TEST_ACQ_RING_FRAMES;
+        acq_cfg.max_frames = TEST_ACQ_DEVICE_FRAMES;
+        if (acq_create(&drains[idx].acq, &acq_cfg) != 0) {
+            perror("acq_create");
+            goto out;
+        }
+    }
+    for (idx = 0U; idx < TEST_ACQ_DEVICES; ++idx) {
+        if (acq_start(drains[idx].acq) != 0 || pthread_create(&consumers[idx], NULL, drain_main, &drains[idx]) != 0) {
+            perror("acq_start/consumer");
+            goto out;
+        }
+        started[idx] = true;
+    }
+    for (idx = 0U; idx < TEST_ACQ_DEVICES; ++idx) {
+        (void)pthread_join(consumers[idx], NULL);
+        started[idx] = false;
+    }
+    for (idx = 0U; idx < TEST_ACQ_DEVICES; ++idx) {
+        acq_stats_t stats;
+
+        acq_stop(drains[idx].acq);
+        acq_get_stats(drains[idx].acq, &stats);
+        if (acq_get_error(drains[idx].acq) != 0 || stats.frames_read != TEST_ACQ_DEVICE_FRAMES ||
+            drains[idx].bad != 0U) {
+            fprintf(stderr, "multi: device %u read %" PRIu64 " of %u frames, %" PRIu64 " off its own ramp, "
+                "error %d\n", idx, stats.frames_read, TEST_ACQ_DEVICE_FRAMES, drains[idx].bad,
+                acq_get_error(drains[idx].acq));
+            goto out;
+        }
+    }
+    rc = 0;
+
+out:
+    for (idx = 0U; idx < TEST_ACQ_DEVICES; ++idx) {
+        if (drains[idx].acq != NULL) {
+            acq_stop(drains[idx].acq);
+        }
+        if (started[idx]) {
+            (void)pthread_join(consumers[idx], NULL);
+        }
+        acq_destroy(drains[idx].acq);
+        ads1278_dev_stop(devs[idx]);
+        ads1278_dev_close(devs[idx]);
+    }
+    return rc;
+}
+
+int main(void)
+{
+    static const test_case_t cases[] = {
+        {"full ring drops, peek stops at the wrap", test_ring},
+        {"seq tracks the conversion index", test_free_running},
+        {"sleeping DRDY at 8 and 52.7 kHz", test_drdy_rates},
+        {"independent devices", test_multi_device}
+    };
+
+    return test_run("acq", cases, sizeof(cases) / sizeof(cases[0]));
+}
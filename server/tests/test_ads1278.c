@@ -0,0 +1,296 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Miguel Dovale (University of Arizona)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * HAL read paths on the sim backend: frames and pooled channel-major blocks
+ * carry the ramp of their conversion index, through the process-wide device
+ * and through handles at every chain length, and conversions a slow reader
+ * skips are counted as missed DRDY edges.
+ */
+
+#include "test_util.h"
+
+#define TEST_ADS1278_FRAMES 4096U
+#define TEST_ADS1278_BLOCK_FRAMES 256U
+#define TEST_ADS1278_DRDY_HZ 20000U
+#define TEST_ADS1278_NAP_EVERY 256U
+#define TEST_ADS1278_NAP_NS 1000000ULL
+#define TEST_ADS1278_START_DELAY_NS 50000000ULL
+
+/* Every channel of a sim frame is on the ramp of the frame's conversion index. */
+static bool ramp_frame_ok(const ads1278_frame_t *frame, uint32_t channels)
+{
+    uint32_t index = sim_ramp_index(frame);
+    uint32_t channel;
+
+    for (channel = 0U; channel < channels; ++channel) {
+        if (frame->ch[channel] != sim_ramp_value(index, channel)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Every sample of a block against the ramp, and the channel count it claims. */
+static uint64_t ramp_block_errors(const ads1278_block_t *blk, uint32_t channels)
+{
+    uint64_t bad = (blk->channel_count == channels) ? 0U : 1U;
+    size_t idx;
+    uint32_t channel;
+
+    for (idx = 0U; idx < blk->count; ++idx) {
+        uint32_t index = (uint32_t)blk->ch[0][idx] & 0xFFFFFFU;
+
+        for (channel = 0U; channel < channels; ++channel) {
+            bad += (blk->ch[channel][idx] == sim_ramp_value(index, channel)) ? 0U : 1U;
+        }
+    }
+    return bad;
+}
+
+static int test_read_frame(void)
+{
+    uint64_t done;
+    uint64_t prev_seq = 0U;
+    int rc = -1;
+
+    if (open_free_running_sim() != 0) {
+        return -1;
+    }
+    for (done = 0U; done < TEST_ADS1278_FRAMES; ++done) {
+        ads1278_frame_t frame;
+
+        if (ads1278_read_frame(&frame) != 0) {
+            perror("ads1278_read_frame");
+            goto out;
+        }
+        if (!ramp_frame_ok(&frame, ADS1278_CHANNEL_COUNT) || (done != 0U && frame.seq <= prev_seq)) {
+            fprintf(stderr, "read_frame: seq %" PRIu64 " off the ramp\n", frame.seq);
+            goto out;
+        }
+        prev_seq = frame.seq;
+    }
+    rc = 0;
+
+out:
+    ads1278_stop();
+    ads1278_close();
+    return rc;
+}
+
+/* Blocks of every size up to the pool's, plus the ramp of each block's seq. */
+static int test_read_frames(void)
+{
+    ads1278_block_pool_t *pool = NULL;
+    ads1278_block_t *blk = NULL;
+    size_t n;
+    int rc = -1;
+
+    if (ads1278_block_pool_create(&pool, 2U, TEST_ADS1278_BLOCK_FRAMES) != 0) {
+        perror("ads1278_block_pool_create");
+        return -1;
+    }
+    blk = ads1278_block_acquire(pool);
+    if (blk == NULL || open_free_running_sim() != 0) {
+        goto out;
+    }
+    for (n = 1U; n <= TEST_ADS1278_BLOCK_FRAMES; ++n) {
+        size_t idx;
+        uint32_t channel;
+
+        if (ads1278_read_frames(blk, n) != 0 || blk->count != n) {
+            fprintf(stderr, "read_frames: %zu frame(s) gave %zu\n", n, blk->count);
+            goto out;
+        }
+        for (channel = 0U; channel < ADS1278_CHANNEL_COUNT; ++channel) {
+            for (idx = 0U; idx < blk->count; ++idx) {
+                if (blk->ch[channel][idx] != sim_ramp_value(blk->seq0 + idx, channel)) {
+                    fprintf(stderr, "read_frames mismatch: seq %" PRIu64 " ch%u\n", blk->seq0 + idx, channel + 1U);
+                    goto out;
+                }
+            }
+        }
+    }
+    rc = 0;
+
+out:
+    ads1278_stop();
+    ads1278_close();
+    if (blk != NULL) {
+        ads1278_block_release(pool, blk);
+    }
+    ads1278_block_pool_destroy(pool);
+    return rc;
+}
+
+/*
+ * A sleeping 20 kHz sim DRDY read with 1 ms naps: every skipped conversion is
+ * a missed edge, and the 50 ms between open and start counts as none.
+ */
+static int test_missed_drdy(void)
+{
+    ads1278_cfg_t cfg = {0};
+    ads1278_frame_t frame;
+    uint64_t missed_before = 0U;
+    uint64_t missed;
+    uint32_t first_index = 0U;
+    uint32_t skipped;
+    uint64_t done;
+    int rc = -1;
+
+    cfg.backend = ADS1278_BACKEND_SIM;
+    cfg.sim.drdy_rate_hz = TEST_ADS1278_DRDY_HZ;
+    cfg.sim.signal = ADS1278_SIM_SIGNAL_RAMP;
+    if (ads1278_open(&cfg) != 0) {
+        perror("ads1278_open");
+        return -1;
+    }
+    nap_ns(TEST_ADS1278_START_DELAY_NS);
+    if (ads1278_start() != 0) {
+        perror("ads1278_start");
+        ads1278_close();
+        return -1;
+    }
+    for (done = 0U; done < TEST_ADS1278_FRAMES; ++done) {
+        if (ads1278_read_frame(&frame) != 0) {
+            perror("ads1278_read_frame");
+            goto out;
+        }
+        if (done == 0U) {
+            first_index = sim_ramp_index(&frame);
+            missed_before = ads1278_get_missed_drdy();
+            if (missed_before != 0U) {
+                fprintf(stderr, "missed DRDY: %" PRIu64 " edge(s) before start counted\n", missed_before);
+                goto out;
+            }
+        }
+        if (done % TEST_ADS1278_NAP_EVERY == TEST_ADS1278_NAP_EVERY - 1U) {
+            nap_ns(TEST_ADS1278_NAP_NS);
+        }
+    }
+    missed = ads1278_get_missed_drdy() - missed_before;
+    skipped = ((sim_ramp_index(&frame) - first_index) & 0xFFFFFFU) + 1U - TEST_ADS1278_FRAMES;
+    if (missed != skipped || skipped == 0U) {
+        fprintf(stderr, "missed DRDY: %" PRIu64 " counted, %u conversion(s) skipped\n", missed, skipped);
+        goto out;
+    }
+    rc = 0;
+
+out:
+    ads1278_stop();
+    ads1278_close();
+    return rc;
+}
+
+/* One chain length through a handle: both read paths on every device's ramp. */
+static int chain_run(uint32_t chain)
+{
+    ads1278_cfg_t cfg = {0};
+    ads1278_dev_t *dev = NULL;
+    ads1278_block_pool_t *pool = NULL;
+    ads1278_block_t *blk = NULL;
+    uint32_t channels = chain * ADS1278_CHANNEL_COUNT;
+    uint64_t bad = 0U;
+    uint64_t done;
+    int rc = -1;
+
+    cfg.backend = ADS1278_BACKEND_SIM;
+    cfg.sim.drdy_rate_hz = 0U;
+    cfg.sim.signal = ADS1278_SIM_SIGNAL_RAMP;
+    cfg.chain_length = chain;
+    if (ads1278_block_pool_create(&pool, 1U, TEST_ADS1278_BLOCK_FRAMES) != 0) {
+        perror("ads1278_block_pool_create");
+        goto out;
+    }
+    blk = ads1278_block_acquire(pool);
+    if (ads1278_dev_open(&dev, &cfg) != 0 || ads1278_dev_start(dev) != 0) {
+        perror("ads1278_dev_open/start");
+        goto out;
+    }
+    if (ads1278_dev_channel_count(dev) != channels) {
+        fprintf(stderr, "chain %u: device reports %u channel(s)\n", chain, ads1278_dev_channel_count(dev));
+        goto out;
+    }
+    for (done = 0U; done < TEST_ADS1278_FRAMES; ++done) {
+        ads1278_frame_t frame;
+
+        if (ads1278_dev_read_frame(dev, &frame) != 0) {
+            perror("ads1278_dev_read_frame");
+            goto out;
+        }
+        bad += ramp_frame_ok(&frame, channels) ? 0U : 1U;
+    }
+    for (done = 0U; done < TEST_ADS1278_FRAMES; done += blk->count) {
+        if (ads1278_dev_read_frames(dev, blk, TEST_ADS1278_BLOCK_FRAMES) != 0) {
+            perror("ads1278_dev_read_frames");
+            goto out;
+        }
+        bad += ramp_block_errors(blk, channels);
+    }
+    if (bad != 0U) {
+        fprintf(stderr, "chain %u: %" PRIu64 " sample(s) off the ramp\n", chain, bad);
+        goto out;
+    }
+    rc = 0;
+
+out:
+    ads1278_dev_stop(dev);
+    ads1278_dev_close(dev);
+    if (blk != NULL) {
+        ads1278_block_release(pool, blk);
+    }
+    ads1278_block_pool_destroy(pool);
+    return rc;
+}
+
+static int test_chain(void)
+{
+    uint32_t chain;
+
+    for (chain = 1U; chain <= ADS1278_MAX_CHAIN; ++chain) {
+        if (chain_run(chain) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int main(void)
+{
+    static const test_case_t cases[] = {
+        {"read_frame on the ramp", test_read_frame},
+        {"read_frames blocks of 1..256", test_read_frames},
+        {"missed DRDY edges at 20 kHz", test_missed_drdy},
+        {"handles at every chain length", test_chain}
+    };
+
+    return test_run("ads1278", cases, sizeof(cases) / sizeof(cases[0]));
+}
@@ -0,0 +1,406 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Miguel Dovale (University of Arizona)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Capture files: v1 records through the buffered writer (pwrite() and
+ * io_uring) byte for byte, v2 files in every chunk encoding read back with
+ * their index, seq gap counts and time seeks, and chained channel counts.
+ */
+
+#include "capture_file.h"
+#include "proto.h"
+#include "test_util.h"
+
+#include <unistd.h>
+
+#define TEST_CAPTURE_FRAMES 100000U
+#define TEST_CAPTURE_BATCH 256U
+#define TEST_CAPTURE_GAP_EVERY 100U
+#define TEST_CAPTURE_SEEKS 2000U
+
+/* Seq of the k-th written frame when one conversion in every gap_every + 1 is missed (0 = none). */
+static uint64_t gapped_seq(uint64_t k, uint32_t gap_every)
+{
+    return (gap_every == 0U) ? k : k + (k / gap_every);
+}
+
+static int make_temp_path(char *path)
+{
+    int fd = mkstemp(path);
+
+    if (fd < 0) {
+        perror("mkstemp");
+        return -1;
+    }
+    (void)close(fd);
+    return 0;
+}
+
+/* Re-read a v1 capture and check every record against the synthetic source. */
+static int verify_v1_file(const char *path, uint64_t frames)
+{
+    FILE *in_file = fopen(path, "rb");
+    uint64_t seq;
+    int rc = 0;
+
+    if (in_file == NULL) {
+        perror("fopen");
+        return -1;
+    }
+    for (seq = 0U; seq < frames && rc == 0; ++seq) {
+        uint8_t got[CAPTURE_RECORD_V1_BYTES];
+        uint8_t want[CAPTURE_RECORD_V1_BYTES];
+        ads1278_frame_t frame;
+        uint32_t idx;
+
+        fill_synthetic_frame(&frame, seq);
+        for (idx = 0U; idx < 8U; ++idx) {
+            want[idx] = (uint8_t)(frame.seq >> (idx * 8U));
+            want[8U + idx] = (uint8_t)(frame.tstamp_ns >> (idx * 8U));
+        }
+        for (idx = 0U; idx < 32U; ++idx) {
+            want[16U + idx] = (uint8_t)((uint32_t)frame.ch[idx / 4U] >> ((idx % 4U) * 8U));
+        }
+        if (fread(got, 1U, sizeof(got), in_file) != sizeof(got) || memcmp(got, want, sizeof(got)) != 0) {
+            fprintf(stderr, "v1 capture mismatch at record %" PRIu64 "\n", seq);
+            rc = -1;
+        }
+    }
+    if (rc == 0 && fgetc(in_file) != EOF) {
+        fprintf(stderr, "v1 capture has trailing bytes\n");
+        rc = -1;
+    }
+    fclose(in_file);
+    return rc;
+}
+
+static int v1_writer_run(bool io_uring)
+{
+    char path[] = "/tmp/test_capture_XXXXXX";
+    ads1278_frame_t batch[TEST_CAPTURE_BATCH];
+    capture_writer_cfg_t cfg = {0};
+    capture_writer_t *writer = NULL;
+    capture_writer_stats_t stats = {0};
+    uint64_t done;
+    int rc = -1;
+
+    if (make_temp_path(path) != 0) {
+        return -1;
+    }
+    /* Small blocks so the background thread writes many of them. */
+    cfg.block_bytes = 64U * 1024U;
+    cfg.io_uring = io_uring;
+    if (capture_writer_open(&writer, path, &cfg) != 0) {
+        perror("capture_writer_open");
+        goto out;
+    }
+    for (done = 0U; done < TEST_CAPTURE_FRAMES;) {
+        size_t n = TEST_CAPTURE_BATCH;
+        size_t idx;
+
+        if (TEST_CAPTURE_FRAMES - done < n) {
+            n = (size_t)(TEST_CAPTURE_FRAMES - done);
+        }
+        for (idx = 0U; idx < n; ++idx) {
+            fill_synthetic_frame(&batch[idx], done + idx);
+        }
+        if (capture_writer_append_frames(writer, batch, n) != 0) {
+            perror("capture_writer_append_frames");
+            (void)capture_writer_close(writer, NULL);
+            goto out;
+        }
+        done += n;
+    }
+    if (capture_writer_close(writer, &stats) != 0) {
+        perror("capture_writer_close");
+        goto out;
+    }
+    if (stats.bytes_written != (uint64_t)TEST_CAPTURE_FRAMES * CAPTURE_RECORD_V1_BYTES) {
+        fprintf(stderr, "v1 capture: %" PRIu64 " byte(s) written\n", stats.bytes_written);
+        goto out;
+    }
+    rc = verify_v1_file(path, TEST_CAPTURE_FRAMES);
+
+out:
+    (void)unlink(path);
+    return rc;
+}
+
+static int test_v1_pwrite(void)
+{
+    return v1_writer_run(false);
+}
+
+/* Falls back to pwrite() where io_uring is unavailable; the file must match either way. */
+static int test_v1_io_uring(void)
+{
+    return v1_writer_run(true);
+}
+
+/* Read a v2 file back in full, then seek to random timestamps between frames. */
+static int verify_v2_file(const char *path, uint64_t frames, uint32_t gap_every)
+{
+    const capture_file_info_t *info;
+    capture_file_t *cf = NULL;
+    ads1278_frame_t got[TEST_CAPTURE_BATCH];
+    uint64_t rng = 0x9E3779B97F4A7C15ULL;
+    uint64_t gaps = (gap_every == 0U || frames == 0U) ? 0U : (frames - 1U) / gap_every;
+    uint64_t k = 0U;
+    uint32_t idx;
+    int rc = -1;
+
+    if (capture_file_open(&cf, path) != 0) {
+        perror("capture_file_open");
+        return -1;
+    }
+    info = capture_file_get_info(cf);
+    if (info->version != CAPTURE_FILE_VERSION || !info->indexed || info->frame_count != frames ||
+        info->gap_count != gaps || info->missed_frames != gaps) {
+        fprintf(stderr, "v2 capture: header v%u indexed %d, %" PRIu64 " frame(s), %" PRIu64 " gap(s), %" PRIu64
+            " missed\n", info->version, (int)info->indexed, info->frame_count, info->gap_count,
+            info->missed_frames);
+        goto out;
+    }
+    for (;;) {
+        long n = capture_file_read(cf, got, sizeof(got) / sizeof(got[0]));
+        long pos;
+
+        if (n < 0) {
+            perror("capture_file_read");
+            goto out;
+        }
+        if (n == 0) {
+            break;
+        }
+        for (pos = 0; pos < n; ++pos, ++k) {
+            ads1278_frame_t want;
+
+            fill_synthetic_frame(&want, gapped_seq(k, gap_every));
+            if (!frames_equal(&got[pos], &want, ADS1278_CHANNEL_COUNT)) {
+                fprintf(stderr, "v2 capture mismatch at frame %" PRIu64 "\n", k);
+                goto out;
+            }
+        }
+    }
+    if (k != frames) {
+        fprintf(stderr, "v2 capture: read %" PRIu64 " of %" PRIu64 " frame(s)\n", k, frames);
+        goto out;
+    }
+
+    for (idx = 0U; idx < TEST_CAPTURE_SEEKS; ++idx) {
+        /* Synthetic frames are 1 us per seq apart; aim between frame k - 1 and frame k. */
+        k = 1U + (xorshift64(&rng) % (frames - 1U));
+        if (capture_file_seek_time(cf, (gapped_seq(k, gap_every) * 1000ULL) - 500U) != 0 ||
+            capture_file_tell(cf) != k) {
+            fprintf(stderr, "v2 capture: seek to frame %" PRIu64 " failed\n", k);
+            goto out;
+        }
+        if (capture_file_read(cf, got, 1U) != 1 || got[0].seq != gapped_seq(k, gap_every)) {
+            fprintf(stderr, "v2 capture: read after a seek to frame %" PRIu64 " failed\n", k);
+            goto out;
+        }
+    }
+    if (capture_file_seek_time(cf, UINT64_MAX) != 0 || capture_file_tell(cf) != frames ||
+        capture_file_read(cf, got, 1U) != 0) {
+        fprintf(stderr, "v2 capture: seek past the end not at the end\n");
+        goto out;
+    }
+    rc = 0;
+
+out:
+    capture_file_close(cf);
+    return rc;
+}
+
+static int v2_run(uint16_t encoding, uint32_t gap_every)
+{
+    char path[] = "/tmp/test_capture_XXXXXX";
+    ads1278_frame_t batch[TEST_CAPTURE_BATCH];
+    capture_file_cfg_t cfg = {0};
+    capture_file_writer_t *cf = NULL;
+    uint64_t done;
+    int rc = -1;
+
+    if (make_temp_path(path) != 0) {
+        return -1;
+    }
+    cfg.encoding = encoding;
+    snprintf(cfg.acq.writer, sizeof(cfg.acq.writer), "test_capture_file");
+    if (capture_file_create(&cf, path, &cfg) != 0) {
+        perror("capture_file_create");
+        goto out;
+    }
+    for (done = 0U; done < TEST_CAPTURE_FRAMES;) {
+        size_t n = TEST_CAPTURE_BATCH;
+        size_t idx;
+
+        if (TEST_CAPTURE_FRAMES - done < n) {
+            n = (size_t)(TEST_CAPTURE_FRAMES - done);
+        }
+        for (idx = 0U; idx < n; ++idx) {
+            fill_synthetic_frame(&batch[idx], gapped_seq(done + idx, gap_every));
+        }
+        if (capture_file_append(cf, batch, n) != 0) {
+            perror("capture_file_append");
+            (void)capture_file_finish(cf, NULL, NULL);
+            goto out;
+        }
+        done += n;
+    }
+    if (capture_file_finish(cf, NULL, NULL) != 0) {
+        perror("capture_file_finish");
+        goto out;
+    }
+    rc = verify_v2_file(path, TEST_CAPTURE_FRAMES, gap_every);
+    if (rc != 0) {
+        fprintf(stderr, "v2 capture: %s%s failed\n", proto_data_encoding_name(encoding),
+            (gap_every != 0U) ? " gapped" : "");
+    }
+
+out:
+    (void)unlink(path);
+    return rc;
+}
+
+static int test_v2_encodings(void)
+{
+    static const uint16_t encodings[] = {PROTO_DATA_ENC_RECORD48, PROTO_DATA_ENC_P24, PROTO_DATA_ENC_DELTA};
+    size_t idx;
+
+    for (idx = 0U; idx < sizeof(encodings) / sizeof(encodings[0]); ++idx) {
+        if (v2_run(encodings[idx], 0U) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/* One conversion in every TEST_CAPTURE_GAP_EVERY + 1 missed. */
+static int test_v2_gaps(void)
+{
+    static const uint16_t encodings[] = {PROTO_DATA_ENC_RECORD48, PROTO_DATA_ENC_P24, PROTO_DATA_ENC_DELTA};
+    size_t idx;
+
+    for (idx = 0U; idx < sizeof(encodings) / sizeof(encodings[0]); ++idx) {
+        if (v2_run(encodings[idx], TEST_CAPTURE_GAP_EVERY) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/* Write frames with a chain's channel count and read them back. */
+static int chain_round_trip(const ads1278_frame_t *src, size_t n, uint32_t channels)
+{
+    char path[] = "/tmp/test_capture_XXXXXX";
+    capture_file_cfg_t cfg = {0};
+    capture_file_writer_t *writer = NULL;
+    capture_file_t *cf = NULL;
+    ads1278_frame_t got[TEST_CAPTURE_BATCH];
+    size_t done = 0U;
+    int rc = -1;
+
+    if (make_temp_path(path) != 0) {
+        return -1;
+    }
+    cfg.encoding = PROTO_DATA_ENC_DELTA;
+    cfg.chunk_frames = 1000U;
+    cfg.channel_count = (uint16_t)channels;
+    if (capture_file_create(&writer, path, &cfg) != 0 || capture_file_append(writer, src, n) != 0 ||
+        capture_file_finish(writer, NULL, NULL) != 0 || capture_file_open(&cf, path) != 0) {
+        perror("chain capture");
+        goto out;
+    }
+    if (capture_file_get_info(cf)->channel_count != channels) {
+        fprintf(stderr, "chain capture: header has %u channel(s), want %u\n",
+            (unsigned)capture_file_get_info(cf)->channel_count, channels);
+        goto out;
+    }
+    for (;;) {
+        long got_n = capture_file_read(cf, got, sizeof(got) / sizeof(got[0]));
+        long pos;
+
+        if (got_n <= 0) {
+            break;
+        }
+        for (pos = 0; pos < got_n; ++pos, ++done) {
+            if (done >= n || !frames_equal(&got[pos], &src[done], channels)) {
+                fprintf(stderr, "chain capture: %u channel(s) mismatch at frame %zu\n", channels, done);
+                goto out;
+            }
+        }
+    }
+    if (done != n) {
+        fprintf(stderr, "chain capture: read %zu of %zu frame(s)\n", done, n);
+        goto out;
+    }
+    rc = 0;
+
+out:
+    capture_file_close(cf);
+    (void)unlink(path);
+    return rc;
+}
+
+static int test_chain_channels(void)
+{
+    ads1278_frame_t *src = malloc(TEST_CAPTURE_FRAMES * sizeof(*src));
+    uint32_t channels;
+    size_t idx;
+    int rc = 0;
+
+    if (src == NULL) {
+        perror("malloc");
+        return -1;
+    }
+    for (idx = 0U; idx < TEST_CAPTURE_FRAMES; ++idx) {
+        fill_synthetic_frame(&src[idx], idx);
+    }
+    for (channels = ADS1278_CHANNEL_COUNT; channels <= ADS1278_MAX_CHANNELS && rc == 0;
+         channels += ADS1278_CHANNEL_COUNT) {
+        rc = chain_round_trip(src, TEST_CAPTURE_FRAMES, channels);
+    }
+    free(src);
+    return rc;
+}
+
+int main(void)
+{
+    static const test_case_t cases[] = {
+        {"v1 writer, pwrite()", test_v1_pwrite},
+        {"v1 writer, io_uring", test_v1_io_uring},
+        {"v2 read back and seek per encoding", test_v2_encodings},
+        {"v2 seq gaps per encoding", test_v2_gaps},
+        {"v2 chained channel counts", test_chain_channels}
+    };
+
+    return test_run("capture_file", cases, sizeof(cases) / sizeof(cases[0]));
+}
@@ -0,0 +1,372 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Miguel Dovale (University of Arizona)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Segmented recorder: size rotation under a quota, time rotation, a paced
+ * run, and a recorder killed mid-segment whose .part the next open recovers.
+ * Every kept segment is read back; frames must run on across segment
+ * boundaries with nothing missing.
+ */
+
+#include "capture_segments.h"
+#include "proto.h"
+#include "test_util.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <limits.h>
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define TEST_SEG_FRAMES 1000000U
+#define TEST_SEG_BATCH 256U
+#define TEST_SEG_PACED_FPS (8U * 52734U)    /* eight ADS1278s at full rate */
+#define TEST_SEG_CRASH_AFTER_NS 400000000ULL
+#define TEST_SEG_CRASH_MIN_FRAMES 100000U   /* 400 ms at TEST_SEG_PACED_FPS with 20 ms checkpoints */
+
+typedef struct {
+    uint32_t count;             /* segments on disk */
+    uint64_t first_seq;
+    uint64_t end_seq;           /* one past the last frame */
+} seg_readback_t;
+
+/* Remove a scratch directory and the files in it. */
+static void remove_dir(const char *dir)
+{
+    DIR *d = opendir(dir);
+    struct dirent *ent;
+
+    if (d != NULL) {
+        while ((ent = readdir(d)) != NULL) {
+            char path[PATH_MAX];
+
+            if (strcmp(ent->d_name, ".") != 0 && strcmp(ent->d_name, "..") != 0 &&
+                snprintf(path, sizeof(path), "%s/%s", dir, ent->d_name) < (int)sizeof(path)) {
+                (void)unlink(path);
+            }
+        }
+        (void)closedir(d);
+    }
+    (void)rmdir(dir);
+}
+
+static int seg_name_filter(const struct dirent *ent)
+{
+    return ent->d_name[0] != '.';
+}
+
+/*
+ * Read every segment in name order: synthetic frames from the first kept one
+ * on, none missing across segment boundaries, no .part left, each finalized
+ * and within span_ns of its first frame (0 = any).
+ */
+static int verify_segments(const char *dir, uint64_t span_ns, seg_readback_t *out)
+{
+    struct dirent **names = NULL;
+    ads1278_frame_t got[TEST_SEG_BATCH];
+    bool have_seq = false;
+    uint64_t seq = 0U;
+    int n = scandir(dir, &names, seg_name_filter, alphasort);
+    int idx;
+    int rc = -1;
+
+    if (n < 0) {
+        perror("scandir");
+        return -1;
+    }
+    memset(out, 0, sizeof(*out));
+    for (idx = 0; idx < n; ++idx) {
+        const char *name = names[idx]->d_name;
+        size_t len = strlen(name);
+        char path[PATH_MAX];
+        capture_file_t *cf = NULL;
+        uint64_t seg_first = 0U;
+        bool seg_any = false;
+
+        if (len < 4U || strcmp(name + len - 4U, CAPTURE_SEG_SUFFIX) != 0) {
+            fprintf(stderr, "segments: unexpected file %s\n", name);
+            goto out;
+        }
+        snprintf(path, sizeof(path), "%s/%s", dir, name);
+        if (capture_file_open(&cf, path) != 0) {
+            fprintf(stderr, "segments: cannot open %s: %s\n", name, strerror(errno));
+            goto out;
+        }
+        /* Retired and recovered segments alike carry their index. */
+        if (!capture_file_get_info(cf)->indexed) {
+            fprintf(stderr, "segments: %s was not finalized\n", name);
+            capture_file_close(cf);
+            goto out;
+        }
+        for (;;) {
+            long got_n = capture_file_read(cf, got, sizeof(got) / sizeof(got[0]));
+            long pos;
+
+            if (got_n <= 0) {
+                break;
+            }
+            for (pos = 0; pos < got_n; ++pos) {
+                ads1278_frame_t want;
+
+                if (!have_seq) {
+                    seq = got[pos].seq;
+                    out->first_seq = seq;
+                    have_seq = true;
+                }
+                if (!seg_any) {
+                    seg_first = got[pos].tstamp_ns;
+                    seg_any = true;
+                }
+                fill_synthetic_frame(&want, seq);
+                if (!frames_equal(&got[pos], &want, ADS1278_CHANNEL_COUNT) ||
+                    (span_ns != 0U && got[pos].tstamp_ns - seg_first >= span_ns)) {
+                    fprintf(stderr, "segments: %s: bad frame, expected seq %" PRIu64 "\n", name, seq);
+                    capture_file_close(cf);
+                    goto out;
+                }
+                ++seq;
+            }
+        }
+        capture_file_close(cf);
+        ++out->count;
+    }
+    out->end_seq = seq;
+    rc = 0;
+
+out:
+    for (idx = 0; idx < n; ++idx) {
+        free(names[idx]);
+    }
+    free(names);
+    return rc;
+}
+
+/* Push frames [0, frames) through a recorder, pacing to fps when non-zero. */
+static int seg_feed(capture_seg_t *seg, uint64_t frames, uint64_t fps)
+{
+    ads1278_frame_t batch[TEST_SEG_BATCH];
+    uint64_t t0 = now_ns();
+    uint64_t done;
+
+    for (done = 0U; done < frames;) {
+        size_t n = TEST_SEG_BATCH;
+        size_t idx;
+
+        if (frames - done < n) {
+            n = (size_t)(frames - done);
+        }
+        for (idx = 0U; idx < n; ++idx) {
+            fill_synthetic_frame(&batch[idx], done + idx);
+        }
+        if (capture_seg_append(seg, batch, n) != 0) {
+            perror("capture_seg_append");
+            return -1;
+        }
+        done += n;
+        if (fps != 0U) {
+            uint64_t due = t0 + (done * 1000000000ULL / fps);
+            uint64_t now = now_ns();
+
+            if (due > now) {
+                nap_ns(due - now);
+            }
+        }
+    }
+    return 0;
+}
+
+/* Record, close, and read the directory back against the recorder's stats. */
+static int seg_run(const capture_seg_cfg_t *cfg, uint64_t frames, uint64_t fps, seg_readback_t *rb)
+{
+    capture_seg_t *seg = NULL;
+    capture_seg_stats_t st;
+
+    memset(&st, 0, sizeof(st));
+    if (capture_seg_open(&seg, cfg) != 0) {
+        perror("capture_seg_open");
+        return -1;
+    }
+    if (seg_feed(seg, frames, fps) != 0) {
+        (void)capture_seg_close(seg, NULL);
+        return -1;
+    }
+    if (capture_seg_close(seg, &st) != 0) {
+        perror("capture_seg_close");
+        return -1;
+    }
+    if (verify_segments(cfg->dir, (uint64_t)cfg->segment_ms * 1000000ULL, rb) != 0) {
+        return -1;
+    }
+    if (rb->count != st.kept_segments || rb->end_seq != frames || (st.deleted == 0U && rb->first_seq != 0U) ||
+        (cfg->quota_bytes != 0U && st.kept_bytes > cfg->quota_bytes) || st.frames != frames ||
+        st.missed_frames != 0U) {
+        fprintf(stderr, "segments: %u on disk (%" PRIu64 " kept, %" PRIu64 " deleted, %" PRIu64 " byte(s)), frames %"
+            PRIu64 "..%" PRIu64 " of %" PRIu64 "\n", rb->count, st.kept_segments, st.deleted, st.kept_bytes,
+            rb->first_seq, rb->end_seq, frames);
+        return -1;
+    }
+    return 0;
+}
+
+/* Run one configuration in a fresh scratch directory; segments must actually rotate. */
+static int seg_case(capture_seg_cfg_t *cfg, uint64_t frames, uint64_t fps, bool want_deleted)
+{
+    char dir[] = "/tmp/test_segments_XXXXXX";
+    seg_readback_t rb;
+    int rc = -1;
+
+    if (mkdtemp(dir) == NULL) {
+        perror("mkdtemp");
+        return -1;
+    }
+    cfg->dir = dir;
+    if (seg_run(cfg, frames, fps, &rb) != 0) {
+        goto out;
+    }
+    if (rb.count < 2U || (want_deleted && rb.first_seq == 0U)) {
+        fprintf(stderr, "segments: %u segment(s) from frame %" PRIu64 ", expected rotation%s\n", rb.count,
+            rb.first_seq, want_deleted ? " and quota deletions" : "");
+        goto out;
+    }
+    rc = 0;
+
+out:
+    remove_dir(dir);
+    return rc;
+}
+
+/* 4 MiB segments under a 16 MiB quota, flat out: the oldest go, the rest stay contiguous. */
+static int test_size_quota(void)
+{
+    capture_seg_cfg_t cfg;
+
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.segment_bytes = 4U * 1024U * 1024U;
+    cfg.quota_bytes = 16U * 1024U * 1024U;
+    cfg.checkpoint_ms = 20U;
+    return seg_case(&cfg, TEST_SEG_FRAMES, 0U, true);
+}
+
+/* 100 ms segments of DELTA chunks (synthetic frames are 1 us apart). */
+static int test_time_rotation(void)
+{
+    capture_seg_cfg_t cfg;
+
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.file.encoding = PROTO_DATA_ENC_DELTA;
+    cfg.segment_ms = 100U;
+    cfg.checkpoint_ms = 20U;
+    return seg_case(&cfg, TEST_SEG_FRAMES, 0U, false);
+}
+
+/* Paced at eight ADS1278s' rate, so checkpoints land between appends. */
+static int test_paced(void)
+{
+    capture_seg_cfg_t cfg;
+
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.segment_bytes = 4U * 1024U * 1024U;
+    cfg.checkpoint_ms = 20U;
+    return seg_case(&cfg, TEST_SEG_PACED_FPS, TEST_SEG_PACED_FPS, false);
+}
+
+/* A recorder killed mid-segment: the next open recovers the .part and loses nothing checkpointed. */
+static int test_crash_recovery(void)
+{
+    char dir[] = "/tmp/test_segments_XXXXXX";
+    capture_seg_cfg_t cfg;
+    capture_seg_t *seg = NULL;
+    capture_seg_stats_t st;
+    seg_readback_t rb;
+    int status = 0;
+    pid_t pid;
+    int rc = -1;
+
+    if (mkdtemp(dir) == NULL) {
+        perror("mkdtemp");
+        return -1;
+    }
+    memset(&cfg, 0, sizeof(cfg));
+    memset(&st, 0, sizeof(st));
+    cfg.dir = dir;
+    cfg.segment_bytes = 4U * 1024U * 1024U;
+    cfg.checkpoint_ms = 20U;
+
+    fflush(stdout);
+    fflush(stderr);
+    pid = fork();
+    if (pid < 0) {
+        perror("fork");
+        goto out;
+    }
+    if (pid == 0) {
+        if (capture_seg_open(&seg, &cfg) != 0) {
+            _exit(1);
+        }
+        (void)seg_feed(seg, UINT64_MAX / 2U, TEST_SEG_PACED_FPS);
+        _exit(1);
+    }
+    nap_ns(TEST_SEG_CRASH_AFTER_NS);
+    (void)kill(pid, SIGKILL);
+    (void)waitpid(pid, &status, 0);
+
+    if (capture_seg_open(&seg, &cfg) != 0 || capture_seg_close(seg, &st) != 0) {
+        perror("capture_seg_open(recover)");
+        goto out;
+    }
+    if (verify_segments(dir, 0U, &rb) != 0) {
+        goto out;
+    }
+    if (st.recovered == 0U || rb.first_seq != 0U || rb.end_seq < TEST_SEG_CRASH_MIN_FRAMES) {
+        fprintf(stderr, "segments crash: %" PRIu64 " recovered, frames %" PRIu64 "..%" PRIu64 "\n", st.recovered,
+            rb.first_seq, rb.end_seq);
+        goto out;
+    }
+    rc = 0;
+
+out:
+    remove_dir(dir);
+    return rc;
+}
+
+int main(void)
+{
+    static const test_case_t cases[] = {
+        {"size rotation under a quota", test_size_quota},
+        {"time rotation", test_time_rotation},
+        {"paced at 8 x 52734 frames/s", test_paced},
+        {"kill -9 mid-segment, then recover", test_crash_recovery}
+    };
+
+    return test_run("segments", cases, sizeof(cases) / sizeof(cases[0]));
+}
@@ -0,0 +1,393 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Miguel Dovale (University of Arizona)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Channel statistics and calibration: accuracy against a two-pass long
+ * double reference (including a near-full-scale DC level with little noise,
+ * where a plain sum of squares cancels), windows merged back into the total,
+ * every kernel bit for bit against scalar, the calibration table parser, and
+ * volts summaries against converted samples.
+ */
+
+#include "chan_stats.h"
+#include "test_util.h"
+
+#include <math.h>
+#include <unistd.h>
+
+#define TEST_CALIB_FRAMES 65536U
+#define TEST_CALIB_DC 8000000             /* near positive full scale */
+#define TEST_CALIB_MAX_REL_ERR 1e-9
+
+typedef struct {
+    const char *label;
+    int32_t dc;
+    uint32_t noise_bits;
+} calib_case_t;
+
+static const calib_case_t k_cases[] = {
+    {"full-range noise", 0, 24U},
+    {"DC near full scale", TEST_CALIB_DC, 4U},
+    {"negative DC, mid noise", -TEST_CALIB_DC / 2, 12U}
+};
+
+static const uint32_t k_channels[] = {ADS1278_CHANNEL_COUNT, 12U, ADS1278_MAX_CHANNELS};
+
+/* Per-channel DC levels spread over the code range, plus uniform noise of noise_bits. */
+static void fill_calib_frames(ads1278_frame_t *frames, size_t n, uint32_t channels, int32_t dc, uint32_t noise_bits,
+                              uint64_t seed)
+{
+    const int64_t half = (int64_t)1 << (noise_bits - 1U);
+    size_t i;
+    uint32_t c;
+
+    for (i = 0U; i < n; ++i) {
+        frames[i].seq = i;
+        frames[i].tstamp_ns = (uint64_t)i * 1000U;
+        for (c = 0U; c < channels; ++c) {
+            int64_t v = (int64_t)dc - ((int64_t)c * 100003) +
+                        (int64_t)(xorshift64(&seed) & (((uint64_t)1 << noise_bits) - 1U)) - half;
+
+            frames[i].ch[c] = (int32_t)((v > 8388607) ? 8388607 : ((v < -8388608) ? -8388608 : v));
+        }
+    }
+}
+
+/* Two-pass long double reference for one channel. */
+static void calib_reference(const ads1278_frame_t *frames, size_t n, uint32_t c, chan_stats_channel_t *out)
+{
+    long double sum = 0.0L;
+    long double m2 = 0.0L;
+    long double mean;
+    size_t i;
+
+    out->min = (double)frames[0].ch[c];
+    out->max = out->min;
+    for (i = 0U; i < n; ++i) {
+        sum += frames[i].ch[c];
+        out->min = fmin(out->min, (double)frames[i].ch[c]);
+        out->max = fmax(out->max, (double)frames[i].ch[c]);
+    }
+    mean = sum / (long double)n;
+    for (i = 0U; i < n; ++i) {
+        const long double d = (long double)frames[i].ch[c] - mean;
+
+        m2 += d * d;
+    }
+    out->mean = (double)mean;
+    out->stddev = (double)sqrtl(m2 / (long double)n);
+    out->rms = (double)sqrtl((mean * mean) + (m2 / (long double)n));
+}
+
+static double rel_err(double got, double want)
+{
+    return fabs(got - want) / fmax(fabs(want), 1e-300);
+}
+
+/* Feed n frames in uneven chunks that straddle the accumulation blocks. */
+static void calib_feed(chan_stats_t *st, const ads1278_frame_t *frames, size_t n, uint64_t seed)
+{
+    size_t done = 0U;
+
+    while (done < n) {
+        size_t take = 1U + (size_t)(xorshift64(&seed) % 9000U);
+
+        if (take > n - done) {
+            take = n - done;
+        }
+        chan_stats_update(st, frames + done, take);
+        done += take;
+    }
+}
+
+/*
+ * Totals against the reference, windows merged back into the total, and the
+ * same summary bit for bit from every kernel. Returns the total summary.
+ */
+static int check_chan_stats(const ads1278_frame_t *frames, size_t n, uint32_t channels, const char *label,
+                            chan_stats_summary_t *total)
+{
+    chan_stats_t *st = NULL;
+    chan_stats_summary_t got;
+    chan_stats_summary_t win;
+    chan_stats_impl_t impl;
+    double merged_n = 0.0;
+    double mean[ADS1278_MAX_CHANNELS];
+    double m2[ADS1278_MAX_CHANNELS];
+    uint64_t seed = 0x2545F4914F6CDD1DULL;
+    size_t done = 0U;
+    uint32_t c;
+    int rc = -1;
+
+    (void)chan_stats_select(CHAN_STATS_SCALAR);
+    if (chan_stats_create(&st, channels) != 0) {
+        perror("chan_stats_create");
+        return -1;
+    }
+    calib_feed(st, frames, n, 1U);
+    chan_stats_total(st, total);
+    if (total->frames != n || total->first_seq != frames[0].seq || total->last_seq != frames[n - 1U].seq ||
+        total->channel_count != channels) {
+        fprintf(stderr, "%s: total covers %" PRIu64 " frames, seq %" PRIu64 "..%" PRIu64 "\n",
+            label, total->frames, total->first_seq, total->last_seq);
+        goto out;
+    }
+    for (c = 0U; c < channels; ++c) {
+        chan_stats_channel_t ref;
+        double worst = 0.0;
+
+        calib_reference(frames, n, c, &ref);
+        if (total->ch[c].min != ref.min || total->ch[c].max != ref.max) {
+            fprintf(stderr, "%s ch%u: min/max %.0f/%.0f, want %.0f/%.0f\n",
+                label, c + 1U, total->ch[c].min, total->ch[c].max, ref.min, ref.max);
+            goto out;
+        }
+        worst = fmax(worst, rel_err(total->ch[c].mean, ref.mean));
+        worst = fmax(worst, rel_err(total->ch[c].stddev, ref.stddev));
+        worst = fmax(worst, rel_err(total->ch[c].rms, ref.rms));
+        if (worst > TEST_CALIB_MAX_REL_ERR) {
+            fprintf(stderr, "%s ch%u: relative error %.3g vs the two-pass reference\n", label, c + 1U, worst);
+            goto out;
+        }
+    }
+
+    /* Random windows, merged back with the pairwise update, must give the total. */
+    chan_stats_reset(st);
+    memset(mean, 0, sizeof(mean));
+    memset(m2, 0, sizeof(m2));
+    while (done < n) {
+        size_t take = 1U + (size_t)(xorshift64(&seed) % 20000U);
+
+        if (take > n - done) {
+            take = n - done;
+        }
+        calib_feed(st, frames + done, take, seed);
+        chan_stats_window(st, &win, true);
+        if (win.frames != take || win.first_seq != frames[done].seq) {
+            fprintf(stderr, "%s: window of %" PRIu64 " frames from seq %" PRIu64 ", want %zu from %" PRIu64 "\n",
+                label, win.frames, win.first_seq, take, frames[done].seq);
+            goto out;
+        }
+        for (c = 0U; c < channels; ++c) {
+            const double nb = (double)win.frames;
+            const double delta = win.ch[c].mean - mean[c];
+
+            mean[c] += delta * nb / (merged_n + nb);
+            m2[c] += (win.ch[c].stddev * win.ch[c].stddev * nb) + (delta * delta * merged_n * nb / (merged_n + nb));
+        }
+        merged_n += (double)win.frames;
+        done += take;
+    }
+    chan_stats_window(st, &win, false);
+    if (win.frames != 0U) {
+        fprintf(stderr, "%s: window not empty after reset\n", label);
+        goto out;
+    }
+    for (c = 0U; c < channels; ++c) {
+        if (rel_err(mean[c], total->ch[c].mean) > TEST_CALIB_MAX_REL_ERR ||
+            rel_err(sqrt(m2[c] / merged_n), total->ch[c].stddev) > 1e-6) {
+            fprintf(stderr, "%s ch%u: merged windows %.9g/%.9g, total %.9g/%.9g\n", label, c + 1U,
+                mean[c], sqrt(m2[c] / merged_n), total->ch[c].mean, total->ch[c].stddev);
+            goto out;
+        }
+    }
+
+    for (impl = CHAN_STATS_SSE41; impl < CHAN_STATS_IMPL_COUNT; ++impl) {
+        if (chan_stats_select(impl) != 0) {
+            continue;
+        }
+        chan_stats_reset(st);
+        calib_feed(st, frames, n, 1U);
+        chan_stats_total(st, &got);
+        if (memcmp(&got, total, sizeof(got)) != 0) {
+            fprintf(stderr, "%s: %s statistics differ from scalar\n", label, chan_stats_impl_name(impl));
+            goto out;
+        }
+    }
+    rc = 0;
+
+out:
+    chan_stats_destroy(st);
+    return rc;
+}
+
+/* Every kernel's volts bit for bit against scalar, and summaries against converted samples. */
+static int check_chan_calib(const ads1278_frame_t *frames, size_t n, uint32_t channels,
+                            const chan_stats_summary_t *codes, float *ref, float *got)
+{
+    static const char k_table[] =
+        "# channel gain offset\n"
+        "1 1.0001 -0.0005\n"
+        "\n"
+        "2 -1 0.25   # inverting input\n";
+    char path[] = "/tmp/test_chan_calib_XXXXXX";
+    chan_calib_t cal;
+    chan_stats_summary_t volts = *codes;
+    chan_stats_impl_t impl;
+    int fd;
+    int loaded;
+    size_t i;
+    uint32_t c;
+
+    fd = mkstemp(path);
+    if (fd < 0 || write(fd, k_table, sizeof(k_table) - 1U) != (ssize_t)(sizeof(k_table) - 1U)) {
+        perror("calibration table");
+        if (fd >= 0) {
+            (void)close(fd);
+            (void)unlink(path);
+        }
+        return -1;
+    }
+    (void)close(fd);
+    loaded = chan_calib_load(&cal, channels, CHAN_CALIB_DEFAULT_VREF, path);
+    (void)unlink(path);
+    if (loaded != 0 || cal.scale[0] != (float)(CHAN_CALIB_DEFAULT_VREF / CHAN_CALIB_FULL_SCALE * 1.0001) ||
+        cal.scale[1] != (float)(-CHAN_CALIB_DEFAULT_VREF / CHAN_CALIB_FULL_SCALE) || cal.offset[1] != 0.25F ||
+        cal.scale[2] != (float)(CHAN_CALIB_DEFAULT_VREF / CHAN_CALIB_FULL_SCALE) || cal.offset[2] != 0.0F) {
+        fprintf(stderr, "calibration table not applied\n");
+        return -1;
+    }
+
+    (void)chan_stats_select(CHAN_STATS_SCALAR);
+    chan_calib_frames(&cal, frames, n, ref);
+    for (impl = CHAN_STATS_SSE41; impl < CHAN_STATS_IMPL_COUNT; ++impl) {
+        if (chan_stats_select(impl) != 0) {
+            continue;
+        }
+        chan_calib_frames(&cal, frames, n, got);
+        if (memcmp(ref, got, n * channels * sizeof(*got)) != 0) {
+            fprintf(stderr, "calib %s: interleaved volts differ from scalar (%u ch)\n",
+                chan_stats_impl_name(impl), channels);
+            return -1;
+        }
+        for (c = 0U; c < channels; ++c) {
+            int32_t codes_c[37];
+            float out[37];
+
+            for (i = 0U; i < 37U; ++i) {
+                codes_c[i] = frames[i].ch[c];
+            }
+            chan_calib_samples(&cal, c, codes_c, 37U, out);
+            for (i = 0U; i < 37U; ++i) {
+                if (out[i] != ref[(i * channels) + c]) {
+                    fprintf(stderr, "calib %s: ch%u sample %zu differs from scalar\n",
+                        chan_stats_impl_name(impl), c + 1U, i);
+                    return -1;
+                }
+            }
+        }
+    }
+
+    chan_calib_summary(&cal, &volts);
+    for (c = 0U; c < channels; ++c) {
+        double lo = ref[c];
+        double hi = ref[c];
+        double sum = 0.0;
+
+        for (i = 0U; i < n; ++i) {
+            lo = fmin(lo, ref[(i * channels) + c]);
+            hi = fmax(hi, ref[(i * channels) + c]);
+            sum += ref[(i * channels) + c];
+        }
+        /* float32 volts carry ~2^-24 relative rounding; the summary is exact in double. */
+        if (fabs(volts.ch[c].min - lo) > 1e-6 || fabs(volts.ch[c].max - hi) > 1e-6 ||
+            fabs(volts.ch[c].mean - (sum / (double)n)) > 1e-6 || !volts.volts) {
+            fprintf(stderr, "calib ch%u: summary %.9f/%.9f/%.9f, samples %.9f/%.9f/%.9f\n", c + 1U,
+                volts.ch[c].min, volts.ch[c].max, volts.ch[c].mean, lo, hi, sum / (double)n);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/* Every signal at every channel count through stats (with_calib false) or stats then calibration. */
+static int calib_sweep(bool with_calib)
+{
+    chan_stats_impl_t saved = chan_stats_active();
+    ads1278_frame_t *frames = calloc(TEST_CALIB_FRAMES, sizeof(*frames));
+    float *ref = malloc((size_t)TEST_CALIB_FRAMES * ADS1278_MAX_CHANNELS * sizeof(*ref));
+    float *got = malloc((size_t)TEST_CALIB_FRAMES * ADS1278_MAX_CHANNELS * sizeof(*got));
+    chan_stats_summary_t total;
+    size_t ch_idx;
+    size_t idx;
+    int rc = -1;
+
+    if (frames == NULL || ref == NULL || got == NULL) {
+        perror("malloc");
+        goto out;
+    }
+    for (ch_idx = 0U; ch_idx < sizeof(k_channels) / sizeof(k_channels[0]); ++ch_idx) {
+        const uint32_t channels = k_channels[ch_idx];
+
+        if (channels > ADS1278_MAX_CHANNELS || (ch_idx != 0U && channels == k_channels[ch_idx - 1U])) {
+            continue;
+        }
+        for (idx = 0U; idx < sizeof(k_cases) / sizeof(k_cases[0]); ++idx) {
+            char label[64];
+
+            fill_calib_frames(frames, TEST_CALIB_FRAMES, channels, k_cases[idx].dc, k_cases[idx].noise_bits,
+                0x9E3779B97F4A7C15ULL + idx);
+            snprintf(label, sizeof(label), "%s, %u ch", k_cases[idx].label, channels);
+            if (check_chan_stats(frames, TEST_CALIB_FRAMES, channels, label, &total) != 0 ||
+                (with_calib && check_chan_calib(frames, TEST_CALIB_FRAMES, channels, &total, ref, got) != 0)) {
+                goto out;
+            }
+        }
+    }
+    rc = 0;
+
+out:
+    (void)chan_stats_select(saved);
+    free(frames);
+    free(ref);
+    free(got);
+    return rc;
+}
+
+static int test_stats(void)
+{
+    return calib_sweep(false);
+}
+
+static int test_calib(void)
+{
+    return calib_sweep(true);
+}
+
+int main(void)
+{
+    static const test_case_t cases[] = {
+        {"statistics, windows and kernels", test_stats},
+        {"calibration table and volts", test_calib}
+    };
+
+    return test_run("chan_stats", cases, sizeof(cases) / sizeof(cases[0]));
+}
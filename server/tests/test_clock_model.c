@@ -0,0 +1,302 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Miguel Dovale (University of Arizona)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Timestamp clock model: error against the true conversion times over a
+ * wakeup latency sweep with drift and stalls, relock after a timestamp step,
+ * and its output as base + rate DATA timestamps within
+ * CLOCK_MODEL_LINEAR_TOLERANCE_NS (exact on an exact grid at tolerance 0).
+ */
+
+#include "clock_model.h"
+#include "proto.h"
+#include "test_util.h"
+
+#include <math.h>
+
+#define TEST_CLOCK_RATE_HZ 52734U
+#define TEST_CLOCK_FRAMES 262144U         /* ~5 s at TEST_CLOCK_RATE_HZ */
+#define TEST_CLOCK_DRIFT_PPM 25.0         /* board clock vs nominal */
+#define TEST_CLOCK_OUTLIER_PROB 0.001
+#define TEST_CLOCK_OUTLIER_NS 1500000.0   /* a scheduling stall */
+#define TEST_CLOCK_STEP_NS 50000000.0
+#define TEST_CLOCK_SETTLE_FRAMES 26367U   /* 0.5 s excluded after the step */
+#define TEST_CLOCK_MAX_DRIFT_ERR_PPM 0.5
+#define TEST_CLOCK_MIN_GAIN 10.0          /* raw jitter / model error */
+#define TEST_CLOCK_MSG_FRAMES 256U
+
+typedef struct {
+    double raw_rms_ns;          /* raw - true, about its mean */
+    double err_rms_ns;          /* model - true, about its mean */
+    double drift_ppm;
+    uint64_t relocks;
+    uint64_t backwards;         /* model timestamps not after the previous one */
+    uint64_t unlocked;          /* scored frames the model had not locked for */
+} clock_trial_t;
+
+/*
+ * A TEST_CLOCK_DRIFT_PPM-fast conversion clock read with exponential wakeup
+ * latency of mean latency_ns, TEST_CLOCK_OUTLIER_PROB stalls and optionally a
+ * timestamp step halfway. The first eighth and the settle window after the
+ * step are not scored; out (TEST_CLOCK_FRAMES entries, may be NULL) gets the
+ * model's frames.
+ */
+static void clock_trial(double latency_ns, bool step, ads1278_frame_t *out, clock_trial_t *res)
+{
+    const double period = (1e9 / TEST_CLOCK_RATE_HZ) / (1.0 + (TEST_CLOCK_DRIFT_PPM * 1e-6));
+    const uint64_t origin = 1000000000000ULL;
+    uint64_t seed = 0x243F6A8885A308D3ULL;
+    clock_model_t model;
+    double raw_sum = 0.0;
+    double raw_sq = 0.0;
+    double err_sum = 0.0;
+    double err_sq = 0.0;
+    uint64_t scored = 0U;
+    uint64_t prev = 0U;
+    uint32_t idx;
+
+    memset(res, 0, sizeof(*res));
+    clock_model_init(&model, TEST_CLOCK_RATE_HZ);
+    for (idx = 0U; idx < TEST_CLOCK_FRAMES; ++idx) {
+        double u = ((double)(xorshift64(&seed) >> 11) + 0.5) * 0x1.0p-53;
+        double latency = -latency_ns * log(u);
+        double shift = (step && idx >= TEST_CLOCK_FRAMES / 2U) ? TEST_CLOCK_STEP_NS : 0.0;
+        uint64_t truth = origin + (uint64_t)llround(((double)idx * period) + shift);
+        uint64_t raw;
+        uint64_t smoothed;
+        bool score = !step || idx < TEST_CLOCK_FRAMES / 2U || idx >= (TEST_CLOCK_FRAMES / 2U) + TEST_CLOCK_SETTLE_FRAMES;
+
+        if ((double)(xorshift64(&seed) >> 11) * 0x1.0p-53 < TEST_CLOCK_OUTLIER_PROB) {
+            latency += TEST_CLOCK_OUTLIER_NS;
+        }
+        raw = truth + (uint64_t)llround(latency);
+        smoothed = clock_model_next(&model, idx, raw);
+        if (idx != 0U && smoothed <= prev) {
+            ++res->backwards;
+        }
+        prev = smoothed;
+        if (out != NULL) {
+            fill_synthetic_frame(&out[idx], idx);
+            out[idx].tstamp_ns = smoothed;
+        }
+        if (!score || idx < TEST_CLOCK_FRAMES / 8U) {
+            continue;
+        }
+        if (!model.locked) {
+            ++res->unlocked;
+            continue;
+        }
+        {
+            double raw_err = (double)(int64_t)(raw - truth);
+            double err = (double)(int64_t)(smoothed - truth);
+
+            raw_sum += raw_err;
+            raw_sq += raw_err * raw_err;
+            err_sum += err;
+            err_sq += err * err;
+            ++scored;
+        }
+    }
+    if (scored != 0U) {
+        double raw_mean = raw_sum / (double)scored;
+        double err_mean = err_sum / (double)scored;
+
+        res->raw_rms_ns = sqrt(fmax(raw_sq / (double)scored - raw_mean * raw_mean, 0.0));
+        res->err_rms_ns = sqrt(fmax(err_sq / (double)scored - err_mean * err_mean, 0.0));
+    }
+    res->drift_ppm = clock_model_drift_ppm(&model);
+    res->relocks = model.relocks;
+}
+
+/*
+ * Encode frames in TEST_CLOCK_MSG_FRAMES messages with linear timestamps at
+ * tolerance_ns and check the decode: seq and samples exact, timestamps within
+ * the tolerance. *linear_frac is the share of messages that went linear.
+ */
+static int clock_wire_run(uint16_t encoding, const ads1278_frame_t *src, size_t n, uint32_t tolerance_ns,
+                          double *linear_frac)
+{
+    proto_data_encoder_t enc;
+    proto_data_info_t info;
+    uint8_t *msg = malloc(proto_data_max_bytes(encoding, ADS1278_CHANNEL_COUNT, TEST_CLOCK_MSG_FRAMES));
+    ads1278_frame_t *decoded = malloc(TEST_CLOCK_MSG_FRAMES * sizeof(*decoded));
+    uint64_t msgs = 0U;
+    size_t pos = 0U;
+    int rc = -1;
+
+    if (msg == NULL || decoded == NULL ||
+        proto_data_encoder_init(&enc, encoding, ADS1278_CHANNEL_COUNT, TEST_CLOCK_MSG_FRAMES) != 0) {
+        perror("clock wire setup");
+        free(msg);
+        free(decoded);
+        return -1;
+    }
+    enc.linear_ts = true;
+    enc.linear_tolerance_ns = tolerance_ns;
+
+    while (pos < n) {
+        size_t taken;
+        size_t len;
+        uint32_t idx;
+
+        proto_data_begin(&enc, msg, (uint32_t)msgs, &src[pos]);
+        taken = proto_data_append(&enc, &src[pos], n - pos);
+        len = proto_data_finish(&enc);
+        if (taken == 0U || proto_decode_data_info(msg + PROTO_HEADER_BYTES, len - PROTO_HEADER_BYTES, &info) != 0 ||
+            info.frame_count != taken) {
+            fprintf(stderr, "clock wire %s: message %" PRIu64 " does not parse\n",
+                proto_data_encoding_name(encoding), msgs);
+            goto out;
+        }
+        proto_data_decode_frames(&info, 0U, info.frame_count, decoded);
+        for (idx = 0U; idx < info.frame_count; ++idx) {
+            const ads1278_frame_t *want = &src[pos + idx];
+            uint64_t diff = (decoded[idx].tstamp_ns > want->tstamp_ns) ? decoded[idx].tstamp_ns - want->tstamp_ns
+                                                                         : want->tstamp_ns - decoded[idx].tstamp_ns;
+
+            if (decoded[idx].seq != want->seq || diff > tolerance_ns ||
+                memcmp(decoded[idx].ch, want->ch, ADS1278_CHANNEL_COUNT * sizeof(want->ch[0])) != 0) {
+                fprintf(stderr, "clock wire %s: seq %" PRIu64 " decodes %" PRIu64 " ns off\n",
+                    proto_data_encoding_name(encoding), want->seq, diff);
+                goto out;
+            }
+        }
+        pos += taken;
+        ++msgs;
+    }
+    *linear_frac = (double)enc.linear_msgs / (double)msgs;
+    rc = 0;
+
+out:
+    proto_data_encoder_destroy(&enc);
+    free(msg);
+    free(decoded);
+    return rc;
+}
+
+static int check_trial(const char *label, double latency_ns, const clock_trial_t *res, uint64_t relocks)
+{
+    double limit = (latency_ns == 0.0) ? 1.0 : res->raw_rms_ns / TEST_CLOCK_MIN_GAIN;
+
+    if (res->backwards != 0U || res->unlocked != 0U || res->relocks != relocks || !(res->err_rms_ns <= limit) ||
+        fabs(res->drift_ppm - TEST_CLOCK_DRIFT_PPM) > TEST_CLOCK_MAX_DRIFT_ERR_PPM) {
+        fprintf(stderr, "clock %s: latency %.0f ns: error %.2f ns RMS (limit %.2f), drift %+.3f ppm, %" PRIu64
+            " backwards, %" PRIu64 " unlocked, %" PRIu64 " relock(s)\n", label, latency_ns, res->err_rms_ns, limit,
+            res->drift_ppm, res->backwards, res->unlocked, res->relocks);
+        return -1;
+    }
+    return 0;
+}
+
+static int test_latency_sweep(void)
+{
+    static const double latencies[] = {0.0, 2000.0, 10000.0, 50000.0};
+    clock_trial_t res;
+    size_t idx;
+
+    for (idx = 0U; idx < sizeof(latencies) / sizeof(latencies[0]); ++idx) {
+        clock_trial(latencies[idx], false, NULL, &res);
+        if (check_trial("sweep", latencies[idx], &res, 0U) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static int test_step(void)
+{
+    clock_trial_t res;
+
+    clock_trial(10000.0, true, NULL, &res);
+    return check_trial("step", 10000.0, &res, 1U);
+}
+
+/* Model timestamps go linear at the default tolerance; a whole-ns grid at tolerance 0, bit-exact. */
+static int test_linear_wire(void)
+{
+    static const uint16_t encodings[] = {PROTO_DATA_ENC_P24, PROTO_DATA_ENC_DELTA};
+    const size_t settled = TEST_CLOCK_FRAMES / 8U;
+    ads1278_frame_t *frames = malloc(TEST_CLOCK_FRAMES * sizeof(*frames));
+    clock_trial_t res;
+    size_t idx;
+    int rc = -1;
+
+    if (frames == NULL) {
+        perror("malloc");
+        return -1;
+    }
+    clock_trial(10000.0, false, frames, &res);
+    for (idx = 0U; idx < sizeof(encodings) / sizeof(encodings[0]); ++idx) {
+        double frac = 0.0;
+
+        if (clock_wire_run(encodings[idx], frames + settled, TEST_CLOCK_FRAMES - settled,
+                           CLOCK_MODEL_LINEAR_TOLERANCE_NS, &frac) != 0) {
+            goto out;
+        }
+        if (frac < 0.99) {
+            fprintf(stderr, "clock wire %s: only %.1f%% of messages linear\n",
+                proto_data_encoding_name(encodings[idx]), frac * 100.0);
+            goto out;
+        }
+    }
+
+    for (idx = 0U; idx < TEST_CLOCK_FRAMES; ++idx) {
+        frames[idx].tstamp_ns = 1000000000ULL + (idx * 18963ULL);
+    }
+    for (idx = 0U; idx < sizeof(encodings) / sizeof(encodings[0]); ++idx) {
+        double frac = 0.0;
+
+        if (clock_wire_run(encodings[idx], frames, TEST_CLOCK_FRAMES, 0U, &frac) != 0) {
+            goto out;
+        }
+        if (frac < 0.99) {
+            fprintf(stderr, "clock wire %s: exact grid only %.1f%% linear at tolerance 0\n",
+                proto_data_encoding_name(encodings[idx]), frac * 100.0);
+            goto out;
+        }
+    }
+    rc = 0;
+
+out:
+    free(frames);
+    return rc;
+}
+
+int main(void)
+{
+    static const test_case_t cases[] = {
+        {"error and drift over a latency sweep", test_latency_sweep},
+        {"relock after a timestamp step", test_step},
+        {"base + rate DATA timestamps", test_linear_wire}
+    };
+
+    return test_run("clock_model", cases, sizeof(cases) / sizeof(cases[0]));
+}
@@ -0,0 +1,501 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Miguel Dovale (University of Arizona)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * CIC + FIR decimator: DC, output seq and timestamps (input time minus the
+ * group delays), passband gain and stopband rejection per configuration;
+ * output independent of the input block size; a seq gap restarting the
+ * filter without emitting a transient; channel groups with their own
+ * filters merged into frames of only the selected channels.
+ */
+
+#include "decim.h"
+#include "test_util.h"
+
+#include <errno.h>
+#include <math.h>
+
+#define TEST_DECIM_FRAMES 1000000U
+#define TEST_DECIM_BLOCK_FRAMES 256U
+#define TEST_DECIM_SOURCE_FRAMES 65536U
+#define TEST_DECIM_PERIOD_NS 100000U
+#define TEST_DECIM_DC 1000000
+#define TEST_DECIM_DC_LOW (ADS1278_SAMPLE_MIN + 100)
+#define TEST_DECIM_GAP_AT 300000U
+#define TEST_DECIM_GAP_SEQS 1000U
+#define TEST_DECIM_GROUP_FACTOR 64U
+
+static const char *const k_specs[] = {
+    "cic=64",
+    "cic=16,fir=4",
+    "cic=8,fir=8",
+    "fir=4",
+    "cic=128,order=5,fir=2"
+};
+
+/*
+ * Per-channel test signals, periodic in TEST_DECIM_SOURCE_FRAMES: ch1/ch2
+ * DC (ch2 near negative full scale), ch3 a passband sine at 0.05 of the
+ * output rate, ch4 a stopband sine at 0.75 of it, ch5..ch8 full-scale noise.
+ */
+static void fill_decim_source(ads1278_frame_t *src, uint32_t factor)
+{
+    const double two_pi = 6.283185307179586;
+    double pass = floor(0.05 * TEST_DECIM_SOURCE_FRAMES / factor + 0.5);
+    double stop = floor(0.75 * TEST_DECIM_SOURCE_FRAMES / factor + 0.5);
+    uint64_t rng = 0x2545F4914F6CDD1DULL;
+    uint32_t idx;
+
+    memset(src, 0, TEST_DECIM_SOURCE_FRAMES * sizeof(*src));
+    for (idx = 0U; idx < TEST_DECIM_SOURCE_FRAMES; ++idx) {
+        double t = (double)idx / TEST_DECIM_SOURCE_FRAMES;
+        uint32_t channel;
+
+        src[idx].ch[0] = TEST_DECIM_DC;
+        src[idx].ch[1] = TEST_DECIM_DC_LOW;
+        src[idx].ch[2] = (int32_t)lrint(4194304.0 * sin(two_pi * pass * t));
+        src[idx].ch[3] = (int32_t)lrint(4194304.0 * sin(two_pi * stop * t));
+        for (channel = 4U; channel < ADS1278_CHANNEL_COUNT; ++channel) {
+            src[idx].ch[channel] = (int32_t)((uint32_t)xorshift64(&rng) << 8U) >> 8;
+        }
+    }
+}
+
+/*
+ * Run a decimator over TEST_DECIM_FRAMES source frames (10 kHz timestamps)
+ * in blocks of block_frames, skipping gap_seqs seq values at
+ * TEST_DECIM_GAP_AT; outputs go to out (NULL = not kept), their count to *n_out.
+ */
+static int decim_run(decim_t *decim, const ads1278_frame_t *src, size_t block_frames, uint64_t gap_seqs,
+                     ads1278_frame_t *out, size_t *n_out)
+{
+    ads1278_frame_t *in = malloc(block_frames * sizeof(*in));
+    ads1278_frame_t *blk_out = malloc((block_frames + 1U) * sizeof(*blk_out));
+    uint64_t done;
+    size_t total = 0U;
+
+    if (in == NULL || blk_out == NULL) {
+        perror("malloc");
+        free(in);
+        free(blk_out);
+        return -1;
+    }
+    for (done = 0U; done < TEST_DECIM_FRAMES;) {
+        size_t n = block_frames;
+        size_t produced;
+        size_t idx;
+
+        if (TEST_DECIM_FRAMES - done < n) {
+            n = (size_t)(TEST_DECIM_FRAMES - done);
+        }
+        for (idx = 0U; idx < n; ++idx) {
+            uint64_t seq = done + idx;
+
+            seq += (seq >= TEST_DECIM_GAP_AT) ? gap_seqs : 0U;
+            in[idx] = src[(done + idx) % TEST_DECIM_SOURCE_FRAMES];
+            in[idx].seq = seq;
+            in[idx].tstamp_ns = seq * TEST_DECIM_PERIOD_NS;
+        }
+        produced = decim_process(decim, in, n, blk_out);
+        if (out != NULL) {
+            memcpy(&out[total], blk_out, produced * sizeof(*blk_out));
+        }
+        total += produced;
+        done += n;
+    }
+    *n_out = total;
+    free(in);
+    free(blk_out);
+    return 0;
+}
+
+/* One configuration over the test signals at TEST_DECIM_BLOCK_FRAMES per call. */
+static int check_spec(const char *spec, ads1278_frame_t *src, ads1278_frame_t *out)
+{
+    decim_cfg_t cfg;
+    decim_t *decim = NULL;
+    double pass_sq = 0.0;
+    double stop_sq = 0.0;
+    uint64_t delay;
+    uint32_t factor;
+    uint32_t order;
+    size_t produced = 0U;
+    size_t idx;
+    int rc = -1;
+
+    if (decim_parse_spec(spec, &cfg) != 0 || decim_create(&decim, &cfg, 1U, ADS1278_CHANNEL_COUNT) != 0) {
+        fprintf(stderr, "decim: bad spec %s\n", spec);
+        return -1;
+    }
+    factor = decim_factor(decim);
+    order = (cfg.cic_factor > 1U) ? ((cfg.cic_order != 0U) ? cfg.cic_order : DECIM_DEFAULT_CIC_ORDER) : 0U;
+    /* Group delay in input frames, doubled to stay integral. */
+    delay = ((uint64_t)order * (((cfg.cic_factor > 1U) ? cfg.cic_factor : 1U) - 1U)) +
+            ((uint64_t)(factor / ((cfg.fir_factor > 1U) ? cfg.fir_factor : 1U)) *
+             ((decim_fir_taps(decim) != 0U) ? decim_fir_taps(decim) - 1U : 0U));
+    fill_decim_source(src, factor);
+    if (decim_run(decim, src, TEST_DECIM_BLOCK_FRAMES, 0U, out, &produced) != 0) {
+        goto out;
+    }
+    if (produced < 100U) {
+        fprintf(stderr, "decim %s: only %zu output(s)\n", spec, produced);
+        goto out;
+    }
+
+    for (idx = 0U; idx < produced; ++idx) {
+        const ads1278_frame_t *frame = &out[idx];
+        uint64_t last = ((frame->seq + 1U) * factor) - 1U;
+        int64_t want_ns = ((int64_t)(last * 2U) - (int64_t)delay) * (TEST_DECIM_PERIOD_NS / 2U);
+
+        if (idx != 0U && frame->seq != out[idx - 1U].seq + 1U) {
+            fprintf(stderr, "decim %s: output seq %" PRIu64 " after %" PRIu64 "\n", spec, frame->seq,
+                out[idx - 1U].seq);
+            goto out;
+        }
+        if (llabs((long long)((int64_t)frame->tstamp_ns - want_ns)) > 1000 ||
+            abs(frame->ch[0] - TEST_DECIM_DC) > 1 || abs(frame->ch[1] - TEST_DECIM_DC_LOW) > 1) {
+            fprintf(stderr, "decim %s: output %" PRIu64 " off: tstamp_ns %" PRIu64 " (want %" PRId64
+                "), dc %" PRId32 " %" PRId32 "\n", spec, frame->seq, frame->tstamp_ns, want_ns,
+                frame->ch[0], frame->ch[1]);
+            goto out;
+        }
+        pass_sq += (double)frame->ch[2] * (double)frame->ch[2];
+        stop_sq += (double)frame->ch[3] * (double)frame->ch[3];
+    }
+    {
+        /* RMS of a sine of amplitude 2^22 is 2^22 / sqrt(2). */
+        double ref_sq = 4194304.0 * 4194304.0 / 2.0 * (double)produced;
+        double pass_db = 10.0 * log10(pass_sq / ref_sq);
+        double stop_db = 10.0 * log10((stop_sq + 1.0) / ref_sq);
+        double pass_tol_db = (decim_fir_taps(decim) != 0U) ? 0.05 : 0.5;
+
+        if (fabs(pass_db) > pass_tol_db || stop_db > -40.0) {
+            fprintf(stderr, "decim %s: passband %+.3f dB, stopband %.1f dB\n", spec, pass_db, stop_db);
+            goto out;
+        }
+    }
+    rc = 0;
+
+out:
+    decim_destroy(decim);
+    return rc;
+}
+
+static int test_response(void)
+{
+    ads1278_frame_t *src = malloc(TEST_DECIM_SOURCE_FRAMES * sizeof(*src));
+    ads1278_frame_t *out = malloc(TEST_DECIM_FRAMES * sizeof(*out));
+    size_t idx;
+    int rc = -1;
+
+    if (src == NULL || out == NULL) {
+        perror("malloc");
+        goto out;
+    }
+    for (idx = 0U; idx < sizeof(k_specs) / sizeof(k_specs[0]); ++idx) {
+        if (check_spec(k_specs[idx], src, out) != 0) {
+            goto out;
+        }
+    }
+    rc = 0;
+
+out:
+    free(src);
+    free(out);
+    return rc;
+}
+
+/* Feeding one frame at a time or odd-sized blocks gives the same outputs. */
+static int test_block_sizes(void)
+{
+    static const size_t k_blocks[] = {1U, 7U, 1000U};
+    ads1278_frame_t *src = malloc(TEST_DECIM_SOURCE_FRAMES * sizeof(*src));
+    ads1278_frame_t *want = malloc(TEST_DECIM_FRAMES * sizeof(*want));
+    ads1278_frame_t *got = malloc(TEST_DECIM_FRAMES * sizeof(*got));
+    decim_cfg_t cfg;
+    decim_t *decim = NULL;
+    size_t want_n = 0U;
+    size_t got_n = 0U;
+    size_t out_idx;
+    size_t idx;
+    size_t spec;
+    int rc = -1;
+
+    if (src == NULL || want == NULL || got == NULL) {
+        perror("malloc");
+        goto out;
+    }
+    for (spec = 0U; spec < sizeof(k_specs) / sizeof(k_specs[0]); ++spec) {
+        if (decim_parse_spec(k_specs[spec], &cfg) != 0 || 
+            decim_create(&decim, &cfg, 1U, ADS1278_CHANNEL_COUNT) != 0) {
+            fprintf(stderr, "decim: bad spec %s\n", k_specs[spec]);
+            goto out;
+        }
+        fill_decim_source(src, decim_factor(decim));
+        if (decim_run(decim, src, TEST_DECIM_BLOCK_FRAMES, 0U, want, &want_n) != 0) {
+            goto out;
+        }
+        for (idx = 0U; idx < sizeof(k_blocks) / sizeof(k_blocks[0]); ++idx) {
+            decim_reset(decim);
+            if (decim_run(decim, src, k_blocks[idx], 0U, got, &got_n) != 0) {
+                goto out;
+            }
+            for (out_idx = 0U; got_n == want_n && out_idx < got_n; ++out_idx) {
+                if (!frames_equal(&got[out_idx], &want[out_idx], ADS1278_CHANNEL_COUNT)) {
+                    break;
+                }
+            }
+            if (got_n != want_n || out_idx != got_n) {
+                fprintf(stderr, "decim %s: %zu-frame blocks give %zu output(s), %zu with %u\n", k_specs[spec],
+                    k_blocks[idx], got_n, want_n, TEST_DECIM_BLOCK_FRAMES);
+                goto out;
+            }
+        }
+        decim_destroy(decim);
+        decim = NULL;
+    }
+    rc = 0;
+
+out:
+    decim_destroy(decim);
+    free(src);
+    free(want);
+    free(got);
+    return rc;
+}
+
+/* A seq gap restarts the filter once; outputs stay on seq and DC stays exact across it. */
+static int test_seq_gap(void)
+{
+    ads1278_frame_t *src = malloc(TEST_DECIM_SOURCE_FRAMES * sizeof(*src));
+    ads1278_frame_t *out = malloc(TEST_DECIM_FRAMES * sizeof(*out));
+    decim_cfg_t cfg;
+    decim_t *decim = NULL;
+    decim_stats_t stats;
+    size_t produced = 0U;
+    size_t idx;
+    size_t spec;
+    int rc = -1;
+
+    if (src == NULL || out == NULL) {
+        perror("malloc");
+        goto out;
+    }
+    for (spec = 0U; spec < sizeof(k_specs) / sizeof(k_specs[0]); ++spec) {
+        uint32_t factor;
+
+        if (decim_parse_spec(k_specs[spec], &cfg) != 0 || 
+            decim_create(&decim, &cfg, 1U, ADS1278_CHANNEL_COUNT) != 0) {
+            fprintf(stderr, "decim: bad spec %s\n", k_specs[spec]);
+            goto out;
+        }
+        factor = decim_factor(decim);
+        fill_decim_source(src, factor);
+        if (decim_run(decim, src, TEST_DECIM_BLOCK_FRAMES, TEST_DECIM_GAP_SEQS, out, &produced) != 0) {
+            goto out;
+        }
+        decim_get_stats(decim, &stats);
+        if (stats.resets != 1U || produced == 0U) {
+            fprintf(stderr, "decim %s: %" PRIu64 " reset(s), %zu output(s)\n", k_specs[spec], stats.resets,
+                produced);
+            goto out;
+        }
+        for (idx = 0U; idx < produced; ++idx) {
+            if ((idx != 0U && out[idx].seq <= out[idx - 1U].seq) ||
+                out[idx].tstamp_ns > ((out[idx].seq + 1U) * factor) * TEST_DECIM_PERIOD_NS ||
+                abs(out[idx].ch[0] - TEST_DECIM_DC) > 1 || abs(out[idx].ch[1] - TEST_DECIM_DC_LOW) > 1) {
+                fprintf(stderr, "decim %s: output %" PRIu64 " off across the gap: dc %" PRId32 " %" PRId32 "\n",
+                    k_specs[spec], out[idx].seq, out[idx].ch[0], out[idx].ch[1]);
+                goto out;
+            }
+        }
+        decim_destroy(decim);
+        decim = NULL;
+    }
+    rc = 0;
+
+out:
+    decim_destroy(decim);
+    free(src);
+    free(out);
+    return rc;
+}
+
+/* Run one decimator over the test signals; outputs go to out. */
+static int run_groups(const char *const *specs, size_t n_groups, const ads1278_frame_t *src, ads1278_frame_t *out,
+                      size_t *n_out, decim_t **keep)
+{
+    decim_cfg_t cfg[DECIM_MAX_GROUPS];
+    decim_t *decim = NULL;
+    size_t idx;
+    int rc;
+
+    for (idx = 0U; idx < n_groups; ++idx) {
+        if (decim_parse_spec(specs[idx], &cfg[idx]) != 0) {
+            fprintf(stderr, "decim: bad spec %s\n", specs[idx]);
+            return -1;
+        }
+    }
+    if (decim_create(&decim, cfg, n_groups, ADS1278_MAX_CHANNELS) != 0) {
+        fprintf(stderr, "decim: cannot create %zu group(s) from %s: %s\n", n_groups, specs[0], strerror(errno));
+        return -1;
+    }
+    rc = decim_run(decim, src, TEST_DECIM_BLOCK_FRAMES, 0U, out, n_out);
+    if (rc == 0 && keep != NULL) {
+        *keep = decim;
+        return 0;
+    }
+    decim_destroy(decim);
+    return rc;
+}
+
+/*
+ * Two groups with different filters over the widest frame: every output
+ * channel matches a decimator filtering all channels with its group's
+ * settings, frames hold only the selected channels (in input order), the
+ * timestamp is the first group's, and conflicting groups are rejected.
+ */
+static int test_groups(void)
+{
+    /* ch0 and the last channel through the FIR, ch1/ch2 through a CIC only. */
+    static const char *const k_full[] = {"cic=16,fir=4", "cic=64"};
+    static const uint32_t k_source[] = {0U, 1U, 2U, ADS1278_MAX_CHANNELS - 1U};
+    static const size_t k_group[] = {0U, 1U, 1U, 0U};
+    size_t capacity = (TEST_DECIM_FRAMES / TEST_DECIM_GROUP_FACTOR) + 1U;
+    ads1278_frame_t *src = malloc(TEST_DECIM_SOURCE_FRAMES * sizeof(*src));
+    ads1278_frame_t *got = malloc(capacity * sizeof(*got));
+    ads1278_frame_t *ref[2] = {malloc(capacity * sizeof(*got)), malloc(capacity * sizeof(*got))};
+    char spec_a[64];
+    const char *groups[2];
+    decim_t *decim = NULL;
+    size_t ref_n[2] = {0U, 0U};
+    size_t got_n = 0U;
+    size_t idx;
+    int rc = -1;
+
+    if (src == NULL || got == NULL || ref[0] == NULL || ref[1] == NULL) {
+        perror("malloc");
+        goto out;
+    }
+    fill_decim_source(src, TEST_DECIM_GROUP_FACTOR);
+    for (idx = 0U; idx < 2U; ++idx) {
+        if (run_groups(&k_full[idx], 1U, src, ref[idx], &ref_n[idx], NULL) != 0) {
+            goto out;
+        }
+    }
+    snprintf(spec_a, sizeof(spec_a), "cic=16,fir=4,mask=0x%" PRIx64,
+        (UINT64_C(1) << (ADS1278_MAX_CHANNELS - 1U)) | UINT64_C(1));
+    groups[0] = spec_a;
+    groups[1] = "cic=64,mask=0x6";
+    if (run_groups(groups, 2U, src, got, &got_n, &decim) != 0) {
+        goto out;
+    }
+    if (decim_channels(decim) != 4U || got_n == 0U || got_n > ref_n[0] || got_n > ref_n[1]) {
+        fprintf(stderr, "decim groups: %" PRIu32 " channel(s), %zu output(s) (%zu and %zu alone)\n",
+            decim_channels(decim), got_n, ref_n[0], ref_n[1]);
+        goto out;
+    }
+    for (idx = 0U; idx < 4U; ++idx) {
+        if (decim_source_channel(decim, (uint32_t)idx) != k_source[idx]) {
+            fprintf(stderr, "decim groups: output ch%zu from ch%" PRIu32 "\n", idx,
+                decim_source_channel(decim, (uint32_t)idx));
+            goto out;
+        }
+    }
+    for (idx = 0U; idx < got_n; ++idx) {
+        const ads1278_frame_t *frame = &got[idx];
+        const ads1278_frame_t *want[2];
+        uint32_t channel;
+
+        want[0] = &ref[0][ref_n[0] - got_n + idx];
+        want[1] = &ref[1][ref_n[1] - got_n + idx];
+        if (frame->seq != want[0]->seq || frame->seq != want[1]->seq || frame->tstamp_ns != want[0]->tstamp_ns) {
+            fprintf(stderr, "decim groups: output %zu seq %" PRIu64 " tstamp_ns %" PRIu64 ", alone %" PRIu64
+                " %" PRIu64 "\n", idx, frame->seq, frame->tstamp_ns, want[0]->seq, want[0]->tstamp_ns);
+            goto out;
+        }
+        for (channel = 0U; channel < ADS1278_MAX_CHANNELS; ++channel) {
+            int32_t expect = (channel < 4U) ? want[k_group[channel]]->ch[k_source[channel]] : 0;
+
+            if (frame->ch[channel] != expect) {
+                fprintf(stderr, "decim groups: output %" PRIu64 " ch%" PRIu32 " = %" PRId32 ", want %" PRId32 "\n",
+                    frame->seq, channel, frame->ch[channel], expect);
+                goto out;
+            }
+        }
+    }
+    decim_destroy(decim);
+    decim = NULL;
+
+    {
+        static const char *const k_bad[][2] = {
+            {"cic=64,mask=0x3", "cic=64,mask=0x6"},     /* ch1 in both */
+            {"cic=64,mask=0x3", "cic=32,mask=0xC"},     /* total factors differ */
+            {"cic=64,mask=0x1", "cic=64"}               /* the default mask overlaps */
+        };
+        decim_cfg_t cfg[2];
+
+        for (idx = 0U; idx < sizeof(k_bad) / sizeof(k_bad[0]); ++idx) {
+            if (decim_parse_spec(k_bad[idx][0], &cfg[0]) != 0 || decim_parse_spec(k_bad[idx][1], &cfg[1]) != 0 ||
+                decim_create(&decim, cfg, 2U, ADS1278_MAX_CHANNELS) == 0 || errno != EINVAL) {
+                fprintf(stderr, "decim groups: %s + %s accepted\n", k_bad[idx][0], k_bad[idx][1]);
+                goto out;
+            }
+        }
+        /* A channel past the frame. */
+        cfg[0].channel_mask = UINT64_C(1) << ADS1278_CHANNEL_COUNT;
+        if (decim_create(&decim, cfg, 1U, ADS1278_CHANNEL_COUNT) == 0 || errno != EINVAL) {
+            fprintf(stderr, "decim groups: mask past the frame accepted\n");
+            goto out;
+        }
+    }
+    rc = 0;
+
+out:
+    decim_destroy(decim);
+    free(src);
+    free(got);
+    free(ref[0]);
+    free(ref[1]);
+    return rc;
+}
+
+int main(void)
+{
+    static const test_case_t cases[] = {
+        {"DC, seq, timestamps and response", test_response},
+        {"independent of the block size", test_block_sizes},
+        {"seq gap restarts the filter", test_seq_gap},
+        {"channel groups, selected channels only", test_groups}
+    };
+
+    return test_run("decim", cases, sizeof(cases) / sizeof(cases[0]));
+}
@@ -0,0 +1,105 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Miguel Dovale (University of Arizona)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Missed-conversion inference on a synthetic DRDY grid with random gaps and
+ * uniform timestamp jitter, fed without backend hints (as with sysfs GPIO):
+ * no frame may be misplaced up to +/-10% jitter (+/-20% per interval).
+ */
+
+#include "drdy_model.h"
+#include "test_util.h"
+
+#define TEST_DRDY_PERIOD_NS 18963.0      /* 52734 Hz, ADS1278 high-resolution mode at 27 MHz */
+#define TEST_DRDY_FRAMES 200000U
+#define TEST_DRDY_GAP_PROB 0.005
+#define TEST_DRDY_GAP_MAX 64U
+
+/* Frames whose inferred index disagrees with the true one, each misplacement counted once. */
+static uint64_t drdy_model_trial(double jitter_frac, uint64_t *missed, uint64_t *true_missed)
+{
+    drdy_model_t model;
+    uint64_t state = 0x2545F4914F6CDD1DULL;
+    uint64_t truth = 0U;
+    uint64_t wrong = 0U;
+    uint64_t offset = 0U;
+    uint32_t frame;
+
+    *true_missed = 0U;
+    drdy_model_init(&model, true, 0U);
+    for (frame = 0U; frame < TEST_DRDY_FRAMES; ++frame) {
+        double jitter = (test_uniform(&state) * 2.0 - 1.0) * jitter_frac * TEST_DRDY_PERIOD_NS;
+        uint64_t tstamp = 1000000000ULL + (uint64_t)((double)truth * TEST_DRDY_PERIOD_NS + jitter);
+        uint64_t index = drdy_model_next(&model, tstamp, 0U);
+
+        if (index - truth != offset) {
+            ++wrong;
+            offset = index - truth;
+        }
+        if (test_uniform(&state) < TEST_DRDY_GAP_PROB) {
+            uint64_t gap = 1U + (uint64_t)(test_uniform(&state) * TEST_DRDY_GAP_MAX);
+
+            truth += gap;
+            *true_missed += gap;
+        }
+        ++truth;
+    }
+    *missed = model.missed;
+    return wrong;
+}
+
+static int test_jitter(void)
+{
+    static const double jitters[] = {0.0, 0.05, 0.10};
+    size_t idx;
+
+    for (idx = 0U; idx < sizeof(jitters) / sizeof(jitters[0]); ++idx) {
+        uint64_t missed;
+        uint64_t true_missed;
+        uint64_t wrong = drdy_model_trial(jitters[idx], &missed, &true_missed);
+
+        if (wrong != 0U || missed != true_missed) {
+            fprintf(stderr, "drdy model jitter +/-%.0f%%: %" PRIu64 " misplaced, %" PRIu64 " missed of %" PRIu64
+                "\n", jitters[idx] * 100.0, wrong, missed, true_missed);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int main(void)
+{
+    static const test_case_t cases[] = {
+        {"no misplacement up to +/-10% jitter", test_jitter}
+    };
+
+    return test_run("drdy_model", cases, sizeof(cases) / sizeof(cases[0]));
+}
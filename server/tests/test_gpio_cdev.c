@@ -0,0 +1,273 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Miguel Dovale (University of Arizona)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/*
+ * DRDY waits on a GPIO character device line, driven through a pipe that
+ * carries gpio_v2_line_event records: the newest queued edge is serviced,
+ * older ones and line_seqno holes count as missed, and read()/poll() are
+ * wrapped at link time to pin the syscalls per wait: one read() without a
+ * timeout, poll() + read() with one.
+ */
+
+#include "ads1278_gpio.h"
+#include "test_util.h"
+
+#include <errno.h>
+#include <linux/gpio.h>
+#include <poll.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#define TEST_CDEV_TIMEOUT_MS 1000U
+#define TEST_CDEV_SHORT_TIMEOUT_MS 10U
+#define TEST_CDEV_LATE_EDGE_NS 5000000ULL
+#define TEST_CDEV_BURST 70U         /* more than one read() takes */
+
+typedef struct {
+    uint64_t reads;
+    uint64_t polls;
+} syscall_count_t;
+
+static syscall_count_t g_calls;
+
+ssize_t __real_read(int fd, void *buf, size_t count);
+int __real_poll(struct pollfd *fds, nfds_t nfds, int timeout);
+ssize_t __wrap_read(int fd, void *buf, size_t count);
+int __wrap_poll(struct pollfd *fds, nfds_t nfds, int timeout);
+
+ssize_t __wrap_read(int fd, void *buf, size_t count)
+{
+    ++g_calls.reads;
+    return __real_read(fd, buf, count);
+}
+
+int __wrap_poll(struct pollfd *fds, nfds_t nfds, int timeout)
+{
+    ++g_calls.polls;
+    return __real_poll(fds, nfds, timeout);
+}
+
+typedef struct {
+    int fds[2];                 /* [0] is the DRDY line fd, [1] the "kernel" */
+    ads1278_gpio_t gpio;
+    uint32_t seqno;
+} fake_line_t;
+
+typedef struct {
+    fake_line_t *line;
+    uint64_t delay_ns;
+    uint64_t edge_ns;
+} late_edge_t;
+
+static int line_open(fake_line_t *line)
+{
+    memset(line, 0, sizeof(*line));
+    if (pipe(line->fds) != 0) {
+        perror("pipe");
+        return -1;
+    }
+    ads1278_gpio_init(&line->gpio, &ads1278_gpio_cdev_ops);
+    line->gpio.fd = line->fds[0];
+    return 0;
+}
+
+static void line_close(fake_line_t *line)
+{
+    /* cdev_close() closes the line fd. */
+    line->gpio.ops->close(&line->gpio);
+    (void)close(line->fds[1]);
+}
+
+/* Queue count edges stamped edge_ns, edge_ns + 1 .., skipping `hole` seqnos before the first. */
+static int line_edges(fake_line_t *line, uint32_t count, uint32_t hole, uint64_t edge_ns)
+{
+    struct gpio_v2_line_event events[TEST_CDEV_BURST];
+    uint32_t idx;
+
+    memset(events, 0, sizeof(events));
+    line->seqno += hole;
+    for (idx = 0U; idx < count; ++idx) {
+        events[idx].timestamp_ns = edge_ns + idx;
+        events[idx].id = GPIO_V2_LINE_EVENT_FALLING_EDGE;
+        events[idx].seqno = ++line->seqno;
+        events[idx].line_seqno = line->seqno;
+    }
+    if (write(line->fds[1], events, count * sizeof(events[0])) != (ssize_t)(count * sizeof(events[0]))) {
+        perror("write");
+        return -1;
+    }
+    return 0;
+}
+
+static void *late_edge_main(void *arg)
+{
+    late_edge_t *late = arg;
+
+    nap_ns(late->delay_ns);
+    (void)line_edges(late->line, 1U, 0U, late->edge_ns);
+    return NULL;
+}
+
+/* One wait, checking the serviced edge, the missed count and the read()/poll() calls it took. */
+static int wait_check(const char *what, fake_line_t *line, uint32_t timeout_ms, uint64_t want_ns,
+                      uint32_t want_missed, uint64_t want_reads, uint64_t want_polls)
+{
+    syscall_count_t calls;
+    uint64_t edge_ns = 0U;
+    uint32_t missed = UINT32_MAX;
+    int rc;
+
+    memset(&g_calls, 0, sizeof(g_calls));
+    rc = line->gpio.ops->wait_edge(&line->gpio, timeout_ms, &edge_ns, &missed);
+    calls = g_calls;
+    if (rc != 0 || edge_ns != want_ns || missed != want_missed) {
+        fprintf(stderr, "%s: rc %d (%s), edge %" PRIu64 " ns (want %" PRIu64 "), missed %u (want %u)\n", what,
+            rc, (rc != 0) ? strerror(errno) : "ok", edge_ns, want_ns, missed, want_missed);
+        return -1;
+    }
+    if (calls.reads != want_reads || calls.polls != want_polls) {
+        fprintf(stderr, "%s: %" PRIu64 " read() and %" PRIu64 " poll() call(s), want %" PRIu64 " and %" PRIu64
+            "\n", what, calls.reads, calls.polls, want_reads, want_polls);
+        return -1;
+    }
+    return 0;
+}
+
+/* Without a timeout: a queued edge, an edge that arrives while blocked, a queued burst with a hole. */
+static int test_no_timeout(void)
+{
+    fake_line_t line;
+    late_edge_t late;
+    pthread_t thread;
+    int rc = -1;
+
+    if (line_open(&line) != 0) {
+        return -1;
+    }
+    if (line_edges(&line, 1U, 0U, 1000U) != 0 ||
+        wait_check("queued edge", &line, ADS1278_NO_TIMEOUT, 1000U, 0U, 1U, 0U) != 0) {
+        goto out;
+    }
+
+    late.line = &line;
+    late.delay_ns = TEST_CDEV_LATE_EDGE_NS;
+    late.edge_ns = 2000U;
+    if (pthread_create(&thread, NULL, late_edge_main, &late) != 0) {
+        perror("pthread_create");
+        goto out;
+    }
+    rc = wait_check("late edge", &line, ADS1278_NO_TIMEOUT, 2000U, 0U, 1U, 0U);
+    (void)pthread_join(thread, NULL);
+    if (rc != 0) {
+        goto out;
+    }
+    rc = -1;
+
+    /* Three queued edges after two the kernel dropped: the newest is serviced, four are missed. */
+    if (line_edges(&line, 3U, 2U, 3000U) != 0 ||
+        wait_check("queued burst", &line, ADS1278_NO_TIMEOUT, 3002U, 4U, 1U, 0U) != 0) {
+        goto out;
+    }
+    rc = 0;
+
+out:
+    line_close(&line);
+    return rc;
+}
+
+/* With a timeout: poll() then read() for a queued edge, poll() alone when it expires. */
+static int test_timeout(void)
+{
+    fake_line_t line;
+    syscall_count_t calls;
+    uint64_t edge_ns;
+    uint32_t missed;
+    int rc = -1;
+
+    if (line_open(&line) != 0) {
+        return -1;
+    }
+    if (line_edges(&line, 1U, 0U, 1000U) != 0 ||
+        wait_check("queued edge", &line, TEST_CDEV_TIMEOUT_MS, 1000U, 0U, 1U, 1U) != 0) {
+        goto out;
+    }
+
+    memset(&g_calls, 0, sizeof(g_calls));
+    if (line.gpio.ops->wait_edge(&line.gpio, TEST_CDEV_SHORT_TIMEOUT_MS, &edge_ns, &missed) == 0 ||
+        errno != ETIMEDOUT) {
+        fprintf(stderr, "no edge: the wait did not time out\n");
+        goto out;
+    }
+    calls = g_calls;
+    if (calls.reads != 0U || calls.polls != 1U) {
+        fprintf(stderr, "no edge: %" PRIu64 " read() and %" PRIu64 " poll() call(s), want 0 and 1\n",
+            calls.reads, calls.polls);
+        goto out;
+    }
+    rc = 0;
+
+out:
+    line_close(&line);
+    return rc;
+}
+
+/* More queued edges than one read() takes: a non-blocking poll() and a second read() reach the newest. */
+static int test_burst(void)
+{
+    fake_line_t line;
+    int rc = -1;
+
+    if (line_open(&line) != 0) {
+        return -1;
+    }
+    if (line_edges(&line, TEST_CDEV_BURST, 0U, 5000U) != 0 ||
+        wait_check("burst", &line, ADS1278_NO_TIMEOUT, 5000U + TEST_CDEV_BURST - 1U, TEST_CDEV_BURST - 1U, 2U,
+                   1U) != 0) {
+        goto out;
+    }
+    rc = 0;
+
+out:
+    line_close(&line);
+    return rc;
+}
+
+int main(void)
+{
+    static const test_case_t cases[] = {
+        {"no timeout: one read() per wait", test_no_timeout},
+        {"timeout: poll() + read(), expiry", test_timeout},
+        {"burst past one read()", test_burst}
+    };
+
+    return test_run("gpio_cdev", cases, sizeof(cases) / sizeof(cases[0]));
+}
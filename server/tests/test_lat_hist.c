@@ -0,0 +1,134 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Miguel Dovale (University of Arizona)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Latency histogram: quantiles of log-uniform 100 ns .. 10 ms latencies
+ * within the 12.5% bucket error of the exact sorted values, and recorder
+ * snapshots and merged halves that agree with a plain histogram.
+ */
+
+#include "lat_hist.h"
+#include "test_util.h"
+
+#include <math.h>
+
+#define TEST_LAT_SAMPLES (1U << 20)
+#define TEST_LAT_MAX_REL_ERR 0.125
+
+static lat_recorder_t g_rec;
+
+static int cmp_u64(const void *lhs, const void *rhs)
+{
+    uint64_t a = *(const uint64_t *)lhs;
+    uint64_t b = *(const uint64_t *)rhs;
+
+    return (a > b) - (a < b);
+}
+
+static int test_quantiles(void)
+{
+    static const double quantiles[] = {0.5, 0.99, 0.999};
+    const size_t count = TEST_LAT_SAMPLES;
+    uint64_t *sorted = malloc(count * sizeof(*sorted));
+    uint64_t state = 0x9E3779B97F4A7C15ULL;
+    lat_hist_t snap;
+    lat_hist_t whole;
+    lat_hist_t half;
+    size_t idx;
+    int rc = -1;
+
+    if (sorted == NULL) {
+        perror("malloc");
+        return -1;
+    }
+    lat_recorder_reset(&g_rec);
+    lat_hist_reset(&whole);
+    lat_hist_reset(&half);
+    for (idx = 0U; idx < count; ++idx) {
+        sorted[idx] = (uint64_t)(100.0 * pow(1e5, test_uniform(&state)));
+        lat_recorder_record(&g_rec, sorted[idx]);
+        lat_hist_record(&whole, sorted[idx]);
+        if (idx < count / 2U) {
+            lat_hist_record(&half, sorted[idx]);
+        }
+    }
+    lat_recorder_snapshot(&g_rec, &snap);
+    if (memcmp(&snap, &whole, sizeof(snap)) != 0) {
+        fprintf(stderr, "lat_hist: recorder snapshot differs from lat_hist_record\n");
+        goto out;
+    }
+    {
+        lat_hist_t rest;
+
+        lat_hist_reset(&rest);
+        for (idx = count / 2U; idx < count; ++idx) {
+            lat_hist_record(&rest, sorted[idx]);
+        }
+        lat_hist_merge(&half, &rest);
+        if (memcmp(&half, &whole, sizeof(half)) != 0) {
+            fprintf(stderr, "lat_hist: merged halves differ from the whole\n");
+            goto out;
+        }
+    }
+
+    qsort(sorted, count, sizeof(*sorted), cmp_u64);
+    if (snap.count != count || snap.max_ns != sorted[count - 1U] || snap.min_ns != sorted[0]) {
+        fprintf(stderr, "lat_hist: count %" PRIu64 " min %" PRIu64 " max %" PRIu64 "\n", snap.count, snap.min_ns,
+            snap.max_ns);
+        goto out;
+    }
+    for (idx = 0U; idx < sizeof(quantiles) / sizeof(quantiles[0]); ++idx) {
+        size_t rank = (size_t)(quantiles[idx] * (double)count);
+        uint64_t exact = sorted[(rank < count) ? rank : count - 1U];
+        uint64_t approx = lat_hist_quantile(&snap, quantiles[idx]);
+        double rel = fabs((double)approx - (double)exact) / (double)exact;
+
+        if (rel > TEST_LAT_MAX_REL_ERR) {
+            fprintf(stderr, "lat_hist: q%g %" PRIu64 " ns vs exact %" PRIu64 " ns (%.1f%%)\n",
+                quantiles[idx] * 100.0, approx, exact, rel * 100.0);
+            goto out;
+        }
+    }
+    rc = 0;
+
+out:
+    free(sorted);
+    return rc;
+}
+
+int main(void)
+{
+    static const test_case_t cases[] = {
+        {"quantiles, snapshot and merge", test_quantiles}
+    };
+
+    return test_run("lat_hist", cases, sizeof(cases) / sizeof(cases[0]));
+}
@@ -0,0 +1,656 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Miguel Dovale (University of Arizona)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Wire framing: header version/magic checks, HELLO/CONFIG/SUBSCRIBE/GAP,
+ * STATS, SUMMARY and SPECTRUM round trips and DATA round trips for every
+ * encoding over jittered timestamps with missed conversions, base + last
+ * timestamps for frames on an exact grid, in-message seq gap lists, and
+ * every chained channel count P24 and DELTA carry.
+ */
+
+#include "proto.h"
+#include "test_util.h"
+
+#define TEST_PROTO_FRAMES 20000U
+#define TEST_PROTO_PER_MSG 256U
+#define TEST_PROTO_GAP_EVERY 4099U   /* a missed DRDY so P24 has to split */
+
+typedef struct {
+    uint64_t msgs;
+    uint64_t linear_msgs;       /* decoded with PROTO_DATA_LINEAR_TS */
+    uint64_t gap_msgs;          /* decoded with a PROTO_DATA_SEQ_GAPS list */
+} wire_result_t;
+
+/* Ramp frames, jittered timestamps optional, one conversion missed every gap_every (0 = none). */
+static void fill_wire_frames(ads1278_frame_t *frames, size_t n, bool jitter, uint32_t gap_every)
+{
+    uint64_t seq = 0U;
+    size_t idx;
+
+    for (idx = 0U; idx < n; ++idx, ++seq) {
+        if (gap_every != 0U && idx != 0U && idx % gap_every == 0U) {
+            ++seq;
+        }
+        fill_synthetic_frame(&frames[idx], seq);
+        if (jitter) {
+            frames[idx].tstamp_ns += (seq * 7919U) % 61U;
+        }
+    }
+}
+
+/*
+ * Encode src in messages of up to TEST_PROTO_PER_MSG frames, decode each
+ * back and compare every frame, its seq through proto_data_frame_seq() and,
+ * for linear messages, proto_data_linear_tstamp().
+ */
+static int wire_round_trip(uint16_t encoding, uint32_t channels, const ads1278_frame_t *src, size_t n,
+                           bool linear, uint32_t max_gaps, wire_result_t *res)
+{
+    proto_data_encoder_t enc;
+    proto_data_info_t info;
+    proto_data_info_t truncated;
+    proto_header_t hdr;
+    size_t msg_bytes = proto_data_max_bytes(encoding, channels, TEST_PROTO_PER_MSG) + PROTO_DATA_GAPS_BYTES(max_gaps);
+    uint8_t *msg = malloc(msg_bytes);
+    ads1278_frame_t *decoded = malloc(TEST_PROTO_PER_MSG * sizeof(*decoded));
+    const char *name = proto_data_encoding_name(encoding);
+    size_t pos = 0U;
+    int rc = -1;
+
+    memset(res, 0, sizeof(*res));
+    if (msg == NULL || decoded == NULL || proto_data_encoder_init(&enc, encoding, channels, TEST_PROTO_PER_MSG) != 0) {
+        perror("wire setup");
+        free(msg);
+        free(decoded);
+        return -1;
+    }
+    enc.linear_ts = linear;
+    enc.max_gaps = max_gaps;
+
+    while (pos < n) {
+        size_t taken;
+        size_t len;
+        uint32_t idx;
+
+        proto_data_begin(&enc, msg, (uint32_t)res->msgs, &src[pos]);
+        taken = proto_data_append(&enc, &src[pos], n - pos);
+        len = proto_data_finish(&enc);
+        if (taken == 0U || len > msg_bytes || proto_decode_header(msg, &hdr) != 0 || hdr.type != PROTO_MSG_DATA ||
+            hdr.msg_seq != (uint32_t)res->msgs || PROTO_HEADER_BYTES + hdr.payload_len != len ||
+            proto_decode_data_info(msg + PROTO_HEADER_BYTES, hdr.payload_len, &info) != 0 ||
+            info.frame_count != taken || info.encoding != encoding || info.channel_count != channels) {
+            fprintf(stderr, "wire %s: message %" PRIu64 " does not parse (%zu frame(s) taken)\n", name, res->msgs,
+                taken);
+            goto out;
+        }
+        if (proto_decode_data_info(msg + PROTO_HEADER_BYTES, hdr.payload_len - 1U, &truncated) == 0) {
+            fprintf(stderr, "wire %s: truncated message %" PRIu64 " accepted\n", name, res->msgs);
+            goto out;
+        }
+        proto_data_decode_frames(&info, 0U, info.frame_count, decoded);
+        for (idx = 0U; idx < info.frame_count; ++idx) {
+            if (!frames_equal(&decoded[idx], &src[pos + idx], channels) ||
+                (encoding != PROTO_DATA_ENC_RECORD48 && proto_data_frame_seq(&info, idx) != src[pos + idx].seq) ||
+                (info.linear_ts && proto_data_linear_tstamp(&info, idx) != src[pos + idx].tstamp_ns)) {
+                fprintf(stderr, "wire %s: round trip mismatch at seq %" PRIu64 "\n", name, src[pos + idx].seq);
+                goto out;
+            }
+        }
+        if (info.gap_count > max_gaps) {
+            fprintf(stderr, "wire %s: %" PRIu32 " gap(s) in a message, at most %" PRIu32 "\n", name,
+                info.gap_count, max_gaps);
+            goto out;
+        }
+        res->linear_msgs += info.linear_ts ? 1U : 0U;
+        res->gap_msgs += (info.gap_count != 0U) ? 1U : 0U;
+        pos += taken;
+        ++res->msgs;
+    }
+    rc = 0;
+
+out:
+    proto_data_encoder_destroy(&enc);
+    free(msg);
+    free(decoded);
+    return rc;
+}
+
+static int test_header(void)
+{
+    uint8_t buf[PROTO_HEADER_BYTES];
+    proto_header_t hdr;
+    proto_header_t got;
+
+    memset(&hdr, 0, sizeof(hdr));
+    memset(&got, 0, sizeof(got));
+
+    hdr.version = PROTO_VERSION;
+    hdr.type = PROTO_MSG_STATS;
+    hdr.flags = 0xA55AU;
+    hdr.msg_seq = 0xDEADBEEFU;
+    hdr.payload_len = 1234U;
+    proto_encode_header(buf, &hdr);
+    if (proto_decode_header(buf, &got) != 0 || memcmp(&got, &hdr, sizeof(hdr)) != 0) {
+        fprintf(stderr, "header does not round-trip\n");
+        return -1;
+    }
+    buf[4] = PROTO_MIN_VERSION;
+    if (proto_decode_header(buf, &got) != 0 || got.version != PROTO_MIN_VERSION) {
+        fprintf(stderr, "version %u header rejected\n", PROTO_MIN_VERSION);
+        return -1;
+    }
+    buf[4] = PROTO_VERSION + 1U;
+    if (proto_decode_header(buf, &got) == 0) {
+        fprintf(stderr, "version %u header accepted\n", PROTO_VERSION + 1U);
+        return -1;
+    }
+    buf[4] = PROTO_VERSION;
+    buf[0] ^= 0xFFU;
+    if (proto_decode_header(buf, &got) == 0) {
+        fprintf(stderr, "bad magic accepted\n");
+        return -1;
+    }
+    buf[0] ^= 0xFFU;
+    proto_store_u32(buf + 12, PROTO_MAX_PAYLOAD_BYTES + 1U);
+    if (proto_decode_header(buf, &got) == 0) {
+        fprintf(stderr, "oversized payload accepted\n");
+        return -1;
+    }
+    return 0;
+}
+
+static int test_control(void)
+{
+    uint8_t buf[PROTO_HEADER_BYTES + PROTO_HELLO_BYTES + PROTO_CONFIG_BYTES + PROTO_GAP_BYTES];
+    proto_header_t hdr;
+    proto_hello_t hello;
+    proto_hello_t hello_got;
+    proto_config_t cfg;
+    proto_config_t cfg_got;
+    proto_subscribe_t sub;
+    proto_subscribe_t sub_got;
+    proto_gap_t gap;
+    proto_gap_t gap_got;
+    size_t len;
+
+    /* Zeroed padding on both sides so whole structs compare. */
+    memset(&hello, 0, sizeof(hello));
+    memset(&hello_got, 0, sizeof(hello_got));
+    memset(&cfg, 0, sizeof(cfg));
+    memset(&cfg_got, 0, sizeof(cfg_got));
+    memset(&sub, 0, sizeof(sub));
+    memset(&sub_got, 0, sizeof(sub_got));
+    memset(&gap, 0, sizeof(gap));
+    memset(&gap_got, 0, sizeof(gap_got));
+    hello.proto_version = PROTO_VERSION;
+    hello.channel_count = ADS1278_CHANNEL_COUNT;
+    snprintf(hello.server_name, sizeof(hello.server_name), "test");
+    len = proto_encode_hello(buf, 7U, &hello);
+    if (len != PROTO_HEADER_BYTES + PROTO_HELLO_BYTES || proto_decode_header(buf, &hdr) != 0 ||
+        hdr.type != PROTO_MSG_HELLO || hdr.msg_seq != 7U ||
+        proto_decode_hello(buf + PROTO_HEADER_BYTES, hdr.payload_len, &hello_got) != 0 ||
+        memcmp(&hello, &hello_got, sizeof(hello)) != 0) {
+        fprintf(stderr, "HELLO does not round-trip\n");
+        return -1;
+    }
+
+    cfg.backend = 1U;
+    cfg.sample_rate_hz = 52734U;
+    cfg.sclk_hz = 27000000U;
+    cfg.spi_mode = 1U;
+    cfg.settle_frames = 3U;
+    cfg.frames_per_msg = 256U;
+    cfg.flush_us = 5000U;
+    cfg.stream_mode = 1U;
+    len = proto_encode_config(buf, 8U, &cfg);
+    if (len != PROTO_HEADER_BYTES + PROTO_CONFIG_BYTES || proto_decode_header(buf, &hdr) != 0 ||
+        hdr.type != PROTO_MSG_CONFIG || proto_decode_config(buf + PROTO_HEADER_BYTES, hdr.payload_len, &cfg_got) != 0 ||
+        memcmp(&cfg, &cfg_got, sizeof(cfg)) != 0) {
+        fprintf(stderr, "CONFIG does not round-trip\n");
+        return -1;
+    }
+    if (proto_decode_config(buf + PROTO_HEADER_BYTES, PROTO_CONFIG_BYTES - 1U, &cfg_got) == 0) {
+        fprintf(stderr, "short CONFIG accepted\n");
+        return -1;
+    }
+
+    sub.resume_seq = 0x123456789ULL;
+    sub.max_lag_ms = 50U;
+    sub.policy = PROTO_POLICY_DISCONNECT;
+    sub.flags = PROTO_SUBSCRIBE_RESUME;
+    len = proto_encode_subscribe(buf, &sub);
+    if (len != PROTO_HEADER_BYTES + PROTO_SUBSCRIBE_BYTES || proto_decode_header(buf, &hdr) != 0 ||
+        hdr.type != PROTO_MSG_SUBSCRIBE ||
+        proto_decode_subscribe(buf + PROTO_HEADER_BYTES, hdr.payload_len, &sub_got) != 0 ||
+        memcmp(&sub, &sub_got, sizeof(sub)) != 0) {
+        fprintf(stderr, "SUBSCRIBE does not round-trip\n");
+        return -1;
+    }
+
+    gap.first_msg_seq = 41U;
+    gap.msg_count = 3U;
+    gap.first_seq = 100000U;
+    gap.frame_count = 768U;
+    gap.flags = PROTO_GAP_RESUME;
+    len = proto_encode_gap(buf, &gap);
+    if (len != PROTO_HEADER_BYTES + PROTO_GAP_BYTES || proto_decode_header(buf, &hdr) != 0 ||
+        hdr.type != PROTO_MSG_GAP || hdr.msg_seq != 0U ||
+        proto_decode_gap(buf + PROTO_HEADER_BYTES, hdr.payload_len, &gap_got) != 0 ||
+        memcmp(&gap, &gap_got, sizeof(gap)) != 0) {
+        fprintf(stderr, "GAP does not round-trip\n");
+        return -1;
+    }
+    if (proto_decode_gap(buf + PROTO_HEADER_BYTES, PROTO_GAP_BYTES - 1U, &gap_got) == 0) {
+        fprintf(stderr, "short GAP accepted\n");
+        return -1;
+    }
+    return 0;
+}
+
+/* STATS round trip, stage summaries saturating at UINT32_MAX ns, unknown stages dropped. */
+static int test_stats(void)
+{
+    uint8_t buf[PROTO_HEADER_BYTES + PROTO_STATS_BYTES + PROTO_STATS_STAGE_BYTES];
+    proto_header_t hdr;
+    proto_stats_t stats;
+    proto_stats_t got;
+    lat_hist_t hist;
+    uint32_t idx;
+    size_t len;
+
+    memset(&stats, 0, sizeof(stats));
+    memset(&got, 0, sizeof(got));
+    stats.mono_ns = 123456789012ULL;
+    stats.frames = 1000000U;
+    stats.drdy_timeouts = 1U;
+    stats.missed_drdy = 2U;
+    stats.overlong_xfers = 3U;
+    stats.ring_overflows = 4U;
+    stats.ring_high_water = 5U;
+    stats.msgs_dropped = 6U;
+    stats.missed_conversions = 7U;
+    stats.gap_events = 8U;
+    stats.ring_capacity = 65536U;
+    stats.stage_count = PROTO_STAGE_COUNT;
+    lat_hist_reset(&hist);
+    lat_hist_record(&hist, 1000U);
+    lat_hist_record(&hist, 10000000000ULL);
+    for (idx = 0U; idx < PROTO_STAGE_COUNT; ++idx) {
+        proto_stage_from_hist(&stats.stage[idx], &hist);
+    }
+    if (stats.stage[0].count != 2U || stats.stage[0].max_ns != UINT32_MAX) {
+        fprintf(stderr, "stage summary: count %" PRIu64 " max %" PRIu32 " ns\n", stats.stage[0].count,
+            stats.stage[0].max_ns);
+        return -1;
+    }
+    len = proto_encode_stats(buf, 9U, &stats);
+    if (len != PROTO_HEADER_BYTES + PROTO_STATS_BYTES || proto_decode_header(buf, &hdr) != 0 ||
+        hdr.type != PROTO_MSG_STATS || hdr.msg_seq != 9U ||
+        proto_decode_stats(buf + PROTO_HEADER_BYTES, hdr.payload_len, &got) != 0 ||
+        memcmp(&stats, &got, sizeof(stats)) != 0) {
+        fprintf(stderr, "STATS does not round-trip\n");
+        return -1;
+    }
+    if (proto_decode_stats(buf + PROTO_HEADER_BYTES, PROTO_STATS_BYTES - 1U, &got) == 0) {
+        fprintf(stderr, "short STATS accepted\n");
+        return -1;
+    }
+
+    /* A newer server's extra stage is skipped. */
+    proto_store_u16(buf + PROTO_HEADER_BYTES + PROTO_STATS_HEADER_BYTES - 4U, (uint16_t)(PROTO_STAGE_COUNT + 1U));
+    memset(buf + PROTO_HEADER_BYTES + PROTO_STATS_BYTES, 0xA5, PROTO_STATS_STAGE_BYTES);
+    if (proto_decode_stats(buf + PROTO_HEADER_BYTES, PROTO_STATS_BYTES + PROTO_STATS_STAGE_BYTES, &got) != 0 ||
+        memcmp(&stats, &got, sizeof(stats)) != 0) {
+        fprintf(stderr, "STATS with an unknown stage does not decode\n");
+        return -1;
+    }
+    return 0;
+}
+
+/* SUMMARY round trip at the largest channel count; a channel count past ADS1278_MAX_CHANNELS is refused. */
+static int test_summary(void)
+{
+    static uint8_t buf[PROTO_HEADER_BYTES + PROTO_SUMMARY_BYTES(ADS1278_MAX_CHANNELS)];
+    proto_header_t hdr;
+    proto_summary_t summary;
+    proto_summary_t got;
+    uint32_t channel;
+    size_t len;
+
+    memset(&summary, 0, sizeof(summary));
+    memset(&got, 0, sizeof(got));
+    summary.mono_ns = 987654321U;
+    summary.first_seq = 1000U;
+    summary.last_seq = 1999U;
+    summary.frames = 1000U;
+    summary.first_tstamp_ns = 1000000U;
+    summary.last_tstamp_ns = 1999000U;
+    summary.channel_count = ADS1278_MAX_CHANNELS;
+    summary.flags = PROTO_SUMMARY_VOLTS;
+    for (channel = 0U; channel < ADS1278_MAX_CHANNELS; ++channel) {
+        summary.ch[channel].min = -2.5 + (channel * 0.125);
+        summary.ch[channel].max = 2.5 - (channel * 0.0625);
+        summary.ch[channel].mean = 1e-6 * channel;
+        summary.ch[channel].rms = 0.7071067811865476 / (channel + 1U);
+        summary.ch[channel].stddev = 3e-7 * (channel + 1U);
+    }
+    len = proto_encode_summary(buf, 11U, &summary);
+    if (len != PROTO_HEADER_BYTES + PROTO_SUMMARY_BYTES(ADS1278_MAX_CHANNELS) || proto_decode_header(buf, &hdr) != 0 ||
+        hdr.type != PROTO_MSG_SUMMARY || hdr.msg_seq != 11U ||
+        proto_decode_summary(buf + PROTO_HEADER_BYTES, hdr.payload_len, &got) != 0 ||
+        memcmp(&summary, &got, sizeof(summary)) != 0) {
+        fprintf(stderr, "SUMMARY does not round-trip\n");
+        return -1;
+    }
+    if (proto_decode_summary(buf + PROTO_HEADER_BYTES, hdr.payload_len - 1U, &got) == 0) {
+        fprintf(stderr, "short SUMMARY accepted\n");
+        return -1;
+    }
+    proto_store_u16(buf + PROTO_HEADER_BYTES + 48, (uint16_t)(ADS1278_MAX_CHANNELS + 1U));
+    if (proto_decode_summary(buf + PROTO_HEADER_BYTES, hdr.payload_len, &got) == 0) {
+        fprintf(stderr, "SUMMARY with %u channels accepted\n", ADS1278_MAX_CHANNELS + 1U);
+        return -1;
+    }
+    return 0;
+}
+
+/* SPECTRUM round trip of header and f32 bins, bins past max_bins left alone. */
+static int test_spectrum(void)
+{
+    enum { BINS = 16 };
+    uint8_t buf[PROTO_HEADER_BYTES + PROTO_SPECTRUM_BYTES(BINS)];
+    proto_header_t hdr;
+    proto_spectrum_t spectrum;
+    proto_spectrum_t got;
+    float bins[BINS];
+    float got_bins[BINS];
+    uint32_t idx;
+    size_t len;
+
+    memset(&spectrum, 0, sizeof(spectrum));
+    memset(&got, 0, sizeof(got));
+    spectrum.mono_ns = 555U;
+    spectrum.result_id = 42U;
+    spectrum.first_seq = 100U;
+    spectrum.last_seq = 4195U;
+    spectrum.bin_hz = 12.20703125;
+    spectrum.enbw_hz = 18.310546875;
+    spectrum.fft_size = 4096U;
+    spectrum.segments = 3U;
+    spectrum.channel = 5U;
+    spectrum.window = 1U;
+    spectrum.flags = PROTO_SPECTRUM_VOLTS;
+    spectrum.bin_group = 128U;
+    spectrum.bin_count = BINS;
+    for (idx = 0U; idx < BINS; ++idx) {
+        bins[idx] = 1e-12f * (float)(idx + 1U);
+        got_bins[idx] = -1.0f;
+    }
+    len = proto_encode_spectrum(buf, 12U, &spectrum, bins);
+    if (len != sizeof(buf) || proto_decode_header(buf, &hdr) != 0 || hdr.type != PROTO_MSG_SPECTRUM ||
+        hdr.msg_seq != 12U ||
+        proto_decode_spectrum(buf + PROTO_HEADER_BYTES, hdr.payload_len, &got, got_bins, BINS / 2U) != 0 ||
+        memcmp(&spectrum, &got, sizeof(spectrum)) != 0 ||
+        memcmp(bins, got_bins, (BINS / 2U) * sizeof(bins[0])) != 0 || got_bins[BINS / 2U] != -1.0f) {
+        fprintf(stderr, "SPECTRUM does not round-trip\n");
+        return -1;
+    }
+    if (proto_decode_spectrum(buf + PROTO_HEADER_BYTES, hdr.payload_len - 1U, &got, NULL, 0U) == 0) {
+        fprintf(stderr, "short SPECTRUM accepted\n");
+        return -1;
+    }
+    return 0;
+}
+
+/* Every encoding, jittered timestamps and a missed conversion every TEST_PROTO_GAP_EVERY frames. */
+static int test_data_encodings(void)
+{
+    static const uint16_t encodings[] = {PROTO_DATA_ENC_RECORD48, PROTO_DATA_ENC_P24, PROTO_DATA_ENC_DELTA};
+    ads1278_frame_t *src = malloc(TEST_PROTO_FRAMES * sizeof(*src));
+    wire_result_t res;
+    size_t idx;
+    int rc = -1;
+
+    if (src == NULL) {
+        perror("malloc");
+        return -1;
+    }
+    fill_wire_frames(src, TEST_PROTO_FRAMES, true, TEST_PROTO_GAP_EVERY);
+    for (idx = 0U; idx < sizeof(encodings) / sizeof(encodings[0]); ++idx) {
+        if (wire_round_trip(encodings[idx], ADS1278_CHANNEL_COUNT, src, TEST_PROTO_FRAMES, false, 0U, &res) != 0) {
+            goto out;
+        }
+        if (res.linear_msgs != 0U || res.gap_msgs != 0U) {
+            fprintf(stderr, "wire %s: %" PRIu64 " linear and %" PRIu64 " gapped message(s) unasked\n",
+                proto_data_encoding_name(encodings[idx]), res.linear_msgs, res.gap_msgs);
+            goto out;
+        }
+    }
+    rc = 0;
+
+out:
+    free(src);
+    return rc;
+}
+
+/* Timestamps on an exact grid go out as base + last; jittered ones keep their deltas. */
+static int test_linear_ts(void)
+{
+    static const uint16_t encodings[] = {PROTO_DATA_ENC_P24, PROTO_DATA_ENC_DELTA};
+    ads1278_frame_t *src = malloc(TEST_PROTO_FRAMES * sizeof(*src));
+    wire_result_t res;
+    size_t idx;
+    int rc = -1;
+
+    if (src == NULL) {
+        perror("malloc");
+        return -1;
+    }
+    for (idx = 0U; idx < sizeof(encodings) / sizeof(encodings[0]); ++idx) {
+        const char *name = proto_data_encoding_name(encodings[idx]);
+
+        fill_wire_frames(src, TEST_PROTO_FRAMES, false, TEST_PROTO_GAP_EVERY);
+        if (wire_round_trip(encodings[idx], ADS1278_CHANNEL_COUNT, src, TEST_PROTO_FRAMES, true, 0U, &res) != 0) {
+            goto out;
+        }
+        if (res.linear_msgs != res.msgs) {
+            fprintf(stderr, "wire %s: %" PRIu64 " of %" PRIu64 " grid message(s) linear\n", name, res.linear_msgs,
+                res.msgs);
+            goto out;
+        }
+        fill_wire_frames(src, TEST_PROTO_FRAMES, true, TEST_PROTO_GAP_EVERY);
+        if (wire_round_trip(encodings[idx], ADS1278_CHANNEL_COUNT, src, TEST_PROTO_FRAMES, true, 0U, &res) != 0) {
+            goto out;
+        }
+        if (res.linear_msgs == res.msgs) {
+            fprintf(stderr, "wire %s: jittered timestamps sent as exact lines\n", name);
+            goto out;
+        }
+    }
+    rc = 0;
+
+out:
+    free(src);
+    return rc;
+}
+
+/* Frequent missed conversions ride inside P24/DELTA messages up to max_gaps, with and without linear_ts. */
+static int test_seq_gaps(void)
+{
+    static const uint16_t encodings[] = {PROTO_DATA_ENC_P24, PROTO_DATA_ENC_DELTA};
+    static const uint32_t k_max_gaps[] = {1U, 4U, PROTO_DATA_MAX_GAPS};
+    ads1278_frame_t *src = malloc(TEST_PROTO_FRAMES * sizeof(*src));
+    wire_result_t plain;
+    wire_result_t res;
+    size_t idx;
+    size_t g;
+    int rc = -1;
+
+    if (src == NULL) {
+        perror("malloc");
+        return -1;
+    }
+    fill_wire_frames(src, TEST_PROTO_FRAMES, false, 37U);
+    for (idx = 0U; idx < sizeof(encodings) / sizeof(encodings[0]); ++idx) {
+        const char *name = proto_data_encoding_name(encodings[idx]);
+
+        if (wire_round_trip(encodings[idx], ADS1278_CHANNEL_COUNT, src, TEST_PROTO_FRAMES, true, 0U, &plain) != 0) {
+            goto out;
+        }
+        for (g = 0U; g < sizeof(k_max_gaps) / sizeof(k_max_gaps[0]); ++g) {
+            if (wire_round_trip(encodings[idx], ADS1278_CHANNEL_COUNT, src, TEST_PROTO_FRAMES, g != 0U,
+                                k_max_gaps[g], &res) != 0) {
+                goto out;
+            }
+            if (res.gap_msgs == 0U || res.msgs >= plain.msgs || (g != 0U && res.linear_msgs != res.msgs)) {
+                fprintf(stderr, "wire %s max_gaps %" PRIu32 ": %" PRIu64 " message(s) (%" PRIu64 " without), %"
+                    PRIu64 " with gaps, %" PRIu64 " linear\n", name, k_max_gaps[g], res.msgs, plain.msgs,
+                    res.gap_msgs, res.linear_msgs);
+                goto out;
+            }
+        }
+    }
+    rc = 0;
+
+out:
+    free(src);
+    return rc;
+}
+
+/* P24/DELTA carry every chained channel; RECORD48 only a single device's 8. */
+static int test_chain_channels(void)
+{
+    static const uint16_t encodings[] = {PROTO_DATA_ENC_P24, PROTO_DATA_ENC_DELTA};
+    ads1278_frame_t *src = malloc(TEST_PROTO_FRAMES * sizeof(*src));
+    proto_data_encoder_t enc;
+    wire_result_t res;
+    uint32_t channels;
+    size_t idx;
+    int rc = -1;
+
+    if (src == NULL) {
+        perror("malloc");
+        return -1;
+    }
+    fill_wire_frames(src, TEST_PROTO_FRAMES, true, TEST_PROTO_GAP_EVERY);
+    for (channels = ADS1278_CHANNEL_COUNT; channels <= ADS1278_MAX_CHANNELS; channels += ADS1278_CHANNEL_COUNT) {
+        for (idx = 0U; idx < sizeof(encodings) / sizeof(encodings[0]); ++idx) {
+            if (wire_round_trip(encodings[idx], channels, src, TEST_PROTO_FRAMES, false, 0U, &res) != 0) {
+                fprintf(stderr, "wire: %u channel(s) failed\n", channels);
+                goto out;
+            }
+        }
+    }
+    if (proto_data_max_bytes(PROTO_DATA_ENC_RECORD48, 2U * ADS1278_CHANNEL_COUNT, 1U) != 0U ||
+        proto_data_encoder_init(&enc, PROTO_DATA_ENC_RECORD48, 2U * ADS1278_CHANNEL_COUNT, 1U) == 0) {
+        fprintf(stderr, "wire record48: accepted more than %u channels\n", ADS1278_CHANNEL_COUNT);
+        goto out;
+    }
+    rc = 0;
+
+out:
+    free(src);
+    return rc;
+}
+
+/* P24 channel-major decode against the frame decoder. */
+static int test_p24_soa(void)
+{
+    proto_data_encoder_t enc;
+    proto_data_info_t info;
+    uint8_t *msg = malloc(proto_data_max_bytes(PROTO_DATA_ENC_P24, ADS1278_MAX_CHANNELS, TEST_PROTO_PER_MSG));
+    ads1278_frame_t *src = malloc(TEST_PROTO_PER_MSG * sizeof(*src));
+    int32_t *storage = malloc((size_t)TEST_PROTO_PER_MSG * ADS1278_MAX_CHANNELS * sizeof(*storage));
+    int32_t *ch[ADS1278_MAX_CHANNELS];
+    uint32_t channel;
+    uint32_t idx;
+    size_t len;
+    int rc = -1;
+
+    if (msg == NULL || src == NULL || storage == NULL ||
+        proto_data_encoder_init(&enc, PROTO_DATA_ENC_P24, ADS1278_MAX_CHANNELS, TEST_PROTO_PER_MSG) != 0) {
+        perror("p24 setup");
+        free(msg);
+        free(src);
+        free(storage);
+        return -1;
+    }
+    for (channel = 0U; channel < ADS1278_MAX_CHANNELS; ++channel) {
+        ch[channel] = storage + ((size_t)channel * TEST_PROTO_PER_MSG);
+    }
+    fill_wire_frames(src, TEST_PROTO_PER_MSG, true, TEST_PROTO_GAP_EVERY);
+    proto_data_begin(&enc, msg, 0U, src);
+    if (proto_data_append(&enc, src, TEST_PROTO_PER_MSG) != TEST_PROTO_PER_MSG) {
+        fprintf(stderr, "p24: message did not take %u frames\n", TEST_PROTO_PER_MSG);
+        goto out;
+    }
+    len = proto_data_finish(&enc);
+    if (proto_decode_data_info(msg + PROTO_HEADER_BYTES, len - PROTO_HEADER_BYTES, &info) != 0) {
+        fprintf(stderr, "p24: message does not parse\n");
+        goto out;
+    }
+    proto_data_p24_samples_soa(&info, ch);
+    for (idx = 0U; idx < TEST_PROTO_PER_MSG; ++idx) {
+        for (channel = 0U; channel < ADS1278_MAX_CHANNELS; ++channel) {
+            if (ch[channel][idx] != src[idx].ch[channel]) {
+                fprintf(stderr, "p24 soa: frame %" PRIu32 " ch%u differs\n", idx, channel + 1U);
+                goto out;
+            }
+        }
+    }
+    rc = 0;
+
+out:
+    proto_data_encoder_destroy(&enc);
+    free(msg);
+    free(src);
+    free(storage);
+    return rc;
+}
+
+int main(void)
+{
+    static const test_case_t cases[] = {
+        {"header magic, version and size", test_header},
+        {"HELLO/CONFIG/SUBSCRIBE/GAP", test_control},
+        {"STATS", test_stats},
+        {"SUMMARY", test_summary},
+        {"SPECTRUM", test_spectrum},
+        {"DATA round trip per encoding", test_data_encodings},
+        {"linear timestamps", test_linear_ts},
+        {"seq gap lists", test_seq_gaps},
+        {"chained channel counts", test_chain_channels},
+        {"P24 channel-major decode", test_p24_soa}
+    };
+
+    return test_run("proto", cases, sizeof(cases) / sizeof(cases[0]));
+}
@@ -0,0 +1,443 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Miguel Dovale (University of Arizona)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Welch power spectral density: the real FFT against a long double DFT,
+ * bin-centred tone power in codes and volts, the rate estimated from
+ * timestamps, bin grouping against averaging the full result, a flat
+ * white-noise floor for every window, and a seq gap dropping the partial
+ * segment.
+ */
+
+#include "psd.h"
+#include "test_util.h"
+
+#include <math.h>
+
+#define TEST_PSD_FRAMES (16384U * 8U)
+#define TEST_PSD_MAX_BINS 1024U
+#define TEST_PSD_PERIOD_NS 20000U          /* 50 kHz */
+#define TEST_PSD_FFT_MAX_ERR 1e-12         /* relative to the largest bin */
+#define TEST_PSD_TONE_MAX_ERR 1e-6
+#define TEST_PSD_NOISE_MAX_ERR 0.03
+
+static ads1278_frame_t g_frames[TEST_PSD_FRAMES];
+static float g_keep[TEST_PSD_MAX_BINS * ADS1278_MAX_CHANNELS];
+static float g_keep2[TEST_PSD_MAX_BINS * ADS1278_MAX_CHANNELS];
+
+static double rel_err(double got, double want)
+{
+    return fabs(got - want) / fmax(fabs(want), 1e-300);
+}
+
+/* Max |fft - dft| over the largest |dft| for one random input of n points. */
+static double psd_fft_error(uint32_t n, uint64_t seed)
+{
+    psd_rfft_t *fft = NULL;
+    double *in = malloc(n * sizeof(*in));
+    double *out = malloc(((size_t)n + 2U) * sizeof(*out));
+    long double *cosine = malloc(n * sizeof(*cosine));
+    double max_err = -1.0;
+    double max_mag = 0.0;
+    uint32_t j;
+    uint32_t k;
+
+    if (in == NULL || out == NULL || cosine == NULL || psd_rfft_create(&fft, n) != 0) {
+        goto out;
+    }
+    for (j = 0U; j < n; ++j) {
+        in[j] = (double)(int64_t)(xorshift64(&seed) % 16777216U) - 8388608.0;
+        cosine[j] = cosl(6.283185307179586476925286766559L * (long double)j / (long double)n);
+    }
+    psd_rfft_forward(fft, in, out);
+
+    /* Naive DFT with an exact table: e^(-i theta jk) = cos - i sin, sin via a quarter-turn shift. */
+    max_err = 0.0;
+    for (k = 0U; k <= n / 2U; ++k) {
+        long double re = 0.0L;
+        long double im = 0.0L;
+
+        for (j = 0U; j < n; ++j) {
+            uint32_t idx = (uint32_t)(((uint64_t)j * k) % n);
+
+            re += (long double)in[j] * cosine[idx];
+            im -= (long double)in[j] * cosine[(idx + (3U * n / 4U)) % n];
+        }
+        max_err = fmax(max_err, fabs(out[2U * k] - (double)re));
+        max_err = fmax(max_err, fabs(out[(2U * k) + 1U] - (double)im));
+        max_mag = fmax(max_mag, (double)sqrtl((re * re) + (im * im)));
+    }
+    max_err /= max_mag;
+
+out:
+    psd_rfft_destroy(fft);
+    free(in);
+    free(out);
+    free(cosine);
+    return max_err;
+}
+
+/*
+ * Channel c: a DC offset plus a tone centred on bin 8 + 13c of fft_size,
+ * amplitude decreasing with c, or with noise_bits uniform noise instead.
+ */
+static void fill_psd_frames(ads1278_frame_t *frames, size_t n, uint64_t seq0, uint32_t channels, uint32_t fft_size,
+                            uint32_t noise_bits, uint64_t seed)
+{
+    size_t i;
+    uint32_t c;
+
+    for (i = 0U; i < n; ++i) {
+        const uint64_t seq = seq0 + i;
+
+        frames[i].seq = seq;
+        frames[i].tstamp_ns = seq * TEST_PSD_PERIOD_NS;
+        for (c = 0U; c < channels; ++c) {
+            const double amplitude = (double)(2000000U >> (c % 4U));
+            const double cycles = (double)(8U + (13U * c)) * (double)(seq % fft_size) / (double)fft_size;
+            double v = 100000.0 * (double)c + ((noise_bits != 0U) ? 0.0 : amplitude * sin(6.283185307179586 * cycles));
+
+            if (noise_bits != 0U) {
+                v += (double)(int64_t)(xorshift64(&seed) & (((uint64_t)1 << noise_bits) - 1U)) -
+                     (double)((int64_t)1 << (noise_bits - 1U));
+            }
+            frames[i].ch[c] = (int32_t)lround(v);
+        }
+    }
+}
+
+/* Feed every frame, keeping a copy of the last result's densities in keep. */
+static int psd_feed(psd_t *psd, const ads1278_frame_t *frames, size_t n, psd_result_t *last, float *keep)
+{
+    int results = 0;
+
+    while (n != 0U) {
+        psd_result_t result;
+        size_t used = psd_process(psd, frames, n, &result);
+
+        if (result.bins != 0U) {
+            uint32_t c;
+
+            *last = result;
+            for (c = 0U; c < result.channel_count; ++c) {
+                memcpy(keep + ((size_t)c * result.bins), result.psd[c], result.bins * sizeof(*keep));
+                last->psd[c] = keep + ((size_t)c * result.bins);
+            }
+            ++results;
+        }
+        frames += used;
+        n -= used;
+    }
+    return results;
+}
+
+/* Tone power (sum over the peak +- 4 bins times bin_hz) against amplitude^2 / 2 per channel. */
+static int check_psd_tones(const psd_result_t *r, uint32_t fft_size, const char *label, double volts_scale)
+{
+    double worst = 0.0;
+    uint32_t c;
+
+    for (c = 0U; c < r->channel_count; ++c) {
+        const uint32_t bin = 8U + (13U * c);
+        const double amplitude = (double)(2000000U >> (c % 4U)) * volts_scale;
+        double power = 0.0;
+        uint32_t k;
+
+        if (bin + 4U >= fft_size / 2U) {
+            continue;
+        }
+        for (k = bin - 4U; k <= bin + 4U; ++k) {
+            power += (double)r->psd[c][k] * r->bin_hz;
+            if (k != bin && r->psd[c][k] >= r->psd[c][bin]) {
+                fprintf(stderr, "%s: ch %u peak at bin %u, want %u\n", label, c + 1U, k, bin);
+                return -1;
+            }
+        }
+        worst = fmax(worst, rel_err(power, amplitude * amplitude / 2.0));
+    }
+    if (!(worst <= TEST_PSD_TONE_MAX_ERR)) {
+        fprintf(stderr, "%s: tone power error %.3g\n", label, worst);
+        return -1;
+    }
+    return 0;
+}
+
+/* The 1024-point, 16-segment tone configuration every tone case starts from. */
+static int tone_cfg(psd_cfg_t *cfg)
+{
+    if (psd_parse_spec("fft=1024,avg=16,detrend=1", cfg) != 0) {
+        fprintf(stderr, "psd_parse_spec rejected the tone spec\n");
+        return -1;
+    }
+    cfg->channel_count = ADS1278_CHANNEL_COUNT;
+    cfg->sample_rate_hz = 1e9 / TEST_PSD_PERIOD_NS;
+    fill_psd_frames(g_frames, 1024U * 9U, 0U, ADS1278_CHANNEL_COUNT, 1024U, 0U, 1U);
+    return 0;
+}
+
+static int test_rfft(void)
+{
+    static const uint32_t k_sizes[] = {16U, 1024U, 4096U};
+    size_t idx;
+
+    for (idx = 0U; idx < sizeof(k_sizes) / sizeof(k_sizes[0]); ++idx) {
+        double err = psd_fft_error(k_sizes[idx], 0x2545F4914F6CDD1DULL + idx);
+
+        if (!(err >= 0.0 && err <= TEST_PSD_FFT_MAX_ERR)) {
+            fprintf(stderr, "real FFT of %u points off the DFT by %.3g\n", k_sizes[idx], err);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/* Bin-centred tones: all their power lands within a few bins of the peak. */
+static int test_tones(void)
+{
+    psd_t *psd = NULL;
+    psd_cfg_t cfg;
+    psd_result_t result;
+    int rc = -1;
+
+    memset(&result, 0, sizeof(result));
+    if (tone_cfg(&cfg) != 0) {
+        return -1;
+    }
+    if (psd_create(&psd, &cfg) != 0) {
+        perror("psd_create");
+        return -1;
+    }
+    if (psd_feed(psd, g_frames, 1024U * 9U, &result, g_keep) != 1 || result.segments != 16U ||
+        result.first_seq != 0U || result.last_seq != (512U * 17U) - 1U || result.bins != 513U) {
+        fprintf(stderr, "%u segment(s), seq %" PRIu64 "..%" PRIu64 ", %u bin(s)\n", result.segments,
+            result.first_seq, result.last_seq, result.bins);
+        goto out;
+    }
+    rc = check_psd_tones(&result, 1024U, "hann, 16 x 50% overlap", 1.0);
+
+out:
+    psd_destroy(psd);
+    return rc;
+}
+
+/* Volts: the same spectrum times scale^2; the offset is detrended away. */
+static int test_volts(void)
+{
+    psd_t *psd = NULL;
+    psd_cfg_t cfg;
+    psd_result_t result;
+    chan_calib_t cal;
+    uint32_t c;
+    int rc = -1;
+
+    memset(&result, 0, sizeof(result));
+    if (tone_cfg(&cfg) != 0) {
+        return -1;
+    }
+    chan_calib_init(&cal, ADS1278_CHANNEL_COUNT, CHAN_CALIB_DEFAULT_VREF);
+    for (c = 0U; c < ADS1278_CHANNEL_COUNT; ++c) {
+        cal.offset[c] = 0.01f * (float)c;
+    }
+    cfg.calib = &cal;
+    if (psd_create(&psd, &cfg) != 0) {
+        perror("psd_create");
+        return -1;
+    }
+    if (psd_feed(psd, g_frames, 1024U * 9U, &result, g_keep) != 1 || !result.volts) {
+        fprintf(stderr, "no volts result\n");
+        goto out;
+    }
+    rc = check_psd_tones(&result, 1024U, "volts", (double)cal.scale[0]);
+
+out:
+    psd_destroy(psd);
+    return rc;
+}
+
+/* Rate from timestamps, and bin grouping equal to averaging the full result. */
+static int test_grouping(void)
+{
+    psd_t *psd = NULL;
+    psd_cfg_t cfg;
+    psd_result_t result;
+    psd_result_t grouped;
+    uint32_t c;
+    int rc = -1;
+
+    memset(&result, 0, sizeof(result));
+    memset(&grouped, 0, sizeof(grouped));
+    if (tone_cfg(&cfg) != 0) {
+        return -1;
+    }
+    cfg.sample_rate_hz = 0.0;
+    if (psd_create(&psd, &cfg) != 0 || psd_feed(psd, g_frames, 1024U * 9U, &result, g_keep) != 1 ||
+        rel_err(result.sample_rate_hz, 1e9 / TEST_PSD_PERIOD_NS) > 1e-12) {
+        fprintf(stderr, "estimated rate %.6f Hz\n", result.sample_rate_hz);
+        goto out;
+    }
+    psd_destroy(psd);
+    psd = NULL;
+    cfg.max_bins = 64U;
+    if (psd_create(&psd, &cfg) != 0 || psd_feed(psd, g_frames, 1024U * 9U, &grouped, g_keep2) != 1 ||
+        grouped.bin_group != 9U || grouped.bins != 57U) {
+        fprintf(stderr, "bins=64 gave %u bins of %u\n", grouped.bins, grouped.bin_group);
+        goto out;
+    }
+    for (c = 0U; c < ADS1278_CHANNEL_COUNT; ++c) {
+        uint32_t k;
+
+        for (k = 0U; k < grouped.bins; ++k) {
+            double sum = 0.0;
+            uint32_t j;
+            uint32_t count = 0U;
+
+            for (j = k * 9U; j < (k + 1U) * 9U && j < result.bins; ++j) {
+                sum += result.psd[c][j];
+                ++count;
+            }
+            if (rel_err(grouped.psd[c][k], sum / count) > 1e-5 && fabs(grouped.psd[c][k] - sum / count) > 1e-30) {
+                fprintf(stderr, "grouped bin %u of ch %u is %g, want %g\n", k, c + 1U, grouped.psd[c][k],
+                    sum / count);
+                goto out;
+            }
+        }
+    }
+    rc = 0;
+
+out:
+    psd_destroy(psd);
+    return rc;
+}
+
+/* White noise: flat at 2 sigma^2 / fs, whatever the window (Parseval). */
+static int test_white_noise(void)
+{
+    static const char *const k_windows[] = {"hann", "rect", "bh"};
+    const double fs = 1e9 / TEST_PSD_PERIOD_NS;
+    const double want = 2.0 * ((double)(1U << 20) * (double)(1U << 20) / 12.0) / fs;
+    psd_cfg_t cfg;
+    psd_result_t result;
+    size_t idx;
+
+    memset(&result, 0, sizeof(result));
+    fill_psd_frames(g_frames, TEST_PSD_FRAMES, 0U, ADS1278_CHANNEL_COUNT, 1024U, 20U, 99U);
+    for (idx = 0U; idx < sizeof(k_windows) / sizeof(k_windows[0]); ++idx) {
+        psd_t *psd = NULL;
+        char spec[64];
+        double worst = 0.0;
+        uint32_t c;
+
+        snprintf(spec, sizeof(spec), "fft=1024,avg=200,detrend=1,window=%s", k_windows[idx]);
+        if (psd_parse_spec(spec, &cfg) != 0) {
+            fprintf(stderr, "psd_parse_spec rejected %s\n", spec);
+            return -1;
+        }
+        cfg.channel_count = ADS1278_CHANNEL_COUNT;
+        cfg.sample_rate_hz = fs;
+        if (psd_create(&psd, &cfg) != 0) {
+            perror("psd_create");
+            return -1;
+        }
+        if (psd_feed(psd, g_frames, TEST_PSD_FRAMES, &result, g_keep) < 1) {
+            fprintf(stderr, "%s: no result\n", k_windows[idx]);
+            psd_destroy(psd);
+            return -1;
+        }
+        psd_destroy(psd);
+        for (c = 0U; c < ADS1278_CHANNEL_COUNT; ++c) {
+            double mean = 0.0;
+            uint32_t k;
+
+            for (k = 1U; k < result.bins - 1U; ++k) {
+                mean += result.psd[c][k];
+            }
+            mean /= (double)(result.bins - 2U);
+            worst = fmax(worst, rel_err(mean, want));
+        }
+        if (!(worst <= TEST_PSD_NOISE_MAX_ERR)) {
+            fprintf(stderr, "%s: density error %.3g\n", k_windows[idx], worst);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/* A seq gap drops the partial segment; the next segment starts after it. */
+static int test_seq_gap(void)
+{
+    psd_t *psd = NULL;
+    psd_cfg_t cfg;
+    psd_result_t result;
+    psd_stats_t stats;
+    int rc = -1;
+
+    memset(&result, 0, sizeof(result));
+    if (psd_parse_spec("fft=256,hop=256,avg=2", &cfg) != 0) {
+        fprintf(stderr, "psd_parse_spec rejected the gap spec\n");
+        return -1;
+    }
+    cfg.channel_count = ADS1278_CHANNEL_COUNT;
+    fill_psd_frames(g_frames, 100U, 0U, ADS1278_CHANNEL_COUNT, 256U, 0U, 1U);
+    fill_psd_frames(g_frames + 100U, 512U, 1000U, ADS1278_CHANNEL_COUNT, 256U, 0U, 1U);
+    if (psd_create(&psd, &cfg) != 0) {
+        perror("psd_create");
+        return -1;
+    }
+    if (psd_feed(psd, g_frames, 612U, &result, g_keep) != 1) {
+        fprintf(stderr, "no result after the gap\n");
+        goto out;
+    }
+    psd_get_stats(psd, &stats);
+    if (stats.gaps != 1U || result.first_seq != 1000U || result.last_seq != 1511U) {
+        fprintf(stderr, "%" PRIu64 " gap(s), result seq %" PRIu64 "..%" PRIu64 "\n", stats.gaps,
+            result.first_seq, result.last_seq);
+        goto out;
+    }
+    rc = 0;
+
+out:
+    psd_destroy(psd);
+    return rc;
+}
+
+int main(void)
+{
+    static const test_case_t cases[] = {
+        {"real FFT against a long double DFT", test_rfft},
+        {"bin-centred tone power", test_tones},
+        {"tone power in volts", test_volts},
+        {"rate from timestamps, bin grouping", test_grouping},
+        {"white noise floor per window", test_white_noise},
+        {"seq gap drops the partial segment", test_seq_gap}
+    };
+
+    return test_run("psd", cases, sizeof(cases) / sizeof(cases[0]));
+}
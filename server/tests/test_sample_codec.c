@@ -0,0 +1,198 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Miguel Dovale (University of Arizona)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Delta/zigzag/bit-pack sample codec: bit-exact round trips of quiet, sine,
+ * ramp and full-scale noise signals at block sizes around the group size,
+ * strided and contiguous, decoded in uneven reads, with
+ * sample_codec_stream_bytes() agreeing with the encoder.
+ */
+
+#include "sample_codec.h"
+#include "test_util.h"
+
+#include <math.h>
+
+#define TEST_CODEC_FRAMES 4096U
+#define TEST_CODEC_RATE_HZ 52734.0
+
+typedef enum {
+    CODEC_SIGNAL_QUIET = 0,     /* +/-4 LSB noise on a per-channel offset */
+    CODEC_SIGNAL_SINE,          /* 1 kHz at 1/8 full scale plus +/-16 LSB noise */
+    CODEC_SIGNAL_RAMP,          /* the sim backend's ramp */
+    CODEC_SIGNAL_NOISE,         /* full-scale white noise, the incompressible case */
+    CODEC_SIGNAL_EXTREMES,      /* alternating int32 extremes: 32-bit deltas */
+    CODEC_SIGNAL_COUNT
+} codec_signal_t;
+
+/* Interleaved frames of ADS1278_CHANNEL_COUNT samples. */
+static void fill_codec_signal(codec_signal_t signal, int32_t *dst, size_t n)
+{
+    uint64_t rng = 0x243F6A8885A308D3ULL;
+    uint32_t channel;
+    size_t idx;
+
+    for (idx = 0U; idx < n; ++idx) {
+        for (channel = 0U; channel < ADS1278_CHANNEL_COUNT; ++channel) {
+            int32_t noise = (int32_t)(xorshift64(&rng) % 9U) - 4;
+            double phase = 2.0 * 3.14159265358979323846 * 1000.0 * (double)idx / TEST_CODEC_RATE_HZ;
+            int32_t *out = &dst[(idx * ADS1278_CHANNEL_COUNT) + channel];
+
+            switch (signal) {
+                case CODEC_SIGNAL_QUIET:
+                    *out = ((int32_t)channel * 1000) - 3500 + noise;
+                    break;
+                case CODEC_SIGNAL_SINE:
+                    *out = (int32_t)((double)(ADS1278_SAMPLE_MAX / 8) * sin(phase + (double)channel)) + (noise * 4);
+                    break;
+                case CODEC_SIGNAL_RAMP:
+                    *out = sim_ramp_value(idx, channel);
+                    break;
+                case CODEC_SIGNAL_NOISE:
+                    *out = (int32_t)((uint32_t)xorshift64(&rng) << 8U) >> 8;
+                    break;
+                default:
+                    *out = ((idx + channel) % 2U == 0U) ? INT32_MAX : INT32_MIN;
+                    break;
+            }
+        }
+    }
+}
+
+/* Every channel of n frames from src: encoded strided, decoded in reads of 1..13 values. */
+static int codec_round_trip(const int32_t *src, size_t n, uint8_t *packed, int32_t *decoded)
+{
+    uint32_t channel;
+
+    for (channel = 0U; channel < ADS1278_CHANNEL_COUNT; ++channel) {
+        sample_codec_reader_t rd;
+        size_t len = sample_codec_encode(src + channel, ADS1278_CHANNEL_COUNT, n, packed);
+        size_t done = 0U;
+        size_t step = 1U;
+        size_t idx;
+
+        if (len > sample_codec_max_bytes(n) || sample_codec_stream_bytes(packed, len, n) != len ||
+            (len != 0U && sample_codec_stream_bytes(packed, len - 1U, n) != 0U)) {
+            fprintf(stderr, "codec: ch%u of %zu frames: %zu byte(s), stream_bytes disagrees\n", channel + 1U, n,
+                len);
+            return -1;
+        }
+        if (sample_codec_encode(src + channel, ADS1278_CHANNEL_COUNT, n, packed + len) != len ||
+            memcmp(packed, packed + len, len) != 0) {
+            fprintf(stderr, "codec: ch%u of %zu frames does not encode the same twice\n", channel + 1U, n);
+            return -1;
+        }
+        sample_codec_reader_init(&rd, packed, n);
+        while (done < n) {
+            size_t count = (step < n - done) ? step : n - done;
+
+            sample_codec_read(&rd, count, decoded + done, 1U);
+            done += count;
+            step = (step % 13U) + 1U;
+        }
+        for (idx = 0U; idx < n; ++idx) {
+            if (decoded[idx] != src[(idx * ADS1278_CHANNEL_COUNT) + channel]) {
+                fprintf(stderr, "codec: ch%u of %zu frames: value %zu is %" PRId32 ", want %" PRId32 "\n",
+                    channel + 1U, n, idx, decoded[idx], src[(idx * ADS1278_CHANNEL_COUNT) + channel]);
+                return -1;
+            }
+        }
+    }
+    return 0;
+}
+
+static int test_round_trip(void)
+{
+    static const size_t k_sizes[] = {0U, 1U, 2U, 31U, 32U, 33U, 64U, 255U, 256U, 1000U, TEST_CODEC_FRAMES};
+    int32_t *src = malloc(TEST_CODEC_FRAMES * ADS1278_CHANNEL_COUNT * sizeof(*src));
+    int32_t *decoded = malloc(TEST_CODEC_FRAMES * sizeof(*decoded));
+    uint8_t *packed = malloc(2U * sample_codec_max_bytes(TEST_CODEC_FRAMES));
+    codec_signal_t signal;
+    size_t idx;
+    int rc = -1;
+
+    if (src == NULL || decoded == NULL || packed == NULL) {
+        perror("malloc");
+        goto out;
+    }
+    for (signal = CODEC_SIGNAL_QUIET; signal < CODEC_SIGNAL_COUNT; ++signal) {
+        fill_codec_signal(signal, src, TEST_CODEC_FRAMES);
+        for (idx = 0U; idx < sizeof(k_sizes) / sizeof(k_sizes[0]); ++idx) {
+            if (codec_round_trip(src, k_sizes[idx], packed, decoded) != 0) {
+                fprintf(stderr, "codec: signal %d failed\n", (int)signal);
+                goto out;
+            }
+        }
+    }
+    rc = 0;
+
+out:
+    free(src);
+    free(decoded);
+    free(packed);
+    return rc;
+}
+
+/* A quiet channel packs to a few bits per sample; noise never exceeds the worst case. */
+static int test_ratio(void)
+{
+    int32_t *src = malloc(TEST_CODEC_FRAMES * ADS1278_CHANNEL_COUNT * sizeof(*src));
+    uint8_t *packed = malloc(sample_codec_max_bytes(TEST_CODEC_FRAMES));
+    size_t len;
+    int rc = -1;
+
+    if (src == NULL || packed == NULL) {
+        perror("malloc");
+        goto out;
+    }
+    fill_codec_signal(CODEC_SIGNAL_QUIET, src, TEST_CODEC_FRAMES);
+    len = sample_codec_encode(src, ADS1278_CHANNEL_COUNT, TEST_CODEC_FRAMES, packed);
+    if ((double)len * 8.0 / TEST_CODEC_FRAMES > 5.0) {
+        fprintf(stderr, "codec: quiet channel at %.2f bit/sample\n", (double)len * 8.0 / TEST_CODEC_FRAMES);
+        goto out;
+    }
+    rc = 0;
+
+out:
+    free(src);
+    free(packed);
+    return rc;
+}
+
+int main(void)
+{
+    static const test_case_t cases[] = {
+        {"round trips per signal and block size", test_round_trip},
+        {"quiet channel compresses", test_ratio}
+    };
+
+    return test_run("sample_codec", cases, sizeof(cases) / sizeof(cases[0]));
+}
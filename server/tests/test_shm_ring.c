@@ -0,0 +1,298 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Miguel Dovale (University of Arizona)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Shared-memory frame ring: one writer and several reader processes, fast
+ * ones and one that naps mid-batch so the writer overwrites slots it is
+ * still reading. release() must reject every overwritten frame, and each
+ * reader must account for every frame as read or lost. Flat out into a small
+ * ring the slow reader is lapped; paced at eight ADS1278s no fast reader
+ * loses anything.
+ */
+
+/* MAP_ANONYMOUS is hidden by a strict _POSIX_C_SOURCE. */
+#define _DEFAULT_SOURCE
+
+#include "shm_ring.h"
+#include "test_util.h"
+
+#include <errno.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define TEST_SHM_FRAMES 1000000U
+#define TEST_SHM_PACED_FRAMES 200000U
+#define TEST_SHM_PACED_FPS 421872U        /* eight ADS1278s at 52734 Hz */
+#define TEST_SHM_FAST_READERS 2U
+#define TEST_SHM_READERS (TEST_SHM_FAST_READERS + 1U)
+#define TEST_SHM_SMALL_RING_FRAMES 4096U
+#define TEST_SHM_BATCH 256U
+#define TEST_SHM_SLOW_BATCH 256U
+#define TEST_SHM_SLOW_NAP_NS 200000U      /* mid-batch, so the writer laps it while it reads */
+
+typedef struct {
+    atomic_bool ready;          /* reader attached */
+    int error;                  /* errno from shm_ring_reader_open(), 0 = ok */
+    uint64_t frames;            /* accepted by release() */
+    uint64_t laps;
+    uint64_t lost;
+    uint64_t torn_caught;       /* bad frames seen in place, then rejected by release() */
+    uint64_t torn_accepted;     /* bad frames release() accepted: must stay 0 */
+} shm_rx_result_t;
+
+typedef struct {
+    atomic_bool go;
+    shm_rx_result_t rx[TEST_SHM_READERS];
+} shm_shared_t;
+
+static bool shm_slot_ok(const shm_ring_slot_t *slot, uint64_t pos, uint32_t channels)
+{
+    ads1278_frame_t expect;
+
+    fill_synthetic_frame(&expect, pos);
+    return slot->seq == pos && slot->tstamp_ns == expect.tstamp_ns &&
+        memcmp(slot->ch, expect.ch, channels * sizeof(expect.ch[0])) == 0;
+}
+
+/*
+ * Child process: attach read-only and check every frame in place. A slow
+ * reader checks half a batch, sleeps, then checks the rest.
+ */
+static void shm_reader_main(const char *name, shm_shared_t *shared, uint32_t idx, uint32_t batch,
+                            uint64_t slow_nap_ns)
+{
+    shm_rx_result_t *res = &shared->rx[idx];
+    shm_ring_reader_t *r = NULL;
+    shm_ring_reader_stats_t stats;
+    uint32_t channels;
+    bool draining = false;
+
+    if (shm_ring_reader_open(&r, name, false) != 0) {
+        res->error = errno;
+        atomic_store(&res->ready, true);
+        _exit(1);
+    }
+    channels = shm_ring_reader_header(r)->channels;
+    atomic_store(&res->ready, true);
+    while (!atomic_load(&shared->go)) {
+        sched_yield();
+    }
+
+    for (;;) {
+        uint64_t first;
+        size_t n = shm_ring_reader_peek(r, &first, batch);
+        uint64_t bad = 0U;
+        size_t i;
+
+        if (n == 0U) {
+            if (draining) {
+                break;
+            }
+            /* One more pass after close: head is final by then. */
+            draining = shm_ring_reader_closed(r);
+            sched_yield();
+            continue;
+        }
+        for (i = 0; i < n; ++i) {
+            if (slow_nap_ns != 0U && i == n / 2U) {
+                nap_ns(slow_nap_ns);
+            }
+            bad += shm_slot_ok(shm_ring_reader_slot(r, first + i), first + i, channels) ? 0U : 1U;
+        }
+        if (shm_ring_reader_release(r, n) == 0) {
+            res->torn_accepted += bad;
+        } else {
+            res->torn_caught += bad;
+        }
+    }
+    shm_ring_reader_get_stats(r, &stats);
+    res->frames = stats.frames;
+    res->laps = stats.laps;
+    res->lost = stats.frames_lost;
+    shm_ring_reader_close(r);
+    _exit(0);
+}
+
+/* This process writes; the last reader is the slow one. fps = 0 publishes as fast as possible. */
+static int shm_run(uint64_t frames, uint64_t capacity, uint64_t fps)
+{
+    shm_shared_t *shared;
+    shm_ring_writer_t *w = NULL;
+    shm_ring_cfg_t cfg = {0};
+    ads1278_frame_t block[TEST_SHM_BATCH];
+    pid_t pids[TEST_SHM_READERS];
+    uint32_t spawned = 0U;
+    char name[64];
+    uint64_t seq = 0U;
+    uint64_t start;
+    uint32_t idx;
+    int rc = -1;
+
+    shared = mmap(NULL, sizeof(*shared), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (shared == MAP_FAILED) {
+        perror("mmap");
+        return -1;
+    }
+    memset(shared, 0, sizeof(*shared));
+    snprintf(name, sizeof(name), "/ads1278-test-%ld", (long)getpid());
+    cfg.name = name;
+    cfg.capacity = capacity;
+    cfg.channels = ADS1278_CHANNEL_COUNT;
+    if (shm_ring_writer_create(&w, &cfg) != 0) {
+        perror("shm_ring_writer_create");
+        goto out;
+    }
+
+    fflush(stdout);
+    fflush(stderr);
+    for (idx = 0U; idx < TEST_SHM_READERS; ++idx) {
+        pid_t pid = fork();
+
+        if (pid < 0) {
+            perror("fork");
+            goto out;
+        }
+        if (pid == 0) {
+            bool slow = (idx == TEST_SHM_READERS - 1U);
+
+            shm_reader_main(name, shared, idx, slow ? TEST_SHM_SLOW_BATCH : TEST_SHM_BATCH,
+                slow ? TEST_SHM_SLOW_NAP_NS : 0U);
+        }
+        pids[spawned++] = pid;
+    }
+    for (idx = 0U; idx < TEST_SHM_READERS; ++idx) {
+        while (!atomic_load(&shared->rx[idx].ready)) {
+            sched_yield();
+        }
+        if (shared->rx[idx].error != 0) {
+            errno = shared->rx[idx].error;
+            perror("shm_ring_reader_open");
+            goto out;
+        }
+    }
+
+    atomic_store(&shared->go, true);
+    start = now_ns();
+    while (seq < frames) {
+        uint64_t n = frames - seq;
+        uint64_t i;
+
+        if (n > TEST_SHM_BATCH) {
+            n = TEST_SHM_BATCH;
+        }
+        for (i = 0U; i < n; ++i) {
+            fill_synthetic_frame(&block[i], seq + i);
+        }
+        shm_ring_writer_publish(w, block, (size_t)n);
+        seq += n;
+        if (fps == 0U) {
+            /* Let readers in between blocks, as they would run beside us on other cores. */
+            sched_yield();
+        } else {
+            uint64_t due = start + (seq * 1000000000ULL) / fps;
+            uint64_t now = now_ns();
+
+            if (due > now) {
+                nap_ns(due - now);
+            }
+        }
+    }
+    shm_ring_writer_destroy(w);
+    w = NULL;
+
+    rc = 0;
+    for (idx = 0U; idx < spawned; ++idx) {
+        int status = 0;
+
+        if (waitpid(pids[idx], &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            fprintf(stderr, "shm: reader %u failed\n", idx);
+            rc = -1;
+        }
+    }
+    spawned = 0U;
+
+    for (idx = 0U; idx < TEST_SHM_READERS; ++idx) {
+        const shm_rx_result_t *res = &shared->rx[idx];
+        bool slow = (idx == TEST_SHM_READERS - 1U);
+
+        if (res->torn_accepted != 0U) {
+            fprintf(stderr, "shm: reader %u accepted %" PRIu64 " torn frame(s)\n", idx, res->torn_accepted);
+            rc = -1;
+        }
+        if (res->frames + res->lost != frames) {
+            fprintf(stderr, "shm: reader %u accounted for %" PRIu64 " of %" PRIu64 " frames\n", idx,
+                res->frames + res->lost, frames);
+            rc = -1;
+        }
+        if (fps == 0U && slow && res->laps == 0U) {
+            fprintf(stderr, "shm: slow reader was never lapped\n");
+            rc = -1;
+        }
+        if (fps != 0U && !slow && res->lost != 0U) {
+            fprintf(stderr, "shm: reader %u lost frames at %" PRIu64 " frames/s\n", idx, fps);
+            rc = -1;
+        }
+    }
+
+out:
+    shm_ring_writer_destroy(w);
+    for (idx = 0U; idx < spawned; ++idx) {
+        (void)kill(pids[idx], SIGKILL);
+        (void)waitpid(pids[idx], NULL, 0);
+    }
+    munmap(shared, sizeof(*shared));
+    return rc;
+}
+
+static int test_flat_out(void)
+{
+    return shm_run(TEST_SHM_FRAMES, TEST_SHM_SMALL_RING_FRAMES, 0U);
+}
+
+static int test_paced(void)
+{
+    return shm_run(TEST_SHM_PACED_FRAMES, SHM_RING_DEFAULT_FRAMES, TEST_SHM_PACED_FPS);
+}
+
+int main(void)
+{
+    static const test_case_t cases[] = {
+        {"flat out into a small ring", test_flat_out},
+        {"paced at 8 x 52734 frames/s", test_paced}
+    };
+
+    return test_run("shm_ring", cases, sizeof(cases) / sizeof(cases[0]));
+}
@@ -0,0 +1,683 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Miguel Dovale (University of Arizona)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * TCP stream server over loopback: fan-out on the free-running sim to
+ * several readers (sendmsg() and io_uring) with one that never reads, and
+ * the three slow-reader policies on a 52.7 kHz sim with a reader that
+ * stalls, where neither the other reader nor the acquisition ring may lose a
+ * frame. Every DATA frame is checked against the ramp and for order, and
+ * every frame the server took is accounted for.
+ */
+
+#include "stream_server.h"
+#include "test_util.h"
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#define TEST_STREAM_FRAMES 1000000U
+#define TEST_STREAM_CLIENTS 2U
+#define TEST_STREAM_RING_FRAMES 65536U
+#define TEST_STREAM_RX_BYTES (1024U * 1024U)
+#define TEST_STREAM_STALLED_RCVBUF 4096
+#define TEST_STREAM_DECODE_FRAMES 64U
+#define TEST_RESUME_DRDY_HZ 52734U
+#define TEST_RESUME_FRAMES 80000U               /* ~1.5 s at TEST_RESUME_DRDY_HZ */
+#define TEST_RESUME_STALL_MS 200U
+#define TEST_RESUME_STALL_AFTER_FRAMES 10000U
+#define TEST_RESUME_SHORT_HISTORY_FRAMES 4096U  /* ~78 ms at TEST_RESUME_DRDY_HZ */
+#define TEST_RESUME_SHORT_HISTORY_MSGS 1024U    /* sleeping sim DRDY misses split messages small */
+#define TEST_RESUME_LONG_HISTORY_FRAMES (2U * 1024U * 1024U)
+#define TEST_RESUME_MAX_LAG_MS 50U
+
+typedef struct {
+    int fd;
+    uint8_t *buf;
+    size_t fill;
+    uint64_t frames;
+    uint64_t next_seq;          /* frame seq must not go below this */
+    uint32_t next_msg;
+    bool started;
+    bool eof;
+    bool resumed;               /* replayed frames below next_seq are duplicates */
+    bool await_resume;          /* DATA ahead of the resume GAP is live data the replay repeats */
+    uint64_t gaps;              /* GAP messages, resume replies excluded */
+    uint64_t gap_msgs;
+    uint64_t gap_frames;        /* frames the server said it dropped (or no longer had) */
+    uint64_t duplicates;
+    ads1278_frame_t frames_buf[TEST_STREAM_DECODE_FRAMES];
+} stream_rx_t;
+
+typedef struct {
+    pthread_mutex_t lock;       /* guards srv against teardown by the thread */
+    stream_server_t *srv;
+    stream_server_stats_t stats;
+    stream_session_stats_t sessions[STREAM_SESSION_LOG];
+    size_t session_count;
+    int rc;
+} stream_thread_t;
+
+typedef struct {
+    const char *name;
+    stream_policy_t policy;
+    uint32_t history_msgs;      /* 0 = sized for history_frames */
+    uint64_t history_frames;
+    uint32_t stall_ms;          /* 0 = the stalled reader never reads again */
+} resume_phase_t;
+
+static int stream_connect(uint16_t port, int rcvbuf)
+{
+    struct sockaddr_in addr;
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+
+    if (fd < 0) {
+        return -1;
+    }
+    /* Must precede connect() to shrink the advertised window. */
+    if (rcvbuf != 0) {
+        (void)setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+    }
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(fd, (const struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        int saved_errno = errno;
+
+        (void)close(fd);
+        errno = saved_errno;
+        return -1;
+    }
+    return fd;
+}
+
+static int stream_subscribe(int fd, stream_policy_t policy, bool resume, uint64_t resume_seq)
+{
+    uint8_t msg[PROTO_HEADER_BYTES + PROTO_SUBSCRIBE_BYTES];
+    proto_subscribe_t sub;
+    size_t len;
+
+    memset(&sub, 0, sizeof(sub));
+    sub.policy = (uint16_t)policy;
+    sub.max_lag_ms = TEST_RESUME_MAX_LAG_MS;
+    sub.flags = resume ? PROTO_SUBSCRIBE_RESUME : 0U;
+    sub.resume_seq = resume_seq;
+    len = proto_encode_subscribe(msg, &sub);
+    return (send(fd, msg, len, MSG_NOSIGNAL) == (ssize_t)len) ? 0 : -1;
+}
+
+/* Consume complete messages: DATA must be gap-free per client and hold sim ramp frames. */
+static int stream_rx_parse(stream_rx_t *rx)
+{
+    size_t pos = 0U;
+
+    while (rx->fill - pos >= PROTO_HEADER_BYTES) {
+        const uint8_t *payload = rx->buf + pos + PROTO_HEADER_BYTES;
+        proto_header_t hdr;
+        proto_data_info_t info;
+        uint32_t idx;
+
+        if (proto_decode_header(rx->buf + pos, &hdr) != 0) {
+            fprintf(stderr, "stream: bad message header\n");
+            return -1;
+        }
+        if (rx->fill - pos < PROTO_HEADER_BYTES + (size_t)hdr.payload_len) {
+            break;
+        }
+
+        if (hdr.type == PROTO_MSG_GAP) {
+            proto_gap_t gap;
+
+            if (proto_decode_gap(payload, hdr.payload_len, &gap) != 0) {
+                fprintf(stderr, "stream: bad GAP\n");
+                return -1;
+            }
+            if ((gap.flags & PROTO_GAP_RESUME) == 0U) {
+                ++rx->gaps;
+                rx->gap_msgs += gap.msg_count;
+            } else {
+                rx->await_resume = false;
+            }
+            rx->gap_frames += gap.frame_count;
+            rx->next_msg = gap.first_msg_seq + gap.msg_count;
+            rx->started = true;
+        } else if (hdr.type == PROTO_MSG_DATA && !rx->await_resume) {
+            if (proto_decode_data_info(payload, hdr.payload_len, &info) != 0 ||
+                (rx->started && (hdr.msg_seq != rx->next_msg || (!rx->resumed && info.first_seq < rx->next_seq)))) {
+                fprintf(stderr, "stream: DATA out of order (msg %" PRIu32 ", seq %" PRIu64 ")\n",
+                    hdr.msg_seq, info.first_seq);
+                return -1;
+            }
+            for (idx = 0U; idx < info.frame_count; ++idx) {
+                const ads1278_frame_t *frame = &rx->frames_buf[idx % TEST_STREAM_DECODE_FRAMES];
+                uint32_t channel;
+
+                if (idx % TEST_STREAM_DECODE_FRAMES == 0U) {
+                    uint32_t left = info.frame_count - idx;
+
+                    proto_data_decode_frames(&info, idx,
+                        (left < TEST_STREAM_DECODE_FRAMES) ? left : TEST_STREAM_DECODE_FRAMES, rx->frames_buf);
+                }
+                if (frame->seq < rx->next_seq) {
+                    if (rx->resumed) {
+                        ++rx->duplicates;
+                        continue;
+                    }
+                    fprintf(stderr, "stream: frame seq went backwards at %" PRIu64 "\n", frame->seq);
+                    return -1;
+                }
+                for (channel = 0U; channel < ADS1278_CHANNEL_COUNT; ++channel) {
+                    if (frame->ch[channel] != sim_ramp_value(sim_ramp_index(frame), channel)) {
+                        fprintf(stderr, "stream: bad sample at seq %" PRIu64 " ch%u\n", frame->seq, channel + 1U);
+                        return -1;
+                    }
+                }
+                rx->next_seq = frame->seq + 1U;
+                ++rx->frames;
+            }
+            rx->next_msg = hdr.msg_seq + 1U;
+            rx->started = true;
+        }
+        pos += PROTO_HEADER_BYTES + (size_t)hdr.payload_len;
+    }
+
+    memmove(rx->buf, rx->buf + pos, rx->fill - pos);
+    rx->fill -= pos;
+    return 0;
+}
+
+/* Run the loop and tear the server down here, so clients see EOF after the last byte. */
+static void *stream_server_thread(void *arg)
+{
+    stream_thread_t *ctx = arg;
+
+    ctx->rc = stream_server_run(ctx->srv);
+    pthread_mutex_lock(&ctx->lock);
+    stream_server_get_stats(ctx->srv, &ctx->stats);
+    ctx->session_count = stream_server_get_sessions(ctx->srv, ctx->sessions, STREAM_SESSION_LOG);
+    stream_server_destroy(ctx->srv);
+    ctx->srv = NULL;
+    pthread_mutex_unlock(&ctx->lock);
+    return NULL;
+}
+
+static const stream_session_stats_t *find_session(const stream_thread_t *ctx, uint64_t id)
+{
+    size_t idx;
+
+    for (idx = 0U; idx < ctx->session_count; ++idx) {
+        if (ctx->sessions[idx].id == id) {
+            return &ctx->sessions[idx];
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Ramp sim (free-running with drdy_rate_hz 0), acquisition of `frames` and a
+ * server on its own thread; undone by stream_teardown().
+ */
+static int stream_setup(stream_thread_t *ctx, stream_server_cfg_t *cfg, uint32_t drdy_rate_hz, uint64_t frames,
+                        acq_t **acq, pthread_t *thread)
+{
+    ads1278_cfg_t sim_cfg = {0};
+    acq_cfg_t acq_cfg = {0};
+
+    sim_cfg.backend = ADS1278_BACKEND_SIM;
+    sim_cfg.sim.drdy_rate_hz = drdy_rate_hz;
+    sim_cfg.sim.signal = ADS1278_SIM_SIGNAL_RAMP;
+    if (ads1278_open(&sim_cfg) != 0 || ads1278_start() != 0) {
+        perror("ads1278_open/start");
+        ads1278_close();
+        return -1;
+    }
+    acq_cfg.ring_capacity = TEST_STREAM_RING_FRAMES;
+    acq_cfg.max_frames = frames;
+    if (acq_create(acq, &acq_cfg) != 0) {
+        perror("acq_create");
+        goto fail;
+    }
+    cfg->bind_addr = "127.0.0.1";
+    cfg->mode = STREAM_MODE_THROUGHPUT;
+    if (stream_server_create(&ctx->srv, cfg, *acq) != 0) {
+        perror("stream_server_create");
+        goto fail;
+    }
+    if (pthread_create(thread, NULL, stream_server_thread, ctx) != 0) {
+        perror("pthread_create");
+        stream_server_destroy(ctx->srv);
+        ctx->srv = NULL;
+        goto fail;
+    }
+    return 0;
+
+fail:
+    acq_destroy(*acq);
+    *acq = NULL;
+    ads1278_stop();
+    ads1278_close();
+    return -1;
+}
+
+static void stream_teardown(stream_thread_t *ctx, acq_t *acq, pthread_t thread, bool joined)
+{
+    if (!joined) {
+        pthread_mutex_lock(&ctx->lock);
+        stream_server_stop(ctx->srv);
+        pthread_mutex_unlock(&ctx->lock);
+        pthread_join(thread, NULL);
+    }
+    acq_destroy(acq);
+    ads1278_stop();
+    ads1278_close();
+}
+
+/* TEST_STREAM_CLIENTS readers plus one that never reads; every active reader must get every frame. */
+static int fanout_run(bool io_uring)
+{
+    stream_rx_t rx[TEST_STREAM_CLIENTS];
+    stream_thread_t ctx;
+    stream_server_cfg_t cfg;
+    acq_t *acq = NULL;
+    pthread_t thread;
+    bool joined = false;
+    int stalled_fd = -1;
+    uint32_t idx;
+    uint32_t open_clients;
+    int rc = -1;
+
+    memset(rx, 0, sizeof(rx));
+    memset(&ctx, 0, sizeof(ctx));
+    memset(&cfg, 0, sizeof(cfg));
+    for (idx = 0U; idx < TEST_STREAM_CLIENTS; ++idx) {
+        rx[idx].fd = -1;
+    }
+    pthread_mutex_init(&ctx.lock, NULL);
+    /* Acquisition starts once every client is in. */
+    cfg.max_clients = TEST_STREAM_CLIENTS + 1U;
+    cfg.start_clients = TEST_STREAM_CLIENTS + 1U;
+    cfg.io_uring = io_uring;
+    if (stream_setup(&ctx, &cfg, 0U, TEST_STREAM_FRAMES, &acq, &thread) != 0) {
+        pthread_mutex_destroy(&ctx.lock);
+        return -1;
+    }
+
+    for (idx = 0U; idx < TEST_STREAM_CLIENTS; ++idx) {
+        rx[idx].buf = malloc(TEST_STREAM_RX_BYTES);
+        rx[idx].fd = stream_connect(stream_server_port(ctx.srv), 0);
+        if (rx[idx].buf == NULL || rx[idx].fd < 0) {
+            perror("stream client");
+            goto out;
+        }
+    }
+    stalled_fd = stream_connect(stream_server_port(ctx.srv), TEST_STREAM_STALLED_RCVBUF);
+    if (stalled_fd < 0) {
+        perror("stalled client");
+        goto out;
+    }
+
+    open_clients = TEST_STREAM_CLIENTS;
+    while (open_clients != 0U) {
+        struct pollfd pfd[TEST_STREAM_CLIENTS];
+        uint32_t map[TEST_STREAM_CLIENTS];
+        nfds_t nfds = 0U;
+        nfds_t pos;
+
+        /* The stalled reader leaves once acquisition ends so the server can finish. */
+        if (stalled_fd >= 0 && acq_is_done(acq)) {
+            (void)close(stalled_fd);
+            stalled_fd = -1;
+        }
+        for (idx = 0U; idx < TEST_STREAM_CLIENTS; ++idx) {
+            if (!rx[idx].eof) {
+                pfd[nfds].fd = rx[idx].fd;
+                pfd[nfds].events = POLLIN;
+                map[nfds++] = idx;
+            }
+        }
+        if (poll(pfd, nfds, 100) < 0 && errno != EINTR) {
+            perror("poll");
+            goto out;
+        }
+        for (pos = 0U; pos < nfds; ++pos) {
+            stream_rx_t *client = &rx[map[pos]];
+            ssize_t n;
+
+            if ((pfd[pos].revents & (POLLIN | POLLHUP | POLLERR)) == 0) {
+                continue;
+            }
+            n = recv(client->fd, client->buf + client->fill, TEST_STREAM_RX_BYTES - client->fill, 0);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                client->eof = true;
+                --open_clients;
+                continue;
+            }
+            client->fill += (size_t)n;
+            if (stream_rx_parse(client) != 0) {
+                goto out;
+            }
+        }
+    }
+
+    pthread_join(thread, NULL);
+    joined = true;
+    if (ctx.rc != 0) {
+        fprintf(stderr, "stream_server_run failed\n");
+        goto out;
+    }
+    for (idx = 0U; idx < TEST_STREAM_CLIENTS; ++idx) {
+        if (rx[idx].fill != 0U || rx[idx].frames != ctx.stats.frames_in || rx[idx].gaps != 0U) {
+            fprintf(stderr, "stream: client %u got %" PRIu64 " of %" PRIu64 " frames, %" PRIu64 " GAP(s)\n",
+                idx, rx[idx].frames, ctx.stats.frames_in, rx[idx].gaps);
+            goto out;
+        }
+    }
+    if (ctx.stats.frames_in == 0U) {
+        fprintf(stderr, "stream: no frames streamed\n");
+        goto out;
+    }
+    rc = 0;
+
+out:
+    if (stalled_fd >= 0) {
+        (void)close(stalled_fd);
+    }
+    for (idx = 0U; idx < TEST_STREAM_CLIENTS; ++idx) {
+        if (rx[idx].fd >= 0) {
+            (void)close(rx[idx].fd);
+        }
+        free(rx[idx].buf);
+    }
+    stream_teardown(&ctx, acq, thread, joined);
+    pthread_mutex_destroy(&ctx.lock);
+    return rc;
+}
+
+static int test_fanout_sendmsg(void)
+{
+    return fanout_run(false);
+}
+
+/* Falls back to sendmsg() where io_uring is unavailable; the stream must be the same either way. */
+static int test_fanout_io_uring(void)
+{
+    return fanout_run(true);
+}
+
+/*
+ * One policy at TEST_RESUME_DRDY_HZ: a never-drop reader that keeps up
+ * (session 1), and one with a small receive buffer (session 2) that stops
+ * reading for the phase's stall_ms once it has TEST_RESUME_STALL_AFTER_FRAMES
+ * frames. A stalled reader that is disconnected reconnects once (session 3)
+ * and resumes from its next seq. Every frame the server took must be
+ * accounted for on both readers, and the stall must never reach the
+ * acquisition ring.
+ */
+static int resume_phase(const resume_phase_t *phase)
+{
+    stream_rx_t rx[2];
+    stream_thread_t ctx;
+    stream_server_cfg_t cfg;
+    acq_stats_t acq_stats;
+    acq_t *acq = NULL;
+    pthread_t thread;
+    bool joined = false;
+    bool stalled = false;
+    bool reconnected = false;
+    bool ended = false;         /* the run finished while the reader was stalled */
+    uint64_t stall_until = 0U;
+    const stream_session_stats_t *first;
+    const stream_session_stats_t *second;
+    uint64_t total;
+    uint16_t port;
+    uint32_t idx;
+    int rc = -1;
+
+    memset(rx, 0, sizeof(rx));
+    memset(&ctx, 0, sizeof(ctx));
+    memset(&cfg, 0, sizeof(cfg));
+    rx[0].fd = -1;
+    rx[1].fd = -1;
+    pthread_mutex_init(&ctx.lock, NULL);
+    cfg.max_clients = 3U;
+    cfg.start_clients = 2U;
+    cfg.history_msgs = phase->history_msgs;
+    cfg.history_frames = phase->history_frames;
+    if (stream_setup(&ctx, &cfg, TEST_RESUME_DRDY_HZ, TEST_RESUME_FRAMES, &acq, &thread) != 0) {
+        pthread_mutex_destroy(&ctx.lock);
+        return -1;
+    }
+    /* The server thread frees ctx.srv when it exits. */
+    port = stream_server_port(ctx.srv);
+
+    for (idx = 0U; idx < 2U; ++idx) {
+        rx[idx].buf = malloc(TEST_STREAM_RX_BYTES);
+        rx[idx].fd = stream_connect(port, (idx == 1U) ? TEST_STREAM_STALLED_RCVBUF : 0);
+        if (rx[idx].buf == NULL || rx[idx].fd < 0 ||
+            stream_subscribe(rx[idx].fd, (idx == 1U) ? phase->policy : STREAM_POLICY_NEVER_DROP, false, 0U) != 0) {
+            perror("stream client");
+            goto out;
+        }
+    }
+
+    while (!rx[0].eof || !rx[1].eof) {
+        struct pollfd pfd[2];
+        uint32_t map[2];
+        nfds_t nfds = 0U;
+        nfds_t pos;
+        uint64_t now = now_ns();
+
+        if (!stalled && rx[1].frames >= TEST_RESUME_STALL_AFTER_FRAMES) {
+            stalled = true;
+            stall_until = (phase->stall_ms == 0U) ? UINT64_MAX : now + ((uint64_t)phase->stall_ms * 1000000ULL);
+        }
+        if (rx[0].eof && stall_until == UINT64_MAX) {
+            /* The run is over: read what the server had sent before it closed. */
+            stall_until = now;
+        }
+        for (idx = 0U; idx < 2U; ++idx) {
+            if (!rx[idx].eof && (idx == 0U || now >= stall_until)) {
+                pfd[nfds].fd = rx[idx].fd;
+                pfd[nfds].events = POLLIN;
+                map[nfds++] = idx;
+            }
+        }
+        if (poll(pfd, nfds, 10) < 0 && errno != EINTR) {
+            perror("poll");
+            goto out;
+        }
+        for (pos = 0U; pos < nfds; ++pos) {
+            stream_rx_t *client = &rx[map[pos]];
+            ssize_t n;
+
+            if ((pfd[pos].revents & (POLLIN | POLLHUP | POLLERR)) == 0) {
+                continue;
+            }
+            n = recv(client->fd, client->buf + client->fill, TEST_STREAM_RX_BYTES - client->fill, 0);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0 && map[pos] == 1U && phase->policy == STREAM_POLICY_DISCONNECT && !reconnected) {
+                /* Closed for lagging: the cut-off message is replayed, so drop its head. */
+                reconnected = true;
+                (void)close(client->fd);
+                client->fill = 0U;
+                client->started = false;
+                client->resumed = true;
+                client->await_resume = true;
+                client->fd = stream_connect(port, 0);
+                if (client->fd < 0 && errno == ECONNREFUSED) {
+                    /* The run ended inside the stall: nothing left to resume. */
+                    ended = true;
+                    client->eof = true;
+                    continue;
+                }
+                if (client->fd < 0 || stream_subscribe(client->fd, phase->policy, true, client->next_seq) != 0) {
+                    perror("resume");
+                    goto out;
+                }
+                continue;
+            }
+            if (n <= 0) {
+                client->eof = true;
+                continue;
+            }
+            client->fill += (size_t)n;
+            if (stream_rx_parse(client) != 0) {
+                goto out;
+            }
+        }
+    }
+
+    pthread_join(thread, NULL);
+    joined = true;
+    if (ctx.rc != 0) {
+        fprintf(stderr, "stream_server_run failed\n");
+        goto out;
+    }
+    first = find_session(&ctx, 2U);
+    second = find_session(&ctx, 3U);
+    total = ctx.stats.frames_in;
+    acq_get_stats(acq, &acq_stats);
+
+    if (rx[0].frames != total || rx[0].gaps != 0U || acq_stats.ring.overflows != 0U) {
+        fprintf(stderr, "resume %s: healthy reader got %" PRIu64 " of %" PRIu64 " frames, %" PRIu64 " GAP(s), %"
+            PRIu64 " frame(s) overflowed the acquisition ring\n", phase->name, rx[0].frames, total, rx[0].gaps,
+            acq_stats.ring.overflows);
+        goto out;
+    }
+    if (!stalled || first == NULL) {
+        fprintf(stderr, "resume %s: the stalled reader never stalled\n", phase->name);
+        goto out;
+    }
+    switch (phase->policy) {
+        case STREAM_POLICY_DROP_OLDEST:
+            /* Received plus dropped is everything, whether or not the stall outgrew the history. */
+            if (rx[1].frames + rx[1].gap_frames != total || first->msgs_dropped != rx[1].gap_msgs) {
+                fprintf(stderr, "resume %s: %" PRIu64 " received + %" PRIu64 " notified != %" PRIu64 " frames "
+                    "(%" PRIu64 " GAP(s), session dropped %" PRIu64 " of %" PRIu64 " named)\n", phase->name,
+                    rx[1].frames, rx[1].gap_frames, total, rx[1].gaps, first->msgs_dropped, rx[1].gap_msgs);
+                goto out;
+            }
+            break;
+        case STREAM_POLICY_DISCONNECT:
+            if (ended && (first->closed == STREAM_CLOSE_LAGGING || first->closed == STREAM_CLOSE_OVERRUN)) {
+                break;
+            }
+            if (first->closed != STREAM_CLOSE_LAGGING && first->closed != STREAM_CLOSE_OVERRUN &&
+                rx[1].gaps == 0U && rx[1].frames == total) {
+                /* Never max_lag_ms behind: nothing to resume, nothing lost. */
+                break;
+            }
+            if (!reconnected || second == NULL || second->resumes != 1U || rx[1].gaps != 0U ||
+                rx[1].gap_frames != 0U || rx[1].frames != total ||
+                (first->closed != STREAM_CLOSE_LAGGING && first->closed != STREAM_CLOSE_OVERRUN)) {
+                fprintf(stderr, "resume %s: got %" PRIu64 " of %" PRIu64 " frames after %s, %" PRIu64 " lost\n",
+                    phase->name, rx[1].frames, total,
+                    reconnected ? stream_close_name(first->closed) : "no disconnect", rx[1].gap_frames);
+                goto out;
+            }
+            break;
+        case STREAM_POLICY_NEVER_DROP:
+            /* Never skipped: an unbroken prefix of the stream, then closed once the history ran out. */
+            if (rx[1].gaps != 0U || rx[1].gap_frames != 0U || first->msgs_dropped != 0U ||
+                first->closed != STREAM_CLOSE_OVERRUN || rx[1].frames >= total) {
+                fprintf(stderr, "resume %s: got %" PRIu64 " of %" PRIu64 " frames, %" PRIu64 " GAP(s), %s\n",
+                    phase->name, rx[1].frames, total, rx[1].gaps, stream_close_name(first->closed));
+                goto out;
+            }
+            break;
+        default:
+            goto out;
+    }
+    rc = 0;
+
+out:
+    for (idx = 0U; idx < 2U; ++idx) {
+        if (rx[idx].fd >= 0) {
+            (void)close(rx[idx].fd);
+        }
+        free(rx[idx].buf);
+    }
+    stream_teardown(&ctx, acq, thread, joined);
+    pthread_mutex_destroy(&ctx.lock);
+    return rc;
+}
+
+static int test_resume_drop_oldest(void)
+{
+    static const resume_phase_t phase = {
+        "drop-oldest", STREAM_POLICY_DROP_OLDEST, TEST_RESUME_SHORT_HISTORY_MSGS, TEST_RESUME_SHORT_HISTORY_FRAMES, TEST_RESUME_STALL_MS
+    };
+
+    return resume_phase(&phase);
+}
+
+static int test_resume_disconnect(void)
+{
+    static const resume_phase_t phase = {
+        "disconnect", STREAM_POLICY_DISCONNECT, 0U, TEST_RESUME_LONG_HISTORY_FRAMES, TEST_RESUME_STALL_MS
+    };
+
+    return resume_phase(&phase);
+}
+
+/* A never-drop reader that stops for good may not hold up the stream: it is closed, never skipped. */
+static int test_resume_never_drop(void)
+{
+    static const resume_phase_t phase = {
+        "never-drop", STREAM_POLICY_NEVER_DROP, TEST_RESUME_SHORT_HISTORY_MSGS, TEST_RESUME_SHORT_HISTORY_FRAMES, 0U
+    };
+
+    return resume_phase(&phase);
+}
+
+int main(void)
+{
+    static const test_case_t cases[] = {
+        {"fan-out, sendmsg()", test_fanout_sendmsg},
+        {"fan-out, io_uring", test_fanout_io_uring},
+        {"stalled reader, drop-oldest", test_resume_drop_oldest},
+        {"stalled reader, disconnect and resume", test_resume_disconnect},
+        {"stopped never-drop reader is closed", test_resume_never_drop}
+    };
+
+    return test_run("stream", cases, sizeof(cases) / sizeof(cases[0]));
+}
@@ -0,0 +1,449 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Miguel Dovale (University of Arizona)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Triggered capture on synthetic signals: every condition kind fires on the
+ * exact frame, hysteresis rejects noise that retriggers a bare level,
+ * holdoff suppresses, windows carry exactly the source frames around the
+ * trigger and round-trip as EVENT messages, an external edge lands on the
+ * next frame and a seq gap cuts the open window.
+ */
+
+#include "proto.h"
+#include "trigger.h"
+#include "test_util.h"
+
+#define TEST_TRIGGER_FRAMES 200000U
+#define TEST_TRIGGER_SHORT_FRAMES 20000U
+#define TEST_TRIGGER_BLOCK_FRAMES 256U
+#define TEST_TRIGGER_SOURCE_FRAMES 6000U    /* common period of the test signals */
+#define TEST_TRIGGER_PERIOD_NS 20000U
+#define TEST_TRIGGER_MAX_HITS 4096U
+
+typedef struct {
+    uint64_t seq;               /* trigger_seq */
+    uint32_t condition;
+    uint32_t pre_frames;
+    uint32_t frame_count;
+} trigger_hit_t;
+
+typedef struct {
+    const char *spec;
+    uint64_t frames;
+    uint64_t gap_from;          /* seq [gap_from, gap_to) is never delivered */
+    uint64_t gap_to;
+    uint64_t fire_seq;          /* external trigger just before this frame, 0 = none */
+    trigger_hit_t hits[TEST_TRIGGER_MAX_HITS];
+    uint64_t events;
+    trigger_stats_t stats;
+} trigger_job_t;
+
+typedef struct {
+    const char *spec;
+    uint64_t offset;            /* triggers expected at offset + period * k for k >= first */
+    uint64_t period;
+    uint64_t first;
+    uint64_t tol;               /* +- frames, for the noisy signal */
+} trigger_case_t;
+
+static const uint16_t k_encodings[] = {PROTO_DATA_ENC_RECORD48, PROTO_DATA_ENC_P24, PROTO_DATA_ENC_DELTA};
+
+#define TEST_TRIGGER_ENCODINGS (sizeof(k_encodings) / sizeof(k_encodings[0]))
+
+static ads1278_frame_t g_src[TEST_TRIGGER_SOURCE_FRAMES];
+
+/*
+ * Test signals, periodic in TEST_TRIGGER_SOURCE_FRAMES:
+ *   ch1    square +-1e6: rises at 500 + 1000k, falls at 1000k
+ *   ch2    triangle +-1e6 (2000 codes/frame) plus +-20000 noise: rises through 0 near 500 + 2000k
+ *   ch3    step to 50000 at 1234 + 3000k, back to 0 at 3000k
+ *   ch4    pulse to 3e6 over [700, 720) + 1000k
+ *   ch5..8 ramps, for the window content checks
+ */
+static void fill_trigger_source(void)
+{
+    uint64_t rng = 0x9E3779B97F4A7C15ULL;
+    uint32_t idx;
+
+    for (idx = 0U; idx < TEST_TRIGGER_SOURCE_FRAMES; ++idx) {
+        uint32_t tri = idx % 2000U;
+        uint32_t channel;
+
+        memset(&g_src[idx], 0, sizeof(g_src[idx]));
+        g_src[idx].ch[0] = ((idx / 500U) % 2U != 0U) ? 1000000 : -1000000;
+        g_src[idx].ch[1] = ((tri < 1000U) ? -1000000 + (int32_t)(2000U * tri)
+                                           : 1000000 - (int32_t)(2000U * (tri - 1000U))) +
+                           (int32_t)(xorshift64(&rng) % 40001U) - 20000;
+        g_src[idx].ch[2] = (idx % 3000U >= 1234U) ? 50000 : 0;
+        g_src[idx].ch[3] = (idx % 1000U >= 700U && idx % 1000U < 720U) ? 3000000 : 0;
+        for (channel = 4U; channel < ADS1278_CHANNEL_COUNT; ++channel) {
+            g_src[idx].ch[channel] = (int32_t)((idx * 1021U * channel) & 0x7FFFFFU);
+        }
+    }
+}
+
+/* A window must be consecutive source frames with the trigger frame at pre_frames. */
+static int check_trigger_window(const trigger_job_t *job, const trigger_cfg_t *cfg, const trigger_event_t *event)
+{
+    uint32_t idx;
+
+    if (event->pre_frames > cfg->pre_frames || event->frame_count <= event->pre_frames ||
+        event->frame_count > event->pre_frames + 1U + cfg->post_frames) {
+        fprintf(stderr, "trigger %s: event %" PRIu64 " has %" PRIu32 " frame(s), %" PRIu32 " before the trigger\n",
+            job->spec, event->id, event->frame_count, event->pre_frames);
+        return -1;
+    }
+    for (idx = 0U; idx < event->frame_count; ++idx) {
+        const ads1278_frame_t *frame = &event->frames[idx];
+        uint64_t want = event->trigger_seq - event->pre_frames + idx;
+
+        if (frame->seq != want || frame->tstamp_ns != want * TEST_TRIGGER_PERIOD_NS ||
+            memcmp(frame->ch, g_src[want % TEST_TRIGGER_SOURCE_FRAMES].ch,
+                   ADS1278_CHANNEL_COUNT * sizeof(frame->ch[0])) != 0) {
+            fprintf(stderr, "trigger %s: event %" PRIu64 " frame %" PRIu32 " is seq %" PRIu64 ", want %" PRIu64 "\n",
+                job->spec, event->id, idx, frame->seq, want);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static int check_event_round_trip(const trigger_job_t *job, const trigger_event_t *event, proto_data_encoder_t *enc,
+                                  uint8_t *msg, ads1278_frame_t *decoded)
+{
+    proto_event_t ev = {0};
+    proto_event_info_t info;
+    proto_header_t hdr;
+    size_t len;
+    uint32_t idx;
+
+    ev.event_id = event->id;
+    ev.trigger_seq = event->trigger_seq;
+    ev.trigger_tstamp_ns = event->trigger_tstamp_ns;
+    ev.pre_frames = event->pre_frames;
+    ev.condition = (uint16_t)event->condition;
+    len = proto_encode_event(msg, 7U, &ev, enc, event->frames, event->frame_count);
+    if (ev.frame_count != event->frame_count || proto_decode_header(msg, &hdr) != 0 ||
+        hdr.type != PROTO_MSG_EVENT || PROTO_HEADER_BYTES + hdr.payload_len != len ||
+        proto_decode_event(msg + PROTO_HEADER_BYTES, hdr.payload_len, &info) != 0 ||
+        info.event.event_id != event->id || info.event.trigger_seq != event->trigger_seq ||
+        info.event.trigger_tstamp_ns != event->trigger_tstamp_ns || info.event.pre_frames != event->pre_frames ||
+        info.event.condition != ev.condition || info.data.frame_count != event->frame_count) {
+        fprintf(stderr, "trigger %s: %s EVENT %" PRIu64 " does not round-trip\n", job->spec,
+            proto_data_encoding_name(enc->encoding), event->id);
+        return -1;
+    }
+    proto_data_decode_frames(&info.data, 0U, info.data.frame_count, decoded);
+    for (idx = 0U; idx < event->frame_count; ++idx) {
+        if (!frames_equal(&decoded[idx], &event->frames[idx], ADS1278_CHANNEL_COUNT)) {
+            fprintf(stderr, "trigger %s: %s EVENT %" PRIu64 " frame %" PRIu32 " differs\n", job->spec,
+                proto_data_encoding_name(enc->encoding), event->id, idx);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static int record_trigger_event(trigger_job_t *job, const trigger_cfg_t *cfg, const trigger_event_t *event,
+                                proto_data_encoder_t *encs, uint8_t *msg, ads1278_frame_t *decoded)
+{
+    uint32_t idx;
+
+    if (check_trigger_window(job, cfg, event) != 0) {
+        return -1;
+    }
+    for (idx = 0U; idx < TEST_TRIGGER_ENCODINGS; ++idx) {
+        if (check_event_round_trip(job, event, &encs[idx], msg, decoded) != 0) {
+            return -1;
+        }
+    }
+    if (job->events < TEST_TRIGGER_MAX_HITS) {
+        trigger_hit_t *hit = &job->hits[job->events];
+
+        hit->seq = event->trigger_seq;
+        hit->condition = event->condition;
+        hit->pre_frames = event->pre_frames;
+        hit->frame_count = event->frame_count;
+    }
+    ++job->events;
+    return 0;
+}
+
+/* Feed job->frames frames through a trigger in blocks, checking every window and its EVENT encodings. */
+static int trigger_job_run(trigger_job_t *job)
+{
+    proto_data_encoder_t encs[TEST_TRIGGER_ENCODINGS];
+    ads1278_frame_t in[TEST_TRIGGER_BLOCK_FRAMES];
+    trigger_cfg_t cfg;
+    trigger_t *trig = NULL;
+    trigger_event_t event;
+    ads1278_frame_t *decoded = NULL;
+    uint8_t *msg = NULL;
+    size_t msg_bytes = 0U;
+    uint64_t seq = 0U;
+    uint64_t done;
+    uint32_t window;
+    uint32_t idx;
+    int rc = -1;
+
+    memset(encs, 0, sizeof(encs));
+    job->events = 0U;
+    if (trigger_parse_spec(job->spec, &cfg) != 0 || trigger_create(&trig, &cfg) != 0) {
+        fprintf(stderr, "trigger: bad spec %s\n", job->spec);
+        return -1;
+    }
+    window = trigger_window_frames(trig);
+    for (idx = 0U; idx < TEST_TRIGGER_ENCODINGS; ++idx) {
+        size_t bytes = proto_event_max_bytes(k_encodings[idx], ADS1278_CHANNEL_COUNT, window);
+
+        msg_bytes = (bytes > msg_bytes) ? bytes : msg_bytes;
+    }
+    msg = malloc(msg_bytes);
+    decoded = calloc(window, sizeof(*decoded));
+    if (msg == NULL || decoded == NULL) {
+        perror("malloc");
+        goto out;
+    }
+    for (idx = 0U; idx < TEST_TRIGGER_ENCODINGS; ++idx) {
+        if (proto_data_encoder_init(&encs[idx], k_encodings[idx], ADS1278_CHANNEL_COUNT, window) != 0) {
+            perror("proto_data_encoder_init");
+            goto out;
+        }
+    }
+    if (job->fire_seq != 0U) {
+        trigger_fire(trig, (job->fire_seq * TEST_TRIGGER_PERIOD_NS) - (TEST_TRIGGER_PERIOD_NS / 2U));
+    }
+
+    for (done = 0U; done < job->frames;) {
+        size_t n = TEST_TRIGGER_BLOCK_FRAMES;
+        size_t pos = 0U;
+
+        if (job->frames - done < n) {
+            n = (size_t)(job->frames - done);
+        }
+        for (idx = 0U; idx < n; ++idx, ++seq) {
+            if (seq == job->gap_from) {
+                seq = job->gap_to;
+            }
+            in[idx] = g_src[seq % TEST_TRIGGER_SOURCE_FRAMES];
+            in[idx].seq = seq;
+            in[idx].tstamp_ns = seq * TEST_TRIGGER_PERIOD_NS;
+        }
+        done += n;
+
+        while (pos < n) {
+            pos += trigger_process(trig, in + pos, n - pos, &event);
+            if (event.frame_count != 0U && record_trigger_event(job, &cfg, &event, encs, msg, decoded) != 0) {
+                goto out;
+            }
+        }
+    }
+    trigger_flush(trig, &event);
+    if (event.frame_count != 0U && record_trigger_event(job, &cfg, &event, encs, msg, decoded) != 0) {
+        goto out;
+    }
+    trigger_get_stats(trig, &job->stats);
+    if (job->stats.frames_in != job->frames || job->stats.events != job->events) {
+        fprintf(stderr, "trigger %s: stats report %" PRIu64 " frame(s) and %" PRIu64 " event(s), want %" PRIu64
+            " and %" PRIu64 "\n", job->spec, job->stats.frames_in, job->stats.events, job->frames, job->events);
+        goto out;
+    }
+    rc = 0;
+
+out:
+    for (idx = 0U; idx < TEST_TRIGGER_ENCODINGS; ++idx) {
+        proto_data_encoder_destroy(&encs[idx]);
+    }
+    free(msg);
+    free(decoded);
+    trigger_destroy(trig);
+    return rc;
+}
+
+static trigger_job_t *new_job(const char *spec, uint64_t frames)
+{
+    trigger_job_t *job = calloc(1U, sizeof(*job));
+
+    if (job == NULL) {
+        perror("calloc");
+        return NULL;
+    }
+    job->spec = spec;
+    job->frames = frames;
+    job->gap_from = UINT64_MAX;
+    return job;
+}
+
+/* Every expected trigger, in order, within tol; the last window may be cut by the end of input. */
+static int check_trigger_case(const trigger_case_t *tc, const trigger_job_t *job)
+{
+    uint64_t want_events = 0U;
+    uint64_t idx;
+
+    while (tc->offset + (tc->period * (tc->first + want_events)) < job->frames) {
+        ++want_events;
+    }
+    if (job->events != want_events) {
+        fprintf(stderr, "trigger %s: %" PRIu64 " event(s), want %" PRIu64 "\n", tc->spec, job->events, want_events);
+        return -1;
+    }
+    for (idx = 0U; idx < job->events && idx < TEST_TRIGGER_MAX_HITS; ++idx) {
+        const trigger_hit_t *hit = &job->hits[idx];
+        uint64_t want = tc->offset + (tc->period * (tc->first + idx));
+        uint64_t off = (hit->seq > want) ? hit->seq - want : want - hit->seq;
+
+        if (off > tc->tol || hit->condition != 0U) {
+            fprintf(stderr, "trigger %s: event %" PRIu64 " at seq %" PRIu64 " (condition %" PRIu32 "), want %" PRIu64
+                "\n", tc->spec, idx, hit->seq, hit->condition, want);
+            return -1;
+        }
+    }
+    if (job->stats.truncated > 1U ||
+        (strstr(tc->spec, "holdoff") != NULL && job->stats.suppressed + 1U < job->events)) {
+        fprintf(stderr, "trigger %s: %" PRIu64 " truncated, %" PRIu64 " suppressed\n", tc->spec,
+            job->stats.truncated, job->stats.suppressed);
+        return -1;
+    }
+    return 0;
+}
+
+static int test_conditions(void)
+{
+    static const trigger_case_t cases[] = {
+        {"pre=16,post=16,ch=1,rise=0", 500U, 1000U, 0U, 0U},
+        {"pre=16,post=16,ch=1,fall=0", 0U, 1000U, 1U, 0U},
+        {"pre=4,post=4,ch=3,slope=40000", 1234U, 3000U, 0U, 0U},
+        {"pre=4,post=4,ch=3,slope=-40000", 0U, 3000U, 1U, 0U},
+        {"pre=8,post=8,ch=4,outside=-1000000:1000000", 700U, 1000U, 0U, 0U},
+        {"pre=8,post=8,ch=4,inside=-1000000:1000000", 720U, 1000U, 0U, 0U},
+        {"ch=2,rise=0,hyst=50000", 500U, 2000U, 0U, 10U},
+        {"post=10,holdoff=1500,ch=1,rise=0", 500U, 2000U, 0U, 0U}
+    };
+    size_t idx;
+
+    for (idx = 0U; idx < sizeof(cases) / sizeof(cases[0]); ++idx) {
+        trigger_job_t *job = new_job(cases[idx].spec, TEST_TRIGGER_FRAMES);
+        int rc;
+
+        if (job == NULL) {
+            return -1;
+        }
+        rc = (trigger_job_run(job) == 0 && check_trigger_case(&cases[idx], job) == 0) ? 0 : -1;
+        free(job);
+        if (rc != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/* Without hysteresis the noisy crossing chatters. */
+static int test_chatter(void)
+{
+    trigger_job_t *job = new_job("ch=2,rise=0", TEST_TRIGGER_FRAMES);
+    int rc = -1;
+
+    if (job == NULL) {
+        return -1;
+    }
+    if (trigger_job_run(job) == 0) {
+        if (job->events > TEST_TRIGGER_FRAMES / 2000U) {
+            rc = 0;
+        } else {
+            fprintf(stderr, "trigger %s: %" PRIu64 " event(s); the noise should retrigger\n", job->spec,
+                job->events);
+        }
+    }
+    free(job);
+    return rc;
+}
+
+/* External edge halfway between frames 12344 and 12345. */
+static int test_external(void)
+{
+    trigger_job_t *job = new_job("pre=8,post=8,ch=1,rise=8000000", TEST_TRIGGER_SHORT_FRAMES);
+    int rc = -1;
+
+    if (job == NULL) {
+        return -1;
+    }
+    job->fire_seq = 12345U;
+    if (trigger_job_run(job) == 0) {
+        if (job->events == 1U && job->hits[0].seq == job->fire_seq && job->hits[0].condition == TRIGGER_EXTERNAL &&
+            job->stats.external == 1U) {
+            rc = 0;
+        } else {
+            fprintf(stderr, "trigger external: %" PRIu64 " event(s), first at seq %" PRIu64 "\n", job->events,
+                job->hits[0].seq);
+        }
+    }
+    free(job);
+    return rc;
+}
+
+/* Seq 550..599 lost: the window opened at 500 ends at 549, the next one starts with clean history. */
+static int test_seq_gap(void)
+{
+    trigger_job_t *job = new_job("pre=100,post=100,ch=1,rise=0", TEST_TRIGGER_SHORT_FRAMES);
+    int rc = -1;
+
+    if (job == NULL) {
+        return -1;
+    }
+    job->gap_from = 550U;
+    job->gap_to = 600U;
+    if (trigger_job_run(job) == 0) {
+        if (job->events >= 2U && job->hits[0].seq == 500U && job->hits[0].frame_count == 150U &&
+            job->hits[1].seq == 1500U && job->hits[1].pre_frames == 100U && job->hits[1].frame_count == 201U &&
+            job->stats.truncated == 1U) {
+            rc = 0;
+        } else {
+            fprintf(stderr, "trigger gap: first events %" PRIu64 "/%" PRIu32 " frames, %" PRIu64 "/%" PRIu32
+                " frames, %" PRIu64 " truncated\n", job->hits[0].seq, job->hits[0].frame_count, job->hits[1].seq,
+                job->hits[1].frame_count, job->stats.truncated);
+        }
+    }
+    free(job);
+    return rc;
+}
+
+int main(void)
+{
+    static const test_case_t cases[] = {
+        {"conditions, windows and EVENT round trips", test_conditions},
+        {"noise retriggers without hysteresis", test_chatter},
+        {"external edge", test_external},
+        {"seq gap cuts the open window", test_seq_gap}
+    };
+
+    fill_trigger_source();
+    return test_run("trigger", cases, sizeof(cases) / sizeof(cases[0]));
+}
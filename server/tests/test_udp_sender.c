@@ -0,0 +1,310 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Miguel Dovale (University of Arizona)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * UDP DATA transport: synthetic frames through one udp_sender to multicast
+ * listeners on loopback, one frame per sendmmsg() and batched, unpaced and
+ * paced. Datagrams may be lost, but what arrives must be intact and in
+ * order, and every datagram sent must be either received or visible as a
+ * msg_seq jump.
+ */
+
+/* struct ip_mreq is hidden by a strict _POSIX_C_SOURCE. */
+#define _DEFAULT_SOURCE
+
+#include "udp_sender.h"
+#include "test_util.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#define TEST_UDP_FRAMES 200000U
+#define TEST_UDP_LISTENERS 2U
+#define TEST_UDP_GROUP "239.255.12.78"
+#define TEST_UDP_RCVBUF (4 * 1024 * 1024)
+#define TEST_UDP_PUSH_FRAMES 1024U        /* frames per flush, like a server tick */
+#define TEST_UDP_PACED_FPS 421872U        /* eight ADS1278s at 52734 Hz */
+#define TEST_UDP_IDLE_MS 200U             /* receivers stop after this long without a datagram */
+#define TEST_UDP_DECODE_FRAMES 64U
+
+typedef struct {
+    int fd;
+    uint64_t datagrams;
+    uint64_t frames;
+    uint64_t lost;              /* msg_seq jumps */
+    uint64_t bad;               /* undecodable datagrams or frames that differ from the source */
+    uint64_t reordered;         /* msg_seq going backwards */
+    uint32_t next_msg;
+} udp_rx_t;
+
+typedef struct {
+    udp_rx_t rx[TEST_UDP_LISTENERS];
+    atomic_bool sending;        /* cleared once the sender has flushed its last datagram */
+} udp_rx_thread_t;
+
+static void udp_rx_datagram(udp_rx_t *rx, const uint8_t *buf, size_t len)
+{
+    ads1278_frame_t frames[TEST_UDP_DECODE_FRAMES];
+    proto_header_t hdr;
+    proto_data_info_t info;
+    uint32_t idx;
+
+    if (len < PROTO_HEADER_BYTES || proto_decode_header(buf, &hdr) != 0 ||
+        hdr.payload_len != len - PROTO_HEADER_BYTES) {
+        ++rx->bad;
+        return;
+    }
+    if (hdr.type != PROTO_MSG_DATA) {
+        return;
+    }
+    if (proto_decode_data_info(buf + PROTO_HEADER_BYTES, hdr.payload_len, &info) != 0 ||
+        info.frame_count > TEST_UDP_DECODE_FRAMES) {
+        ++rx->bad;
+        return;
+    }
+    if ((int32_t)(hdr.msg_seq - rx->next_msg) < 0) {
+        ++rx->reordered;
+    } else {
+        rx->lost += hdr.msg_seq - rx->next_msg;
+        rx->next_msg = hdr.msg_seq + 1U;
+    }
+    proto_data_decode_frames(&info, 0U, info.frame_count, frames);
+    for (idx = 0U; idx < info.frame_count; ++idx) {
+        ads1278_frame_t want;
+
+        fill_synthetic_frame(&want, info.first_seq + idx);
+        if (!frames_equal(&frames[idx], &want, ADS1278_CHANNEL_COUNT)) {
+            ++rx->bad;
+            break;
+        }
+    }
+    ++rx->datagrams;
+    rx->frames += info.frame_count;
+}
+
+/* Drain every listener until the sender is done and the group has gone quiet. */
+static void *udp_rx_main(void *arg)
+{
+    udp_rx_thread_t *ctx = arg;
+    struct pollfd pfd[TEST_UDP_LISTENERS];
+    static uint8_t buf[65536];
+    uint32_t idx;
+
+    for (idx = 0U; idx < TEST_UDP_LISTENERS; ++idx) {
+        pfd[idx].fd = ctx->rx[idx].fd;
+        pfd[idx].events = POLLIN;
+    }
+    for (;;) {
+        int n = poll(pfd, TEST_UDP_LISTENERS, (int)TEST_UDP_IDLE_MS);
+
+        if (n == 0 && !atomic_load(&ctx->sending)) {
+            break;
+        }
+        for (idx = 0U; n > 0 && idx < TEST_UDP_LISTENERS; ++idx) {
+            ssize_t len;
+
+            if ((pfd[idx].revents & POLLIN) == 0) {
+                continue;
+            }
+            while ((len = recv(ctx->rx[idx].fd, buf, sizeof(buf), MSG_DONTWAIT)) > 0) {
+                udp_rx_datagram(&ctx->rx[idx], buf, (size_t)len);
+            }
+        }
+    }
+    return NULL;
+}
+
+/* Listener joined to the test group on loopback; port 0 picks one for the first. */
+static int udp_listen(uint16_t *port)
+{
+    struct sockaddr_in addr;
+    struct ip_mreq mreq;
+    socklen_t len = sizeof(addr);
+    int rcvbuf = TEST_UDP_RCVBUF;
+    int one = 1;
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+
+    if (fd < 0) {
+        return -1;
+    }
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(*port);
+    (void)inet_pton(AF_INET, TEST_UDP_GROUP, &addr.sin_addr);
+    (void)inet_pton(AF_INET, TEST_UDP_GROUP, &mreq.imr_multiaddr);
+    mreq.imr_interface.s_addr = htonl(INADDR_LOOPBACK);
+    (void)setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+    if (setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one)) != 0 ||
+        bind(fd, (const struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+        setsockopt(fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) != 0 ||
+        getsockname(fd, (struct sockaddr *)&addr, &len) != 0) {
+        (void)close(fd);
+        return -1;
+    }
+    *port = ntohs(addr.sin_port);
+    return fd;
+}
+
+static int udp_run(uint32_t batch, uint32_t fps)
+{
+    udp_rx_thread_t ctx;
+    udp_sender_cfg_t cfg;
+    udp_sender_stats_t stats;
+    udp_sender_t *snd = NULL;
+    ads1278_frame_t frames[TEST_UDP_PUSH_FRAMES];
+    pthread_t thread;
+    bool thread_started = false;
+    uint16_t port = 0U;
+    uint64_t seq = 0U;
+    uint64_t received = 0U;
+    uint64_t t0;
+    uint32_t idx;
+    int rc = -1;
+
+    memset(&ctx, 0, sizeof(ctx));
+    memset(&cfg, 0, sizeof(cfg));
+    for (idx = 0U; idx < TEST_UDP_LISTENERS; ++idx) {
+        ctx.rx[idx].fd = -1;
+    }
+    for (idx = 0U; idx < TEST_UDP_LISTENERS; ++idx) {
+        ctx.rx[idx].fd = udp_listen(&port);
+        if (ctx.rx[idx].fd < 0) {
+            perror("udp listener");
+            goto out;
+        }
+    }
+
+    cfg.dest = TEST_UDP_GROUP;
+    cfg.port = port;
+    cfg.iface = "127.0.0.1";
+    cfg.batch = batch;
+    cfg.sndbuf = TEST_UDP_RCVBUF;
+    if (udp_sender_create(&snd, &cfg) != 0) {
+        perror("udp_sender_create");
+        goto out;
+    }
+    atomic_store(&ctx.sending, true);
+    if (pthread_create(&thread, NULL, udp_rx_main, &ctx) != 0) {
+        perror("pthread_create");
+        goto out;
+    }
+    thread_started = true;
+
+    t0 = now_ns();
+    while (seq < TEST_UDP_FRAMES) {
+        size_t n = (TEST_UDP_FRAMES - seq < TEST_UDP_PUSH_FRAMES) ? (size_t)(TEST_UDP_FRAMES - seq)
+                                                                 : TEST_UDP_PUSH_FRAMES;
+
+        for (idx = 0U; idx < n; ++idx) {
+            fill_synthetic_frame(&frames[idx], seq + idx);
+        }
+        udp_sender_push(snd, frames, n);
+        udp_sender_flush(snd);
+        seq += n;
+        if (fps != 0U) {
+            uint64_t due = t0 + (seq * 1000000000ULL) / fps;
+            uint64_t now = now_ns();
+
+            if (due > now) {
+                nap_ns(due - now);
+            }
+        }
+    }
+    udp_sender_get_stats(snd, &stats);
+    atomic_store(&ctx.sending, false);
+    pthread_join(thread, NULL);
+    thread_started = false;
+
+    for (idx = 0U; idx < TEST_UDP_LISTENERS; ++idx) {
+        udp_rx_t *rx = &ctx.rx[idx];
+
+        /* Datagrams lost after the last one received show up as a short count. */
+        rx->lost += stats.datagrams - rx->next_msg;
+        if (rx->datagrams + rx->lost != stats.datagrams || rx->bad != 0U || rx->reordered != 0U) {
+            fprintf(stderr, "udp batch %u listener %u: %" PRIu64 " received + %" PRIu64 " lost != %" PRIu64
+                " sent, %" PRIu64 " bad, %" PRIu64 " reordered\n", batch, idx, rx->datagrams, rx->lost,
+                stats.datagrams, rx->bad, rx->reordered);
+            goto out;
+        }
+        received += rx->datagrams;
+    }
+    if (stats.frames != TEST_UDP_FRAMES || stats.dropped != 0U || stats.send_errors != 0U || received == 0U) {
+        fprintf(stderr, "udp batch %u: packed %" PRIu64 " of %u frames, %" PRIu64 " dropped by the socket, %"
+            PRIu64 " send error(s), %" PRIu64 " received\n", batch, stats.frames, TEST_UDP_FRAMES, stats.dropped,
+            stats.send_errors, received);
+        goto out;
+    }
+    rc = 0;
+
+out:
+    if (thread_started) {
+        atomic_store(&ctx.sending, false);
+        pthread_join(thread, NULL);
+    }
+    udp_sender_destroy(snd);
+    for (idx = 0U; idx < TEST_UDP_LISTENERS; ++idx) {
+        if (ctx.rx[idx].fd >= 0) {
+            (void)close(ctx.rx[idx].fd);
+        }
+    }
+    return rc;
+}
+
+static int test_single(void)
+{
+    return udp_run(1U, 0U);
+}
+
+static int test_batched(void)
+{
+    return udp_run(UDP_DEFAULT_BATCH, 0U);
+}
+
+static int test_paced(void)
+{
+    return udp_run(UDP_DEFAULT_BATCH, TEST_UDP_PACED_FPS);
+}
+
+int main(void)
+{
+    static const test_case_t cases[] = {
+        {"one datagram per sendmmsg()", test_single},
+        {"batched sendmmsg()", test_batched},
+        {"batched, paced at 8 x 52734 frames/s", test_paced}
+    };
+
+    return test_run("udp_sender", cases, sizeof(cases) / sizeof(cases[0]));
+}
@@ -0,0 +1,143 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Miguel Dovale (University of Arizona)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * 24-bit TDM unpack: every implementation this CPU supports against the
+ * scalar reference, interleaved and channel-major, for every tail length.
+ */
+
+#include "ads1278_unpack.h"
+#include "test_util.h"
+
+#define TEST_UNPACK_FRAMES 256U
+
+/* Random frames with the 24-bit extremes planted in the first few samples. */
+static void fill_random_frames(uint8_t *raw, size_t nframes, uint64_t seed)
+{
+    static const uint32_t k_edges[] = {0x000000U, 0x000001U, 0x7FFFFFU, 0x800000U, 0x800001U, 0xFFFFFFU};
+    size_t idx;
+
+    for (idx = 0U; idx < nframes * ADS1278_TDM_FRAME_BYTES; ++idx) {
+        raw[idx] = (uint8_t)xorshift64(&seed);
+    }
+    for (idx = 0U; idx < sizeof(k_edges) / sizeof(k_edges[0]) && idx < nframes * ADS1278_CHANNEL_COUNT; ++idx) {
+        raw[(idx * 3U) + 0U] = (uint8_t)(k_edges[idx] >> 16U);
+        raw[(idx * 3U) + 1U] = (uint8_t)(k_edges[idx] >> 8U);
+        raw[(idx * 3U) + 2U] = (uint8_t)k_edges[idx];
+    }
+}
+
+/* Bit-exact comparison against the scalar reference for every tail length up to nframes. */
+static int check_unpack_impl(const uint8_t *raw, size_t nframes, int32_t *ref, int32_t *got,
+                             int32_t *const ch[ADS1278_CHANNEL_COUNT])
+{
+    size_t n;
+
+    ads1278_unpack_frames_ref(raw, nframes, ref);
+    for (n = 0U; n <= nframes; n = (n < 33U) ? n + 1U : (n == nframes ? n + 1U : nframes)) {
+        size_t idx;
+        uint32_t channel;
+
+        memset(got, 0x5A, nframes * ADS1278_CHANNEL_COUNT * sizeof(*got));
+        ads1278_unpack_frames(raw, n, got);
+        if (memcmp(ref, got, n * ADS1278_CHANNEL_COUNT * sizeof(*got)) != 0) {
+            fprintf(stderr, "unpack mismatch (interleaved, %zu frames)\n", n);
+            return -1;
+        }
+        if (n < nframes && got[n * ADS1278_CHANNEL_COUNT] != 0x5A5A5A5A) {
+            fprintf(stderr, "unpack wrote past %zu frames\n", n);
+            return -1;
+        }
+
+        ads1278_unpack_frames_soa(raw, n, ch);
+        for (channel = 0U; channel < ADS1278_CHANNEL_COUNT; ++channel) {
+            for (idx = 0U; idx < n; ++idx) {
+                if (ch[channel][idx] != ref[(idx * ADS1278_CHANNEL_COUNT) + channel]) {
+                    fprintf(stderr, "unpack mismatch (channel-major, %zu frames, frame %zu ch%u)\n",
+                        n, idx, channel + 1U);
+                    return -1;
+                }
+            }
+        }
+    }
+
+    return 0;
+}
+
+static int test_unpack_impls(void)
+{
+    const size_t nframes = TEST_UNPACK_FRAMES;
+    uint8_t *raw = malloc(nframes * ADS1278_TDM_FRAME_BYTES);
+    int32_t *ref = malloc(nframes * ADS1278_CHANNEL_COUNT * sizeof(*ref));
+    int32_t *got = malloc(nframes * ADS1278_CHANNEL_COUNT * sizeof(*got));
+    int32_t *ch[ADS1278_CHANNEL_COUNT];
+    ads1278_unpack_impl_t saved = ads1278_unpack_active();
+    ads1278_unpack_impl_t impl;
+    uint32_t channel;
+    int rc = -1;
+
+    if (raw == NULL || ref == NULL || got == NULL) {
+        perror("malloc");
+        goto out;
+    }
+    /* Channel-major view carved out of the same buffer as the interleaved output. */
+    for (channel = 0U; channel < ADS1278_CHANNEL_COUNT; ++channel) {
+        ch[channel] = got + (channel * nframes);
+    }
+    fill_random_frames(raw, nframes, 0x9E3779B97F4A7C15ULL);
+
+    for (impl = ADS1278_UNPACK_SCALAR; impl < ADS1278_UNPACK_IMPL_COUNT; ++impl) {
+        if (ads1278_unpack_select(impl) != 0) {
+            continue;
+        }
+        if (check_unpack_impl(raw, nframes, ref, got, ch) != 0) {
+            fprintf(stderr, "unpack implementation %s is not bit-exact\n", ads1278_unpack_impl_name(impl));
+            goto out;
+        }
+    }
+    rc = 0;
+
+out:
+    (void)ads1278_unpack_select(saved);
+    free(raw);
+    free(ref);
+    free(got);
+    return rc;
+}
+
+int main(void)
+{
+    static const test_case_t cases[] = {
+        {"implementations vs reference", test_unpack_impls}
+    };
+
+    return test_run("unpack", cases, sizeof(cases) / sizeof(cases[0]));
+}
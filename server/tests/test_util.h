@@ -0,0 +1,162 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Miguel Dovale (University of Arizona)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef TEST_UTIL_H
+#define TEST_UTIL_H
+
+#include "ads1278.h"
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/*
+ * Helpers shared by the host unit tests. Each test program is a table of
+ * cases run in order; a case prints why it failed to stderr and returns -1.
+ */
+
+typedef struct {
+    const char *name;
+    int (*run)(void);
+} test_case_t;
+
+static inline int test_run(const char *module, const test_case_t *cases, size_t count)
+{
+    size_t failed = 0U;
+    size_t idx;
+
+    for (idx = 0U; idx < count; ++idx) {
+        int rc;
+
+        fflush(stdout);
+        rc = cases[idx].run();
+        printf("%-12s %-44s %s\n", module, cases[idx].name, (rc == 0) ? "ok" : "FAILED");
+        failed += (rc == 0) ? 0U : 1U;
+    }
+    if (failed != 0U) {
+        printf("%s: %zu of %zu case(s) failed\n", module, failed, count);
+    }
+    return (failed == 0U) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+static inline uint64_t now_ns(void)
+{
+    struct timespec ts = {0, 0};
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+static inline void nap_ns(uint64_t ns)
+{
+    struct timespec ts;
+
+    ts.tv_sec = (time_t)(ns / 1000000000ULL);
+    ts.tv_nsec = (long)(ns % 1000000000ULL);
+    (void)nanosleep(&ts, NULL);
+}
+
+static inline uint64_t xorshift64(uint64_t *state)
+{
+    uint64_t x = *state;
+
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    *state = x;
+    return x;
+}
+
+/* Uniform in [0, 1) with 53 random bits. */
+static inline double test_uniform(uint64_t *state)
+{
+    return (double)(xorshift64(state) >> 11U) / 9007199254740992.0;
+}
+
+/* Value the sim backend's ramp signal produces for a conversion/channel. */
+static inline int32_t sim_ramp_value(uint64_t index, uint32_t channel)
+{
+    uint32_t raw24 = (uint32_t)(index * (uint64_t)(channel + 1U)) & 0xFFFFFFU;
+
+    return (int32_t)(raw24 ^ 0x800000U) - 0x800000;
+}
+
+/* Conversion index (mod 2^24) of a sim ramp frame: channel 1 carries it. */
+static inline uint32_t sim_ramp_index(const ads1278_frame_t *frame)
+{
+    return (uint32_t)frame->ch[0] & 0xFFFFFFU;
+}
+
+/* Synthetic frame seq: 1 us per seq, sim ramp samples on every channel. */
+static inline void fill_synthetic_frame(ads1278_frame_t *frame, uint64_t seq)
+{
+    uint32_t channel;
+
+    frame->seq = seq;
+    frame->tstamp_ns = seq * 1000ULL;
+    for (channel = 0U; channel < ADS1278_MAX_CHANNELS; ++channel) {
+        frame->ch[channel] = sim_ramp_value(seq, channel);
+    }
+}
+
+/* Decoders only fill the channels a message carries. */
+static inline bool frames_equal(const ads1278_frame_t *a, const ads1278_frame_t *b, uint32_t channels)
+{
+    return a->seq == b->seq && a->tstamp_ns == b->tstamp_ns &&
+        memcmp(a->ch, b->ch, channels * sizeof(a->ch[0])) == 0;
+}
+
+/* Open a free-running ramp sim on the process-wide device. */
+static inline int open_free_running_sim(void)
+{
+    ads1278_cfg_t cfg = {0};
+
+    cfg.backend = ADS1278_BACKEND_SIM;
+    cfg.sim.drdy_rate_hz = 0U;
+    cfg.sim.signal = ADS1278_SIM_SIGNAL_RAMP;
+    if (ads1278_open(&cfg) != 0) {
+        perror("ads1278_open");
+        return -1;
+    }
+    if (ads1278_start() != 0) {
+        perror("ads1278_start");
+        ads1278_close();
+        return -1;
+    }
+    return 0;
+}
+
+#endif /* TEST_UTIL_H */
@@ -0,0 +1,3697 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Miguel Dovale (University of Arizona)
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Host-side benchmarks for the acquisition software path. Every mode runs on
+ * the sim backend or on synthetic buffers and prints one summary line per
+ * variant; pass/fail checks for the same modules live in tests/.
+ */
+
+/* struct ip_mreq is hidden by a strict _POSIX_C_SOURCE. */
+#define _DEFAULT_SOURCE
+
+#include "acq.h"
+#include "ads1278.h"
+#include "ads1278_unpack.h"
+#include "capture_file.h"
+#include "capture_segments.h"
+#include "capture_writer.h"
+#include "chan_stats.h"
+#include "clock_model.h"
+#include "decim.h"
+#include "drdy_model.h"
+#include "psd.h"
+#include "sample_codec.h"
+#include "shm_ring.h"
+#include "stream_server.h"
+#include "trigger.h"
+#include "udp_sender.h"
+#include "uring.h"
+
+#include <arpa/inet.h>
+#include <dirent.h>
+#include <errno.h>
+#include <getopt.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <math.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#define BENCH_DEFAULT_FRAMES 1000000U
+#define BENCH_DEFAULT_BLOCK_FRAMES 256U
+#define BENCH_CAPTURE_GAP_EVERY 100U
+#define BENCH_DEFAULT_CLIENTS 2U
+#define BENCH_DEFAULT_DEVICES 4U
+#define BENCH_MAX_DEVICES 16U
+#define BENCH_STREAM_RING_FRAMES 65536U
+#define BENCH_STREAM_RX_BYTES (1024U * 1024U)
+#define BENCH_STREAM_STALLED_RCVBUF 4096
+#define BENCH_STREAM_DECODE_FRAMES 64U
+#define BENCH_RESUME_STALL_MS 200U
+#define BENCH_RESUME_STALL_AFTER_FRAMES 100000U
+#define BENCH_RESUME_SHORT_HISTORY_FRAMES 65536U  /* ~30 ms of the free-running sim */
+#define BENCH_RESUME_LONG_HISTORY_FRAMES (2U * 1024U * 1024U)
+#define BENCH_RESUME_MAX_LAG_MS 50U
+#define BENCH_UDP_GROUP "239.255.12.78"
+#define BENCH_UDP_RCVBUF (4 * 1024 * 1024)
+#define BENCH_UDP_PUSH_FRAMES 1024U        /* frames per flush, like a server tick */
+#define BENCH_UDP_PACED_FPS 421872U        /* eight ADS1278s at 52734 Hz */
+#define BENCH_UDP_IDLE_MS 200U             /* receivers stop after this long without a datagram */
+#define BENCH_SHM_SMALL_RING_FRAMES 4096U
+#define BENCH_SHM_SLOW_BATCH 256U
+#define BENCH_SHM_SLOW_NAP_NS 200000U    /* mid-batch, so the writer laps it while it reads */
+#define BENCH_WIRE_SOURCE_FRAMES 65536U
+#define BENCH_CHAIN_SOURCE_FRAMES 16384U
+#define BENCH_CODEC_SOURCE_FRAMES 65536U
+#define BENCH_CODEC_RATE_HZ 52734.0
+#define BENCH_DECIM_SOURCE_FRAMES 65536U
+#define BENCH_DECIM_PERIOD_NS 100000U
+#define BENCH_DECIM_DC 1000000
+#define BENCH_RT_RATE_HZ 8000U
+#define BENCH_RT_FRAMES 20000U
+#define BENCH_RT_PRIORITY 80
+#define BENCH_RT_LOAD_BYTES (4U * 1024U * 1024U)
+#define BENCH_DRDY_PERIOD_NS 18963.0      /* 52734 Hz, ADS1278 high-resolution mode at 27 MHz */
+#define BENCH_DRDY_MODEL_FRAMES 200000U
+#define BENCH_DRDY_GAP_PROB 0.005
+#define BENCH_DRDY_GAP_MAX 64U
+#define BENCH_DRDY_SWEEP_SECONDS 0.5
+#define BENCH_TRIGGER_SOURCE_FRAMES 6000U    /* common period of the trigger test signals */
+#define BENCH_TRIGGER_PERIOD_NS 20000U
+#define BENCH_STATS_MAX_SAMPLES (1U << 22)
+#define BENCH_CALIB_SOURCE_FRAMES 65536U
+#define BENCH_PSD_PERIOD_NS 20000U         /* 50 kHz */
+#define BENCH_CLOCK_RATE_HZ 52734U
+#define BENCH_CLOCK_FRAMES 262144U         /* ~5 s at BENCH_CLOCK_RATE_HZ */
+#define BENCH_CLOCK_DRIFT_PPM 25.0         /* board clock vs nominal */
+#define BENCH_CLOCK_OUTLIER_PROB 0.001
+#define BENCH_CLOCK_OUTLIER_NS 1500000.0   /* a scheduling stall */
+#define BENCH_CLOCK_STEP_NS 50000000.0     /* timestamp step the model relocks after */
+#define BENCH_CLOCK_SETTLE_FRAMES 26367U   /* 0.5 s excluded after the step */
+
+typedef struct {
+    uint64_t frames;
+    bool frames_set;            /* rt: --frames given, else BENCH_RT_FRAMES */
+    uint32_t block_frames;
+    uint32_t clients;
+    uint32_t devices;
+    const char *in_path;        /* codec: recorded v1/v2 capture file */
+} bench_opts_t;
+
+typedef struct {
+    const char *name;
+    const char *summary;
+    int (*run)(const bench_opts_t *opts);
+} bench_mode_t;
+
+static void usage(FILE *stream, const char *prog_name);
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts = {0, 0};
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+static void nap_ns(uint64_t ns)
+{
+    struct timespec ts;
+
+    ts.tv_sec = (time_t)(ns / 1000000000ULL);
+    ts.tv_nsec = (long)(ns % 1000000000ULL);
+    (void)nanosleep(&ts, NULL);
+}
+
+static void report(const char *label, uint64_t items, uint64_t elapsed_ns, const char *unit)
+{
+    double seconds = (double)elapsed_ns * 1e-9;
+
+    printf("%-28s %12" PRIu64 " %s in %8.3f ms  %14.0f %s/s  %8.1f ns/%s\n",
+        label, items, unit, seconds * 1e3,
+        (seconds > 0.0) ? (double)items / seconds : 0.0, unit,
+        (items != 0U) ? (double)elapsed_ns / (double)items : 0.0, unit);
+}
+
+static int parse_u32(const char *text, uint32_t *out_value)
+{
+    char *end = NULL;
+    unsigned long value;
+
+    errno = 0;
+    value = strtoul(text, &end, 10);
+    if (errno != 0 || end == text || *end != '\0' || value > UINT32_MAX) {
+        return -1;
+    }
+
+    *out_value = (uint32_t)value;
+    return 0;
+}
+
+static int parse_u64(const char *text, uint64_t *out_value)
+{
+    char *end = NULL;
+    unsigned long long value;
+
+    errno = 0;
+    value = strtoull(text, &end, 10);
+    if (errno != 0 || end == text || *end != '\0') {
+        return -1;
+    }
+
+    *out_value = (uint64_t)value;
+    return 0;
+}
+
+/* Value the sim backend's ramp signal produces for a conversion/channel. */
+static int32_t sim_ramp_value(uint64_t index, uint32_t channel)
+{
+    uint32_t raw24 = (uint32_t)(index * (uint64_t)(channel + 1U)) & 0xFFFFFFU;
+
+    return (int32_t)(raw24 ^ 0x800000U) - 0x800000;
+}
+
+static int open_free_running_sim(void)
+{
+    ads1278_cfg_t cfg = {0};
+
+    cfg.backend = ADS1278_BACKEND_SIM;
+    cfg.sim.drdy_rate_hz = 0U;
+    cfg.sim.signal = ADS1278_SIM_SIGNAL_RAMP;
+
+    if (ads1278_open(&cfg) != 0) {
+        perror("ads1278_open");
+        return -1;
+    }
+    if (ads1278_start() != 0) {
+        perror("ads1278_start");
+        ads1278_close();
+        return -1;
+    }
+    return 0;
+}
+
+static int bench_read(const bench_opts_t *opts)
+{
+    ads1278_block_pool_t *pool = NULL;
+    ads1278_block_t *blk = NULL;
+    uint64_t done = 0U;
+    uint64_t t0;
+    int rc = -1;
+
+    /* 1) one ads1278_read_frame() per frame, array-of-structs */
+    if (open_free_running_sim() != 0) {
+        return -1;
+    }
+    t0 = now_ns();
+    for (done = 0U; done < opts->frames; ++done) {
+        ads1278_frame_t frame;
+
+        if (ads1278_read_frame(&frame) != 0) {
+            perror("ads1278_read_frame");
+            goto out;
+        }
+    }
+    report("read_frame (AoS)", done, now_ns() - t0, "frame");
+    ads1278_stop();
+    ads1278_close();
+
+    /* 2) ads1278_read_frames() into pooled channel-major blocks */
+    if (ads1278_block_pool_create(&pool, 2U, opts->block_frames) != 0) {
+        perror("ads1278_block_pool_create");
+        return -1;
+    }
+    blk = ads1278_block_acquire(pool);
+    if (blk == NULL || open_free_running_sim() != 0) {
+        goto out;
+    }
+
+    t0 = now_ns();
+    for (done = 0U; done < opts->frames; done += blk->count) {
+        size_t n = opts->block_frames;
+
+        if (opts->frames - done < n) {
+            n = (size_t)(opts->frames - done);
+        }
+        if (ads1278_read_frames(blk, n) != 0) {
+            perror("ads1278_read_frames");
+            goto out;
+        }
+    }
+    report("read_frames (SoA blocks)", done, now_ns() - t0, "frame");
+    rc = 0;
+
+out:
+    ads1278_stop();
+    ads1278_close();
+    ads1278_block_release(pool, blk);
+    ads1278_block_pool_destroy(pool);
+    return rc;
+}
+
+static uint64_t xorshift64(uint64_t *state)
+{
+    uint64_t x = *state;
+
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    *state = x;
+    return x;
+}
+
+static void fill_random_frames(uint8_t *raw, size_t nframes, uint64_t seed)
+{
+    size_t idx;
+
+    for (idx = 0U; idx < nframes * ADS1278_TDM_FRAME_BYTES; ++idx) {
+        raw[idx] = (uint8_t)xorshift64(&seed);
+    }
+}
+
+static int bench_unpack(const bench_opts_t *opts)
+{
+    size_t nframes = opts->block_frames;
+    uint8_t *raw = NULL;
+    int32_t *got = NULL;
+    int32_t *ch[ADS1278_CHANNEL_COUNT];
+    ads1278_unpack_impl_t saved = ads1278_unpack_active();
+    ads1278_unpack_impl_t impl;
+    uint32_t channel;
+    int rc = -1;
+
+    raw = malloc(nframes * ADS1278_TDM_FRAME_BYTES);
+    got = malloc(nframes * ADS1278_CHANNEL_COUNT * sizeof(*got));
+    if (raw == NULL || got == NULL) {
+        perror("malloc");
+        goto out;
+    }
+    /* Channel-major view carved out of the same buffer as the interleaved output. */
+    for (channel = 0U; channel < ADS1278_CHANNEL_COUNT; ++channel) {
+        ch[channel] = got + (channel * nframes);
+    }
+    fill_random_frames(raw, nframes, 0x9E3779B97F4A7C15ULL);
+
+    printf("default unpack: %s\n", ads1278_unpack_impl_name(saved));
+    for (impl = ADS1278_UNPACK_SCALAR; impl < ADS1278_UNPACK_IMPL_COUNT; ++impl) {
+        char label[64];
+        uint64_t done;
+        uint64_t t0;
+
+        if (ads1278_unpack_select(impl) != 0) {
+            continue;
+        }
+
+        t0 = now_ns();
+        for (done = 0U; done < opts->frames; done += nframes) {
+            ads1278_unpack_frames(raw, nframes, got);
+        }
+        snprintf(label, sizeof(label), "unpack %s (interleaved)", ads1278_unpack_impl_name(impl));
+        report(label, done, now_ns() - t0, "frame");
+
+        t0 = now_ns();
+        for (done = 0U; done < opts->frames; done += nframes) {
+            ads1278_unpack_frames_soa(raw, nframes, ch);
+        }
+        snprintf(label, sizeof(label), "unpack %s (channel-major)", ads1278_unpack_impl_name(impl));
+        report(label, done, now_ns() - t0, "frame");
+    }
+    rc = 0;
+
+out:
+    (void)ads1278_unpack_select(saved);
+    free(raw);
+    free(got);
+    return rc;
+}
+
+static void fill_synthetic_frame(ads1278_frame_t *frame, uint64_t seq)
+{
+    uint32_t channel;
+
+    frame->seq = seq;
+    frame->tstamp_ns = seq * 1000ULL;
+    for (channel = 0U; channel < ADS1278_CHANNEL_COUNT; ++channel) {
+        frame->ch[channel] = sim_ramp_value(seq, channel);
+    }
+}
+
+/* The baseline ads1278_dump record writer: ten fwrite() calls per record. */
+static int fwrite_record_per_field(FILE *out_file, const ads1278_frame_t *frame)
+{
+    uint8_t bytes[8];
+    uint32_t idx;
+    uint32_t channel;
+
+    for (idx = 0U; idx < 8U; ++idx) {
+        bytes[idx] = (uint8_t)(frame->seq >> (idx * 8U));
+    }
+    if (fwrite(bytes, 1U, 8U, out_file) != 8U) {
+        return -1;
+    }
+    for (idx = 0U; idx < 8U; ++idx) {
+        bytes[idx] = (uint8_t)(frame->tstamp_ns >> (idx * 8U));
+    }
+    if (fwrite(bytes, 1U, 8U, out_file) != 8U) {
+        return -1;
+    }
+    for (channel = 0U; channel < ADS1278_CHANNEL_COUNT; ++channel) {
+        for (idx = 0U; idx < 4U; ++idx) {
+            bytes[idx] = (uint8_t)((uint32_t)frame->ch[channel] >> (idx * 8U));
+        }
+        if (fwrite(bytes, 1U, 4U, out_file) != 4U) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/* Seq of the k-th written frame when one conversion in every gap_every + 1 is missed (0 = none). */
+static uint64_t gapped_seq(uint64_t k, uint32_t gap_every)
+{
+    return (gap_every == 0U) ? k : k + (k / gap_every);
+}
+
+/* Time seeks to random timestamps in a v2 file, each landing between two frames. */
+static int bench_capture_seek(const char *path, uint64_t frames, uint32_t gap_every, uint32_t seeks)
+{
+    capture_file_t *cf = NULL;
+    uint64_t rng = 0x9E3779B97F4A7C15ULL;
+    uint64_t t0;
+    uint32_t idx;
+    int rc = -1;
+
+    if (frames < 2U) {
+        return 0;
+    }
+    if (capture_file_open(&cf, path) != 0) {
+        perror("capture_file_open");
+        return -1;
+    }
+    t0 = now_ns();
+    for (idx = 0U; idx < seeks; ++idx) {
+        /* Synthetic frames are 1 us per seq apart; aim between frame k - 1 and frame k. */
+        uint64_t k = 1U + (xorshift64(&rng) % (frames - 1U));
+
+        if (capture_file_seek_time(cf, (gapped_seq(k, gap_every) * 1000ULL) - 500U) != 0) {
+            perror("capture_file_seek_time");
+            goto out;
+        }
+    }
+    report("capture_file seek_time", seeks, now_ns() - t0, "seek");
+    rc = 0;
+
+out:
+    capture_file_close(cf);
+    return rc;
+}
+
+static int bench_capture_v2(const bench_opts_t *opts, const char *path, uint16_t encoding, uint32_t gap_every,
+                            ads1278_frame_t *batch)
+{
+    capture_file_cfg_t cfg = {0};
+    capture_file_writer_t *cf = NULL;
+    capture_writer_stats_t stats = {0};
+    char label[64];
+    uint64_t done;
+    uint64_t t0;
+
+    cfg.encoding = encoding;
+    snprintf(cfg.acq.writer, sizeof(cfg.acq.writer), "ads1278_bench");
+    if (capture_file_create(&cf, path, &cfg) != 0) {
+        perror("capture_file_create");
+        return -1;
+    }
+    t0 = now_ns();
+    for (done = 0U; done < opts->frames;) {
+        size_t n = opts->block_frames;
+        size_t idx;
+
+        if (opts->frames - done < n) {
+            n = (size_t)(opts->frames - done);
+        }
+        for (idx = 0U; idx < n; ++idx) {
+            fill_synthetic_frame(&batch[idx], gapped_seq(done + idx, gap_every));
+        }
+        if (capture_file_append(cf, batch, n) != 0) {
+            perror("capture_file_append");
+            (void)capture_file_finish(cf, NULL, NULL);
+            return -1;
+        }
+        done += n;
+    }
+    if (capture_file_finish(cf, &stats, NULL) != 0) {
+        perror("capture_file_finish");
+        return -1;
+    }
+    snprintf(label, sizeof(label), "capture_file v2 %s%s (to close)", proto_data_encoding_name(encoding),
+        (gap_every != 0U) ? " gapped" : "");
+    report(label, done, now_ns() - t0, "frame");
+    printf("capture_file v2 %s%s: %.2f byte/frame including header and index\n",
+        proto_data_encoding_name(encoding), (gap_every != 0U) ? " gapped" : "",
+        (double)stats.bytes_written / (double)done);
+    return bench_capture_seek(path, opts->frames, gap_every, 100000U);
+}
+
+static int bench_capture(const bench_opts_t *opts)
+{
+    char path[] = "/tmp/ads1278_bench_XXXXXX";
+    ads1278_frame_t *batch = NULL;
+    capture_writer_cfg_t cfg = {0};
+    capture_writer_t *writer = NULL;
+    capture_writer_stats_t stats = {0};
+    FILE *out_file = NULL;
+    uint64_t done;
+    uint64_t t0;
+    int fd;
+    int rc = -1;
+
+    fd = mkstemp(path);
+    if (fd < 0) {
+        perror("mkstemp");
+        return -1;
+    }
+    (void)close(fd);
+
+    batch = malloc(opts->block_frames * sizeof(*batch));
+    if (batch == NULL) {
+        perror("malloc");
+        goto out;
+    }
+
+    /* 1) per-field fwrite through stdio */
+    out_file = fopen(path, "wb");
+    if (out_file == NULL) {
+        perror("fopen");
+        goto out;
+    }
+    t0 = now_ns();
+    for (done = 0U; done < opts->frames; ++done) {
+        ads1278_frame_t frame;
+
+        fill_synthetic_frame(&frame, done);
+        if (fwrite_record_per_field(out_file, &frame) != 0) {
+            perror("fwrite");
+            goto out;
+        }
+    }
+    if (fclose(out_file) != 0) {
+        out_file = NULL;
+        perror("fclose");
+        goto out;
+    }
+    out_file = NULL;
+    report("fwrite per field", done, now_ns() - t0, "frame");
+
+    /* 2) capture writer, batches of --block-frames */
+    cfg.prealloc_bytes = opts->frames * CAPTURE_RECORD_V1_BYTES;
+    if (capture_writer_open(&writer, path, &cfg) != 0) {
+        perror("capture_writer_open");
+        goto out;
+    }
+    t0 = now_ns();
+    for (done = 0U; done < opts->frames;) {
+        size_t n = opts->block_frames;
+        size_t idx;
+
+        if (opts->frames - done < n) {
+            n = (size_t)(opts->frames - done);
+        }
+        for (idx = 0U; idx < n; ++idx) {
+            fill_synthetic_frame(&batch[idx], done + idx);
+        }
+        if (capture_writer_append_frames(writer, batch, n) != 0) {
+            perror("capture_writer_append_frames");
+            goto out;
+        }
+        done += n;
+    }
+    report("capture_writer (append)", done, now_ns() - t0, "frame");
+    rc = capture_writer_close(writer, &stats);
+    writer = NULL;
+    if (rc != 0) {
+        perror("capture_writer_close");
+        goto out;
+    }
+    rc = -1;
+    report("capture_writer (to close)", done, stats.elapsed_ns, "frame");
+    printf("capture_writer: %.1f MB/s, worst write %.3f ms, %" PRIu64 " producer stall(s) worst %.3f ms\n",
+        (stats.elapsed_ns != 0U) ? (double)stats.bytes_written * 1e3 / (double)stats.elapsed_ns : 0.0,
+        (double)stats.write_ns_max / 1e6, stats.producer_stalls, (double)stats.producer_stall_ns_max / 1e6);
+
+    /*
+     * 3) v2 file with chunk index, both chunk encodings, plus random time
+     * seeks; then DELTA again missing one conversion in every 101.
+     */
+    if (bench_capture_v2(opts, path, PROTO_DATA_ENC_RECORD48, 0U, batch) != 0 ||
+        bench_capture_v2(opts, path, PROTO_DATA_ENC_DELTA, 0U, batch) != 0 ||
+        bench_capture_v2(opts, path, PROTO_DATA_ENC_DELTA, BENCH_CAPTURE_GAP_EVERY, batch) != 0) {
+        goto out;
+    }
+    rc = 0;
+
+out:
+    if (writer != NULL) {
+        (void)capture_writer_close(writer, NULL);
+    }
+    if (out_file != NULL) {
+        fclose(out_file);
+    }
+    free(batch);
+    (void)unlink(path);
+    return rc;
+}
+
+
+/* Remove a scratch directory and the files in it. */
+static void remove_dir(const char *dir)
+{
+    DIR *d = opendir(dir);
+    struct dirent *ent;
+
+    if (d != NULL) {
+        while ((ent = readdir(d)) != NULL) {
+            char path[PATH_MAX];
+
+            if (strcmp(ent->d_name, ".") != 0 && strcmp(ent->d_name, "..") != 0 &&
+                snprintf(path, sizeof(path), "%s/%s", dir, ent->d_name) < (int)sizeof(path)) {
+                (void)unlink(path);
+            }
+        }
+        (void)closedir(d);
+    }
+    (void)rmdir(dir);
+}
+
+/* Push frames [first, first + frames) through a recorder, pacing to fps when non-zero. */
+static int seg_feed(capture_seg_t *seg, const bench_opts_t *opts, uint64_t first, uint64_t frames, uint64_t fps,
+                    ads1278_frame_t *batch)
+{
+    uint64_t t0 = now_ns();
+    uint64_t done;
+
+    for (done = 0U; done < frames;) {
+        size_t n = opts->block_frames;
+        size_t idx;
+
+        if (frames - done < n) {
+            n = (size_t)(frames - done);
+        }
+        for (idx = 0U; idx < n; ++idx) {
+            fill_synthetic_frame(&batch[idx], first + done + idx);
+        }
+        if (capture_seg_append(seg, batch, n) != 0) {
+            perror("capture_seg_append");
+            return -1;
+        }
+        done += n;
+        if (fps != 0U) {
+            uint64_t due = t0 + (done * 1000000000ULL / fps);
+            uint64_t now = now_ns();
+
+            if (due > now) {
+                nap_ns(due - now);
+            }
+        }
+    }
+    return 0;
+}
+
+static void seg_report(const char *label, const capture_seg_stats_t *st)
+{
+    double mb = (double)st->bytes_written / 1e6;
+
+    report(label, st->frames, st->elapsed_ns, "frame");
+    printf("%s: %.1f MB/s sustained, %" PRIu64 " segment(s) (%" PRIu64 " kept, %" PRIu64 " deleted for the quota, "
+        "%.1f MB on disk), %" PRIu64 " checkpoint(s)\n", label, mb * 1e9 / (double)st->elapsed_ns, st->segments,
+        st->kept_segments, st->deleted, (double)st->kept_bytes / 1e6, st->checkpoints);
+    printf("%s: worst append stall %.3f ms, %" PRIu64 " block wait(s), %" PRIu64 " rotation wait(s) (worst %.3f ms), "
+        "slowest finish %.3f ms, worst fsync %.3f ms, %" PRIu64 " frame(s) dropped upstream\n", label,
+        (double)st->append_ns_max * 1e-6, st->producer_stalls, st->rotate_waits,
+        (double)st->rotate_wait_ns_max * 1e-6, (double)st->finish_ns_max * 1e-6, (double)st->fsync_ns_max * 1e-6,
+        st->missed_frames);
+}
+
+static int seg_run(const bench_opts_t *opts, const char *label, const capture_seg_cfg_t *cfg, uint64_t frames,
+                   uint64_t fps, ads1278_frame_t *batch)
+{
+    capture_seg_t *seg = NULL;
+    capture_seg_stats_t st;
+
+    memset(&st, 0, sizeof(st));
+    if (capture_seg_open(&seg, cfg) != 0) {
+        perror("capture_seg_open");
+        return -1;
+    }
+    if (seg_feed(seg, opts, 0U, frames, fps, batch) != 0) {
+        (void)capture_seg_close(seg, NULL);
+        return -1;
+    }
+    if (capture_seg_close(seg, &st) != 0) {
+        perror("capture_seg_close");
+        return -1;
+    }
+    seg_report(label, &st);
+    return 0;
+}
+
+/* A recorder killed mid-segment: time the next open, which finalizes the .part it left. */
+static int seg_crash_run(const bench_opts_t *opts, const capture_seg_cfg_t *cfg, ads1278_frame_t *batch)
+{
+    capture_seg_t *seg = NULL;
+    capture_seg_stats_t st;
+    uint64_t t0;
+    uint64_t open_ns;
+    int status = 0;
+    pid_t pid;
+
+    memset(&st, 0, sizeof(st));
+    fflush(stdout);
+    pid = fork();
+    if (pid < 0) {
+        perror("fork");
+        return -1;
+    }
+    if (pid == 0) {
+        if (capture_seg_open(&seg, cfg) != 0) {
+            _exit(1);
+        }
+        (void)seg_feed(seg, opts, 0U, UINT64_MAX / 2U, 8U * 52734U, batch);
+        _exit(1);
+    }
+    nap_ns(400000000ULL);
+    (void)kill(pid, SIGKILL);
+    (void)waitpid(pid, &status, 0);
+
+    t0 = now_ns();
+    if (capture_seg_open(&seg, cfg) != 0) {
+        perror("capture_seg_open(recover)");
+        return -1;
+    }
+    open_ns = now_ns() - t0;
+    if (capture_seg_close(seg, &st) != 0) {
+        perror("capture_seg_close");
+        return -1;
+    }
+    printf("segments crash: recorder killed after 400 ms, %" PRIu64 " .part recovered by an open of %.3f ms\n",
+        st.recovered, (double)open_ns * 1e-6);
+    return 0;
+}
+
+static int bench_segments(const bench_opts_t *opts)
+{
+    char dir[] = "/tmp/ads1278_segments_XXXXXX";
+    ads1278_frame_t *batch = NULL;
+    capture_seg_cfg_t cfg;
+    int rc = -1;
+
+    if (mkdtemp(dir) == NULL) {
+        perror("mkdtemp");
+        return -1;
+    }
+    batch = malloc(opts->block_frames * sizeof(*batch));
+    if (batch == NULL) {
+        perror("malloc");
+        goto out;
+    }
+
+    /* 1) size rotation under a quota, flat out */
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.dir = dir;
+    cfg.segment_bytes = 4U * 1024U * 1024U;
+    cfg.quota_bytes = 16U * 1024U * 1024U;
+    cfg.checkpoint_ms = 20U;
+    if (seg_run(opts, "segments 4 MiB quota 16 MiB", &cfg, opts->frames, 0U, batch) != 0) {
+        goto out;
+    }
+    remove_dir(dir);
+
+    /* 2) time rotation (synthetic frames are 1 us apart), delta chunks */
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.dir = dir;
+    cfg.file.encoding = PROTO_DATA_ENC_DELTA;
+    cfg.segment_ms = 100U;
+    cfg.checkpoint_ms = 20U;
+    if (seg_run(opts, "segments 100 ms delta", &cfg, opts->frames, 0U, batch) != 0) {
+        goto out;
+    }
+    remove_dir(dir);
+
+    /* 3) paced at 8 x the ADS1278 rate: stalls when checkpoints and rotations are spread out */
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.dir = dir;
+    cfg.segment_bytes = 4U * 1024U * 1024U;
+    cfg.checkpoint_ms = 20U;
+    if (seg_run(opts, "segments paced", &cfg, 8U * 52734U, 8U * 52734U, batch) != 0) {
+        goto out;
+    }
+    remove_dir(dir);
+
+    /* 4) kill -9 mid-segment, then recover */
+    if (seg_crash_run(opts, &cfg, batch) != 0) {
+        goto out;
+    }
+    rc = 0;
+
+out:
+    free(batch);
+    remove_dir(dir);
+    return rc;
+}
+
+/*
+ * Synthetic acquisition stream for the wire formats: ramp samples, a few ns of
+ * timestamp jitter (none for a clock-model-like stream), and a missed DRDY
+ * every 4099 frames so P24 has to split.
+ */
+static void fill_wire_frames(ads1278_frame_t *frames, size_t n, bool jitter)
+{
+    uint64_t seq = 0U;
+    size_t idx;
+
+    for (idx = 0U; idx < n; ++idx, ++seq) {
+        if (idx != 0U && idx % 4099U == 0U) {
+            ++seq;
+        }
+        fill_synthetic_frame(&frames[idx], seq);
+        if (jitter) {
+            frames[idx].tstamp_ns += (seq * 7919U) % 61U;
+        }
+    }
+}
+
+/*
+ * Encode the source in messages of up to per_msg frames and decode each back.
+ * linear: messages whose timestamps lie on a line carry base + last.
+ */
+static int bench_wire_encoding(const bench_opts_t *opts, uint16_t encoding, uint32_t channels,
+                               const ads1278_frame_t *src, size_t src_frames, bool linear)
+{
+    proto_data_encoder_t enc;
+    proto_data_info_t info;
+    uint32_t per_msg = opts->block_frames;
+    uint8_t *msg = malloc(proto_data_max_bytes(encoding, channels, per_msg));
+    ads1278_frame_t *decoded = malloc((size_t)per_msg * sizeof(*decoded));
+    uint64_t encode_ns = 0U;
+    uint64_t decode_ns = 0U;
+    uint64_t bytes = 0U;
+    uint64_t msgs = 0U;
+    uint64_t done = 0U;
+    char name[32];
+    char label[64];
+    int rc = -1;
+
+    if (msg == NULL || decoded == NULL || proto_data_encoder_init(&enc, encoding, channels, per_msg) != 0) {
+        perror("wire setup");
+        free(msg);
+        free(decoded);
+        return -1;
+    }
+    enc.linear_ts = linear;
+    snprintf(name, sizeof(name), "%s%s", proto_data_encoding_name(encoding), linear ? " linear" : "");
+
+    while (done < opts->frames) {
+        size_t pos = 0U;
+
+        while (pos < src_frames && done < opts->frames) {
+            size_t n = src_frames - pos;
+            size_t taken;
+            size_t len;
+            uint64_t t0;
+            uint64_t t1;
+
+            t0 = now_ns();
+            proto_data_begin(&enc, msg, (uint32_t)msgs, &src[pos]);
+            taken = proto_data_append(&enc, &src[pos], n);
+            len = proto_data_finish(&enc);
+            t1 = now_ns();
+            if (proto_decode_data_info(msg + PROTO_HEADER_BYTES, len - PROTO_HEADER_BYTES, &info) != 0) {
+                fprintf(stderr, "wire %s: message %" PRIu64 " does not parse\n", name, msgs);
+                goto out;
+            }
+            proto_data_decode_frames(&info, 0U, info.frame_count, decoded);
+            decode_ns += now_ns() - t1;
+            encode_ns += t1 - t0;
+            pos += taken;
+            done += taken;
+            bytes += len;
+            ++msgs;
+        }
+    }
+
+    printf("%s: %" PRIu64 " message(s), %.2f byte/frame on the wire\n", name, msgs, (double)bytes / (double)done);
+    snprintf(label, sizeof(label), "encode %s", name);
+    report(label, done, encode_ns, "frame");
+    snprintf(label, sizeof(label), "decode %s", name);
+    report(label, done, decode_ns, "frame");
+    rc = 0;
+
+out:
+    proto_data_encoder_destroy(&enc);
+    free(msg);
+    free(decoded);
+    return rc;
+}
+
+typedef enum {
+    CODEC_SIGNAL_QUIET = 0,     /* +/-4 LSB noise on a per-channel offset */
+    CODEC_SIGNAL_SINE,          /* 1 kHz at 1/8 full scale plus +/-16 LSB noise */
+    CODEC_SIGNAL_RAMP,          /* the sim backend's ramp */
+    CODEC_SIGNAL_NOISE,         /* full-scale white noise, the incompressible case */
+    CODEC_SIGNAL_COUNT
+} codec_signal_t;
+
+static const char *const k_codec_signal_names[CODEC_SIGNAL_COUNT] = {
+    "quiet (+/-4 LSB)", "sine + noise", "sim ramp", "full-scale noise"
+};
+
+static int32_t clamp24(double value)
+{
+    if (value > (double)ADS1278_SAMPLE_MAX) {
+        return ADS1278_SAMPLE_MAX;
+    }
+    if (value < (double)ADS1278_SAMPLE_MIN) {
+        return ADS1278_SAMPLE_MIN;
+    }
+    return (int32_t)value;
+}
+
+static void fill_codec_signal(codec_signal_t signal, int32_t *const ch[ADS1278_CHANNEL_COUNT], size_t n)
+{
+    uint64_t rng = 0x243F6A8885A308D3ULL;
+    uint32_t channel;
+    size_t idx;
+
+    for (channel = 0U; channel < ADS1278_CHANNEL_COUNT; ++channel) {
+        for (idx = 0U; idx < n; ++idx) {
+            int32_t noise = (int32_t)(xorshift64(&rng) % 9U) - 4;
+            double phase = 2.0 * 3.14159265358979323846 * 1000.0 * (double)idx / BENCH_CODEC_RATE_HZ;
+
+            switch (signal) {
+                case CODEC_SIGNAL_QUIET:
+                    ch[channel][idx] = ((int32_t)channel * 1000) - 3500 + noise;
+                    break;
+                case CODEC_SIGNAL_SINE:
+                    ch[channel][idx] = clamp24((double)(ADS1278_SAMPLE_MAX / 8) * sin(phase + (double)channel) +
+                        (double)(noise * 4));
+                    break;
+                case CODEC_SIGNAL_RAMP:
+                    ch[channel][idx] = sim_ramp_value(idx, channel);
+                    break;
+                default:
+                    ch[channel][idx] = (int32_t)((uint32_t)xorshift64(&rng) << 8U) >> 8;
+                    break;
+            }
+        }
+    }
+}
+
+/* Up to max_frames frames of a v1 or v2 capture file, channel-major. */
+static size_t load_codec_recording(const char *path, int32_t *const ch[ADS1278_CHANNEL_COUNT], size_t max_frames)
+{
+    capture_file_t *cf = NULL;
+    ads1278_frame_t frames[256];
+    size_t n = 0U;
+
+    if (capture_file_open(&cf, path) != 0) {
+        perror(path);
+        return 0U;
+    }
+    while (n < max_frames) {
+        size_t want = max_frames - n;
+        long got;
+        long idx;
+
+        if (want > sizeof(frames) / sizeof(frames[0])) {
+            want = sizeof(frames) / sizeof(frames[0]);
+        }
+        got = capture_file_read(cf, frames, want);
+        if (got <= 0) {
+            break;
+        }
+        for (idx = 0; idx < got; ++idx) {
+            uint32_t channel;
+
+            for (channel = 0U; channel < ADS1278_CHANNEL_COUNT; ++channel) {
+                ch[channel][n] = frames[idx].ch[channel];
+            }
+            ++n;
+        }
+    }
+    capture_file_close(cf);
+    return n;
+}
+
+/*
+ * Compress the source in blocks of --block-frames (one codec stream per
+ * channel per block, as in a DELTA message) and decode every block back.
+ * Throughput is quoted in MB/s of 24-bit samples.
+ */
+static int bench_codec_signal(const bench_opts_t *opts, const char *label,
+                              int32_t *const src[ADS1278_CHANNEL_COUNT], size_t src_frames,
+                              uint8_t *packed, int32_t *decoded)
+{
+    uint64_t encode_ns = 0U;
+    uint64_t decode_ns = 0U;
+    uint64_t bytes = 0U;
+    uint64_t done = 0U;
+    double raw_mb;
+
+    while (done < opts->frames) {
+        size_t pos;
+
+        for (pos = 0U; pos < src_frames && done < opts->frames;) {
+            size_t n = src_frames - pos;
+            size_t offsets[ADS1278_CHANNEL_COUNT + 1U];
+            sample_codec_reader_t rd;
+            uint32_t channel;
+            uint64_t t0;
+
+            n = (n < opts->block_frames) ? n : opts->block_frames;
+            offsets[0] = 0U;
+            t0 = now_ns();
+            for (channel = 0U; channel < ADS1278_CHANNEL_COUNT; ++channel) {
+                offsets[channel + 1U] = offsets[channel] + sample_codec_encode(src[channel] + pos, 1U, n,
+                    packed + offsets[channel]);
+            }
+            encode_ns += now_ns() - t0;
+
+            t0 = now_ns();
+            for (channel = 0U; channel < ADS1278_CHANNEL_COUNT; ++channel) {
+                sample_codec_reader_init(&rd, packed + offsets[channel], n);
+                sample_codec_read(&rd, n, decoded + (channel * n), 1U);
+            }
+            decode_ns += now_ns() - t0;
+            bytes += offsets[ADS1278_CHANNEL_COUNT];
+            done += n;
+            pos += n;
+        }
+    }
+
+    raw_mb = (double)done * ADS1278_TDM_FRAME_BYTES / 1e6;
+    printf("%-22s %6.2f bit/sample  %5.2fx vs p24  encode %8.1f MB/s  decode %8.1f MB/s\n",
+        label, (double)bytes * 8.0 / ((double)done * ADS1278_CHANNEL_COUNT),
+        (double)done * ADS1278_TDM_FRAME_BYTES / (double)bytes,
+        (encode_ns != 0U) ? raw_mb * 1e9 / (double)encode_ns : 0.0,
+        (decode_ns != 0U) ? raw_mb * 1e9 / (double)decode_ns : 0.0);
+    return 0;
+}
+
+static int bench_codec(const bench_opts_t *opts)
+{
+    size_t src_frames = (opts->frames < BENCH_CODEC_SOURCE_FRAMES) ? (size_t)opts->frames : BENCH_CODEC_SOURCE_FRAMES;
+    int32_t *storage = malloc(src_frames * ADS1278_CHANNEL_COUNT * sizeof(*storage));
+    int32_t *decoded = malloc((size_t)opts->block_frames * ADS1278_CHANNEL_COUNT * sizeof(*decoded));
+    uint8_t *packed = malloc(ADS1278_CHANNEL_COUNT * sample_codec_max_bytes(opts->block_frames));
+    int32_t *ch[ADS1278_CHANNEL_COUNT];
+    codec_signal_t signal;
+    uint32_t channel;
+    int rc = -1;
+
+    if (storage == NULL || decoded == NULL || packed == NULL) {
+        perror("malloc");
+        goto out;
+    }
+    for (channel = 0U; channel < ADS1278_CHANNEL_COUNT; ++channel) {
+        ch[channel] = storage + (channel * src_frames);
+    }
+
+    printf("codec: %u-frame blocks, 24-bit p24 is 24.00 bit/sample, 48-byte records 48.00\n", opts->block_frames);
+    for (signal = CODEC_SIGNAL_QUIET; signal < CODEC_SIGNAL_COUNT; ++signal) {
+        fill_codec_signal(signal, ch, src_frames);
+        if (bench_codec_signal(opts, k_codec_signal_names[signal], ch, src_frames, packed, decoded) != 0) {
+            goto out;
+        }
+    }
+    if (opts->in_path != NULL) {
+        size_t n = load_codec_recording(opts->in_path, ch, src_frames);
+
+        if (n == 0U) {
+            fprintf(stderr, "codec: no records in %s\n", opts->in_path);
+            goto out;
+        }
+        if (bench_codec_signal(opts, "recorded (--in)", ch, n, packed, decoded) != 0) {
+            goto out;
+        }
+    }
+    rc = 0;
+
+out:
+    free(storage);
+    free(decoded);
+    free(packed);
+    return rc;
+}
+
+static int bench_wire(const bench_opts_t *opts)
+{
+    size_t src_frames = (opts->frames < BENCH_WIRE_SOURCE_FRAMES) ? (size_t)opts->frames : BENCH_WIRE_SOURCE_FRAMES;
+    ads1278_frame_t *src = malloc(src_frames * sizeof(*src));
+    int rc = -1;
+
+    if (src == NULL) {
+        perror("malloc");
+        return -1;
+    }
+    fill_wire_frames(src, src_frames, true);
+    if (bench_wire_encoding(opts, PROTO_DATA_ENC_RECORD48, ADS1278_CHANNEL_COUNT, src, src_frames, false) != 0 ||
+        bench_wire_encoding(opts, PROTO_DATA_ENC_P24, ADS1278_CHANNEL_COUNT, src, src_frames, false) != 0 ||
+        bench_wire_encoding(opts, PROTO_DATA_ENC_DELTA, ADS1278_CHANNEL_COUNT, src, src_frames, false) != 0) {
+        goto out;
+    }
+    /* Timestamps on the conversion grid (sim DRDY, --smooth-tstamps): P24 drops its deltas. */
+    fill_wire_frames(src, src_frames, false);
+    if (bench_wire_encoding(opts, PROTO_DATA_ENC_P24, ADS1278_CHANNEL_COUNT, src, src_frames, true) != 0) {
+        goto out;
+    }
+    rc = 0;
+
+out:
+    free(src);
+    return rc;
+}
+
+typedef struct {
+    int fd;
+    uint8_t *buf;
+    size_t fill;
+    uint64_t frames;
+    uint64_t next_seq;          /* frames below this are replayed duplicates */
+    bool eof;
+    bool await_resume;          /* DATA ahead of the resume GAP is live data the replay repeats */
+    uint64_t gaps;              /* GAP messages, resume replies excluded */
+    uint64_t gap_msgs;
+    uint64_t gap_frames;        /* frames the server said it dropped (or no longer had) */
+    uint64_t duplicates;
+    ads1278_frame_t frames_buf[BENCH_STREAM_DECODE_FRAMES];
+} stream_rx_t;
+
+typedef struct {
+    pthread_mutex_t lock;       /* guards srv against teardown by the thread */
+    stream_server_t *srv;
+    stream_server_stats_t stats;
+    stream_session_stats_t sessions[STREAM_SESSION_LOG];
+    size_t session_count;
+    uint64_t cpu_ns;            /* server thread CPU time for the whole run */
+    int rc;
+} stream_thread_t;
+
+/* One stream fan-out run, for the stream and uring modes. */
+typedef struct {
+    uint64_t bytes;             /* received over all clients */
+    uint64_t elapsed_ns;
+    uint64_t cpu_ns;            /* server thread */
+    stream_server_stats_t stats;
+} stream_fanout_t;
+
+static int stream_connect(uint16_t port, int rcvbuf)
+{
+    struct sockaddr_in addr;
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+
+    if (fd < 0) {
+        return -1;
+    }
+    /* Must precede connect() to shrink the advertised window. */
+    if (rcvbuf != 0) {
+        (void)setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+    }
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(fd, (const struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        int saved_errno = errno;
+
+        (void)close(fd);
+        errno = saved_errno;
+        return -1;
+    }
+    return fd;
+}
+
+/* Consume complete messages, counting new frames, duplicates and what GAPs name. */
+static int stream_rx_parse(stream_rx_t *rx)
+{
+    size_t pos = 0U;
+
+    while (rx->fill - pos >= PROTO_HEADER_BYTES) {
+        const uint8_t *payload = rx->buf + pos + PROTO_HEADER_BYTES;
+        proto_header_t hdr;
+        proto_data_info_t info;
+        uint32_t idx;
+
+        if (proto_decode_header(rx->buf + pos, &hdr) != 0) {
+            fprintf(stderr, "stream: bad message header\n");
+            return -1;
+        }
+        if (rx->fill - pos < PROTO_HEADER_BYTES + (size_t)hdr.payload_len) {
+            break;
+        }
+
+        if (hdr.type == PROTO_MSG_GAP) {
+            proto_gap_t gap;
+
+            if (proto_decode_gap(payload, hdr.payload_len, &gap) != 0) {
+                fprintf(stderr, "stream: bad GAP\n");
+                return -1;
+            }
+            if ((gap.flags & PROTO_GAP_RESUME) == 0U) {
+                ++rx->gaps;
+                rx->gap_msgs += gap.msg_count;
+            } else {
+                rx->await_resume = false;
+            }
+            rx->gap_frames += gap.frame_count;
+        } else if (hdr.type == PROTO_MSG_DATA && !rx->await_resume) {
+            if (proto_decode_data_info(payload, hdr.payload_len, &info) != 0) {
+                fprintf(stderr, "stream: bad DATA\n");
+                return -1;
+            }
+            for (idx = 0U; idx < info.frame_count; ++idx) {
+                const ads1278_frame_t *frame = &rx->frames_buf[idx % BENCH_STREAM_DECODE_FRAMES];
+
+                if (idx % BENCH_STREAM_DECODE_FRAMES == 0U) {
+                    uint32_t left = info.frame_count - idx;
+
+                    proto_data_decode_frames(&info, idx,
+                        (left < BENCH_STREAM_DECODE_FRAMES) ? left : BENCH_STREAM_DECODE_FRAMES, rx->frames_buf);
+                }
+                if (frame->seq < rx->next_seq) {
+                    ++rx->duplicates;
+                    continue;
+                }
+                rx->next_seq = frame->seq + 1U;
+                ++rx->frames;
+            }
+        }
+        pos += PROTO_HEADER_BYTES + (size_t)hdr.payload_len;
+    }
+
+    memmove(rx->buf, rx->buf + pos, rx->fill - pos);
+    rx->fill -= pos;
+    return 0;
+}
+
+/* Run the loop and tear the server down here, so clients see EOF after the last byte. */
+static void *stream_server_thread(void *arg)
+{
+    stream_thread_t *ctx = arg;
+    struct timespec ts;
+
+    ctx->rc = stream_server_run(ctx->srv);
+    (void)clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    ctx->cpu_ns = ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+    pthread_mutex_lock(&ctx->lock);
+    stream_server_get_stats(ctx->srv, &ctx->stats);
+    ctx->session_count = stream_server_get_sessions(ctx->srv, ctx->sessions, STREAM_SESSION_LOG);
+    stream_server_destroy(ctx->srv);
+    ctx->srv = NULL;
+    pthread_mutex_unlock(&ctx->lock);
+    return NULL;
+}
+
+/*
+ * Loopback fan-out of --frames free-running sim frames to --clients readers
+ * plus one that never reads.
+ */
+static int stream_fanout(const bench_opts_t *opts, bool io_uring, stream_fanout_t *result)
+{
+    stream_rx_t *rx = NULL;
+    stream_thread_t ctx;
+    stream_server_cfg_t cfg;
+    acq_cfg_t acq_cfg = {0};
+    acq_t *acq = NULL;
+    pthread_t thread;
+    bool thread_started = false;
+    bool hal_open = false;
+    int stalled_fd = -1;
+    uint64_t bytes = 0U;
+    uint64_t t0 = 0U;
+    uint64_t elapsed;
+    uint32_t idx;
+    uint32_t open_clients;
+    int rc = -1;
+
+    memset(&ctx, 0, sizeof(ctx));
+    memset(&cfg, 0, sizeof(cfg));
+    pthread_mutex_init(&ctx.lock, NULL);
+    rx = calloc(opts->clients, sizeof(*rx));
+    if (rx == NULL) {
+        perror("calloc");
+        return -1;
+    }
+    for (idx = 0U; idx < opts->clients; ++idx) {
+        rx[idx].fd = -1;
+    }
+
+    if (open_free_running_sim() != 0) {
+        goto out;
+    }
+    hal_open = true;
+    acq_cfg.ring_capacity = BENCH_STREAM_RING_FRAMES;
+    acq_cfg.max_frames = opts->frames;
+    if (acq_create(&acq, &acq_cfg) != 0) {
+        perror("acq_create");
+        goto out;
+    }
+
+    /* Active clients plus one that never reads; acquisition starts once all are in. */
+    cfg.bind_addr = "127.0.0.1";
+    cfg.mode = STREAM_MODE_THROUGHPUT;
+    cfg.max_clients = opts->clients + 1U;
+    cfg.start_clients = opts->clients + 1U;
+    cfg.io_uring = io_uring;
+    if (stream_server_create(&ctx.srv, &cfg, acq) != 0) {
+        perror("stream_server_create");
+        goto out;
+    }
+    if (pthread_create(&thread, NULL, stream_server_thread, &ctx) != 0) {
+        perror("pthread_create");
+        stream_server_destroy(ctx.srv);
+        goto out;
+    }
+    thread_started = true;
+
+    for (idx = 0U; idx < opts->clients; ++idx) {
+        rx[idx].buf = malloc(BENCH_STREAM_RX_BYTES);
+        rx[idx].fd = stream_connect(stream_server_port(ctx.srv), 0);
+        if (rx[idx].buf == NULL || rx[idx].fd < 0) {
+            perror("stream client");
+            goto out;
+        }
+    }
+    stalled_fd = stream_connect(stream_server_port(ctx.srv), BENCH_STREAM_STALLED_RCVBUF);
+    if (stalled_fd < 0) {
+        perror("stalled client");
+        goto out;
+    }
+
+    t0 = now_ns();
+    open_clients = opts->clients;
+    while (open_clients != 0U) {
+        struct pollfd pfd[64];
+        uint32_t map[64];
+        nfds_t nfds = 0U;
+        nfds_t pos;
+
+        /* The stalled reader leaves once acquisition ends so the server can finish. */
+        if (stalled_fd >= 0 && acq_is_done(acq)) {
+            (void)close(stalled_fd);
+            stalled_fd = -1;
+        }
+        for (idx = 0U; idx < opts->clients && nfds < 64U; ++idx) {
+            if (!rx[idx].eof) {
+                pfd[nfds].fd = rx[idx].fd;
+                pfd[nfds].events = POLLIN;
+                map[nfds++] = idx;
+            }
+        }
+        if (poll(pfd, nfds, 100) < 0 && errno != EINTR) {
+            perror("poll");
+            goto out;
+        }
+        for (pos = 0U; pos < nfds; ++pos) {
+            stream_rx_t *client = &rx[map[pos]];
+            ssize_t n;
+
+            if ((pfd[pos].revents & (POLLIN | POLLHUP | POLLERR)) == 0) {
+                continue;
+            }
+            n = recv(client->fd, client->buf + client->fill, BENCH_STREAM_RX_BYTES - client->fill, 0);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                client->eof = true;
+                --open_clients;
+                continue;
+            }
+            bytes += (uint64_t)n;
+            client->fill += (size_t)n;
+            if (stream_rx_parse(client) != 0) {
+                goto out;
+            }
+        }
+    }
+    elapsed = now_ns() - t0;
+
+    pthread_join(thread, NULL);
+    thread_started = false;
+    if (ctx.rc != 0) {
+        fprintf(stderr, "stream_server_run failed\n");
+        goto out;
+    }
+
+    result->bytes = bytes;
+    result->elapsed_ns = elapsed;
+    result->cpu_ns = ctx.cpu_ns;
+    result->stats = ctx.stats;
+    rc = 0;
+
+out:
+    if (stalled_fd >= 0) {
+        (void)close(stalled_fd);
+    }
+    for (idx = 0U; idx < opts->clients; ++idx) {
+        if (rx[idx].fd >= 0) {
+            (void)close(rx[idx].fd);
+        }
+        free(rx[idx].buf);
+    }
+    if (thread_started) {
+        pthread_mutex_lock(&ctx.lock);
+        stream_server_stop(ctx.srv);
+        pthread_mutex_unlock(&ctx.lock);
+        pthread_join(thread, NULL);
+    }
+    pthread_mutex_destroy(&ctx.lock);
+    acq_destroy(acq);
+    if (hal_open) {
+        ads1278_stop();
+        ads1278_close();
+    }
+    free(rx);
+    return rc;
+}
+
+static int bench_stream(const bench_opts_t *opts)
+{
+    stream_fanout_t r;
+    const stream_server_stats_t *st = &r.stats;
+
+    memset(&r, 0, sizeof(r));
+    if (stream_fanout(opts, false, &r) != 0) {
+        return -1;
+    }
+    report("stream (per client)", st->frames_in, r.elapsed_ns, "frame");
+    printf("stream: %u client(s), %.1f MB/s received in total, %.1f send call(s)/MB, "
+        "%" PRIu64 " message(s) of %.0f frames on average\n",
+        opts->clients, (double)r.bytes * 1e3 / (double)r.elapsed_ns,
+        (r.bytes != 0U) ? (double)st->send_calls * 1e6 / (double)r.bytes : 0.0,
+        st->msgs_published,
+        (st->msgs_published != 0U) ? (double)st->frames_in / (double)st->msgs_published : 0.0);
+    printf("stream: stalled client skipped %" PRIu64 " message(s); acquisition frames %" PRIu64 "\n",
+        st->msgs_dropped, st->frames_in);
+    return 0;
+}
+
+static uint64_t process_cpu_ns(void)
+{
+    struct rusage ru;
+
+    (void)getrusage(RUSAGE_SELF, &ru);
+    return ((uint64_t)(ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) * 1000000000ULL) +
+        ((uint64_t)(ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) * 1000ULL);
+}
+
+/* --frames synthetic v1 records through the capture writer. */
+static int uring_capture_run(const bench_opts_t *opts, const char *path, size_t block_bytes, bool io_uring,
+                             ads1278_frame_t *batch)
+{
+    capture_writer_cfg_t cfg = {0};
+    capture_writer_t *writer = NULL;
+    capture_writer_stats_t stats = {0};
+    char label[64];
+    uint64_t done;
+    uint64_t t0;
+    uint64_t cpu0;
+    uint64_t elapsed;
+    uint64_t cpu;
+    double mb;
+
+    cfg.block_bytes = block_bytes;
+    cfg.io_uring = io_uring;
+    if (capture_writer_open(&writer, path, &cfg) != 0) {
+        perror("capture_writer_open");
+        return -1;
+    }
+    t0 = now_ns();
+    cpu0 = process_cpu_ns();
+    for (done = 0U; done < opts->frames;) {
+        size_t n = opts->block_frames;
+        size_t idx;
+
+        if (opts->frames - done < n) {
+            n = (size_t)(opts->frames - done);
+        }
+        for (idx = 0U; idx < n; ++idx) {
+            fill_synthetic_frame(&batch[idx], done + idx);
+        }
+        if (capture_writer_append_frames(writer, batch, n) != 0) {
+            perror("capture_writer_append_frames");
+            (void)capture_writer_close(writer, NULL);
+            return -1;
+        }
+        done += n;
+    }
+    if (capture_writer_close(writer, &stats) != 0) {
+        perror("capture_writer_close");
+        return -1;
+    }
+    elapsed = now_ns() - t0;
+    cpu = process_cpu_ns() - cpu0;
+    if (io_uring && !stats.io_uring) {
+        printf("uring: io_uring unavailable here (%s), capture stays on pwrite()\n", strerror(ENOSYS));
+    }
+
+    mb = (double)stats.bytes_written / 1e6;
+    snprintf(label, sizeof(label), "capture %zu KiB %s", block_bytes / 1024U,
+        stats.io_uring ? (stats.io_uring_fixed ? "io_uring fixed" : "io_uring") : "pwrite");
+    report(label, done, elapsed, "frame");
+    printf("%s: %.1f MB/s, %.2f write syscall(s)/MB, CPU %.0f%%, worst write %.3f ms\n", label,
+        mb * 1e9 / (double)elapsed, (double)stats.write_calls / mb, 100.0 * (double)cpu / (double)elapsed,
+        (double)stats.write_ns_max * 1e-6);
+    return 0;
+}
+
+static int uring_stream_run(const bench_opts_t *opts, bool io_uring)
+{
+    stream_fanout_t r;
+    const stream_server_stats_t *st = &r.stats;
+    const char *label;
+    double mb;
+
+    memset(&r, 0, sizeof(r));
+    if (stream_fanout(opts, io_uring, &r) != 0) {
+        return -1;
+    }
+    label = st->io_uring ? "stream io_uring" : "stream sendmsg";
+    mb = (double)st->bytes_sent / 1e6;
+    report(label, st->frames_in, r.elapsed_ns, "frame");
+    printf("%s: %u client(s), %.1f MB/s sent, %.2f send syscall(s)/MB (%.2f sendmsg/MB), server thread CPU %.0f%%\n",
+        label, opts->clients, mb * 1e9 / (double)r.elapsed_ns, (double)st->send_syscalls / mb,
+        (double)st->send_calls / mb, 100.0 * (double)r.cpu_ns / (double)r.elapsed_ns);
+    return 0;
+}
+
+static int bench_uring(const bench_opts_t *opts)
+{
+    static const size_t k_block_bytes[] = {64U * 1024U, CAPTURE_WRITER_DEFAULT_BLOCK_BYTES};
+    char path[] = "/tmp/ads1278_bench_XXXXXX";
+    ads1278_frame_t *batch = NULL;
+    size_t b;
+    int fd;
+    int rc = -1;
+
+    if (uring_probe() != 0) {
+        printf("uring: io_uring unavailable (%s); both runs use the plain path\n", strerror(errno));
+    }
+    fd = mkstemp(path);
+    if (fd < 0) {
+        perror("mkstemp");
+        return -1;
+    }
+    (void)close(fd);
+    batch = malloc(opts->block_frames * sizeof(*batch));
+    if (batch == NULL) {
+        perror("malloc");
+        goto out;
+    }
+    for (b = 0U; b < sizeof(k_block_bytes) / sizeof(k_block_bytes[0]); ++b) {
+        if (uring_capture_run(opts, path, k_block_bytes[b], false, batch) != 0 ||
+            uring_capture_run(opts, path, k_block_bytes[b], true, batch) != 0) {
+            goto out;
+        }
+    }
+    if (uring_stream_run(opts, false) != 0 || uring_stream_run(opts, true) != 0) {
+        goto out;
+    }
+    rc = 0;
+
+out:
+    free(batch);
+    (void)unlink(path);
+    return rc;
+}
+
+typedef struct {
+    const char *name;
+    stream_policy_t policy;
+    uint64_t history_frames;
+} resume_phase_t;
+
+static int stream_subscribe(int fd, stream_policy_t policy, bool resume, uint64_t resume_seq)
+{
+    uint8_t msg[PROTO_HEADER_BYTES + PROTO_SUBSCRIBE_BYTES];
+    proto_subscribe_t sub;
+    size_t len;
+
+    memset(&sub, 0, sizeof(sub));
+    sub.policy = (uint16_t)policy;
+    sub.max_lag_ms = BENCH_RESUME_MAX_LAG_MS;
+    sub.flags = resume ? PROTO_SUBSCRIBE_RESUME : 0U;
+    sub.resume_seq = resume_seq;
+    len = proto_encode_subscribe(msg, &sub);
+    return (send(fd, msg, len, MSG_NOSIGNAL) == (ssize_t)len) ? 0 : -1;
+}
+
+static const stream_session_stats_t *find_session(const stream_thread_t *ctx, uint64_t id)
+{
+    size_t idx;
+
+    for (idx = 0U; idx < ctx->session_count; ++idx) {
+        if (ctx->sessions[idx].id == id) {
+            return &ctx->sessions[idx];
+        }
+    }
+    return NULL;
+}
+
+/*
+ * One policy over loopback: a never-drop reader that keeps up (session 1) and
+ * one with a small receive buffer (session 2) that stops reading for BENCH_RESUME_STALL_MS
+ * once it has BENCH_RESUME_STALL_AFTER_FRAMES frames (an eighth of a shorter
+ * --frames). A stalled reader that is disconnected reconnects once (session
+ * 3) and resumes from its next seq; the replay back to the live edge is timed.
+ */
+static int resume_phase(const bench_opts_t *opts, const resume_phase_t *phase)
+{
+    stream_rx_t *rx = NULL;
+    stream_thread_t ctx;
+    stream_server_cfg_t cfg;
+    acq_cfg_t acq_cfg = {0};
+    acq_stats_t acq_stats;
+    acq_t *acq = NULL;
+    pthread_t thread;
+    bool thread_started = false;
+    bool hal_open = false;
+    bool stalled = false;
+    bool reconnected = false;
+    bool ended = false;         /* the run finished while the reader was stalled */
+    uint64_t stall_until = 0U;
+    uint64_t stall_after = BENCH_RESUME_STALL_AFTER_FRAMES;
+    uint64_t replay_target = 0U;
+    uint64_t replay_t0 = 0U;
+    uint64_t replay_bytes = 0U;
+    uint64_t replay_ns = 0U;
+    const stream_session_stats_t *first;
+    const stream_session_stats_t *second;
+    uint16_t port = 0U;
+    uint32_t idx;
+    int rc = -1;
+
+    memset(&ctx, 0, sizeof(ctx));
+    memset(&cfg, 0, sizeof(cfg));
+    pthread_mutex_init(&ctx.lock, NULL);
+    rx = calloc(2U, sizeof(*rx));
+    if (rx == NULL) {
+        perror("calloc");
+        return -1;
+    }
+    rx[0].fd = -1;
+    rx[1].fd = -1;
+    if (opts->frames / 8U < stall_after) {
+        stall_after = opts->frames / 8U;
+    }
+
+    if (open_free_running_sim() != 0) {
+        goto out;
+    }
+    hal_open = true;
+    acq_cfg.ring_capacity = BENCH_STREAM_RING_FRAMES;
+    acq_cfg.max_frames = opts->frames;
+    if (acq_create(&acq, &acq_cfg) != 0) {
+        perror("acq_create");
+        goto out;
+    }
+
+    cfg.bind_addr = "127.0.0.1";
+    cfg.mode = STREAM_MODE_THROUGHPUT;
+    cfg.max_clients = 3U;
+    cfg.start_clients = 2U;
+    cfg.history_frames = phase->history_frames;
+    if (stream_server_create(&ctx.srv, &cfg, acq) != 0) {
+        perror("stream_server_create");
+        goto out;
+    }
+    if (pthread_create(&thread, NULL, stream_server_thread, &ctx) != 0) {
+        perror("pthread_create");
+        stream_server_destroy(ctx.srv);
+        goto out;
+    }
+    thread_started = true;
+    /* The server thread frees ctx.srv when it exits. */
+    port = stream_server_port(ctx.srv);
+
+    for (idx = 0U; idx < 2U; ++idx) {
+        rx[idx].buf = malloc(BENCH_STREAM_RX_BYTES);
+        rx[idx].fd = stream_connect(port, (idx == 1U) ? BENCH_STREAM_STALLED_RCVBUF : 0);
+        if (rx[idx].buf == NULL || rx[idx].fd < 0 ||
+            stream_subscribe(rx[idx].fd, (idx == 1U) ? phase->policy : STREAM_POLICY_NEVER_DROP, false, 0U) != 0) {
+            perror("stream client");
+            goto out;
+        }
+    }
+
+    while (!rx[0].eof || !rx[1].eof) {
+        struct pollfd pfd[2];
+        uint32_t map[2];
+        nfds_t nfds = 0U;
+        nfds_t pos;
+        uint64_t now = now_ns();
+
+        if (!stalled && rx[1].frames >= stall_after) {
+            stalled = true;
+            stall_until = now + ((uint64_t)BENCH_RESUME_STALL_MS * 1000000ULL);
+        }
+        for (idx = 0U; idx < 2U; ++idx) {
+            if (!rx[idx].eof && (idx == 0U || now >= stall_until)) {
+                pfd[nfds].fd = rx[idx].fd;
+                pfd[nfds].events = POLLIN;
+                map[nfds++] = idx;
+            }
+        }
+        if (poll(pfd, nfds, 10) < 0 && errno != EINTR) {
+            perror("poll");
+            goto out;
+        }
+        for (pos = 0U; pos < nfds; ++pos) {
+            stream_rx_t *client = &rx[map[pos]];
+            ssize_t n;
+
+            if ((pfd[pos].revents & (POLLIN | POLLHUP | POLLERR)) == 0) {
+                continue;
+            }
+            n = recv(client->fd, client->buf + client->fill, BENCH_STREAM_RX_BYTES - client->fill, 0);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0 && map[pos] == 1U && phase->policy == STREAM_POLICY_DISCONNECT && !reconnected) {
+                /* Closed for lagging: the cut-off message is replayed, so drop its head. */
+                reconnected = true;
+                (void)close(client->fd);
+                client->fill = 0U;
+                client->await_resume = true;
+                client->fd = stream_connect(port, 0);
+                if (client->fd < 0 && errno == ECONNREFUSED) {
+                    /* A short --frames run can end inside the stall: nothing left to resume. */
+                    ended = true;
+                    client->eof = true;
+                    continue;
+                }
+                if (client->fd < 0 || stream_subscribe(client->fd, phase->policy, true, client->next_seq) != 0) {
+                    perror("resume");
+                    goto out;
+                }
+                replay_target = rx[0].next_seq;
+                replay_t0 = now_ns();
+                continue;
+            }
+            if (n <= 0) {
+                client->eof = true;
+                continue;
+            }
+            client->fill += (size_t)n;
+            if (stream_rx_parse(client) != 0) {
+                goto out;
+            }
+            if (map[pos] == 1U && replay_t0 != 0U && replay_ns == 0U) {
+                replay_bytes += (uint64_t)n;
+                if (client->next_seq >= replay_target) {
+                    replay_ns = now_ns() - replay_t0;
+                }
+            }
+        }
+    }
+
+    pthread_join(thread, NULL);
+    thread_started = false;
+    if (ctx.rc != 0) {
+        fprintf(stderr, "stream_server_run failed\n");
+        goto out;
+    }
+    acq_get_stats(acq, &acq_stats);
+    first = find_session(&ctx, 2U);
+    second = find_session(&ctx, 3U);
+
+    if (!stalled || first == NULL) {
+        printf("resume %-11s the reader never stalled (raise --frames)\n", phase->name);
+        rc = 0;
+        goto out;
+    }
+    switch (phase->policy) {
+        case STREAM_POLICY_DROP_OLDEST:
+            if (rx[1].gaps == 0U) {
+                /* Too few frames behind the stall to outgrow the history: nothing to drop. */
+                printf("resume %-11s stalled %u ms: no GAP, the stall never outgrew the %" PRIu64 "-frame history; "
+                    "max backlog %" PRIu64 " message(s)\n", phase->name, BENCH_RESUME_STALL_MS,
+                    phase->history_frames, first->max_lag_msgs);
+                break;
+            }
+            printf("resume %-11s stalled %u ms: %" PRIu64 " GAP(s) naming %" PRIu64 " message(s), %" PRIu64
+                " frame(s) of %" PRIu64 ", max backlog %" PRIu64 " message(s)\n", phase->name, BENCH_RESUME_STALL_MS,
+                rx[1].gaps, rx[1].gap_msgs, rx[1].gap_frames, ctx.stats.frames_in, first->max_lag_msgs);
+            break;
+        case STREAM_POLICY_DISCONNECT:
+            if (!reconnected || ended || second == NULL) {
+                printf("resume %-11s stalled %u ms: %s; nothing replayed (raise --frames)\n", phase->name,
+                    BENCH_RESUME_STALL_MS, reconnected ? "the run ended first" : "never closed");
+                break;
+            }
+            printf("resume %-11s stalled %u ms: closed (%s), resumed from seq and replayed %" PRIu64 " message(s) "
+                "at %.1f MB/s, %" PRIu64 " duplicate frame(s) discarded\n", phase->name, BENCH_RESUME_STALL_MS,
+                stream_close_name(first->closed), second->msgs_replayed,
+                (replay_ns != 0U) ? (double)replay_bytes * 1e3 / (double)replay_ns : 0.0, rx[1].duplicates);
+            break;
+        default:
+            if (first->closed != STREAM_CLOSE_OVERRUN) {
+                printf("resume %-11s stalled %u ms: the stall never outgrew the %" PRIu64 "-frame history, "
+                    "%" PRIu64 " of %" PRIu64 " frame(s) received, max backlog %" PRIu64 " message(s)\n", phase->name,
+                    BENCH_RESUME_STALL_MS, phase->history_frames, rx[1].frames, ctx.stats.frames_in,
+                    first->max_lag_msgs);
+                break;
+            }
+            printf("resume %-11s stalled %u ms: closed (%s) after %" PRIu64 " of %" PRIu64 " frame(s), no GAP; "
+                "the other reader got %" PRIu64 ", %" PRIu64 " frame(s) overflowed the acquisition ring\n",
+                phase->name, BENCH_RESUME_STALL_MS, stream_close_name(first->closed), rx[1].frames,
+                ctx.stats.frames_in, rx[0].frames, acq_stats.ring.overflows);
+            break;
+    }
+    rc = 0;
+
+out:
+    for (idx = 0U; idx < 2U; ++idx) {
+        if (rx[idx].fd >= 0) {
+            (void)close(rx[idx].fd);
+        }
+        free(rx[idx].buf);
+    }
+    if (thread_started) {
+        pthread_mutex_lock(&ctx.lock);
+        stream_server_stop(ctx.srv);
+        pthread_mutex_unlock(&ctx.lock);
+        pthread_join(thread, NULL);
+    }
+    pthread_mutex_destroy(&ctx.lock);
+    acq_destroy(acq);
+    if (hal_open) {
+        ads1278_stop();
+        ads1278_close();
+    }
+    free(rx);
+    return rc;
+}
+
+static int bench_resume(const bench_opts_t *opts)
+{
+    static const resume_phase_t phases[] = {
+        {"drop-oldest", STREAM_POLICY_DROP_OLDEST, BENCH_RESUME_SHORT_HISTORY_FRAMES},
+        {"disconnect", STREAM_POLICY_DISCONNECT, BENCH_RESUME_LONG_HISTORY_FRAMES},
+        {"never-drop", STREAM_POLICY_NEVER_DROP, BENCH_RESUME_SHORT_HISTORY_FRAMES},
+    };
+    size_t idx;
+
+    for (idx = 0U; idx < sizeof(phases) / sizeof(phases[0]); ++idx) {
+        if (resume_phase(opts, &phases[idx]) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+typedef struct {
+    int fd;
+    uint64_t datagrams;
+    uint64_t frames;
+    uint64_t lost;              /* msg_seq jumps */
+    uint32_t next_msg;
+} udp_rx_t;
+
+typedef struct {
+    udp_rx_t *rx;
+    uint32_t count;
+    atomic_bool sending;        /* cleared once the sender has flushed its last datagram */
+} udp_rx_thread_t;
+
+static void udp_rx_datagram(udp_rx_t *rx, const uint8_t *buf, size_t len)
+{
+    proto_header_t hdr;
+    proto_data_info_t info;
+
+    if (len < PROTO_HEADER_BYTES || proto_decode_header(buf, &hdr) != 0 || hdr.type != PROTO_MSG_DATA ||
+        proto_decode_data_info(buf + PROTO_HEADER_BYTES, hdr.payload_len, &info) != 0) {
+        return;
+    }
+    if ((int32_t)(hdr.msg_seq - rx->next_msg) >= 0) {
+        rx->lost += hdr.msg_seq - rx->next_msg;
+        rx->next_msg = hdr.msg_seq + 1U;
+    }
+    ++rx->datagrams;
+    rx->frames += info.frame_count;
+}
+
+/* Drain every listener until the sender is done and the group has gone quiet. */
+static void *udp_rx_main(void *arg)
+{
+    udp_rx_thread_t *ctx = arg;
+    struct pollfd pfd[64];
+    uint8_t buf[65536];
+    uint32_t idx;
+
+    for (idx = 0U; idx < ctx->count; ++idx) {
+        pfd[idx].fd = ctx->rx[idx].fd;
+        pfd[idx].events = POLLIN;
+    }
+    for (;;) {
+        int n = poll(pfd, ctx->count, (int)BENCH_UDP_IDLE_MS);
+
+        if (n == 0 && !atomic_load(&ctx->sending)) {
+            break;
+        }
+        for (idx = 0U; n > 0 && idx < ctx->count; ++idx) {
+            ssize_t len;
+
+            if ((pfd[idx].revents & POLLIN) == 0) {
+                continue;
+            }
+            while ((len = recv(ctx->rx[idx].fd, buf, sizeof(buf), MSG_DONTWAIT)) > 0) {
+                udp_rx_datagram(&ctx->rx[idx], buf, (size_t)len);
+            }
+        }
+    }
+    return NULL;
+}
+
+/* Listener joined to the bench group on loopback; port 0 picks one for the first. */
+static int udp_listen(uint16_t *port)
+{
+    struct sockaddr_in addr;
+    struct ip_mreq mreq;
+    socklen_t len = sizeof(addr);
+    int rcvbuf = BENCH_UDP_RCVBUF;
+    int one = 1;
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+
+    if (fd < 0) {
+        return -1;
+    }
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(*port);
+    (void)inet_pton(AF_INET, BENCH_UDP_GROUP, &addr.sin_addr);
+    (void)inet_pton(AF_INET, BENCH_UDP_GROUP, &mreq.imr_multiaddr);
+    mreq.imr_interface.s_addr = htonl(INADDR_LOOPBACK);
+    (void)setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+    if (setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one)) != 0 ||
+        bind(fd, (const struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+        setsockopt(fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) != 0 ||
+        getsockname(fd, (struct sockaddr *)&addr, &len) != 0) {
+        (void)close(fd);
+        return -1;
+    }
+    *port = ntohs(addr.sin_port);
+    return fd;
+}
+
+/*
+ * opts->frames synthetic frames through one udp_sender to opts->clients
+ * multicast listeners on loopback, unpaced or at fps frames/s; datagrams the
+ * listeners miss are counted from msg_seq jumps.
+ */
+static int udp_run(const bench_opts_t *opts, uint32_t batch, uint32_t fps)
+{
+    udp_rx_thread_t ctx;
+    udp_sender_cfg_t cfg;
+    udp_sender_stats_t stats;
+    udp_sender_t *snd = NULL;
+    ads1278_frame_t *frames = NULL;
+    pthread_t thread;
+    bool thread_started = false;
+    uint16_t port = 0U;
+    uint64_t seq = 0U;
+    uint64_t t0;
+    uint64_t elapsed;
+    uint64_t lost = 0U;
+    char label[64];
+    uint32_t idx;
+    int rc = -1;
+
+    memset(&ctx, 0, sizeof(ctx));
+    memset(&cfg, 0, sizeof(cfg));
+    ctx.count = opts->clients;
+    ctx.rx = calloc(ctx.count, sizeof(*ctx.rx));
+    frames = calloc(BENCH_UDP_PUSH_FRAMES, sizeof(*frames));
+    if (ctx.rx == NULL || frames == NULL) {
+        perror("calloc");
+        goto out;
+    }
+    for (idx = 0U; idx < ctx.count; ++idx) {
+        ctx.rx[idx].fd = -1;
+    }
+    for (idx = 0U; idx < ctx.count; ++idx) {
+        ctx.rx[idx].fd = udp_listen(&port);
+        if (ctx.rx[idx].fd < 0) {
+            perror("udp listener");
+            goto out;
+        }
+    }
+
+    cfg.dest = BENCH_UDP_GROUP;
+    cfg.port = port;
+    cfg.iface = "127.0.0.1";
+    cfg.batch = batch;
+    cfg.sndbuf = BENCH_UDP_RCVBUF;
+    if (udp_sender_create(&snd, &cfg) != 0) {
+        perror("udp_sender_create");
+        goto out;
+    }
+    atomic_store(&ctx.sending, true);
+    if (pthread_create(&thread, NULL, udp_rx_main, &ctx) != 0) {
+        perror("pthread_create");
+        goto out;
+    }
+    thread_started = true;
+
+    t0 = now_ns();
+    while (seq < opts->frames) {
+        size_t n = (opts->frames - seq < BENCH_UDP_PUSH_FRAMES) ? (size_t)(opts->frames - seq)
+                                                                  : BENCH_UDP_PUSH_FRAMES;
+
+        for (idx = 0U; idx < n; ++idx) {
+            fill_synthetic_frame(&frames[idx], seq + idx);
+        }
+        udp_sender_push(snd, frames, n);
+        udp_sender_flush(snd);
+        seq += n;
+        if (fps != 0U) {
+            uint64_t due = t0 + (seq * 1000000000ULL) / fps;
+            uint64_t now = now_ns();
+
+            if (due > now) {
+                nap_ns(due - now);
+            }
+        }
+    }
+    elapsed = now_ns() - t0;
+    udp_sender_get_stats(snd, &stats);
+    atomic_store(&ctx.sending, false);
+    pthread_join(thread, NULL);
+    thread_started = false;
+
+    for (idx = 0U; idx < ctx.count; ++idx) {
+        udp_rx_t *rx = &ctx.rx[idx];
+
+        /* Datagrams lost after the last one received show up as a short count. */
+        rx->lost += stats.datagrams - rx->next_msg;
+        lost += rx->lost;
+    }
+
+    snprintf(label, sizeof(label), "udp batch %u%s", batch, (fps != 0U) ? ", paced" : "");
+    report(label, stats.datagrams, elapsed, "datagram");
+    printf("%s: %.1f MB/s to %u listener(s), %u frames/datagram, %.1f datagrams/sendmmsg, "
+        "%.2f%% lost at the listeners\n", label, (double)stats.bytes * 1e3 / (double)elapsed, ctx.count,
+        stats.frames_per_datagram, (double)stats.datagrams / (double)stats.send_calls,
+        100.0 * (double)lost / (double)(stats.datagrams * ctx.count));
+    rc = 0;
+
+out:
+    if (thread_started) {
+        atomic_store(&ctx.sending, false);
+        pthread_join(thread, NULL);
+    }
+    udp_sender_destroy(snd);
+    for (idx = 0U; ctx.rx != NULL && idx < ctx.count; ++idx) {
+        if (ctx.rx[idx].fd >= 0) {
+            (void)close(ctx.rx[idx].fd);
+        }
+    }
+    free(ctx.rx);
+    free(frames);
+    return rc;
+}
+
+static int bench_udp(const bench_opts_t *opts)
+{
+    if (opts->clients > 64U) {
+        fprintf(stderr, "udp: at most 64 listeners\n");
+        return -1;
+    }
+    if (udp_run(opts, 1U, 0U) != 0 || udp_run(opts, UDP_DEFAULT_BATCH, 0U) != 0 ||
+        udp_run(opts, UDP_DEFAULT_BATCH, BENCH_UDP_PACED_FPS) != 0) {
+        return -1;
+    }
+    return 0;
+}
+
+typedef struct {
+    atomic_bool ready;          /* reader attached */
+    int error;                  /* errno from shm_ring_reader_open(), 0 = ok */
+    uint64_t frames;            /* accepted by release() */
+    uint64_t laps;
+    uint64_t lost;
+    uint64_t retries;           /* peeked batches release() rejected as overwritten */
+    uint64_t elapsed_ns;        /* first frame to end of stream */
+    int64_t sink;               /* sum of channel 1, so the slot reads stay */
+} shm_rx_result_t;
+
+typedef struct {
+    atomic_bool go;
+    shm_rx_result_t rx[];
+} shm_shared_t;
+
+/*
+ * Child process: attach read-only and read every frame in place. A slow
+ * reader reads half a batch, sleeps, then reads the rest, so the writer
+ * overwrites slots it is still reading.
+ */
+static void shm_reader_main(const char *name, shm_shared_t *shared, uint32_t idx, uint32_t batch,
+                            uint64_t slow_nap_ns)
+{
+    shm_rx_result_t *res = &shared->rx[idx];
+    shm_ring_reader_t *r = NULL;
+    shm_ring_reader_stats_t stats;
+    uint64_t start = 0U;
+    bool draining = false;
+
+    if (shm_ring_reader_open(&r, name, false) != 0) {
+        res->error = errno;
+        atomic_store(&res->ready, true);
+        _exit(1);
+    }
+    atomic_store(&res->ready, true);
+    while (!atomic_load(&shared->go)) {
+        sched_yield();
+    }
+
+    for (;;) {
+        uint64_t first;
+        size_t n = shm_ring_reader_peek(r, &first, batch);
+        int64_t sum = 0;
+        size_t i;
+
+        if (n == 0U) {
+            if (draining) {
+                break;
+            }
+            /* One more pass after close: head is final by then. */
+            draining = shm_ring_reader_closed(r);
+            sched_yield();
+            continue;
+        }
+        if (start == 0U) {
+            start = now_ns();
+        }
+        for (i = 0; i < n; ++i) {
+            if (slow_nap_ns != 0U && i == n / 2U) {
+                nap_ns(slow_nap_ns);
+            }
+            sum += shm_ring_reader_slot(r, first + i)->ch[0];
+        }
+        if (shm_ring_reader_release(r, n) == 0) {
+            res->sink += sum;
+        } else {
+            ++res->retries;
+        }
+    }
+    res->elapsed_ns = (start != 0U) ? now_ns() - start : 0U;
+    shm_ring_reader_get_stats(r, &stats);
+    res->frames = stats.frames;
+    res->laps = stats.laps;
+    res->lost = stats.frames_lost;
+    shm_ring_reader_close(r);
+    _exit(0);
+}
+
+/*
+ * One writer (this process) and --clients fast readers plus one slow reader,
+ * each a separate process. fps = 0 publishes as fast as possible.
+ */
+static int shm_run(const bench_opts_t *opts, const char *label, uint64_t frames, uint64_t capacity, uint64_t fps)
+{
+    uint32_t readers = opts->clients + 1U;
+    size_t shared_bytes = sizeof(shm_shared_t) + (readers * sizeof(shm_rx_result_t));
+    shm_shared_t *shared;
+    shm_ring_writer_t *w = NULL;
+    shm_ring_cfg_t cfg = {0};
+    ads1278_frame_t *block = NULL;
+    pid_t pids[64];
+    uint32_t spawned = 0U;
+    char name[64];
+    uint64_t seq = 0U;
+    uint64_t start;
+    uint64_t elapsed;
+    uint32_t idx;
+    int rc = -1;
+
+    shared = mmap(NULL, shared_bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (shared == MAP_FAILED) {
+        perror("mmap");
+        return -1;
+    }
+    memset(shared, 0, shared_bytes);
+    block = calloc(opts->block_frames, sizeof(*block));
+    if (block == NULL) {
+        perror("calloc");
+        goto out;
+    }
+    snprintf(name, sizeof(name), "/ads1278-bench-%ld", (long)getpid());
+    cfg.name = name;
+    cfg.capacity = capacity;
+    cfg.channels = ADS1278_CHANNEL_COUNT;
+    if (shm_ring_writer_create(&w, &cfg) != 0) {
+        perror("shm_ring_writer_create");
+        goto out;
+    }
+
+    fflush(stdout);
+    for (idx = 0U; idx < readers; ++idx) {
+        pid_t pid = fork();
+
+        if (pid < 0) {
+            perror("fork");
+            goto out;
+        }
+        if (pid == 0) {
+            bool slow = (idx == readers - 1U);
+
+            shm_reader_main(name, shared, idx, slow ? BENCH_SHM_SLOW_BATCH : opts->block_frames,
+                slow ? BENCH_SHM_SLOW_NAP_NS : 0U);
+        }
+        pids[spawned++] = pid;
+    }
+    for (idx = 0U; idx < readers; ++idx) {
+        while (!atomic_load(&shared->rx[idx].ready)) {
+            sched_yield();
+        }
+        if (shared->rx[idx].error != 0) {
+            errno = shared->rx[idx].error;
+            perror("shm_ring_reader_open");
+            goto out;
+        }
+    }
+
+    atomic_store(&shared->go, true);
+    start = now_ns();
+    while (seq < frames) {
+        uint64_t n = frames - seq;
+        uint64_t i;
+
+        if (n > opts->block_frames) {
+            n = opts->block_frames;
+        }
+        for (i = 0U; i < n; ++i) {
+            fill_synthetic_frame(&block[i], seq + i);
+        }
+        shm_ring_writer_publish(w, block, (size_t)n);
+        seq += n;
+        if (fps == 0U) {
+            /* Let readers in between blocks, as they would run beside us on other cores. */
+            sched_yield();
+        } else {
+            uint64_t due = start + (seq * 1000000000ULL) / fps;
+            uint64_t now = now_ns();
+
+            if (due > now) {
+                nap_ns(due - now);
+            }
+        }
+    }
+    elapsed = now_ns() - start;
+    shm_ring_writer_destroy(w);
+    w = NULL;
+
+    rc = 0;
+    for (idx = 0U; idx < spawned; ++idx) {
+        int status = 0;
+
+        if (waitpid(pids[idx], &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            fprintf(stderr, "%s: reader %u failed\n", label, idx);
+            rc = -1;
+        }
+    }
+    spawned = 0U;
+
+    report(label, frames, elapsed, "frame");
+    for (idx = 0U; idx < readers; ++idx) {
+        const shm_rx_result_t *res = &shared->rx[idx];
+        bool slow = (idx == readers - 1U);
+        char rx_label[48];
+
+        snprintf(rx_label, sizeof(rx_label), "  %s reader %u", slow ? "slow" : "fast", idx);
+        report(rx_label, res->frames, res->elapsed_ns, "frame");
+        printf("  %s reader %u: %" PRIu64 " lap(s), %" PRIu64 " frame(s) lost, %" PRIu64
+            " batch(es) overwritten while read\n", slow ? "slow" : "fast", idx, res->laps, res->lost,
+            res->retries);
+    }
+
+out:
+    shm_ring_writer_destroy(w);
+    for (idx = 0U; idx < spawned; ++idx) {
+        (void)kill(pids[idx], SIGKILL);
+        (void)waitpid(pids[idx], NULL, 0);
+    }
+    free(block);
+    munmap(shared, shared_bytes);
+    return rc;
+}
+
+static int bench_shm(const bench_opts_t *opts)
+{
+    uint64_t paced = (opts->frames < BENCH_UDP_PACED_FPS) ? opts->frames : BENCH_UDP_PACED_FPS;
+
+    if (shm_run(opts, "shm flat out", opts->frames, BENCH_SHM_SMALL_RING_FRAMES, 0U) != 0 ||
+        shm_run(opts, "shm at 8 ADCs", paced, SHM_RING_DEFAULT_FRAMES, BENCH_UDP_PACED_FPS) != 0) {
+        return -1;
+    }
+    return 0;
+}
+
+/*
+ * Per-channel test signals, periodic in BENCH_DECIM_SOURCE_FRAMES: ch1/ch2
+ * DC (ch2 near negative full scale), ch3 a passband sine at 0.05 of the
+ * output rate, ch4 a stopband sine at 0.75 of it, ch5..ch8 full-scale noise.
+ */
+static void fill_decim_source(ads1278_frame_t *src, uint32_t factor, double *pass_cycles, double *stop_cycles)
+{
+    const double two_pi = 6.283185307179586;
+    double pass = floor(0.05 * BENCH_DECIM_SOURCE_FRAMES / factor + 0.5);
+    double stop = floor(0.75 * BENCH_DECIM_SOURCE_FRAMES / factor + 0.5);
+    uint64_t rng = 0x2545F4914F6CDD1DULL;
+    uint32_t idx;
+
+    for (idx = 0U; idx < BENCH_DECIM_SOURCE_FRAMES; ++idx) {
+        double t = (double)idx / BENCH_DECIM_SOURCE_FRAMES;
+        uint32_t channel;
+
+        src[idx].ch[0] = BENCH_DECIM_DC;
+        src[idx].ch[1] = ADS1278_SAMPLE_MIN + 100;
+        src[idx].ch[2] = (int32_t)lrint(4194304.0 * sin(two_pi * pass * t));
+        src[idx].ch[3] = (int32_t)lrint(4194304.0 * sin(two_pi * stop * t));
+        for (channel = 4U; channel < ADS1278_CHANNEL_COUNT; ++channel) {
+            src[idx].ch[channel] = (int32_t)((uint32_t)xorshift64(&rng) << 8U) >> 8;
+        }
+    }
+    *pass_cycles = pass;
+    *stop_cycles = stop;
+}
+
+/*
+ * Run one decimator over --frames frames (10 kHz timestamps) in --block-frames
+ * blocks, measuring passband gain, stopband rejection and the CIC + FIR group
+ * delay alongside the throughput.
+ */
+static int bench_decim_spec(const bench_opts_t *opts, const char *spec, ads1278_frame_t *src,
+                            ads1278_frame_t *in, ads1278_frame_t *out)
+{
+    decim_cfg_t cfg;
+    decim_t *decim = NULL;
+    decim_stats_t stats;
+    double pass_cycles;
+    double stop_cycles;
+    double pass_sq = 0.0;
+    double stop_sq = 0.0;
+    uint64_t elapsed_ns = 0U;
+    uint64_t done;
+    uint64_t delay;
+    uint32_t factor;
+    uint32_t order;
+    char label[64];
+
+    if (decim_parse_spec(spec, &cfg) != 0 || decim_create(&decim, &cfg, 1U, ADS1278_CHANNEL_COUNT) != 0) {
+        fprintf(stderr, "decim: bad spec %s\n", spec);
+        return -1;
+    }
+    factor = decim_factor(decim);
+    order = (cfg.cic_factor > 1U) ? ((cfg.cic_order != 0U) ? cfg.cic_order : DECIM_DEFAULT_CIC_ORDER) : 0U;
+    /* Group delay in input frames, doubled to stay integral. */
+    delay = ((uint64_t)order * (((cfg.cic_factor > 1U) ? cfg.cic_factor : 1U) - 1U)) +
+            ((uint64_t)(factor / ((cfg.fir_factor > 1U) ? cfg.fir_factor : 1U)) *
+             ((decim_fir_taps(decim) != 0U) ? decim_fir_taps(decim) - 1U : 0U));
+    fill_decim_source(src, factor, &pass_cycles, &stop_cycles);
+
+    for (done = 0U; done < opts->frames;) {
+        size_t n = opts->block_frames;
+        size_t produced;
+        size_t idx;
+        uint64_t t0;
+
+        if (opts->frames - done < n) {
+            n = (size_t)(opts->frames - done);
+        }
+        for (idx = 0U; idx < n; ++idx) {
+            in[idx] = src[(done + idx) % BENCH_DECIM_SOURCE_FRAMES];
+            in[idx].seq = done + idx;
+            in[idx].tstamp_ns = (done + idx) * BENCH_DECIM_PERIOD_NS;
+        }
+        t0 = now_ns();
+        produced = decim_process(decim, in, n, out);
+        elapsed_ns += now_ns() - t0;
+        done += n;
+
+        for (idx = 0U; idx < produced; ++idx) {
+            const ads1278_frame_t *frame = &out[idx];
+
+            pass_sq += (double)frame->ch[2] * (double)frame->ch[2];
+            stop_sq += (double)frame->ch[3] * (double)frame->ch[3];
+        }
+    }
+
+    decim_get_stats(decim, &stats);
+    {
+        /* RMS of a sine of amplitude 2^22 is 2^22 / sqrt(2). */
+        double ref_sq = 4194304.0 * 4194304.0 / 2.0 * (double)stats.frames_out;
+        double pass_db = 10.0 * log10(pass_sq / ref_sq);
+        double stop_db = 10.0 * log10((stop_sq + 1.0) / ref_sq);
+
+        snprintf(label, sizeof(label), "decim %s", spec);
+        report(label, opts->frames * ADS1278_CHANNEL_COUNT, elapsed_ns, "sample");
+        printf("  /%" PRIu32 ", %" PRIu32 " FIR taps: %.1f channel-MS/s, passband %+.3f dB at %.3f fs_out, "
+            "stopband %.1f dB at %.3f fs_out, delay %.1f input frames\n",
+            factor, decim_fir_taps(decim),
+            (elapsed_ns != 0U) ? (double)(opts->frames * ADS1278_CHANNEL_COUNT) * 1e3 / (double)elapsed_ns : 0.0,
+            pass_db, pass_cycles * factor / BENCH_DECIM_SOURCE_FRAMES, stop_db,
+            stop_cycles * factor / BENCH_DECIM_SOURCE_FRAMES, (double)delay / 2.0);
+    }
+    decim_destroy(decim);
+    return 0;
+}
+
+static int bench_decim(const bench_opts_t *opts)
+{
+    static const char *const specs[] = {
+        "cic=64",
+        "cic=16,fir=4",
+        "cic=8,fir=8",
+        "fir=4",
+        "cic=128,order=5,fir=2"
+    };
+    ads1278_frame_t *src = malloc(BENCH_DECIM_SOURCE_FRAMES * sizeof(*src));
+    ads1278_frame_t *in = malloc(opts->block_frames * sizeof(*in));
+    ads1278_frame_t *out = malloc((opts->block_frames + 1U) * sizeof(*out));
+    size_t idx;
+    int rc = -1;
+
+    if (src == NULL || in == NULL || out == NULL) {
+        perror("malloc");
+        goto out;
+    }
+    for (idx = 0U; idx < sizeof(specs) / sizeof(specs[0]); ++idx) {
+        if (bench_decim_spec(opts, specs[idx], src, in, out) != 0) {
+            goto out;
+        }
+    }
+    rc = 0;
+
+out:
+    free(src);
+    free(in);
+    free(out);
+    return rc;
+}
+
+typedef struct {
+    atomic_bool stop;
+    uint8_t *buf;
+} rt_load_t;
+
+/* Background load: stream through a buffer larger than the caches, yielding now and then. */
+static void *rt_load_thread(void *arg)
+{
+    rt_load_t *load = arg;
+    uint64_t round = 0U;
+
+    while (!atomic_load_explicit(&load->stop, memory_order_relaxed)) {
+        size_t offset;
+
+        for (offset = 0U; offset < BENCH_RT_LOAD_BYTES; offset += 64U) {
+            load->buf[offset] = (uint8_t)(load->buf[offset] + 1U);
+        }
+        if ((++round & 7U) == 0U) {
+            nap_ns(200000U);
+        }
+    }
+    return NULL;
+}
+
+static int rt_run(const char *label, const rt_cfg_t *rt, uint64_t frames, lat_hist_t *latency)
+{
+    ads1278_cfg_t cfg = {0};
+    acq_cfg_t acq_cfg = {0};
+    acq_stats_t stats;
+    acq_t *acq = NULL;
+    ads1278_frame_t batch[BENCH_DEFAULT_BLOCK_FRAMES];
+    char text[512];
+    uint64_t missed;
+    int rc = -1;
+
+    cfg.backend = ADS1278_BACKEND_SIM;
+    cfg.sim.drdy_rate_hz = BENCH_RT_RATE_HZ;
+    cfg.sim.signal = ADS1278_SIM_SIGNAL_RAMP;
+    if (ads1278_open(&cfg) != 0 || ads1278_start() != 0) {
+        perror("ads1278_open/start");
+        ads1278_close();
+        return -1;
+    }
+    acq_cfg.ring_capacity = BENCH_STREAM_RING_FRAMES;
+    acq_cfg.max_frames = frames;
+    acq_cfg.rt = *rt;
+    if (acq_create(&acq, &acq_cfg) != 0 || acq_start(acq) != 0) {
+        perror("acq_create/start");
+        goto out;
+    }
+    for (;;) {
+        bool finished = acq_is_done(acq);
+        size_t n = acq_drain(acq, batch, BENCH_DEFAULT_BLOCK_FRAMES, 100U);
+
+        if (n == 0U && finished) {
+            break;
+        }
+    }
+    acq_stop(acq);
+    acq_get_stats(acq, &stats);
+    missed = ads1278_get_missed_drdy();
+    if (acq_get_error(acq) != 0) {
+        fprintf(stderr, "rt %s: acquisition failed: %s\n", label, strerror(acq_get_error(acq)));
+        goto out;
+    }
+
+    lat_hist_format(&stats.latency, text, sizeof(text));
+    printf("rt %-22s %s, %" PRIu64 " > 100 us, missed DRDY %" PRIu64 ", %" PRIu64 " ring overflow(s)\n",
+        label, text, lat_hist_count_above(&stats.latency, 100000U), missed, stats.ring.overflows);
+    *latency = stats.latency;
+    if (rt_cfg_active(rt)) {
+        rt_status_t status;
+
+        acq_get_rt_status(acq, &status);
+        rt_format_status(rt, &status, text, sizeof(text));
+        printf("  %s\n", text);
+    }
+    rc = 0;
+
+out:
+    acq_destroy(acq);
+    ads1278_stop();
+    ads1278_close();
+    return rc;
+}
+
+/*
+ * DRDY-to-frame latency of the acquisition thread on a sleeping sim DRDY
+ * source: default scheduler idle and under load, then the RT profile under
+ * the same load. The sim edge time is exact, so this is the wakeup latency
+ * plus a near-zero transfer.
+ */
+static int bench_rt(const bench_opts_t *opts)
+{
+    uint64_t frames = opts->frames_set ? opts->frames : BENCH_RT_FRAMES;
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    uint32_t load_threads = (cpus > 0) ? (uint32_t)cpus : 1U;
+    rt_load_t *load = NULL;
+    pthread_t *threads = NULL;
+    uint32_t started = 0U;
+    uint32_t idx;
+    rt_cfg_t plain = {0};
+    rt_cfg_t rt = {0};
+    lat_hist_t idle;
+    lat_hist_t before;
+    lat_hist_t after;
+    int rc = -1;
+
+    rt.priority = BENCH_RT_PRIORITY;
+    rt.cpu_mask = 1ULL << (uint32_t)(((cpus > 0) ? cpus : 1) - 1);
+    rt.lock_memory = true;
+
+    printf("rt: sim DRDY at %u Hz, %" PRIu64 " frames per run, %u load thread(s)\n",
+        BENCH_RT_RATE_HZ, frames, load_threads);
+    if (rt_run("default, idle", &plain, frames, &idle) != 0) {
+        return -1;
+    }
+
+    load = calloc(load_threads, sizeof(*load));
+    threads = calloc(load_threads, sizeof(*threads));
+    if (load == NULL || threads == NULL) {
+        perror("calloc");
+        goto out;
+    }
+    for (idx = 0U; idx < load_threads; ++idx) {
+        atomic_init(&load[idx].stop, false);
+        load[idx].buf = calloc(1U, BENCH_RT_LOAD_BYTES);
+        if (load[idx].buf == NULL || pthread_create(&threads[idx], NULL, rt_load_thread, &load[idx]) != 0) {
+            perror("load thread");
+            goto out;
+        }
+        ++started;
+    }
+
+    if (rt_run("default, loaded", &plain, frames, &before) != 0 ||
+        rt_run("SCHED_FIFO, loaded", &rt, frames, &after) != 0) {
+        goto out;
+    }
+    printf("rt: p99.9 %.1f -> %.1f us, max %.1f -> %.1f us under load\n",
+        (double)lat_hist_quantile(&before, 0.999) / 1000.0, (double)lat_hist_quantile(&after, 0.999) / 1000.0,
+        (double)before.max_ns / 1000.0, (double)after.max_ns / 1000.0);
+    rc = 0;
+
+out:
+    for (idx = 0U; idx < started; ++idx) {
+        atomic_store(&load[idx].stop, true);
+    }
+    for (idx = 0U; idx < started; ++idx) {
+        (void)pthread_join(threads[idx], NULL);
+    }
+    for (idx = 0U; load != NULL && idx < load_threads; ++idx) {
+        free(load[idx].buf);
+    }
+    free(load);
+    free(threads);
+    (void)munlockall();
+    return rc;
+}
+
+/*
+ * Cost of one latency sample (record alone, and with the clock reads that
+ * bracket a stage) over log-uniform 100 ns .. 10 ms latencies, and of a
+ * snapshot.
+ */
+static int bench_stats(const bench_opts_t *opts)
+{
+    static lat_recorder_t rec;
+    size_t count = (opts->frames < BENCH_STATS_MAX_SAMPLES) ? (size_t)opts->frames : BENCH_STATS_MAX_SAMPLES;
+    uint64_t *samples = NULL;
+    uint64_t state = 0x9E3779B97F4A7C15ULL;
+    uint64_t t0;
+    lat_hist_t snap;
+    size_t idx;
+
+    if (count == 0U) {
+        fprintf(stderr, "stats: --frames must be > 0\n");
+        return -1;
+    }
+    samples = malloc(count * sizeof(*samples));
+    if (samples == NULL) {
+        perror("malloc");
+        return -1;
+    }
+    for (idx = 0U; idx < count; ++idx) {
+        double unit;
+
+        state ^= state << 13U;
+        state ^= state >> 7U;
+        state ^= state << 17U;
+        unit = (double)(state >> 11U) / 9007199254740992.0;
+        samples[idx] = (uint64_t)(100.0 * pow(1e5, unit));
+    }
+
+    printf("stats: %zu samples, %u histogram buckets (%zu bytes per recorder)\n",
+        count, LAT_HIST_BUCKETS, sizeof(rec));
+    lat_recorder_reset(&rec);
+    t0 = now_ns();
+    for (idx = 0U; idx < count; ++idx) {
+        lat_recorder_record(&rec, samples[idx]);
+    }
+    report("record", count, now_ns() - t0, "sample");
+
+    t0 = now_ns();
+    for (idx = 0U; idx < count; ++idx) {
+        (void)now_ns();
+        (void)now_ns();
+    }
+    report("2x clock_gettime", count, now_ns() - t0, "sample");
+
+    lat_recorder_reset(&rec);
+    t0 = now_ns();
+    for (idx = 0U; idx < count; ++idx) {
+        uint64_t start = now_ns();
+
+        lat_recorder_record(&rec, now_ns() - start);
+    }
+    report("2x clock_gettime + record", count, now_ns() - t0, "sample");
+
+    t0 = now_ns();
+    for (idx = 0U; idx < 1000U; ++idx) {
+        lat_recorder_snapshot(&rec, &snap);
+    }
+    report("snapshot", 1000U, now_ns() - t0, "snapshot");
+    free(samples);
+    return 0;
+}
+
+static double bench_uniform(uint64_t *state)
+{
+    *state ^= *state << 13U;
+    *state ^= *state >> 7U;
+    *state ^= *state << 17U;
+    return (double)(*state >> 11U) / 9007199254740992.0;
+}
+
+/*
+ * Synthetic DRDY grid with random gaps and uniform timestamp jitter, fed to
+ * the model without backend hints (as with sysfs GPIO); reports the frames
+ * whose inferred index disagrees with the true one.
+ */
+static void drdy_model_trial(double jitter_frac, bool report_rate)
+{
+    drdy_model_t model;
+    uint64_t state = 0x2545F4914F6CDD1DULL;
+    uint64_t truth = 0U;
+    uint64_t true_missed = 0U;
+    uint64_t wrong = 0U;
+    uint64_t offset = 0U;
+    uint64_t elapsed = 0U;
+    uint32_t frame;
+
+    drdy_model_init(&model, true, 0U);
+    for (frame = 0U; frame < BENCH_DRDY_MODEL_FRAMES; ++frame) {
+        double jitter = (bench_uniform(&state) * 2.0 - 1.0) * jitter_frac * BENCH_DRDY_PERIOD_NS;
+        uint64_t tstamp = 1000000000ULL + (uint64_t)((double)truth * BENCH_DRDY_PERIOD_NS + jitter);
+        uint64_t t0 = now_ns();
+        uint64_t index = drdy_model_next(&model, tstamp, 0U);
+
+        elapsed += now_ns() - t0;
+        if (index - truth != offset) {
+            /* Count each misplacement once: later frames are judged against the new offset. */
+            ++wrong;
+            offset = index - truth;
+        }
+        if (bench_uniform(&state) < BENCH_DRDY_GAP_PROB) {
+            uint64_t gap = 1U + (uint64_t)(bench_uniform(&state) * BENCH_DRDY_GAP_MAX);
+
+            truth += gap;
+            true_missed += gap;
+        }
+        ++truth;
+    }
+
+    printf("drdy model jitter +/-%4.0f%%  missed %7" PRIu64 " (true %7" PRIu64 ") in %5" PRIu64
+        " gap(s), %6" PRIu64 " ambiguous, %5" PRIu64 " misplaced, period %.1f ns\n",
+        jitter_frac * 100.0, model.missed, true_missed, model.gaps, model.ambiguous, wrong, model.period_ns);
+    if (report_rate) {
+        report("drdy_model_next", BENCH_DRDY_MODEL_FRAMES, elapsed, "frame");
+    }
+}
+
+/* Sleeping sim DRDY at rate_hz through the acquisition thread. */
+static int drdy_sweep_run(uint32_t rate_hz)
+{
+    ads1278_cfg_t cfg = {0};
+    acq_cfg_t acq_cfg = {0};
+    ads1278_stats_t hal;
+    acq_stats_t stats;
+    acq_t *acq = NULL;
+    ads1278_frame_t batch[BENCH_DEFAULT_BLOCK_FRAMES];
+    uint64_t frames = (uint64_t)((double)rate_hz * BENCH_DRDY_SWEEP_SECONDS);
+    uint64_t drained = 0U;
+    int rc = -1;
+
+    cfg.backend = ADS1278_BACKEND_SIM;
+    cfg.sim.drdy_rate_hz = rate_hz;
+    cfg.sim.signal = ADS1278_SIM_SIGNAL_RAMP;
+    if (ads1278_open(&cfg) != 0 || ads1278_start() != 0) {
+        perror("ads1278_open/start");
+        ads1278_close();
+        return -1;
+    }
+    acq_cfg.ring_capacity = BENCH_STREAM_RING_FRAMES;
+    acq_cfg.max_frames = frames;
+    if (acq_create(&acq, &acq_cfg) != 0 || acq_start(acq) != 0) {
+        perror("acq_create/start");
+        goto out;
+    }
+    for (;;) {
+        bool finished = acq_is_done(acq);
+        size_t n = acq_drain(acq, batch, BENCH_DEFAULT_BLOCK_FRAMES, 100U);
+
+        if (n == 0U && finished) {
+            break;
+        }
+        drained += n;
+    }
+    acq_stop(acq);
+    acq_get_stats(acq, &stats);
+    (void)ads1278_get_stats(&hal);
+    if (acq_get_error(acq) != 0) {
+        fprintf(stderr, "drdy %u Hz: acquisition failed: %s\n", rate_hz, strerror(acq_get_error(acq)));
+        goto out;
+    }
+
+    printf("drdy sim %6u Hz  %7" PRIu64 " frames, %7" PRIu64 " missed (%6.2f%%) in %6" PRIu64
+        " gap(s), longest %5" PRIu64 ", period %.1f ns, ring overflows %" PRIu64 "\n",
+        rate_hz, drained, hal.missed_conversions,
+        100.0 * (double)hal.missed_conversions / (double)(drained + hal.missed_conversions),
+        hal.gap_events, hal.longest_gap, hal.drdy_period_ns, stats.ring.overflows);
+    rc = 0;
+
+out:
+    acq_destroy(acq);
+    ads1278_stop();
+    ads1278_close();
+    return rc;
+}
+
+/*
+ * Missed-conversion inference: model accuracy on synthetic jittered grids,
+ * then a sweep of sleeping sim DRDY rates through the acquisition thread,
+ * which is how the sustainable output data rate of a board is found (run it
+ * there with the real backend settings in mind).
+ */
+static int bench_drdy(const bench_opts_t *opts)
+{
+    static const double jitters[] = {0.0, 0.05, 0.10, 0.20, 0.35};
+    static const uint32_t rates[] = {8000U, 16000U, 32000U, 52734U, 105469U};
+    size_t idx;
+
+    (void)opts;
+    for (idx = 0U; idx < sizeof(jitters) / sizeof(jitters[0]); ++idx) {
+        drdy_model_trial(jitters[idx], idx == 0U);
+    }
+    for (idx = 0U; idx < sizeof(rates) / sizeof(rates[0]); ++idx) {
+        if (drdy_sweep_run(rates[idx]) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+typedef struct {
+    ads1278_dev_t *dev;
+    acq_t *acq;
+    pthread_t consumer;
+    bool consumer_started;
+    uint64_t drained;
+} multi_dev_t;
+
+/* Drain one device's ring, as a server's consumer would. */
+static void *multi_consumer_main(void *arg)
+{
+    multi_dev_t *md = arg;
+    ads1278_frame_t batch[BENCH_DEFAULT_BLOCK_FRAMES];
+
+    for (;;) {
+        bool finished = acq_is_done(md->acq);
+        size_t n = acq_drain(md->acq, batch, BENCH_DEFAULT_BLOCK_FRAMES, 100U);
+
+        if (n == 0U && finished) {
+            break;
+        }
+        md->drained += n;
+    }
+    return NULL;
+}
+
+/* count free-running sim devices, each on its own acquisition thread pinned to its own CPU. */
+static int multi_run(uint32_t count, uint64_t frames, uint32_t cpus, double *aggregate_fps)
+{
+    multi_dev_t devs[BENCH_MAX_DEVICES];
+    uint64_t read_total = 0U;
+    uint64_t drained_total = 0U;
+    uint64_t overflows = 0U;
+    uint64_t t0;
+    uint64_t elapsed;
+    uint32_t idx;
+    int rc = -1;
+
+    memset(devs, 0, sizeof(devs));
+    for (idx = 0U; idx < count; ++idx) {
+        ads1278_cfg_t cfg = {0};
+        acq_cfg_t acq_cfg = {0};
+
+        cfg.backend = ADS1278_BACKEND_SIM;
+        cfg.sim.drdy_rate_hz = 0U;
+        cfg.sim.signal = ADS1278_SIM_SIGNAL_RAMP;
+        if (ads1278_dev_open(&devs[idx].dev, &cfg) != 0 || ads1278_dev_start(devs[idx].dev) != 0) {
+            perror("ads1278_dev_open/start");
+            goto out;
+        }
+        acq_cfg.dev = devs[idx].dev;
+        acq_cfg.ring_capacity = BENCH_STREAM_RING_FRAMES;
+        acq_cfg.max_frames = frames;
+        acq_cfg.rt.cpu_mask = 1ULL << (idx % cpus);
+        if (acq_create(&devs[idx].acq, &acq_cfg) != 0) {
+            perror("acq_create");
+            goto out;
+        }
+    }
+
+    t0 = now_ns();
+    for (idx = 0U; idx < count; ++idx) {
+        if (acq_start(devs[idx].acq) != 0) {
+            perror("acq_start");
+            goto out;
+        }
+        if (pthread_create(&devs[idx].consumer, NULL, multi_consumer_main, &devs[idx]) != 0) {
+            fprintf(stderr, "multi: cannot start consumer thread\n");
+            goto out;
+        }
+        devs[idx].consumer_started = true;
+    }
+    for (idx = 0U; idx < count; ++idx) {
+        (void)pthread_join(devs[idx].consumer, NULL);
+        devs[idx].consumer_started = false;
+    }
+    elapsed = now_ns() - t0;
+
+    for (idx = 0U; idx < count; ++idx) {
+        acq_stats_t stats;
+
+        acq_stop(devs[idx].acq);
+        acq_get_stats(devs[idx].acq, &stats);
+        if (acq_get_error(devs[idx].acq) != 0) {
+            fprintf(stderr, "multi: device %u failed: %s\n", idx, strerror(acq_get_error(devs[idx].acq)));
+            goto out;
+        }
+        read_total += stats.frames_read;
+        drained_total += devs[idx].drained;
+        overflows += stats.ring.overflows;
+    }
+
+    *aggregate_fps = (double)read_total * 1e9 / (double)elapsed;
+    printf("multi %2u device(s)  %9" PRIu64 " frames in %8.3f ms  %10.0f frame/s aggregate  %10.0f per device"
+        "  %" PRIu64 " drained, %" PRIu64 " ring overflow(s)\n",
+        count, read_total, (double)elapsed / 1e6, *aggregate_fps, *aggregate_fps / (double)count,
+        drained_total, overflows);
+    rc = 0;
+
+out:
+    for (idx = 0U; idx < count; ++idx) {
+        if (devs[idx].acq != NULL) {
+            acq_stop(devs[idx].acq);
+        }
+        if (devs[idx].consumer_started) {
+            (void)pthread_join(devs[idx].consumer, NULL);
+        }
+        acq_destroy(devs[idx].acq);
+        ads1278_dev_stop(devs[idx].dev);
+        ads1278_dev_close(devs[idx].dev);
+    }
+    return rc;
+}
+
+/*
+ * Aggregate read throughput of 1, 2, 4 .. --devices independent sim devices
+ * opened through the handle API, one acquisition thread per device pinned
+ * round-robin over the online CPUs, one consumer thread each.
+ */
+static int bench_multi(const bench_opts_t *opts)
+{
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    uint32_t cpus = (online > 0 && online < 64) ? (uint32_t)online : 1U;
+    double single = 0.0;
+    uint32_t count = 1U;
+
+    printf("multi: free-running sim, %" PRIu64 " frames per device, %u CPU(s)\n", opts->frames, cpus);
+    for (;;) {
+        double fps;
+
+        if (multi_run(count, opts->frames, cpus, &fps) != 0) {
+            return -1;
+        }
+        if (count == 1U) {
+            single = fps;
+        } else {
+            printf("  scaling vs 1 device: %.2fx\n", fps / single);
+        }
+        if (count == opts->devices) {
+            break;
+        }
+        count = (count * 2U < opts->devices) ? count * 2U : opts->devices;
+    }
+    return 0;
+}
+
+/* One chain length: frame and block reads, then P24 and DELTA encoding of what was read. */
+static int chain_run(const bench_opts_t *opts, uint32_t chain)
+{
+    ads1278_cfg_t cfg = {0};
+    ads1278_dev_t *dev = NULL;
+    ads1278_block_pool_t *pool = NULL;
+    ads1278_block_t *blk = NULL;
+    ads1278_frame_t *src = NULL;
+    bench_opts_t wire_opts = *opts;
+    uint32_t channels = chain * ADS1278_CHANNEL_COUNT;
+    size_t src_frames = (opts->frames < BENCH_CHAIN_SOURCE_FRAMES) ? (size_t)opts->frames : BENCH_CHAIN_SOURCE_FRAMES;
+    uint64_t frame_ns;
+    uint64_t block_ns;
+    uint64_t done;
+    uint64_t t0;
+    char label[64];
+    int rc = -1;
+
+    cfg.backend = ADS1278_BACKEND_SIM;
+    cfg.sim.drdy_rate_hz = 0U;
+    cfg.sim.signal = ADS1278_SIM_SIGNAL_RAMP;
+    cfg.chain_length = chain;
+    src = malloc(src_frames * sizeof(*src));
+    if (src == NULL || ads1278_block_pool_create(&pool, 1U, opts->block_frames) != 0) {
+        perror("chain setup");
+        goto out;
+    }
+    blk = ads1278_block_acquire(pool);
+    if (ads1278_dev_open(&dev, &cfg) != 0 || ads1278_dev_start(dev) != 0) {
+        perror("ads1278_dev_open/start");
+        goto out;
+    }
+
+    t0 = now_ns();
+    for (done = 0U; done < opts->frames; ++done) {
+        ads1278_frame_t frame;
+
+        if (ads1278_dev_read_frame(dev, &frame) != 0) {
+            perror("ads1278_dev_read_frame");
+            goto out;
+        }
+        if (done < src_frames) {
+            src[done] = frame;
+        }
+    }
+    frame_ns = now_ns() - t0;
+
+    t0 = now_ns();
+    for (done = 0U; done < opts->frames; done += blk->count) {
+        size_t n = opts->block_frames;
+
+        if (opts->frames - done < n) {
+            n = (size_t)(opts->frames - done);
+        }
+        if (ads1278_dev_read_frames(dev, blk, n) != 0) {
+            perror("ads1278_dev_read_frames");
+            goto out;
+        }
+    }
+    block_ns = now_ns() - t0;
+
+    snprintf(label, sizeof(label), "chain %u read_frame", chain);
+    report(label, opts->frames, frame_ns, "frame");
+    snprintf(label, sizeof(label), "chain %u read_frames", chain);
+    report(label, opts->frames, block_ns, "frame");
+    printf("  %u channel(s): %.1f / %.1f ns per channel-sample (frame / block path)\n", channels,
+        (double)frame_ns / ((double)opts->frames * channels), (double)block_ns / ((double)opts->frames * channels));
+
+    wire_opts.frames = src_frames;
+    if (bench_wire_encoding(&wire_opts, PROTO_DATA_ENC_P24, channels, src, src_frames, false) != 0 ||
+        bench_wire_encoding(&wire_opts, PROTO_DATA_ENC_DELTA, channels, src, src_frames, false) != 0) {
+        goto out;
+    }
+    rc = 0;
+
+out:
+    ads1278_dev_stop(dev);
+    ads1278_dev_close(dev);
+    if (blk != NULL) {
+        ads1278_block_release(pool, blk);
+    }
+    ads1278_block_pool_destroy(pool);
+    free(src);
+    return rc;
+}
+
+/*
+ * Daisy-chained readout on the sim backend at chain lengths 1..ADS1278_MAX_CHAIN:
+ * per-frame cost of both read paths and of P24/DELTA DATA messages against
+ * chain length.
+ */
+static int bench_chain(const bench_opts_t *opts)
+{
+    uint32_t chain;
+
+    printf("chain: free-running sim, %" PRIu64 " frames per length, ADS1278_MAX_CHAIN %u\n",
+        opts->frames, (unsigned)ADS1278_MAX_CHAIN);
+    for (chain = 1U; chain <= ADS1278_MAX_CHAIN; ++chain) {
+        if (chain_run(opts, chain) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/*
+ * Trigger test signals, periodic in BENCH_TRIGGER_SOURCE_FRAMES:
+ *   ch1    square +-1e6: rises at 500 + 1000k, falls at 1000k
+ *   ch2    triangle +-1e6 (2000 codes/frame) plus +-20000 noise: rises through 0 near 500 + 2000k
+ *   ch3    step to 50000 at 1234 + 3000k, back to 0 at 3000k
+ *   ch4    pulse to 3e6 over [700, 720) + 1000k
+ *   ch5..8 ramps
+ */
+static void fill_trigger_source(ads1278_frame_t *src)
+{
+    uint64_t rng = 0x9E3779B97F4A7C15ULL;
+    uint32_t idx;
+
+    for (idx = 0U; idx < BENCH_TRIGGER_SOURCE_FRAMES; ++idx) {
+        uint32_t tri = idx % 2000U;
+        uint32_t channel;
+
+        memset(&src[idx], 0, sizeof(src[idx]));
+        src[idx].ch[0] = ((idx / 500U) % 2U != 0U) ? 1000000 : -1000000;
+        src[idx].ch[1] = ((tri < 1000U) ? -1000000 + (int32_t)(2000U * tri)
+                                         : 1000000 - (int32_t)(2000U * (tri - 1000U))) +
+                         (int32_t)(xorshift64(&rng) % 40001U) - 20000;
+        src[idx].ch[2] = (idx % 3000U >= 1234U) ? 50000 : 0;
+        src[idx].ch[3] = (idx % 1000U >= 700U && idx % 1000U < 720U) ? 3000000 : 0;
+        for (channel = 4U; channel < ADS1278_CHANNEL_COUNT; ++channel) {
+            src[idx].ch[channel] = (int32_t)((idx * 1021U * channel) & 0x7FFFFFU);
+        }
+    }
+}
+
+/* Feed --frames frames through one trigger spec in --block-frames blocks; only trigger_process() is timed. */
+static int trigger_time(const bench_opts_t *opts, const char *spec, const ads1278_frame_t *src, ads1278_frame_t *in)
+{
+    trigger_cfg_t cfg;
+    trigger_t *trig = NULL;
+    trigger_event_t event;
+    trigger_stats_t stats;
+    uint64_t elapsed_ns = 0U;
+    uint64_t done;
+    char label[64];
+
+    if (trigger_parse_spec(spec, &cfg) != 0 || trigger_create(&trig, &cfg) != 0) {
+        fprintf(stderr, "trigger: bad spec %s\n", spec);
+        return -1;
+    }
+    for (done = 0U; done < opts->frames;) {
+        size_t n = opts->block_frames;
+        size_t pos = 0U;
+        size_t idx;
+        uint64_t t0;
+
+        if (opts->frames - done < n) {
+            n = (size_t)(opts->frames - done);
+        }
+        for (idx = 0U; idx < n; ++idx) {
+            in[idx] = src[(done + idx) % BENCH_TRIGGER_SOURCE_FRAMES];
+            in[idx].seq = done + idx;
+            in[idx].tstamp_ns = (done + idx) * BENCH_TRIGGER_PERIOD_NS;
+        }
+        done += n;
+
+        t0 = now_ns();
+        while (pos < n) {
+            pos += trigger_process(trig, in + pos, n - pos, &event);
+        }
+        elapsed_ns += now_ns() - t0;
+    }
+    trigger_flush(trig, &event);
+    trigger_get_stats(trig, &stats);
+    trigger_destroy(trig);
+
+    snprintf(label, sizeof(label), "trigger %" PRIu32 " condition(s)", cfg.cond_count);
+    report(label, opts->frames, elapsed_ns, "frame");
+    printf("  %" PRIu64 " event(s), %" PRIu64 " suppressed\n", stats.events, stats.suppressed);
+    return 0;
+}
+
+/* Frames/s through trigger_process() for one noisy level and for every condition kind at once. */
+static int bench_trigger(const bench_opts_t *opts)
+{
+    static const char *const timed[] = {
+        "pre=64,post=64,ch=2,rise=0,hyst=50000",
+        "pre=64,post=64,ch=1,rise=0,fall=0,ch=2,rise=0,hyst=50000,ch=3,slope=40000,slope=-40000,"
+            "ch=4,outside=-1000000:1000000,inside=-1000000:1000000,ch=5,rise=8000000"
+    };
+    ads1278_frame_t *src = malloc(BENCH_TRIGGER_SOURCE_FRAMES * sizeof(*src));
+    ads1278_frame_t *in = malloc(opts->block_frames * sizeof(*in));
+    size_t idx;
+    int rc = -1;
+
+    if (src == NULL || in == NULL) {
+        perror("malloc");
+        goto out;
+    }
+    fill_trigger_source(src);
+    printf("trigger: %" PRIu64 " frames per spec, --block-frames %" PRIu32 "\n", opts->frames, opts->block_frames);
+    for (idx = 0U; idx < sizeof(timed) / sizeof(timed[0]); ++idx) {
+        if (trigger_time(opts, timed[idx], src, in) != 0) {
+            goto out;
+        }
+    }
+    rc = 0;
+
+out:
+    free(src);
+    free(in);
+    return rc;
+}
+
+/* Full-range uniform noise on every channel. */
+static void fill_calib_frames(ads1278_frame_t *frames, size_t n, uint32_t channels, uint64_t seed)
+{
+    size_t i;
+    uint32_t c;
+
+    for (i = 0U; i < n; ++i) {
+        frames[i].seq = i;
+        frames[i].tstamp_ns = (uint64_t)i * 1000U;
+        for (c = 0U; c < channels; ++c) {
+            frames[i].ch[c] = (int32_t)((uint32_t)xorshift64(&seed) << 8U) >> 8;
+        }
+    }
+}
+
+/* Statistics and volts conversion per kernel, at the base and the largest channel count. */
+static int bench_chanstats(const bench_opts_t *opts)
+{
+    const size_t n = BENCH_CALIB_SOURCE_FRAMES;
+    const uint32_t k_channels[] = {ADS1278_CHANNEL_COUNT, ADS1278_MAX_CHANNELS};
+    chan_stats_impl_t saved = chan_stats_active();
+    ads1278_frame_t *frames = NULL;
+    float *got = NULL;
+    chan_stats_t *st = NULL;
+    chan_stats_summary_t total;
+    chan_calib_t cal;
+    chan_stats_impl_t impl;
+    size_t ch_idx;
+    int rc = -1;
+
+    frames = calloc(n, sizeof(*frames));
+    got = malloc(n * ADS1278_MAX_CHANNELS * sizeof(*got));
+    if (frames == NULL || got == NULL) {
+        perror("malloc");
+        goto out;
+    }
+
+    printf("default kernels: %s\n", chan_stats_impl_name(saved));
+    for (ch_idx = 0U; ch_idx < sizeof(k_channels) / sizeof(k_channels[0]); ++ch_idx) {
+        const uint32_t channels = k_channels[ch_idx];
+
+        if (ch_idx != 0U && channels == k_channels[0]) {
+            continue;
+        }
+        fill_calib_frames(frames, n, channels, 7U);
+        chan_calib_init(&cal, channels, CHAN_CALIB_DEFAULT_VREF);
+        if (chan_stats_create(&st, channels) != 0) {
+            perror("chan_stats_create");
+            goto out;
+        }
+        for (impl = CHAN_STATS_SCALAR; impl < CHAN_STATS_IMPL_COUNT; ++impl) {
+            char label[64];
+            uint64_t done;
+            uint64_t t0;
+
+            if (chan_stats_select(impl) != 0) {
+                continue;
+            }
+            chan_stats_reset(st);
+            t0 = now_ns();
+            for (done = 0U; done < opts->frames; done += n) {
+                chan_stats_update(st, frames, n);
+            }
+            chan_stats_total(st, &total);
+            snprintf(label, sizeof(label), "stats %s (%u ch)", chan_stats_impl_name(impl), channels);
+            report(label, done, now_ns() - t0, "frame");
+
+            t0 = now_ns();
+            for (done = 0U; done < opts->frames; done += n) {
+                chan_calib_frames(&cal, frames, n, got);
+            }
+            snprintf(label, sizeof(label), "volts %s (%u ch)", chan_stats_impl_name(impl), channels);
+            report(label, done * channels, now_ns() - t0, "sample");
+        }
+        chan_stats_destroy(st);
+        st = NULL;
+    }
+    rc = 0;
+
+out:
+    (void)chan_stats_select(saved);
+    chan_stats_destroy(st);
+    free(frames);
+    free(got);
+    return rc;
+}
+
+/* A DC offset per channel plus 20 bits of uniform noise, at BENCH_PSD_PERIOD_NS. */
+static void fill_psd_frames(ads1278_frame_t *frames, size_t n, uint32_t channels, uint64_t seed)
+{
+    size_t i;
+    uint32_t c;
+
+    for (i = 0U; i < n; ++i) {
+        frames[i].seq = i;
+        frames[i].tstamp_ns = i * BENCH_PSD_PERIOD_NS;
+        for (c = 0U; c < channels; ++c) {
+            frames[i].ch[c] = (int32_t)(100000U * c) + (int32_t)(xorshift64(&seed) & 0xFFFFFU) - 0x80000;
+        }
+    }
+}
+
+/* Feed every frame, keeping a copy of the last result's densities in keep. */
+static int psd_feed(psd_t *psd, const ads1278_frame_t *frames, size_t n, psd_result_t *last, float *keep)
+{
+    int results = 0;
+
+    while (n != 0U) {
+        psd_result_t result;
+        size_t used = psd_process(psd, frames, n, &result);
+
+        if (result.bins != 0U) {
+            uint32_t c;
+
+            *last = result;
+            for (c = 0U; c < result.channel_count; ++c) {
+                memcpy(keep + ((size_t)c * result.bins), result.psd[c], result.bins * sizeof(*keep));
+                last->psd[c] = keep + ((size_t)c * result.bins);
+            }
+            ++results;
+        }
+        frames += used;
+        n -= used;
+    }
+    return results;
+}
+
+static int bench_psd(const bench_opts_t *opts)
+{
+    static const uint32_t k_sizes[] = {1024U, 4096U, 16384U};
+    const uint32_t channels = ADS1278_CHANNEL_COUNT;
+    const size_t n = 16384U * 8U;
+    ads1278_frame_t *frames = NULL;
+    float *keep = NULL;
+    double *buf = NULL;
+    psd_rfft_t *fft = NULL;
+    psd_t *psd = NULL;
+    psd_cfg_t cfg;
+    psd_result_t result;
+    char label[64];
+    size_t idx;
+    uint32_t c;
+    int rc = -1;
+
+    frames = calloc(n, sizeof(*frames));
+    keep = malloc(16384U * ADS1278_MAX_CHANNELS * sizeof(*keep));
+    buf = calloc((2U * 16384U) + 2U, sizeof(*buf));
+    memset(&result, 0, sizeof(result));
+    if (frames == NULL || keep == NULL || buf == NULL) {
+        perror("malloc");
+        goto out;
+    }
+    fill_psd_frames(frames, n, channels, 5U);
+
+    for (idx = 0U; idx < sizeof(k_sizes) / sizeof(k_sizes[0]); ++idx) {
+        const uint32_t size = k_sizes[idx];
+        uint64_t done = 0U;
+        uint64_t count = 0U;
+        uint64_t t0;
+
+        if (psd_rfft_create(&fft, size) != 0) {
+            perror("psd_rfft_create");
+            goto out;
+        }
+        for (c = 0U; c < size; ++c) {
+            buf[c] = (double)frames[c].ch[0];
+        }
+        t0 = now_ns();
+        for (done = 0U; done < opts->frames; done += size) {
+            psd_rfft_forward(fft, buf, buf + size);
+            ++count;
+        }
+        snprintf(label, sizeof(label), "rfft %u", size);
+        report(label, count, now_ns() - t0, "fft");
+        psd_rfft_destroy(fft);
+        fft = NULL;
+
+        snprintf(label, sizeof(label), "fft=%u", size);
+        if (psd_parse_spec(label, &cfg) != 0) {
+            goto out;
+        }
+        cfg.channel_count = channels;
+        cfg.sample_rate_hz = 1e9 / BENCH_PSD_PERIOD_NS;
+        if (psd_create(&psd, &cfg) != 0) {
+            perror("psd_create");
+            goto out;
+        }
+        t0 = now_ns();
+        for (done = 0U; done < opts->frames; done += n) {
+            (void)psd_feed(psd, frames, n, &result, keep);
+        }
+        snprintf(label, sizeof(label), "welch %u, hann 50%% (%u ch)", size, channels);
+        report(label, done, now_ns() - t0, "frame");
+        psd_destroy(psd);
+        psd = NULL;
+    }
+    rc = 0;
+
+out:
+    psd_rfft_destroy(fft);
+    psd_destroy(psd);
+    free(frames);
+    free(keep);
+    free(buf);
+    return rc;
+}
+
+typedef struct {
+    double raw_rms_ns;          /* raw - true, about its mean */
+    double err_rms_ns;          /* model - true, about its mean */
+    double err_pp_ns;           /* model - true, peak to peak */
+    double drift_ppm;
+    uint64_t outliers;
+    uint64_t relocks;
+} clock_trial_t;
+
+/*
+ * A BENCH_CLOCK_DRIFT_PPM-fast conversion clock read with exponential wakeup
+ * latency of mean latency_ns, BENCH_CLOCK_OUTLIER_PROB stalls and optionally a
+ * timestamp step halfway. Frames after the step's settle window and before it
+ * are scored; out (BENCH_CLOCK_FRAMES entries, may be NULL) gets the model's
+ * frames.
+ */
+static void clock_trial(double latency_ns, bool step, bool report_rate, ads1278_frame_t *out, clock_trial_t *res)
+{
+    const double period = (1e9 / BENCH_CLOCK_RATE_HZ) / (1.0 + (BENCH_CLOCK_DRIFT_PPM * 1e-6));
+    const uint64_t origin = 1000000000000ULL;
+    uint64_t seed = 0x243F6A8885A308D3ULL;
+    clock_model_t model;
+    double raw_sum = 0.0;
+    double raw_sq = 0.0;
+    double err_sum = 0.0;
+    double err_sq = 0.0;
+    double err_min = INFINITY;
+    double err_max = -INFINITY;
+    uint64_t scored = 0U;
+    uint64_t t0;
+    uint32_t idx;
+
+    memset(res, 0, sizeof(*res));
+    clock_model_init(&model, BENCH_CLOCK_RATE_HZ);
+    for (idx = 0U; idx < BENCH_CLOCK_FRAMES; ++idx) {
+        double u = ((double)(xorshift64(&seed) >> 11) + 0.5) * 0x1.0p-53;
+        double latency = -latency_ns * log(u);
+        double shift = (step && idx >= BENCH_CLOCK_FRAMES / 2U) ? BENCH_CLOCK_STEP_NS : 0.0;
+        uint64_t truth = origin + (uint64_t)llround(((double)idx * period) + shift);
+        uint64_t raw;
+        uint64_t smoothed;
+        bool score = !step || idx < BENCH_CLOCK_FRAMES / 2U || idx >= (BENCH_CLOCK_FRAMES / 2U) + BENCH_CLOCK_SETTLE_FRAMES;
+
+        if ((double)(xorshift64(&seed) >> 11) * 0x1.0p-53 < BENCH_CLOCK_OUTLIER_PROB) {
+            latency += BENCH_CLOCK_OUTLIER_NS;
+        }
+        raw = truth + (uint64_t)llround(latency);
+        smoothed = clock_model_next(&model, idx, raw);
+        if (out != NULL) {
+            uint32_t channel;
+
+            out[idx].seq = idx;
+            out[idx].tstamp_ns = smoothed;
+            for (channel = 0U; channel < ADS1278_CHANNEL_COUNT; ++channel) {
+                out[idx].ch[channel] = sim_ramp_value(idx, channel);
+            }
+        }
+        if (!score || idx < BENCH_CLOCK_FRAMES / 8U || !model.locked) {
+            continue;
+        }
+        {
+            double raw_err = (double)(int64_t)(raw - truth);
+            double err = (double)(int64_t)(smoothed - truth);
+
+            raw_sum += raw_err;
+            raw_sq += raw_err * raw_err;
+            err_sum += err;
+            err_sq += err * err;
+            err_min = fmin(err_min, err);
+            err_max = fmax(err_max, err);
+            ++scored;
+        }
+    }
+
+    if (scored != 0U) {
+        double raw_mean = raw_sum / (double)scored;
+        double err_mean = err_sum / (double)scored;
+
+        res->raw_rms_ns = sqrt(fmax(raw_sq / (double)scored - raw_mean * raw_mean, 0.0));
+        res->err_rms_ns = sqrt(fmax(err_sq / (double)scored - err_mean * err_mean, 0.0));
+        res->err_pp_ns = err_max - err_min;
+    }
+    res->drift_ppm = clock_model_drift_ppm(&model);
+    res->outliers = model.outliers;
+    res->relocks = model.relocks;
+    printf("clock latency %6.0f ns%s  raw %9.1f ns RMS -> model %7.2f ns RMS (p-p %8.1f), drift %+.3f ppm "
+        "(true %+.1f), %" PRIu64 " outlier(s), %" PRIu64 " relock(s)\n",
+        latency_ns, step ? " +step" : "      ", res->raw_rms_ns, res->err_rms_ns, res->err_pp_ns, res->drift_ppm,
+        BENCH_CLOCK_DRIFT_PPM, res->outliers, res->relocks);
+    if (report_rate) {
+        clock_model_init(&model, BENCH_CLOCK_RATE_HZ);
+        t0 = now_ns();
+        for (idx = 0U; idx < BENCH_CLOCK_FRAMES; ++idx) {
+            (void)clock_model_next(&model, idx, 1000000000ULL + (idx * 18963ULL) + (xorshift64(&seed) & 0x3FFFU));
+        }
+        report("clock_model_next", BENCH_CLOCK_FRAMES, now_ns() - t0, "frame");
+    }
+}
+
+/*
+ * Encode frames in BENCH_DEFAULT_BLOCK_FRAMES messages with linear timestamps
+ * at tolerance_ns, or per-frame deltas when linear is false.
+ */
+static int clock_wire_run(uint16_t encoding, const ads1278_frame_t *src, size_t n, bool linear,
+                          uint32_t tolerance_ns, double *bytes_per_frame, double *linear_frac)
+{
+    proto_data_encoder_t enc;
+    uint8_t *msg = malloc(proto_data_max_bytes(encoding, ADS1278_CHANNEL_COUNT, BENCH_DEFAULT_BLOCK_FRAMES));
+    uint64_t bytes = 0U;
+    uint64_t msgs = 0U;
+    size_t pos = 0U;
+
+    if (msg == NULL || proto_data_encoder_init(&enc, encoding, ADS1278_CHANNEL_COUNT, BENCH_DEFAULT_BLOCK_FRAMES) != 0) {
+        perror("clock wire setup");
+        free(msg);
+        return -1;
+    }
+    enc.linear_ts = linear;
+    enc.linear_tolerance_ns = tolerance_ns;
+
+    while (pos < n) {
+        proto_data_begin(&enc, msg, (uint32_t)msgs, &src[pos]);
+        pos += proto_data_append(&enc, &src[pos], n - pos);
+        bytes += proto_data_finish(&enc);
+        ++msgs;
+    }
+    *bytes_per_frame = (double)bytes / (double)n;
+    *linear_frac = (double)enc.linear_msgs / (double)msgs;
+    proto_data_encoder_destroy(&enc);
+    free(msg);
+    return 0;
+}
+
+/*
+ * Timestamp clock model: error against the true conversion times over a
+ * latency sweep (with drift, stalls and a timestamp step), then its output
+ * sent as base + rate DATA timestamps and the bytes per frame that saves.
+ */
+static int bench_clock(const bench_opts_t *opts)
+{
+    static const double latencies[] = {0.0, 2000.0, 10000.0, 50000.0};
+    static const uint16_t encodings[] = {PROTO_DATA_ENC_P24, PROTO_DATA_ENC_DELTA};
+    const size_t settled = BENCH_CLOCK_FRAMES / 8U;
+    ads1278_frame_t *frames = malloc(BENCH_CLOCK_FRAMES * sizeof(*frames));
+    clock_trial_t res;
+    size_t idx;
+    int rc = -1;
+
+    (void)opts;
+    if (frames == NULL) {
+        perror("malloc");
+        return -1;
+    }
+    for (idx = 0U; idx < sizeof(latencies) / sizeof(latencies[0]); ++idx) {
+        clock_trial(latencies[idx], false, idx == 0U, (latencies[idx] == 10000.0) ? frames : NULL, &res);
+    }
+    clock_trial(10000.0, true, false, NULL, &res);
+
+    for (idx = 0U; idx < sizeof(encodings) / sizeof(encodings[0]); ++idx) {
+        double deltas_bpf;
+        double linear_bpf;
+        double frac;
+
+        if (clock_wire_run(encodings[idx], frames + settled, BENCH_CLOCK_FRAMES - settled, false, 0U,
+                           &deltas_bpf, &frac) != 0 ||
+            clock_wire_run(encodings[idx], frames + settled, BENCH_CLOCK_FRAMES - settled, true,
+                           CLOCK_MODEL_LINEAR_TOLERANCE_NS, &linear_bpf, &frac) != 0) {
+            goto out;
+        }
+        printf("clock wire %-5s model timestamps: %.2f byte/frame with deltas, %.2f base + rate "
+            "(%.1f%% of messages linear)\n", proto_data_encoding_name(encodings[idx]), deltas_bpf, linear_bpf,
+            frac * 100.0);
+    }
+    rc = 0;
+
+out:
+    free(frames);
+    return rc;
+}
+
+static const bench_mode_t k_modes[] = {
+    {"read", "HAL read path on the free-running sim backend (AoS vs SoA blocks)", bench_read},
+    {"unpack", "24-bit frame unpack per implementation (scalar/SSSE3/AVX2/NEON)", bench_unpack},
+    {"capture", "capture files: per-field fwrite vs the buffered writer, v2 write/read/seek", bench_capture},
+    {"segments", "rotating capture segments: size/time rotation, quota, checkpoints, kill -9 recovery",
+     bench_segments},
+    {"wire", "DATA message encode and decode MB/s per encoding (record48, p24, delta)", bench_wire},
+    {"codec", "delta/zigzag/bit-pack sample codec: ratio and MB/s per signal (and --in)", bench_codec},
+    {"decim", "CIC + FIR decimator: channel-samples/s per core and measured response", bench_decim},
+    {"stream", "epoll TCP fan-out over loopback to --clients readers plus one stalled reader", bench_stream},
+    {"uring", "io_uring vs plain syscalls: capture block writes and stream fan-out, syscalls/MB and CPU%",
+     bench_uring},
+    {"resume", "backpressure policies over loopback with a stalled reader: GAPs, disconnect + resume, never-drop",
+     bench_resume},
+    {"udp", "multicast DATA datagrams over loopback to --clients listeners: sendmmsg batching and loss",
+     bench_udp},
+    {"shm", "shared-memory frame ring: --clients reader processes plus a slow one, laps and retries",
+     bench_shm},
+    {"rt", "acquisition wakeup latency: default scheduler vs SCHED_FIFO/affinity/mlockall under load", bench_rt},
+    {"stats", "latency histogram: record and snapshot cost per sample", bench_stats},
+    {"drdy", "missed-conversion inference: model accuracy vs jitter, sim DRDY rate sweep", bench_drdy},
+    {"multi", "aggregate throughput of 1..--devices sim devices, one pinned acquisition thread each", bench_multi},
+    {"chain", "daisy-chained readout per chain length: read path and DATA message cost per frame", bench_chain},
+    {"trigger", "triggered capture: frames/s and event counts per trigger spec on synthetic signals", bench_trigger},
+    {"chanstats", "channel statistics and volts calibration: SIMD vs scalar frames/s", bench_chanstats},
+    {"psd", "Welch PSD: FFTs/s and 8-channel frames/s", bench_psd},
+    {"clock", "timestamp clock model: error vs latency/drift/steps, base + rate DATA timestamps", bench_clock}
+};
+
+static void usage(FILE *stream, const char *prog_name)
+{
+    size_t idx;
+
+    fprintf(stream,
+        "Usage: %s <mode> [options]\n"
+        "\n"
+        "Modes:\n",
+        prog_name);
+    for (idx = 0U; idx < sizeof(k_modes) / sizeof(k_modes[0]); ++idx) {
+        fprintf(stream, "  %-12s %s\n", k_modes[idx].name, k_modes[idx].summary);
+    }
+    fprintf(stream,
+        "\n"
+        "Options:\n"
+        "  --frames <n>                         Frames per run (default: %u)\n"
+        "  --block-frames <n>                   Frames per block (default: %u)\n"
+        "  --clients <n>                        Stream readers (default: %u)\n"
+        "  --devices <n>                        multi: most sim devices in parallel (default: %u)\n"
+        "  --in <path>                          codec: also run on a recorded capture file\n"
+        "  --help                               Show this help text\n",
+        BENCH_DEFAULT_FRAMES,
+        BENCH_DEFAULT_BLOCK_FRAMES,
+        BENCH_DEFAULT_CLIENTS,
+        BENCH_DEFAULT_DEVICES);
+}
+
+int main(int argc, char **argv)
+{
+    bench_opts_t opts;
+    const bench_mode_t *mode = NULL;
+    size_t idx;
+
+    static const struct option long_options[] = {
+        {"frames", required_argument, NULL, 'f'},
+        {"block-frames", required_argument, NULL, 'b'},
+        {"clients", required_argument, NULL, 'c'},
+        {"devices", required_argument, NULL, 'd'},
+        {"in", required_argument, NULL, 'i'},
+        {"help", no_argument, NULL, 'h'},
+        {0, 0, 0, 0}
+    };
+
+    memset(&opts, 0, sizeof(opts));
+    opts.frames = BENCH_DEFAULT_FRAMES;
+    opts.block_frames = BENCH_DEFAULT_BLOCK_FRAMES;
+    opts.clients = BENCH_DEFAULT_CLIENTS;
+    opts.devices = BENCH_DEFAULT_DEVICES;
+
+    if (argc < 2 || argv[1][0] == '-') {
+        usage((argc >= 2 && strcmp(argv[1], "--help") == 0) ? stdout : stderr, argv[0]);
+        return (argc >= 2 && strcmp(argv[1], "--help") == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    for (idx = 0U; idx < sizeof(k_modes) / sizeof(k_modes[0]); ++idx) {
+        if (strcmp(argv[1], k_modes[idx].name) == 0) {
+            mode = &k_modes[idx];
+        }
+    }
+    if (mode == NULL) {
+        fprintf(stderr, "Unknown mode: %s\n", argv[1]);
+        usage(stderr, argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    optind = 2;
+    while (1) {
+        int opt = getopt_long(argc, argv, "f:b:c:d:i:h", long_options, NULL);
+        if (opt == -1) {
+            break;
+        }
+
+        switch (opt) {
+            case 'f':
+                if (parse_u64(optarg, &opts.frames) != 0 || opts.frames == 0U) {
+                    fprintf(stderr, "Invalid --frames: %s\n", optarg);
+                    return EXIT_FAILURE;
+                }
+                opts.frames_set = true;
+                break;
+            case 'b':
+                if (parse_u32(optarg, &opts.block_frames) != 0 || opts.block_frames == 0U) {
+                    fprintf(stderr, "Invalid --block-frames: %s\n", optarg);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'c':
+                if (parse_u32(optarg, &opts.clients) != 0 || opts.clients == 0U || opts.clients > 63U) {
+                    fprintf(stderr, "Invalid --clients (1..63): %s\n", optarg);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'd':
+                if (parse_u32(optarg, &opts.devices) != 0 || opts.devices == 0U ||
+                    opts.devices > BENCH_MAX_DEVICES) {
+                    fprintf(stderr, "Invalid --devices (1..%u): %s\n", BENCH_MAX_DEVICES, optarg);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'i':
+                opts.in_path = optarg;
+                break;
+            case 'h':
+                usage(stdout, argv[0]);
+                return EXIT_SUCCESS;
+            default:
+                usage(stderr, argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+
+    return (mode->run(&opts) == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
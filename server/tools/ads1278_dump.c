@@ -29,51 +29,207 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include "acq.h"
 #include "ads1278.h"
+#include "capture_file.h"
+#include "capture_segments.h"
+#include "capture_writer.h"
+#include "chan_stats.h"
+#include "clock_model.h"
+#include "decim.h"
+#include "proto.h"
+#include "shm_ring.h"
+#include "trigger.h"
 
 #include <errno.h>
 #include <getopt.h>
 #include <inttypes.h>
 #include <limits.h>
+#include <signal.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
 typedef struct {
-    uint32_t gpio_number;
+    uint32_t gpio_number;       /* sysfs global number, or line offset on chip */
+    char chip[64];              /* empty = sysfs, else /dev/gpiochipN */
     bool set;
 } gpio_endpoint_t;
 
+enum {
+    OPT_BACKEND = 0x100,
+    OPT_SIM_RATE_HZ,
+    OPT_SIM_SIGNAL,
+    OPT_SIM_AMPLITUDE,
+    OPT_SIM_SIGNAL_HZ,
+    OPT_SIM_JITTER_NS,
+    OPT_SIM_XFER_DELAY_US,
+    OPT_SIM_XFER_DELAY_EVERY,
+    OPT_SIM_BUSY_WAIT,
+    OPT_RING_FRAMES,
+    OPT_OUT_BLOCK_KB,
+    OPT_OUT_PREALLOC_MB,
+    OPT_OUT_FSYNC,
+    OPT_OUT_IO_URING,
+    OPT_OUT_DIR,
+    OPT_SEGMENT_MB,
+    OPT_SEGMENT_S,
+    OPT_QUOTA_MB,
+    OPT_CHECKPOINT_MS,
+    OPT_OUT_CODEC,
+    OPT_OUT_FORMAT,
+    OPT_DECIM,
+    OPT_TRIGGER,
+    OPT_TRIGGER_GPIO,
+    OPT_STATS,
+    OPT_SUMMARY,
+    OPT_CALIB,
+    OPT_VREF,
+    OPT_RT_PRIORITY,
+    OPT_RT_CPUS,
+    OPT_MLOCK,
+    OPT_CHAIN,
+    OPT_SMOOTH_TSTAMPS,
+    OPT_SHM,
+    OPT_SHM_FRAMES
+};
+
+#define DUMP_DRAIN_BATCH_FRAMES 256U
+#define DUMP_DEFAULT_SEGMENT_MB 64U
+#define DUMP_DRAIN_WAIT_MS 100U
+
+/* Set by SIGINT/SIGTERM: stop acquiring, then finish the output as after --frames. */
+static volatile sig_atomic_t g_stop;
+
+/*
+ * Where drained frames go: optional decimation, channel statistics and
+ * triggering, then stdout and/or the capture file (EVENT messages back to
+ * back with a trigger).
+ */
+typedef struct {
+    capture_writer_t *writer;
+    capture_file_writer_t *cfile;
+    capture_seg_t *segs;
+    decim_t *decim;
+    ads1278_frame_t decim_out[DUMP_DRAIN_BATCH_FRAMES + 1U];
+    uint32_t channels;
+    chan_stats_t *chan_stats;
+    trigger_t *trigger;
+    const trigger_cfg_t *trigger_cfg;
+    proto_data_encoder_t event_enc;
+    uint8_t *event_msg;
+} dump_sink_t;
+
+static const char *const k_sim_signal_names[] = {
+    [ADS1278_SIM_SIGNAL_ZERO] = "zero",
+    [ADS1278_SIM_SIGNAL_RAMP] = "ramp",
+    [ADS1278_SIM_SIGNAL_SINE] = "sine",
+    [ADS1278_SIM_SIGNAL_SQUARE] = "square",
+    [ADS1278_SIM_SIGNAL_NOISE] = "noise"
+};
+
 static void usage(FILE *stream, const char *prog_name)
 {
     fprintf(stream,
         "Usage: %s [options]\n"
         "\n"
-        "Required:\n"
-        "  --drdy <gpio_number>                  DRDY input GPIO number\n"
+        "Required (spidev backend):\n"
+        "  --drdy <endpoint>                    DRDY input GPIO (see endpoints below)\n"
         "\n"
         "Optional:\n"
+        "  --backend <spidev|sim>               Frame source (default: spidev)\n"
         "  --spidev <path>                      SPI device (default: %s)\n"
         "  --sclk-hz <hz>                       SPI clock (default: 1000000)\n"
         "  --spi-mode <0..3>                    SPI mode (default: 0)\n"
-        "  --sync <gpio_number>                  SYNC output GPIO number\n"
+        "  --chain <n>                          Daisy-chained ADS1278s on one DOUT (default: 1, max: %u)\n"
+        "  --sync <endpoint>                    SYNC output GPIO\n"
         "  --no-sync                            Disable SYNC pulse\n"
         "  --settle-frames <n>                  Discard N frames after SYNC pulse\n"
-        "  --drdy-timeout-ms <ms>               DRDY wait timeout (default: %u)\n"
-        "  --frames <n>                         Frames to capture (default: 1000)\n"
+        "  --drdy-timeout-ms <ms>               DRDY wait timeout, 0 = none (default: %u)\n"
+        "  --smooth-tstamps                     Stamp frames from the fitted conversion clock (no wakeup\n"
+        "                                       jitter), so v2 p24/delta chunks fit base + rate\n"
+        "  --frames <n>                         Frames to capture, 0 = until SIGINT/SIGTERM\n"
+        "                                       (default: 1000)\n"
         "  --out <path>                         Write binary capture records\n"
         "  --print                              Pretty-print each frame\n"
         "  --hex <n>                            Hex dump first N raw SPI frames\n"
-        "  --help                               Show this help text\n"
-        "\n"
-        "Notes:\n"
-        "  - This build uses sysfs GPIO only.\n"
-        "  - Pass global GPIO numbers (e.g. 968, 969 from /sys/kernel/debug/gpio).\n",
+        "  --ring-frames <n>                    Acquisition ring size, power of two (default: %u)\n"
+        "  --decim <spec>                       Decimate before output, e.g. cic=64 or cic=16,fir=4\n"
+        "                                       (keys cic, order, fir, taps, pass, mask); repeat with\n"
+        "                                       disjoint masks and the same total factor for per-group\n"
+        "                                       filters; only the masked channels are kept\n"
+        "  --trigger <spec>                     Keep only triggered windows, e.g.\n"
+        "                                       pre=1000,post=4000,ch=2,rise=100000,hyst=500 (keys pre,\n"
+        "                                       post, holdoff, ch, rise, fall, slope, outside, inside, hyst);\n"
+        "                                       --out then holds EVENT messages (docs/ads1278_output.md)\n"
+        "  --trigger-gpio <endpoint>            External trigger on falling edges of this input GPIO\n"
+        "  --stats                              Print per-stage latency (p50/p99/p99.9/max) and counters\n"
+        "  --summary                            Print per-channel min/max/mean/RMS/stddev at exit\n"
+        "  --calib <file>                       Summary in volts from a per-channel gain/offset table\n"
+        "                                       (lines: channel gain offset)\n"
+        "  --vref <volts>                       Summary in volts with this reference (default: %.1f)\n"
+        "  --rt-priority <1..99>                Run the acquisition thread SCHED_FIFO at this priority\n"
+        "  --rt-cpus <list>                     Pin the acquisition thread, e.g. 1 or 0,2-3\n"
+        "  --mlock                              Lock and prefault all memory (mlockall)\n"
+        "  --shm <name>                         Also publish acquired frames to POSIX shm object /name\n"
+        "  --shm-frames <n>                     Shared ring size, power of two (default: %u)\n"
+        "  --help                               Show this help text\n",
         prog_name,
         ADS1278_DEFAULT_SPIDEV,
-        ADS1278_DEFAULT_DRDY_TIMEOUT_MS);
+        (unsigned)ADS1278_MAX_CHAIN,
+        ADS1278_DEFAULT_DRDY_TIMEOUT_MS,
+        ACQ_RING_DEFAULT_CAPACITY,
+        CHAN_CALIB_DEFAULT_VREF,
+        SHM_RING_DEFAULT_FRAMES);
+    fprintf(stream,
+        "\n"
+        "Capture file (--out):\n"
+        "  --out-block-kb <kb>                  Writer block size, multiple of 4 (default: %u)\n"
+        "  --out-prealloc-mb <mb>               Preallocate the file with fallocate (default: off)\n"
+        "  --out-fsync <none|close|block|MS>    fsync policy; a number fsyncs at most every\n"
+        "                                       MS milliseconds (default: none)\n"
+        "  --out-io-uring                       Submit queued blocks through io_uring when the\n"
+        "                                       kernel supports it (falls back to pwrite)\n"
+        "  --out-format <v1|v2>                 v2: header, chunks and time index;\n"
+        "                                       v1: bare 48-byte records (default: v2)\n"
+        "  --out-codec <none|delta>             v2 chunk encoding; delta is lossless\n"
+        "                                       delta/zigzag/bit-packing (default: none;\n"
+        "                                       packed 24-bit samples with --chain > 1)\n"
+        "\n"
+        "Segmented recording (--out-dir, v2 files; --out-* options apply per segment):\n"
+        "  --out-dir <dir>                      Record rotating segments DIR/capture-NNNNNN.bin\n"
+        "                                       (.part while open) instead of --out\n"
+        "  --segment-mb <mb>                    Rotate at this size (default: %u, 0 = no limit)\n"
+        "  --segment-s <s>                      Rotate when a segment spans this long (default: off)\n"
+        "  --quota-mb <mb>                      Delete the oldest segments to stay under this\n"
+        "                                       (at least 3 segments; default: off)\n"
+        "  --checkpoint-ms <ms>                 Write out and fdatasync this often (default: %u)\n"
+        "\n"
+        "Simulator (--backend sim):\n"
+        "  --sim-rate-hz <hz>                   Synthetic DRDY rate, 0 = free-run (default: %u)\n"
+        "  --sim-signal <name>                  zero|ramp|sine|square|noise (default: ramp)\n"
+        "  --sim-amplitude <code>               Peak code (default: half scale)\n"
+        "  --sim-signal-hz <hz>                 Sine/square frequency (default: rate/100)\n"
+        "  --sim-jitter-ns <ns>                 +/- DRDY edge jitter (default: 0)\n"
+        "  --sim-xfer-delay-us <us>             Injected transfer delay (default: 0)\n"
+        "  --sim-xfer-delay-every <n>           Inject the delay every N transfers\n"
+        "  --sim-busy-wait                      Spin for DRDY edges instead of sleeping\n"
+        "\n"
+        "GPIO endpoints:\n"
+        "  N | sysfs:N                          sysfs global GPIO number (e.g. 968)\n"
+        "  gpiochipK:N | /dev/gpiochipK:N       character device line offset N; kernel\n"
+        "                                       edge timestamps and missed-edge counting\n"
+        "\n"
+        "Notes:\n"
+        "  - The sim backend needs no --drdy/--sync; SYNC restarts its conversion clock.\n"
+        "  - With --backend sim, a gpiochip --drdy supplies real edges (e.g. gpio-sim).\n",
+        CAPTURE_WRITER_DEFAULT_BLOCK_BYTES / 1024U,
+        DUMP_DEFAULT_SEGMENT_MB,
+        CAPTURE_SEG_DEFAULT_CHECKPOINT_MS,
+        ADS1278_SIM_DEFAULT_RATE_HZ);
 }
 
 static int parse_u32(const char *text, uint32_t *out_value)
@@ -106,110 +262,377 @@ static int parse_u64(const char *text, uint64_t *out_value)
     return 0;
 }
 
+static int parse_double(const char *text, double *out_value)
+{
+    char *end = NULL;
+    double value;
+
+    errno = 0;
+    value = strtod(text, &end);
+    if (errno != 0 || end == text || *end != '\0' || value < 0.0) {
+        return -1;
+    }
+
+    *out_value = value;
+    return 0;
+}
+
+static int parse_backend(const char *text, ads1278_backend_id_t *out_backend)
+{
+    if (strcmp(text, "spidev") == 0) {
+        *out_backend = ADS1278_BACKEND_SPIDEV;
+        return 0;
+    }
+    if (strcmp(text, "sim") == 0) {
+        *out_backend = ADS1278_BACKEND_SIM;
+        return 0;
+    }
+    return -1;
+}
+
+static int parse_fsync_policy(const char *text, capture_writer_cfg_t *out_cfg)
+{
+    if (strcmp(text, "none") == 0) {
+        out_cfg->fsync_policy = CAPTURE_FSYNC_NONE;
+        return 0;
+    }
+    if (strcmp(text, "close") == 0) {
+        out_cfg->fsync_policy = CAPTURE_FSYNC_CLOSE;
+        return 0;
+    }
+    if (strcmp(text, "block") == 0) {
+        out_cfg->fsync_policy = CAPTURE_FSYNC_BLOCK;
+        return 0;
+    }
+    if (parse_u32(text, &out_cfg->fsync_interval_ms) == 0) {
+        out_cfg->fsync_policy = CAPTURE_FSYNC_INTERVAL;
+        return 0;
+    }
+    return -1;
+}
+
+static int parse_sim_signal(const char *text, ads1278_sim_signal_t *out_signal)
+{
+    size_t idx;
+
+    for (idx = 0; idx < sizeof(k_sim_signal_names) / sizeof(k_sim_signal_names[0]); ++idx) {
+        if (strcmp(text, k_sim_signal_names[idx]) == 0) {
+            *out_signal = (ads1278_sim_signal_t)idx;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+static void on_signal(int signo)
+{
+    (void)signo;
+    g_stop = 1;
+}
+
+/* The first SIGINT/SIGTERM ends the capture cleanly; a second one kills as before. */
+static int install_signal_handlers(void)
+{
+    struct sigaction sa;
+
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = on_signal;
+    sa.sa_flags = SA_RESETHAND;
+    sigemptyset(&sa.sa_mask);
+    if (sigaction(SIGINT, &sa, NULL) != 0 || sigaction(SIGTERM, &sa, NULL) != 0) {
+        return -1;
+    }
+    return 0;
+}
+
+static double monotonic_seconds(void)
+{
+    struct timespec ts = {0, 0};
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
 static int parse_gpio_endpoint(const char *text, gpio_endpoint_t *out_endpoint)
 {
-    const char *sep = strchr(text, ':');
+    const char *sep = strrchr(text, ':');
+    uint32_t gpio_number = 0U;
+    size_t prefix_len;
 
     if (sep == NULL) {
-        uint32_t gpio_number;
-
         if (parse_u32(text, &gpio_number) != 0) {
             return -1;
         }
 
         out_endpoint->gpio_number = gpio_number;
+        out_endpoint->chip[0] = '\0';
         out_endpoint->set = true;
         return 0;
     }
 
-    if (strncmp(text, "sysfs:", 6) != 0) {
+    if (parse_u32(sep + 1, &gpio_number) != 0) {
         return -1;
     }
 
-    {
-        uint32_t gpio_number = 0U;
-
-        if (parse_u32(sep + 1, &gpio_number) != 0) {
+    prefix_len = (size_t)(sep - text);
+    if (prefix_len == 5U && strncmp(text, "sysfs", 5U) == 0) {
+        out_endpoint->chip[0] = '\0';
+    } else if (strncmp(text, "gpiochip", 8U) == 0) {
+        if (prefix_len + 5U >= sizeof(out_endpoint->chip)) {
             return -1;
         }
-
-        out_endpoint->gpio_number = gpio_number;
-        out_endpoint->set = true;
-        return 0;
+        snprintf(out_endpoint->chip, sizeof(out_endpoint->chip), "/dev/%.*s", (int)prefix_len, text);
+    } else if (text[0] == '/') {
+        if (prefix_len >= sizeof(out_endpoint->chip)) {
+            return -1;
+        }
+        snprintf(out_endpoint->chip, sizeof(out_endpoint->chip), "%.*s", (int)prefix_len, text);
+    } else {
+        return -1;
     }
+
+    out_endpoint->gpio_number = gpio_number;
+    out_endpoint->set = true;
+    return 0;
+}
+
+static const char *gpio_endpoint_chip(const gpio_endpoint_t *endpoint)
+{
+    return (endpoint->set && endpoint->chip[0] != '\0') ? endpoint->chip : NULL;
 }
 
 static void free_gpio_endpoint(gpio_endpoint_t *endpoint)
 {
     endpoint->gpio_number = 0U;
+    endpoint->chip[0] = '\0';
     endpoint->set = false;
 }
 
-static int write_u64_le(FILE *out_file, uint64_t value)
+static void print_frame(const ads1278_frame_t *frame, uint32_t channels)
 {
-    uint8_t bytes[8];
-    size_t idx;
+    uint32_t idx;
 
-    for (idx = 0; idx < 8U; ++idx) {
-        bytes[idx] = (uint8_t)((value >> (idx * 8U)) & 0xFFU);
+    printf("seq=%" PRIu64 " tstamp_ns=%" PRIu64 " ch=[",
+        frame->seq, frame->tstamp_ns);
+    for (idx = 0; idx < channels; ++idx) {
+        printf("%" PRId32 "%s", frame->ch[idx], (idx + 1U == channels) ? "" : ", ");
     }
-
-    return (fwrite(bytes, 1U, sizeof(bytes), out_file) == sizeof(bytes)) ? 0 : -1;
+    printf("]\n");
 }
 
-static int write_i32_le(FILE *out_file, int32_t value)
+static void print_raw_hex(const uint8_t *raw, size_t len, uint64_t seq)
 {
-    uint32_t cast_value = (uint32_t)value;
-    uint8_t bytes[4];
     size_t idx;
 
-    for (idx = 0; idx < 4U; ++idx) {
-        bytes[idx] = (uint8_t)((cast_value >> (idx * 8U)) & 0xFFU);
+    printf("raw seq=%" PRIu64 ":", seq);
+    for (idx = 0; idx < len; ++idx) {
+        printf(" %02X", raw[idx]);
+    }
+    printf("\n");
+}
+
+static int emit_event(dump_sink_t *sink, const trigger_event_t *event, bool pretty_print)
+{
+    proto_event_t ev = {0};
+    size_t len;
+
+    ev.event_id = event->id;
+    ev.trigger_seq = event->trigger_seq;
+    ev.trigger_tstamp_ns = event->trigger_tstamp_ns;
+    ev.pre_frames = event->pre_frames;
+    ev.condition = PROTO_EVENT_EXTERNAL;
+    ev.channel = PROTO_EVENT_EXTERNAL;
+    if (event->condition != TRIGGER_EXTERNAL) {
+        ev.condition = (uint16_t)event->condition;
+        ev.channel = (uint16_t)sink->trigger_cfg->cond[event->condition].channel;
     }
 
-    return (fwrite(bytes, 1U, sizeof(bytes), out_file) == sizeof(bytes)) ? 0 : -1;
+    if (pretty_print) {
+        uint32_t idx;
+
+        printf("event id=%" PRIu64 " trigger_seq=%" PRIu64 " condition=%s%" PRIu32 " pre=%" PRIu32
+            " frames=%" PRIu32 "\n", event->id, event->trigger_seq,
+            (event->condition == TRIGGER_EXTERNAL) ? "external/" : "", event->condition,
+            event->pre_frames, event->frame_count);
+        for (idx = 0U; idx < event->frame_count; ++idx) {
+            print_frame(&event->frames[idx], sink->channels);
+        }
+    }
+    if (sink->writer == NULL) {
+        return 0;
+    }
+    len = proto_encode_event(sink->event_msg, (uint32_t)event->id, &ev, &sink->event_enc, event->frames,
+                             event->frame_count);
+    if (ev.frame_count != event->frame_count) {
+        fprintf(stderr, "warning: event %" PRIu64 " cut to %" PRIu32 " of %" PRIu32
+            " frame(s) at a timestamp step.\n", event->id, ev.frame_count, event->frame_count);
+    }
+    if (capture_writer_write(sink->writer, sink->event_msg, len) != 0) {
+        perror("capture_writer_write");
+        return -1;
+    }
+    return 0;
 }
 
-static int write_frame_record(FILE *out_file, const ads1278_frame_t *frame)
+static int trigger_frames(dump_sink_t *sink, const ads1278_frame_t *frames, size_t n, bool pretty_print)
 {
-    uint32_t idx;
+    while (n != 0U) {
+        trigger_event_t event;
+        size_t used = trigger_process(sink->trigger, frames, n, &event);
 
-    if (write_u64_le(out_file, frame->seq) != 0) {
-        return -1;
+        if (event.frame_count != 0U && emit_event(sink, &event, pretty_print) != 0) {
+            return -1;
+        }
+        frames += used;
+        n -= used;
     }
-    if (write_u64_le(out_file, frame->tstamp_ns) != 0) {
-        return -1;
+    return 0;
+}
+
+static int consume_frames(dump_sink_t *sink, const ads1278_frame_t *frames, size_t n, bool pretty_print)
+{
+    if (sink->decim != NULL) {
+        n = decim_process(sink->decim, frames, n, sink->decim_out);
+        frames = sink->decim_out;
+    }
+    if (sink->chan_stats != NULL) {
+        chan_stats_update(sink->chan_stats, frames, n);
+    }
+    if (sink->trigger != NULL) {
+        return trigger_frames(sink, frames, n, pretty_print);
     }
-    for (idx = 0; idx < ADS1278_CHANNEL_COUNT; ++idx) {
-        if (write_i32_le(out_file, frame->ch[idx]) != 0) {
+
+    if (pretty_print) {
+        size_t idx;
+
+        for (idx = 0U; idx < n; ++idx) {
+            print_frame(&frames[idx], sink->channels);
+        }
+    }
+
+    if (sink->segs != NULL) {
+        if (capture_seg_append(sink->segs, frames, n) != 0) {
+            perror("capture_seg_append");
             return -1;
         }
+    } else if (sink->cfile != NULL) {
+        if (capture_file_append(sink->cfile, frames, n) != 0) {
+            perror("capture_file_append");
+            return -1;
+        }
+    } else if (sink->writer != NULL && capture_writer_append_frames(sink->writer, frames, n) != 0) {
+        perror("capture_writer_append_frames");
+        return -1;
     }
 
     return 0;
 }
 
-static void print_frame(const ads1278_frame_t *frame)
+static void report_channel_summary(chan_stats_t *st, const chan_calib_t *calib)
 {
-    uint32_t idx;
+    chan_stats_summary_t summary;
+    uint32_t c;
 
-    printf("seq=%" PRIu64 " tstamp_ns=%" PRIu64 " ch=[",
-        frame->seq, frame->tstamp_ns);
-    for (idx = 0; idx < ADS1278_CHANNEL_COUNT; ++idx) {
-        printf("%" PRId32 "%s", frame->ch[idx], (idx + 1U == ADS1278_CHANNEL_COUNT) ? "" : ", ");
+    chan_stats_total(st, &summary);
+    if (calib != NULL) {
+        chan_calib_summary(calib, &summary);
+    }
+    fprintf(stderr, "Channel summary (%s) over %" PRIu64 " frame(s), seq %" PRIu64 "..%" PRIu64 ":\n",
+        summary.volts ? "volts" : "codes", summary.frames, summary.first_seq, summary.last_seq);
+    fprintf(stderr, "  %-5s %14s %14s %14s %14s %14s\n", "ch", "min", "max", "mean", "rms", "stddev");
+    for (c = 0U; c < summary.channel_count && summary.frames != 0U; ++c) {
+        const chan_stats_channel_t *ch = &summary.ch[c];
+
+        if (summary.volts) {
+            fprintf(stderr, "  ch%-3u %14.9f %14.9f %14.9f %14.9f %14.9f\n",
+                c + 1U, ch->min, ch->max, ch->mean, ch->rms, ch->stddev);
+        } else {
+            fprintf(stderr, "  ch%-3u %14.0f %14.0f %14.3f %14.3f %14.3f\n",
+                c + 1U, ch->min, ch->max, ch->mean, ch->rms, ch->stddev);
+        }
     }
-    printf("]\n");
 }
 
-static void print_raw_hex(const uint8_t raw[ADS1278_TDM_FRAME_BYTES], uint64_t seq)
+static void report_segment_stats(const char *dir, const capture_seg_stats_t *stats)
 {
-    uint32_t idx;
+    double seconds = (double)stats->elapsed_ns * 1e-9;
 
-    printf("raw seq=%" PRIu64 ":", seq);
-    for (idx = 0; idx < ADS1278_TDM_FRAME_BYTES; ++idx) {
-        printf(" %02X", raw[idx]);
+    fprintf(stderr, "Segments: %" PRIu64 " finished in %s, %.1f MB at %.1f MB/s, %" PRIu64 " checkpoint(s); %"
+        PRIu64 " kept (%.1f MB), %" PRIu64 " deleted for the quota (%.1f MB)",
+        stats->segments, dir, (double)stats->bytes_written / 1e6,
+        (seconds > 0.0) ? (double)stats->bytes_written / 1e6 / seconds : 0.0, stats->checkpoints,
+        stats->kept_segments, (double)stats->kept_bytes / 1e6, stats->deleted, (double)stats->deleted_bytes / 1e6);
+    if (stats->recovered != 0U) {
+        fprintf(stderr, ", %" PRIu64 " recovered from an earlier run", stats->recovered);
+    }
+    fprintf(stderr, ".\n");
+    fprintf(stderr, "Segments: worst append stall %.3f ms, %" PRIu64 " block wait(s), %" PRIu64 " rotation wait(s); "
+        "slowest finish %.3f ms, worst write %.3f ms, worst fsync %.3f ms.\n",
+        (double)stats->append_ns_max / 1e6, stats->producer_stalls, stats->rotate_waits,
+        (double)stats->finish_ns_max / 1e6, (double)stats->write_ns_max / 1e6, (double)stats->fsync_ns_max / 1e6);
+    if (stats->missed_frames != 0U) {
+        fprintf(stderr, "warning: %" PRIu64 " frame(s) dropped before the recorder in %" PRIu64 " seq gap(s).\n",
+            stats->missed_frames, stats->gap_count);
+    }
+}
+
+static void report_writer_stats(const capture_writer_stats_t *stats)
+{
+    double seconds = (double)stats->elapsed_ns * 1e-9;
+
+    fprintf(stderr, "Capture file: %.1f MB in %" PRIu64 " block(s), %.1f MB/s, %" PRIu64 " write call(s)%s, "
+        "worst write %.3f ms",
+        (double)stats->bytes_written / 1e6, stats->blocks_written,
+        (seconds > 0.0) ? (double)stats->bytes_written / 1e6 / seconds : 0.0, stats->write_calls,
+        stats->io_uring ? (stats->io_uring_fixed ? " via io_uring (registered)" : " via io_uring") : "",
+        (double)stats->write_ns_max / 1e6);
+    if (stats->fsyncs != 0U) {
+        fprintf(stderr, ", %" PRIu64 " fsync(s) worst %.3f ms", stats->fsyncs, (double)stats->fsync_ns_max / 1e6);
+    }
+    fprintf(stderr, ".\n");
+    if (stats->producer_stalls != 0U) {
+        fprintf(stderr, "warning: capture writer stalled the consumer %" PRIu64 " time(s), worst %.3f ms.\n",
+            stats->producer_stalls, (double)stats->producer_stall_ns_max / 1e6);
+    }
+}
+
+static void report_stage(const char *name, const lat_hist_t *hist)
+{
+    fprintf(stderr, "  %-12s %12" PRIu64 " %10.1f %10.1f %10.1f %10.1f\n", name, hist->count,
+        (double)lat_hist_quantile(hist, 0.5) / 1000.0, (double)lat_hist_quantile(hist, 0.99) / 1000.0,
+        (double)lat_hist_quantile(hist, 0.999) / 1000.0, (double)hist->max_ns / 1000.0);
+}
+
+static void report_pipeline_stats(const ads1278_stats_t *hal, const acq_stats_t *acq)
+{
+    fprintf(stderr, "Stage latency (us):\n  %-12s %12s %10s %10s %10s %10s\n",
+        "stage", "n", "p50", "p99", "p99.9", "max");
+    report_stage("drdy-wakeup", &hal->drdy_wakeup);
+    report_stage("spi-xfer", &hal->spi_xfer);
+    report_stage("parse", &hal->parse);
+    if (acq != NULL) {
+        report_stage("drdy-frame", &acq->latency);
+        report_stage("ring-dwell", &acq->ring_dwell);
+    }
+    fprintf(stderr, "Counters: frames %" PRIu64 ", DRDY timeouts %" PRIu64 ", missed DRDY %" PRIu64
+        ", missed conversions %" PRIu64 " in %" PRIu64 " gap(s) (longest %" PRIu64 ", %" PRIu64 " ambiguous)"
+        ", overlong transfers %" PRIu64, hal->frames, hal->drdy_timeouts, hal->missed_drdy,
+        hal->missed_conversions, hal->gap_events, hal->longest_gap, hal->ambiguous_intervals, hal->overlong_xfers);
+    if (acq != NULL) {
+        fprintf(stderr, ", ring overflows %" PRIu64 ", ring high-water %" PRIu64 "/%" PRIu64,
+            acq->ring.overflows, acq->ring.high_water, acq->ring.capacity);
+    }
+    fprintf(stderr, ".\n");
+    if (hal->drdy_period_ns != 0.0) {
+        fprintf(stderr, "DRDY period model: %.1f ns (%.1f Hz).\n", hal->drdy_period_ns, 1e9 / hal->drdy_period_ns);
+    } else {
+        fprintf(stderr, "DRDY period model: not locked (free-running source or timestamps too jittery).\n");
+    }
+    if (hal->drdy_period_ns != 0.0) {
+        fprintf(stderr, "DRDY clock model: jitter %.1f ns RMS (max %" PRIu64 " ns), drift %+.3f ppm, %" PRIu64
+            " outlier(s), %" PRIu64 " relock(s).\n", hal->tstamp_jitter_ns, hal->tstamp_jitter_max_ns,
+            hal->clock_drift_ppm, hal->clock_outliers, hal->clock_relocks);
     }
-    printf("\n");
 }
 
 int main(int argc, char **argv)
@@ -217,17 +640,68 @@ int main(int argc, char **argv)
     const char *spidev_path = ADS1278_DEFAULT_SPIDEV;
     uint32_t sclk_hz = 1000000U;
     uint32_t spi_mode = 0U;
+    uint32_t chain_length = 1U;
     uint32_t settle_frames = 0U;
     uint32_t drdy_timeout_ms = ADS1278_DEFAULT_DRDY_TIMEOUT_MS;
     uint32_t hex_frames = 0U;
+    uint32_t ring_frames = ACQ_RING_DEFAULT_CAPACITY;
     uint64_t frames_to_capture = 1000U;
     bool pretty_print = false;
     bool use_sync = true;
+    bool smooth_tstamps = false;
     const char *out_path = NULL;
-    FILE *out_file = NULL;
+    capture_writer_cfg_t writer_cfg = {0};
+    capture_writer_t *writer = NULL;
+    capture_writer_stats_t writer_stats = {0};
+    uint32_t out_block_kb = 0U;
+    uint32_t out_prealloc_mb = 0U;
+    bool out_v2 = true;
+    uint16_t out_encoding = PROTO_DATA_ENC_RECORD48;
+    capture_file_writer_t *cfile = NULL;
+    capture_file_info_t cfile_info = {0};
+    capture_file_cfg_t file_cfg = {0};
+    const char *out_dir = NULL;
+    capture_seg_cfg_t seg_cfg = {0};
+    capture_seg_t *segs = NULL;
+    capture_seg_stats_t seg_stats = {0};
+    uint32_t segment_mb = DUMP_DEFAULT_SEGMENT_MB;
+    uint32_t segment_s = 0U;
+    uint32_t quota_mb = 0U;
+    bool until_signal = false;
+    static dump_sink_t sink;
+    decim_cfg_t decim_cfg[DECIM_MAX_GROUPS] = {{0}};
+    size_t decim_groups = 0U;
+    decim_stats_t decim_stats = {0};
+    trigger_cfg_t trigger_cfg = {0};
+    bool use_trigger = false;
+    gpio_endpoint_t trigger_gpio = {0};
+    trigger_stats_t trigger_stats = {0};
     gpio_endpoint_t drdy = {0};
     gpio_endpoint_t sync = {0};
+    ads1278_backend_id_t backend = ADS1278_BACKEND_SPIDEV;
+    ads1278_sim_cfg_t sim = {0};
     uint64_t captured = 0U;
+    double t_start = 0.0;
+    double elapsed_s = 0.0;
+    acq_t *acq = NULL;
+    acq_stats_t acq_stats = {0};
+    uint64_t missed_drdy = 0U;
+    uint64_t overlong_xfers = 0U;
+    bool print_stats = false;
+    bool print_summary = false;
+    const char *calib_path = NULL;
+    double vref = CHAN_CALIB_DEFAULT_VREF;
+    bool vref_set = false;
+    chan_calib_t calib;
+    ads1278_stats_t hal_stats = {0};
+    uint32_t rt_priority = 0U;
+    rt_cfg_t rt_cfg = {0};
+    rt_status_t rt_status;
+    char text[512];
+    bool hal_open = false;
+    shm_ring_cfg_t shm_cfg = {0};
+    uint32_t shm_frames = 0U;
+    shm_ring_writer_t *shm = NULL;
     int exit_code = EXIT_FAILURE;
 
     static const struct option long_options[] = {
@@ -244,9 +718,47 @@ int main(int argc, char **argv)
         {"print", no_argument, NULL, 'p'},
         {"hex", required_argument, NULL, 'x'},
         {"help", no_argument, NULL, 'h'},
+        {"backend", required_argument, NULL, OPT_BACKEND},
+        {"sim-rate-hz", required_argument, NULL, OPT_SIM_RATE_HZ},
+        {"sim-signal", required_argument, NULL, OPT_SIM_SIGNAL},
+        {"sim-amplitude", required_argument, NULL, OPT_SIM_AMPLITUDE},
+        {"sim-signal-hz", required_argument, NULL, OPT_SIM_SIGNAL_HZ},
+        {"sim-jitter-ns", required_argument, NULL, OPT_SIM_JITTER_NS},
+        {"sim-xfer-delay-us", required_argument, NULL, OPT_SIM_XFER_DELAY_US},
+        {"sim-xfer-delay-every", required_argument, NULL, OPT_SIM_XFER_DELAY_EVERY},
+        {"sim-busy-wait", no_argument, NULL, OPT_SIM_BUSY_WAIT},
+        {"ring-frames", required_argument, NULL, OPT_RING_FRAMES},
+        {"out-block-kb", required_argument, NULL, OPT_OUT_BLOCK_KB},
+        {"out-prealloc-mb", required_argument, NULL, OPT_OUT_PREALLOC_MB},
+        {"out-fsync", required_argument, NULL, OPT_OUT_FSYNC},
+        {"out-io-uring", no_argument, NULL, OPT_OUT_IO_URING},
+        {"out-dir", required_argument, NULL, OPT_OUT_DIR},
+        {"segment-mb", required_argument, NULL, OPT_SEGMENT_MB},
+        {"segment-s", required_argument, NULL, OPT_SEGMENT_S},
+        {"quota-mb", required_argument, NULL, OPT_QUOTA_MB},
+        {"checkpoint-ms", required_argument, NULL, OPT_CHECKPOINT_MS},
+        {"out-codec", required_argument, NULL, OPT_OUT_CODEC},
+        {"out-format", required_argument, NULL, OPT_OUT_FORMAT},
+        {"decim", required_argument, NULL, OPT_DECIM},
+        {"trigger", required_argument, NULL, OPT_TRIGGER},
+        {"trigger-gpio", required_argument, NULL, OPT_TRIGGER_GPIO},
+        {"stats", no_argument, NULL, OPT_STATS},
+        {"summary", no_argument, NULL, OPT_SUMMARY},
+        {"calib", required_argument, NULL, OPT_CALIB},
+        {"vref", required_argument, NULL, OPT_VREF},
+        {"rt-priority", required_argument, NULL, OPT_RT_PRIORITY},
+        {"rt-cpus", required_argument, NULL, OPT_RT_CPUS},
+        {"mlock", no_argument, NULL, OPT_MLOCK},
+        {"chain", required_argument, NULL, OPT_CHAIN},
+        {"smooth-tstamps", no_argument, NULL, OPT_SMOOTH_TSTAMPS},
+        {"shm", required_argument, NULL, OPT_SHM},
+        {"shm-frames", required_argument, NULL, OPT_SHM_FRAMES},
         {0, 0, 0, 0}
     };
 
+    sim.drdy_rate_hz = ADS1278_SIM_DEFAULT_RATE_HZ;
+    sim.signal = ADS1278_SIM_SIGNAL_RAMP;
+
     while (1) {
         int opt = getopt_long(argc, argv, "d:s:m:r:y:nt:w:f:o:px:h", long_options, NULL);
         if (opt == -1) {
@@ -297,12 +809,19 @@ int main(int argc, char **argv)
                     fprintf(stderr, "Invalid --drdy-timeout-ms: %s\n", optarg);
                     goto cleanup;
                 }
+                if (drdy_timeout_ms == 0U) {
+                    drdy_timeout_ms = ADS1278_NO_TIMEOUT;
+                }
                 break;
             case 'f':
-                if (parse_u64(optarg, &frames_to_capture) != 0 || frames_to_capture == 0U) {
+                if (parse_u64(optarg, &frames_to_capture) != 0) {
                     fprintf(stderr, "Invalid --frames: %s\n", optarg);
                     goto cleanup;
                 }
+                until_signal = (frames_to_capture == 0U);
+                if (until_signal) {
+                    frames_to_capture = UINT64_MAX;
+                }
                 break;
             case 'o':
                 out_path = optarg;
@@ -316,6 +835,203 @@ int main(int argc, char **argv)
                     goto cleanup;
                 }
                 break;
+            case OPT_BACKEND:
+                if (parse_backend(optarg, &backend) != 0) {
+                    fprintf(stderr, "Invalid --backend: %s\n", optarg);
+                    goto cleanup;
+                }
+                break;
+            case OPT_SIM_RATE_HZ:
+                if (parse_u32(optarg, &sim.drdy_rate_hz) != 0) {
+                    fprintf(stderr, "Invalid --sim-rate-hz: %s\n", optarg);
+                    goto cleanup;
+                }
+                break;
+            case OPT_SIM_SIGNAL:
+                if (parse_sim_signal(optarg, &sim.signal) != 0) {
+                    fprintf(stderr, "Invalid --sim-signal: %s\n", optarg);
+                    goto cleanup;
+                }
+                break;
+            case OPT_SIM_AMPLITUDE:
+                if (parse_u32(optarg, &sim.amplitude) != 0) {
+                    fprintf(stderr, "Invalid --sim-amplitude: %s\n", optarg);
+                    goto cleanup;
+                }
+                break;
+            case OPT_SIM_SIGNAL_HZ:
+                if (parse_double(optarg, &sim.signal_hz) != 0) {
+                    fprintf(stderr, "Invalid --sim-signal-hz: %s\n", optarg);
+                    goto cleanup;
+                }
+                break;
+            case OPT_SIM_JITTER_NS:
+                if (parse_u32(optarg, &sim.jitter_ns) != 0) {
+                    fprintf(stderr, "Invalid --sim-jitter-ns: %s\n", optarg);
+                    goto cleanup;
+                }
+                break;
+            case OPT_SIM_XFER_DELAY_US:
+                if (parse_u32(optarg, &sim.xfer_delay_us) != 0) {
+                    fprintf(stderr, "Invalid --sim-xfer-delay-us: %s\n", optarg);
+                    goto cleanup;
+                }
+                break;
+            case OPT_SIM_XFER_DELAY_EVERY:
+                if (parse_u32(optarg, &sim.xfer_delay_every) != 0) {
+                    fprintf(stderr, "Invalid --sim-xfer-delay-every: %s\n", optarg);
+                    goto cleanup;
+                }
+                break;
+            case OPT_SIM_BUSY_WAIT:
+                sim.busy_wait = true;
+                break;
+            case OPT_RING_FRAMES:
+                if (parse_u32(optarg, &ring_frames) != 0 || ring_frames == 0U ||
+                    (ring_frames & (ring_frames - 1U)) != 0U) {
+                    fprintf(stderr, "Invalid --ring-frames (power of two): %s\n", optarg);
+                    goto cleanup;
+                }
+                break;
+            case OPT_OUT_BLOCK_KB:
+                if (parse_u32(optarg, &out_block_kb) != 0 || out_block_kb == 0U || (out_block_kb % 4U) != 0U) {
+                    fprintf(stderr, "Invalid --out-block-kb (multiple of 4): %s\n", optarg);
+                    goto cleanup;
+                }
+                break;
+            case OPT_OUT_PREALLOC_MB:
+                if (parse_u32(optarg, &out_prealloc_mb) != 0) {
+                    fprintf(stderr, "Invalid --out-prealloc-mb: %s\n", optarg);
+                    goto cleanup;
+                }
+                break;
+            case OPT_OUT_FSYNC:
+                if (parse_fsync_policy(optarg, &writer_cfg) != 0) {
+                    fprintf(stderr, "Invalid --out-fsync: %s\n", optarg);
+                    goto cleanup;
+                }
+                break;
+            case OPT_OUT_IO_URING:
+                writer_cfg.io_uring = true;
+                break;
+            case OPT_OUT_DIR:
+                out_dir = optarg;
+                break;
+            case OPT_SEGMENT_MB:
+                if (parse_u32(optarg, &segment_mb) != 0) {
+                    fprintf(stderr, "Invalid --segment-mb: %s\n", optarg);
+                    goto cleanup;
+                }
+                break;
+            case OPT_SEGMENT_S:
+                if (parse_u32(optarg, &segment_s) != 0 || segment_s > UINT32_MAX / 1000U) {
+                    fprintf(stderr, "Invalid --segment-s: %s\n", optarg);
+                    goto cleanup;
+                }
+                break;
+            case OPT_QUOTA_MB:
+                if (parse_u32(optarg, &quota_mb) != 0) {
+                    fprintf(stderr, "Invalid --quota-mb: %s\n", optarg);
+                    goto cleanup;
+                }
+                break;
+            case OPT_CHECKPOINT_MS:
+                if (parse_u32(optarg, &seg_cfg.checkpoint_ms) != 0 || seg_cfg.checkpoint_ms == 0U) {
+                    fprintf(stderr, "Invalid --checkpoint-ms: %s\n", optarg);
+                    goto cleanup;
+                }
+                break;
+            case OPT_OUT_CODEC:
+                if (strcmp(optarg, "none") == 0) {
+                    out_encoding = PROTO_DATA_ENC_RECORD48;
+                } else if (strcmp(optarg, "delta") == 0) {
+                    out_encoding = PROTO_DATA_ENC_DELTA;
+                } else {
+                    fprintf(stderr, "Invalid --out-codec: %s\n", optarg);
+                    goto cleanup;
+                }
+                break;
+            case OPT_OUT_FORMAT:
+                if (strcmp(optarg, "v1") == 0 || strcmp(optarg, "v2") == 0) {
+                    out_v2 = (strcmp(optarg, "v2") == 0);
+                } else {
+                    fprintf(stderr, "Invalid --out-format: %s\n", optarg);
+                    goto cleanup;
+                }
+                break;
+            case OPT_DECIM:
+                if (decim_groups == DECIM_MAX_GROUPS || decim_parse_spec(optarg, &decim_cfg[decim_groups]) != 0) {
+                    fprintf(stderr, "Invalid --decim: %s\n", optarg);
+                    goto cleanup;
+                }
+                ++decim_groups;
+                break;
+            case OPT_TRIGGER:
+                if (trigger_parse_spec(optarg, &trigger_cfg) != 0) {
+                    fprintf(stderr, "Invalid --trigger: %s\n", optarg);
+                    goto cleanup;
+                }
+                use_trigger = true;
+                break;
+            case OPT_TRIGGER_GPIO:
+                if (parse_gpio_endpoint(optarg, &trigger_gpio) != 0) {
+                    fprintf(stderr, "Invalid --trigger-gpio: %s\n", optarg);
+                    goto cleanup;
+                }
+                break;
+            case OPT_RT_PRIORITY:
+                if (parse_u32(optarg, &rt_priority) != 0 || rt_priority < 1U || rt_priority > 99U) {
+                    fprintf(stderr, "Invalid --rt-priority (1..99): %s\n", optarg);
+                    goto cleanup;
+                }
+                break;
+            case OPT_RT_CPUS:
+                if (rt_parse_cpus(optarg, &rt_cfg.cpu_mask) != 0) {
+                    fprintf(stderr, "Invalid --rt-cpus: %s\n", optarg);
+                    goto cleanup;
+                }
+                break;
+            case OPT_CHAIN:
+                if (parse_u32(optarg, &chain_length) != 0 || chain_length < 1U ||
+                    chain_length > ADS1278_MAX_CHAIN) {
+                    fprintf(stderr, "Invalid --chain (1..%u): %s\n", (unsigned)ADS1278_MAX_CHAIN, optarg);
+                    goto cleanup;
+                }
+                break;
+            case OPT_STATS:
+                print_stats = true;
+                break;
+            case OPT_SUMMARY:
+                print_summary = true;
+                break;
+            case OPT_CALIB:
+                calib_path = optarg;
+                print_summary = true;
+                break;
+            case OPT_VREF:
+                if (parse_double(optarg, &vref) != 0 || !(vref > 0.0)) {
+                    fprintf(stderr, "Invalid --vref: %s\n", optarg);
+                    goto cleanup;
+                }
+                vref_set = true;
+                print_summary = true;
+                break;
+            case OPT_MLOCK:
+                rt_cfg.lock_memory = true;
+                break;
+            case OPT_SMOOTH_TSTAMPS:
+                smooth_tstamps = true;
+                break;
+            case OPT_SHM:
+                shm_cfg.name = optarg;
+                break;
+            case OPT_SHM_FRAMES:
+                if (parse_u32(optarg, &shm_frames) != 0 || shm_frames == 0U ||
+                    (shm_frames & (shm_frames - 1U)) != 0U) {
+                    fprintf(stderr, "Invalid --shm-frames (power of two): %s\n", optarg);
+                    goto cleanup;
+                }
+                break;
             case 'h':
                 usage(stdout, argv[0]);
                 exit_code = EXIT_SUCCESS;
@@ -326,97 +1042,435 @@ int main(int argc, char **argv)
         }
     }
 
-    if (!drdy.set) {
+    if (backend == ADS1278_BACKEND_SPIDEV && !drdy.set) {
         fprintf(stderr, "--drdy is required.\n");
         usage(stderr, argv[0]);
         goto cleanup;
     }
 
-    if (use_sync && !sync.set) {
+    if (backend == ADS1278_BACKEND_SPIDEV && use_sync && !sync.set) {
         fprintf(stderr, "--sync is required unless --no-sync is used.\n");
         goto cleanup;
     }
 
-    if (out_path != NULL) {
-        out_file = fopen(out_path, "wb");
-        if (out_file == NULL) {
-            perror("fopen(--out)");
+    if (!out_v2 && out_encoding != PROTO_DATA_ENC_RECORD48) {
+        fprintf(stderr, "--out-codec needs --out-format v2.\n");
+        goto cleanup;
+    }
+
+    if (chain_length > 1U && out_path != NULL && !out_v2) {
+        fprintf(stderr, "--chain needs --out-format v2 (v1 records hold 8 channels).\n");
+        goto cleanup;
+    }
+    if (trigger_gpio.set && !use_trigger) {
+        fprintf(stderr, "--trigger-gpio needs --trigger for the window, e.g. --trigger pre=1000,post=1000.\n");
+        goto cleanup;
+    }
+    if (use_trigger && trigger_cfg.cond_count == 0U && !trigger_gpio.set) {
+        fprintf(stderr, "--trigger needs a condition or --trigger-gpio.\n");
+        goto cleanup;
+    }
+    if (shm_cfg.name == NULL && shm_frames != 0U) {
+        fprintf(stderr, "--shm-frames needs --shm.\n");
+        goto cleanup;
+    }
+    if (out_dir != NULL && (out_path != NULL || use_trigger || !out_v2)) {
+        fprintf(stderr, "--out-dir records v2 frame segments; it cannot be combined with --out, --trigger or "
+            "--out-format v1.\n");
+        goto cleanup;
+    }
+    if (out_dir != NULL && segment_mb == 0U && segment_s == 0U) {
+        fprintf(stderr, "--out-dir needs --segment-mb or --segment-s.\n");
+        goto cleanup;
+    }
+    if (out_dir != NULL && quota_mb != 0U && (uint64_t)segment_mb * 3U > quota_mb) {
+        fprintf(stderr, "--quota-mb must hold at least 3 segments of --segment-mb.\n");
+        goto cleanup;
+    }
+    if ((out_path != NULL || out_dir != NULL) && out_v2 &&
+        (strlen(drdy.chip) >= CAPTURE_FILE_NAME_BYTES ||
+         (use_sync && strlen(sync.chip) >= CAPTURE_FILE_NAME_BYTES))) {
+        fprintf(stderr, "The v2 capture header holds gpiochip paths of up to %u bytes; use a shorter --drdy/--sync "
+            "path (e.g. gpiochipN:line).\n", CAPTURE_FILE_NAME_BYTES - 1U);
+        goto cleanup;
+    }
+    if (use_trigger && out_path != NULL && !out_v2) {
+        fprintf(stderr, "--trigger writes EVENT messages; it cannot be combined with --out-format v1.\n");
+        goto cleanup;
+    }
+    sink.channels = chain_length * ADS1278_CHANNEL_COUNT;
+    if (decim_groups != 0U) {
+        if (decim_create(&sink.decim, decim_cfg, decim_groups, sink.channels) != 0) {
+            perror("decim_create(--decim)");
+            goto cleanup;
+        }
+        /* Output and statistics see only the channels the masks select. */
+        sink.channels = decim_channels(sink.decim);
+        if (sink.channels != ADS1278_CHANNEL_COUNT && out_path != NULL && !out_v2) {
+            fprintf(stderr, "--decim masks need --out-format v2 (v1 records hold 8 channels).\n");
             goto cleanup;
         }
     }
+    if (sink.channels != ADS1278_CHANNEL_COUNT && out_encoding == PROTO_DATA_ENC_RECORD48) {
+        /* RECORD48 chunks hold one device; packed 24-bit samples are the raw equivalent. */
+        out_encoding = PROTO_DATA_ENC_P24;
+    }
+    if (print_summary && chan_stats_create(&sink.chan_stats, sink.channels) != 0) {
+        perror("chan_stats_create(--summary)");
+        goto cleanup;
+    }
+    if (calib_path != NULL) {
+        if (chan_calib_load(&calib, chain_length * ADS1278_CHANNEL_COUNT, vref, calib_path) != 0) {
+            fprintf(stderr, "Cannot load calibration table %s: %s\n", calib_path, strerror(errno));
+            goto cleanup;
+        }
+    } else if (vref_set) {
+        chan_calib_init(&calib, chain_length * ADS1278_CHANNEL_COUNT, vref);
+    }
+    if ((calib_path != NULL || vref_set) && sink.decim != NULL) {
+        uint32_t channel;
+
+        /* The table is per input channel; follow the decimator's selection. */
+        for (channel = 0U; channel < sink.channels; ++channel) {
+            calib.scale[channel] = calib.scale[decim_source_channel(sink.decim, channel)];
+            calib.offset[channel] = calib.offset[decim_source_channel(sink.decim, channel)];
+        }
+        calib.channel_count = sink.channels;
+    }
+
+    if (use_trigger) {
+        trigger_cfg.channel_count = sink.channels;
+        trigger_cfg.use_gpio = trigger_gpio.set;
+        trigger_cfg.gpio_chip = gpio_endpoint_chip(&trigger_gpio);
+        trigger_cfg.gpio_line = trigger_gpio.gpio_number;
+        if (trigger_create(&sink.trigger, &trigger_cfg) != 0) {
+            perror("trigger_create(--trigger)");
+            goto cleanup;
+        }
+        sink.trigger_cfg = &trigger_cfg;
+    }
+    if (use_trigger && out_path != NULL) {
+        uint32_t window = trigger_window_frames(sink.trigger);
+
+        sink.event_msg = malloc(proto_event_max_bytes(out_encoding, sink.channels, window));
+        if (sink.event_msg == NULL ||
+            proto_data_encoder_init(&sink.event_enc, out_encoding, sink.channels, window) != 0) {
+            perror("proto_data_encoder_init(--trigger)");
+            goto cleanup;
+        }
+        sink.event_enc.linear_ts = true;
+        sink.event_enc.linear_tolerance_ns = smooth_tstamps ? CLOCK_MODEL_LINEAR_TOLERANCE_NS : 0U;
+    }
+
+    if (out_path != NULL || out_dir != NULL) {
+        writer_cfg.block_bytes = (size_t)out_block_kb * 1024U;
+        writer_cfg.prealloc_bytes = (uint64_t)out_prealloc_mb * 1024U * 1024U;
+        if (out_v2 && !use_trigger) {
+            capture_file_acq_t *snap = &file_cfg.acq;
+
+            file_cfg.writer = writer_cfg;
+            file_cfg.encoding = out_encoding;
+            file_cfg.channel_count = (uint16_t)sink.channels;
+            file_cfg.linear_ts = true;
+            file_cfg.linear_tolerance_ns = smooth_tstamps ? CLOCK_MODEL_LINEAR_TOLERANCE_NS : 0U;
+            snap->backend = (uint32_t)backend;
+            snap->sample_rate_hz = (backend == ADS1278_BACKEND_SIM) ? sim.drdy_rate_hz : 0U;
+            if (sink.decim != NULL) {
+                snap->decimation = decim_factor(sink.decim);
+                snap->sample_rate_hz /= snap->decimation;
+            }
+            snap->sclk_hz = sclk_hz;
+            snap->spi_mode = spi_mode;
+            snap->settle_frames = settle_frames;
+            snap->drdy_timeout_ms = drdy_timeout_ms;
+            snap->drdy_line = drdy.set ? drdy.gpio_number : CAPTURE_FILE_NO_LINE;
+            snap->sync_line = (use_sync && sync.set) ? sync.gpio_number : CAPTURE_FILE_NO_LINE;
+            snprintf(snap->drdy_chip, sizeof(snap->drdy_chip), "%s", drdy.set ? drdy.chip : "");
+            snprintf(snap->sync_chip, sizeof(snap->sync_chip), "%s", (use_sync && sync.set) ? sync.chip : "");
+            snprintf(snap->writer, sizeof(snap->writer), "ads1278_dump");
+        }
+        if (out_dir != NULL) {
+            seg_cfg.dir = out_dir;
+            seg_cfg.file = file_cfg;
+            seg_cfg.segment_bytes = (uint64_t)segment_mb * 1024U * 1024U;
+            seg_cfg.segment_ms = segment_s * 1000U;
+            seg_cfg.quota_bytes = (uint64_t)quota_mb * 1024U * 1024U;
+            if (capture_seg_open(&segs, &seg_cfg) != 0) {
+                fprintf(stderr, "Cannot record segments in %s: %s\n", out_dir, strerror(errno));
+                goto cleanup;
+            }
+        } else if (out_v2 && !use_trigger) {
+            if (capture_file_create(&cfile, out_path, &file_cfg) != 0) {
+                perror("capture_file_create(--out)");
+                goto cleanup;
+            }
+        } else if (capture_writer_open(&writer, out_path, &writer_cfg) != 0) {
+            perror("capture_writer_open(--out)");
+            goto cleanup;
+        }
+    }
+    sink.writer = writer;
+    sink.cfile = cfile;
+    sink.segs = segs;
+    if (install_signal_handlers() != 0) {
+        perror("sigaction");
+        goto cleanup;
+    }
 
     {
         ads1278_cfg_t cfg = {0};
+        acq_cfg_t acq_cfg = {0};
         uint64_t idx;
 
         cfg.spidev_path = spidev_path;
         cfg.sclk_hz = sclk_hz;
         cfg.spi_mode = (uint8_t)spi_mode;
         cfg.spi_no_cs = true;
+        cfg.chain_length = chain_length;
+        cfg.smooth_tstamps = smooth_tstamps;
         cfg.drdy_gpio_number = drdy.gpio_number;
+        cfg.drdy_gpiochip = gpio_endpoint_chip(&drdy);
         cfg.use_sync = use_sync;
         cfg.sync_gpio_number = use_sync ? sync.gpio_number : 0U;
+        cfg.sync_gpiochip = use_sync ? gpio_endpoint_chip(&sync) : NULL;
         cfg.settle_frames = settle_frames;
         cfg.drdy_timeout_ms = drdy_timeout_ms;
+        cfg.backend = backend;
+        cfg.sim = sim;
 
         if (ads1278_open(&cfg) != 0) {
             perror("ads1278_open");
             goto cleanup;
         }
+        hal_open = true;
 
         if (ads1278_start() != 0) {
             perror("ads1278_start");
-            ads1278_close();
             goto cleanup;
         }
 
-        for (idx = 0U; idx < frames_to_capture; ++idx) {
+        t_start = monotonic_seconds();
+
+        /* Raw hex needs the HAL's last-frame buffer, so read those frames inline. */
+        for (idx = 0U; idx < frames_to_capture && idx < (uint64_t)hex_frames; ++idx) {
             ads1278_frame_t frame = {0};
+            uint8_t raw[ADS1278_MAX_FRAME_BYTES];
 
             if (ads1278_read_frame(&frame) != 0) {
                 perror("ads1278_read_frame");
-                ads1278_stop();
-                ads1278_close();
                 goto cleanup;
             }
 
             ++captured;
-
             if (pretty_print) {
-                print_frame(&frame);
+                print_frame(&frame, chain_length * ADS1278_CHANNEL_COUNT);
+            }
+            if (ads1278_get_last_raw_frame(raw) == 0) {
+                print_raw_hex(raw, (size_t)chain_length * ADS1278_TDM_FRAME_BYTES, frame.seq);
+            }
+            if (consume_frames(&sink, &frame, 1U, false) != 0) {
+                goto cleanup;
             }
+        }
+
+        if (captured < frames_to_capture) {
+            ads1278_frame_t batch[DUMP_DRAIN_BATCH_FRAMES];
+
+            if (shm_cfg.name != NULL) {
+                shm_cfg.capacity = shm_frames;
+                shm_cfg.channels = chain_length * ADS1278_CHANNEL_COUNT;
+                shm_cfg.sample_rate_hz = (backend == ADS1278_BACKEND_SIM) ? sim.drdy_rate_hz : 0U;
+                if (shm_ring_writer_create(&shm, &shm_cfg) != 0) {
+                    fprintf(stderr, "Cannot create shared memory ring %s: %s\n", shm_cfg.name, strerror(errno));
+                    goto cleanup;
+                }
+            }
+            acq_cfg.ring_capacity = ring_frames;
+            acq_cfg.max_frames = frames_to_capture - captured;
+            acq_cfg.shm = shm;
+            acq_cfg.rt = rt_cfg;
+            acq_cfg.rt.priority = (int)rt_priority;
+            if (acq_create(&acq, &acq_cfg) != 0) {
+                perror("acq_create");
+                goto cleanup;
+            }
+            if (acq_start(acq) != 0) {
+                perror("acq_start");
+                goto cleanup;
+            }
+            acq_get_rt_status(acq, &rt_status);
+            rt_format_status(&acq_cfg.rt, &rt_status, text, sizeof(text));
+            fprintf(stderr, "%s\n", text);
+
+            for (;;) {
+                bool finished;
+                size_t n;
 
-            if (idx < (uint64_t)hex_frames) {
-                uint8_t raw[ADS1278_TDM_FRAME_BYTES];
-                if (ads1278_get_last_raw_frame(raw) == 0) {
-                    print_raw_hex(raw, frame.seq);
+                if (g_stop) {
+                    /* Drain what was acquired before the signal, then finish as usual. */
+                    acq_stop(acq);
                 }
+                finished = acq_is_done(acq);
+                n = acq_drain(acq, batch, DUMP_DRAIN_BATCH_FRAMES, DUMP_DRAIN_WAIT_MS);
+
+                if (n == 0U && finished) {
+                    break;
+                }
+                if (consume_frames(&sink, batch, n, pretty_print) != 0) {
+                    goto cleanup;
+                }
+                captured += n;
             }
 
-            if (out_file != NULL && write_frame_record(out_file, &frame) != 0) {
-                perror("write_frame_record");
-                ads1278_stop();
-                ads1278_close();
+            acq_stop(acq);
+            acq_get_stats(acq, &acq_stats);
+            if (acq_get_error(acq) != 0) {
+                errno = acq_get_error(acq);
+                perror("ads1278_read_frame");
                 goto cleanup;
             }
         }
 
+        if (sink.trigger != NULL) {
+            trigger_event_t event;
+
+            trigger_flush(sink.trigger, &event);
+            if (event.frame_count != 0U && emit_event(&sink, &event, pretty_print) != 0) {
+                goto cleanup;
+            }
+        }
+
+        elapsed_s = monotonic_seconds() - t_start;
+        missed_drdy = ads1278_get_missed_drdy();
+        overlong_xfers = ads1278_get_overlong_xfers();
+        (void)ads1278_get_stats(&hal_stats);
         ads1278_stop();
         ads1278_close();
+        hal_open = false;
     }
 
-    if (out_file != NULL && fflush(out_file) != 0) {
-        perror("fflush");
-        goto cleanup;
+    if (segs != NULL) {
+        int rc = capture_seg_close(segs, &seg_stats);
+
+        segs = NULL;
+        sink.segs = NULL;
+        if (rc != 0) {
+            perror("capture_seg_close");
+            goto cleanup;
+        }
+    }
+    if (cfile != NULL) {
+        int rc = capture_file_finish(cfile, &writer_stats, &cfile_info);
+
+        cfile = NULL;
+        if (rc != 0) {
+            perror("capture_file_finish");
+            goto cleanup;
+        }
+    }
+    if (writer != NULL) {
+        int rc = capture_writer_close(writer, &writer_stats);
+
+        writer = NULL;
+        if (rc != 0) {
+            perror("capture_writer_close");
+            goto cleanup;
+        }
     }
 
-    fprintf(stderr, "Captured %" PRIu64 " frame(s).\n", captured);
+    fprintf(stderr, "Captured %" PRIu64 " frame(s) from %s backend in %.3f s (%.0f frames/s).\n",
+        captured, ads1278_backend_name(backend), elapsed_s,
+        (elapsed_s > 0.0) ? (double)captured / elapsed_s : 0.0);
+    if (missed_drdy != 0U) {
+        fprintf(stderr, "warning: %" PRIu64 " DRDY edge(s) missed (conversions lost).\n", missed_drdy);
+    }
+    if (hal_stats.missed_conversions != 0U) {
+        fprintf(stderr, "warning: %" PRIu64 " conversion(s) missed in %" PRIu64 " gap(s), longest %" PRIu64
+            " (seq jumps).\n", hal_stats.missed_conversions, hal_stats.gap_events, hal_stats.longest_gap);
+    }
+    if (overlong_xfers != 0U) {
+        fprintf(stderr, "warning: %" PRIu64 " frame(s) read more than 5 ms after DRDY (overrun risk).\n",
+            overlong_xfers);
+    }
+    if (shm != NULL) {
+        fprintf(stderr, "Shared memory: %" PRIu64 " frame(s) published to %s.\n", shm_ring_writer_frames(shm),
+            shm_cfg.name);
+    }
+    if (acq != NULL) {
+        lat_hist_format(&acq_stats.latency, text, sizeof(text));
+        fprintf(stderr, "DRDY-to-frame latency: %s.\n", text);
+        fprintf(stderr, "Ring: capacity %" PRIu64 ", high-water %" PRIu64 ", overflows %" PRIu64 ".\n",
+            acq_stats.ring.capacity, acq_stats.ring.high_water, acq_stats.ring.overflows);
+        if (acq_stats.ring.overflows != 0U) {
+            fprintf(stderr, "warning: %" PRIu64 " frame(s) dropped on ring overflow.\n",
+                acq_stats.ring.overflows);
+        }
+    }
+    if (sink.decim != NULL) {
+        decim_get_stats(sink.decim, &decim_stats);
+        fprintf(stderr, "Decimator: /%" PRIu32 " (%" PRIu32 " FIR taps), %" PRIu64 " frame(s) in, %" PRIu64
+            " out, %" PRIu64 " reset(s).\n", decim_factor(sink.decim), decim_fir_taps(sink.decim),
+            decim_stats.frames_in, decim_stats.frames_out, decim_stats.resets);
+    }
+    if (sink.trigger != NULL) {
+        trigger_get_stats(sink.trigger, &trigger_stats);
+        fprintf(stderr, "Trigger: %" PRIu64 " event(s) from %" PRIu64 " frame(s), %" PRIu64 " suppressed, %" PRIu64
+            " truncated, %" PRIu64 " external edge(s).\n", trigger_stats.events, trigger_stats.frames_in,
+            trigger_stats.suppressed, trigger_stats.truncated, trigger_stats.external);
+        if (trigger_get_error(sink.trigger) != 0) {
+            errno = trigger_get_error(sink.trigger);
+            perror("warning: --trigger-gpio watcher stopped");
+        }
+    }
+    if (sink.chan_stats != NULL) {
+        report_channel_summary(sink.chan_stats, (calib_path != NULL || vref_set) ? &calib : NULL);
+    }
+    if (print_stats) {
+        report_pipeline_stats(&hal_stats, (acq != NULL) ? &acq_stats : NULL);
+    }
+    if (out_path != NULL) {
+        report_writer_stats(&writer_stats);
+    }
+    if (out_dir != NULL) {
+        report_segment_stats(out_dir, &seg_stats);
+    }
+    if (cfile_info.frame_count != 0U) {
+        /* Relative to seq + tstamp + one i32 per channel (the 48-byte v1 record for one device). */
+        uint32_t record_bytes = 16U + (4U * sink.channels);
+
+        fprintf(stderr, "Format v2: %" PRIu64 " %s chunk(s), %.2f byte/frame (%.2fx vs %" PRIu32 "-byte records).\n",
+            cfile_info.chunk_count, proto_data_encoding_name(cfile_info.encoding),
+            (double)writer_stats.bytes_written / (double)cfile_info.frame_count,
+            (double)cfile_info.frame_count * record_bytes / (double)writer_stats.bytes_written, record_bytes);
+        if (cfile_info.gap_count != 0U) {
+            fprintf(stderr, "Format v2: %" PRIu64 " missing frame(s) in %" PRIu64 " seq gap(s) recorded in the header.\n",
+                cfile_info.missed_frames, cfile_info.gap_count);
+        }
+    }
     exit_code = EXIT_SUCCESS;
 
 cleanup:
-    if (out_file != NULL) {
-        fclose(out_file);
+    acq_destroy(acq);
+    shm_ring_writer_destroy(shm);
+    if (hal_open) {
+        ads1278_stop();
+        ads1278_close();
+    }
+    if (segs != NULL) {
+        (void)capture_seg_close(segs, NULL);
+    }
+    if (cfile != NULL) {
+        (void)capture_file_finish(cfile, NULL, NULL);
+    }
+    if (writer != NULL) {
+        (void)capture_writer_close(writer, NULL);
     }
+    decim_destroy(sink.decim);
+    chan_stats_destroy(sink.chan_stats);
+    trigger_destroy(sink.trigger);
+    proto_data_encoder_destroy(&sink.event_enc);
+    free(sink.event_msg);
+    free_gpio_endpoint(&trigger_gpio);
     free_gpio_endpoint(&drdy);
     free_gpio_endpoint(&sync);
     return exit_code;